@@ -0,0 +1,111 @@
+// bench_edit.c
+/**
+ * @detail Large documents: generates a text file of `mb` megabytes, then times
+ * 	opening it in a text editor (mapping + piece tree), the first frame (lays
+ * 	out only the visible lines), jumping to the middle and last lines, random
+ * 	inserts and erases across the whole document, and indexing every line.
+ * 	Open and edit times should not grow with the file size.
+ * 	usage: bench_edit [mb=1024] [edits=100000] [path=/tmp/sigui_bench_edit.txt]
+ */
+#include "sigui.h"
+#include "sigui_widgets.h"
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_sec(void);
+
+/* writes lines of varying length until `bytes` are written */
+static int generate(const char* path, int64_t bytes) {
+	FILE* f = fopen(path, "wb");
+	if (!f) return -1;
+	static char block[1 << 20];
+	int n = 0, line = 0;
+	for (int64_t written = 0; written < bytes; written += n) {
+		n = 0;
+		while (n < (int)sizeof(block) - 128) n += snprintf(block + n, 128, "%08d the quick brown fox %.*s\n", line, line % 60, "jumps over the lazy dog, jumps over the lazy dog, jumps over!"), line++;
+		if (written + n > bytes) n = (int)(bytes - written);
+		fwrite(block, 1, n, f);
+	}
+
+	return fclose(f);
+}
+
+int main(int argc, char** argv) {
+	int mb = argc > 1 ? atoi(argv[1]) : 1024;
+	int edits = argc > 2 ? atoi(argv[2]) : 100000;
+	const char* path = argc > 3 ? argv[3] : "/tmp/sigui_bench_edit.txt";
+
+	double t0 = now_sec();
+	if (generate(path, (int64_t)mb << 20) != 0) {
+		printf("cannot write %s\n", path);
+		return 1;
+	}
+	printf("generated %d MB in %.2f s\n", mb, now_sec() - t0);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 1280, 720);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_textedit ed = TextEdit.new(ctx, "edit", Sigui.new_window(ctx, 0, 0, 1280, 720));
+
+	t0 = now_sec();
+	TextEdit.open(ed, path);
+	double open = now_sec() - t0;
+	t0 = now_sec();
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	double first = now_sec() - t0;
+	textedit_stats es;
+	TextEdit.stats(ed, &es);
+	printf("%-24s %10.3f ms  (pieces=%d, lines drawn=%d)\n", "open", 1e3 * open, es.pieces, es.drawn);
+	printf("%-24s %10.3f ms\n", "first frame", 1e3 * first);
+
+	//	jumps: the index is only built up to the line asked for
+	t0 = now_sec();
+	int64_t middle = TextEdit.line_of(ed, es.length / 2);
+	TextEdit.scroll_to_line(ed, middle);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	printf("%-24s %10.3f ms  (line %lld)\n", "jump to middle", 1e3 * (now_sec() - t0), (long long)middle);
+
+	//	random edits over the whole document
+	uint32_t seed = 1;
+	t0 = now_sec();
+	for (int i = 0; i < edits; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		int64_t offset = (int64_t)(((uint64_t)seed << 16) % (uint64_t)(TextEdit.length(ed) + 1));
+		if (i % 2) TextEdit.erase(ed, offset, 1 + i % 7);
+		else TextEdit.insert(ed, offset, "inserted text\n", 14);
+	}
+	double edit = now_sec() - t0;
+	TextEdit.stats(ed, &es);
+	printf("%-24s %10.3f us  (pieces=%d)\n", "insert/erase per op", 1e6 * edit / edits, es.pieces);
+
+	t0 = now_sec();
+	for (int i = 0; i < 1000; ++i) {
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+		TextEdit.stats(ed, &es);
+		if (es.indexed >= es.mapped) break;
+	}
+	int64_t lines = TextEdit.lines(ed);
+	printf("%-24s %10.3f ms  (%lld lines)\n", "index all lines", 1e3 * (now_sec() - t0), (long long)lines);
+
+	t0 = now_sec();
+	TextEdit.scroll_to_line(ed, lines - 10);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	printf("%-24s %10.3f ms\n", "jump to end", 1e3 * (now_sec() - t0));
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	remove(path);
+
+	return 0;
+}
+
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,99 @@
+// bench_flex.c
+/**
+ * @detail Flex layout: builds a page of panels (rows) of cards (columns) of
+ * 	leaves, each leaf laying out a module window, then times updates after one
+ * 	change. A change absorbed by a fixed-size card, and one that widens a card
+ * 	within its panel, should cost microseconds whatever the tree size; a change
+ * 	that makes a panel taller also shifts the panels below it; a resize of the
+ * 	root re-places everything.
+ * 	usage: bench_flex [panels=50] [cards=20] [leaves=20] [iterations=2000]
+ */
+#include "sigui.h"
+#include "sigui_flex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_sec(void);
+static void bench_render(ui_context, ui_module, ui_input*);
+
+/* times one kind of change; `change` alternates between two values */
+static void run(const char* name, ui_context ctx, int iterations, int node, int mode) {
+	flex_stats fs = {0};
+	double total = 0, worst = 0;
+	for (int i = 0; i < iterations; ++i) {
+		int odd = i & 1;
+		if (mode == 0) Flex.content(ctx, node, odd ? 40 : 30, 12);
+		else if (mode == 1) Flex.content(ctx, node, odd ? 200 : 30, 12);
+		else if (mode == 2) Flex.content(ctx, node, 30, odd ? 400 : 12);
+		else Flex.resize(ctx, odd ? 1600 : 1920, 0);
+		double t0 = now_sec();
+		Flex.update(ctx);
+		double dt = now_sec() - t0;
+		total += dt;
+		if (dt > worst) worst = dt;
+		Flex.stats(ctx, &fs);
+	}
+
+	printf("%-26s %10.2f %10.2f %9d %9d %9d %9d\n", name, 1e6 * total / iterations, 1e6 * worst,
+			 fs.measured, fs.arranged, fs.moved, fs.written);
+}
+
+int main(int argc, char** argv) {
+	int panels = argc > 1 ? atoi(argv[1]) : 50;
+	int cards = argc > 2 ? atoi(argv[2]) : 20;
+	int leaves = argc > 3 ? atoi(argv[3]) : 20;
+	int iterations = argc > 4 ? atoi(argv[4]) : 2000;
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	double t0 = now_sec();
+	Flex.style(ctx, FLEX_ROOT, &(flex_style){ .direction = FLEX_COLUMN, .padding = { 8, 8, 8, 8 }, .gap = 8 });
+	Flex.resize(ctx, 1920, 0);
+	int fixed_leaf = -1, free_leaf = -1;
+	for (int p = 0; p < panels; ++p) {
+		int panel = Flex.node(ctx, FLEX_ROOT, &(flex_style){ .gap = 4, .padding = { 4, 4, 4, 4 }, .align = FLEX_ALIGN_START }, NULL);
+		for (int c = 0; c < cards; ++c) {
+			//	even cards are fixed-size; odd cards size to their leaves
+			flex_style card = { .direction = FLEX_COLUMN, .gap = 2, .padding = { 2, 2, 2, 2 } };
+			if (c % 2 == 0) card.width = 80, card.height = leaves * 14 + 8;
+			int cn = Flex.node(ctx, panel, &card, NULL);
+			for (int l = 0; l < leaves; ++l) {
+				ui_module m = Sigui.add_module(ctx, "leaf", bench_render, NULL, NULL);
+				int leaf = Flex.node(ctx, cn, NULL, m);
+				Flex.content(ctx, leaf, 30, 12);
+				if (p == panels / 2 && c == 0 && l == leaves / 2) fixed_leaf = leaf;
+				if (p == panels / 2 && c == 1 && l == leaves / 2) free_leaf = leaf;
+			}
+		}
+	}
+	double build = now_sec() - t0;
+	t0 = now_sec();
+	Flex.update(ctx);
+	double first = now_sec() - t0;
+	flex_stats fs;
+	Flex.stats(ctx, &fs);
+	printf("nodes=%d (panels=%d cards=%d leaves=%d)  build %.2f ms, first layout %.2f ms\n",
+			 fs.nodes, panels, cards, leaves, 1e3 * build, 1e3 * first);
+
+	printf("%-26s %10s %10s %9s %9s %9s %9s\n", "change", "avg us", "worst us", "measured", "arranged", "moved", "written");
+	run("leaf in fixed card", ctx, iterations, fixed_leaf, 0);
+	run("leaf widens its card", ctx, iterations, free_leaf, 1);
+	run("leaf makes panel taller", ctx, iterations, free_leaf, 2);
+	run("root resize", ctx, iterations / 20 + 1, fixed_leaf, 3);
+
+	t0 = now_sec();
+	for (int i = 0; i < iterations; ++i) Flex.update(ctx);
+	printf("%-26s %10.3f\n", "update without changes", 1e6 * (now_sec() - t0) / iterations);
+
+	Sigui.free_context(ctx);
+	return 0;
+}
+
+static void bench_render(ui_context ctx, ui_module m, ui_input* input) {
+	//	layout only
+}
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
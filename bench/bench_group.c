@@ -0,0 +1,82 @@
+// bench_group.c
+/**
+ * @detail Context group throughput: steps G independent headless contexts per
+ * 	frame on 1..N threads and reports contexts/sec for each thread count.
+ * 	usage: bench_group [contexts=256] [frames=200] [max_threads=2*cores]
+ */
+#include "sigui.h"
+#include "sigui_group.h"
+#include "render.h"
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MODULES_PER_CONTEXT 8
+#define TARGET_WIDTH 320
+#define TARGET_HEIGHT 240
+
+static void bench_render(ui_context, ui_module, ui_input*);
+static double now_sec(void);
+
+int main(int argc, char** argv) {
+	int contexts = argc > 1 ? atoi(argv[1]) : 256;
+	int frames = argc > 2 ? atoi(argv[2]) : 200;
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	int max_threads = argc > 3 ? atoi(argv[3]) : (int)(cores > 0 ? cores * 2 : 2);
+
+	ui_context* ctxs = calloc(contexts, sizeof(ui_context));
+	render_target* targets = calloc(contexts, sizeof(render_target));
+	for (int c = 0; c < contexts; ++c) {
+		ctxs[c] = Sigui.new_context(NULL, NULL);
+		targets[c] = Render.new_target(RENDER_HEADLESS, TARGET_WIDTH, TARGET_HEIGHT);
+		for (int m = 0; m < MODULES_PER_CONTEXT; ++m) {
+			window win = Sigui.new_window(ctxs[c], (m % 4) * 80, (m / 4) * 120, 72, 110);
+			Sigui.add_module(ctxs[c], "bench", bench_render, NULL, win);
+		}
+	}
+
+	printf("contexts=%d frames=%d modules/context=%d target=%dx%d cores=%ld\n",
+			 contexts, frames, MODULES_PER_CONTEXT, TARGET_WIDTH, TARGET_HEIGHT, cores);
+	printf("%8s %14s %10s\n", "threads", "contexts/sec", "speedup");
+
+	double base = 0.0;
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+		ui_group g = Group.new(threads);
+		for (int c = 0; c < contexts; ++c) Group.add(g, ctxs[c], targets[c]);
+
+		ui_input input = {0};
+		for (int f = 0; f < 5; ++f) Group.step(g);		// warm-up
+
+		double t0 = now_sec();
+		for (int f = 0; f < frames; ++f) {
+			input.mouse_x = f;
+			for (int c = 0; c < contexts; ++c) Group.set_input(g, c, &input);
+			Group.step(g);
+		}
+		double rate = (double)contexts * frames / (now_sec() - t0);
+		if (threads == 1) base = rate;
+
+		printf("%8d %14.0f %9.2fx\n", Group.threads(g), rate, rate / base);
+		Group.free(g);
+	}
+
+	for (int c = 0; c < contexts; ++c) {
+		Render.free_target(targets[c]);
+		Sigui.free_context(ctxs[c]);
+	}
+	free(targets);
+	free(ctxs);
+
+	return 0;
+}
+
+/* light per-module work so logic is not free */
+static void bench_render(ui_context ctx, ui_module m, ui_input* input) {
+	volatile int acc = 0;
+	for (int i = 0; i < 64; ++i) acc += input ? input->mouse_x * i : i;
+}
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,77 @@
+// bench_list.c
+/**
+ * @detail Virtualized list scrolling: a list of N rows (fixed or variable
+ * 	heights) scrolls a few pixels every frame through a headless target, for
+ * 	100 rows and for 10M rows. Frame time should not depend on the row count.
+ * 	Reports frames/sec and rows fetched/recorded per frame.
+ * 	usage: bench_list [frames=2000] [height=720]
+ */
+#include "sigui.h"
+#include "sigui_widgets.h"
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static int row_text(object, int, char*, int);
+static int row_height(object, int);
+static double now_sec(void);
+
+static int height = 720;
+
+static void run(int rows, int variable, int frames) {
+	render_target t = Render.new_target(RENDER_HEADLESS, 480, height);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	listview_source src = { .text = row_text, .height = variable ? row_height : NULL };
+	ui_listview l = ListView.new(ctx, "list", Sigui.new_window(ctx, 0, 0, 480, height), &src, rows, 20);
+
+	for (int f = 0; f < 2; ++f) {		// warm-up
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+	}
+
+	//	scroll down and bounce back at the end
+	int64_t step = 7;
+	double t0 = now_sec();
+	for (int f = 0; f < frames; ++f) {
+		int64_t before = ListView.offset(l);
+		ListView.scroll_by(l, step);
+		if (ListView.offset(l) == before) step = -step;
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+	}
+	double elapsed = now_sec() - t0;
+	listview_stats ls;
+	ListView.stats(l, &ls);
+
+	printf("%-10d %-9s %12.1f %12.2f %12.2f %9d\n", rows, variable ? "variable" : "fixed", frames / elapsed,
+			 1e6 * elapsed / frames, (double)ls.fetched / frames, ls.drawn);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+
+int main(int argc, char** argv) {
+	int frames = argc > 1 ? atoi(argv[1]) : 2000;
+	height = argc > 2 ? atoi(argv[2]) : height;
+
+	printf("frames=%d window=480x%d\n", frames, height);
+	printf("%-10s %-9s %12s %12s %12s %9s\n", "rows", "heights", "frames/sec", "us/frame", "fetch/frame", "recorded");
+	for (int variable = 0; variable < 2; ++variable) {
+		run(100, variable, frames);
+		run(10000000, variable, frames);
+	}
+
+	return 0;
+}
+
+static int row_text(object data, int row, char* buf, int size) {
+	return snprintf(buf, size, "row %d: %08x", row, row * 2654435761u);
+}
+static int row_height(object data, int row) {
+	return 18 + (row * 7) % 3 * 6;
+}
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,109 @@
+// bench_pipeline.c
+/**
+ * @detail Pipelined frames: a grid of modules records shapes that change every
+ * 	frame (the logic stage) and a headless target rasterizes them (the render
+ * 	stage). The same scene runs serially (`Sigui.render` then `Render.frame`)
+ * 	and through a pipeline, where the render thread presents frame N while the
+ * 	caller records frame N+1. With both stages busy the pipelined frame time
+ * 	approaches the longer stage instead of their sum.
+ * 	usage: bench_pipeline [modules=64] [shapes=200] [frames=200] [size=1024]
+ */
+#include "sigui.h"
+#include "sigui_draw.h"
+#include "sigui_pipeline.h"
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static void bench_render(ui_context, ui_module, ui_input*);
+static double now_sec(void);
+
+static int shapes = 200;
+static int cell = 128;
+static int tick = 0;
+
+/* builds the scene: modules tiled over the target */
+static ui_context scene(int modules, int size) {
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	int per_row = size / cell;
+	for (int i = 0; i < modules; ++i) {
+		int x = (i % per_row) * cell, y = (i / per_row % per_row) * cell;
+		Sigui.add_module(ctx, "cell", bench_render, NULL, Sigui.new_window(ctx, x, y, cell, cell));
+	}
+
+	return ctx;
+}
+
+int main(int argc, char** argv) {
+	int modules = argc > 1 ? atoi(argv[1]) : 64;
+	shapes = argc > 2 ? atoi(argv[2]) : shapes;
+	int frames = argc > 3 ? atoi(argv[3]) : 200;
+	int size = argc > 4 ? atoi(argv[4]) : 1024;
+	printf("modules=%d shapes=%d frames=%d target=%dx%d\n", modules, shapes, frames, size, size);
+
+	//	serial
+	render_target t = Render.new_target(RENDER_HEADLESS, size, size);
+	ui_context ctx = scene(modules, size);
+	double logic = 0, render = 0;
+	for (int f = 0; f < frames + 3; ++f) {
+		if (f == 3) logic = render = 0;		// after warm-up
+		tick++;
+		double t0 = now_sec();
+		Sigui.render(ctx, NULL);
+		double t1 = now_sec();
+		Render.frame(t, ctx);
+		logic += t1 - t0;
+		render += now_sec() - t1;
+	}
+	double serial = (logic + render) / frames;
+	printf("%-10s %10.3f ms/frame  (logic %.3f ms, render %.3f ms)\n", "serial", 1e3 * serial, 1e3 * logic / frames, 1e3 * render / frames);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+
+	//	pipelined
+	t = Render.new_target(RENDER_HEADLESS, size, size);
+	ctx = scene(modules, size);
+	ui_pipeline p = Pipeline.new(ctx, t, 2);
+	for (int f = 0; f < 3; ++f) {
+		tick++;
+		Pipeline.frame(p, NULL);
+	}
+	Pipeline.flush(p);
+	pipeline_stats before, after;
+	Pipeline.stats(p, &before);
+	double t0 = now_sec();
+	for (int f = 0; f < frames; ++f) {
+		tick++;
+		Pipeline.frame(p, NULL);
+	}
+	Pipeline.flush(p);
+	double piped = (now_sec() - t0) / frames;
+	Pipeline.stats(p, &after);
+	printf("%-10s %10.3f ms/frame  (logic %.3f ms, render %.3f ms, stalls %llu, copied %llu, shared %llu)\n", "pipelined", 1e3 * piped,
+			 1e-6 * (after.logic_ns - before.logic_ns) / frames, 1e-6 * (after.render_ns - before.render_ns) / frames,
+			 (unsigned long long)(after.stalls - before.stalls), (unsigned long long)(after.copied - before.copied),
+			 (unsigned long long)(after.shared - before.shared));
+	printf("speedup    %10.2fx\n", serial / piped);
+	Pipeline.free(p);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+
+	return 0;
+}
+
+/* rects and rounded rects drifting every frame */
+static void bench_render(ui_context ctx, ui_module m, ui_input* input) {
+	for (int i = 0; i < shapes; ++i) {
+		int x = (i * 37 + tick) % (cell - 20);
+		int y = (i * 91 + tick / 2) % (cell - 20);
+		uint32_t color = UI_RGBA(i * 13 + tick, i * 7, i * 3, 0xC0);
+		if (i % 2) Draw.rounded(ctx, x, y, 18, 18, 6, color);
+		else Draw.rect(ctx, x, y, 16, 12, color);
+	}
+}
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,81 @@
+// bench_plot.c
+/**
+ * @detail Live telemetry: every frame appends 1/60 s worth of samples (rate
+ * 	samples/sec per series) to a plot and renders it to a headless target,
+ * 	either showing every sample so far (zoomed out over a growing history) or
+ * 	following the last 10 s. The target is 1M samples/sec at 60 fps: appends
+ * 	plus frame must stay under 16.7 ms as the series grow to tens of millions
+ * 	of samples. Reports frames/sec, per-frame append and render times, and
+ * 	pyramid entries read per frame.
+ * 	usage: bench_plot [rate=1000000] [seconds=10] [series=2] [width=1280]
+ */
+#include "sigui.h"
+#include "sigui_widgets.h"
+#include "render.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_sec(void);
+
+static void run(const char* name, int rate, int seconds, int series, int width, int follow) {
+	int height = width * 9 / 16;
+	render_target t = Render.new_target(RENDER_HEADLESS, width, height);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_plotview p = PlotView.new(ctx, "plot", Sigui.new_window(ctx, 0, 0, width, height));
+	for (int s = 0; s < series; ++s) PlotView.add_series(p, UI_RGB(40 + 100 * s, 80, 200 - 60 * s));
+	if (follow) PlotView.follow(p, (int64_t)rate * 10);
+
+	int batch = rate / 60;
+	float* samples = malloc(sizeof(float) * batch);
+	int frames = seconds * 60;
+	double append = 0, render = 0, worst = 0;
+	int64_t scanned = 0, n = 0;
+	for (int f = 0; f < frames; ++f) {
+		double t0 = now_sec();
+		for (int s = 0; s < series; ++s) {
+			for (int i = 0; i < batch; ++i, ++n) samples[i] = sinf(n * 1e-5f * (s + 1)) + 0.1f * sinf(n * 0.37f);
+			PlotView.append(p, s, samples, batch);
+		}
+		double t1 = now_sec();
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+		double t2 = now_sec();
+
+		plotview_stats ps;
+		PlotView.stats(p, &ps);
+		scanned += ps.scanned;
+		append += t1 - t0;
+		render += t2 - t1;
+		if (t2 - t0 > worst) worst = t2 - t0;
+	}
+	plotview_stats ps;
+	PlotView.stats(p, &ps);
+
+	printf("%-8s %12lld %10.1f %10.3f %10.3f %10.3f %12lld\n", name, (long long)ps.samples, frames / (append + render),
+			 1e3 * append / frames, 1e3 * render / frames, 1e3 * worst, (long long)(scanned / frames));
+	free(samples);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+
+int main(int argc, char** argv) {
+	int rate = argc > 1 ? atoi(argv[1]) : 1000000;
+	int seconds = argc > 2 ? atoi(argv[2]) : 10;
+	int series = argc > 3 ? atoi(argv[3]) : 2;
+	int width = argc > 4 ? atoi(argv[4]) : 1280;
+
+	printf("rate=%d samples/sec x %d series, %d s at 60 fps, target=%dx%d\n", rate, series, seconds, width, width * 9 / 16);
+	printf("%-8s %12s %10s %10s %10s %10s %12s\n", "view", "samples", "frames/sec", "append ms", "render ms", "worst ms", "read/frame");
+	run("all", rate, seconds, series, width, 0);
+	run("follow", rate, seconds, series, width, 1);
+
+	return 0;
+}
+
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,82 @@
+// bench_rects.c
+/**
+ * @detail Shape throughput: one module records N rects/borders/rounded rects
+ * 	that change every frame; frames are rendered to a headless (CPU) target and
+ * 	to an instanced GL core offscreen target (EGL surfaceless, e.g. llvmpipe).
+ * 	Reports frames/sec and shapes/sec per backend.
+ * 	usage: bench_rects [shapes=10000] [frames=100] [size=512]
+ */
+#include "sigui.h"
+#include "sigui_draw.h"
+#include "render.h"
+#include <stdlib.h>
+#include <time.h>
+
+static void bench_render(ui_context, ui_module, ui_input*);
+static double now_sec(void);
+
+static int shapes = 10000;
+static int size = 512;
+static int tick = 0;
+
+static void run(const char* name, render_mode mode, int frames) {
+	render_target t = Render.new_target(mode, size, size);
+	if (!t) {
+		printf("%-10s unavailable\n", name);
+		return;
+	}
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "shapes", bench_render, NULL, Sigui.new_window(ctx, 0, 0, size, size));
+
+	for (int f = 0; f < 3; ++f) {		// warm-up
+		tick++;
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+	}
+
+	double t0 = now_sec();
+	for (int f = 0; f < frames; ++f) {
+		tick++;
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+	}
+	double elapsed = now_sec() - t0;
+	render_stats rs;
+	Render.stats(t, &rs);
+
+	printf("%-10s %12.1f %14.0f %8d\n", name, frames / elapsed, (double)shapes * frames / elapsed, rs.batches);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+
+int main(int argc, char** argv) {
+	shapes = argc > 1 ? atoi(argv[1]) : shapes;
+	int frames = argc > 2 ? atoi(argv[2]) : 100;
+	size = argc > 3 ? atoi(argv[3]) : size;
+
+	printf("shapes=%d frames=%d target=%dx%d\n", shapes, frames, size, size);
+	printf("%-10s %12s %14s %8s\n", "backend", "frames/sec", "shapes/sec", "draws");
+	run("headless", RENDER_HEADLESS, frames);
+	run("offscreen", RENDER_OFFSCREEN, frames);
+
+	return 0;
+}
+
+/* a third each of rects, borders and rounded rects, shifting every frame */
+static void bench_render(ui_context ctx, ui_module m, ui_input* input) {
+	for (int i = 0; i < shapes; ++i) {
+		int x = (i * 37 + tick) % (size - 24);
+		int y = (i * 91) % (size - 24);
+		uint32_t color = UI_RGBA(i * 13, i * 7, i * 3, 0xC0);
+		switch (i % 3) {
+			case 0: Draw.rect(ctx, x, y, 20, 16, color); break;
+			case 1: Draw.border(ctx, x, y, 24, 20, 2, 4, color); break;
+			default: Draw.rounded(ctx, x, y, 24, 24, 8, color); break;
+		}
+	}
+}
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,153 @@
+// bench_remote.c
+/**
+ * @detail Remote streaming over loopback: a grid of modules where one in
+ * 	`active` changes every frame (a moving marker and a counter label) and the
+ * 	rest stay put, as in a dashboard. The server records and sends each frame;
+ * 	a viewer thread replays it into a headless target, moves the pointer and
+ * 	acknowledges, so the server measures the round trip. Runs over a unix
+ * 	socket and TCP; with an address it only serves (connect `sigview` to it).
+ * 	usage: bench_remote [modules=64] [frames=500] [active=8] [address]
+ */
+#include "sigui.h"
+#include "sigui_draw.h"
+#include "sigui_remote.h"
+#include "render.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static void bench_render(ui_context, ui_module, ui_input*);
+static double now_sec(void);
+
+static int active = 8;
+static int cell = 96;
+static int tick = 0;
+static int slot = 0;							/* module being rendered this frame */
+
+typedef struct viewer_job_s {
+	string address;
+	int frames;
+	int size;
+} viewer_job;
+
+/* builds the scene: modules tiled over the target */
+static ui_context scene(int modules, int size) {
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	int per_row = size / cell;
+	for (int i = 0; i < modules; ++i) {
+		int x = (i % per_row) * cell, y = (i / per_row % per_row) * cell;
+		Sigui.add_module(ctx, "cell", bench_render, NULL, Sigui.new_window(ctx, x, y, cell, cell));
+	}
+
+	return ctx;
+}
+/* viewer thread: replay, render and answer with input */
+static void* run_viewer(void* arg) {
+	viewer_job* job = arg;
+	ui_remote viewer = Remote.connect(job->address, job->size, job->size);
+	if (!viewer) return NULL;
+	render_target t = Render.new_target(RENDER_HEADLESS, job->size, job->size);
+	ui_input input = { 0 };
+	for (int received = 0; received < job->frames;) {
+		int n = Remote.receive(viewer, 1000);
+		if (n < 0) break;
+		received += n;
+		Render.frame(t, Remote.context(viewer));
+		input.mouse_x = received % job->size;
+		Remote.send_input(viewer, &input);
+	}
+	Render.free_target(t);
+	Remote.free(viewer);
+
+	return NULL;
+}
+/* streams `frames` frames to one viewer */
+static void stream(string address, int modules, int frames, int size, int local) {
+	ui_context ctx = scene(modules, size);
+	ui_remote server = Remote.serve(ctx, address);
+	if (!server) {
+		printf("%-6s cannot serve %s\n", address, address);
+		Sigui.free_context(ctx);
+		return;
+	}
+	viewer_job job = { Remote.address(server), frames, size };
+	pthread_t thread;
+	if (local) pthread_create(&thread, NULL, run_viewer, &job);
+	else printf("serving %s: connect a viewer (sigview %s %d %d %d)\n", job.address, job.address, size, size, frames);
+
+	ui_input input = { 0 };
+	while (Remote.send(server) == 0) usleep(1000);		// wait for the viewer
+	double t0 = now_sec(), logic = 0;
+	for (int f = 0; f < frames; ++f) {
+		tick++;
+		slot = 0;
+		Remote.input(server, &input);
+		double t1 = now_sec();
+		Sigui.render(ctx, &input);
+		logic += now_sec() - t1;
+		if (Remote.send(server) < 0) break;
+	}
+	//	the last acknowledgements
+	remote_stats st;
+	for (int i = 0; i < 1000; ++i) {
+		Remote.input(server, &input);
+		Remote.stats(server, &st);
+		if (st.acks >= st.frames || !st.connected) break;
+		usleep(1000);
+	}
+	double seconds = now_sec() - t0;
+	Remote.stats(server, &st);
+	double per_frame = st.frames ? (double)st.bytes_out / st.frames : 0;
+	printf("%-6s %8.1f bytes/frame  %7.2f MB/s  raw %.1fx  rtt avg %.1f us, max %.1f us  (%llu frames, %.2f ms/frame, logic %.3f ms)\n",
+			 !strncmp(job.address, "tcp:", 4) ? "tcp" : "unix", per_frame, st.bytes_out / seconds / 1e6,
+			 st.bytes_out ? (double)st.raw_bytes / st.bytes_out : 0.0, st.acks ? 1e-3 * st.latency_total_ns / st.acks : 0.0,
+			 1e-3 * st.latency_max_ns, (unsigned long long)st.frames, 1e3 * seconds / (frames ? frames : 1), 1e3 * logic / (frames ? frames : 1));
+	printf("       records %llu, unchanged %llu, commands %llu (kept %llu), strings %llu (hits %llu), inputs %llu\n",
+			 (unsigned long long)st.modules, (unsigned long long)st.unchanged, (unsigned long long)st.commands,
+			 (unsigned long long)st.kept, (unsigned long long)st.strings, (unsigned long long)st.string_hits, (unsigned long long)st.inputs);
+
+	Remote.free(server);
+	if (local) pthread_join(thread, NULL);
+	Sigui.free_context(ctx);
+}
+
+int main(int argc, char** argv) {
+	int modules = argc > 1 ? atoi(argv[1]) : 64;
+	int frames = argc > 2 ? atoi(argv[2]) : 500;
+	active = argc > 3 ? atoi(argv[3]) : active;
+	int size = 768;
+	printf("modules=%d frames=%d active=%d target=%dx%d\n", modules, frames, active, size, size);
+
+	if (argc > 4) {
+		stream(argv[4], modules, frames, size, 0);
+		return 0;
+	}
+	char path[64];
+	snprintf(path, sizeof(path), "unix:/tmp/bench_remote_%d.sock", (int)getpid());
+	stream(path, modules, frames, size, 1);
+	stream("tcp:127.0.0.1:0", modules, frames, size, 1);
+
+	return 0;
+}
+
+/* a static panel; the active modules move a marker and count frames */
+static void bench_render(ui_context ctx, ui_module m, ui_input* input) {
+	int index = slot++;
+	int live = active > 0 && index % active == tick % active;
+	char label[32];
+	Draw.rect(ctx, 0, 0, cell, cell, 0xFF202830u);
+	Draw.border(ctx, 2, 2, cell - 4, cell - 4, 1, 0, 0xFF5080A0u);
+	for (int i = 0; i < 8; ++i) Draw.rect(ctx, 8, 24 + i * 8, 40 + (index * 7 + i * 13) % 40, 5, 0xFF70A0C0u);
+	Draw.text(ctx, 8, 6, UI_FONT_DEFAULT, "sensor", 0xFFE0E0E0u);
+	snprintf(label, sizeof(label), "%d", live ? tick : index);
+	Draw.text(ctx, 60, 6, UI_FONT_DEFAULT, label, 0xFFFFFF80u);
+	if (live) Draw.rounded(ctx, 8 + tick % (cell - 24), cell - 18, 12, 12, 6, 0xFFFF6040u);
+}
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
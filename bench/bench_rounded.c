@@ -0,0 +1,87 @@
+// bench_rounded.c
+/**
+ * @detail Tessellation throughput: one module records N rounded rects (plus a
+ * 	few borders, lines and shadows) in a handful of sizes that move every
+ * 	frame, so module caches rebuild while the shape meshes are reused. Frames
+ * 	go to a headless (CPU) target and to an instanced GL core offscreen target.
+ * 	Reports frames/sec, shapes/sec and the mesh cache hit rate per backend.
+ * 	usage: bench_rounded [shapes=50000] [frames=20] [size=1024]
+ */
+#include "sigui.h"
+#include "sigui_draw.h"
+#include "render.h"
+#include <stdlib.h>
+#include <time.h>
+
+static void bench_render(ui_context, ui_module, ui_input*);
+static double now_sec(void);
+
+static int shapes = 50000;
+static int size = 1024;
+static int tick = 0;
+
+static void run(const char* name, render_mode mode, int frames) {
+	render_target t = Render.new_target(mode, size, size);
+	if (!t) {
+		printf("%-10s unavailable\n", name);
+		return;
+	}
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "shapes", bench_render, NULL, Sigui.new_window(ctx, 0, 0, size, size));
+
+	for (int f = 0; f < 2; ++f) {		// warm-up
+		tick++;
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+	}
+
+	double t0 = now_sec();
+	for (int f = 0; f < frames; ++f) {
+		tick++;
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+	}
+	double elapsed = now_sec() - t0;
+	render_stats rs;
+	Render.stats(t, &rs);
+
+	uint64_t lookups = rs.mesh_hits + rs.mesh_misses;
+	printf("%-10s %12.1f %14.0f %8d %9.2f%%\n", name, frames / elapsed, (double)shapes * frames / elapsed, rs.meshes,
+			 lookups ? 100.0 * rs.mesh_hits / lookups : 0.0);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+
+int main(int argc, char** argv) {
+	shapes = argc > 1 ? atoi(argv[1]) : shapes;
+	int frames = argc > 2 ? atoi(argv[2]) : 20;
+	size = argc > 3 ? atoi(argv[3]) : size;
+
+	printf("shapes=%d frames=%d target=%dx%d\n", shapes, frames, size, size);
+	printf("%-10s %12s %14s %8s %10s\n", "backend", "frames/sec", "shapes/sec", "meshes", "mesh hits");
+	run("headless", RENDER_HEADLESS, frames);
+	run("offscreen", RENDER_OFFSCREEN, frames);
+
+	return 0;
+}
+
+/* rounded rects in eight sizes, one in sixteen shapes a border, line or shadow */
+static void bench_render(ui_context ctx, ui_module m, ui_input* input) {
+	for (int i = 0; i < shapes; ++i) {
+		int w = 16 + i % 4 * 6, h = 12 + i / 4 % 2 * 8;
+		int x = (i * 37 + tick) % (size - 40);
+		int y = (i * 91) % (size - 40);
+		uint32_t color = UI_RGBA(i * 13, i * 7, i * 3, 0xC0);
+		switch (i % 16) {
+			case 0: Draw.border(ctx, x, y, w, h, 2, 5, color); break;
+			case 1: Draw.line(ctx, x, y, x + w, y + h, 2, color); break;
+			case 2: Draw.shadow(ctx, x, y, w, h, 4, 6, color); break;
+			default: Draw.rounded(ctx, x, y, w, h, 6, color); break;
+		}
+	}
+}
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
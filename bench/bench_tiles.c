@@ -0,0 +1,108 @@
+// bench_tiles.c
+/**
+ * @detail Large images: writes a side x side PPM, converts it to a tiled
+ * 	pyramid, then pans and zooms a viewer over it without waiting for tiles
+ * 	(what an operator sees: tiles pop in as the prefetch thread pages them).
+ * 	Reports conversion time, frames/sec and worst frame per motion, the share
+ * 	of visible tiles shown from a fallback, and the cache size, which must stay
+ * 	at the cap whatever the image size.
+ * 	usage: bench_tiles [side=16384] [frames=600] [cap_mb=64]
+ */
+#include "sigui.h"
+#include "sigui_widgets.h"
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_sec(void);
+
+/* a pattern with detail at every scale */
+static int write_ppm(const char* path, int side) {
+	FILE* f = fopen(path, "wb");
+	if (!f) return -1;
+	fprintf(f, "P6\n%d %d\n255\n", side, side);
+	uint8_t* row = malloc((size_t)side * 3);
+	for (int y = 0; y < side; ++y) {
+		for (int x = 0; x < side; ++x) {
+			row[x * 3] = (uint8_t)(x * 255 / side);
+			row[x * 3 + 1] = (uint8_t)(y * 255 / side);
+			row[x * 3 + 2] = (uint8_t)((x ^ y) & 0xFF);
+		}
+		fwrite(row, 3, side, f);
+	}
+	free(row);
+
+	return fclose(f);
+}
+
+static void run(const char* name, render_target t, ui_context ctx, ui_tileview v, int frames, int zoom) {
+	double total = 0, worst = 0;
+	int64_t visible = 0, fallback = 0;
+	tileview_stats ts = {0};
+	for (int f = 0; f < frames; ++f) {
+		if (zoom) TileView.zoom(v, (f / 60) % 2 ? 0.95 : 1.0 / 0.95, 640, 360);
+		else TileView.pan(v, -24, (f / 100) % 2 ? 8 : -8);
+		double t0 = now_sec();
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+		double dt = now_sec() - t0;
+		total += dt;
+		if (dt > worst) worst = dt;
+		TileView.stats(v, &ts);
+		visible += ts.visible;
+		fallback += ts.fallback;
+	}
+
+	printf("%-8s %10.1f %10.3f %10.1f %8d %10.1f %10llu %10llu\n", name, frames / total, 1e3 * worst,
+			 visible ? 100.0 * fallback / visible : 0.0, ts.resident, ts.bytes / 1048576.0,
+			 (unsigned long long)ts.loaded, (unsigned long long)ts.evicted);
+}
+
+int main(int argc, char** argv) {
+	int side = argc > 1 ? atoi(argv[1]) : 16384;
+	int frames = argc > 2 ? atoi(argv[2]) : 600;
+	int cap = argc > 3 ? atoi(argv[3]) : 64;
+	const char* ppm = "/tmp/sigui_bench_tiles.ppm";
+	const char* path = "/tmp/sigui_bench_tiles.sgt";
+
+	double t0 = now_sec();
+	if (write_ppm(ppm, side) != 0) {
+		printf("cannot write %s\n", ppm);
+		return 1;
+	}
+	double t1 = now_sec();
+	if (TileView.convert(ppm, path, 0) != 0) {
+		printf("cannot convert %s\n", ppm);
+		return 1;
+	}
+	double t2 = now_sec();
+	remove(ppm);
+	printf("image=%dx%d  write ppm %.2f s, convert %.2f s\n", side, side, t1 - t0, t2 - t1);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 1280, 720);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_tileview v = TileView.new(ctx, "viewer", Sigui.new_window(ctx, 0, 0, 1280, 720));
+	TileView.cache(v, (size_t)cap << 20);
+	t0 = now_sec();
+	TileView.open(v, path);
+	printf("open %.3f ms, cap %d MB\n", 1e3 * (now_sec() - t0), cap);
+
+	printf("%-8s %10s %10s %10s %8s %10s %10s %10s\n", "motion", "frames/s", "worst ms", "fallback%", "tiles", "cache MB", "loaded", "evicted");
+	TileView.view(v, side / 2.0, side / 2.0, 1.0);
+	run("pan", t, ctx, v, frames, 0);
+	TileView.view(v, side / 2.0 - 640, side / 2.0 - 360, 1.0);
+	run("zoom", t, ctx, v, frames, 1);
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	remove(path);
+
+	return 0;
+}
+
+static double now_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -9,16 +9,70 @@
 // Use real SDL/OpenGL unless SIMOCK is defined
 #ifndef SIMOCK
 #include <SDL2/SDL.h>
+#define GL_GLEXT_PROTOTYPES		// GL 1.5 buffer objects
 #include <GL/gl.h>
 #else
 #include "sigui_debug.h"
 #endif
 
+/** @brief Render target backends */
+typedef enum {
+	RENDER_WINDOW,					/**< SDL window + OpenGL context */
+	RENDER_HEADLESS,				/**< CPU framebuffer (ARGB8888), no display required */
+	RENDER_OFFSCREEN				/**< GL 3.3 core via EGL surfaceless (e.g. Mesa llvmpipe); instanced, read back to ARGB8888 */
+} render_mode;
+/** @brief Opaque pointer to a render target (one per rendered UI) */
+typedef struct render_target_s* render_target;
+
+/** @brief Per-target render statistics */
+typedef struct render_stats_s {
+	uint64_t frames;				/**< frames presented */
+	uint64_t skipped;				/**< frames skipped because nothing was damaged */
+	int regions;					/**< damage regions redrawn in the last presented frame */
+	long pixels;					/**< pixels redrawn in the last presented frame */
+	int drawn;						/**< modules drawn in the last presented frame */
+	int culled;						/**< modules culled (off target or occluded) in the last presented frame */
+	int batches;					/**< merged (RENDER_WINDOW) or instanced (RENDER_OFFSCREEN) draws in the last presented frame */
+	uint64_t state_changes;		/**< GL state changes issued */
+	uint64_t state_avoided;		/**< redundant GL state changes filtered out */
+	int layers;						/**< resident offscreen layers */
+	size_t layer_bytes;			/**< bytes held by resident layers */
+	uint64_t layer_renders;		/**< layers (re-)rendered */
+	uint64_t layer_evictions;	/**< layers evicted by the budget */
+	int glyphs;						/**< glyphs cached in the atlas */
+	uint64_t glyph_lookups;		/**< atlas lookups (one per laid out glyph) */
+	uint64_t glyph_misses;		/**< glyphs rasterized into the atlas */
+	uint64_t atlas_evictions;	/**< atlas shelves evicted (least recently drawn) */
+	uint64_t atlas_uploads;		/**< atlas uploads (dirty sub-rectangles) */
+	size_t atlas_upload_bytes;	/**< atlas bytes uploaded */
+	int meshes;						/**< shape meshes cached */
+	uint64_t mesh_hits;			/**< shapes that reused a cached mesh */
+	uint64_t mesh_misses;		/**< shapes tessellated */
+	int images;						/**< images cached (RENDER_WINDOW: textures resident or streaming) */
+	size_t image_bytes;			/**< bytes held by image textures */
+	uint64_t image_hits;			/**< image draws the target could draw */
+	uint64_t image_misses;		/**< image draws shown as placeholders (decoding or streaming) */
+	uint64_t image_evictions;	/**< image textures evicted by the budget */
+	size_t image_upload_bytes;	/**< image bytes uploaded */
+	uint64_t image_stall_ns;	/**< time spent uploading image rows */
+} render_stats;
+
 /** @brief Render interface */
 typedef struct IRender {
-    int (*init)(int, int);
-    void (*module)(ui_module);
-    int (*dispose)(const string);
+    int (*init)(int, int);									/**< Initialize the default (windowed) target */
+    void (*module)(ui_module);							/**< Render one module to the default target */
+    int (*dispose)(const string);						/**< Dispose the default target */
+    render_target (*new_target)(render_mode, int, int);	/**< Create an independent render target */
+    void (*free_target)(render_target);				/**< Release a render target */
+    void (*frame)(render_target, ui_context);		/**< Render all enabled modules of a context */
+    const uint32_t* (*pixels)(render_target);		/**< Headless/offscreen framebuffer (NULL for windowed targets) */
+    const string (*status)(render_target);			/**< Last error source of a target (NULL=OK) */
+    void (*stats)(render_target, render_stats*);	/**< Copy a target's statistics */
+    int (*damage)(render_target, ui_rect*, int);	/**< Regions redrawn in the last presented frame */
+    void (*layer_budget)(render_target, size_t);	/**< Resident layer byte budget (least recently used evicted first) */
+    void (*atlas_size)(render_target, int);			/**< Glyph atlas side in pixels (drops cached glyphs) */
+    void (*image_budget)(render_target, size_t);	/**< Resident image texture byte budget (least recently drawn evicted first) */
+    void (*upload_budget)(render_target, size_t);	/**< Image bytes streamed into textures per frame */
 } IRender;
 
 extern const IRender Render;
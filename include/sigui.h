@@ -4,6 +4,14 @@
 
 #include <sigcore.h>
 #include <stdio.h>
+#include "sigui_alloc.h"
+
+/** @brief Strokes of the longest key binding (a chord of up to KEY_CHORD_MAX keys) */
+#define KEY_CHORD_MAX 4
+/** @brief Bytes of one widget state blob */
+#define STATE_BLOB_SIZE 64
+/** @brief Depth of the widget id stack */
+#define STATE_ID_DEPTH 32
 
 //	Forward Declarations ========================================================
 /** @brief Opaque pointer to a sigui context */
@@ -32,17 +40,32 @@ typedef enum {
 	MOUSE_BUTTON_5 = 1 << 4,			// 16
 	MOSUE_BUTTON_6 = 1 << 5,			// 32
 } mouse_button;
+/** @brief Keyboard modifier mask */
+typedef enum {
+	KEY_MOD_NONE = 0,
+	KEY_MOD_SHIFT = 1 << 0,
+	KEY_MOD_CTRL = 1 << 1,
+	KEY_MOD_ALT = 1 << 2,
+	KEY_MOD_SUPER = 1 << 3,
+	KEY_MOD_ALL = 0x0F					/**< every modifier bit (others are ignored) */
+} key_modifier;
 /** @brief Input state for mouse and keyboard */
 typedef struct ui_input_s {
 	int mouse_x, mouse_y;		/**< Mouse position. */
 	uint32_t button;				/**< Mouse button mask */
 	//	[TODO] TASK: update keyboard input similar to mouse updates
 	uint8_t keys[256];			/**< key states: 1 = pressed; 0 = released */
+	uint32_t modifiers;			/**< modifiers held (key_modifier mask) */
 } ui_input;
 struct input_state_s {
 	ui_input* state;
 };
 typedef struct input_state_s* input_state;
+/** @brief Axis aligned rectangle */
+typedef struct ui_rect_s {
+	int x, y;						/**< Position: x, y */
+	int width, height;			/**< Size: width, height */
+} ui_rect;
 /** @brief Window properties (public - heap allocated) */
 struct ui_window_s {
 	int x, y;						/**< Position: x, y */
@@ -59,14 +82,25 @@ struct event_s {
 		} mouse;						/**< Data for mouse events */
 		struct {
 			int key_code;			/**< Key code (if applicable) */
+			uint32_t modifiers;	/**< Modifiers held (key_modifier mask) */
 		} key;						/**< Data for keyboard events */
 	} data;							/**< Union of event specific data */
 };
 typedef struct event_s* event;
+/** @brief Dispatch phase of an event */
+typedef enum {
+	EVENT_PHASE_BROADCAST,				/**< no target: delivered to every enabled module */
+	EVENT_PHASE_CAPTURE,					/**< ancestors of the target, root first (capture handlers) */
+	EVENT_PHASE_TARGET,					/**< the target itself */
+	EVENT_PHASE_BUBBLE					/**< ancestors of the target, parent first */
+} event_phase;
 /** @brief Event info for extensibility */
 struct event_info_s {
-	event e;			/**< The event data */
-	//	extend via ui_module, target, timestamp, etc.
+	event e;							/**< The event data */
+	ui_module target;				/**< Module the event is aimed at (NULL: broadcast; set before queueing to aim it) */
+	ui_module current_target;	/**< Module whose handler is running */
+	event_phase phase;			/**< Phase of the running handler */
+	int stop;						/**< Set by a handler to stop propagation */
 };
 typedef struct event_info_s* event_info;
 /** @brief Command structure for actionable responses */
@@ -76,6 +110,84 @@ struct command_s {
 	void (*execute)(ui_context, ui_module);	/**< Function delegate to executethe command */
 };
 typedef struct command_s* command;
+/** @brief One stroke of a key binding: a key with an exact modifier mask */
+typedef struct key_stroke_s {
+	uint32_t modifiers;							/**< key_modifier mask */
+	int key;											/**< key code (keys[] index) */
+} key_stroke;
+/** @brief Key binding statistics */
+typedef struct keymap_stats_s {
+	int bindings;									/**< bindings registered */
+	int nodes;										/**< nodes of the compiled trie */
+	int slots;										/**< slots of the compiled edge table */
+	uint64_t lookups;								/**< key presses looked up */
+	uint64_t probes;								/**< edge table slots read */
+	uint64_t matched;								/**< bindings completed (commands queued) */
+	int pending;									/**< strokes of the chord in progress */
+} keymap_stats;
+/** @brief Widget id: a hash of the id stack and a label */
+typedef uint64_t ui_id;
+/** @brief Widget state store statistics */
+typedef struct state_stats_s {
+	int live;										/**< state blobs in use */
+	int slots;										/**< hash table slots */
+	int slabs;										/**< blob slabs allocated */
+	uint64_t lookups;								/**< get/find calls */
+	uint64_t probes;								/**< slots read by lookups */
+	uint64_t created;								/**< blobs created */
+	uint64_t collected;							/**< blobs dropped after going untouched */
+} state_stats;
+/** @brief Module tree statistics */
+typedef struct tree_stats_s {
+	int roots;										/**< modules without a parent */
+	uint64_t targeted;							/**< events dispatched along a path */
+	uint64_t broadcast;							/**< events without a target */
+	uint64_t calls;								/**< handler calls */
+	uint64_t stopped;								/**< events a handler stopped */
+	uint64_t tested;								/**< modules visited by hit tests */
+	uint64_t refreshed;							/**< subtree bounds recomputed */
+} tree_stats;
+
+/** @brief Per-module statistics */
+typedef struct module_stats_s {
+	uint64_t frames;				/**< frames the module's callback recorded a draw list */
+	uint64_t retained;			/**< frames skipped because the module declared itself unchanged */
+	uint64_t cache_hits;			/**< presented frames that reused the module's vertex data */
+	uint64_t cache_misses;		/**< presented frames that rebuilt the module's vertex data */
+	int commands;					/**< commands in the current draw list */
+	uint64_t culled;				/**< frames skipped because the module was off screen or occluded */
+	uint64_t paced;				/**< frames skipped because the module was not due at its update rate */
+	uint64_t throttled;			/**< frames skipped by the watchdog */
+	uint64_t render_ns;			/**< time spent in the render callback */
+	uint64_t handler_ns;			/**< time spent in event handlers and commands aimed at the module */
+	uint32_t last_ns;				/**< time charged to the last run (handlers since the previous run included) */
+	uint32_t worst_ns;			/**< longest last_ns */
+	uint64_t over_budget;		/**< runs that exceeded the module's budget */
+	int throttle;					/**< watchdog level: the module runs every 2^throttle frames */
+	int flagged;					/**< kept exceeding its budget (cleared once it fits again) */
+} module_stats;
+/** @brief Per-frame context statistics (last `Sigui.render`) */
+typedef struct frame_stats_s {
+	int modules;					/**< enabled modules with a render callback */
+	int drawn;						/**< modules whose callback ran */
+	int retained;					/**< modules that kept their last draw list */
+	int culled_viewport;			/**< modules outside the viewport */
+	int culled_occluded;			/**< modules fully covered by an opaque window */
+	int primitives;				/**< primitives recorded */
+	int primitives_culled;		/**< primitives dropped by the clip stack */
+	int paced;						/**< modules not due at their update rate */
+	int throttled;					/**< modules skipped by the watchdog */
+	int flagged;					/**< modules flagged by the watchdog */
+	uint64_t callback_ns;		/**< time charged to the modules that ran */
+} frame_stats;
+/** @brief Watchdog action for modules that keep exceeding their budget */
+typedef enum {
+	WATCHDOG_OFF,					/**< measure only */
+	WATCHDOG_FLAG,					/**< flag them (default) */
+	WATCHDOG_THROTTLE				/**< flag them and run them on fewer frames until they fit */
+} watchdog_mode;
+/** @brief Clock in nanoseconds (user data) */
+typedef uint64_t (*ui_clock)(object);
 
 //	Delegates ===================================================================
 /** @brief Render delegate function for modules */
@@ -89,15 +201,20 @@ typedef void (*event_handler)(ui_context, ui_module, event_info);
  * @details Provides methods to intiialize , add modules, render, and clean up a sigui context.
  */
 typedef struct ISigui {
-	ui_context (*new_context)(object);					/**< Creates a new sigui context with user-defined state. */
+	ui_context (*new_context)(object, ui_allocator);	/**< Creates a new sigui context with user-defined state (NULL allocator=Mem). */
 	void (*free_context)(ui_context);					/**< Frees the sigui context and its resources */
-	window (*new_window)(int, int, int, int);			/**< Create a new window. */
+	window (*new_window)(ui_context, int, int, int, int);	/**< Create a new window owned by the context. */
 	ui_module (*add_module)(ui_context, string, 		/**< Adds a module with a name and render function */
 							 		ui_render, event_handler, window);
 	void (*render)(ui_context, ui_input*);				/**< Renders all enabled modules with input */
-	event_info (*new_event)(event_type, ui_input*,	/**< Create a new event */
-									uint32_t);
-	command (*new_command)(const string);				/**< Create a new command */
+	event_info (*new_event)(ui_context, event_type,	/**< Create a new event */
+									ui_input*, uint32_t);
+	command (*new_command)(ui_context, const string);	/**< Create a new command */
+	void (*invalidate)(ui_module);						/**< Marks a module's window dirty for the next frame */
+	void (*damage)(ui_context, ui_rect);				/**< Marks an arbitrary rect dirty for the next frame */
+	void (*stats)(ui_module, module_stats*);			/**< Copy a module's statistics */
+	void (*viewport)(ui_context, ui_rect);				/**< Visible area used for culling (empty=adopt the render target size) */
+	void (*frame_stats)(ui_context, frame_stats*);	/**< Copy the last frame's drawn/culled counts */
 } ISigui;
 /**
  * @brief Interface for the event queuing and dispatching
@@ -109,7 +226,103 @@ typedef struct ISigui {
  	void (*dispatch_commands)(ui_context);			/**< Dispatches all the context's commands */
  } IDispatcher;
  
+/**
+ * @brief Interface for key bindings
+ * @details Bindings map a sequence of up to KEY_CHORD_MAX strokes to a command
+ * 	id. They compile into a trie whose edges (node, modifiers, key) live in one
+ * 	open-addressed hash table, so each key press costs a probe or two however
+ * 	many bindings there are. Bindings scoped to the focused module are tried
+ * 	before global ones. A press that continues a chord, or completes one, is
+ * 	consumed: no key event is queued for it or its release. A completed binding
+ * 	queues its command with the scope module (or the focused module) as target.
+ * 	A stroke that breaks a chord starts over from the roots.
+ */
+typedef struct IKeymap {
+	int (*command)(ui_context, const string, void (*)(ui_context, ui_module));	/**< Register a command (name, execute); returns its id (> 0) or -1 */
+	int (*bind)(ui_context, ui_module, const key_stroke*, int, int);	/**< Bind strokes to a command (scope (NULL: global), strokes, count, id); 0 on success, -1 when one sequence is a prefix of another */
+	int (*unbind)(ui_context, ui_module, const key_stroke*, int);		/**< Remove a binding (scope, strokes, count); 0 on success */
+	int (*compile)(ui_context);												/**< Build the table now (otherwise the next key press after a change does); 0 on success */
+	void (*focus)(ui_context, ui_module);									/**< Module whose scoped bindings come first (NULL: global only) */
+	ui_module (*focused)(ui_context);											/**< Focused module */
+	void (*stats)(ui_context, keymap_stats*);								/**< Copy the key binding statistics */
+} IKeymap;
+
+/**
+ * @brief Interface for the module tree
+ * @details Modules form a forest: add_module creates a root, and attach moves a
+ * 	module (with its subtree) under a parent. Pointer events are aimed at the
+ * 	enabled module drawn last under the pointer (modules draw in the order they
+ * 	were added, whatever their parent; a disabled module hides its subtree from
+ * 	hits); a button release goes to the module that took the press. Only the path from the root to that target is walked:
+ * 	capture handlers root first, then the target's handlers, then the regular
+ * 	handlers back up to the root. A handler sets `event_info->stop` to end the
+ * 	walk. Events without a target (key events, presses that hit no module) are
+ * 	broadcast to every enabled module in order, and stop ends that too. Each
+ * 	module caches the bounds of its subtree; moved windows are picked up at the
+ * 	next dispatch or cull, and only the subtrees that changed are recomputed.
+ */
+typedef struct IModuleTree {
+	int (*attach)(ui_module, ui_module);				/**< Move a module under a parent (parent, child; NULL parent: root); 0 on success, -1 on a cycle */
+	ui_module (*parent)(ui_module);						/**< Parent (NULL: root) */
+	int (*children)(ui_module);							/**< Child count */
+	ui_module (*child)(ui_module, int);					/**< Child at an index (NULL: out of range) */
+	void (*capture)(ui_module, event_handler);		/**< Handler run on the way down to a descendant target */
+	ui_module (*hit)(ui_context, int, int);			/**< Deepest enabled module containing a point (NULL: none) */
+	ui_rect (*bounds)(ui_module);							/**< On-screen bounds of a module and its descendants */
+	void (*stats)(ui_context, tree_stats*);			/**< Copy the module tree statistics */
+} IModuleTree;
+
+/**
+ * @brief Interface for persistent widget state
+ * @details Immediate-mode widgets keep state across frames (scroll offsets,
+ * 	open flags, cursors) in STATE_BLOB_SIZE-byte blobs keyed by a widget id.
+ * 	An id hashes a label with the top of the id stack; while a module's render
+ * 	callback runs the stack is seeded with the module, so equal labels in two
+ * 	modules do not collide. `get` returns the blob of an id (zeroed when it is
+ * 	created) and marks it used this frame; a blob stays at the same address
+ * 	until it is dropped. Blobs left untouched for `keep` frames are dropped by
+ * 	a sweep that visits a bounded number of slots per frame. Once the table and
+ * 	slabs have grown to the working set, lookups do not allocate.
+ */
+typedef struct IWidgetState {
+	ui_id (*id)(ui_context, const string);						/**< Id of a label under the id stack */
+	ui_id (*id_data)(ui_context, const void*, size_t);		/**< Id of raw bytes under the id stack */
+	int (*push)(ui_context, ui_id);								/**< Push an id as the scope of the next ids; 0 on success, -1 when full */
+	void (*pop)(ui_context);										/**< Pop the innermost scope */
+	object (*get)(ui_context, ui_id, int*);					/**< Blob of an id, created zeroed if missing (created flag); NULL when out of memory */
+	object (*find)(ui_context, ui_id);							/**< Blob of an id, or NULL (not created) */
+	void (*forget)(ui_context, ui_id);							/**< Drop an id's blob now */
+	void (*keep)(ui_context, int);								/**< Frames an untouched blob survives (<= 0: default) */
+	void (*stats)(ui_context, state_stats*);					/**< Copy the store statistics */
+} IWidgetState;
+
+/**
+ * @brief Interface for module update rates and time budgets
+ * @details Every render callback, and every handler or command aimed at a
+ * 	module, is timed. A module with an update rate runs only when it is due;
+ * 	on other frames it keeps its last draw list, as a retained module does.
+ * 	A module with a budget is checked each time it runs: the time charged to it
+ * 	(the callback plus the handlers since its last run) over the budget counts
+ * 	a strike, and `strikes` strikes in a row flag it. Under WATCHDOG_THROTTLE a
+ * 	flagged module also runs on every second frame, then every fourth, and so
+ * 	on, each level granting it its budget times the frames it covers; it steps
+ * 	back down once it would fit the level below for `strikes` runs in a row.
+ * 	A module without a draw list, or with more of it visible than it recorded,
+ * 	runs even when it is not due.
+ */
+typedef struct IBudget {
+	void (*rate)(ui_module, double);								/**< Target update rate in Hz (<= 0: every frame) */
+	void (*budget)(ui_module, int);								/**< Time budget per frame in microseconds (<= 0: none) */
+	void (*watchdog)(ui_context, watchdog_mode, int);		/**< Watchdog action and strikes before it acts (<= 0: default) */
+	void (*clock)(ui_context, ui_clock, object);				/**< Clock for rates and timings (NULL: monotonic) */
+	int (*flagged)(ui_context, ui_module*, int);				/**< Copy up to max flagged modules; returns how many are flagged */
+} IBudget;
+
 extern const ISigui Sigui;							/**< Global Sigui interface instance */
 extern const IDispatcher Dispatcher;			/**< Global Dispatcher interface instance */
+extern const IKeymap Keymap;						/**< Global Keymap interface instance */
+extern const IModuleTree ModuleTree;			/**< Global ModuleTree interface instance */
+extern const IWidgetState WidgetState;			/**< Global WidgetState interface instance */
+extern const IBudget Budget;						/**< Global Budget interface instance */
 
 #endif // SIGUI_H
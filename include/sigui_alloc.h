@@ -0,0 +1,69 @@
+// sigui_alloc.h
+#ifndef SIGUI_ALLOC_H
+#define SIGUI_ALLOC_H
+
+#include <sigcore.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//	Types =======================================================================
+/** @brief Subsystem tags; every allocation is accounted against one of these */
+typedef enum {
+	ALLOC_CONTEXT,
+	ALLOC_MODULE,
+	ALLOC_WINDOW,
+	ALLOC_EVENT,
+	ALLOC_COMMAND,
+	ALLOC_STRING,
+	ALLOC_DRAW,
+	ALLOC_TEXT,
+	ALLOC_WIDGET,
+	ALLOC_KEYMAP,
+	ALLOC_TREE,
+	ALLOC_FLEX,
+	ALLOC_STATE,
+	ALLOC_STYLE,
+	ALLOC_PIPELINE,
+	ALLOC_REMOTE,
+	ALLOC_TAG_COUNT				/**< number of tags (not a tag) */
+} alloc_tag;
+/** @brief Opaque pointer to an allocator */
+typedef struct ui_allocator_s* ui_allocator;
+/** @brief Allocator vtable; `begin_frame`/`end_frame` are optional (may be NULL) */
+struct ui_allocator_s {
+	object (*alloc)(ui_allocator, size_t, alloc_tag);	/**< allocate zeroed memory */
+	void (*free)(ui_allocator, object, alloc_tag);		/**< release memory */
+	void (*begin_frame)(ui_allocator);						/**< frame start notification */
+	void (*end_frame)(ui_allocator, int);					/**< frame end notification (1=steady-state frame) */
+	object user;													/**< implementation defined state */
+};
+/** @brief Allocation statistics for one subsystem (or the total) */
+typedef struct alloc_stats_s {
+	size_t live_bytes;			/**< bytes currently allocated */
+	size_t peak_bytes;			/**< high water mark of live_bytes */
+	size_t allocs;					/**< total number of allocations */
+	size_t frees;					/**< total number of frees */
+	size_t frame_allocs;			/**< allocations made during the last completed frame */
+} alloc_stats;
+/** @brief Strict mode violation handler: (allocator, frame number, allocations in frame) */
+typedef void (*alloc_violation)(ui_allocator, size_t, size_t);
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for context allocators
+ * @details `standard` forwards to sigcore `Mem`. A tracking allocator wraps a parent
+ * 	allocator and records per-subsystem live/peak bytes and per-frame allocations.
+ * 	A block must be freed by the allocator that made it.
+ */
+typedef struct IAllocator {
+	ui_allocator (*standard)(void);										/**< The default (sigcore Mem) allocator */
+	ui_allocator (*new_tracking)(ui_allocator);						/**< Create a tracking allocator over a parent (NULL=standard) */
+	void (*free_tracking)(ui_allocator);								/**< Free a tracking allocator */
+	int (*stats)(ui_allocator, alloc_tag, alloc_stats*);			/**< Stats for a tag; ALLOC_TAG_COUNT=totals; 0 on success */
+	void (*set_strict)(ui_allocator, size_t, alloc_violation);	/**< Fail when a steady frame allocates after N warm-up frames */
+	string (*tag_name)(alloc_tag);										/**< Printable subsystem name */
+} IAllocator;
+
+extern const IAllocator Allocator;			/**< Global Allocator interface instance */
+
+#endif // SIGUI_ALLOC_H
@@ -34,12 +34,90 @@ void glBegin(uint32_t mode);
 void glVertex2i(int x, int y);
 void glEnd(void);
 void glColor3f(float r, float g, float b);
+void glScissor(int x, int y, int w, int h);
+void glEnable(uint32_t cap);
+void glDisable(uint32_t cap);
+
+typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+typedef int GLsizei;
+
+void glGenBuffers(GLsizei n, GLuint* buffers);
+void glDeleteBuffers(GLsizei n, const GLuint* buffers);
+void glBindBuffer(GLenum target, GLuint buffer);
+void glBufferData(GLenum target, long size, const void* data, GLenum usage);
+void glEnableClientState(GLenum array);
+void glDisableClientState(GLenum array);
+void glVertexPointer(int size, GLenum type, GLsizei stride, const void* ptr);
+void glColorPointer(int size, GLenum type, GLsizei stride, const void* ptr);
+void glDrawArrays(GLenum mode, int first, GLsizei count);
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void glBufferSubData(GLenum target, long offset, long size, const void* data);
+void glGenTextures(GLsizei n, GLuint* textures);
+void glDeleteTextures(GLsizei n, const GLuint* textures);
+void glBindTexture(GLenum target, GLuint texture);
+void glTexParameteri(GLenum target, GLenum name, int value);
+void glTexImage2D(GLenum target, int level, int internal, GLsizei w, GLsizei h, int border, GLenum format, GLenum type, const void* data);
+void glGenFramebuffers(GLsizei n, GLuint* framebuffers);
+void glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void glBindFramebuffer(GLenum target, GLuint framebuffer);
+void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, int level);
+void glViewport(int x, int y, GLsizei w, GLsizei h);
+void glBlendFunc(GLenum sfactor, GLenum dfactor);
+void glColor4ub(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+void glTexCoord2f(float s, float t);
+void glTexCoordPointer(int size, GLenum type, GLsizei stride, const void* ptr);
+void glTexSubImage2D(GLenum target, int level, int x, int y, GLsizei w, GLsizei h, GLenum format, GLenum type, const void* data);
+void glPixelStorei(GLenum name, int value);
+
+#define GL_SCISSOR_TEST 0x0C11
+#define GL_COLOR_BUFFER_BIT 0x4000
+#define GL_QUADS 0x0007
+#define GL_FLOAT 0x1406
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_VERTEX_ARRAY 0x8074
+#define GL_COLOR_ARRAY 0x8076
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_TRIANGLES 0x0004
+#define GL_UNSIGNED_INT 0x1405
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_NEAREST 0x2600
+#define GL_LINEAR 0x2601
+#define GL_RGBA 0x1908
+#define GL_BGRA 0x80E1
+#define GL_RGBA8 0x8058
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_BLEND 0x0BE2
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_TEXTURE_COORD_ARRAY 0x8078
+#define GL_ALPHA 0x1906
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#define GL_UNPACK_ALIGNMENT 0x0CF5
 
 extern int mock_sdl_init_called;
 extern int mock_sdl_window_created;
 extern int mock_gl_context_created;
 extern int mock_gl_begin_called;
 extern int mock_gl_end_called;
+extern int mock_gl_scissor_called;
+extern int mock_swap_called;
+extern int mock_gl_buffer_uploads;
+extern int mock_gl_draw_calls;
+extern int mock_gl_fbo_binds;
+extern int mock_gl_layers_live;
+extern int mock_gl_index_uploads;
+extern int mock_gl_state_calls;
+extern int mock_gl_state_avoided;
+extern int mock_gl_texture_uploads;
+extern long mock_gl_texture_bytes;
+extern int mock_gl_textures_live;
 #endif // SIMOCK
 
 #endif // SIGUI_DEBUG_H
@@ -0,0 +1,163 @@
+// sigui_draw.h
+#ifndef SIGUI_DRAW_H
+#define SIGUI_DRAW_H
+
+#include "sigui.h"
+
+/** @brief Packs an ARGB8888 color */
+#define UI_RGBA(r, g, b, a) (((uint32_t)(a) << 24) | ((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(b))
+/** @brief Packs an opaque ARGB8888 color */
+#define UI_RGB(r, g, b) UI_RGBA(r, g, b, 0xFF)
+/** @brief Built-in 8x16 bitmap font (ASCII) */
+#define UI_FONT_DEFAULT 0
+
+//	Types =======================================================================
+/** @brief Draw command kinds */
+typedef enum {
+	DRAW_RECT,						/**< filled rectangle */
+	DRAW_BORDER,					/**< rectangle outline (optionally rounded) */
+	DRAW_ROUNDED,					/**< filled rectangle with rounded corners */
+	DRAW_TEXT,						/**< UTF-8 text run */
+	DRAW_LINE,						/**< anti-aliased line segment */
+	DRAW_SHADOW,					/**< soft (blurred) rounded rect */
+	DRAW_IMAGE						/**< decoded image scaled into a rect */
+} draw_kind;
+/** @brief Font handle (UI_FONT_DEFAULT or a handle returned by `Font.load`) */
+typedef int ui_font;
+/** @brief Image handle returned by `Image.load`/`Image.decode` (0=none) */
+typedef int ui_image;
+/** @brief Image decode states */
+typedef enum {
+	IMAGE_NONE,						/**< unknown or freed handle */
+	IMAGE_PENDING,					/**< queued or decoding on a worker thread */
+	IMAGE_READY,					/**< decoded */
+	IMAGE_FAILED					/**< unreadable or unsupported data */
+} image_state;
+/** @brief A recorded draw command (window-local coordinates; no padding - hashed as bytes) */
+typedef struct draw_cmd_s {
+	uint32_t kind;					/**< draw_kind */
+	uint32_t color;				/**< ARGB8888 */
+	ui_rect rect;					/**< bounds relative to the module window (DRAW_RECT: already clipped) */
+	ui_rect clip;					/**< clip rect the command was recorded under */
+	uint16_t radius;				/**< corner radius (0=square) */
+	uint16_t border;				/**< DRAW_BORDER: outline width; DRAW_LINE: width; DRAW_SHADOW: blur */
+	uint32_t text;					/**< DRAW_TEXT: offset of the run in the list's text buffer */
+	uint32_t length;				/**< DRAW_TEXT: run bytes */
+	int32_t font;					/**< DRAW_TEXT: ui_font */
+	int32_t points[4];			/**< DRAW_LINE: x0, y0, x1, y1 (window-local pixel centers) */
+	int32_t image;					/**< DRAW_IMAGE: ui_image (color: placeholder) */
+} draw_cmd;
+/** @brief Text layout cache statistics of a context */
+typedef struct text_stats_s {
+	int entries;					/**< cached layouts */
+	size_t bytes;					/**< arena bytes holding them */
+	uint64_t hits;					/**< lookups answered from the cache */
+	uint64_t misses;				/**< layouts shaped from scratch */
+	uint64_t rewraps;				/**< layouts re-broken from a cached layout of the same text (wrap width changed) */
+	uint64_t lines_reused;		/**< lines rewraps kept unchanged */
+	uint64_t evictions;			/**< layouts dropped after going unused */
+} text_stats;
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for emitting geometry from `ui_render` callbacks
+ * @details Commands are recorded into the module's draw list and hashed as they are
+ * 	emitted. When a list hashes the same as last frame (and the window did not move)
+ * 	the renderer reuses the module's previously built vertex data. Primitives are
+ * 	clipped to the clip stack, whose base is the visible part of the window;
+ * 	primitives entirely outside it are dropped before any vertex work.
+ * 	Borders, rounded rects, lines and shadows are tessellated into triangles with
+ * 	a one-pixel coverage ramp on their edges (anti-aliasing); meshes are cached
+ * 	by shape, so identical shapes only translate their geometry.
+ */
+typedef struct IDraw {
+	void (*rect)(ui_context, int, int, int, int, uint32_t);	/**< Filled rect (x, y, w, h, ARGB) */
+	void (*border)(ui_context, int, int, int, int, int, int, uint32_t);	/**< Outline (x, y, w, h, width, radius, ARGB) */
+	void (*rounded)(ui_context, int, int, int, int, int, uint32_t);		/**< Rounded rect (x, y, w, h, radius, ARGB) */
+	void (*line)(ui_context, int, int, int, int, int, uint32_t);			/**< Line between pixel centers (x0, y0, x1, y1, width, ARGB) */
+	void (*shadow)(ui_context, int, int, int, int, int, int, uint32_t);	/**< Shadow of a rounded rect (x, y, w, h, radius, blur, ARGB) */
+	void (*text)(ui_context, int, int, ui_font, const char*, uint32_t);	/**< UTF-8 text at its top-left corner (x, y, font, text, ARGB); '\n' starts a line */
+	void (*image)(ui_context, int, int, int, int, ui_image, uint32_t);	/**< Image scaled into a rect (x, y, w, h, image, placeholder ARGB shown until it is ready) */
+	int (*paragraph)(ui_context, int, int, int, ui_font, const char*, uint32_t);	/**< Text wrapped at spaces (x, y, wrap width, font, text, ARGB); returns its height */
+	int (*push_clip)(ui_context, int, int, int, int);			/**< Push a clip rect (intersected with the current one); 0 on success */
+	void (*pop_clip)(ui_context);										/**< Pop the last pushed clip rect */
+	void (*retain)(ui_module, int);									/**< 1: skip the callback and reuse the last draw list */
+	int (*count)(ui_module);											/**< Commands in the module's current draw list */
+} IDraw;
+
+extern const IDraw Draw;					/**< Global Draw interface instance */
+
+/**
+ * @brief Interface for rendering a module into its own offscreen layer
+ * @details A layered module's draw list is rendered into a layer (an FBO on window
+ * 	targets, a pixel buffer on headless targets) only when the list changes; the
+ * 	layer is composited every frame. Scrolling, translating or fading a layer
+ * 	re-composites it without calling the module back or re-rendering the layer.
+ * 	Resident layers are bounded per target by `Render.layer_budget` (LRU).
+ */
+typedef struct ILayer {
+	void (*enable)(ui_module, int, int);		/**< Render into a (w, h) layer; <= 0 follows the window size */
+	void (*disable)(ui_module);					/**< Draw directly again */
+	void (*scroll)(ui_module, int, int);		/**< Layer pixel shown at the window origin */
+	void (*translate)(ui_module, int, int);	/**< Composite offset from the window position */
+	void (*opacity)(ui_module, uint8_t);		/**< Composite opacity (255=opaque) */
+} ILayer;
+
+extern const ILayer Layer;					/**< Global Layer interface instance */
+
+/**
+ * @brief Interface for fonts used by `Draw.text`
+ * @details UI_FONT_DEFAULT is a built-in 8x16 bitmap font covering ASCII. TrueType
+ * 	fonts load when sigui is built with FreeType (`make FREETYPE=1`); otherwise
+ * 	`load` fails. Glyphs are rasterized on first use into each render target's
+ * 	glyph atlas, so fonts must outlive the frames that draw with them.
+ */
+typedef struct IFont {
+	ui_font (*load)(const char*, int);						/**< Load a TrueType font at a pixel height (-1=failure) */
+	void (*free)(ui_font);										/**< Release a loaded font */
+	int (*measure)(ui_font, const char*, int*, int*);	/**< Text extent (width, height); 0 on success */
+	int (*height)(ui_font);										/**< Line height in pixels (0=invalid font) */
+} IFont;
+
+extern const IFont Font;						/**< Global Font interface instance */
+
+/**
+ * @brief Interface for the text layout cache of a context
+ * @details `Draw.text`, `Draw.paragraph` and `measure` look text up by (text hash,
+ * 	font, wrap width); the font handle carries the size. A layout holds the shaped
+ * 	glyph positions and the line breaks. When only the wrap width changes, the
+ * 	cached glyphs are re-broken and lines whose break still holds are kept.
+ * 	Layouts unused for `keep` frames are dropped when the cache is swept.
+ */
+typedef struct IText {
+	int (*measure)(ui_context, ui_font, const char*, int, int*, int*);	/**< Extent wrapped at a width (<= 0: no wrap) (width, height); 0 on success */
+	void (*keep)(ui_context, int);												/**< Frames an unused layout stays cached (default 60) */
+	void (*stats)(ui_context, text_stats*);									/**< Copy the cache statistics */
+} IText;
+
+extern const IText Text;						/**< Global Text interface instance */
+
+/**
+ * @brief Interface for images drawn with `Draw.image`
+ * @details PPM (P5/P6, 8-bit) and QOI images decode on a small pool of worker
+ * 	threads; `Draw.image` shows its placeholder color until an image is decoded
+ * 	and, on window targets, streamed into a texture within the target's per-frame
+ * 	upload budget (`Render.upload_budget`). Textures are evicted least recently
+ * 	drawn first under `Render.image_budget`. A freed handle stays invalid (its
+ * 	slot is reused under a new handle). Any thread may free an image, also while
+ * 	a render thread (`Pipeline`) draws or uploads it: later frames show the
+ * 	placeholder, and the pixels are released once the renderer is done with them.
+ */
+typedef struct IImage {
+	ui_image (*load)(const char*);						/**< Queue a PPM or QOI file for decoding (0=failure) */
+	ui_image (*decode)(const void*, size_t);		/**< Queue in-memory PPM or QOI data (copied) for decoding (0=failure) */
+	void (*free)(ui_image);								/**< Release an image from any thread (a decode in progress is dropped) */
+	image_state (*state)(ui_image);					/**< Decode state */
+	int (*size)(ui_image, int*, int*);				/**< Decoded size (width, height); 0 on success */
+	int (*wait)(ui_image);								/**< Block until decoded; 0 when ready */
+	void (*workers)(int);								/**< Decoder threads (default 2; set before the first image) */
+} IImage;
+
+extern const IImage Image;						/**< Global Image interface instance */
+
+#endif // SIGUI_DRAW_H
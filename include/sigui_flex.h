@@ -0,0 +1,79 @@
+// sigui_flex.h
+#ifndef SIGUI_FLEX_H
+#define SIGUI_FLEX_H
+
+#include "sigui.h"
+
+/** @brief Id of the root node (sized by `Flex.resize`) */
+#define FLEX_ROOT 0
+
+//	Types =======================================================================
+/** @brief Main axis of a node's children */
+typedef enum {
+	FLEX_ROW,								/**< left to right */
+	FLEX_COLUMN								/**< top to bottom */
+} flex_direction;
+/** @brief Main axis placement of leftover space (when no child grows) */
+typedef enum {
+	FLEX_JUSTIFY_START,
+	FLEX_JUSTIFY_CENTER,
+	FLEX_JUSTIFY_END,
+	FLEX_JUSTIFY_SPACE_BETWEEN
+} flex_justify;
+/** @brief Cross axis placement of children */
+typedef enum {
+	FLEX_ALIGN_STRETCH,					/**< fill the cross axis (unless the child has a cross size) */
+	FLEX_ALIGN_START,
+	FLEX_ALIGN_CENTER,
+	FLEX_ALIGN_END
+} flex_align;
+/** @brief Layout style of a node (zeroed: a content-sized row) */
+typedef struct flex_style_s {
+	flex_direction direction;			/**< main axis of the children */
+	flex_justify justify;				/**< main axis placement of leftover space */
+	flex_align align;						/**< cross axis placement of the children */
+	int padding[4];						/**< left, top, right, bottom */
+	int gap;									/**< space between children */
+	int width, height;					/**< preferred size (0: content) */
+	int min_width, min_height;			/**< lower bounds */
+	int max_width, max_height;			/**< upper bounds (0: none) */
+	float grow;								/**< share of the parent's free main axis space (0: none) */
+	float shrink;							/**< share of the parent's overflow, weighted by size (0: none) */
+} flex_style;
+/** @brief Layout statistics (counts are for the last update) */
+typedef struct flex_stats_s {
+	int nodes;								/**< live nodes */
+	int measured;							/**< nodes whose size was re-measured */
+	int arranged;							/**< nodes whose children were re-placed */
+	int moved;								/**< nodes shifted without re-placing their children */
+	int written;							/**< module windows written */
+	uint64_t updates;						/**< updates that had work to do */
+} flex_stats;
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for flex layout of module windows
+ * @details Each context has one layout tree whose nodes live in a flat array.
+ * 	A node sizes itself from its style and content, then places its children
+ * 	along its main axis: free space goes to growing children, overflow is taken
+ * 	from shrinking ones, and the cross axis is stretched or aligned. A node
+ * 	given a module writes its rect into the module's window.
+ * 	Changes only mark nodes: the next update (`Sigui.render` runs one after
+ * 	commands) re-measures the changed nodes and the ancestors whose size they
+ * 	affect, re-places the children of the boxes that changed, and shifts
+ * 	subtrees that only moved. Untouched subtrees are not visited.
+ */
+typedef struct IFlex {
+	int (*node)(ui_context, int, const flex_style*, ui_module);		/**< Append a node (parent, style (NULL: zeroed), module (NULL: none)); returns its id or -1 */
+	int (*remove)(ui_context, int);											/**< Remove a node with its subtree (not the root); 0 on success */
+	int (*style)(ui_context, int, const flex_style*);					/**< Replace a node's style; 0 on success */
+	int (*content)(ui_context, int, int, int);							/**< Content size of a childless node (width, height); 0 on success */
+	void (*resize)(ui_context, int, int);									/**< Size of the root (<= 0: its measured size) */
+	int (*update)(ui_context);													/**< Lay out pending changes now; returns the nodes re-placed */
+	ui_rect (*rect)(ui_context, int);										/**< Rect of a node at the last update */
+	void (*stats)(ui_context, flex_stats*);								/**< Copy the layout statistics */
+} IFlex;
+
+extern const IFlex Flex;					/**< Global Flex interface instance */
+
+#endif // SIGUI_FLEX_H
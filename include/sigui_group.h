@@ -0,0 +1,32 @@
+// sigui_group.h
+#ifndef SIGUI_GROUP_H
+#define SIGUI_GROUP_H
+
+#include "sigui.h"
+#include "render.h"
+
+//	Types =======================================================================
+/** @brief Opaque pointer to a context group */
+typedef struct ui_group_s* ui_group;
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for stepping many independent contexts in parallel
+ * @details Each member pairs a context with its own render target (typically
+ * 	RENDER_HEADLESS). `step` runs `Sigui.render` + `Render.frame` for every member
+ * 	once, spread over a fixed thread pool, and returns when all members are done.
+ * 	Members must not share contexts or targets; the group is not re-entrant.
+ */
+typedef struct IGroup {
+	ui_group (*new)(int);											/**< Create a group stepping on N threads (<=0: one per core) */
+	void (*free)(ui_group);											/**< Stop the pool and free the group (members are not freed) */
+	int (*add)(ui_group, ui_context, render_target);		/**< Add a member; returns its index or -1 */
+	void (*set_input)(ui_group, int, ui_input*);				/**< Set (copy) the input for a member's next step; NULL clears */
+	void (*step)(ui_group);											/**< Step every member once */
+	int (*count)(ui_group);											/**< Number of members */
+	int (*threads)(ui_group);										/**< Number of stepping threads (including the caller) */
+} IGroup;
+
+extern const IGroup Group;					/**< Global Group interface instance */
+
+#endif // SIGUI_GROUP_H
@@ -0,0 +1,51 @@
+// sigui_pipeline.h
+#ifndef SIGUI_PIPELINE_H
+#define SIGUI_PIPELINE_H
+
+#include "sigui.h"
+#include "render.h"
+
+#define PIPELINE_MAX_DEPTH 4				/**< most frame packets in flight */
+
+//	Types =======================================================================
+/** @brief Opaque pointer to a frame pipeline */
+typedef struct ui_pipeline_s* ui_pipeline;
+/** @brief Pipeline statistics */
+typedef struct pipeline_stats_s {
+	int depth;										/**< frame packets */
+	uint64_t frames;								/**< frames queued */
+	uint64_t presented;							/**< frames the render thread finished */
+	uint64_t stalls;								/**< frames that waited for a free packet */
+	uint64_t stall_ns;							/**< time spent waiting for a free packet */
+	uint64_t logic_ns;							/**< time spent in `Sigui.render` */
+	uint64_t render_ns;							/**< time spent in `Render.frame` (render thread) */
+	uint64_t copied;								/**< draw lists copied into packets */
+	uint64_t shared;								/**< draw lists a packet already held */
+} pipeline_stats;
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for pipelined frames
+ * @details A pipeline overlaps the logic of one frame with the rendering of
+ * 	the previous one. `frame` runs `Sigui.render` (events, commands, layout and
+ * 	module callbacks) on the calling thread, then copies what the renderer
+ * 	reads (windows, layer options, draw lists, damage) into a frame packet and
+ * 	queues it; a render thread takes packets in order and runs `Render.frame`
+ * 	on them. Each module has one draw list per packet, and a packet that
+ * 	already holds a module's current list does not copy it again. When every
+ * 	packet is queued, `frame` waits for the render thread.
+ * 	While a pipeline runs, the context must only be rendered through it and
+ * 	the target must only be used by it; call `flush` before reading the target
+ * 	(pixels, stats). Free the pipeline before its context and target.
+ */
+typedef struct IPipeline {
+	ui_pipeline (*new)(ui_context, render_target, int);	/**< Create a pipeline with N packets (<= 0: 2, at most PIPELINE_MAX_DEPTH); NULL on failure */
+	void (*free)(ui_pipeline);										/**< Present the queued frames, stop the render thread and free the pipeline */
+	void (*frame)(ui_pipeline, ui_input*);						/**< Run the logic of the next frame and queue it for rendering */
+	void (*flush)(ui_pipeline);									/**< Wait until every queued frame is presented */
+	void (*stats)(ui_pipeline, pipeline_stats*);				/**< Copy the pipeline statistics */
+} IPipeline;
+
+extern const IPipeline Pipeline;				/**< Global Pipeline interface instance */
+
+#endif // SIGUI_PIPELINE_H
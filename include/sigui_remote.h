@@ -0,0 +1,65 @@
+// sigui_remote.h
+#ifndef SIGUI_REMOTE_H
+#define SIGUI_REMOTE_H
+
+#include "sigui.h"
+
+#define REMOTE_STRING_MAX 4096				/**< interned strings before both ends start over */
+
+//	Types =======================================================================
+/** @brief Opaque pointer to a remote endpoint (server or viewer) */
+typedef struct ui_remote_s* ui_remote;
+/** @brief Remote endpoint statistics */
+typedef struct remote_stats_s {
+	int connected;									/**< a peer is connected */
+	uint64_t frames;								/**< frames sent (server) or applied (viewer) */
+	uint64_t bytes_out;							/**< bytes written to the socket */
+	uint64_t bytes_in;							/**< bytes read from the socket */
+	uint64_t raw_bytes;							/**< server: bytes of the full draw lists the frames described */
+	uint64_t modules;								/**< module records sent or applied */
+	uint64_t unchanged;							/**< server: modules left out as unchanged */
+	uint64_t commands;							/**< draw commands sent or applied */
+	uint64_t kept;									/**< draw commands reused from a module's previous list */
+	uint64_t strings;								/**< strings interned */
+	uint64_t string_hits;						/**< text runs sent as an interned string id */
+	uint64_t inputs;								/**< input messages sent (viewer) or applied (server) */
+	uint64_t acks;									/**< server: frames the viewer acknowledged */
+	uint64_t latency_ns;							/**< server: last round trip (send, replay, acknowledge) */
+	uint64_t latency_max_ns;					/**< server: longest round trip */
+	uint64_t latency_total_ns;					/**< server: sum of round trips (average: / acks) */
+} remote_stats;
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for streaming a context to a viewer over a socket
+ * @details A server endpoint streams its context after each `Sigui.render`:
+ * 	per module, only what changed since the frame the viewer last received
+ * 	(window, enabled flag, layer options, draw list). A changed draw list is
+ * 	sent as the commands between the prefix and suffix it shares with the
+ * 	previous one, varint-encoded and delta-coded against the command before
+ * 	it; text runs are interned, so a string crosses the wire once. Images are
+ * 	sent as their placeholder rects. A viewer endpoint applies the frames to a
+ * 	replica context that any render target can draw with `Render.frame`, sends
+ * 	`ui_input` changes back, and acknowledges each frame so the server can
+ * 	measure the round trip. Addresses are "unix:<path>" or "tcp:<host>:<port>"
+ * 	(port 0 picks a free port; see `address`). A server takes one viewer at a
+ * 	time; a new viewer is sent the whole state. Sends block while the socket
+ * 	is full; reads never block unless `receive` is asked to wait. A message
+ * 	longer than 64 MiB or one that does not decode drops the connection.
+ */
+typedef struct IRemote {
+	ui_remote (*serve)(ui_context, const string);				/**< Server: listen on an address; NULL on failure */
+	ui_remote (*connect)(const string, int, int);				/**< Viewer: connect (address, target width, height); NULL on failure */
+	void (*free)(ui_remote);											/**< Close the endpoint (a viewer's replica context too) */
+	const string (*address)(ui_remote);							/**< Bound or connected address */
+	int (*send)(ui_remote);												/**< Server: stream the current frame; bytes written, 0 without a viewer, -1 on error */
+	int (*input)(ui_remote, ui_input*);							/**< Server: copy the viewer's input when it changed; 1 when copied */
+	int (*receive)(ui_remote, int);									/**< Viewer: apply the frames received, waiting up to ms for one; frames applied, -1 when closed */
+	ui_context (*context)(ui_remote);								/**< Viewer: replica context (render it with `Render.frame`, not `Sigui.render`) */
+	int (*send_input)(ui_remote, const ui_input*);				/**< Viewer: send what changed since the last input; bytes written, -1 on error */
+	void (*stats)(ui_remote, remote_stats*);						/**< Copy the endpoint statistics */
+} IRemote;
+
+extern const IRemote Remote;					/**< Global Remote interface instance */
+
+#endif // SIGUI_REMOTE_H
@@ -0,0 +1,83 @@
+// sigui_style.h
+#ifndef SIGUI_STYLE_H
+#define SIGUI_STYLE_H
+
+#include "sigui.h"
+#include "sigui_draw.h"
+
+//	Types =======================================================================
+/** @brief Widget state bits a rule can require */
+typedef enum {
+	STYLE_STATE_NONE = 0,
+	STYLE_STATE_HOVER = 1 << 0,
+	STYLE_STATE_PRESSED = 1 << 1,
+	STYLE_STATE_FOCUSED = 1 << 2,
+	STYLE_STATE_SELECTED = 1 << 3,
+	STYLE_STATE_DISABLED = 1 << 4,
+	STYLE_STATE_ALL = 0x1F				/**< every state bit (others are ignored) */
+} style_state;
+/** @brief Properties a rule sets (mask) */
+typedef enum {
+	STYLE_BACKGROUND = 1 << 0,
+	STYLE_TEXT = 1 << 1,
+	STYLE_BORDER_COLOR = 1 << 2,
+	STYLE_BORDER = 1 << 3,
+	STYLE_RADIUS = 1 << 4,
+	STYLE_PADDING = 1 << 5,
+	STYLE_FONT = 1 << 6
+} style_property;
+/** @brief Resolved style */
+typedef struct ui_style_s {
+	uint32_t background;					/**< ARGB (0 alpha: none) */
+	uint32_t text;							/**< ARGB */
+	uint32_t border_color;				/**< ARGB */
+	int16_t border;						/**< outline width */
+	int16_t radius;						/**< corner radius */
+	int16_t padding[4];					/**< left, top, right, bottom */
+	ui_font font;
+} ui_style;
+/** @brief Style rule: the properties in `set` are taken from `values` */
+typedef struct style_rule_s {
+	uint32_t set;							/**< style_property mask */
+	ui_style values;
+} style_rule;
+/** @brief Theme statistics */
+typedef struct style_stats_s {
+	int classes;							/**< classes registered (the global class included) */
+	int rules;								/**< rules registered */
+	int cached;								/**< resolved styles interned */
+	uint32_t generation;					/**< bumped by every theme change */
+	uint64_t lookups;						/**< resolve calls */
+	uint64_t hits;							/**< lookups answered by a current record */
+	uint64_t resolved;					/**< records resolved (new or stale) */
+	uint64_t flushes;						/**< times the cache was emptied at STYLE_CACHE_MAX */
+} style_stats;
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for themes and resolved styles
+ * @details A theme is a set of rules on widget classes. A rule applies to a
+ * 	class (and classes derived from it) when the widget's state has every bit
+ * 	the rule requires; class 0 is the global class every class derives from.
+ * 	Rules are applied over the theme defaults in order of the number of state
+ * 	bits they require, then class depth (derived after base), then insertion.
+ * 	Per-call overrides go last. `resolve` interns the result by (class, state,
+ * 	overrides), so the same widget costs a hash probe per frame; a theme change
+ * 	bumps a generation, and stale records are re-resolved in place on their
+ * 	next lookup. Returned pointers stay valid (and current after the next
+ * 	`resolve` of the same key) until the cache reaches STYLE_CACHE_MAX records
+ * 	and is emptied.
+ */
+typedef struct ITheme {
+	int (*add_class)(ui_context, const string, int);								/**< Register a class (name, parent class; 0: global); returns its id (> 0) or -1; an existing name returns its id */
+	int (*rule)(ui_context, int, uint32_t, const style_rule*);				/**< Add a rule (class, required state bits, rule); 0 on success */
+	void (*defaults)(ui_context, const ui_style*);								/**< Style every rule applies over */
+	void (*clear)(ui_context);															/**< Remove every rule (classes are kept) */
+	const ui_style* (*resolve)(ui_context, int, uint32_t, const style_rule*);	/**< Resolved style of (class, state bits, overrides (NULL: none)) */
+	uint32_t (*generation)(ui_context);												/**< Theme generation (bumped by every change) */
+	void (*stats)(ui_context, style_stats*);										/**< Copy the theme statistics */
+} ITheme;
+
+extern const ITheme Theme;					/**< Global Theme interface instance */
+
+#endif // SIGUI_STYLE_H
@@ -0,0 +1,262 @@
+// sigui_widgets.h
+#ifndef SIGUI_WIDGETS_H
+#define SIGUI_WIDGETS_H
+
+#include "sigui.h"
+#include "sigui_draw.h"
+
+/** @brief Rows of one column fetched and cached together by a grid */
+#define GRID_TILE_ROWS 32
+/** @brief Bytes kept of a grid cell's text (NUL included) */
+#define GRID_CELL_MAX 64
+/** @brief Entries of a plot pyramid level summarized by one entry of the next level */
+#define PLOT_FAN 16
+/** @brief Series per plot */
+#define PLOT_SERIES_MAX 8
+/** @brief Largest piece of a text editor's piece table (bytes) */
+#define EDIT_PIECE_MAX 65536
+/** @brief Default side of a tile in a tiled image file (pixels) */
+#define TILE_SIDE 256
+/** @brief Levels of a tiled image pyramid, level 0 being full resolution */
+#define TILE_LEVELS_MAX 24
+
+//	Types =======================================================================
+/** @brief Opaque pointer to a virtualized list (owned by its module) */
+typedef struct ui_listview_s* ui_listview;
+/** @brief Row source of a list; rows are pulled only while they are on screen */
+typedef struct listview_source_s {
+	object data;											/**< passed to every callback */
+	int (*text)(object, int, char*, int);			/**< Write a row's text (row, buffer, size); returns its bytes (< 0: blank row) */
+	int (*height)(object, int);						/**< Row height in pixels (NULL: every row has the default height) */
+	void (*draw)(ui_context, object, int, ui_rect);	/**< Draw a row into its window-local rect (NULL: the row's text is drawn) */
+} listview_source;
+/** @brief List statistics */
+typedef struct listview_stats_s {
+	int first, last;				/**< rows recorded by the last frame [first, last) (visible + overscan) */
+	int drawn;						/**< rows recorded by the last frame */
+	int measured;					/**< rows whose height has been asked for */
+	uint64_t fetched;				/**< row texts pulled from the source */
+	uint64_t reused;				/**< rows drawn from the row cache without asking the source */
+} listview_stats;
+
+/** @brief Opaque pointer to a virtualized grid (owned by its module) */
+typedef struct ui_gridview_s* ui_gridview;
+/** @brief Columnar cell source of a grid; cells are pulled a column tile at a time */
+typedef struct gridview_source_s {
+	object data;																/**< passed to every callback */
+	void (*cells)(object, int, int, int, char*, int);				/**< Write a column's cells (column, first row, rows, buffer, stride): row i's text goes to buffer + i * stride (NUL-terminated) */
+	int (*header)(object, int, char*, int);							/**< Write a column title (column, buffer, size); returns its bytes (NULL: no titles) */
+} gridview_source;
+/** @brief Grid statistics */
+typedef struct gridview_stats_s {
+	int first_row, last_row;			/**< rows shown by the last frame [first, last) */
+	int first_column, last_column;	/**< scrolled columns shown by the last frame [first, last) (frozen ones excluded) */
+	int tiles;								/**< cell tiles drawn by the last frame */
+	uint64_t batches;						/**< column tiles fetched from the source */
+	uint64_t cells;						/**< cells fetched from the source */
+	uint64_t hits;							/**< tiles drawn from the tile cache */
+	uint64_t refits;						/**< cells re-fitted to a changed column width */
+} gridview_stats;
+/** @brief Opaque pointer to a time-series plot (owned by its module) */
+typedef struct ui_plotview_s* ui_plotview;
+/** @brief Plot statistics */
+typedef struct plotview_stats_s {
+	int64_t samples;						/**< samples held by every series */
+	int levels;								/**< deepest min/max pyramid level built */
+	size_t bytes;							/**< sample and pyramid bytes */
+	int columns;							/**< pixel columns decimated by the last frame (0: drawn as lines) */
+	int64_t scanned;						/**< samples/pyramid entries read by the last frame */
+} plotview_stats;
+/** @brief Opaque pointer to a text editor (owned by its module) */
+typedef struct ui_textedit_s* ui_textedit;
+/** @brief Text editor statistics */
+typedef struct textedit_stats_s {
+	int64_t length;						/**< document bytes */
+	int64_t lines;							/**< lines found so far (every line once `indexed` reaches the original) */
+	int64_t indexed;						/**< original bytes whose newlines have been counted */
+	int64_t mapped;						/**< bytes of the mapped original file (never copied) */
+	int64_t added;							/**< bytes in the append buffer */
+	int pieces;								/**< pieces in the piece table */
+	int drawn;								/**< lines laid out by the last frame */
+} textedit_stats;
+/** @brief Opaque pointer to a tiled image viewer (owned by its module) */
+typedef struct ui_tileview_s* ui_tileview;
+/**
+ * @brief Header of a tiled image file (native byte order; `TileView.convert` writes it)
+ * @details Level l is the image halved l times (rounded up). Its tiles follow
+ * 	one another row by row from `offset[l]`; each is tile x tile ARGB pixels,
+ * 	page aligned, with the part past the image edge zeroed.
+ */
+typedef struct tiled_header_s {
+	char magic[8];							/**< "SGTILES1" */
+	uint32_t width, height;				/**< level 0 pixels */
+	uint32_t tile;							/**< tile side (power of two) */
+	uint32_t levels;						/**< levels in the file */
+	uint64_t offset[TILE_LEVELS_MAX];	/**< file offset of the first tile of each level */
+} tiled_header;
+/** @brief Tiled image viewer statistics */
+typedef struct tileview_stats_s {
+	int level;								/**< pyramid level drawn by the last frame */
+	int visible;							/**< tiles crossing the window at that level */
+	int drawn;								/**< visible tiles drawn from the cache */
+	int fallback;							/**< visible tiles shown from a coarser tile or the placeholder */
+	int resident;							/**< tiles in the cache */
+	size_t bytes;							/**< bytes of cached tiles */
+	int queued;								/**< tiles waiting for the prefetch thread */
+	uint64_t loaded;						/**< tiles paged in by the prefetch thread */
+	uint64_t evicted;						/**< tiles dropped by the cache cap */
+} tileview_stats;
+
+//	Interfaces ==================================================================
+/**
+ * @brief Interface for virtualized lists over large row sources
+ * @details A list is a module whose callback records only the rows crossing its
+ * 	window plus `overscan` rows on either side, so its frame cost does not depend
+ * 	on the row count. Row heights live in an extent index (a Fenwick tree over
+ * 	blocks of rows): offset -> row and row -> offset are O(log n). Variable
+ * 	heights are asked for the first time a row comes near the window; until then
+ * 	a row counts as the default height, and the row at the top of the window
+ * 	stays put while rows above it are measured. Row texts are cached across
+ * 	frames and only fetched again after `refresh`/`update`.
+ */
+typedef struct IListView {
+	ui_listview (*new)(ui_context, string, window, const listview_source*, int, int);	/**< Add a list module (name, window, source (copied), rows, default row height) */
+	ui_module (*module)(ui_listview);								/**< The list's module */
+	void (*refresh)(ui_listview, int);							/**< The source changed: set the row count, drop cached rows and heights */
+	void (*update)(ui_listview, int);								/**< One row changed: fetch and measure it again */
+	void (*overscan)(ui_listview, int);							/**< Rows recorded past each edge of the window (default 4) */
+	void (*style)(ui_listview, ui_font, uint32_t, uint32_t, uint32_t);	/**< Font, text, background and odd-row stripe colors (ARGB; 0 alpha: none) */
+	void (*scroll_to)(ui_listview, int64_t);					/**< Content offset shown at the top of the window (clamped) */
+	void (*scroll_by)(ui_listview, int64_t);					/**< Scroll by a pixel delta (clamped) */
+	void (*scroll_to_row)(ui_listview, int);					/**< Show a row at the top of the window */
+	int64_t (*offset)(ui_listview);								/**< Content offset at the top of the window */
+	int (*row_at)(ui_listview, int);								/**< Row under a window-local y (-1: none) */
+	int64_t (*row_offset)(ui_listview, int);					/**< Content offset of a row */
+	int64_t (*height)(ui_listview);								/**< Content height (unmeasured rows count as the default height) */
+	int (*rows)(ui_listview);										/**< Row count */
+	void (*stats)(ui_listview, listview_stats*);					/**< Copy the list statistics */
+} IListView;
+
+extern const IListView ListView;			/**< Global ListView interface instance */
+
+/**
+ * @brief Interface for virtualized grids over columnar cell sources
+ * @details A grid is a module with a frozen header row, optional frozen leading
+ * 	columns and both axes virtualized: only the cells crossing its window are
+ * 	recorded. Row and column extents live in extent indexes, so scrolling and
+ * 	hit tests are O(log n) per axis and resizing a column is O(log n). Cells are
+ * 	fetched a column tile (GRID_TILE_ROWS rows of one column) per call and cached
+ * 	with each cell's text fitted to its column width. A resize re-fits only the
+ * 	tiles of the resized column. Dragging a header edge resizes a column and
+ * 	pressing a cell selects it.
+ */
+typedef struct IGridView {
+	ui_gridview (*new)(ui_context, string, window, const gridview_source*, int, int, int, int);	/**< Add a grid module (name, window, source (copied), rows, columns, row height, column width) */
+	ui_module (*module)(ui_gridview);									/**< The grid's module */
+	void (*refresh)(ui_gridview, int, int);							/**< The source changed: set the row and column counts, drop cached cells (widths kept) */
+	void (*header)(ui_gridview, int);									/**< Header row height (0: no header; default: the row height) */
+	void (*freeze)(ui_gridview, int);									/**< Leading columns kept in place while scrolling horizontally */
+	void (*resize_column)(ui_gridview, int, int);					/**< Set a column's width */
+	int (*column_width)(ui_gridview, int);								/**< A column's width */
+	void (*style)(ui_gridview, ui_font, uint32_t, uint32_t, uint32_t, uint32_t);	/**< Font, text, background, header and grid line colors (ARGB) */
+	void (*scroll_to)(ui_gridview, int64_t, int64_t);				/**< Scrolled content offset (x past the frozen columns, y below the header; clamped) */
+	void (*scroll_by)(ui_gridview, int64_t, int64_t);				/**< Scroll by a pixel delta (clamped) */
+	void (*offset)(ui_gridview, int64_t*, int64_t*);				/**< Scrolled content offset (x, y) */
+	int (*cell_at)(ui_gridview, int, int, int*, int*);			/**< Cell under a window-local point (row, column): 0 cell, 1 header (row -1), -1 none */
+	int (*selected)(ui_gridview, int*, int*);						/**< Last pressed cell (row, column); 0 when one is selected */
+	void (*stats)(ui_gridview, gridview_stats*);					/**< Copy the grid statistics */
+} IGridView;
+
+extern const IGridView GridView;			/**< Global GridView interface instance */
+
+/**
+ * @brief Interface for time-series plots over very long series
+ * @details Series hold float samples at consecutive x (sample index). Appending
+ * 	extends a min/max pyramid per series (each level summarizes PLOT_FAN entries
+ * 	of the one below) in time proportional to the appended samples. A frame
+ * 	decimates each series to one min/max span per pixel column, answered from
+ * 	the pyramid (SIMD kernels scan at most a few runs of PLOT_FAN entries per
+ * 	level), so its cost depends on the plot width, not on the samples in view.
+ * 	Zoomed in past one sample per pixel, samples are joined by lines. Append
+ * 	between frames (the plot is not thread-safe).
+ */
+typedef struct IPlotView {
+	ui_plotview (*new)(ui_context, string, window);								/**< Add a plot module (name, window) */
+	ui_module (*module)(ui_plotview);												/**< The plot's module */
+	int (*add_series)(ui_plotview, uint32_t);										/**< Add a series drawn in an ARGB color; returns its index or -1 */
+	int (*append)(ui_plotview, int, const float*, int);						/**< Append samples to a series (series, samples, count); 0 on success */
+	int64_t (*count)(ui_plotview, int);												/**< Samples in a series */
+	void (*view)(ui_plotview, int64_t, int64_t);									/**< Show samples [first, first + span) (span <= 0: every sample) */
+	void (*follow)(ui_plotview, int64_t);											/**< Show the last `span` samples as they are appended */
+	void (*range)(ui_plotview, float, float);										/**< Value range shown (min >= max: fit the samples in view) */
+	int (*minmax)(ui_plotview, int, int64_t, int64_t, float*, float*);		/**< Min and max of samples [first, last) of a series (NaN samples are skipped); 0 on success */
+	void (*stats)(ui_plotview, plotview_stats*);									/**< Copy the plot statistics */
+} IPlotView;
+
+extern const IPlotView PlotView;			/**< Global PlotView interface instance */
+
+/**
+ * @brief Interface for editing very large documents
+ * @details The document is a piece table: pieces point into the original file,
+ * 	which is mmap'd and never copied, or into an append buffer that receives
+ * 	every inserted byte. Pieces are kept in a balanced tree (a treap) summing
+ * 	bytes and newlines per subtree, so finding an offset or a line, inserting and
+ * 	erasing are O(log n) in the piece count plus a scan of one piece (pieces are
+ * 	at most EDIT_PIECE_MAX bytes). Opening a file only maps it; its newlines are
+ * 	counted lazily, in order, as lines are asked for and a slice per frame in the
+ * 	background. A frame lays out only the lines in the window. Printable keys,
+ * 	Enter, Tab, Backspace and Delete edit at the caret; a press moves it.
+ */
+typedef struct ITextEdit {
+	ui_textedit (*new)(ui_context, string, window);							/**< Add an editor module (name, window) */
+	ui_module (*module)(ui_textedit);												/**< The editor's module */
+	int (*open)(ui_textedit, const char*);											/**< Map a file as the document (read-only mapping; no copy); 0 on success */
+	int (*load)(ui_textedit, const char*, int64_t);								/**< Use in-memory text as the document (copied); 0 on success */
+	int (*save)(ui_textedit, const char*);											/**< Write the document to a file (replaced atomically); 0 on success */
+	int (*insert)(ui_textedit, int64_t, const char*, int64_t);				/**< Insert bytes at an offset; 0 on success */
+	int (*erase)(ui_textedit, int64_t, int64_t);									/**< Erase bytes from an offset; 0 on success */
+	int64_t (*read)(ui_textedit, int64_t, char*, int64_t);					/**< Copy bytes from an offset; returns the bytes copied */
+	int64_t (*length)(ui_textedit);													/**< Document bytes */
+	int64_t (*lines)(ui_textedit);													/**< Line count (counts every remaining newline first) */
+	int64_t (*line_start)(ui_textedit, int64_t);									/**< Offset where a line starts (-1: no such line) */
+	int64_t (*line_of)(ui_textedit, int64_t);										/**< Line holding an offset */
+	void (*caret)(ui_textedit, int64_t);											/**< Move the caret to an offset (clamped) */
+	int64_t (*position)(ui_textedit);												/**< Caret offset */
+	void (*scroll_to_line)(ui_textedit, int64_t);								/**< Show a line at the top of the window */
+	int64_t (*top)(ui_textedit);														/**< Line at the top of the window */
+	void (*stats)(ui_textedit, textedit_stats*);									/**< Copy the editor statistics */
+} ITextEdit;
+
+extern const ITextEdit TextEdit;			/**< Global TextEdit interface instance */
+
+/**
+ * @brief Interface for viewing very large images from tiled pyramid files
+ * @details The file (see tiled_header) is mmap'd; a frame draws the tiles of
+ * 	the level nearest the scale that cross the window, straight from the mapping
+ * 	(nothing is decoded or copied). A tile is drawn only once a background
+ * 	thread has paged it in; until then the closest cached coarser tile, or the
+ * 	placeholder color, stands in. Every frame the thread's queue is replaced by
+ * 	the missing visible tiles, then a ring of neighbors and the next coarser
+ * 	level. Cached tiles are evicted least recently drawn first once they exceed
+ * 	the cache cap (tiles drawn by the current frame are kept). Dragging with
+ * 	the left button pans; '+'/'-' zoom about the window center and '0' fits.
+ */
+typedef struct ITileView {
+	ui_tileview (*new)(ui_context, string, window);								/**< Add a viewer module (name, window) */
+	ui_module (*module)(ui_tileview);												/**< The viewer's module */
+	int (*convert)(const char*, const char*, int);								/**< Write a tiled file from a binary PPM (P5/P6; source, target, tile side (0: TILE_SIDE)); 0 on success */
+	int (*open)(ui_tileview, const char*);											/**< Map a tiled file and fit it in the window; 0 on success */
+	int (*size)(ui_tileview, int*, int*);											/**< Full-resolution size (width, height); 0 when open */
+	void (*view)(ui_tileview, double, double, double);							/**< Show image point (x, y) at the window's top-left at a scale (window pixels per image pixel) */
+	void (*fit)(ui_tileview);															/**< Fit the whole image in the window */
+	void (*pan)(ui_tileview, int, int);												/**< Move the image by window pixels (dx, dy) */
+	void (*zoom)(ui_tileview, double, int, int);									/**< Multiply the scale, keeping a window point (factor, x, y) in place */
+	double (*scale)(ui_tileview);														/**< Window pixels per image pixel */
+	void (*cache)(ui_tileview, size_t);												/**< Cap cached tile bytes (default 64 MiB) */
+	void (*wait)(ui_tileview);															/**< Block until the prefetch thread is idle */
+	void (*stats)(ui_tileview, tileview_stats*);									/**< Copy the viewer statistics */
+} ITileView;
+
+extern const ITileView TileView;			/**< Global TileView interface instance */
+
+#endif // SIGUI_WIDGETS_H
@@ -0,0 +1,198 @@
+// allocator.c
+/**
+ * @detail Context allocators. Every sigui allocation is routed through the
+ * 	context's `ui_allocator` with a subsystem tag. The standard allocator is a thin
+ * 	pass-through to sigcore `Mem`; the tracking allocator prefixes each block with a
+ * 	small header (size + tag) so it can account live/peak bytes per subsystem. A
+ * 	block is always released by the allocator that made it (windows are made with
+ * 	`Sigui.new_window`, so no context memory predates its allocator).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sigui_alloc.h"
+#include "sigui_debug.h"
+
+//	Private structs =============================================================
+/* tracking header placed in front of every tracked block */
+typedef union track_header_u {
+	struct {
+		uint32_t tag;						// alloc_tag
+		size_t size;						// requested size
+	} h;
+	max_align_t align;					// keep payload maximally aligned
+} track_header;
+/* tracking allocator */
+typedef struct tracker_s {
+	struct ui_allocator_s base;		// must be first
+	ui_allocator parent;					// backing allocator
+	alloc_stats stats[ALLOC_TAG_COUNT + 1];	// per tag + totals
+	size_t current[ALLOC_TAG_COUNT + 1];		// allocations in the running frame
+	size_t frame;							// completed frame count
+	int in_frame;							// 1 between begin/end frame
+	int strict;								// steady-state allocation check enabled
+	size_t warmup;							// frames ignored by the strict check
+	alloc_violation on_violation;		// NULL = report and abort
+} tracker;
+
+static const string TAG_NAMES[ALLOC_TAG_COUNT + 1] = {
+	"context", "module", "window", "event", "command", "string", "draw", "text", "widget", "keymap", "tree", "flex", "state", "style", "pipeline", "remote", "total"
+};
+
+//	Standard Allocator ==========================================================
+static object std_alloc(ui_allocator a, size_t size, alloc_tag tag) {
+	object ptr = Mem.alloc(size);
+	if (ptr) memset(ptr, 0, size);
+	
+	return ptr;
+}
+static void std_free(ui_allocator a, object ptr, alloc_tag tag) {
+	if (ptr) Mem.free(ptr);
+}
+
+static struct ui_allocator_s STANDARD = {
+	.alloc = std_alloc,
+	.free = std_free,
+	.begin_frame = NULL,
+	.end_frame = NULL,
+	.user = NULL
+};
+
+/* returns the standard allocator */
+static ui_allocator standard_allocator(void) {
+	return &STANDARD;
+}
+
+//	Tracking Allocator ==========================================================
+static void account(alloc_stats* s, size_t size, int add) {
+	if (add) {
+		s->live_bytes += size;
+		s->allocs++;
+		if (s->live_bytes > s->peak_bytes) s->peak_bytes = s->live_bytes;
+	} else {
+		s->live_bytes -= size;
+		s->frees++;
+	}
+}
+static object track_alloc(ui_allocator a, size_t size, alloc_tag tag) {
+	tracker* t = (tracker*)a;
+	if (tag >= ALLOC_TAG_COUNT) tag = ALLOC_TAG_COUNT - 1;
+
+	track_header* hdr = t->parent->alloc(t->parent, sizeof(track_header) + size, tag);
+	if (!hdr) return NULL;
+
+	hdr->h.tag = tag;
+	hdr->h.size = size;
+
+	account(&t->stats[tag], size, 1);
+	account(&t->stats[ALLOC_TAG_COUNT], size, 1);
+	if (t->in_frame) {
+		t->current[tag]++;
+		t->current[ALLOC_TAG_COUNT]++;
+	}
+
+	return hdr + 1;
+}
+static void track_free(ui_allocator a, object ptr, alloc_tag tag) {
+	if (!ptr) return;
+	tracker* t = (tracker*)a;
+
+	track_header* hdr = (track_header*)ptr - 1;
+	account(&t->stats[hdr->h.tag], hdr->h.size, 0);
+	account(&t->stats[ALLOC_TAG_COUNT], hdr->h.size, 0);
+	t->parent->free(t->parent, hdr, hdr->h.tag);
+}
+static void track_begin_frame(ui_allocator a) {
+	tracker* t = (tracker*)a;
+
+	int i = 0;
+	while (i <= ALLOC_TAG_COUNT) t->current[i++] = 0;
+	t->in_frame = 1;
+}
+static void track_end_frame(ui_allocator a, int steady) {
+	tracker* t = (tracker*)a;
+
+	int i = 0;
+	while (i <= ALLOC_TAG_COUNT) {
+		t->stats[i].frame_allocs = t->current[i];
+		++i;
+	}
+	t->in_frame = 0;
+	t->frame++;
+
+	size_t count = t->current[ALLOC_TAG_COUNT];
+	if (!t->strict || !steady || count == 0 || t->frame <= t->warmup) return;
+
+	if (t->on_violation) {
+		t->on_violation(a, t->frame, count);
+		return;
+	}
+	//	fail loudly: a steady-state frame must not allocate
+	fprintf(stderr, "[Allocator] steady-state frame %zu made %zu allocation(s):", t->frame, count);
+	i = 0;
+	while (i < ALLOC_TAG_COUNT) {
+		if (t->current[i]) fprintf(stderr, " %s=%zu", TAG_NAMES[i], t->current[i]);
+		++i;
+	}
+	fprintf(stderr, "\n");
+	abort();
+}
+
+/* creates a tracking allocator over a parent allocator */
+static ui_allocator new_tracking(ui_allocator parent) {
+	if (!parent) parent = &STANDARD;
+
+	tracker* t = Mem.alloc(sizeof(tracker));
+	if (!t) return NULL;
+
+	*t = (tracker){0};
+	t->base.alloc = track_alloc;
+	t->base.free = track_free;
+	t->base.begin_frame = track_begin_frame;
+	t->base.end_frame = track_end_frame;
+	t->base.user = t;
+	t->parent = parent;
+
+	return &t->base;
+}
+/* frees a tracking allocator (outstanding blocks are reported, not released) */
+static void free_tracking(ui_allocator a) {
+	if (!a || a == &STANDARD || a->alloc != track_alloc) return;
+	tracker* t = (tracker*)a;
+
+	if (t->stats[ALLOC_TAG_COUNT].live_bytes) {
+		DBLOG("Tracking allocator freed with %zu live bytes", t->stats[ALLOC_TAG_COUNT].live_bytes);
+	}
+	Mem.free(t);
+}
+/* copies stats for a tag (ALLOC_TAG_COUNT = totals) */
+static int get_stats(ui_allocator a, alloc_tag tag, alloc_stats* out) {
+	if (!a || !out || a->alloc != track_alloc || tag > ALLOC_TAG_COUNT) return -1;
+
+	*out = ((tracker*)a)->stats[tag];
+	return 0;
+}
+/* enables the steady-state allocation check after `warmup` frames */
+static void set_strict(ui_allocator a, size_t warmup, alloc_violation handler) {
+	if (!a || a->alloc != track_alloc) return;
+	tracker* t = (tracker*)a;
+
+	t->strict = 1;
+	t->warmup = warmup;
+	t->on_violation = handler;
+}
+/* printable tag name */
+static string tag_name(alloc_tag tag) {
+	return tag <= ALLOC_TAG_COUNT ? TAG_NAMES[tag] : "unknown";
+}
+
+/* allocator interface */
+const IAllocator Allocator = {
+	.standard = standard_allocator,
+	.new_tracking = new_tracking,
+	.free_tracking = free_tracking,
+	.stats = get_stats,
+	.set_strict = set_strict,
+	.tag_name = tag_name
+};
@@ -0,0 +1,223 @@
+// atlas.c
+/**
+ * @detail Glyph atlas. Glyphs are rasterized on first use and packed into
+ * 	shelves: rows of similar height filled left to right. A glyph goes to the
+ * 	shortest shelf that fits it (and is not much taller), otherwise to a new
+ * 	shelf. When the atlas is full, the least recently drawn shelf (not drawn in
+ * 	the current frame) is evicted whole. Changed atlas rects accumulate in a
+ * 	damage set so backends upload only dirty sub-rectangles. Module caches
+ * 	record the shelves their glyphs live on and the eviction stamp, which is how
+ * 	cached vertices are found stale after an eviction.
+ */
+
+#include <string.h>
+#include "render_core.h"
+#include "sigui_debug.h"
+
+#define SHELF_SLACK 4					/* extra rows a glyph may waste in a shelf */
+
+//	Helper Functions ============================================================
+static unsigned slot_of(uint64_t key, int capacity) {
+	return ui_fib_slot(key, __builtin_ctz((unsigned)capacity));
+}
+/* rebuilds the open addressing index */
+static int rebuild_index(glyph_atlas* a, int capacity) {
+	int* index = Mem.alloc(sizeof(int) * capacity);
+	if (!index) return -1;
+	memset(index, 0, sizeof(int) * capacity);
+
+	for (int i = 0; i < a->count; ++i) {
+		unsigned s = slot_of(a->glyphs[i].key, capacity);
+		while (index[s]) s = (s + 1) & (capacity - 1);
+		index[s] = i + 1;
+	}
+	if (a->index) Mem.free(a->index);
+	a->index = index;
+	a->index_capacity = capacity;
+
+	return 0;
+}
+static glyph_entry* find_glyph(glyph_atlas* a, uint64_t key) {
+	if (!a->index) return NULL;
+
+	unsigned s = slot_of(key, a->index_capacity);
+	while (a->index[s]) {
+		glyph_entry* g = &a->glyphs[a->index[s] - 1];
+		if (g->key == key) return g;
+		s = (s + 1) & (a->index_capacity - 1);
+	}
+
+	return NULL;
+}
+static glyph_entry* add_glyph(glyph_atlas* a, uint64_t key) {
+	if (a->count == a->capacity) {
+		int capacity = a->capacity ? a->capacity * 2 : 128;
+		glyph_entry* glyphs = Mem.alloc(sizeof(glyph_entry) * capacity);
+		if (!glyphs) return NULL;
+		if (a->glyphs) {
+			memcpy(glyphs, a->glyphs, sizeof(glyph_entry) * a->count);
+			Mem.free(a->glyphs);
+		}
+		a->glyphs = glyphs;
+		a->capacity = capacity;
+	}
+
+	glyph_entry* g = &a->glyphs[a->count++];
+	memset(g, 0, sizeof(glyph_entry));
+	g->key = key;
+
+	//	keep the index at most half full
+	if (a->count * 2 > a->index_capacity) {
+		if (rebuild_index(a, a->index_capacity ? a->index_capacity * 2 : 256) != 0) {
+			a->count--;
+			return NULL;
+		}
+	} else {
+		unsigned s = slot_of(key, a->index_capacity);
+		while (a->index[s]) s = (s + 1) & (a->index_capacity - 1);
+		a->index[s] = a->count;
+	}
+
+	return g;
+}
+/* drops a shelf's glyphs and clears its rows */
+static void evict_shelf(glyph_atlas* a, int shelf) {
+	atlas_shelf* sh = &a->shelves[shelf];
+	DBLOG("<Atlas> evicting shelf %d (y=%d h=%d)", shelf, sh->y, sh->height);
+
+	int i = 0;
+	while (i < a->count) {
+		if (a->glyphs[i].shelf == shelf) a->glyphs[i] = a->glyphs[--a->count];
+		else ++i;
+	}
+	rebuild_index(a, a->index_capacity);
+
+	memset(a->pixels + (size_t)sh->y * a->size, 0, (size_t)sh->height * a->size);
+	Damage.add(&a->dirty, (ui_rect){ 0, sh->y, a->size, sh->height });
+	sh->x = 0;
+	sh->evicted = ++a->stamp;
+	a->evictions++;
+}
+/*
+ *	Finds room for a (w, h) bitmap: best fitting shelf, a new shelf, or the least
+ *	recently drawn shelf tall enough (evicted); returns the shelf (-1=full)
+ */
+static int pack(glyph_atlas* a, int w, int h, uint64_t frame) {
+	int best = -1;
+	for (int s = 0; s < a->shelf_count; ++s) {
+		const atlas_shelf* sh = &a->shelves[s];
+		if (sh->height < h || sh->height > h + SHELF_SLACK || sh->x + w > a->size) continue;
+		if (best < 0 || sh->height < a->shelves[best].height) best = s;
+	}
+	if (best >= 0) return best;
+
+	if (a->shelf_count < ATLAS_SHELVES && a->bottom + h <= a->size) {
+		atlas_shelf* sh = &a->shelves[a->shelf_count];
+		*sh = (atlas_shelf){ a->bottom, h, 0, frame, 0 };
+		a->bottom += h + 1;		// one row (and column) of gap keeps neighbours from bleeding
+		return a->shelf_count++;
+	}
+
+	int lru = -1;
+	for (int s = 0; s < a->shelf_count; ++s) {
+		const atlas_shelf* sh = &a->shelves[s];
+		if (sh->height < h || sh->used >= frame) continue;
+		if (lru < 0 || sh->used < a->shelves[lru].used) lru = s;
+	}
+	if (lru >= 0) evict_shelf(a, lru);
+
+	return lru;
+}
+
+/*
+ *	Looks a glyph up; a miss rasterizes and packs it. Returns NULL when the font is
+ *	gone or every shelf that could hold the glyph is drawn in this frame
+ */
+static const glyph_entry* atlas_glyph(glyph_atlas* a, ui_font font, uint32_t cp, uint64_t frame) {
+	uint64_t key = (uint64_t)(uint32_t)font << 32 | cp;
+	a->lookups++;
+	glyph_entry* g = find_glyph(a, key);
+	if (g) {
+		if (g->shelf >= 0) a->shelves[g->shelf].used = frame;
+		return g;
+	}
+
+	if (!a->pixels) {
+		if (a->size <= 0) a->size = ATLAS_SIZE;
+		a->pixels = Mem.alloc((size_t)a->size * a->size);
+		if (!a->pixels) return NULL;
+		memset(a->pixels, 0, (size_t)a->size * a->size);
+	}
+	glyph_image image;
+	if (Glyphs.raster(font, cp, &image) != 0) return NULL;
+	a->misses++;
+
+	int shelf = -1, x = 0, y = 0;
+	if (image.width > 0 && image.height > 0) {
+		if (image.width > a->size || image.height > a->size) return NULL;
+		shelf = pack(a, image.width + 1, image.height, frame);
+		if (shelf < 0) return NULL;
+
+		atlas_shelf* sh = &a->shelves[shelf];
+		x = sh->x;
+		y = sh->y;
+		sh->x += image.width + 1;
+		sh->used = frame;
+		for (int row = 0; row < image.height; ++row) {
+			memcpy(a->pixels + (size_t)(y + row) * a->size + x, image.alpha + row * image.width, image.width);
+		}
+		Damage.add(&a->dirty, (ui_rect){ x, y, image.width, image.height });
+	}
+
+	//	after packing: an eviction compacts the entries
+	g = add_glyph(a, key);
+	if (!g) return NULL;
+	g->x = x;
+	g->y = y;
+	g->width = shelf >= 0 ? image.width : 0;
+	g->height = shelf >= 0 ? image.height : 0;
+	g->left = image.left;
+	g->top = image.top;
+	g->advance = image.advance;
+	g->shelf = shelf;
+
+	return g;
+}
+/* marks shelves drawn this frame (cached modules) */
+static void touch_shelves(glyph_atlas* a, uint64_t mask, uint64_t frame) {
+	while (mask) {
+		int s = __builtin_ctzll(mask);
+		a->shelves[s].used = frame;
+		mask &= mask - 1;
+	}
+}
+/* any shelf of the mask evicted after `stamp` */
+static int shelves_stale(const glyph_atlas* a, uint64_t mask, uint64_t stamp) {
+	while (mask) {
+		int s = __builtin_ctzll(mask);
+		if (a->shelves[s].evicted > stamp) return 1;
+		mask &= mask - 1;
+	}
+
+	return 0;
+}
+/* drops every glyph and the atlas storage */
+static void release_atlas(glyph_atlas* a) {
+	if (a->pixels) Mem.free(a->pixels);
+	if (a->glyphs) Mem.free(a->glyphs);
+	if (a->index) Mem.free(a->index);
+
+	int size = a->size;
+	uint64_t stamp = a->stamp;
+	memset(a, 0, sizeof(glyph_atlas));
+	a->size = size;
+	a->stamp = stamp;
+}
+
+/* glyph atlas interface (internal) */
+const IAtlas Atlas = {
+	.glyph = atlas_glyph,
+	.touch = touch_shelves,
+	.stale = shelves_stale,
+	.release = release_atlas
+};
@@ -0,0 +1,180 @@
+// batch.c
+/**
+ * @detail Draw batching for GL submission. Items arrive in z order, each with a
+ * 	state key (texture, blend). An item moves back to the most recent batch with
+ * 	the same key unless a batch in between overlaps it, so z order is only kept
+ * 	where primitives actually overlap. Each batch becomes one indexed draw.
+ */
+
+#include <string.h>
+#include "render_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+/* smallest rect containing both */
+static ui_rect rect_union(ui_rect a, ui_rect b) {
+	int x0 = a.x < b.x ? a.x : b.x;
+	int y0 = a.y < b.y ? a.y : b.y;
+	int x1 = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+	int y1 = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+
+	return (ui_rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+/* two triangles per quad (quads start at vertex `first`) */
+static void emit_quads(uint32_t* out, int first, int count) {
+	for (int q = 0; q < count; ++q) {
+		uint32_t v = (uint32_t)(first + q * 4);
+		*out++ = v;
+		*out++ = v + 1;
+		*out++ = v + 2;
+		*out++ = v;
+		*out++ = v + 2;
+		*out++ = v + 3;
+	}
+}
+/* same state key (layer composites never merge) */
+static int same_key(const draw_batch* b, const draw_item* it) {
+	return !b->layer && !it->layer && b->texture == it->texture && b->blend == it->blend;
+}
+
+/* drops items, batches and indices (storage is kept) */
+static void reset_set(batch_set* bs) {
+	bs->item_count = 0;
+	bs->count = 0;
+	bs->index_count = 0;
+}
+/* mesh triangles rebased on their first vertex */
+static void emit_mesh(uint32_t* out, const uint32_t* mesh, int count, int base) {
+	for (int i = 0; i < count; ++i) out[i] = (uint32_t)base + mesh[i];
+}
+/* indices an item emits */
+static int item_indices(const draw_item* it) {
+	return it->mesh ? it->count : it->count * 6;
+}
+/* adds a run of quads (first vertex, quad count); contiguous runs with the same key coalesce */
+static int add_quads(batch_set* bs, GLuint texture, int first, int count, ui_rect bounds, int blend) {
+	if (count <= 0) return 0;
+
+	if (bs->item_count > 0) {
+		draw_item* last = &bs->items[bs->item_count - 1];
+		if (!last->layer && !last->mesh && last->texture == texture && last->blend == blend && last->first + last->count * 4 == first) {
+			last->count += count;
+			last->bounds = rect_union(last->bounds, bounds);
+			return 0;
+		}
+	}
+	if (ui_grow_array((void**)&bs->items, &bs->item_capacity, bs->item_count + 1, sizeof(draw_item), 16) != 0) return -1;
+
+	bs->items[bs->item_count++] = (draw_item){ texture, blend, bounds, first, count, NULL, 0, NULL };
+	return 0;
+}
+/* adds a mesh: blended (its edges ramp coverage), never coalesced */
+static int add_mesh(batch_set* bs, const uint32_t* indices, int count, int base, ui_rect bounds) {
+	if (count <= 0) return 0;
+	if (ui_grow_array((void**)&bs->items, &bs->item_capacity, bs->item_count + 1, sizeof(draw_item), 16) != 0) return -1;
+
+	bs->items[bs->item_count++] = (draw_item){ 0, 1, bounds, base, count, NULL, 0, indices };
+	return 0;
+}
+/* adds a layer composite */
+static int add_layer(batch_set* bs, module_cache* mc, ui_rect bounds, int blend) {
+	if (ui_grow_array((void**)&bs->items, &bs->item_capacity, bs->item_count + 1, sizeof(draw_item), 16) != 0) return -1;
+
+	bs->items[bs->item_count++] = (draw_item){ mc->layer.texture, blend, bounds, 0, 0, mc, 0, NULL };
+	return 0;
+}
+/* emits indices for a module's quads and meshes in order, drawn on its own (layer content) */
+static int add_content(batch_set* bs, const module_cache* mc) {
+	int need = bs->index_count + mc->tri_count + mc->count / 4 * 6;		// bound: every vertex in a quad
+	if (ui_grow_array((void**)&bs->indices, &bs->index_capacity, need, sizeof(uint32_t), 16) != 0) return -1;
+
+	int start = bs->index_count;
+	uint32_t* out = bs->indices + start;
+	int s = 0, v = 0;
+	while (v < mc->count) {
+		if (s < mc->mesh_count && mc->meshes[s].first == v) {
+			const mesh_span* m = &mc->meshes[s++];
+			emit_mesh(out, mc->tris + m->index, m->indices, mc->base);
+			out += m->indices;
+			v += m->count;
+			continue;
+		}
+		emit_quads(out, mc->base + v, 1);
+		out += 6;
+		v += 4;
+	}
+	bs->index_count = (int)(out - bs->indices);
+
+	return start;
+}
+/* merges items into batches and emits their indices */
+static int build_set(batch_set* bs) {
+	bs->count = 0;
+	for (int i = 0; i < bs->item_count; ++i) {
+		draw_item* it = &bs->items[i];
+
+		//	move back to a batch with the same key unless something in between overlaps
+		int target = -1;
+		int stop = bs->count > BATCH_LOOKBACK ? bs->count - BATCH_LOOKBACK : 0;
+		for (int j = bs->count - 1; j >= stop; --j) {
+			draw_batch* b = &bs->batches[j];
+			if (same_key(b, it)) {
+				target = j;
+				break;
+			}
+			if (Damage.intersect(b->bounds, it->bounds, NULL)) break;
+		}
+
+		if (target < 0) {
+			if (ui_grow_array((void**)&bs->batches, &bs->capacity, bs->count + 1, sizeof(draw_batch), 16) != 0) return -1;
+			target = bs->count++;
+			bs->batches[target] = (draw_batch){ it->texture, it->blend, it->bounds, 0, 0, it->layer, 0 };
+		} else {
+			bs->batches[target].bounds = rect_union(bs->batches[target].bounds, it->bounds);
+		}
+		bs->batches[target].items++;
+		bs->batches[target].count += item_indices(it);
+		it->batch = target;
+	}
+
+	//	lay batches out after the content ranges, then fill them in z order
+	if (ui_grow_array((void**)&bs->scratch, &bs->scratch_capacity, bs->count, sizeof(int), 16) != 0) return -1;
+	int cursor = bs->index_count;
+	for (int j = 0; j < bs->count; ++j) {
+		bs->batches[j].first = cursor;
+		bs->scratch[j] = cursor;
+		cursor += bs->batches[j].count;
+	}
+	if (ui_grow_array((void**)&bs->indices, &bs->index_capacity, cursor, sizeof(uint32_t), 16) != 0) return -1;
+
+	for (int i = 0; i < bs->item_count; ++i) {
+		draw_item* it = &bs->items[i];
+		if (!it->count) continue;
+		if (it->mesh) emit_mesh(bs->indices + bs->scratch[it->batch], it->mesh, it->count, it->first);
+		else emit_quads(bs->indices + bs->scratch[it->batch], it->first, it->count);
+		bs->scratch[it->batch] += item_indices(it);
+	}
+	bs->index_count = cursor;
+	DBLOG("<Batch> items=%d batches=%d indices=%d", bs->item_count, bs->count, bs->index_count);
+
+	return 0;
+}
+/* frees the set's storage */
+static void release_set(batch_set* bs) {
+	if (bs->items) Mem.free(bs->items);
+	if (bs->batches) Mem.free(bs->batches);
+	if (bs->indices) Mem.free(bs->indices);
+	if (bs->scratch) Mem.free(bs->scratch);
+	memset(bs, 0, sizeof(batch_set));
+}
+
+/* batch interface (internal) */
+const IBatch Batch = {
+	.reset = reset_set,
+	.quads = add_quads,
+	.mesh = add_mesh,
+	.layer = add_layer,
+	.content = add_content,
+	.build = build_set,
+	.release = release_set
+};
@@ -0,0 +1,55 @@
+// cull.c
+/**
+ * @detail Module culling. A module is culled when its on-screen rect misses the
+ * 	viewport, or when its visible part is fully covered by a single opaque module
+ * 	drawn after it. Culled modules skip their callback and all vertex work.
+ * 	Subtrees whose cached bounds miss the viewport are culled as a whole first.
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+/* an enabled module drawn after `index` covers `visible` */
+static int occluded(ui_context ctx, int index, int count, ui_rect visible) {
+	for (int j = index + 1; j < count; ++j) {
+		ui_module o = List.getAt(ctx->modules, j);
+		if (!o->enabled || !o->win || !ui_module_opaque(o)) continue;
+		if (ui_rect_contains(ui_module_bounds(o), visible)) return 1;
+	}
+	
+	return 0;
+}
+
+/* classifies every module; counts are optional */
+static void cull_modules(ui_context ctx, ui_rect viewport, int* outside, int* covered) {
+	int count = List.count(ctx->modules);
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		m->culled = CULL_NONE;
+	}
+	Hierarchy.refresh(ctx);
+	int n_outside = Hierarchy.cull(ctx, viewport), n_covered = 0;
+	
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		if (m->culled || !m->enabled || !m->win) continue;
+		
+		ui_rect visible;
+		if (!Damage.intersect(ui_module_bounds(m), viewport, &visible)) {
+			m->culled = CULL_VIEWPORT;
+			n_outside++;
+		} else if (occluded(ctx, i, count, visible)) {
+			m->culled = CULL_OCCLUDED;
+			n_covered++;
+		}
+	}
+	
+	if (outside) *outside = n_outside;
+	if (covered) *covered = n_covered;
+}
+
+/* cull interface (internal) */
+const ICull Cull = {
+	.modules = cull_modules
+};
@@ -0,0 +1,152 @@
+// damage.c
+/**
+ * @detail Damage regions. Dirty rectangles are folded into a small fixed set:
+ * 	overlapping rects are unioned, and when the set is full the pair whose union
+ * 	wastes the least area is merged. The renderer redraws (scissors) only the
+ * 	resulting regions.
+ */
+
+#include "ui_core.h"
+
+//	Helper Functions ============================================================
+static long rect_area(ui_rect r) {
+	return (long)r.width * r.height;
+}
+static ui_rect rect_union(ui_rect a, ui_rect b) {
+	int x0 = a.x < b.x ? a.x : b.x;
+	int y0 = a.y < b.y ? a.y : b.y;
+	int x1 = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+	int y1 = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+
+	return (ui_rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+/* overlapping or edge-adjacent */
+static int rect_touches(ui_rect a, ui_rect b) {
+	return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+			 a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+static int rect_contains(ui_rect outer, ui_rect inner) {
+	return inner.x >= outer.x && inner.y >= outer.y &&
+			 inner.x + inner.width <= outer.x + outer.width &&
+			 inner.y + inner.height <= outer.y + outer.height;
+}
+/* removes rect i by moving the last rect into its slot */
+static void remove_at(damage_set* ds, int i) {
+	ds->rects[i] = ds->rects[--ds->count];
+}
+/* unions touching regions until none touch */
+static void coalesce(damage_set* ds) {
+	int merged = 1;
+	while (merged) {
+		merged = 0;
+		for (int i = 0; i < ds->count && !merged; ++i) {
+			for (int j = i + 1; j < ds->count; ++j) {
+				if (!rect_touches(ds->rects[i], ds->rects[j])) continue;
+				ds->rects[i] = rect_union(ds->rects[i], ds->rects[j]);
+				remove_at(ds, j);
+				merged = 1;
+				break;
+			}
+		}
+	}
+}
+
+/* clears a damage set */
+static void damage_clear(damage_set* ds) {
+	ds->count = 0;
+	ds->full = 0;
+}
+/* marks the whole surface dirty */
+static void damage_all(damage_set* ds) {
+	ds->count = 0;
+	ds->full = 1;
+}
+/* adds a dirty rect */
+static void damage_add(damage_set* ds, ui_rect r) {
+	if (ds->full || r.width <= 0 || r.height <= 0) return;
+
+	for (int i = 0; i < ds->count; ++i) {
+		if (rect_contains(ds->rects[i], r)) return;
+	}
+	ds->rects[ds->count++] = r;
+	coalesce(ds);
+	if (ds->count <= DAMAGE_MAX_REGIONS) return;
+
+	//	over budget: merge the cheapest pair
+	int bi = 0, bj = 1;
+	long best = -1;
+	for (int i = 0; i < ds->count; ++i) {
+		for (int j = i + 1; j < ds->count; ++j) {
+			long waste = rect_area(rect_union(ds->rects[i], ds->rects[j])) -
+							 rect_area(ds->rects[i]) - rect_area(ds->rects[j]);
+			if (best < 0 || waste < best) {
+				best = waste;
+				bi = i;
+				bj = j;
+			}
+		}
+	}
+	ds->rects[bi] = rect_union(ds->rects[bi], ds->rects[bj]);
+	remove_at(ds, bj);
+	coalesce(ds);
+}
+/* adds every region of another set */
+static void damage_merge(damage_set* ds, const damage_set* other) {
+	if (other->full) {
+		damage_all(ds);
+		return;
+	}
+	for (int i = 0; i < other->count; ++i) damage_add(ds, other->rects[i]);
+}
+/* clips regions to a surface; a full set becomes one surface-sized region */
+static void damage_clip(damage_set* ds, int width, int height) {
+	if (ds->full) {
+		ds->rects[0] = (ui_rect){ 0, 0, width, height };
+		ds->count = 1;
+		return;
+	}
+
+	int i = 0;
+	while (i < ds->count) {
+		ui_rect* r = &ds->rects[i];
+		int x0 = r->x < 0 ? 0 : r->x;
+		int y0 = r->y < 0 ? 0 : r->y;
+		int x1 = r->x + r->width > width ? width : r->x + r->width;
+		int y1 = r->y + r->height > height ? height : r->y + r->height;
+		if (x0 >= x1 || y0 >= y1) {
+			remove_at(ds, i);
+			continue;
+		}
+		*r = (ui_rect){ x0, y0, x1 - x0, y1 - y0 };
+		++i;
+	}
+}
+/* total area covered by the regions (regions never overlap after coalesce) */
+static long damage_area(const damage_set* ds) {
+	long area = 0;
+	for (int i = 0; i < ds->count; ++i) area += rect_area(ds->rects[i]);
+
+	return area;
+}
+/* rect intersection; returns 0 when empty */
+static int rect_intersect(ui_rect a, ui_rect b, ui_rect* out) {
+	int x0 = a.x > b.x ? a.x : b.x;
+	int y0 = a.y > b.y ? a.y : b.y;
+	int x1 = a.x + a.width < b.x + b.width ? a.x + a.width : b.x + b.width;
+	int y1 = a.y + a.height < b.y + b.height ? a.y + a.height : b.y + b.height;
+	if (x0 >= x1 || y0 >= y1) return 0;
+
+	if (out) *out = (ui_rect){ x0, y0, x1 - x0, y1 - y0 };
+	return 1;
+}
+
+/* damage interface (internal) */
+const IDamage Damage = {
+	.clear = damage_clear,
+	.all = damage_all,
+	.add = damage_add,
+	.merge = damage_merge,
+	.clip = damage_clip,
+	.area = damage_area,
+	.intersect = rect_intersect
+};
@@ -1,36 +1,77 @@
 // dispatcher.c
 /** 
  * @detail Here we can add a lot of detail about what is going on from a 30,000 foot perspective. 
+ * 	Events aimed at a module walk the path from its root: capture handlers on
+ * 	the way down, the target, then the regular handlers on the way back up.
+ * 	Events without a target are broadcast to every module in order.
  */
  
 #include "sigui.h"
 #include "ui_core.h"
+#include "sigui_debug.h"
  
 /* enqueue an event to the context queue */
 static void enqueue_event(ui_context ctx, event_info ei) {
 	if (!ctx || !ei) return;
 	
 	List.add(ctx->events, ei);
-	printf("   <Dispatch> equeued event\n");
+	DBLOG("<Dispatch> enqueued event");
 }
-/* dispatches context events */
+/* runs one handler; 1 when it stopped propagation */
+static int deliver(ui_context ctx, ui_module m, event_handler h, event_info ei, event_phase phase) {
+	if (!m->enabled || !h) return 0;
+	
+	DBLOG("<Dispatch> event module=%s phase=%d", m->name, phase);
+	ei->current_target = m;
+	ei->phase = phase;
+	ctx->tree.stats.calls++;
+	uint64_t start = Pacer.now(ctx);
+	h(ctx, m, ei);
+	Pacer.charge(m, Pacer.now(ctx) - start);
+	
+	return ei->stop;
+}
+/* every enabled module in order, until a handler stops it */
+static void broadcast(ui_context ctx, event_info ei) {
+	ctx->tree.stats.broadcast++;
+	int count = List.count(ctx->modules);
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		if (deliver(ctx, m, m->handler, ei, EVENT_PHASE_BROADCAST)) break;
+	}
+}
+/* capture down the path, the target, then bubble back up */
+static void propagate(ui_context ctx, event_info ei) {
+	ctx->tree.stats.targeted++;
+	int depth;
+	ui_module* path = Hierarchy.path(ctx, ei->target, &depth);
+	
+	for (int i = depth - 1; i > 0; --i) {
+		if (deliver(ctx, path[i], path[i]->capture, ei, EVENT_PHASE_CAPTURE)) return;
+	}
+	ui_module target = ei->target;
+	if (deliver(ctx, target, target->capture, ei, EVENT_PHASE_TARGET)) return;
+	if (deliver(ctx, target, target->handler, ei, EVENT_PHASE_TARGET)) return;
+	for (int i = 1; i < depth; ++i) {
+		if (deliver(ctx, path[i], path[i]->handler, ei, EVENT_PHASE_BUBBLE)) return;
+	}
+}
+/* dispatches context events along their target paths */
 static void dispatch_events(ui_context ctx) {
 	if (!ctx || !ctx->events || List.count(ctx->events) == 0) return;
 	
+	//	windows moved by handlers are picked up by the next dispatch
+	Hierarchy.refresh(ctx);
 	iterator e_it = Array.getIterator(ctx->events, LIST);
 	while (Iterator.hasNext(e_it)) {
 		event_info ei = Iterator.next(e_it);
-		iterator m_it = Array.getIterator(ctx->modules, LIST);
-		while (Iterator.hasNext(m_it)) {
-			ui_module m = Iterator.next(m_it);
-			if (m->enabled && m->handler) {
-				printf("   <Dispatch> event module=%s\n", m->name); 
-				m->handler(ctx, m, ei);
-			}
-		}
-		Iterator.free(m_it);
-		Mem.free(ei->e);
-		Mem.free(ei);
+		if (!ei->target) ei->target = Hierarchy.target(ctx, ei->e);
+		if (ei->target) propagate(ctx, ei);
+		else broadcast(ctx, ei);
+		if (ei->stop) ctx->tree.stats.stopped++;
+		
+		ui_free(ctx, ei->e, ALLOC_EVENT);
+		ui_free(ctx, ei, ALLOC_EVENT);
 	}
 	
 	Iterator.free(e_it);
@@ -41,39 +82,36 @@ static void enqueue_command(ui_context ctx, command c) {
 	if (!ctx || !c) return;
 	
 	List.add(ctx->commands, c);
-	printf("   <Dispatch> enqueued command\n");
+	DBLOG("<Dispatch> enqueued command");
 }
 /* dispatches context commands */
 static void dispatch_commands(ui_context ctx) {
-	printf("   <Dispatch> begin\n");
-	fflush(stdout);
+	DBLOG("<Dispatch> begin");
 	if (!ctx || !ctx->commands || List.count(ctx->commands) == 0) return;
 	
 	iterator it = Array.getIterator(ctx->commands, LIST);
-	printf("   <Dispatch> hasIterator=%s\n", it ? "TRUE" : "FALSE");
-	fflush(stdout);
+	DBLOG("<Dispatch> hasIterator=%s", it ? "TRUE" : "FALSE");
 	
 	while (Iterator.hasNext(it)) {
 		command c = Iterator.next(it);
-		printf("   <Dispatch> hasCommand=%s\n", c ? c->name : "FALSE");
-		fflush(stdout);
+		DBLOG("<Dispatch> hasCommand=%s", c ? c->name : "FALSE");
 		
 		if (c->execute) {
-			printf("   <Dispatch> command=%s valid=%s target=%s\n", c->name,
+			DBLOG("<Dispatch> command=%s valid=%s target=%s", c->name,
 					  	c->execute ? "TRUE" : "FALSE", 
-					  	c->target->name ? c->target->name : "NULL");
-			fflush(stdout);
+					  	c->target && c->target->name ? c->target->name : "NULL");
 			
+			uint64_t start = Pacer.now(ctx);
 			c->execute(ctx, c->target);
+			if (c->target) Pacer.charge(c->target, Pacer.now(ctx) - start);
 		}
-		if (c->name) String.free(c->name);
-		Mem.free(c);
+		if (c->name) ui_free(ctx, c->name, ALLOC_STRING);
+		ui_free(ctx, c, ALLOC_COMMAND);
 	}
 	
 	Iterator.free(it);
 	List.clear(ctx->commands);
-	printf("   <Dispatch> end\n");
-	fflush(stdout);
+	DBLOG("<Dispatch> end");
 }
 
 /* dispatcher interface */
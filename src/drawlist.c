@@ -0,0 +1,301 @@
+// drawlist.c
+/**
+ * @detail Draw lists. While a module's `ui_render` callback runs, `Draw.*` calls
+ * 	append window-local commands to the module's draw list and fold them into a
+ * 	running FNV-1a hash. The hash is what the renderer compares against to decide
+ * 	whether the module's vertex data can be reused.
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+/* appends a command to the recording module */
+static void push_cmd(ui_context ctx, const draw_cmd* cmd) {
+	if (!ctx || !ctx->recording) return;
+	draw_list* dl = &ctx->recording->draws;
+
+	if (dl->count == dl->capacity) {
+		int capacity = dl->capacity ? dl->capacity * 2 : 16;
+		draw_cmd* cmds = ui_grow(ctx, dl->cmds, sizeof(draw_cmd) * dl->count,
+										 sizeof(draw_cmd) * capacity, ALLOC_DRAW);
+		if (!cmds) return;
+		dl->cmds = cmds;
+		dl->capacity = capacity;
+	}
+
+	dl->cmds[dl->count++] = *cmd;
+	dl->hash = ui_fnv1a(dl->hash, cmd, sizeof(draw_cmd));
+}
+
+/* visible part of a module in recording space (layers record their whole extent) */
+static ui_rect base_clip(ui_context ctx, ui_module m) {
+	if (!m->win) return (ui_rect){0};
+	if (m->layer.enabled) return ui_layer_rect(m);
+	
+	ui_rect b = ui_module_bounds(m);
+	ui_rect clip;
+	if (!Damage.intersect(b, ui_viewport(ctx), &clip)) return (ui_rect){0};
+	
+	return (ui_rect){ clip.x - b.x, clip.y - b.y, clip.width, clip.height };
+}
+/* starts recording a module (capacity is kept across frames) */
+static void begin_record(ui_context ctx, ui_module m) {
+	m->draws.count = 0;
+	m->draws.text_count = 0;
+	m->draws.culled = 0;
+	m->draws.hash = UI_FNV_OFFSET;
+	m->draws.clip = base_clip(ctx, m);
+	ctx->clips[0] = m->draws.clip;
+	ctx->clip_depth = 1;
+	ctx->recording = m;
+}
+/* finishes recording; a changed list damages the module window */
+static void end_record(ui_context ctx, ui_module m) {
+	ctx->recording = NULL;
+	ctx->clip_depth = 0;
+	m->stats.frames++;
+	m->stats.commands = m->draws.count;
+	m->force_record = 0;
+
+	if (m->recorded && m->draws.hash == m->recorded_hash) return;
+	DBLOG("<Draw> module=%s changed (commands=%d)", m->name, m->draws.count);
+	m->recorded = 1;
+	m->recorded_hash = m->draws.hash;
+	if (m->win) Damage.add(&ctx->damage, ui_window_rect(m));
+}
+/* releases a module's draw list */
+static void release_list(ui_context ctx, ui_module m) {
+	if (m->draws.cmds) ui_free(ctx, m->draws.cmds, ALLOC_DRAW);
+	if (m->draws.text) ui_free(ctx, m->draws.text, ALLOC_DRAW);
+	m->draws = (draw_list){0};
+}
+
+/* filled rectangle, clipped to the clip stack */
+static void draw_rect(ui_context ctx, int x, int y, int w, int h, uint32_t color) {
+	if (w <= 0 || h <= 0 || !ctx || !ctx->recording) return;
+
+	ui_rect clipped;
+	if (!Damage.intersect((ui_rect){ x, y, w, h }, ctx->clips[ctx->clip_depth - 1], &clipped)) {
+		ctx->recording->draws.culled++;
+		return;
+	}
+
+	draw_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));		// hashed as bytes
+	cmd.kind = DRAW_RECT;
+	cmd.color = color;
+	cmd.rect = clipped;
+	cmd.clip = clipped;
+	push_cmd(ctx, &cmd);
+}
+/* shaped primitive: kept whole (corners depend on the full rect) with its clip */
+static void draw_shape(ui_context ctx, uint32_t kind, ui_rect r, int width, int radius, uint32_t color) {
+	if (r.width <= 0 || r.height <= 0 || !ctx || !ctx->recording) return;
+
+	ui_rect clip;
+	if (!Damage.intersect(r, ctx->clips[ctx->clip_depth - 1], &clip)) {
+		ctx->recording->draws.culled++;
+		return;
+	}
+
+	int limit = (r.width < r.height ? r.width : r.height) / 2;
+	draw_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));		// hashed as bytes
+	cmd.kind = kind;
+	cmd.color = color;
+	cmd.rect = r;
+	cmd.clip = clip;
+	cmd.radius = radius < 0 ? 0 : radius > limit ? limit : radius;
+	cmd.border = width < 0 ? 0 : width > limit ? limit : width;
+	push_cmd(ctx, &cmd);
+}
+/* rectangle outline */
+static void draw_border(ui_context ctx, int x, int y, int w, int h, int width, int radius, uint32_t color) {
+	if (width <= 0) return;
+	draw_shape(ctx, DRAW_BORDER, (ui_rect){ x, y, w, h }, width, radius, color);
+}
+/* filled rounded rectangle */
+static void draw_rounded(ui_context ctx, int x, int y, int w, int h, int radius, uint32_t color) {
+	draw_shape(ctx, DRAW_ROUNDED, (ui_rect){ x, y, w, h }, 0, radius, color);
+}
+/* line segment between pixel centers; bounds include the coverage ramp */
+static void draw_line(ui_context ctx, int x0, int y0, int x1, int y1, int width, uint32_t color) {
+	if (width <= 0 || !ctx || !ctx->recording) return;
+	if (width > 0xFFFF) width = 0xFFFF;
+
+	int pad = width / 2 + 2;
+	ui_rect r = { (x0 < x1 ? x0 : x1) - pad, (y0 < y1 ? y0 : y1) - pad,
+					  (x0 < x1 ? x1 - x0 : x0 - x1) + 2 * pad, (y0 < y1 ? y1 - y0 : y0 - y1) + 2 * pad };
+	ui_rect clip;
+	if (!Damage.intersect(r, ctx->clips[ctx->clip_depth - 1], &clip)) {
+		ctx->recording->draws.culled++;
+		return;
+	}
+
+	draw_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));		// hashed as bytes
+	cmd.kind = DRAW_LINE;
+	cmd.color = color;
+	cmd.rect = r;
+	cmd.clip = clip;
+	cmd.border = width;
+	cmd.points[0] = x0;
+	cmd.points[1] = y0;
+	cmd.points[2] = x1;
+	cmd.points[3] = y1;
+	push_cmd(ctx, &cmd);
+}
+/* soft shadow: coverage ramps over `blur` pixels centered on the rect's edge */
+static void draw_shadow(ui_context ctx, int x, int y, int w, int h, int radius, int blur, uint32_t color) {
+	if (w <= 0 || h <= 0 || !ctx || !ctx->recording) return;
+	if (blur < 1) blur = 1;
+	if (blur > 0xFFFF) blur = 0xFFFF;
+
+	int pad = (blur + 1) / 2;
+	ui_rect clip;
+	if (!Damage.intersect((ui_rect){ x - pad, y - pad, w + 2 * pad, h + 2 * pad }, ctx->clips[ctx->clip_depth - 1], &clip)) {
+		ctx->recording->draws.culled++;
+		return;
+	}
+
+	int limit = (w < h ? w : h) / 2;
+	draw_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));		// hashed as bytes
+	cmd.kind = DRAW_SHADOW;
+	cmd.color = color;
+	cmd.rect = (ui_rect){ x, y, w, h };
+	cmd.clip = clip;
+	cmd.radius = radius < 0 ? 0 : radius > limit ? limit : radius;
+	cmd.border = blur;
+	push_cmd(ctx, &cmd);
+}
+/* image scaled into a rect: kept whole (texture coordinates depend on it) with its clip */
+static void draw_image(ui_context ctx, int x, int y, int w, int h, ui_image image, uint32_t placeholder) {
+	if (w <= 0 || h <= 0 || image <= 0 || !ctx || !ctx->recording) return;
+
+	ui_rect clip;
+	if (!Damage.intersect((ui_rect){ x, y, w, h }, ctx->clips[ctx->clip_depth - 1], &clip)) {
+		ctx->recording->draws.culled++;
+		return;
+	}
+
+	draw_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));		// hashed as bytes
+	cmd.kind = DRAW_IMAGE;
+	cmd.color = placeholder;
+	cmd.rect = (ui_rect){ x, y, w, h };
+	cmd.clip = clip;
+	cmd.image = image;
+	push_cmd(ctx, &cmd);
+}
+/* appends a text run (culled against the clip); glyphs are resolved by each render target's atlas */
+static void push_text(ui_context ctx, ui_rect r, ui_font font, const char* text, int length, uint32_t color) {
+	draw_list* dl = &ctx->recording->draws;
+	ui_rect clip;
+	if (!Damage.intersect(r, ctx->clips[ctx->clip_depth - 1], &clip)) {
+		dl->culled++;
+		return;
+	}
+
+	if (dl->text_count + length > dl->text_capacity) {
+		int capacity = dl->text_capacity ? dl->text_capacity : 256;
+		while (capacity < dl->text_count + length) capacity *= 2;
+		char* buffer = ui_grow(ctx, dl->text, dl->text_count, capacity, ALLOC_DRAW);
+		if (!buffer) return;
+		dl->text = buffer;
+		dl->text_capacity = capacity;
+	}
+	memcpy(dl->text + dl->text_count, text, length);
+
+	draw_cmd cmd;
+	memset(&cmd, 0, sizeof(cmd));		// hashed as bytes
+	cmd.kind = DRAW_TEXT;
+	cmd.color = color;
+	cmd.rect = r;
+	cmd.clip = clip;
+	cmd.text = dl->text_count;
+	cmd.length = length;
+	cmd.font = font;
+	dl->text_count += length;
+	dl->hash = ui_fnv1a(dl->hash, text, length);
+	push_cmd(ctx, &cmd);
+}
+/* records a text run (extent from the layout cache) */
+static void draw_text(ui_context ctx, int x, int y, ui_font font, const char* text, uint32_t color) {
+	if (!text || !*text || !ctx || !ctx->recording) return;
+
+	text_layout layout;
+	if (TextCache.layout(ctx, font, text, -1, 0, &layout) != 0) return;
+	push_text(ctx, (ui_rect){ x, y, layout.width, layout.height }, font, text, (int)strlen(text), color);
+}
+/* records the visible lines of wrapped text; returns the text height */
+static int draw_paragraph(ui_context ctx, int x, int y, int wrap, ui_font font, const char* text, uint32_t color) {
+	if (!text || !ctx || !ctx->recording) return 0;
+
+	text_layout layout;
+	if (TextCache.layout(ctx, font, text, -1, wrap, &layout) != 0) return 0;
+
+	//	only lines crossing the clip are looked at
+	ui_rect clip = ctx->clips[ctx->clip_depth - 1];
+	int lh = layout.line_height;
+	int first = clip.y > y ? (clip.y - y) / lh : 0;
+	int last = (clip.y + clip.height - y + lh - 1) / lh;
+	if (last > layout.line_count) last = layout.line_count;
+	if (first > layout.line_count) first = layout.line_count;
+	if (last < first) last = first;
+	ctx->recording->draws.culled += first + layout.line_count - last;
+	for (int i = first; i < last; ++i) {
+		const text_line* line = &layout.lines[i];
+		if (!line->bytes) continue;
+		push_text(ctx, (ui_rect){ x, y + i * lh, line->width, lh }, font, text + line->start, line->bytes, color);
+	}
+
+	return layout.height;
+}
+/* pushes a clip rect; an empty intersection culls everything until popped */
+static int push_clip(ui_context ctx, int x, int y, int w, int h) {
+	if (!ctx || !ctx->recording || ctx->clip_depth >= CLIP_STACK_MAX) return -1;
+
+	ui_rect top = ctx->clips[ctx->clip_depth - 1];
+	ui_rect clip;
+	if (!Damage.intersect((ui_rect){ x, y, w, h }, top, &clip)) clip = (ui_rect){ top.x, top.y, 0, 0 };
+	ctx->clips[ctx->clip_depth++] = clip;
+
+	return 0;
+}
+/* pops a clip rect (the base clip stays) */
+static void pop_clip(ui_context ctx) {
+	if (ctx && ctx->clip_depth > 1) ctx->clip_depth--;
+}
+/* declares a module unchanged (its callback is skipped while retained) */
+static void retain_module(ui_module m, int retain) {
+	if (m) m->retained = retain ? 1 : 0;
+}
+/* commands in a module's current draw list */
+static int command_count(ui_module m) {
+	return m ? m->draws.count : 0;
+}
+
+/* draw list interface (internal) */
+const IDrawList DrawList = {
+	.base_clip = base_clip,
+	.begin = begin_record,
+	.end = end_record,
+	.release = release_list
+};
+/* draw interface */
+const IDraw Draw = {
+	.rect = draw_rect,
+	.border = draw_border,
+	.rounded = draw_rounded,
+	.line = draw_line,
+	.shadow = draw_shadow,
+	.image = draw_image,
+	.text = draw_text,
+	.paragraph = draw_paragraph,
+	.push_clip = push_clip,
+	.pop_clip = pop_clip,
+	.retain = retain_module,
+	.count = command_count
+};
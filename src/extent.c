@@ -0,0 +1,164 @@
+// extent.c
+/**
+ * @detail Extent index: the sizes of a long run of items (list rows, grid rows
+ * 	or columns) with O(log n) offset <-> item lookups. Items are grouped into
+ * 	blocks of EXTENT_BLOCK; a Fenwick tree holds the block sums and a lookup
+ * 	scans at most one block. Sizes are 16-bit with 0 meaning the default size,
+ * 	so an index starts out as plain arithmetic and only allocates its arrays
+ * 	(2 bytes per item) when the first item gets an explicit size.
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+static inline int item_size(const extent_index* ei, int i) {
+	return ei->sizes && ei->sizes[i] ? ei->sizes[i] : ei->size;
+}
+static int64_t block_sum(const extent_index* ei, int b) {
+	int first = b * EXTENT_BLOCK;
+	int last = first + EXTENT_BLOCK < ei->count ? first + EXTENT_BLOCK : ei->count;
+	int64_t sum = 0;
+	for (int i = first; i < last; ++i) sum += item_size(ei, i);
+
+	return sum;
+}
+/* sum of blocks [0, b) */
+static int64_t prefix(const extent_index* ei, int b) {
+	int64_t sum = 0;
+	for (; b > 0; b -= b & -b) sum += ei->tree[b];
+
+	return sum;
+}
+/* builds the Fenwick tree from the block sums in O(blocks) */
+static void build_tree(extent_index* ei) {
+	for (int i = 1; i <= ei->blocks; ++i) ei->tree[i] = block_sum(ei, i - 1);
+	for (int i = 1; i <= ei->blocks; ++i) {
+		int j = i + (i & -i);
+		if (j <= ei->blocks) ei->tree[j] += ei->tree[i];
+	}
+}
+/* (re)allocates the size array and tree for `count` items, keeping known sizes */
+static int allocate(ui_context ctx, extent_index* ei, int count) {
+	int blocks = (count + EXTENT_BLOCK - 1) / EXTENT_BLOCK;
+	uint16_t* sizes = ui_alloc(ctx, sizeof(uint16_t) * (count ? count : 1), ALLOC_WIDGET);
+	int64_t* tree = ui_alloc(ctx, sizeof(int64_t) * (blocks + 1), ALLOC_WIDGET);
+	if (!sizes || !tree) {
+		if (sizes) ui_free(ctx, sizes, ALLOC_WIDGET);
+		if (tree) ui_free(ctx, tree, ALLOC_WIDGET);
+		return -1;
+	}
+
+	if (ei->sizes) {
+		int kept = count < ei->count ? count : ei->count;
+		memcpy(sizes, ei->sizes, sizeof(uint16_t) * kept);
+		ei->measured = 0;
+		for (int i = 0; i < kept; ++i) ei->measured += sizes[i] != 0;
+		ui_free(ctx, ei->sizes, ALLOC_WIDGET);
+	}
+	if (ei->tree) ui_free(ctx, ei->tree, ALLOC_WIDGET);
+	ei->sizes = sizes;
+	ei->tree = tree;
+	ei->count = count;
+	ei->blocks = blocks;
+	build_tree(ei);
+
+	return 0;
+}
+
+//	Extent Index ================================================================
+/* starts an index where every item has the default size (nothing allocated) */
+static void init_index(extent_index* ei, int count, int size) {
+	memset(ei, 0, sizeof(extent_index));
+	ei->count = count > 0 ? count : 0;
+	ei->blocks = (ei->count + EXTENT_BLOCK - 1) / EXTENT_BLOCK;
+	ei->size = size > 0 ? size : 1;
+}
+static int resize_index(ui_context ctx, extent_index* ei, int count) {
+	if (count < 0) count = 0;
+	if (!ei->sizes) {
+		ei->count = count;
+		ei->blocks = (count + EXTENT_BLOCK - 1) / EXTENT_BLOCK;
+		return 0;
+	}
+
+	return allocate(ctx, ei, count);
+}
+/* O(log n): updates the item and every tree node covering its block */
+static int set_size(ui_context ctx, extent_index* ei, int i, int size) {
+	if (i < 0 || i >= ei->count) return -1;
+	if (size < 1) size = 1;
+	if (size > UINT16_MAX) size = UINT16_MAX;
+	if (!ei->sizes && allocate(ctx, ei, ei->count) != 0) return -1;
+
+	int64_t delta = size - item_size(ei, i);
+	if (!ei->sizes[i]) ei->measured++;
+	ei->sizes[i] = (uint16_t)size;
+	for (int b = i / EXTENT_BLOCK + 1; delta && b <= ei->blocks; b += b & -b) ei->tree[b] += delta;
+
+	return 0;
+}
+static int get_size(const extent_index* ei, int i) {
+	return i >= 0 && i < ei->count ? item_size(ei, i) : 0;
+}
+static int is_measured(const extent_index* ei, int i) {
+	return ei->sizes && i >= 0 && i < ei->count && ei->sizes[i];
+}
+static int64_t item_offset(const extent_index* ei, int i) {
+	if (i <= 0) return 0;
+	if (i > ei->count) i = ei->count;
+	if (!ei->sizes) return (int64_t)i * ei->size;
+
+	int b = i / EXTENT_BLOCK;
+	int64_t offset = prefix(ei, b);
+	for (int j = b * EXTENT_BLOCK; j < i; ++j) offset += item_size(ei, j);
+
+	return offset;
+}
+/* O(log n): descends the Fenwick tree to the block, then scans inside it */
+static int item_at(const extent_index* ei, int64_t offset) {
+	if (ei->count == 0 || offset <= 0) return 0;
+	if (!ei->sizes) {
+		int64_t i = offset / ei->size;
+		return i < ei->count ? (int)i : ei->count - 1;
+	}
+
+	int b = 0;
+	int step = 1;
+	while (step * 2 <= ei->blocks) step *= 2;
+	for (; step; step >>= 1) {
+		if (b + step <= ei->blocks && ei->tree[b + step] <= offset) {
+			b += step;
+			offset -= ei->tree[b];
+		}
+	}
+	if (b >= ei->blocks) return ei->count - 1;
+
+	int i = b * EXTENT_BLOCK;
+	while (i < ei->count - 1 && offset >= item_size(ei, i)) offset -= item_size(ei, i++);
+
+	return i;
+}
+static int64_t total_size(const extent_index* ei) {
+	return ei->sizes ? prefix(ei, ei->blocks) : (int64_t)ei->count * ei->size;
+}
+static void release_index(ui_context ctx, extent_index* ei) {
+	if (ei->sizes) ui_free(ctx, ei->sizes, ALLOC_WIDGET);
+	if (ei->tree) ui_free(ctx, ei->tree, ALLOC_WIDGET);
+	ei->sizes = NULL;
+	ei->tree = NULL;
+	ei->measured = 0;
+}
+
+/* item extent index interface (internal) */
+const IExtent Extent = {
+	.init = init_index,
+	.resize = resize_index,
+	.set = set_size,
+	.size = get_size,
+	.measured = is_measured,
+	.offset = item_offset,
+	.index = item_at,
+	.total = total_size,
+	.release = release_index
+};
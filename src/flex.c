@@ -0,0 +1,340 @@
+// flex.c
+/**
+ * @detail Flex layout. Nodes live in one array linked by ids (parent, first and
+ * 	last child, siblings); removed slots are chained into a free list. Each node
+ * 	keeps its measured size and placed rect between updates, and three flags:
+ * 	`dirty` (re-measure), `relayout` (re-place the children) and `pending` (a
+ * 	descendant has work; every ancestor of a flagged node is pending).
+ * 	An update runs two passes along pending paths only. Measuring is bottom-up
+ * 	and stops climbing where a size comes out unchanged; a parent whose child
+ * 	changed size re-places its children. Placing is top-down: a child whose size
+ * 	changed is re-placed in turn, a child that only moved has its subtree
+ * 	shifted, and anything else is left alone.
+ */
+
+#include <math.h>
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+static inline int clamp_size(int v, int lo, int hi) {
+	if (hi > 0 && v > hi) v = hi;
+	return v < lo ? lo : v;
+}
+static inline flex_node* node_at(flex_tree* t, int id) {
+	return id >= 0 && id < t->count && t->nodes[id].used ? &t->nodes[id] : NULL;
+}
+/* flags every ancestor pending (stops at one already pending) */
+static void mark_pending(flex_tree* t, flex_node* n) {
+	for (int p = n->parent; p >= 0 && !t->nodes[p].pending; p = t->nodes[p].parent) t->nodes[p].pending = 1;
+}
+/* a node's size inputs changed */
+static void mark_dirty(flex_tree* t, flex_node* n) {
+	n->dirty = n->relayout = 1;
+	mark_pending(t, n);
+}
+/* the root exists from the first node on */
+static int ensure_root(ui_context ctx) {
+	flex_tree* t = &ctx->flex;
+	if (t->count) return 0;
+
+	t->nodes = ui_grow(ctx, NULL, 0, sizeof(flex_node) * 16, ALLOC_FLEX);
+	if (!t->nodes) return -1;
+	t->capacity = 16;
+	t->count = 1;
+	t->free = -1;
+	t->nodes[0] = (flex_node){ .module = NULL, .parent = -1, .first = -1, .last = -1, .prev = -1, .next = -1, .used = 1, .dirty = 1, .relayout = 1 };
+	t->stats.nodes = 1;
+
+	return 0;
+}
+/* a free slot (-1: out of memory) */
+static int new_slot(ui_context ctx) {
+	flex_tree* t = &ctx->flex;
+	if (t->free >= 0) {
+		int id = t->free;
+		t->free = t->nodes[id].next;
+		return id;
+	}
+	if (t->count == t->capacity) {
+		flex_node* grown = ui_grow(ctx, t->nodes, sizeof(flex_node) * t->count, sizeof(flex_node) * t->capacity * 2, ALLOC_FLEX);
+		if (!grown) return -1;
+		t->nodes = grown;
+		t->capacity *= 2;
+	}
+
+	return t->count++;
+}
+/* returns a subtree's slots to the free list */
+static void free_subtree(flex_tree* t, int id) {
+	for (int c = t->nodes[id].first; c >= 0; ) {
+		int next = t->nodes[c].next;
+		free_subtree(t, c);
+		c = next;
+	}
+	t->nodes[id].used = 0;
+	t->nodes[id].next = t->free;
+	t->free = id;
+	t->stats.nodes--;
+}
+/* writes a node's rect into its module window */
+static void write_window(flex_tree* t, flex_node* n) {
+	ui_module m = n->module;
+	if (!m) return;
+
+	ui_rect r = n->rect;
+	if (!m->win) m->win = Sigui.new_window(m->ctx, r.x, r.y, r.width, r.height);
+	else {
+		m->win->x = r.x;
+		m->win->y = r.y;
+		m->win->width = r.width;
+		m->win->height = r.height;
+	}
+	t->stats.written++;
+}
+/* size from the style and the children (or the content) */
+static void measure(flex_tree* t, flex_node* n) {
+	const flex_style* s = &n->style;
+	int w = n->content_width, h = n->content_height;
+	if (n->first >= 0) {
+		int row = s->direction == FLEX_ROW;
+		int main = 0, cross = 0, k = 0;
+		for (int c = n->first; c >= 0; c = t->nodes[c].next, ++k) {
+			flex_node* child = &t->nodes[c];
+			main += row ? child->width : child->height;
+			int b = row ? child->height : child->width;
+			if (b > cross) cross = b;
+		}
+		main += s->gap * (k - 1);
+		w = row ? main : cross;
+		h = row ? cross : main;
+	}
+
+	n->width = clamp_size(s->width > 0 ? s->width : w + s->padding[0] + s->padding[2], s->min_width, s->max_width);
+	n->height = clamp_size(s->height > 0 ? s->height : h + s->padding[1] + s->padding[3], s->min_height, s->max_height);
+	t->stats.measured++;
+}
+/* measures the dirty nodes under a pending path; 1 when the node's size changed */
+static int remeasure(flex_tree* t, flex_node* n) {
+	int children = 0;
+	if (n->pending) {
+		for (int c = n->first; c >= 0; c = t->nodes[c].next) {
+			flex_node* child = &t->nodes[c];
+			if ((child->pending || child->dirty) && remeasure(t, child)) children = 1;
+		}
+	}
+	if (!n->dirty && !children) return 0;
+
+	//	a child changed size: the children are re-placed even if this size holds
+	if (children) n->relayout = 1;
+	int w = n->width, h = n->height;
+	measure(t, n);
+	n->dirty = 0;
+
+	return w != n->width || h != n->height;
+}
+/* shifts a subtree that moved without changing size */
+static void translate(flex_tree* t, flex_node* n, int dx, int dy) {
+	n->rect.x += dx;
+	n->rect.y += dy;
+	write_window(t, n);
+	t->stats.moved++;
+	for (int c = n->first; c >= 0; c = t->nodes[c].next) translate(t, &t->nodes[c], dx, dy);
+}
+/* gives a node its rect; a new size re-places its children */
+static void place(flex_tree* t, flex_node* n, ui_rect r) {
+	ui_rect o = n->rect;
+	if (o.width != r.width || o.height != r.height) {
+		n->rect = r;
+		n->relayout = 1;
+	} else if (o.x != r.x || o.y != r.y) translate(t, n, r.x - o.x, r.y - o.y);
+}
+/* places the children of a node along its main axis */
+static void arrange(flex_tree* t, flex_node* n) {
+	const flex_style* s = &n->style;
+	int row = s->direction == FLEX_ROW;
+	int ix = n->rect.x + s->padding[0], iy = n->rect.y + s->padding[1];
+	int iw = n->rect.width - s->padding[0] - s->padding[2], ih = n->rect.height - s->padding[1] - s->padding[3];
+	if (iw < 0) iw = 0;
+	if (ih < 0) ih = 0;
+	int avail = row ? iw : ih, cross = row ? ih : iw;
+
+	int k = 0, basis = 0;
+	float grow = 0, shrink = 0;
+	for (int c = n->first; c >= 0; c = t->nodes[c].next, ++k) {
+		flex_node* child = &t->nodes[c];
+		int b = row ? child->width : child->height;
+		basis += b;
+		grow += child->style.grow;
+		shrink += child->style.shrink * b;
+	}
+	int free = avail - basis - (k > 0 ? s->gap * (k - 1) : 0);
+
+	//	leftover space no child takes is placed by justify
+	float pos = 0, between = s->gap;
+	if (free > 0 && grow <= 0) {
+		if (s->justify == FLEX_JUSTIFY_CENTER) pos = free / 2.0f;
+		else if (s->justify == FLEX_JUSTIFY_END) pos = (float)free;
+		else if (s->justify == FLEX_JUSTIFY_SPACE_BETWEEN && k > 1) between += (float)free / (k - 1);
+	}
+	for (int c = n->first; c >= 0; c = t->nodes[c].next) {
+		flex_node* child = &t->nodes[c];
+		const flex_style* cs = &child->style;
+		int b = row ? child->width : child->height;
+		float size = (float)b;
+		if (free > 0 && grow > 0) size += free * cs->grow / grow;
+		else if (free < 0 && shrink > 0) size += free * (cs->shrink * b) / shrink;
+
+		//	rounding the running edge keeps neighbours flush
+		int start = (int)lroundf(pos);
+		pos += size;
+		int main = row ? clamp_size((int)lroundf(pos) - start, cs->min_width, cs->max_width)
+						   : clamp_size((int)lroundf(pos) - start, cs->min_height, cs->max_height);
+		pos += between;
+
+		int fixed = row ? cs->height : cs->width;
+		int span = s->align == FLEX_ALIGN_STRETCH && fixed <= 0 ? cross : row ? child->height : child->width;
+		span = row ? clamp_size(span, cs->min_height, cs->max_height) : clamp_size(span, cs->min_width, cs->max_width);
+		int offset = s->align == FLEX_ALIGN_CENTER ? (cross - span) / 2 : s->align == FLEX_ALIGN_END ? cross - span : 0;
+
+		place(t, child, row ? (ui_rect){ ix + start, iy + offset, main, span } : (ui_rect){ ix + offset, iy + start, span, main });
+	}
+	t->stats.arranged++;
+}
+/* re-places flagged nodes top-down along pending paths */
+static void descend(flex_tree* t, flex_node* n) {
+	if (n->relayout) {
+		write_window(t, n);
+		arrange(t, n);
+	}
+	if (n->relayout || n->pending) {
+		for (int c = n->first; c >= 0; c = t->nodes[c].next) {
+			flex_node* child = &t->nodes[c];
+			if (child->relayout || child->pending) descend(t, child);
+		}
+	}
+	n->relayout = n->pending = 0;
+}
+
+//	Flex Interface ==============================================================
+/* appends a node as the last child of a parent */
+static int add_node(ui_context ctx, int parent, const flex_style* style, ui_module m) {
+	if (!ctx || ensure_root(ctx) != 0) return -1;
+	flex_tree* t = &ctx->flex;
+	if (!node_at(t, parent)) return -1;
+
+	int id = new_slot(ctx);
+	if (id < 0) return -1;
+	flex_node* p = &t->nodes[parent];
+	t->nodes[id] = (flex_node){ .module = m, .parent = parent, .first = -1, .last = -1, .prev = p->last, .next = -1, .used = 1 };
+	if (style) t->nodes[id].style = *style;
+	if (p->last >= 0) t->nodes[p->last].next = id;
+	else p->first = id;
+	p->last = id;
+	t->stats.nodes++;
+
+	mark_dirty(t, &t->nodes[id]);
+	mark_dirty(t, p);
+
+	return id;
+}
+/* unlinks a node and frees its subtree */
+static int remove_node(ui_context ctx, int id) {
+	if (!ctx || id == FLEX_ROOT) return -1;
+	flex_tree* t = &ctx->flex;
+	flex_node* n = node_at(t, id);
+	if (!n) return -1;
+
+	flex_node* p = &t->nodes[n->parent];
+	if (n->prev >= 0) t->nodes[n->prev].next = n->next;
+	else p->first = n->next;
+	if (n->next >= 0) t->nodes[n->next].prev = n->prev;
+	else p->last = n->prev;
+	n->next = -1;
+	free_subtree(t, id);
+	mark_dirty(t, p);
+
+	return 0;
+}
+/* the parent re-places its children too: grow, shrink and bounds are its inputs */
+static int set_style(ui_context ctx, int id, const flex_style* style) {
+	if (!ctx || !style || ensure_root(ctx) != 0) return -1;
+	flex_tree* t = &ctx->flex;
+	flex_node* n = node_at(t, id);
+	if (!n) return -1;
+
+	n->style = *style;
+	mark_dirty(t, n);
+	if (n->parent >= 0) {
+		t->nodes[n->parent].relayout = 1;
+		mark_pending(t, &t->nodes[n->parent]);
+	}
+
+	return 0;
+}
+static int set_content(ui_context ctx, int id, int width, int height) {
+	if (!ctx) return -1;
+	flex_tree* t = &ctx->flex;
+	flex_node* n = node_at(t, id);
+	if (!n) return -1;
+	if (n->content_width == width && n->content_height == height) return 0;
+
+	n->content_width = width;
+	n->content_height = height;
+	mark_dirty(t, n);
+
+	return 0;
+}
+static void resize_root(ui_context ctx, int width, int height) {
+	if (!ctx || ensure_root(ctx) != 0) return;
+	flex_tree* t = &ctx->flex;
+	if (t->width == width && t->height == height) return;
+
+	t->width = width;
+	t->height = height;
+	t->nodes[0].pending = 1;
+}
+/* measure up, then place down, along the pending paths */
+static int update_layout(ui_context ctx) {
+	if (!ctx || !ctx->flex.count) return 0;
+	flex_tree* t = &ctx->flex;
+	flex_node* root = &t->nodes[0];
+	if (!root->pending && !root->dirty && !root->relayout) return 0;
+
+	t->stats.measured = t->stats.arranged = t->stats.moved = t->stats.written = 0;
+	t->stats.updates++;
+	remeasure(t, root);
+	place(t, root, (ui_rect){ 0, 0, t->width > 0 ? t->width : root->width, t->height > 0 ? t->height : root->height });
+	descend(t, root);
+	DBLOG("<Flex> update measured=%d arranged=%d moved=%d", t->stats.measured, t->stats.arranged, t->stats.moved);
+
+	return t->stats.arranged;
+}
+static ui_rect node_rect(ui_context ctx, int id) {
+	flex_node* n = ctx ? node_at(&ctx->flex, id) : NULL;
+
+	return n ? n->rect : (ui_rect){ 0 };
+}
+static void flex_statistics(ui_context ctx, flex_stats* out) {
+	if (ctx && out) *out = ctx->flex.stats;
+}
+static void release_flex(ui_context ctx) {
+	if (ctx->flex.nodes) ui_free(ctx, ctx->flex.nodes, ALLOC_FLEX);
+	ctx->flex = (flex_tree){ 0 };
+}
+
+/* flex interface */
+const IFlex Flex = {
+	.node = add_node,
+	.remove = remove_node,
+	.style = set_style,
+	.content = set_content,
+	.resize = resize_root,
+	.update = update_layout,
+	.rect = node_rect,
+	.stats = flex_statistics
+};
+/* flex tree interface (internal) */
+const IFlexTree FlexTree = {
+	.release = release_flex
+};
@@ -0,0 +1,323 @@
+// font.c
+/**
+ * @detail Fonts and glyph rasterization. UI_FONT_DEFAULT is a built-in 8x16
+ * 	bitmap font (printable ASCII; other codepoints draw as '?'). With
+ * 	SIGUI_FREETYPE defined, `Font.load` opens TrueType faces through FreeType;
+ * 	each face has its own lock so render targets on different threads can
+ * 	rasterize concurrently. Handles are never reused, so a glyph cached under a
+ * 	freed font can not alias a later one.
+ */
+
+#include <pthread.h>
+#include "ui_core.h"
+#include "sigui_debug.h"
+#ifdef SIGUI_FREETYPE
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#endif
+
+#define FONT_MAX 64					/* fonts loaded per process (handles are not reused) */
+#define BUILTIN_WIDTH 8
+#define BUILTIN_HEIGHT 16
+#define BUILTIN_FIRST 32
+#define BUILTIN_LAST 126
+#define ADVANCE_CACHE 128			/* codepoints with cached advances */
+
+/* loaded font */
+typedef struct font_face_s {
+	int live;							/* loaded and not freed */
+	int height;							/* line height */
+#ifdef SIGUI_FREETYPE
+	FT_Face face;						/* FreeType face (guarded by lock) */
+	pthread_mutex_t lock;
+	int ascent;							/* baseline below the line top */
+	int16_t advances[ADVANCE_CACHE];
+#endif
+} font_face;
+
+//	Engine State ================================================================
+static font_face fonts[FONT_MAX];	/* slot 0: UI_FONT_DEFAULT */
+static int font_count = 1;
+static pthread_mutex_t font_lock = PTHREAD_MUTEX_INITIALIZER;
+#ifdef SIGUI_FREETYPE
+static FT_Library library = NULL;
+#endif
+
+/* built-in font: one byte per row, MSB leftmost (rasterized from DejaVu Sans Mono, 13px) */
+static const uint8_t BUILTIN_GLYPHS[BUILTIN_LAST - BUILTIN_FIRST + 1][BUILTIN_HEIGHT] = {
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* ' ' */
+	{0x00,0x00,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x10,0x10,0x00,0x00,0x00,0x00,0x00},	/* '!' */
+	{0x00,0x00,0x28,0x28,0x28,0x28,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* '"' */
+	{0x00,0x12,0x12,0x16,0x7F,0x24,0x24,0xFE,0x28,0x48,0x48,0x00,0x00,0x00,0x00,0x00},	/* '#' */
+	{0x00,0x00,0x08,0x3E,0x49,0x48,0x38,0x0E,0x09,0x49,0x3E,0x08,0x08,0x00,0x00,0x00},	/* '$' */
+	{0x00,0x00,0x60,0x90,0x90,0x62,0x1C,0x66,0x09,0x09,0x06,0x00,0x00,0x00,0x00,0x00},	/* '%' */
+	{0x00,0x00,0x1C,0x20,0x20,0x30,0x49,0x4D,0x45,0x62,0x3D,0x00,0x00,0x00,0x00,0x00},	/* '&' */
+	{0x00,0x00,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* ''' */
+	{0x0C,0x08,0x08,0x10,0x10,0x10,0x10,0x10,0x10,0x08,0x08,0x04,0x00,0x00,0x00,0x00},	/* '(' */
+	{0x30,0x10,0x10,0x08,0x08,0x08,0x08,0x08,0x08,0x10,0x10,0x30,0x00,0x00,0x00,0x00},	/* ')' */
+	{0x00,0x00,0x08,0x49,0x3E,0x1C,0x6B,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* '*' */
+	{0x00,0x00,0x00,0x10,0x10,0x10,0xFE,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00,0x00},	/* '+' */
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x10,0x20,0x00,0x00,0x00},	/* ',' */
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x38,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* '-' */
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00,0x00},	/* '.' */
+	{0x00,0x00,0x02,0x04,0x04,0x08,0x08,0x18,0x10,0x10,0x20,0x20,0x40,0x00,0x00,0x00},	/* '/' */
+	{0x00,0x00,0x1C,0x22,0x41,0x41,0x49,0x41,0x41,0x22,0x1C,0x00,0x00,0x00,0x00,0x00},	/* '0' */
+	{0x00,0x00,0x38,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x3E,0x00,0x00,0x00,0x00,0x00},	/* '1' */
+	{0x00,0x00,0x3E,0x43,0x01,0x01,0x02,0x0C,0x18,0x20,0x7F,0x00,0x00,0x00,0x00,0x00},	/* '2' */
+	{0x00,0x00,0x3E,0x41,0x01,0x03,0x1C,0x03,0x01,0x43,0x3E,0x00,0x00,0x00,0x00,0x00},	/* '3' */
+	{0x00,0x00,0x06,0x0A,0x1A,0x12,0x22,0x42,0x7F,0x02,0x02,0x00,0x00,0x00,0x00,0x00},	/* '4' */
+	{0x00,0x00,0x7E,0x40,0x40,0x7C,0x03,0x01,0x01,0x43,0x3C,0x00,0x00,0x00,0x00,0x00},	/* '5' */
+	{0x00,0x00,0x1E,0x21,0x40,0x5E,0x63,0x41,0x41,0x23,0x1E,0x00,0x00,0x00,0x00,0x00},	/* '6' */
+	{0x00,0x00,0x7F,0x02,0x02,0x04,0x04,0x08,0x18,0x10,0x20,0x00,0x00,0x00,0x00,0x00},	/* '7' */
+	{0x00,0x00,0x3E,0x41,0x41,0x41,0x3E,0x63,0x41,0x61,0x3E,0x00,0x00,0x00,0x00,0x00},	/* '8' */
+	{0x00,0x00,0x3C,0x62,0x41,0x41,0x63,0x3D,0x01,0x42,0x3C,0x00,0x00,0x00,0x00,0x00},	/* '9' */
+	{0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00,0x00},	/* ':' */
+	{0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x10,0x20,0x00,0x00,0x00},	/* ';' */
+	{0x00,0x00,0x00,0x00,0x01,0x0E,0x70,0x70,0x0E,0x01,0x00,0x00,0x00,0x00,0x00,0x00},	/* '<' */
+	{0x00,0x00,0x00,0x00,0x00,0x7F,0x00,0x00,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* '=' */
+	{0x00,0x00,0x00,0x00,0x40,0x38,0x07,0x07,0x38,0x40,0x00,0x00,0x00,0x00,0x00,0x00},	/* '>' */
+	{0x00,0x00,0x38,0x44,0x04,0x08,0x10,0x10,0x00,0x10,0x10,0x00,0x00,0x00,0x00,0x00},	/* '?' */
+	{0x00,0x00,0x1E,0x33,0x21,0x47,0x49,0x49,0x49,0x47,0x20,0x30,0x1E,0x00,0x00,0x00},	/* '@' */
+	{0x00,0x00,0x08,0x14,0x14,0x14,0x22,0x22,0x3E,0x63,0x41,0x00,0x00,0x00,0x00,0x00},	/* 'A' */
+	{0x00,0x00,0x7E,0x41,0x41,0x41,0x7E,0x41,0x41,0x41,0x7E,0x00,0x00,0x00,0x00,0x00},	/* 'B' */
+	{0x00,0x00,0x1E,0x21,0x40,0x40,0x40,0x40,0x40,0x21,0x1E,0x00,0x00,0x00,0x00,0x00},	/* 'C' */
+	{0x00,0x00,0x7C,0x42,0x41,0x41,0x41,0x41,0x41,0x42,0x7C,0x00,0x00,0x00,0x00,0x00},	/* 'D' */
+	{0x00,0x00,0x7F,0x40,0x40,0x40,0x7F,0x40,0x40,0x40,0x7F,0x00,0x00,0x00,0x00,0x00},	/* 'E' */
+	{0x00,0x00,0x7F,0x40,0x40,0x40,0x7F,0x40,0x40,0x40,0x40,0x00,0x00,0x00,0x00,0x00},	/* 'F' */
+	{0x00,0x00,0x1E,0x21,0x40,0x40,0x43,0x41,0x41,0x21,0x1E,0x00,0x00,0x00,0x00,0x00},	/* 'G' */
+	{0x00,0x00,0x41,0x41,0x41,0x41,0x7F,0x41,0x41,0x41,0x41,0x00,0x00,0x00,0x00,0x00},	/* 'H' */
+	{0x00,0x00,0x7C,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x7C,0x00,0x00,0x00,0x00,0x00},	/* 'I' */
+	{0x00,0x00,0x1C,0x04,0x04,0x04,0x04,0x04,0x04,0x44,0x38,0x00,0x00,0x00,0x00,0x00},	/* 'J' */
+	{0x00,0x00,0x42,0x44,0x48,0x50,0x70,0x48,0x44,0x44,0x42,0x00,0x00,0x00,0x00,0x00},	/* 'K' */
+	{0x00,0x00,0x40,0x40,0x40,0x40,0x40,0x40,0x40,0x40,0x7F,0x00,0x00,0x00,0x00,0x00},	/* 'L' */
+	{0x00,0x00,0x63,0x63,0x55,0x55,0x55,0x49,0x41,0x41,0x41,0x00,0x00,0x00,0x00,0x00},	/* 'M' */
+	{0x00,0x00,0x61,0x61,0x51,0x51,0x49,0x45,0x45,0x43,0x43,0x00,0x00,0x00,0x00,0x00},	/* 'N' */
+	{0x00,0x00,0x1C,0x22,0x41,0x41,0x41,0x41,0x41,0x22,0x1C,0x00,0x00,0x00,0x00,0x00},	/* 'O' */
+	{0x00,0x00,0x7E,0x43,0x41,0x41,0x43,0x7E,0x40,0x40,0x40,0x00,0x00,0x00,0x00,0x00},	/* 'P' */
+	{0x00,0x00,0x1C,0x22,0x41,0x41,0x41,0x41,0x41,0x23,0x1E,0x06,0x02,0x00,0x00,0x00},	/* 'Q' */
+	{0x00,0x00,0x7E,0x43,0x41,0x41,0x7E,0x42,0x41,0x41,0x40,0x00,0x00,0x00,0x00,0x00},	/* 'R' */
+	{0x00,0x00,0x3E,0x61,0x40,0x60,0x3E,0x03,0x01,0x43,0x3E,0x00,0x00,0x00,0x00,0x00},	/* 'S' */
+	{0x00,0x00,0xFE,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00},	/* 'T' */
+	{0x00,0x00,0x41,0x41,0x41,0x41,0x41,0x41,0x41,0x41,0x3E,0x00,0x00,0x00,0x00,0x00},	/* 'U' */
+	{0x00,0x00,0x41,0x63,0x22,0x22,0x22,0x14,0x14,0x14,0x08,0x00,0x00,0x00,0x00,0x00},	/* 'V' */
+	{0x00,0x00,0x81,0x81,0x81,0x5A,0x5A,0x5A,0x66,0x66,0x66,0x00,0x00,0x00,0x00,0x00},	/* 'W' */
+	{0x00,0x00,0x63,0x22,0x14,0x1C,0x08,0x14,0x36,0x22,0x41,0x00,0x00,0x00,0x00,0x00},	/* 'X' */
+	{0x00,0x00,0x82,0x44,0x28,0x28,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00},	/* 'Y' */
+	{0x00,0x00,0x7F,0x03,0x06,0x04,0x08,0x10,0x30,0x60,0x7F,0x00,0x00,0x00,0x00,0x00},	/* 'Z' */
+	{0x1C,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x1C,0x00,0x00,0x00,0x00},	/* '[' */
+	{0x00,0x00,0x40,0x20,0x20,0x10,0x10,0x18,0x08,0x08,0x04,0x04,0x02,0x00,0x00,0x00},	/* '\' */
+	{0x38,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x38,0x00,0x00,0x00,0x00},	/* ']' */
+	{0x00,0x00,0x10,0x28,0x44,0xC6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* '^' */
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x00,0x00},	/* '_' */
+	{0x00,0x10,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* '`' */
+	{0x00,0x00,0x00,0x00,0x1C,0x22,0x02,0x3E,0x42,0x46,0x3A,0x00,0x00,0x00,0x00,0x00},	/* 'a' */
+	{0x40,0x40,0x40,0x40,0x7C,0x66,0x42,0x42,0x42,0x66,0x7C,0x00,0x00,0x00,0x00,0x00},	/* 'b' */
+	{0x00,0x00,0x00,0x00,0x1C,0x22,0x40,0x40,0x40,0x22,0x1C,0x00,0x00,0x00,0x00,0x00},	/* 'c' */
+	{0x02,0x02,0x02,0x02,0x3E,0x66,0x42,0x42,0x42,0x66,0x3E,0x00,0x00,0x00,0x00,0x00},	/* 'd' */
+	{0x00,0x00,0x00,0x00,0x3C,0x66,0x42,0x7E,0x40,0x62,0x3C,0x00,0x00,0x00,0x00,0x00},	/* 'e' */
+	{0x0C,0x10,0x10,0x10,0x7C,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00},	/* 'f' */
+	{0x00,0x00,0x00,0x00,0x3E,0x66,0x42,0x42,0x42,0x66,0x3A,0x02,0x22,0x1C,0x00,0x00},	/* 'g' */
+	{0x40,0x40,0x40,0x40,0x5C,0x62,0x42,0x42,0x42,0x42,0x42,0x00,0x00,0x00,0x00,0x00},	/* 'h' */
+	{0x10,0x00,0x00,0x00,0x70,0x10,0x10,0x10,0x10,0x10,0x7C,0x00,0x00,0x00,0x00,0x00},	/* 'i' */
+	{0x08,0x00,0x00,0x00,0x38,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x70,0x00,0x00},	/* 'j' */
+	{0x40,0x40,0x40,0x40,0x44,0x48,0x50,0x70,0x48,0x44,0x42,0x00,0x00,0x00,0x00,0x00},	/* 'k' */
+	{0x70,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x0E,0x00,0x00,0x00,0x00,0x00},	/* 'l' */
+	{0x00,0x00,0x00,0x00,0x7F,0x49,0x49,0x49,0x49,0x49,0x49,0x00,0x00,0x00,0x00,0x00},	/* 'm' */
+	{0x00,0x00,0x00,0x00,0x5C,0x62,0x42,0x42,0x42,0x42,0x42,0x00,0x00,0x00,0x00,0x00},	/* 'n' */
+	{0x00,0x00,0x00,0x00,0x3C,0x66,0x42,0x42,0x42,0x66,0x3C,0x00,0x00,0x00,0x00,0x00},	/* 'o' */
+	{0x00,0x00,0x00,0x00,0x7C,0x66,0x42,0x42,0x42,0x66,0x7C,0x40,0x40,0x40,0x00,0x00},	/* 'p' */
+	{0x00,0x00,0x00,0x00,0x3E,0x66,0x42,0x42,0x42,0x66,0x3A,0x02,0x02,0x02,0x00,0x00},	/* 'q' */
+	{0x00,0x00,0x00,0x00,0x3C,0x32,0x20,0x20,0x20,0x20,0x20,0x00,0x00,0x00,0x00,0x00},	/* 'r' */
+	{0x00,0x00,0x00,0x00,0x3C,0x42,0x40,0x3C,0x02,0x42,0x3C,0x00,0x00,0x00,0x00,0x00},	/* 's' */
+	{0x00,0x00,0x10,0x10,0x7E,0x10,0x10,0x10,0x10,0x10,0x0E,0x00,0x00,0x00,0x00,0x00},	/* 't' */
+	{0x00,0x00,0x00,0x00,0x42,0x42,0x42,0x42,0x42,0x46,0x3A,0x00,0x00,0x00,0x00,0x00},	/* 'u' */
+	{0x00,0x00,0x00,0x00,0x42,0x66,0x24,0x24,0x3C,0x18,0x18,0x00,0x00,0x00,0x00,0x00},	/* 'v' */
+	{0x00,0x00,0x00,0x00,0x81,0x81,0x5A,0x5A,0x5A,0x24,0x24,0x00,0x00,0x00,0x00,0x00},	/* 'w' */
+	{0x00,0x00,0x00,0x00,0x66,0x24,0x18,0x18,0x18,0x24,0x66,0x00,0x00,0x00,0x00,0x00},	/* 'x' */
+	{0x00,0x00,0x00,0x00,0x42,0x22,0x24,0x24,0x14,0x18,0x08,0x08,0x10,0x30,0x00,0x00},	/* 'y' */
+	{0x00,0x00,0x00,0x00,0x7E,0x02,0x04,0x18,0x20,0x40,0x7E,0x00,0x00,0x00,0x00,0x00},	/* 'z' */
+	{0x1C,0x10,0x10,0x10,0x10,0x60,0x10,0x10,0x10,0x10,0x10,0x0C,0x00,0x00,0x00,0x00},	/* '{' */
+	{0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00},	/* '|' */
+	{0x70,0x10,0x10,0x10,0x10,0x0C,0x10,0x10,0x10,0x10,0x10,0x60,0x00,0x00,0x00,0x00},	/* '}' */
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x39,0x46,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},	/* '~' */
+};
+
+//	Helper Functions ============================================================
+/* live font of a handle (NULL=invalid) */
+static font_face* face_of(ui_font font) {
+	if (font == UI_FONT_DEFAULT) return &fonts[0];
+	if (font < 0 || font >= __atomic_load_n(&font_count, __ATOMIC_ACQUIRE)) return NULL;
+
+	return __atomic_load_n(&fonts[font].live, __ATOMIC_ACQUIRE) ? &fonts[font] : NULL;
+}
+/* built-in glyph, trimmed to its inked rows */
+static int raster_builtin(uint32_t cp, glyph_image* out) {
+	if (cp < BUILTIN_FIRST || cp > BUILTIN_LAST) cp = '?';
+	const uint8_t* rows = BUILTIN_GLYPHS[cp - BUILTIN_FIRST];
+	int first = 0, last = BUILTIN_HEIGHT - 1;
+	while (first <= last && !rows[first]) ++first;
+	while (last >= first && !rows[last]) --last;
+
+	out->advance = BUILTIN_WIDTH;
+	out->left = 0;
+	out->top = first <= last ? first : 0;
+	out->width = first <= last ? BUILTIN_WIDTH : 0;
+	out->height = first <= last ? last - first + 1 : 0;
+	for (int y = 0; y < out->height; ++y) {
+		for (int x = 0; x < BUILTIN_WIDTH; ++x) out->alpha[y * BUILTIN_WIDTH + x] = rows[first + y] & (0x80 >> x) ? 0xFF : 0;
+	}
+
+	return 0;
+}
+#ifdef SIGUI_FREETYPE
+/* renders a codepoint with the face lock held; 0 on success */
+static int raster_face(font_face* f, uint32_t cp, glyph_image* out) {
+	FT_UInt index = FT_Get_Char_Index(f->face, cp);
+	if (!index) index = FT_Get_Char_Index(f->face, '?');
+	if (FT_Load_Glyph(f->face, index, FT_LOAD_RENDER) != 0) return -1;
+
+	FT_GlyphSlot g = f->face->glyph;
+	int w = g->bitmap.width < GLYPH_MAX ? (int)g->bitmap.width : GLYPH_MAX;
+	int h = g->bitmap.rows < GLYPH_MAX ? (int)g->bitmap.rows : GLYPH_MAX;
+	out->advance = (int)((g->advance.x + 32) >> 6);
+	out->left = g->bitmap_left;
+	out->top = f->ascent - g->bitmap_top;
+	out->width = w;
+	out->height = h;
+	for (int y = 0; y < h; ++y) memcpy(out->alpha + y * w, g->bitmap.buffer + y * g->bitmap.pitch, w);
+
+	return 0;
+}
+#endif
+
+/* loads a TrueType font at a pixel height */
+static ui_font load_font(const char* path, int pixels) {
+#ifdef SIGUI_FREETYPE
+	if (!path || pixels <= 0 || pixels > GLYPH_MAX) return -1;
+
+	pthread_mutex_lock(&font_lock);
+	ui_font font = -1;
+	if (font_count >= FONT_MAX) goto done;
+	if (!library && FT_Init_FreeType(&library) != 0) {
+		library = NULL;
+		goto done;
+	}
+
+	font_face* f = &fonts[font_count];
+	if (FT_New_Face(library, path, 0, &f->face) != 0) {
+		DBLOG("<Font> cannot load %s", path);
+		goto done;
+	}
+	FT_Set_Pixel_Sizes(f->face, 0, pixels);
+	f->ascent = (int)((f->face->size->metrics.ascender + 63) >> 6);
+	f->height = (int)((f->face->size->metrics.height + 63) >> 6);
+	pthread_mutex_init(&f->lock, NULL);
+	for (uint32_t cp = 0; cp < ADVANCE_CACHE; ++cp) {
+		FT_Load_Char(f->face, cp, FT_LOAD_DEFAULT);
+		f->advances[cp] = (int16_t)((f->face->glyph->advance.x + 32) >> 6);
+	}
+	__atomic_store_n(&f->live, 1, __ATOMIC_RELEASE);
+	font = font_count;
+	__atomic_store_n(&font_count, font_count + 1, __ATOMIC_RELEASE);
+
+done:
+	pthread_mutex_unlock(&font_lock);
+	return font;
+#else
+	DBLOG("<Font> TrueType support not built (FREETYPE=1)");
+	return -1;
+#endif
+}
+/* releases a loaded font (the built-in font stays) */
+static void free_font(ui_font font) {
+	if (font == UI_FONT_DEFAULT) return;
+	font_face* f = face_of(font);
+	if (!f) return;
+
+	pthread_mutex_lock(&font_lock);
+	__atomic_store_n(&f->live, 0, __ATOMIC_RELEASE);
+#ifdef SIGUI_FREETYPE
+	pthread_mutex_lock(&f->lock);		// wait for a raster in progress
+	FT_Done_Face(f->face);
+	f->face = NULL;
+	pthread_mutex_unlock(&f->lock);
+#endif
+	pthread_mutex_unlock(&font_lock);
+}
+/* line height */
+static int font_height(ui_font font) {
+	if (font == UI_FONT_DEFAULT) return BUILTIN_HEIGHT;
+	font_face* f = face_of(font);
+
+	return f ? f->height : 0;
+}
+/* pen advance of a codepoint */
+static int glyph_advance(ui_font font, uint32_t cp) {
+	if (font == UI_FONT_DEFAULT) return BUILTIN_WIDTH;
+#ifdef SIGUI_FREETYPE
+	font_face* f = face_of(font);
+	if (!f) return 0;
+	if (cp < ADVANCE_CACHE) return f->advances[cp];
+
+	int advance = 0;
+	pthread_mutex_lock(&f->lock);
+	if (f->face && FT_Load_Char(f->face, cp, FT_LOAD_DEFAULT) == 0) advance = (int)((f->face->glyph->advance.x + 32) >> 6);
+	pthread_mutex_unlock(&f->lock);
+
+	return advance;
+#else
+	return 0;
+#endif
+}
+/* rasterizes a codepoint */
+static int raster_glyph(ui_font font, uint32_t cp, glyph_image* out) {
+	if (font == UI_FONT_DEFAULT) return raster_builtin(cp, out);
+#ifdef SIGUI_FREETYPE
+	font_face* f = face_of(font);
+	if (!f) return -1;
+
+	pthread_mutex_lock(&f->lock);
+	int ret = f->face ? raster_face(f, cp, out) : -1;
+	pthread_mutex_unlock(&f->lock);
+
+	return ret;
+#else
+	return -1;
+#endif
+}
+/* text extent: widest line x line count */
+static int measure_text(ui_font font, const char* text, int* width, int* height) {
+	int line = font_height(font);
+	if (!text || !line) return -1;
+
+	const char* end = text + strlen(text);
+	int pen = 0, widest = 0, lines = 1;
+	while (text < end) {
+		uint32_t cp = ui_utf8_next(&text, end);
+		if (cp == '\n') {
+			lines++;
+			pen = 0;
+			continue;
+		}
+		pen += glyph_advance(font, cp);
+		if (pen > widest) widest = pen;
+	}
+	if (width) *width = widest;
+	if (height) *height = lines * line;
+
+	return 0;
+}
+
+/* glyph source interface (internal) */
+const IGlyphs Glyphs = {
+	.raster = raster_glyph,
+	.advance = glyph_advance,
+	.height = font_height
+};
+/* font interface */
+const IFont Font = {
+	.load = load_font,
+	.free = free_font,
+	.measure = measure_text,
+	.height = font_height
+};
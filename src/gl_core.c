@@ -0,0 +1,616 @@
+// gl_core.c
+/**
+ * @detail GL 3.3 core renderer. Every rect, border, rounded rect and glyph is one
+ * 	instance of a 4-vertex strip; a single shader evaluates a rounded-box distance
+ * 	for the corners/border, samples the glyph atlas for glyphs, and discards
+ * 	fragments outside the instance clip. Instances are
+ * 	written straight into a persistently mapped ring buffer (three frame segments,
+ * 	each fenced), so a frame costs one memcpy per module and one draw per damage
+ * 	region. GL entry points are loaded through eglGetProcAddress, so nothing here
+ * 	links against libGL; the context is EGL surfaceless (Mesa llvmpipe works
+ * 	without a GPU or display) and renders into an FBO that is read back.
+ */
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glcorearb.h>
+#include "gl_core.h"
+#include "sigui_debug.h"
+
+#define RING_SEGMENTS 3				/* frames in flight */
+#define RING_MIN 1024					/* minimum instances per segment */
+
+//	GL entry points (name, type) ================================================
+#define GL_FUNCS(X) \
+	X(GetString, PFNGLGETSTRINGPROC) \
+	X(GetError, PFNGLGETERRORPROC) \
+	X(Enable, PFNGLENABLEPROC) \
+	X(Disable, PFNGLDISABLEPROC) \
+	X(BlendFunc, PFNGLBLENDFUNCPROC) \
+	X(Scissor, PFNGLSCISSORPROC) \
+	X(Viewport, PFNGLVIEWPORTPROC) \
+	X(ClearColor, PFNGLCLEARCOLORPROC) \
+	X(Clear, PFNGLCLEARPROC) \
+	X(ReadPixels, PFNGLREADPIXELSPROC) \
+	X(PixelStorei, PFNGLPIXELSTOREIPROC) \
+	X(Finish, PFNGLFINISHPROC) \
+	X(CreateShader, PFNGLCREATESHADERPROC) \
+	X(ShaderSource, PFNGLSHADERSOURCEPROC) \
+	X(CompileShader, PFNGLCOMPILESHADERPROC) \
+	X(GetShaderiv, PFNGLGETSHADERIVPROC) \
+	X(GetShaderInfoLog, PFNGLGETSHADERINFOLOGPROC) \
+	X(DeleteShader, PFNGLDELETESHADERPROC) \
+	X(CreateProgram, PFNGLCREATEPROGRAMPROC) \
+	X(AttachShader, PFNGLATTACHSHADERPROC) \
+	X(LinkProgram, PFNGLLINKPROGRAMPROC) \
+	X(GetProgramiv, PFNGLGETPROGRAMIVPROC) \
+	X(GetProgramInfoLog, PFNGLGETPROGRAMINFOLOGPROC) \
+	X(DeleteProgram, PFNGLDELETEPROGRAMPROC) \
+	X(UseProgram, PFNGLUSEPROGRAMPROC) \
+	X(GetUniformLocation, PFNGLGETUNIFORMLOCATIONPROC) \
+	X(Uniform2f, PFNGLUNIFORM2FPROC) \
+	X(GenVertexArrays, PFNGLGENVERTEXARRAYSPROC) \
+	X(BindVertexArray, PFNGLBINDVERTEXARRAYPROC) \
+	X(DeleteVertexArrays, PFNGLDELETEVERTEXARRAYSPROC) \
+	X(GenBuffers, PFNGLGENBUFFERSPROC) \
+	X(BindBuffer, PFNGLBINDBUFFERPROC) \
+	X(DeleteBuffers, PFNGLDELETEBUFFERSPROC) \
+	X(BufferData, PFNGLBUFFERDATAPROC) \
+	X(MapBufferRange, PFNGLMAPBUFFERRANGEPROC) \
+	X(UnmapBuffer, PFNGLUNMAPBUFFERPROC) \
+	X(VertexAttribPointer, PFNGLVERTEXATTRIBPOINTERPROC) \
+	X(EnableVertexAttribArray, PFNGLENABLEVERTEXATTRIBARRAYPROC) \
+	X(VertexAttribDivisor, PFNGLVERTEXATTRIBDIVISORPROC) \
+	X(DrawArraysInstanced, PFNGLDRAWARRAYSINSTANCEDPROC) \
+	X(FenceSync, PFNGLFENCESYNCPROC) \
+	X(ClientWaitSync, PFNGLCLIENTWAITSYNCPROC) \
+	X(DeleteSync, PFNGLDELETESYNCPROC) \
+	X(GenFramebuffers, PFNGLGENFRAMEBUFFERSPROC) \
+	X(BindFramebuffer, PFNGLBINDFRAMEBUFFERPROC) \
+	X(DeleteFramebuffers, PFNGLDELETEFRAMEBUFFERSPROC) \
+	X(GenRenderbuffers, PFNGLGENRENDERBUFFERSPROC) \
+	X(BindRenderbuffer, PFNGLBINDRENDERBUFFERPROC) \
+	X(RenderbufferStorage, PFNGLRENDERBUFFERSTORAGEPROC) \
+	X(FramebufferRenderbuffer, PFNGLFRAMEBUFFERRENDERBUFFERPROC) \
+	X(CheckFramebufferStatus, PFNGLCHECKFRAMEBUFFERSTATUSPROC) \
+	X(DeleteRenderbuffers, PFNGLDELETERENDERBUFFERSPROC) \
+	X(GenTextures, PFNGLGENTEXTURESPROC) \
+	X(DeleteTextures, PFNGLDELETETEXTURESPROC) \
+	X(BindTexture, PFNGLBINDTEXTUREPROC) \
+	X(TexParameteri, PFNGLTEXPARAMETERIPROC) \
+	X(TexImage2D, PFNGLTEXIMAGE2DPROC) \
+	X(TexSubImage2D, PFNGLTEXSUBIMAGE2DPROC)
+
+#define GL_MEMBER(name, type) type name;
+/* loaded GL entry points */
+typedef struct gl_api_s {
+	GL_FUNCS(GL_MEMBER)
+	PFNGLBUFFERSTORAGEPROC BufferStorage;	/* GL 4.4 / ARB_buffer_storage (optional) */
+} gl_api;
+
+/* EGL entry points (libEGL is opened on first use) */
+typedef struct egl_api_s {
+	void* lib;
+	PFNEGLGETPROCADDRESSPROC GetProcAddress;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC GetPlatformDisplayEXT;
+	EGLBoolean (*Initialize)(EGLDisplay, EGLint*, EGLint*);
+	EGLBoolean (*Terminate)(EGLDisplay);
+	EGLBoolean (*BindAPI)(EGLenum);
+	EGLBoolean (*ChooseConfig)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*);
+	EGLContext (*CreateContext)(EGLDisplay, EGLConfig, EGLContext, const EGLint*);
+	EGLBoolean (*DestroyContext)(EGLDisplay, EGLContext);
+	EGLBoolean (*MakeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+	EGLDisplay display;
+	int users;
+} egl_api;
+
+/* GL 3.3 core renderer */
+struct gl_core_s {
+	gl_api gl;						/* entry points */
+	EGLContext egl_context;		/* surfaceless context */
+	int width, height;			/* target size */
+	GLuint program, vao;			/* shader + vertex layout */
+	GLint u_viewport;				/* viewport uniform */
+	GLuint fbo, color;			/* offscreen framebuffer + color renderbuffer */
+	GLuint atlas;					/* glyph atlas texture (R8) */
+	int atlas_size;				/* atlas side (0=none) */
+	GLuint ring;					/* instance ring buffer */
+	int persistent;				/* ring is persistently mapped */
+	gl_instance* mapped;			/* persistent mapping (or this frame's mapping) */
+	int segment_capacity;		/* instances per segment */
+	int segment;					/* current segment */
+	GLsync fences[RING_SEGMENTS];	/* segment fences */
+	uint32_t* scratch;			/* read-back rows */
+	size_t scratch_size;
+};
+
+//	Engine State ================================================================
+static egl_api egl = {0};
+static pthread_mutex_t egl_lock = PTHREAD_MUTEX_INITIALIZER;
+static const char* last_error = NULL;
+
+//	Shaders =====================================================================
+static const char* VERTEX_SHADER =
+	"#version 330 core\n"
+	"layout(location = 0) in vec4 a_rect;\n"
+	"layout(location = 1) in vec4 a_clip;\n"
+	"layout(location = 2) in vec4 a_uv;\n"
+	"layout(location = 3) in vec4 a_color;\n"
+	"layout(location = 4) in vec3 a_shape;\n"
+	"uniform vec2 u_viewport;\n"
+	"out vec2 v_local;\n"
+	"out vec2 v_uv;\n"
+	"flat out int v_textured;\n"
+	"flat out vec2 v_half;\n"
+	"flat out vec4 v_color;\n"
+	"flat out vec3 v_shape;\n"
+	"flat out vec4 v_ends;\n"
+	"flat out vec4 v_clip;\n"
+	"void main() {\n"
+	"	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+	"	vec2 pos = a_rect.xy + corner * a_rect.zw;\n"
+	"	v_half = a_rect.zw * 0.5;\n"
+	"	v_local = (corner - 0.5) * a_rect.zw;\n"
+	"	v_uv = mix(a_uv.xy, a_uv.zw, corner);\n"
+	"	v_textured = a_shape.z == 0.0 && a_uv.z > 0.0 ? 1 : 0;\n"
+	"	v_ends = a_uv;\n"
+	"	v_color = a_color;\n"
+	"	v_shape = a_shape;\n"
+	"	v_clip = a_clip;\n"
+	"	vec2 ndc = pos / u_viewport * 2.0 - 1.0;\n"
+	"	gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);\n"
+	"}\n";
+static const char* FRAGMENT_SHADER =
+	"#version 330 core\n"
+	"uniform vec2 u_viewport;\n"
+	"uniform sampler2D u_atlas;\n"
+	"in vec2 v_local;\n"
+	"in vec2 v_uv;\n"
+	"flat in int v_textured;\n"
+	"flat in vec2 v_half;\n"
+	"flat in vec4 v_color;\n"
+	"flat in vec3 v_shape;\n"
+	"flat in vec4 v_ends;\n"
+	"flat in vec4 v_clip;\n"
+	"out vec4 o_color;\n"
+	"void main() {\n"
+	"	vec2 frag = vec2(gl_FragCoord.x, u_viewport.y - gl_FragCoord.y);\n"
+	"	if (frag.x < v_clip.x || frag.y < v_clip.y || frag.x >= v_clip.x + v_clip.z || frag.y >= v_clip.y + v_clip.w) discard;\n"
+	"	float cover;\n"
+	"	if (v_shape.z == 1.0) {\n"
+	"		vec2 axis = v_ends.zw - v_ends.xy;\n"
+	"		float len = length(axis);\n"
+	"		vec2 u = axis / len;\n"
+	"		vec2 p = frag - v_ends.xy;\n"
+	"		vec2 q = abs(vec2(dot(p, u) - len * 0.5, dot(p, vec2(-u.y, u.x)))) - vec2(len * 0.5, v_shape.y * 0.5);\n"
+	"		float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);\n"
+	"		cover = clamp(0.5 - d, 0.0, 1.0) * min(v_shape.y, 1.0);\n"
+	"	} else {\n"
+	"		vec2 half_size = v_shape.z == 2.0 ? v_half - floor((v_shape.y + 1.0) * 0.5) : v_half;\n"
+	"		float r = min(v_shape.x, min(half_size.x, half_size.y));\n"
+	"		vec2 q = abs(v_local) - half_size + r;\n"
+	"		float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;\n"
+	"		if (v_shape.z == 2.0) cover = clamp(0.5 - d / v_shape.y, 0.0, 1.0);\n"
+	"		else {\n"
+	"			cover = clamp(0.5 - d, 0.0, 1.0);\n"
+	"			if (v_shape.y > 0.0) cover *= clamp(0.5 + d + v_shape.y, 0.0, 1.0);\n"
+	"		}\n"
+	"	}\n"
+	"	if (v_textured != 0) cover *= texture(u_atlas, v_uv).r;\n"
+	"	if (cover <= 0.0) discard;\n"
+	"	o_color = vec4(v_color.rgb, v_color.a * cover);\n"
+	"}\n";
+
+//	Helper Functions ============================================================
+/* records a creation error */
+static gl_core fail(gl_core core, const char* msg);
+static void free_core(gl_core);
+
+/* opens libEGL and the surfaceless display (reference counted) */
+static int acquire_egl(void) {
+	int ret = -1;
+	pthread_mutex_lock(&egl_lock);
+	if (egl.users > 0) {
+		egl.users++;
+		ret = 0;
+		goto done;
+	}
+
+	if (!egl.lib) egl.lib = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+	if (!egl.lib) {
+		last_error = "libEGL not found";
+		goto done;
+	}
+	egl.GetProcAddress = (PFNEGLGETPROCADDRESSPROC)dlsym(egl.lib, "eglGetProcAddress");
+	egl.Initialize = dlsym(egl.lib, "eglInitialize");
+	egl.Terminate = dlsym(egl.lib, "eglTerminate");
+	egl.BindAPI = dlsym(egl.lib, "eglBindAPI");
+	egl.ChooseConfig = dlsym(egl.lib, "eglChooseConfig");
+	egl.CreateContext = dlsym(egl.lib, "eglCreateContext");
+	egl.DestroyContext = dlsym(egl.lib, "eglDestroyContext");
+	egl.MakeCurrent = dlsym(egl.lib, "eglMakeCurrent");
+	if (!egl.GetProcAddress || !egl.Initialize || !egl.MakeCurrent) {
+		last_error = "libEGL incomplete";
+		goto done;
+	}
+	egl.GetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)egl.GetProcAddress("eglGetPlatformDisplayEXT");
+	if (!egl.GetPlatformDisplayEXT) {
+		last_error = "EGL_EXT_platform_base unsupported";
+		goto done;
+	}
+
+	egl.display = egl.GetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	EGLint major, minor;
+	if (egl.display == EGL_NO_DISPLAY || !egl.Initialize(egl.display, &major, &minor)) {
+		last_error = "EGL surfaceless display unavailable";
+		goto done;
+	}
+	DBLOG("<GLCore> EGL %d.%d surfaceless display", major, minor);
+	egl.users = 1;
+	ret = 0;
+
+done:
+	pthread_mutex_unlock(&egl_lock);
+	return ret;
+}
+static void release_egl(void) {
+	pthread_mutex_lock(&egl_lock);
+	if (egl.users > 0 && --egl.users == 0) {
+		egl.Terminate(egl.display);
+		egl.display = EGL_NO_DISPLAY;
+	}
+	pthread_mutex_unlock(&egl_lock);
+}
+/* eglGetProcAddress as a gl_loader */
+static void* egl_loader(const char* name) {
+	return (void*)egl.GetProcAddress(name);
+}
+/* loads every entry point; 0 on success */
+static int load_api(gl_api* gl, void* (*load)(const char*)) {
+#define GL_LOAD(name, type) \
+	if (!(gl->name = (type)load("gl" #name))) { \
+		last_error = "missing gl" #name; \
+		return -1; \
+	}
+	GL_FUNCS(GL_LOAD)
+#undef GL_LOAD
+	gl->BufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+
+	return 0;
+}
+/* compiles one shader stage */
+static GLuint compile(gl_api* gl, GLenum stage, const char* source) {
+	GLuint shader = gl->CreateShader(stage);
+	gl->ShaderSource(shader, 1, &source, NULL);
+	gl->CompileShader(shader);
+
+	GLint ok = 0;
+	gl->GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if (!ok) {
+		char log[512];
+		gl->GetShaderInfoLog(shader, sizeof(log), NULL, log);
+		DBLOG("<GLCore> shader error: %s", log);
+		gl->DeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+/* builds the program and vertex layout; 0 on success */
+static int init_pipeline(gl_core core) {
+	gl_api* gl = &core->gl;
+	GLuint vs = compile(gl, GL_VERTEX_SHADER, VERTEX_SHADER);
+	GLuint fs = compile(gl, GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+	if (!vs || !fs) {
+		if (vs) gl->DeleteShader(vs);
+		if (fs) gl->DeleteShader(fs);
+		last_error = "shader compilation failed";
+		return -1;
+	}
+
+	core->program = gl->CreateProgram();
+	gl->AttachShader(core->program, vs);
+	gl->AttachShader(core->program, fs);
+	gl->LinkProgram(core->program);
+	gl->DeleteShader(vs);
+	gl->DeleteShader(fs);
+	GLint ok = 0;
+	gl->GetProgramiv(core->program, GL_LINK_STATUS, &ok);
+	if (!ok) {
+		last_error = "shader link failed";
+		return -1;
+	}
+	core->u_viewport = gl->GetUniformLocation(core->program, "u_viewport");
+
+	gl->GenVertexArrays(1, &core->vao);
+	gl->BindVertexArray(core->vao);
+	gl->UseProgram(core->program);
+	gl->Uniform2f(core->u_viewport, (float)core->width, (float)core->height);
+	gl->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	gl->Enable(GL_BLEND);
+	gl->Viewport(0, 0, core->width, core->height);
+	gl->ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+	return 0;
+}
+/* (re)creates the instance ring for `capacity` instances per segment; 0 on success */
+static int init_ring(gl_core core, int capacity) {
+	gl_api* gl = &core->gl;
+
+	//	the old ring may still be read by in-flight frames
+	for (int i = 0; i < RING_SEGMENTS; ++i) {
+		if (!core->fences[i]) continue;
+		gl->ClientWaitSync(core->fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)1000000000);
+		gl->DeleteSync(core->fences[i]);
+		core->fences[i] = 0;
+	}
+	if (core->ring) {
+		gl->BindBuffer(GL_ARRAY_BUFFER, core->ring);
+		if (core->persistent) gl->UnmapBuffer(GL_ARRAY_BUFFER);
+		gl->DeleteBuffers(1, &core->ring);
+		core->mapped = NULL;
+	}
+
+	GLsizeiptr size = (GLsizeiptr)sizeof(gl_instance) * capacity * RING_SEGMENTS;
+	gl->GenBuffers(1, &core->ring);
+	gl->BindBuffer(GL_ARRAY_BUFFER, core->ring);
+	core->persistent = 0;
+	if (gl->BufferStorage) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		gl->BufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+		core->mapped = gl->MapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+		core->persistent = core->mapped != NULL;
+	}
+	if (!core->persistent) gl->BufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+	core->segment_capacity = capacity;
+	core->segment = 0;
+
+	//	per-instance attributes; the pointers are re-based on the frame segment at draw time
+	for (GLuint loc = 0; loc < 5; ++loc) {
+		gl->EnableVertexAttribArray(loc);
+		gl->VertexAttribDivisor(loc, 1);
+	}
+	DBLOG("<GLCore> ring %d x %d instances (persistent=%d)", RING_SEGMENTS, capacity, core->persistent);
+
+	return gl->GetError() == GL_NO_ERROR ? 0 : -1;
+}
+/* points the instance attributes at a segment */
+static void bind_segment(gl_core core, int segment) {
+	gl_api* gl = &core->gl;
+	size_t base = sizeof(gl_instance) * (size_t)segment * core->segment_capacity;
+	GLsizei stride = sizeof(gl_instance);
+
+	gl->VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (const void*)(base + offsetof(gl_instance, rect)));
+	gl->VertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (const void*)(base + offsetof(gl_instance, clip)));
+	gl->VertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (const void*)(base + offsetof(gl_instance, uv)));
+	gl->VertexAttribPointer(3, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, stride, (const void*)(base + offsetof(gl_instance, color)));
+	gl->VertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (const void*)(base + offsetof(gl_instance, radius)));
+}
+/* creates the pipeline and ring on the current context */
+static gl_core init_core(gl_core core) {
+	if (init_pipeline(core) != 0) return fail(core, last_error);
+	if (init_ring(core, RING_MIN) != 0) return fail(core, "instance ring");
+
+	return core;
+}
+
+/* renderer on an owned EGL surfaceless context rendering into an FBO */
+static gl_core new_offscreen(int width, int height) {
+	if (width <= 0 || height <= 0 || acquire_egl() != 0) return NULL;
+
+	gl_core core = Mem.alloc(sizeof(struct gl_core_s));
+	if (!core) {
+		release_egl();
+		return NULL;
+	}
+	memset(core, 0, sizeof(struct gl_core_s));
+	core->width = width;
+	core->height = height;
+
+	egl.BindAPI(EGL_OPENGL_API);
+	EGLint config_attrs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = EGL_NO_CONFIG_KHR;		// surfaceless contexts need no config
+	EGLint configs = 0;
+	egl.ChooseConfig(egl.display, config_attrs, &config, 1, &configs);
+	if (configs == 0) config = EGL_NO_CONFIG_KHR;
+
+	EGLint context_attrs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	core->egl_context = egl.CreateContext(egl.display, config, EGL_NO_CONTEXT, context_attrs);
+	if (core->egl_context == EGL_NO_CONTEXT) return fail(core, "GL 3.3 core context unavailable");
+	if (!egl.MakeCurrent(egl.display, EGL_NO_SURFACE, EGL_NO_SURFACE, core->egl_context)) {
+		return fail(core, "surfaceless context cannot be made current");
+	}
+	if (load_api(&core->gl, egl_loader) != 0) return fail(core, last_error);
+	DBLOG("<GLCore> %s (%s)", core->gl.GetString(GL_VERSION), core->gl.GetString(GL_RENDERER));
+
+	//	color target
+	gl_api* gl = &core->gl;
+	gl->GenRenderbuffers(1, &core->color);
+	gl->BindRenderbuffer(GL_RENDERBUFFER, core->color);
+	gl->RenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	gl->GenFramebuffers(1, &core->fbo);
+	gl->BindFramebuffer(GL_FRAMEBUFFER, core->fbo);
+	gl->FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, core->color);
+	if (gl->CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) return fail(core, "incomplete framebuffer");
+
+	return init_core(core);
+}
+/* records a creation error and frees a partial renderer */
+static gl_core fail(gl_core core, const char* msg) {
+	last_error = msg;
+	DBLOG("<GLCore> %s", msg);
+	free_core(core);
+
+	return NULL;
+}
+/* binds the context to the calling thread */
+static int make_current(gl_core core) {
+	if (!core) return -1;
+
+	return egl.MakeCurrent(egl.display, EGL_NO_SURFACE, EGL_NO_SURFACE, core->egl_context) ? 0 : -1;
+}
+/* releases GL objects, the context and the display reference */
+static void free_core(gl_core core) {
+	if (!core) return;
+
+	int current = core->egl_context != EGL_NO_CONTEXT && make_current(core) == 0;
+	gl_api* gl = &core->gl;
+	if (current && gl->DeleteSync) {
+		for (int i = 0; i < RING_SEGMENTS; ++i) if (core->fences[i]) gl->DeleteSync(core->fences[i]);
+		if (core->ring) {
+			gl->BindBuffer(GL_ARRAY_BUFFER, core->ring);
+			if (core->persistent) gl->UnmapBuffer(GL_ARRAY_BUFFER);
+			gl->DeleteBuffers(1, &core->ring);
+		}
+		if (core->vao) gl->DeleteVertexArrays(1, &core->vao);
+		if (core->program) gl->DeleteProgram(core->program);
+		if (core->atlas) gl->DeleteTextures(1, &core->atlas);
+		if (core->fbo) gl->DeleteFramebuffers(1, &core->fbo);
+		if (core->color) gl->DeleteRenderbuffers(1, &core->color);
+	}
+	if (core->egl_context != EGL_NO_CONTEXT) {
+		egl.MakeCurrent(egl.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		egl.DestroyContext(egl.display, core->egl_context);
+	}
+	release_egl();
+	if (core->scratch) Mem.free(core->scratch);
+
+	Mem.free(core);
+}
+/*
+ *	Returns ring space for this frame's instances: the next segment once the GPU
+ *	has finished the frame that last used it
+ */
+static gl_instance* map_instances(gl_core core, int count) {
+	gl_api* gl = &core->gl;
+	if (count > core->segment_capacity) {
+		int capacity = core->segment_capacity;
+		while (capacity < count) capacity *= 2;
+		if (init_ring(core, capacity) != 0) return NULL;
+	}
+
+	core->segment = (core->segment + 1) % RING_SEGMENTS;
+	GLsync fence = core->fences[core->segment];
+	if (fence) {
+		gl->ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)1000000000);
+		gl->DeleteSync(fence);
+		core->fences[core->segment] = 0;
+	}
+
+	size_t base = (size_t)core->segment * core->segment_capacity;
+	if (core->persistent) return core->mapped + base;
+
+	//	fallback: unsynchronized mapping of the (fenced) segment
+	gl->BindBuffer(GL_ARRAY_BUFFER, core->ring);
+	core->mapped = gl->MapBufferRange(GL_ARRAY_BUFFER, sizeof(gl_instance) * base, sizeof(gl_instance) * (size_t)count,
+												 GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	return core->mapped;
+}
+/*
+ *	Draws the mapped instances: one instanced draw per damage region
+ */
+static int draw_instances(gl_core core, int count, const ui_rect* regions, int region_count, int full) {
+	gl_api* gl = &core->gl;
+	if (!core->persistent) {
+		gl->BindBuffer(GL_ARRAY_BUFFER, core->ring);
+		gl->UnmapBuffer(GL_ARRAY_BUFFER);
+		core->mapped = NULL;
+	}
+
+	bind_segment(core, core->segment);
+	gl->BindTexture(GL_TEXTURE_2D, core->atlas);
+	if (full) gl->Disable(GL_SCISSOR_TEST);
+	else gl->Enable(GL_SCISSOR_TEST);
+
+	int draws = 0;
+	for (int i = 0; i < region_count; ++i) {
+		ui_rect r = regions[i];
+		if (!full) gl->Scissor(r.x, core->height - r.y - r.height, r.width, r.height);
+		gl->Clear(GL_COLOR_BUFFER_BIT);
+		if (count > 0) {
+			gl->DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+			draws++;
+		}
+	}
+	core->fences[core->segment] = gl->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	return draws;
+}
+/*
+ *	Reads regions of the offscreen framebuffer back into an ARGB buffer
+ */
+static int read_pixels(gl_core core, uint32_t* pixels, const ui_rect* regions, int region_count) {
+	gl_api* gl = &core->gl;
+	gl->PixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	for (int i = 0; i < region_count; ++i) {
+		ui_rect r = regions[i];
+		size_t size = sizeof(uint32_t) * (size_t)r.width * r.height;
+		if (size > core->scratch_size) {
+			uint32_t* scratch = Mem.alloc(size);
+			if (!scratch) return -1;
+			if (core->scratch) Mem.free(core->scratch);
+			core->scratch = scratch;
+			core->scratch_size = size;
+		}
+
+		//	BGRA bytes are ARGB words; GL rows are bottom-up
+		gl->ReadPixels(r.x, core->height - r.y - r.height, r.width, r.height, GL_BGRA, GL_UNSIGNED_BYTE, core->scratch);
+		for (int row = 0; row < r.height; ++row) {
+			const uint32_t* src = core->scratch + (size_t)(r.height - 1 - row) * r.width;
+			uint32_t* dst = pixels + (size_t)(r.y + row) * core->width + r.x;
+			for (int col = 0; col < r.width; ++col) dst[col] = src[col] | 0xFF000000u;
+		}
+	}
+
+	return gl->GetError() == GL_NO_ERROR ? 0 : -1;
+}
+/*
+ *	Uploads the dirty rects of the glyph atlas; no rects (or a new atlas size)
+ *	uploads the whole atlas
+ */
+static void upload_atlas(gl_core core, const uint8_t* pixels, int size, const ui_rect* rects, int count) {
+	gl_api* gl = &core->gl;
+	gl->PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (!rects || size != core->atlas_size) {
+		if (!core->atlas) gl->GenTextures(1, &core->atlas);
+		gl->BindTexture(GL_TEXTURE_2D, core->atlas);
+		gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		gl->TexImage2D(GL_TEXTURE_2D, 0, GL_R8, size, size, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+		core->atlas_size = size;
+		return;
+	}
+
+	gl->BindTexture(GL_TEXTURE_2D, core->atlas);
+	gl->PixelStorei(GL_UNPACK_ROW_LENGTH, size);
+	for (int i = 0; i < count; ++i) {
+		ui_rect r = rects[i];
+		gl->TexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.width, r.height, GL_RED, GL_UNSIGNED_BYTE,
+								pixels + (size_t)r.y * size + r.x);
+	}
+	gl->PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+/* last creation error */
+static const char* core_error(void) {
+	return last_error;
+}
+
+/* GL core interface (internal) */
+const IGLCore GLCore = {
+	.new_offscreen = new_offscreen,
+	.free = free_core,
+	.make_current = make_current,
+	.map = map_instances,
+	.draw = draw_instances,
+	.read = read_pixels,
+	.atlas = upload_atlas,
+	.error = core_error
+};
@@ -0,0 +1,42 @@
+// gl_core.h
+#ifndef GL_CORE_H
+#define GL_CORE_H
+
+#include "ui_core.h"
+
+/* opaque GL 3.3 core renderer */
+typedef struct gl_core_s* gl_core;
+
+/* instance kinds */
+enum {
+	GL_INSTANCE_RECT,				/* rect, border, rounded rect or glyph */
+	GL_INSTANCE_LINE,				/* anti-aliased segment between the uv endpoints */
+	GL_INSTANCE_SHADOW			/* blurred rounded rect (rect grown by half the blur) */
+};
+
+/* one instanced shape (64 bytes, std layout) */
+typedef struct gl_instance_s {
+	float rect[4];					/* x, y, w, h (target pixels, top-left origin) */
+	float clip[4];					/* x, y, w, h; fragments outside are discarded */
+	float uv[4];					/* glyphs: atlas u0, v0, u1, v1 (u1 <= 0: untextured); lines: x0, y0, x1, y1 */
+	uint32_t color;				/* ARGB8888 (uploaded as BGRA bytes) */
+	float radius;					/* corner radius (0=square) */
+	float border;					/* border width (0=filled); lines: width; shadows: blur */
+	float kind;						/* GL_INSTANCE_* */
+} gl_instance;
+
+/* GL 3.3 core renderer interface (internal) */
+typedef struct IGLCore {
+	gl_core (*new_offscreen)(int, int);				/* EGL surfaceless context + FBO (NULL=unavailable) */
+	void (*free)(gl_core);									/* release GL objects and the context */
+	int (*make_current)(gl_core);							/* bind the context to the calling thread; 0 on success */
+	gl_instance* (*map)(gl_core, int);					/* ring space for N instances of this frame (NULL=error) */
+	int (*draw)(gl_core, int, const ui_rect*, int, int);	/* draw N mapped instances into damage regions (full=1: no scissor); returns draw calls */
+	int (*read)(gl_core, uint32_t*, const ui_rect*, int);	/* read regions back as ARGB rows; 0 on success */
+	void (*atlas)(gl_core, const uint8_t*, int, const ui_rect*, int);	/* upload dirty rects of an A8 glyph atlas (NULL rects: all of it) */
+	const char* (*error)(void);							/* last creation error */
+} IGLCore;
+
+extern const IGLCore GLCore;
+
+#endif	//	GL_CORE_H
@@ -0,0 +1,447 @@
+// grid.c
+/**
+ * @detail Virtualized grids. Row and column extents live in two extent indexes
+ * 	so the first visible row/column and any hit test are O(log n); the rest of a
+ * 	frame walks only what crosses the window, one column at a time. Cells come
+ * 	from the source in column tiles (GRID_TILE_ROWS rows of one column per call,
+ * 	which suits columnar stores) and are cached in a tile table keyed by
+ * 	(column, row block). A tile sits within GRID_PROBE slots of its home slot;
+ * 	when that window is full its least recently drawn tile gives way, so tiles
+ * 	on screen together keep their slots. A tile also keeps each cell's text
+ * 	fitted to the column width (whole glyphs only); it is re-fitted when its
+ * 	column's width no longer matches, so a resize touches only that column's
+ * 	tiles.
+ */
+
+#include "ui_core.h"
+#include "sigui_widgets.h"
+#include "sigui_debug.h"
+
+#define GRID_PAD 4								/* text inset inside a cell */
+#define GRID_GRIP 3								/* header pixels around a column edge that start a resize */
+#define GRID_MIN_WIDTH 8						/* narrowest column a drag can make */
+#define GRID_HEADER_BLOCK -1					/* row block of a header tile */
+#define GRID_PROBE 8								/* slots a tile may sit past its home slot */
+
+/* cached column tile: GRID_TILE_ROWS cells of one column (header tiles hold one) */
+typedef struct grid_tile_s {
+	int column;									/* key (-1: empty slot) */
+	int block;									/* row block (GRID_HEADER_BLOCK: column title) */
+	int width;									/* column width the cells were fitted to (-1: never) */
+	uint64_t used;								/* tile clock at its last draw (LRU within a probe window) */
+	uint8_t fit[GRID_TILE_ROWS];			/* bytes of each cell that fit the column */
+	char text[GRID_TILE_ROWS][GRID_CELL_MAX];
+} grid_tile;
+/* grid state (module widget) */
+struct ui_gridview_s {
+	ui_module module;
+	gridview_source source;
+	extent_index rows, columns;
+	int64_t scroll_x, scroll_y;			/* scrolled content offset */
+	int header;									/* header row height */
+	int frozen;									/* leading columns kept in place */
+	ui_font font;
+	uint32_t color, background, header_color, lines;
+	grid_tile* tiles;							/* tile cache (linear probing, LRU replacement) */
+	int tile_capacity;						/* slots (power of two) */
+	uint64_t tile_clock;						/* tiles drawn so far */
+	int selected_row, selected_column;	/* last pressed cell (-1: none) */
+	int drag;									/* column being resized (-1: none) */
+	gridview_stats stats;
+};
+
+//	Helper Functions ============================================================
+/* width of the frozen columns */
+static int frozen_width(ui_gridview g) {
+	return (int)Extent.offset(&g->columns, g->frozen);
+}
+/* window-local x of a column's left edge */
+static int64_t column_x(ui_gridview g, int column) {
+	int64_t x = Extent.offset(&g->columns, column);
+	return column < g->frozen ? x : x - g->scroll_x;
+}
+/* keeps the scroll offset inside the scrollable content */
+static void clamp_scroll(ui_gridview g) {
+	window w = g->module->win;
+	int64_t max_x = Extent.total(&g->columns) - (w ? w->width : 0);
+	int64_t max_y = Extent.total(&g->rows) - (w ? w->height - g->header : 0);
+	if (g->scroll_x > max_x) g->scroll_x = max_x;
+	if (g->scroll_x < 0) g->scroll_x = 0;
+	if (g->scroll_y > max_y) g->scroll_y = max_y;
+	if (g->scroll_y < 0) g->scroll_y = 0;
+}
+/* a tile's slot: its own, else the first empty one of its window, else the window's least recently drawn */
+static grid_tile* tile_slot(ui_gridview g, int column, int block) {
+	int mask = g->tile_capacity - 1;
+	int i = (int)ui_fib_slot((uint64_t)(uint32_t)column << 32 | (uint32_t)block, __builtin_ctz((unsigned)g->tile_capacity));
+	grid_tile* oldest = NULL;
+	for (int n = 0; n < GRID_PROBE; ++n, i = (i + 1) & mask) {
+		grid_tile* t = &g->tiles[i];
+		if (t->column < 0 || (t->column == column && t->block == block)) return t;
+		if (!oldest || t->used < oldest->used) oldest = t;
+	}
+
+	return oldest;
+}
+static void clear_tiles(ui_gridview g) {
+	for (int i = 0; i < g->tile_capacity; ++i) g->tiles[i].column = -1;
+}
+/* grows the tile cache to hold `tiles` tiles twice over; cached tiles move along */
+static void reserve_tiles(ui_gridview g, int tiles) {
+	if (tiles * 2 <= g->tile_capacity) return;
+
+	int old_capacity = g->tile_capacity;
+	grid_tile* old = g->tiles;
+	int capacity = old_capacity ? old_capacity : 64;
+	while (capacity < tiles * 2) capacity *= 2;
+	grid_tile* cache = ui_alloc(g->module->ctx, sizeof(grid_tile) * capacity, ALLOC_WIDGET);
+	if (!cache) return;
+
+	g->tiles = cache;
+	g->tile_capacity = capacity;
+	clear_tiles(g);
+	for (int i = 0; i < old_capacity; ++i) {
+		if (old[i].column >= 0) *tile_slot(g, old[i].column, old[i].block) = old[i];
+	}
+	if (old) ui_free(g->module->ctx, old, ALLOC_WIDGET);
+}
+/* bytes of a text whose glyphs fit in `avail` pixels */
+static int fit_bytes(ui_context ctx, ui_font font, const char* text, int avail) {
+	text_layout layout;
+	if (!*text || avail <= 0 || TextCache.layout(ctx, font, text, -1, 0, &layout) != 0) return 0;
+
+	int i = 0;
+	while (i < layout.glyph_count && layout.glyphs[i].pen + layout.glyphs[i].advance <= avail) i++;
+
+	return i < layout.glyph_count ? (int)layout.glyphs[i].offset : (int)strlen(text);
+}
+/* a column tile: fetched in one batch on a miss, re-fitted when the column width changed */
+static grid_tile* fetch_tile(ui_gridview g, int column, int block) {
+	grid_tile* t = tile_slot(g, column, block);
+	int first = block * GRID_TILE_ROWS;
+	int count = block == GRID_HEADER_BLOCK ? 1 : g->rows.count - first;
+	if (count > GRID_TILE_ROWS) count = GRID_TILE_ROWS;
+
+	if (t->column == column && t->block == block) g->stats.hits++;
+	else {
+		t->column = column;
+		t->block = block;
+		t->width = -1;
+		for (int i = 0; i < count; ++i) t->text[i][0] = '\0';
+		if (block == GRID_HEADER_BLOCK) {
+			if (g->source.header) g->source.header(g->source.data, column, t->text[0], GRID_CELL_MAX);
+		} else if (g->source.cells) {
+			g->source.cells(g->source.data, column, first, count, t->text[0], GRID_CELL_MAX);
+			g->stats.batches++;
+			g->stats.cells += count;
+		}
+		for (int i = 0; i < count; ++i) t->text[i][GRID_CELL_MAX - 1] = '\0';
+	}
+	t->used = ++g->tile_clock;
+
+	int width = Extent.size(&g->columns, column);
+	if (t->width != width) {
+		for (int i = 0; i < count; ++i) t->fit[i] = (uint8_t)fit_bytes(g->module->ctx, g->font, t->text[i], width - 2 * GRID_PAD);
+		if (t->width >= 0) g->stats.refits += count;
+		t->width = width;
+	}
+
+	return t;
+}
+/* draws the first `fit` bytes of a cell */
+static void draw_cell(ui_gridview g, grid_tile* t, int i, int x, int y, int h, int line) {
+	int n = t->fit[i];
+	if (!n) return;
+
+	char saved = t->text[i][n];
+	t->text[i][n] = '\0';
+	Draw.text(g->module->ctx, x + GRID_PAD, y + (h - line) / 2, g->font, t->text[i], g->color);
+	t->text[i][n] = saved;
+}
+/* records one column's visible cells, tile by tile */
+static void draw_column(ui_gridview g, int column, int first, int last, int line) {
+	ui_context ctx = g->module->ctx;
+	int x = (int)column_x(g, column);
+	int width = Extent.size(&g->columns, column);
+	int64_t top = Extent.offset(&g->rows, first) - g->scroll_y + g->header;
+
+	if (column == g->selected_column && g->selected_row >= first && g->selected_row < last) {
+		int64_t y = Extent.offset(&g->rows, g->selected_row) - g->scroll_y + g->header;
+		Draw.rect(ctx, x, (int)y, width, Extent.size(&g->rows, g->selected_row), UI_RGB(204, 228, 255));
+	}
+	for (int row = first; row < last; ) {
+		int block = row / GRID_TILE_ROWS;
+		int end = (block + 1) * GRID_TILE_ROWS < last ? (block + 1) * GRID_TILE_ROWS : last;
+		grid_tile* t = fetch_tile(g, column, block);
+		g->stats.tiles++;
+		for (; row < end; ++row) {
+			int h = Extent.size(&g->rows, row);
+			draw_cell(g, t, row - block * GRID_TILE_ROWS, x, (int)top, h, line);
+			top += h;
+		}
+	}
+}
+/* walks the frozen columns, then the visible scrolled ones [left, right) */
+static inline int next_column(int c, int frozen, int left) {
+	return c + 1 == frozen ? left : c + 1;
+}
+/* the column whose right edge is within the grip of a header x (-1: none) */
+static int edge_at(ui_gridview g, int x) {
+	int fw = frozen_width(g);
+	int64_t content = x < fw ? x : x + g->scroll_x;
+	int column = Extent.index(&g->columns, content);
+	int64_t left = column_x(g, column);
+	int64_t right = left + Extent.size(&g->columns, column);
+	if (right - x <= GRID_GRIP && x - right <= GRID_GRIP) return column;
+	if (x - left <= GRID_GRIP && column > 0 && column != g->frozen) return column - 1;
+
+	return -1;
+}
+
+//	Module Callbacks ============================================================
+/* records the visible cells, then the header over them and the frozen columns beside them */
+static void render_grid(ui_context ctx, ui_module m, ui_input* input) {
+	ui_gridview g = m->widget;
+	if (!g || !m->win) return;
+	int width = m->win->width, height = m->win->height;
+
+	//	a header edge being dragged follows the mouse
+	if (g->drag >= 0 && input && (input->button & MOUSE_BUTTON_LEFT)) {
+		int w = input->mouse_x - m->win->x - (int)column_x(g, g->drag);
+		if (w < GRID_MIN_WIDTH) w = GRID_MIN_WIDTH;
+		if (w != Extent.size(&g->columns, g->drag)) Extent.set(ctx, &g->columns, g->drag, w);
+	}
+	clamp_scroll(g);
+
+	int fw = frozen_width(g);
+	int line = Font.height(g->font);
+	int first = Extent.index(&g->rows, g->scroll_y);
+	int last = first;
+	for (int64_t y = Extent.offset(&g->rows, first) - g->scroll_y + g->header; last < g->rows.count && y < height; ) {
+		y += Extent.size(&g->rows, last++);
+	}
+	int left = Extent.index(&g->columns, fw + g->scroll_x);
+	if (left < g->frozen) left = g->frozen;
+	int right = left;
+	for (int64_t x = column_x(g, left); right < g->columns.count && x < width; ) {
+		x += Extent.size(&g->columns, right++);
+	}
+	int frozen = g->frozen < g->columns.count ? g->frozen : g->columns.count;
+	reserve_tiles(g, (right - left + frozen) * ((last - first) / GRID_TILE_ROWS + 3));
+	if (!g->tiles) return;
+
+	g->stats.tiles = 0;
+	Draw.rect(ctx, 0, 0, width, height, g->background);
+
+	//	body: scrolled columns right of the frozen ones, then the frozen columns
+	Draw.push_clip(ctx, fw, g->header, width - fw, height - g->header);
+	for (int c = left; c < right; ++c) {
+		Draw.push_clip(ctx, (int)column_x(g, c), g->header, Extent.size(&g->columns, c), height - g->header);
+		draw_column(g, c, first, last, line);
+		Draw.pop_clip(ctx);
+	}
+	Draw.pop_clip(ctx);
+	for (int c = 0; c < frozen; ++c) {
+		Draw.push_clip(ctx, (int)column_x(g, c), g->header, Extent.size(&g->columns, c), height - g->header);
+		draw_column(g, c, first, last, line);
+		Draw.pop_clip(ctx);
+	}
+
+	//	grid lines
+	int64_t y = Extent.offset(&g->rows, first) - g->scroll_y + g->header;
+	for (int r = first; r < last; ++r) {
+		y += Extent.size(&g->rows, r);
+		if (y > g->header) Draw.rect(ctx, 0, (int)y - 1, width, 1, g->lines);
+	}
+	for (int c = frozen ? 0 : left; c < right; c = next_column(c, frozen, left)) {
+		int64_t x = column_x(g, c) + Extent.size(&g->columns, c) - 1;
+		if (c < frozen || x >= fw) Draw.rect(ctx, (int)x, 0, 1, height, g->lines);
+	}
+
+	//	frozen header row
+	if (g->header > 0) {
+		Draw.rect(ctx, 0, 0, width, g->header, g->header_color);
+		for (int c = frozen ? 0 : left; c < right; c = next_column(c, frozen, left)) {
+			int x = (int)column_x(g, c), w = Extent.size(&g->columns, c);
+			if (c >= frozen) Draw.push_clip(ctx, fw, 0, width - fw, g->header);
+			Draw.push_clip(ctx, x, 0, w - 1, g->header);
+			draw_cell(g, fetch_tile(g, c, GRID_HEADER_BLOCK), 0, x, 0, g->header, line);
+			Draw.pop_clip(ctx);
+			if (c >= frozen) Draw.pop_clip(ctx);
+			Draw.rect(ctx, x + w - 1, 0, 1, g->header, g->lines);
+		}
+		Draw.rect(ctx, 0, g->header - 1, width, 1, g->lines);
+	}
+
+	g->stats.first_row = first;
+	g->stats.last_row = last;
+	g->stats.first_column = left;
+	g->stats.last_column = right;
+}
+/* header edge presses start a column resize; cell presses select the cell */
+static void handle_grid(ui_context ctx, ui_module m, event_info ei) {
+	ui_gridview g = m->widget;
+	if (!g || !ei || !ei->e || !m->win) return;
+	event e = ei->e;
+	if (e->data.mouse.button != MOUSE_BUTTON_LEFT) return;
+
+	if (e->type == EVENT_MOUSE_RELEASE) {
+		g->drag = -1;
+		return;
+	}
+	if (e->type != EVENT_MOUSE_PRESS) return;
+
+	int x = e->data.mouse.x - m->win->x, y = e->data.mouse.y - m->win->y;
+	int row, column;
+	int hit = GridView.cell_at(g, x, y, &row, &column);
+	if (hit == 1) g->drag = edge_at(g, x);
+	else if (hit == 0) {
+		g->selected_row = row;
+		g->selected_column = column;
+	}
+}
+/* frees the grid with its module */
+static void release_grid(ui_module m) {
+	ui_gridview g = m->widget;
+	if (!g) return;
+
+	Extent.release(m->ctx, &g->rows);
+	Extent.release(m->ctx, &g->columns);
+	if (g->tiles) ui_free(m->ctx, g->tiles, ALLOC_WIDGET);
+	ui_free(m->ctx, g, ALLOC_WIDGET);
+	m->widget = NULL;
+}
+
+//	Grid Interface ==============================================================
+static ui_gridview new_grid(ui_context ctx, string name, window win, const gridview_source* source,
+									 int rows, int columns, int row_height, int column_width) {
+	if (!ctx || !source) return NULL;
+
+	ui_gridview g = ui_alloc(ctx, sizeof(struct ui_gridview_s), ALLOC_WIDGET);
+	if (!g) return NULL;
+	ui_module m = Sigui.add_module(ctx, name, render_grid, handle_grid, win);
+	if (!m) {
+		ui_free(ctx, g, ALLOC_WIDGET);
+		return NULL;
+	}
+	DBLOG("<Grid> new grid=%s rows=%d columns=%d", name, rows, columns);
+
+	g->module = m;
+	g->source = *source;
+	Extent.init(&g->rows, rows, row_height);
+	Extent.init(&g->columns, columns, column_width);
+	g->header = g->rows.size;
+	g->font = UI_FONT_DEFAULT;
+	g->color = UI_RGB(0, 0, 0);
+	g->background = UI_RGB(255, 255, 255);
+	g->header_color = UI_RGB(230, 230, 230);
+	g->lines = UI_RGB(208, 208, 208);
+	g->selected_row = g->selected_column = -1;
+	g->drag = -1;
+	m->widget = g;
+	m->release = release_grid;
+
+	return g;
+}
+static ui_module grid_module(ui_gridview g) {
+	return g ? g->module : NULL;
+}
+static void refresh_grid(ui_gridview g, int rows, int columns) {
+	if (!g) return;
+
+	Extent.resize(g->module->ctx, &g->rows, rows);
+	Extent.resize(g->module->ctx, &g->columns, columns);
+	if (g->tiles) clear_tiles(g);
+	if (g->selected_row >= rows || g->selected_column >= columns) g->selected_row = g->selected_column = -1;
+	g->drag = -1;
+	clamp_scroll(g);
+}
+static void set_header(ui_gridview g, int height) {
+	if (g) g->header = height > 0 ? height : 0;
+}
+static void freeze_columns(ui_gridview g, int columns) {
+	if (!g) return;
+
+	g->frozen = columns > 0 ? columns : 0;
+	clamp_scroll(g);
+}
+/* O(log n): the column's tiles are re-fitted the next time they are drawn */
+static void resize_column(ui_gridview g, int column, int width) {
+	if (g) Extent.set(g->module->ctx, &g->columns, column, width);
+}
+static int column_width(ui_gridview g, int column) {
+	return g ? Extent.size(&g->columns, column) : 0;
+}
+static void set_style(ui_gridview g, ui_font font, uint32_t color, uint32_t background, uint32_t header, uint32_t lines) {
+	if (!g) return;
+
+	if (g->font != font && g->tiles) {
+		for (int i = 0; i < g->tile_capacity; ++i) g->tiles[i].width = -1;
+	}
+	g->font = font;
+	g->color = color;
+	g->background = background;
+	g->header_color = header;
+	g->lines = lines;
+}
+static void scroll_to(ui_gridview g, int64_t x, int64_t y) {
+	if (!g) return;
+
+	g->scroll_x = x;
+	g->scroll_y = y;
+	clamp_scroll(g);
+}
+static void scroll_by(ui_gridview g, int64_t dx, int64_t dy) {
+	if (g) scroll_to(g, g->scroll_x + dx, g->scroll_y + dy);
+}
+static void grid_offset(ui_gridview g, int64_t* x, int64_t* y) {
+	if (x) *x = g ? g->scroll_x : 0;
+	if (y) *y = g ? g->scroll_y : 0;
+}
+/* O(log n) per axis */
+static int cell_at(ui_gridview g, int x, int y, int* row, int* column) {
+	if (!g || !g->module->win || x < 0 || y < 0 || x >= g->module->win->width || y >= g->module->win->height) return -1;
+
+	int fw = frozen_width(g);
+	int64_t cx = x < fw ? x : x + g->scroll_x;
+	if (cx >= Extent.total(&g->columns)) return -1;
+	int c = Extent.index(&g->columns, cx);
+	int r = -1;
+	if (y >= g->header) {
+		int64_t cy = y - g->header + g->scroll_y;
+		if (cy >= Extent.total(&g->rows)) return -1;
+		r = Extent.index(&g->rows, cy);
+	}
+	if (row) *row = r;
+	if (column) *column = c;
+
+	return r < 0 ? 1 : 0;
+}
+static int selected_cell(ui_gridview g, int* row, int* column) {
+	if (!g || g->selected_row < 0) return -1;
+	if (row) *row = g->selected_row;
+	if (column) *column = g->selected_column;
+
+	return 0;
+}
+static void grid_statistics(ui_gridview g, gridview_stats* out) {
+	if (g && out) *out = g->stats;
+}
+
+/* global grid view interface */
+const IGridView GridView = {
+	.new = new_grid,
+	.module = grid_module,
+	.refresh = refresh_grid,
+	.header = set_header,
+	.freeze = freeze_columns,
+	.resize_column = resize_column,
+	.column_width = column_width,
+	.style = set_style,
+	.scroll_to = scroll_to,
+	.scroll_by = scroll_by,
+	.offset = grid_offset,
+	.cell_at = cell_at,
+	.selected = selected_cell,
+	.stats = grid_statistics
+};
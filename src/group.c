@@ -0,0 +1,195 @@
+// group.c
+/**
+ * @detail Context groups. A fixed pool of worker threads steps independent
+ * 	(context, render target) members. Work is claimed with an atomic cursor so
+ * 	members are load-balanced; the calling thread takes part in every step.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include "sigui_group.h"
+#include "sigui_debug.h"
+
+//	Private structs =============================================================
+typedef struct group_member_s {
+	ui_context ctx;						// member context
+	render_target target;				// member render target (may be NULL)
+	ui_input input;						// input for the next step
+	int has_input;							// 0 = step without input
+} group_member;
+
+struct ui_group_s {
+	group_member* members;				// member array
+	int count, capacity;					// member count/capacity
+	pthread_t* workers;					// worker threads (threads - 1)
+	int threads;							// stepping threads including the caller
+	pthread_mutex_t lock;
+	pthread_cond_t start;				// signalled when a new step begins
+	pthread_cond_t done;					// signalled when the last worker finishes
+	unsigned long generation;			// step counter
+	int pending;							// workers still running the current step
+	int shutdown;							// 1 = workers exit
+	atomic_int next;						// next member to claim
+};
+
+//	Helper Functions ============================================================
+/* steps one member: logic then render */
+static void step_member(group_member* gm) {
+	Sigui.render(gm->ctx, gm->has_input ? &gm->input : NULL);
+	if (gm->target) Render.frame(gm->target, gm->ctx);
+}
+/* claims and steps members until none are left */
+static void run_members(ui_group g) {
+	int i;
+	while ((i = atomic_fetch_add(&g->next, 1)) < g->count) {
+		step_member(&g->members[i]);
+	}
+}
+/* worker thread */
+static void* worker_main(void* arg) {
+	ui_group g = arg;
+	unsigned long seen = 0;
+
+	pthread_mutex_lock(&g->lock);
+	while (1) {
+		while (g->generation == seen && !g->shutdown) pthread_cond_wait(&g->start, &g->lock);
+		if (g->shutdown) break;
+		seen = g->generation;
+		pthread_mutex_unlock(&g->lock);
+
+		run_members(g);
+
+		pthread_mutex_lock(&g->lock);
+		if (--g->pending == 0) pthread_cond_signal(&g->done);
+	}
+	pthread_mutex_unlock(&g->lock);
+
+	return NULL;
+}
+
+/* creates a context group */
+static ui_group new_group(int threads) {
+	if (threads <= 0) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (int)cores : 1;
+	}
+
+	ui_group g = Mem.alloc(sizeof(struct ui_group_s));
+	if (!g) return NULL;
+	memset(g, 0, sizeof(struct ui_group_s));
+
+	g->threads = threads;
+	pthread_mutex_init(&g->lock, NULL);
+	pthread_cond_init(&g->start, NULL);
+	pthread_cond_init(&g->done, NULL);
+	atomic_init(&g->next, 0);
+
+	if (threads > 1) {
+		g->workers = Mem.alloc(sizeof(pthread_t) * (threads - 1));
+		if (!g->workers) {
+			Mem.free(g);
+			return NULL;
+		}
+		int i = 0;
+		while (i < threads - 1) {
+			if (pthread_create(&g->workers[i], NULL, worker_main, g) != 0) break;
+			++i;
+		}
+		g->threads = i + 1;		// run with the workers we got
+	}
+	DBLOG("Group created: threads=%d", g->threads);
+
+	return g;
+}
+/* stops the pool and frees the group */
+static void free_group(ui_group g) {
+	if (!g) return;
+
+	pthread_mutex_lock(&g->lock);
+	g->shutdown = 1;
+	pthread_cond_broadcast(&g->start);
+	pthread_mutex_unlock(&g->lock);
+
+	int i = 0;
+	while (i < g->threads - 1) pthread_join(g->workers[i++], NULL);
+
+	pthread_cond_destroy(&g->done);
+	pthread_cond_destroy(&g->start);
+	pthread_mutex_destroy(&g->lock);
+	if (g->workers) Mem.free(g->workers);
+	if (g->members) Mem.free(g->members);
+	Mem.free(g);
+}
+/* adds a member */
+static int add_member(ui_group g, ui_context ctx, render_target target) {
+	if (!g || !ctx) return -1;
+
+	if (g->count == g->capacity) {
+		int capacity = g->capacity ? g->capacity * 2 : 8;
+		group_member* members = Mem.alloc(sizeof(group_member) * capacity);
+		if (!members) return -1;
+		if (g->members) {
+			memcpy(members, g->members, sizeof(group_member) * g->count);
+			Mem.free(g->members);
+		}
+		g->members = members;
+		g->capacity = capacity;
+	}
+
+	group_member* gm = &g->members[g->count];
+	memset(gm, 0, sizeof(group_member));
+	gm->ctx = ctx;
+	gm->target = target;
+
+	return g->count++;
+}
+/* sets the input of a member for the next step */
+static void set_member_input(ui_group g, int index, ui_input* input) {
+	if (!g || index < 0 || index >= g->count) return;
+
+	group_member* gm = &g->members[index];
+	gm->has_input = input != NULL;
+	if (input) gm->input = *input;
+}
+/* steps every member once */
+static void step_group(ui_group g) {
+	if (!g || g->count == 0) return;
+
+	atomic_store(&g->next, 0);
+	if (g->threads > 1) {
+		pthread_mutex_lock(&g->lock);
+		g->pending = g->threads - 1;
+		g->generation++;
+		pthread_cond_broadcast(&g->start);
+		pthread_mutex_unlock(&g->lock);
+	}
+
+	run_members(g);
+
+	if (g->threads > 1) {
+		pthread_mutex_lock(&g->lock);
+		while (g->pending > 0) pthread_cond_wait(&g->done, &g->lock);
+		pthread_mutex_unlock(&g->lock);
+	}
+}
+/* member count */
+static int member_count(ui_group g) {
+	return g ? g->count : 0;
+}
+/* stepping threads */
+static int thread_count(ui_group g) {
+	return g ? g->threads : 0;
+}
+
+/* group interface */
+const IGroup Group = {
+	.new = new_group,
+	.free = free_group,
+	.add = add_member,
+	.set_input = set_member_input,
+	.step = step_group,
+	.count = member_count,
+	.threads = thread_count
+};
@@ -0,0 +1,555 @@
+// image.c
+/**
+ * @detail Images. `Image.load`/`Image.decode` register a handle and queue the
+ * 	source on a small pool of decoder threads, started with the first image.
+ * 	PPM (P5/P6, 8-bit) and QOI decode into ARGB8888 without external libraries.
+ * 	Slots are guarded by one lock; decoding runs outside it, so a free during a
+ * 	decode only marks the slot and the worker drops its result. Readers pin the
+ * 	pixels (`Images.pixels` .. `Images.release`): a free while pinned leaves
+ * 	decoded pixels to the last release, and waits for it when they are borrowed
+ * 	(`Images.wrap`), since the caller takes them back on return. A slot nothing
+ * 	refers to any more goes on a free list and is reused oldest first; a handle
+ * 	carries its slot's reuse count, so a stale handle (or a texture cached under
+ * 	it) resolves to no image rather than to the one that took its slot.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+#define IMAGE_WORKERS 2				/* default decoder threads */
+#define IMAGE_WORKERS_MAX 16
+#define IMAGE_SIDE_MAX 16384			/* widest/tallest decodable image */
+#define IMAGE_PIXELS_MAX (1 << 26)	/* largest decodable image (256 MiB as ARGB) */
+#define IMAGE_FILE_MAX (1 << 30)		/* largest source file read */
+#define IMAGE_REUSE_MASK ((1 << (31 - IMAGE_INDEX_BITS)) - 1)	/* reuse counts that keep a handle positive */
+
+/* registered image */
+typedef struct image_slot_s {
+	image_state state;
+	int decoding;						/* a worker holds the source */
+	char* path;							/* file source (NULL=bytes) */
+	uint8_t* bytes;					/* in-memory source */
+	size_t size;
+	uint32_t* pixels;					/* decoded ARGB */
+	int width, height;
+	int opaque;							/* every pixel has alpha 255 */
+	int borrowed;						/* pixels owned by the caller (Images.wrap) */
+	int pins;							/* readers between Images.pixels and Images.release */
+	int reuse;							/* times the slot was freed (handle bits above the index) */
+	int next_free;						/* next slot on the free list (-1: last) */
+} image_slot;
+
+//	Engine State ================================================================
+static image_slot* slots = NULL;	/* slot i holds handle (reuse << IMAGE_INDEX_BITS | i + 1) */
+static int slot_count = 0, slot_capacity = 0;
+static int free_head = -1, free_tail = -1;	/* reusable slots, oldest first */
+static int* queue = NULL;			/* ring of handles waiting for a worker */
+static int queue_head = 0, queue_count = 0, queue_capacity = 0;
+static int worker_target = IMAGE_WORKERS;
+static int worker_count = 0;
+static uint64_t generation = 0;
+static pthread_mutex_t image_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t image_work = PTHREAD_COND_INITIALIZER;	/* queue not empty */
+static pthread_cond_t image_done = PTHREAD_COND_INITIALIZER;	/* a decode finished */
+
+//	Decoders ====================================================================
+/* reads a big-endian 32-bit value */
+static inline uint32_t read_be32(const uint8_t* p) {
+	return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+/* allocates the output of a decode after checking its size */
+static uint32_t* alloc_pixels(uint32_t w, uint32_t h) {
+	if (!w || !h || w > IMAGE_SIDE_MAX || h > IMAGE_SIDE_MAX || (uint64_t)w * h > IMAGE_PIXELS_MAX) return NULL;
+
+	return Mem.alloc(sizeof(uint32_t) * (size_t)w * h);
+}
+/* skips PPM whitespace and comments; reads one decimal header field (-1=malformed) */
+static long ppm_field(const uint8_t** p, const uint8_t* end) {
+	while (*p < end) {
+		if (**p == '#') {
+			while (*p < end && **p != '\n') (*p)++;
+		} else if (**p == ' ' || **p == '\t' || **p == '\r' || **p == '\n') {
+			(*p)++;
+		} else {
+			break;
+		}
+	}
+	if (*p == end || **p < '0' || **p > '9') return -1;
+
+	long v = 0;
+	while (*p < end && **p >= '0' && **p <= '9') {
+		v = v * 10 + (**p - '0');
+		(*p)++;
+		if (v > IMAGE_SIDE_MAX * 16L) return -1;
+	}
+
+	return v;
+}
+/* binary PPM (P6, RGB) or PGM (P5, gray) with maxval <= 255; 0 on success */
+static int decode_ppm(const uint8_t* data, size_t size, image_slot* out) {
+	if (size < 2 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) return -1;
+	int channels = data[1] == '6' ? 3 : 1;
+
+	const uint8_t* p = data + 2;
+	const uint8_t* end = data + size;
+	long w = ppm_field(&p, end), h = ppm_field(&p, end), max = ppm_field(&p, end);
+	if (w <= 0 || h <= 0 || max <= 0 || max > 255 || p == end) return -1;
+	p++;		// single whitespace before the raster
+	if ((size_t)(end - p) < (size_t)w * h * channels) return -1;
+
+	uint32_t* px = alloc_pixels((uint32_t)w, (uint32_t)h);
+	if (!px) return -1;
+	size_t n = (size_t)w * h;
+	for (size_t i = 0; i < n; ++i, p += channels) {
+		uint32_t r = p[0], g = p[channels > 1], b = p[channels > 1 ? 2 : 0];
+		if (max != 255) {
+			r = r > (uint32_t)max ? 255 : (r * 255 + max / 2) / max;
+			g = g > (uint32_t)max ? 255 : (g * 255 + max / 2) / max;
+			b = b > (uint32_t)max ? 255 : (b * 255 + max / 2) / max;
+		}
+		px[i] = 0xFF000000u | r << 16 | g << 8 | b;
+	}
+	out->pixels = px;
+	out->width = (int)w;
+	out->height = (int)h;
+	out->opaque = 1;
+
+	return 0;
+}
+/* QOI ("qoif", RGB or RGBA, any colorspace); 0 on success */
+static int decode_qoi(const uint8_t* data, size_t size, image_slot* out) {
+	if (size < 14 + 8 || memcmp(data, "qoif", 4) != 0) return -1;
+	uint32_t w = read_be32(data + 4), h = read_be32(data + 8);
+	if (data[12] != 3 && data[12] != 4) return -1;
+
+	uint32_t* px = alloc_pixels(w, h);
+	if (!px) return -1;
+
+	//	index and pixel as R, G, B, A bytes
+	uint8_t index[64][4];
+	memset(index, 0, sizeof(index));
+	uint8_t c[4] = { 0, 0, 0, 255 };
+	const uint8_t* p = data + 14;
+	const uint8_t* end = data + size - 8;		// end marker
+	size_t n = (size_t)w * h, i = 0;
+	uint32_t alpha = 0xFF;
+	while (i < n) {
+		if (p >= end) {
+			Mem.free(px);
+			return -1;
+		}
+		uint8_t op = *p++;
+		int run = 1;
+		if (op == 0xFE || op == 0xFF) {
+			int bytes = op == 0xFE ? 3 : 4;
+			if (end - p < bytes) break;
+			memcpy(c, p, bytes);
+			p += bytes;
+		} else if ((op >> 6) == 0) {
+			memcpy(c, index[op], 4);
+		} else if ((op >> 6) == 1) {
+			c[0] += ((op >> 4) & 3) - 2;
+			c[1] += ((op >> 2) & 3) - 2;
+			c[2] += (op & 3) - 2;
+		} else if ((op >> 6) == 2) {
+			if (p == end) break;
+			int dg = (op & 0x3F) - 32;
+			int drb = *p++;
+			c[0] += dg + (drb >> 4) - 8;
+			c[1] += dg;
+			c[2] += dg + (drb & 0x0F) - 8;
+		} else {
+			run = (op & 0x3F) + 1;
+		}
+		memcpy(index[(c[0] * 3 + c[1] * 5 + c[2] * 7 + c[3] * 11) % 64], c, 4);
+
+		uint32_t argb = (uint32_t)c[3] << 24 | (uint32_t)c[0] << 16 | (uint32_t)c[1] << 8 | c[2];
+		alpha &= c[3];
+		while (run-- && i < n) px[i++] = argb;
+	}
+	if (i < n) {
+		Mem.free(px);
+		return -1;
+	}
+	out->pixels = px;
+	out->width = (int)w;
+	out->height = (int)h;
+	out->opaque = alpha == 0xFF;
+
+	return 0;
+}
+/* reads a whole file (NULL=unreadable) */
+static uint8_t* read_file(const char* path, size_t* size) {
+	FILE* f = fopen(path, "rb");
+	if (!f) return NULL;
+
+	size_t capacity = 0, count = 0;
+	uint8_t* data = NULL;
+	while (1) {
+		if (count == capacity) {
+			size_t grown = capacity ? capacity * 2 : 1 << 16;
+			uint8_t* buffer = grown <= IMAGE_FILE_MAX ? Mem.alloc(grown) : NULL;
+			if (!buffer) break;
+			if (data) {
+				memcpy(buffer, data, count);
+				Mem.free(data);
+			}
+			data = buffer;
+			capacity = grown;
+		}
+		size_t got = fread(data + count, 1, capacity - count, f);
+		count += got;
+		if (got == 0) {
+			fclose(f);
+			*size = count;
+			return data;
+		}
+	}
+	fclose(f);
+	if (data) Mem.free(data);
+
+	return NULL;
+}
+
+//	Workers =====================================================================
+/* decodes a source into a scratch slot; 0 on success */
+static int decode_source(const char* path, const uint8_t* bytes, size_t size, image_slot* out) {
+	uint8_t* file = NULL;
+	if (path) {
+		file = read_file(path, &size);
+		if (!file) {
+			DBLOG("<Image> cannot read %s", path);
+			return -1;
+		}
+		bytes = file;
+	}
+	int ret = size >= 4 && memcmp(bytes, "qoif", 4) == 0 ? decode_qoi(bytes, size, out) : decode_ppm(bytes, size, out);
+	if (file) Mem.free(file);
+
+	return ret;
+}
+/* drops a slot's source */
+static void free_source(image_slot* s) {
+	if (s->path) Mem.free(s->path);
+	if (s->bytes) Mem.free(s->bytes);
+	s->path = NULL;
+	s->bytes = NULL;
+	s->size = 0;
+}
+/* slot of a handle (lock held; NULL=unknown or stale) */
+static image_slot* slot_of(ui_image image) {
+	int i = ui_image_index(image) - 1;
+	if (image <= 0 || i < 0 || i >= slot_count) return NULL;
+
+	return slots[i].reuse == image >> IMAGE_INDEX_BITS ? &slots[i] : NULL;
+}
+/* frees a slot for reuse once no worker, reader or queue refers to it (lock held) */
+static void recycle_slot(image_slot* s) {
+	if (s->state != IMAGE_NONE || s->decoding || s->pins) return;
+
+	int i = (int)(s - slots);
+	s->reuse = (s->reuse + 1) & IMAGE_REUSE_MASK;		// queued and caller handles go stale
+	s->next_free = -1;
+	if (free_tail >= 0) slots[free_tail].next_free = i;
+	else free_head = i;
+	free_tail = i;
+}
+/* decoder thread: takes queued handles until the process exits */
+static void* worker_main(void* arg) {
+	(void)arg;
+	pthread_mutex_lock(&image_lock);
+	while (1) {
+		while (!queue_count) pthread_cond_wait(&image_work, &image_lock);
+		int handle = queue[queue_head];
+		queue_head = (queue_head + 1) % queue_capacity;
+		queue_count--;
+
+		image_slot* s = slot_of(handle);
+		if (!s || s->state != IMAGE_PENDING) continue;		// freed while queued
+		s->decoding = 1;
+		char* path = s->path;
+		uint8_t* bytes = s->bytes;
+		size_t size = s->size;
+		pthread_mutex_unlock(&image_lock);
+
+		image_slot result = {0};
+		int ret = decode_source(path, bytes, size, &result);
+
+		pthread_mutex_lock(&image_lock);
+		s = slot_of(handle);		// slots may have moved
+		s->decoding = 0;
+		free_source(s);
+		if (s->state != IMAGE_PENDING) {
+			if (result.pixels) Mem.free(result.pixels);		// freed while decoding
+			recycle_slot(s);
+		} else if (ret != 0) {
+			s->state = IMAGE_FAILED;
+		} else {
+			s->pixels = result.pixels;
+			s->width = result.width;
+			s->height = result.height;
+			s->opaque = result.opaque;
+			s->state = IMAGE_READY;
+		}
+		__atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+		pthread_cond_broadcast(&image_done);
+	}
+
+	return NULL;
+}
+/* queues a handle, starting the workers on first use (lock held); 0 on success */
+static int enqueue(int handle) {
+	if (queue_count == queue_capacity) {
+		int capacity = queue_capacity ? queue_capacity * 2 : 64;
+		int* ring = Mem.alloc(sizeof(int) * capacity);
+		if (!ring) return -1;
+		for (int i = 0; i < queue_count; ++i) ring[i] = queue[(queue_head + i) % queue_capacity];
+		if (queue) Mem.free(queue);
+		queue = ring;
+		queue_head = 0;
+		queue_capacity = capacity;
+	}
+	while (worker_count < worker_target) {
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, worker_main, NULL) != 0) break;
+		pthread_detach(thread);
+		worker_count++;
+	}
+	if (!worker_count) return -1;
+
+	queue[(queue_head + queue_count++) % queue_capacity] = handle;
+	pthread_cond_signal(&image_work);
+
+	return 0;
+}
+/* makes room for one more slot (lock held); 0 on success */
+static int reserve_slot(void) {
+	if (slot_count < slot_capacity) return 0;
+	if (slot_count + 1 >= 1 << IMAGE_INDEX_BITS) return -1;
+
+	int capacity = slot_capacity ? slot_capacity * 2 : 64;
+	image_slot* grown = Mem.alloc(sizeof(image_slot) * capacity);
+	if (!grown) return -1;
+	if (slots) {
+		memcpy(grown, slots, sizeof(image_slot) * slot_count);
+		Mem.free(slots);
+	}
+	slots = grown;
+	slot_capacity = capacity;
+
+	return 0;
+}
+/* takes an empty slot, the oldest freed one first (lock held); its index, -1 when full */
+static int take_slot(void) {
+	int i = free_head;
+	if (i >= 0) {
+		free_head = slots[i].next_free;
+		if (free_head < 0) free_tail = -1;
+	} else {
+		if (reserve_slot() != 0) return -1;
+		i = slot_count++;
+		slots[i].reuse = 0;
+	}
+	slots[i] = (image_slot){ .reuse = slots[i].reuse, .next_free = -1 };
+
+	return i;
+}
+/* handle of the image in slot i (lock held) */
+static inline ui_image handle_of(int i) {
+	return slots[i].reuse << IMAGE_INDEX_BITS | (i + 1);
+}
+/* registers a pending image owning a source (freed on failure); returns its handle (0=failure) */
+static ui_image add_image(char* path, uint8_t* bytes, size_t size) {
+	pthread_mutex_lock(&image_lock);
+	ui_image handle = 0;
+	int i = take_slot();
+	if (i < 0) goto done;
+	if (enqueue(handle_of(i)) != 0) {
+		recycle_slot(&slots[i]);
+		goto done;
+	}
+
+	image_slot* s = &slots[i];
+	s->state = IMAGE_PENDING;
+	s->path = path;
+	s->bytes = bytes;
+	s->size = size;
+	handle = handle_of(i);
+
+done:
+	pthread_mutex_unlock(&image_lock);
+	if (!handle) {
+		if (path) Mem.free(path);
+		if (bytes) Mem.free(bytes);
+	}
+	return handle;
+}
+
+/* queues a file for decoding */
+static ui_image load_image(const char* path) {
+	if (!path) return 0;
+	size_t length = strlen(path);
+	char* copy = Mem.alloc(length + 1);
+	if (!copy) return 0;
+	memcpy(copy, path, length + 1);
+
+	return add_image(copy, NULL, 0);
+}
+/* queues a copy of in-memory data for decoding */
+static ui_image decode_image(const void* data, size_t size) {
+	if (!data || !size) return 0;
+	uint8_t* copy = Mem.alloc(size);
+	if (!copy) return 0;
+	memcpy(copy, data, size);
+
+	return add_image(NULL, copy, size);
+}
+/* drops a freed slot's pixels once no reader holds them (lock held) */
+static void drop_pixels(image_slot* s) {
+	if (s->pins) return;
+	if (s->pixels && !s->borrowed) Mem.free(s->pixels);
+	s->pixels = NULL;
+}
+/* releases an image; a worker holding its source drops the result, a reader its pixels */
+static void free_image(ui_image image) {
+	pthread_mutex_lock(&image_lock);
+	image_slot* s = slot_of(image);
+	if (s && s->state != IMAGE_NONE) {
+		if (!s->decoding) free_source(s);
+		s->state = IMAGE_NONE;
+		while (s && s->borrowed && s->pins) {
+			pthread_cond_wait(&image_done, &image_lock);
+			s = slot_of(image);		// slots may have moved, or the last release recycled it
+		}
+		if (s) {
+			drop_pixels(s);
+			recycle_slot(s);
+		}
+		__atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+		pthread_cond_broadcast(&image_done);
+	}
+	pthread_mutex_unlock(&image_lock);
+}
+/* decode state */
+static image_state image_state_of(ui_image image) {
+	pthread_mutex_lock(&image_lock);
+	image_slot* s = slot_of(image);
+	image_state state = s ? s->state : IMAGE_NONE;
+	pthread_mutex_unlock(&image_lock);
+
+	return state;
+}
+/* decoded size */
+static int image_size(ui_image image, int* width, int* height) {
+	pthread_mutex_lock(&image_lock);
+	image_slot* s = slot_of(image);
+	int ret = -1;
+	if (s && s->state == IMAGE_READY) {
+		if (width) *width = s->width;
+		if (height) *height = s->height;
+		ret = 0;
+	}
+	pthread_mutex_unlock(&image_lock);
+
+	return ret;
+}
+/* blocks until an image leaves the pending state */
+static int wait_image(ui_image image) {
+	pthread_mutex_lock(&image_lock);
+	image_slot* s;
+	while ((s = slot_of(image)) && s->state == IMAGE_PENDING) pthread_cond_wait(&image_done, &image_lock);
+	int ret = s && s->state == IMAGE_READY ? 0 : -1;
+	pthread_mutex_unlock(&image_lock);
+
+	return ret;
+}
+/* sets the decoder thread count (running workers are kept) */
+static void set_workers(int count) {
+	pthread_mutex_lock(&image_lock);
+	worker_target = count < 1 ? 1 : count > IMAGE_WORKERS_MAX ? IMAGE_WORKERS_MAX : count;
+	pthread_mutex_unlock(&image_lock);
+}
+/* decoded pixels of a ready image, pinned until release_pixels */
+static const uint32_t* image_pixels(ui_image image, int* width, int* height, int* opaque) {
+	pthread_mutex_lock(&image_lock);
+	image_slot* s = slot_of(image);
+	const uint32_t* px = NULL;
+	if (s && s->state == IMAGE_READY) {
+		px = s->pixels;
+		s->pins++;
+		if (width) *width = s->width;
+		if (height) *height = s->height;
+		if (opaque) *opaque = s->opaque;
+	}
+	pthread_mutex_unlock(&image_lock);
+
+	return px;
+}
+/* unpins pixels; the last release of a freed image drops them */
+static void release_pixels(ui_image image) {
+	pthread_mutex_lock(&image_lock);
+	image_slot* s = slot_of(image);
+	if (s && s->pins > 0 && --s->pins == 0 && s->state == IMAGE_NONE) {
+		drop_pixels(s);
+		recycle_slot(s);
+		pthread_cond_broadcast(&image_done);
+	}
+	pthread_mutex_unlock(&image_lock);
+}
+/* registers caller-owned pixels as a ready image; they are neither copied nor freed */
+static ui_image wrap_pixels(const uint32_t* pixels, int width, int height, int opaque) {
+	if (!pixels || width <= 0 || height <= 0) return 0;
+
+	pthread_mutex_lock(&image_lock);
+	ui_image handle = 0;
+	int i = take_slot();
+	if (i >= 0) {
+		image_slot* s = &slots[i];
+		s->state = IMAGE_READY;
+		s->pixels = (uint32_t*)pixels;
+		s->width = width;
+		s->height = height;
+		s->opaque = opaque;
+		s->borrowed = 1;
+		handle = handle_of(i);
+		__atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+		pthread_cond_broadcast(&image_done);
+	}
+	pthread_mutex_unlock(&image_lock);
+
+	return handle;
+}
+/* registry size: live slots and free ones */
+static int image_slots(void) {
+	pthread_mutex_lock(&image_lock);
+	int count = slot_count;
+	pthread_mutex_unlock(&image_lock);
+
+	return count;
+}
+/* registry generation */
+static uint64_t image_generation(void) {
+	return __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+}
+
+/* decoded image source interface (internal) */
+const IImages Images = {
+	.pixels = image_pixels,
+	.release = release_pixels,
+	.wrap = wrap_pixels,
+	.generation = image_generation,
+	.slots = image_slots
+};
+/* image interface */
+const IImage Image = {
+	.load = load_image,
+	.decode = decode_image,
+	.free = free_image,
+	.state = image_state_of,
+	.size = image_size,
+	.wait = wait_image,
+	.workers = set_workers
+};
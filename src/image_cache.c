@@ -0,0 +1,136 @@
+// image_cache.c
+/**
+ * @detail Per-target image caches. Headless targets sample decoded images in
+ * 	place, so an image is drawable as soon as it is decoded. Window targets draw
+ * 	from textures: the first draw of a decoded image adds an entry, the backend
+ * 	streams its rows in within the per-frame upload budget, and it becomes
+ * 	drawable once every row is resident. Entries are found through a direct
+ * 	array indexed by the handle's registry slot (small, since freed slots are
+ * 	reused). A stale entry keeps its slot until the backend drops it after the
+ * 	free, and the image that reused the slot waits as a placeholder till then.
+ */
+
+#include <string.h>
+#include "render_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+static image_entry* find_entry(image_table* it, ui_image image) {
+	int index = ui_image_index(image);
+	if (image <= 0 || index >= it->slot_capacity || !it->slots[index]) return NULL;
+
+	image_entry* e = &it->entries[it->slots[index] - 1];
+	return e->image == image ? e : NULL;
+}
+/* adds an entry (NULL: no memory, or a freed image's entry still holds the slot) */
+static image_entry* add_entry(image_table* it, ui_image image) {
+	int index = ui_image_index(image);
+	if (index < it->slot_capacity && it->slots[index]) return NULL;
+	if (index >= it->slot_capacity) {
+		int capacity = it->slot_capacity ? it->slot_capacity : 64;
+		while (capacity <= index) capacity *= 2;
+		int* slots = Mem.alloc(sizeof(int) * capacity);
+		if (!slots) return NULL;
+		memset(slots, 0, sizeof(int) * capacity);
+		if (it->slots) {
+			memcpy(slots, it->slots, sizeof(int) * it->slot_capacity);
+			Mem.free(it->slots);
+		}
+		it->slots = slots;
+		it->slot_capacity = capacity;
+	}
+	if (it->count == it->capacity) {
+		int capacity = it->capacity ? it->capacity * 2 : 16;
+		image_entry* entries = Mem.alloc(sizeof(image_entry) * capacity);
+		if (!entries) return NULL;
+		if (it->entries) {
+			memcpy(entries, it->entries, sizeof(image_entry) * it->count);
+			Mem.free(it->entries);
+		}
+		it->entries = entries;
+		it->capacity = capacity;
+	}
+
+	image_entry* e = &it->entries[it->count++];
+	memset(e, 0, sizeof(image_entry));
+	e->image = image;
+	it->slots[index] = it->count;
+
+	return e;
+}
+/* whether an image can be drawn now; window targets add decoded images for upload */
+static int lookup(image_table* it, ui_image image, uint64_t frame) {
+	if (!it->streamed) return Image.state(image) == IMAGE_READY;
+
+	image_entry* e = find_entry(it, image);
+	if (!e) {
+		int w, h, opaque;
+		if (!Images.pixels(image, &w, &h, &opaque)) return 0;
+		Images.release(image);		// only the size is kept; stream_images reads the pixels
+		if (!(e = add_entry(it, image))) return 0;
+		e->width = w;
+		e->height = h;
+		e->opaque = opaque;
+	}
+	e->used = frame;
+
+	return e->rows == e->height;
+}
+
+/* draw lookup: counts a hit (drawable) or a miss (placeholder) */
+static int ready_image(image_table* it, ui_image image, uint64_t frame) {
+	int ready = lookup(it, image, frame);
+	if (ready) it->hits++;
+	else it->misses++;
+
+	return ready;
+}
+/* marks a cached module's images drawn; 0 when one is no longer drawable */
+static int touch_images(image_table* it, const image_quad* quads, int count, uint64_t frame) {
+	int ready = 1;
+	for (int i = 0; i < count; ++i) ready &= lookup(it, quads[i].image, frame);
+
+	return ready;
+}
+/* least recently drawn entry holding storage, not drawn since `frame` */
+static image_entry* lru_entry(image_table* it, uint64_t frame) {
+	image_entry* lru = NULL;
+	for (int i = 0; i < it->count; ++i) {
+		image_entry* e = &it->entries[i];
+		if (!e->bytes || e->used >= frame) continue;
+		if (!lru || e->used < lru->used) lru = e;
+	}
+
+	return lru;
+}
+/* drops an entry; the last entry moves into its place */
+static void remove_entry(image_table* it, image_entry* e) {
+	it->bytes -= e->bytes;
+	it->slots[ui_image_index(e->image)] = 0;
+	image_entry* last = &it->entries[--it->count];
+	if (e != last) {
+		*e = *last;
+		it->slots[ui_image_index(e->image)] = (int)(e - it->entries) + 1;
+	}
+	it->stamp++;
+}
+/* frees the table storage; budgets and statistics are kept */
+static void release_table(image_table* it) {
+	if (it->entries) Mem.free(it->entries);
+	if (it->slots) Mem.free(it->slots);
+	it->entries = NULL;
+	it->slots = NULL;
+	it->count = it->capacity = it->slot_capacity = 0;
+	it->bytes = 0;
+}
+
+/* per-target image cache interface (internal) */
+const IImageCache ImageCache = {
+	.ready = ready_image,
+	.request = lookup,
+	.touch = touch_images,
+	.find = find_entry,
+	.lru = lru_entry,
+	.remove = remove_entry,
+	.release = release_table
+};
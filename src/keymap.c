@@ -0,0 +1,309 @@
+// keymap.c
+/**
+ * @detail Key bindings. Bindings are kept as registered and compiled on demand
+ * 	into a trie: every scope (a module, or NULL for global bindings) gets a
+ * 	root node, and every stroke of a binding an edge. Edges are not stored per
+ * 	node but in one open-addressed table keyed by (parent, modifiers, key), so
+ * 	following an edge is a hash probe whatever the fan-out, and a key press is
+ * 	at most two lookups (focused scope, then global). A node that completes a
+ * 	binding holds its command id; bind refuses sequences that are a prefix of
+ * 	another in the same scope, so completing nodes are always leaves and no
+ * 	timeout is needed to tell a short binding from a longer one.
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+/* edge table key; parents start at 1 so a used key is never 0 */
+static inline uint64_t edge_key(int parent, uint32_t modifiers, int key) {
+	return (uint64_t)parent << 40 | (uint64_t)(modifiers & KEY_MOD_ALL) << 32 | (uint32_t)key;
+}
+/* Fibonacci hashing: the top bits of the product index the table */
+static inline uint32_t edge_slot(const keymap* km, uint64_t key) {
+	return ui_fib_slot(key, __builtin_popcount(km->edge_mask));
+}
+
+//	Helper Functions ============================================================
+/* child of a node along a stroke (0: none) */
+static int find_edge(keymap* km, int parent, uint32_t modifiers, int key) {
+	if (!km->edges || !parent) return 0;
+
+	uint64_t k = edge_key(parent, modifiers, key);
+	for (uint32_t slot = edge_slot(km, k); ; slot = (slot + 1) & km->edge_mask) {
+		km->stats.probes++;
+		if (km->edges[slot].key == k) return km->edges[slot].child;
+		if (!km->edges[slot].key) return 0;
+	}
+}
+static void add_edge(keymap* km, int parent, uint32_t modifiers, int key, int child) {
+	uint64_t k = edge_key(parent, modifiers, key);
+	uint32_t slot = edge_slot(km, k);
+	while (km->edges[slot].key) slot = (slot + 1) & km->edge_mask;
+	km->edges[slot].key = k;
+	km->edges[slot].child = child;
+}
+/* root of a scope's trie (0: the scope has no bindings) */
+static int scope_root(keymap* km, ui_module scope) {
+	for (int i = 0; i < km->scope_count; ++i) {
+		if (km->scopes[i] == scope) return i + 1;
+	}
+
+	return 0;
+}
+/* binding with the same scope and strokes (-1: none) */
+static int find_binding(keymap* km, ui_module scope, const key_stroke* strokes, int count) {
+	for (int i = 0; i < km->binding_count; ++i) {
+		key_binding* b = &km->bindings[i];
+		if (b->scope != scope || b->count != count) continue;
+		int same = 1;
+		for (int s = 0; same && s < count; ++s) {
+			same = b->strokes[s].key == strokes[s].key &&
+					 (b->strokes[s].modifiers & KEY_MOD_ALL) == (strokes[s].modifiers & KEY_MOD_ALL);
+		}
+		if (same) return i;
+	}
+
+	return -1;
+}
+/* 1 when a binding of the scope starts with the other's strokes or the other way round */
+static int prefix_conflict(keymap* km, ui_module scope, const key_stroke* strokes, int count) {
+	for (int i = 0; i < km->binding_count; ++i) {
+		key_binding* b = &km->bindings[i];
+		int n = b->count < count ? b->count : count;
+		if (b->scope != scope || b->count == count) continue;
+		int same = 1;
+		for (int s = 0; same && s < n; ++s) {
+			same = b->strokes[s].key == strokes[s].key &&
+					 (b->strokes[s].modifiers & KEY_MOD_ALL) == (strokes[s].modifiers & KEY_MOD_ALL);
+		}
+		if (same) return 1;
+	}
+
+	return 0;
+}
+/* frees the compiled table */
+static void free_table(ui_context ctx, keymap* km) {
+	if (km->edges) ui_free(ctx, km->edges, ALLOC_KEYMAP);
+	if (km->accept) ui_free(ctx, km->accept, ALLOC_KEYMAP);
+	if (km->scopes) ui_free(ctx, km->scopes, ALLOC_KEYMAP);
+	km->edges = NULL;
+	km->accept = NULL;
+	km->scopes = NULL;
+	km->edge_mask = 0;
+	km->scope_count = 0;
+	km->global_root = km->focus_root = 0;
+	km->stats.nodes = km->stats.slots = 0;
+}
+/* queues a binding's command for its scope (or the focused module) */
+static void run_command(ui_context ctx, keymap* km, int id, ui_module scope) {
+	key_command* kc = &km->commands[id - 1];
+	command cmd = Sigui.new_command(ctx, kc->name);
+	if (!cmd) return;
+	DBLOG("<Keymap> matched command=%s", kc->name);
+
+	cmd->target = scope ? scope : km->focus;
+	cmd->execute = kc->execute;
+	Dispatcher.queue_command(ctx, cmd);
+	km->stats.matched++;
+}
+
+//	Key Table Interface =========================================================
+/* follows the chord in progress, or starts one from the focused then global roots */
+static int key_press(ui_context ctx, int key, uint32_t modifiers) {
+	if (!ctx) return 0;
+	keymap* km = &ctx->keys;
+	if (!km->binding_count || (km->dirty && Keymap.compile(ctx) != 0)) return 0;
+	km->stats.lookups++;
+
+	int child = 0;
+	if (km->node && !(child = find_edge(km, km->node, modifiers, key))) km->node = 0;		// broken: start over
+	if (!km->node) {
+		km->chord_scope = km->focus;
+		km->stats.pending = 0;
+		if (!(child = find_edge(km, km->focus_root, modifiers, key))) {
+			km->chord_scope = NULL;
+			child = find_edge(km, km->global_root, modifiers, key);
+		}
+		if (!child) return 0;
+	}
+
+	km->consumed[key >> 3] |= 1 << (key & 7);
+	if (km->accept[child]) {
+		km->node = 0;
+		km->stats.pending = 0;
+		run_command(ctx, km, km->accept[child], km->chord_scope);
+	} else {
+		km->node = child;
+		km->stats.pending++;
+	}
+
+	return 1;
+}
+static int key_up(ui_context ctx, int key) {
+	if (!ctx || !(ctx->keys.consumed[key >> 3] & 1 << (key & 7))) return 0;
+
+	ctx->keys.consumed[key >> 3] &= ~(1 << (key & 7));
+	return 1;
+}
+static void release_keys(ui_context ctx) {
+	if (!ctx) return;
+	keymap* km = &ctx->keys;
+
+	free_table(ctx, km);
+	for (int i = 0; i < km->command_count; ++i) {
+		if (km->commands[i].name) ui_free(ctx, km->commands[i].name, ALLOC_STRING);
+	}
+	if (km->commands) ui_free(ctx, km->commands, ALLOC_KEYMAP);
+	if (km->bindings) ui_free(ctx, km->bindings, ALLOC_KEYMAP);
+	memset(km, 0, sizeof(keymap));
+}
+
+//	Keymap Interface ============================================================
+static int add_command(ui_context ctx, const string name, void (*execute)(ui_context, ui_module)) {
+	if (!ctx || !name || !execute) return -1;
+	keymap* km = &ctx->keys;
+
+	if (km->command_count == km->command_capacity) {
+		int capacity = km->command_capacity ? km->command_capacity * 2 : 16;
+		key_command* commands = ui_grow(ctx, km->commands, sizeof(key_command) * km->command_count,
+												  sizeof(key_command) * capacity, ALLOC_KEYMAP);
+		if (!commands) return -1;
+		km->commands = commands;
+		km->command_capacity = capacity;
+	}
+	size_t length = strlen(name);
+	string copy = ui_alloc(ctx, length + 1, ALLOC_STRING);
+	if (!copy) return -1;
+	memcpy(copy, name, length + 1);
+	km->commands[km->command_count] = (key_command){ copy, execute };
+
+	return ++km->command_count;
+}
+static int bind_keys(ui_context ctx, ui_module scope, const key_stroke* strokes, int count, int id) {
+	if (!ctx || !strokes || count < 1 || count > KEY_CHORD_MAX) return -1;
+	keymap* km = &ctx->keys;
+	if (id < 1 || id > km->command_count) return -1;
+	for (int s = 0; s < count; ++s) {
+		if (strokes[s].key < 0 || strokes[s].key >= (int)sizeof(ctx->input_state.keys)) return -1;
+	}
+
+	int i = find_binding(km, scope, strokes, count);
+	if (i < 0 && prefix_conflict(km, scope, strokes, count)) return -1;
+	if (i < 0) {
+		if (km->binding_count == km->binding_capacity) {
+			int capacity = km->binding_capacity ? km->binding_capacity * 2 : 32;
+			key_binding* bindings = ui_grow(ctx, km->bindings, sizeof(key_binding) * km->binding_count,
+													  sizeof(key_binding) * capacity, ALLOC_KEYMAP);
+			if (!bindings) return -1;
+			km->bindings = bindings;
+			km->binding_capacity = capacity;
+		}
+		i = km->binding_count++;
+	}
+	key_binding* b = &km->bindings[i];
+	b->scope = scope;
+	b->count = count;
+	b->command = id;
+	for (int s = 0; s < count; ++s) b->strokes[s] = (key_stroke){ strokes[s].modifiers & KEY_MOD_ALL, strokes[s].key };
+	km->dirty = 1;
+	km->stats.bindings = km->binding_count;
+
+	return 0;
+}
+static int unbind_keys(ui_context ctx, ui_module scope, const key_stroke* strokes, int count) {
+	if (!ctx || !strokes) return -1;
+	keymap* km = &ctx->keys;
+
+	int i = find_binding(km, scope, strokes, count);
+	if (i < 0) return -1;
+	km->bindings[i] = km->bindings[--km->binding_count];
+	km->dirty = 1;
+	km->stats.bindings = km->binding_count;
+
+	return 0;
+}
+/* builds the trie: one root per scope, one node per distinct stroke prefix */
+static int compile_keys(ui_context ctx) {
+	if (!ctx) return -1;
+	keymap* km = &ctx->keys;
+
+	free_table(ctx, km);
+	km->node = 0;
+	km->stats.pending = 0;
+	km->dirty = 0;
+	if (!km->binding_count) return 0;
+
+	int strokes = 0;
+	for (int i = 0; i < km->binding_count; ++i) strokes += km->bindings[i].count;
+	int slots = 16;
+	while (slots < strokes * 2) slots *= 2;
+	km->edges = ui_alloc(ctx, sizeof(key_edge) * slots, ALLOC_KEYMAP);
+	km->scopes = ui_alloc(ctx, sizeof(ui_module) * km->binding_count, ALLOC_KEYMAP);
+	km->accept = ui_alloc(ctx, sizeof(int) * (km->binding_count + strokes + 1), ALLOC_KEYMAP);
+	if (!km->edges || !km->scopes || !km->accept) {
+		free_table(ctx, km);
+		km->dirty = 1;
+		return -1;
+	}
+	km->edge_mask = slots - 1;
+
+	//	roots first (nodes 1..scope_count), then the strokes
+	for (int i = 0; i < km->binding_count; ++i) {
+		if (!scope_root(km, km->bindings[i].scope)) km->scopes[km->scope_count++] = km->bindings[i].scope;
+	}
+	int nodes = km->scope_count;
+	uint64_t probes = km->stats.probes;		// counts lookups only
+	for (int i = 0; i < km->binding_count; ++i) {
+		key_binding* b = &km->bindings[i];
+		int node = scope_root(km, b->scope);
+		for (int s = 0; s < b->count; ++s) {
+			int child = find_edge(km, node, b->strokes[s].modifiers, b->strokes[s].key);
+			if (!child) {
+				child = ++nodes;
+				add_edge(km, node, b->strokes[s].modifiers, b->strokes[s].key, child);
+			}
+			node = child;
+		}
+		km->accept[node] = b->command;
+	}
+	km->stats.probes = probes;
+	km->global_root = scope_root(km, NULL);
+	km->focus_root = km->focus ? scope_root(km, km->focus) : 0;
+	km->stats.nodes = nodes;
+	km->stats.slots = slots;
+	DBLOG("<Keymap> compiled bindings=%d nodes=%d slots=%d", km->binding_count, nodes, slots);
+
+	return 0;
+}
+static void set_focus(ui_context ctx, ui_module m) {
+	if (!ctx || ctx->keys.focus == m) return;
+	keymap* km = &ctx->keys;
+
+	km->focus = m;
+	km->focus_root = m && !km->dirty ? scope_root(km, m) : 0;
+	km->node = 0;				// a chord does not survive a focus change
+	km->stats.pending = 0;
+}
+static ui_module focused_module(ui_context ctx) {
+	return ctx ? ctx->keys.focus : NULL;
+}
+static void keymap_statistics(ui_context ctx, keymap_stats* out) {
+	if (ctx && out) *out = ctx->keys.stats;
+}
+
+/* key table interface (internal) */
+const IKeyTable KeyTable = {
+	.press = key_press,
+	.up = key_up,
+	.release = release_keys
+};
+/* keymap interface */
+const IKeymap Keymap = {
+	.command = add_command,
+	.bind = bind_keys,
+	.unbind = unbind_keys,
+	.compile = compile_keys,
+	.focus = set_focus,
+	.focused = focused_module,
+	.stats = keymap_statistics
+};
@@ -0,0 +1,65 @@
+// layer.c
+/**
+ * @detail Offscreen layer options. These only update module state and damage
+ * 	what is on screen; render targets own the layer storage and decide when a
+ * 	layer has to be re-rendered (its draw list or size changed).
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+/* damages the module's on-screen rect */
+static void damage_bounds(ui_module m) {
+	if (m->ctx && m->win) Damage.add(&m->ctx->damage, ui_module_bounds(m));
+}
+
+/* renders a module into a layer */
+static void enable_layer(ui_module m, int width, int height) {
+	if (!m) return;
+	
+	m->layer.enabled = 1;
+	m->layer.width = width;
+	m->layer.height = height;
+	DBLOG("<Layer> module=%s enabled (%dx%d)", m->name, width, height);
+	damage_bounds(m);
+}
+/* draws a module directly again */
+static void disable_layer(ui_module m) {
+	if (!m || !m->layer.enabled) return;
+	
+	damage_bounds(m);
+	m->layer.enabled = 0;
+	damage_bounds(m);
+}
+/* scrolls the layer content (re-composited, not re-rendered) */
+static void scroll_layer(ui_module m, int x, int y) {
+	if (!m || (m->layer.scroll_x == x && m->layer.scroll_y == y)) return;
+	
+	m->layer.scroll_x = x;
+	m->layer.scroll_y = y;
+	if (m->layer.enabled) damage_bounds(m);
+}
+/* offsets the composited layer from the window (the renderer damages old/new rects) */
+static void translate_layer(ui_module m, int dx, int dy) {
+	if (!m) return;
+	
+	m->layer.dx = dx;
+	m->layer.dy = dy;
+}
+/* sets the composite opacity */
+static void layer_opacity(ui_module m, uint8_t opacity) {
+	if (!m || m->layer.opacity == opacity) return;
+	
+	m->layer.opacity = opacity;
+	if (m->layer.enabled) damage_bounds(m);
+}
+
+/* layer interface */
+const ILayer Layer = {
+	.enable = enable_layer,
+	.disable = disable_layer,
+	.scroll = scroll_layer,
+	.translate = translate_layer,
+	.opacity = layer_opacity
+};
@@ -0,0 +1,414 @@
+// layout.c
+/**
+ * @detail Text layout cache. Render callbacks re-submit the same strings every
+ * 	frame; a layout (shaped glyph pen positions + line breaks) is looked up by
+ * 	(text hash, font, bytes, wrap width) and verified against a copy of the text.
+ * 	Entry arrays are bump allocated from an arena that is compacted into a spare
+ * 	arena when unused entries are swept, so steady frames do not allocate.
+ * 	When only the wrap width changes, the glyphs of a cached layout of the same
+ * 	text are re-broken: a cached line is kept while it starts where the new line
+ * 	starts and its break decision holds at the new width (every extent it checked
+ * 	fits and the extent that forced its break still does not).
+ * 	A context renders on one thread at a time, so the cache takes no locks.
+ */
+
+#include <limits.h>
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+#define TEXT_SPACE 1						/* glyph is a break opportunity (consumed by the break) */
+#define TEXT_NEWLINE 2						/* glyph ends its line */
+
+//	Helper Functions ============================================================
+static unsigned slot_of(uint64_t key, int capacity) {
+	return ui_fib_slot(key, __builtin_ctz((unsigned)capacity));
+}
+static uint64_t run_key(uint64_t hash, int font, int length) {
+	return hash ^ ((uint64_t)(uint32_t)font << 32 | (uint32_t)length) * 0xC2B2AE3D27D4EB4Full;
+}
+static uint64_t entry_key(const text_entry* e) {
+	return run_key(e->hash, e->font, e->length) ^ (uint64_t)(uint32_t)e->wrap * 0x165667B19E3779F9ull;
+}
+static int same_text(const text_cache* tc, const text_entry* e, uint64_t hash, int font, const char* text, int length) {
+	return e->hash == hash && e->font == font && e->length == length &&
+			 memcmp(tc->arena + e->text, text, length) == 0;
+}
+/* adds an entry to both indexes (a run slot keeps the newest entry of its text) */
+static void index_entry(text_cache* tc, int i) {
+	const text_entry* e = &tc->entries[i];
+	unsigned mask = tc->index_capacity - 1;
+
+	unsigned s = slot_of(entry_key(e), tc->index_capacity);
+	while (tc->index[s]) s = (s + 1) & mask;
+	tc->index[s] = i + 1;
+
+	s = slot_of(run_key(e->hash, e->font, e->length), tc->index_capacity);
+	while (tc->runs[s]) {
+		const text_entry* o = &tc->entries[tc->runs[s] - 1];
+		if (o->hash == e->hash && o->font == e->font && o->length == e->length) break;
+		s = (s + 1) & mask;
+	}
+	tc->runs[s] = i + 1;
+}
+/* rebuilds both indexes at a capacity (a power of two) */
+static int rebuild_index(ui_context ctx, text_cache* tc, int capacity) {
+	if (capacity != tc->index_capacity) {
+		int* index = ui_alloc(ctx, sizeof(int) * capacity, ALLOC_TEXT);
+		int* runs = ui_alloc(ctx, sizeof(int) * capacity, ALLOC_TEXT);
+		if (!index || !runs) {
+			if (index) ui_free(ctx, index, ALLOC_TEXT);
+			if (runs) ui_free(ctx, runs, ALLOC_TEXT);
+			return -1;
+		}
+		if (tc->index) ui_free(ctx, tc->index, ALLOC_TEXT);
+		if (tc->runs) ui_free(ctx, tc->runs, ALLOC_TEXT);
+		tc->index = index;
+		tc->runs = runs;
+		tc->index_capacity = capacity;
+	} else {
+		memset(tc->index, 0, sizeof(int) * capacity);
+		memset(tc->runs, 0, sizeof(int) * capacity);
+	}
+
+	for (int i = 0; i < tc->count; ++i) index_entry(tc, i);
+
+	return 0;
+}
+/* entry for the full key (-1=miss) */
+static int find_layout(const text_cache* tc, uint64_t hash, int font, const char* text, int length, int wrap) {
+	if (!tc->index) return -1;
+
+	text_entry probe = { .hash = hash, .font = font, .length = length, .wrap = wrap };
+	unsigned s = slot_of(entry_key(&probe), tc->index_capacity);
+	while (tc->index[s]) {
+		const text_entry* e = &tc->entries[tc->index[s] - 1];
+		if (e->wrap == wrap && same_text(tc, e, hash, font, text, length)) return tc->index[s] - 1;
+		s = (s + 1) & (tc->index_capacity - 1);
+	}
+
+	return -1;
+}
+/* newest entry of the same text at any wrap width (-1=none) */
+static int find_run(const text_cache* tc, uint64_t hash, int font, const char* text, int length) {
+	if (!tc->runs) return -1;
+
+	unsigned s = slot_of(run_key(hash, font, length), tc->index_capacity);
+	while (tc->runs[s]) {
+		const text_entry* e = &tc->entries[tc->runs[s] - 1];
+		if (same_text(tc, e, hash, font, text, length)) return tc->runs[s] - 1;
+		s = (s + 1) & (tc->index_capacity - 1);
+	}
+
+	return -1;
+}
+/* grows a scratch array to hold n items (contents kept); 0 on success */
+static int reserve(ui_context ctx, void** items, int* capacity, int n, size_t size) {
+	if (n <= *capacity) return 0;
+
+	int grown = *capacity ? *capacity : 64;
+	while (grown < n) grown *= 2;
+	void* p = ui_grow(ctx, *items, size * *capacity, size * grown, ALLOC_TEXT);
+	if (!p) return -1;
+	*items = p;
+	*capacity = grown;
+
+	return 0;
+}
+/* bump allocates arena bytes (8-byte aligned); offset or UINT32_MAX */
+static uint32_t arena_take(ui_context ctx, text_cache* tc, size_t size) {
+	size = (size + 7) & ~(size_t)7;
+	if (tc->used + size > tc->arena_capacity) {
+		size_t capacity = tc->arena_capacity ? tc->arena_capacity : 16384;
+		while (capacity < tc->used + size) capacity *= 2;
+		if (capacity > UINT32_MAX) return UINT32_MAX;
+		uint8_t* arena = ui_grow(ctx, tc->arena, tc->used, capacity, ALLOC_TEXT);
+		if (!arena) return UINT32_MAX;
+		tc->arena = arena;
+		tc->arena_capacity = capacity;
+		if (tc->spare) {			// reallocated at the size of the arena by the next sweep
+			ui_free(ctx, tc->spare, ALLOC_TEXT);
+			tc->spare = NULL;
+		}
+	}
+
+	uint32_t offset = (uint32_t)tc->used;
+	tc->used += size;
+
+	return offset;
+}
+/* decodes and measures a text run into the shaping scratch; glyph count or -1 */
+static int shape_text(ui_context ctx, text_cache* tc, ui_font font, const char* text, int length) {
+	if (reserve(ctx, (void**)&tc->scratch_glyphs, &tc->scratch_glyph_capacity, length, sizeof(text_glyph)) != 0) return -1;
+
+	const char* p = text;
+	const char* end = text + length;
+	int n = 0, pen = 0;
+	while (p < end) {
+		text_glyph* g = &tc->scratch_glyphs[n++];
+		g->offset = (uint32_t)(p - text);
+		uint32_t cp = ui_utf8_next(&p, end);
+		g->pen = pen;
+		g->flags = cp == '\n' ? TEXT_NEWLINE : cp == ' ' || cp == '\t' ? TEXT_SPACE : 0;
+		g->advance = cp == '\n' ? 0 : Glyphs.advance(font, cp);
+		pen += g->advance;
+	}
+
+	return n;
+}
+/* greedy line break from glyph `start` (wrap <= 0: only at '\n') */
+static void break_line(const text_glyph* g, int n, int length, int start, int wrap, text_line* line) {
+	int x0 = start < n ? g[start].pen : 0;
+	int space = -1, end = n, ink = 0;
+	memset(line, 0, sizeof(text_line));
+	line->next = n;
+	line->overflow = INT_MAX;
+
+	for (int j = start; j < n; ++j) {
+		if (g[j].flags & TEXT_NEWLINE) {
+			end = j;
+			line->next = j + 1;
+			line->newline = 1;
+			break;
+		}
+		if (g[j].flags & TEXT_SPACE) {
+			if (ink) space = j;
+			continue;
+		}
+		int extent = g[j].pen + g[j].advance - x0;
+		if (wrap > 0 && extent > wrap && ink) {
+			line->overflow = extent;
+			end = space >= 0 ? space : j;
+			int next = end;
+			while (next < n && (g[next].flags & TEXT_SPACE)) ++next;
+			line->next = next;
+			break;
+		}
+		line->scan = extent;
+		ink = 1;
+	}
+
+	int last = end;
+	while (last > start && (g[last - 1].flags & TEXT_SPACE)) --last;
+	line->first = start;
+	line->count = last - start;
+	line->width = last > start ? g[last - 1].pen + g[last - 1].advance - x0 : 0;
+	line->start = start < n ? (int)g[start].offset : length;
+	line->bytes = (last < n ? (int)g[last].offset : length) - line->start;
+}
+/* a cached line breaks the same way at `wrap` */
+static int line_holds(const text_line* line, int wrap) {
+	if (wrap <= 0) return line->overflow == INT_MAX;
+
+	return line->scan <= wrap && wrap < line->overflow;
+}
+/*
+ *	Breaks glyphs into the line scratch, keeping the lines of `old` (a layout of
+ *	the same glyphs at another width) that still hold; line count or -1
+ */
+static int wrap_lines(ui_context ctx, text_cache* tc, const text_glyph* g, int n, int length, int wrap,
+							 const text_line* old, int old_count, uint64_t* reused) {
+	int count = 0, start = 0, k = 0;
+	for (;;) {
+		if (reserve(ctx, (void**)&tc->scratch_lines, &tc->scratch_line_capacity, count + 1, sizeof(text_line)) != 0) return -1;
+		text_line* line = &tc->scratch_lines[count++];
+
+		while (k < old_count && old[k].first < start) ++k;
+		if (k < old_count && old[k].first == start && line_holds(&old[k], wrap)) {
+			*line = old[k];
+			(*reused)++;
+		} else {
+			break_line(g, n, length, start, wrap, line);
+		}
+
+		//	a trailing '\n' opens one last (empty) line
+		if (line->next >= n && !line->newline) break;
+		start = line->next;
+	}
+
+	return count;
+}
+/* drops entries unused for `keep` generations and compacts the arena */
+static void sweep(ui_context ctx, text_cache* tc) {
+	int keep = tc->keep > 0 ? tc->keep : TEXT_KEEP_FRAMES;
+	tc->swept = tc->generation;
+
+	int live = 0;
+	for (int i = 0; i < tc->count; ++i) live += tc->generation - tc->entries[i].used <= (uint64_t)keep;
+	if (live == tc->count) return;
+
+	if (!tc->spare) {
+		tc->spare = ui_alloc(ctx, tc->arena_capacity, ALLOC_TEXT);
+		if (!tc->spare) return;
+	}
+	size_t used = 0;
+	int count = 0;
+	for (int i = 0; i < tc->count; ++i) {
+		text_entry e = tc->entries[i];
+		if (tc->generation - e.used > (uint64_t)keep) {
+			tc->stats.evictions++;
+			continue;
+		}
+		size_t text = (e.length + 7) & ~(size_t)7;
+		size_t glyphs = (sizeof(text_glyph) * e.glyph_count + 7) & ~(size_t)7;
+		size_t lines = sizeof(text_line) * e.line_count;
+		memcpy(tc->spare + used, tc->arena + e.text, text + glyphs + lines);
+		e.glyphs = (uint32_t)used + (e.glyphs - e.text);
+		e.lines = (uint32_t)used + (e.lines - e.text);
+		e.text = (uint32_t)used;
+		used += (text + glyphs + lines + 7) & ~(size_t)7;
+		tc->entries[count++] = e;
+	}
+	DBLOG("<Text> swept %d of %d layouts (%zu -> %zu bytes)", tc->count - count, tc->count, tc->used, used);
+
+	uint8_t* arena = tc->arena;
+	tc->arena = tc->spare;
+	tc->spare = arena;
+	tc->used = used;
+	tc->count = count;
+	rebuild_index(ctx, tc, tc->index_capacity);
+}
+static void resolve(const text_cache* tc, const text_entry* e, int line_height, text_layout* out) {
+	out->text = (const char*)tc->arena + e->text;
+	out->glyphs = (const text_glyph*)(tc->arena + e->glyphs);
+	out->lines = (const text_line*)(tc->arena + e->lines);
+	out->glyph_count = e->glyph_count;
+	out->line_count = e->line_count;
+	out->width = e->width;
+	out->line_height = line_height;
+	out->height = e->line_count * line_height;
+}
+
+/* cached layout of a text run; a miss shapes it (or rewraps a cached layout of it) */
+static int text_layout_of(ui_context ctx, ui_font font, const char* text, int length, int wrap, text_layout* out) {
+	if (!ctx || !text || !out) return -1;
+	int line_height = Glyphs.height(font);
+	if (!line_height) return -1;
+	text_cache* tc = &ctx->text;
+	if (length < 0) length = (int)strlen(text);
+	if (wrap < 0) wrap = 0;
+
+	uint64_t hash = ui_fnv1a(UI_FNV_OFFSET, text, (size_t)length);
+	int hit = find_layout(tc, hash, font, text, length, wrap);
+	if (hit >= 0) {
+		tc->entries[hit].used = tc->generation;
+		tc->stats.hits++;
+		resolve(tc, &tc->entries[hit], line_height, out);
+		return 0;
+	}
+
+	//	glyphs: from a layout of the same text, or shaped
+	int run = find_run(tc, hash, font, text, length);
+	const text_glyph* glyphs;
+	int n, lines;
+	if (run >= 0) {
+		const text_entry* r = &tc->entries[run];
+		glyphs = (const text_glyph*)(tc->arena + r->glyphs);
+		n = r->glyph_count;
+		lines = wrap_lines(ctx, tc, glyphs, n, length, wrap, (const text_line*)(tc->arena + r->lines),
+								 r->line_count, &tc->stats.lines_reused);
+		tc->stats.rewraps++;
+	} else {
+		n = shape_text(ctx, tc, font, text, length);
+		if (n < 0) return -1;
+		glyphs = tc->scratch_glyphs;
+		lines = wrap_lines(ctx, tc, glyphs, n, length, wrap, NULL, 0, &tc->stats.lines_reused);
+		tc->stats.misses++;
+	}
+	if (lines < 0) return -1;
+
+	//	one arena block: text, glyphs, lines
+	if (tc->count == tc->capacity) {
+		int capacity = tc->capacity ? tc->capacity * 2 : 64;
+		text_entry* entries = ui_grow(ctx, tc->entries, sizeof(text_entry) * tc->count, sizeof(text_entry) * capacity, ALLOC_TEXT);
+		if (!entries) return -1;
+		tc->entries = entries;
+		tc->capacity = capacity;
+	}
+	if ((tc->count + 1) * 2 > tc->index_capacity &&
+		 rebuild_index(ctx, tc, tc->index_capacity ? tc->index_capacity * 2 : 128) != 0) return -1;
+	size_t text_size = (length + 7) & ~(size_t)7;
+	size_t glyph_size = (sizeof(text_glyph) * n + 7) & ~(size_t)7;
+	uint32_t base = arena_take(ctx, tc, text_size + glyph_size + sizeof(text_line) * lines);
+	if (base == UINT32_MAX) return -1;
+	if (run >= 0) glyphs = (const text_glyph*)(tc->arena + tc->entries[run].glyphs);	// the arena may have moved
+
+	text_entry* e = &tc->entries[tc->count];
+	memset(e, 0, sizeof(text_entry));
+	e->hash = hash;
+	e->font = font;
+	e->length = length;
+	e->wrap = wrap;
+	e->text = base;
+	e->glyphs = base + (uint32_t)text_size;
+	e->lines = e->glyphs + (uint32_t)glyph_size;
+	e->glyph_count = n;
+	e->line_count = lines;
+	e->used = tc->generation;
+	memcpy(tc->arena + e->text, text, length);
+	memcpy(tc->arena + e->glyphs, glyphs, sizeof(text_glyph) * n);
+	memcpy(tc->arena + e->lines, tc->scratch_lines, sizeof(text_line) * lines);
+	for (int i = 0; i < lines; ++i) {
+		if (tc->scratch_lines[i].width > e->width) e->width = tc->scratch_lines[i].width;
+	}
+	index_entry(tc, tc->count++);
+
+	resolve(tc, e, line_height, out);
+	return 0;
+}
+/* advances the generation; sweeps every `keep` frames */
+static void end_frame(ui_context ctx) {
+	if (!ctx) return;
+	text_cache* tc = &ctx->text;
+
+	tc->generation++;
+	int keep = tc->keep > 0 ? tc->keep : TEXT_KEEP_FRAMES;
+	if (tc->count && tc->generation - tc->swept >= (uint64_t)keep) sweep(ctx, tc);
+}
+/* frees every layout and the cache storage */
+static void release_cache(ui_context ctx) {
+	if (!ctx) return;
+	text_cache* tc = &ctx->text;
+
+	if (tc->entries) ui_free(ctx, tc->entries, ALLOC_TEXT);
+	if (tc->index) ui_free(ctx, tc->index, ALLOC_TEXT);
+	if (tc->runs) ui_free(ctx, tc->runs, ALLOC_TEXT);
+	if (tc->arena) ui_free(ctx, tc->arena, ALLOC_TEXT);
+	if (tc->spare) ui_free(ctx, tc->spare, ALLOC_TEXT);
+	if (tc->scratch_glyphs) ui_free(ctx, tc->scratch_glyphs, ALLOC_TEXT);
+	if (tc->scratch_lines) ui_free(ctx, tc->scratch_lines, ALLOC_TEXT);
+	memset(tc, 0, sizeof(text_cache));
+}
+/* wrapped text extent */
+static int measure_text(ui_context ctx, ui_font font, const char* text, int wrap, int* width, int* height) {
+	text_layout layout;
+	if (text_layout_of(ctx, font, text, -1, wrap, &layout) != 0) return -1;
+	if (width) *width = layout.width;
+	if (height) *height = layout.height;
+
+	return 0;
+}
+/* sets the frames an unused layout stays cached */
+static void keep_frames(ui_context ctx, int frames) {
+	if (ctx) ctx->text.keep = frames;
+}
+/* copies the cache statistics */
+static void text_statistics(ui_context ctx, text_stats* out) {
+	if (!ctx || !out) return;
+
+	*out = ctx->text.stats;
+	out->entries = ctx->text.count;
+	out->bytes = ctx->text.used;
+}
+
+/* text layout cache interface (internal) */
+const ITextCache TextCache = {
+	.layout = text_layout_of,
+	.end_frame = end_frame,
+	.release = release_cache
+};
+/* text interface */
+const IText Text = {
+	.measure = measure_text,
+	.keep = keep_frames,
+	.stats = text_statistics
+};
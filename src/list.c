@@ -0,0 +1,270 @@
+// list.c
+/**
+ * @detail Virtualized lists. A list is an ordinary module whose callback walks
+ * 	only the rows crossing its window (plus overscan): the top row comes from
+ * 	the extent index in O(log n) and the rest follow by adding row heights.
+ * 	Row texts are kept in a direct-mapped row cache (slot = row & mask) that
+ * 	outlives frames, so a scroll only asks the source for the rows it brings
+ * 	in; the text layouts of cached rows are in turn memoized by the context's
+ * 	text cache. The state hangs off the module and is freed with it.
+ */
+
+#include "ui_core.h"
+#include "sigui_widgets.h"
+#include "sigui_debug.h"
+
+#define LIST_TEXT_MAX 128						/* cached bytes of a row's text */
+#define LIST_OVERSCAN 4							/* default rows past each window edge */
+#define LIST_PAD 4								/* text inset from the left edge */
+
+/* cached row */
+typedef struct list_row_s {
+	int row;										/* row index (-1: empty slot) */
+	int bytes;									/* text bytes (-1: blank row) */
+	char text[LIST_TEXT_MAX];
+} list_row;
+/* list state (module widget) */
+struct ui_listview_s {
+	ui_module module;
+	listview_source source;
+	extent_index rows;						/* row heights */
+	int64_t offset;							/* content offset at the top of the window */
+	int overscan;
+	ui_font font;
+	uint32_t color, background, stripe;
+	list_row* cache;							/* direct-mapped row cache */
+	int cache_capacity;						/* slots (power of two) */
+	listview_stats stats;
+};
+
+//	Helper Functions ============================================================
+static inline int window_height(ui_listview l) {
+	return l->module->win ? l->module->win->height : 0;
+}
+/* keeps the offset inside [0, content - window] */
+static void clamp_offset(ui_listview l) {
+	int64_t max = Extent.total(&l->rows) - window_height(l);
+	if (l->offset > max) l->offset = max;
+	if (l->offset < 0) l->offset = 0;
+}
+/* empties the row cache (slots are kept) */
+static void clear_cache(ui_listview l) {
+	for (int i = 0; i < l->cache_capacity; ++i) l->cache[i].row = -1;
+}
+/* grows the row cache to hold `rows` rows twice over; cached rows move along */
+static void reserve_cache(ui_listview l, int rows) {
+	if (rows * 2 <= l->cache_capacity) return;
+
+	int capacity = l->cache_capacity ? l->cache_capacity : 32;
+	while (capacity < rows * 2) capacity *= 2;
+	list_row* cache = ui_alloc(l->module->ctx, sizeof(list_row) * capacity, ALLOC_WIDGET);
+	if (!cache) return;
+	for (int i = 0; i < capacity; ++i) cache[i].row = -1;
+	for (int i = 0; i < l->cache_capacity; ++i) {
+		if (l->cache[i].row >= 0) cache[l->cache[i].row & (capacity - 1)] = l->cache[i];
+	}
+	if (l->cache) ui_free(l->module->ctx, l->cache, ALLOC_WIDGET);
+	l->cache = cache;
+	l->cache_capacity = capacity;
+}
+/* a row's cached text; asks the source on a miss */
+static list_row* fetch_row(ui_listview l, int row) {
+	list_row* r = &l->cache[row & (l->cache_capacity - 1)];
+	if (r->row == row) {
+		l->stats.reused++;
+		return r;
+	}
+
+	r->row = row;
+	r->bytes = l->source.text ? l->source.text(l->source.data, row, r->text, LIST_TEXT_MAX) : -1;
+	if (r->bytes >= LIST_TEXT_MAX) r->bytes = LIST_TEXT_MAX - 1;
+	if (r->bytes >= 0) r->text[r->bytes] = '\0';
+	l->stats.fetched++;
+
+	return r;
+}
+/* asks the source for the heights of the rows near the window that were never measured;
+	the top row keeps its place on screen when rows above it change height */
+static void measure_rows(ui_listview l, int height) {
+	if (!l->source.height || !l->rows.count) return;
+	ui_context ctx = l->module->ctx;
+
+	int top = Extent.index(&l->rows, l->offset);
+	int64_t into = l->offset - Extent.offset(&l->rows, top);
+	int row = top - l->overscan > 0 ? top - l->overscan : 0;
+	int64_t y = Extent.offset(&l->rows, row) - l->offset;
+	int after = l->overscan;
+	for (; row < l->rows.count && (y < height || after-- > 0); ++row) {
+		if (!Extent.measured(&l->rows, row)) Extent.set(ctx, &l->rows, row, l->source.height(l->source.data, row));
+		if (row == top) y = -into;			// rows above the top may have moved it
+		y += Extent.size(&l->rows, row);
+	}
+
+	l->offset = Extent.offset(&l->rows, top) + into;
+	clamp_offset(l);
+}
+
+//	Render Callback =============================================================
+/* records the rows crossing the window plus overscan */
+static void render_list(ui_context ctx, ui_module m, ui_input* input) {
+	ui_listview l = m->widget;
+	if (!l || !m->win) return;
+	int width = m->win->width, height = m->win->height;
+
+	if (l->background >> 24) Draw.rect(ctx, 0, 0, width, height, l->background);
+	measure_rows(l, height);
+	clamp_offset(l);
+
+	int top = Extent.index(&l->rows, l->offset);
+	int first = top - l->overscan > 0 ? top - l->overscan : 0;
+	int64_t y = Extent.offset(&l->rows, first) - l->offset;
+	int last = first;
+	for (int after = l->overscan; last < l->rows.count && (y < height || after-- > 0); ++last) {
+		y += Extent.size(&l->rows, last);
+	}
+	reserve_cache(l, last - first);
+	if (!l->cache) return;
+
+	int line = Font.height(l->font);
+	y = Extent.offset(&l->rows, first) - l->offset;
+	for (int row = first; row < last; ++row) {
+		int h = Extent.size(&l->rows, row);
+		ui_rect rect = { 0, (int)y, width, h };
+		if ((row & 1) && (l->stripe >> 24)) Draw.rect(ctx, rect.x, rect.y, rect.width, rect.height, l->stripe);
+		if (l->source.draw) l->source.draw(ctx, l->source.data, row, rect);
+		else {
+			list_row* r = fetch_row(l, row);
+			if (r->bytes > 0) Draw.text(ctx, LIST_PAD, rect.y + (h - line) / 2, l->font, r->text, l->color);
+		}
+		y += h;
+	}
+
+	l->stats.first = first;
+	l->stats.last = last;
+	l->stats.drawn = last - first;
+}
+/* frees the list with its module */
+static void release_list(ui_module m) {
+	ui_listview l = m->widget;
+	if (!l) return;
+
+	Extent.release(m->ctx, &l->rows);
+	if (l->cache) ui_free(m->ctx, l->cache, ALLOC_WIDGET);
+	ui_free(m->ctx, l, ALLOC_WIDGET);
+	m->widget = NULL;
+}
+
+//	List Interface ==============================================================
+static ui_listview new_list(ui_context ctx, string name, window win, const listview_source* source, int rows, int row_height) {
+	if (!ctx || !source) return NULL;
+
+	ui_listview l = ui_alloc(ctx, sizeof(struct ui_listview_s), ALLOC_WIDGET);
+	if (!l) return NULL;
+	ui_module m = Sigui.add_module(ctx, name, render_list, NULL, win);
+	if (!m) {
+		ui_free(ctx, l, ALLOC_WIDGET);
+		return NULL;
+	}
+	DBLOG("<List> new list=%s rows=%d", name, rows);
+
+	l->module = m;
+	l->source = *source;
+	Extent.init(&l->rows, rows, row_height);
+	l->overscan = LIST_OVERSCAN;
+	l->font = UI_FONT_DEFAULT;
+	l->color = UI_RGB(0, 0, 0);
+	l->background = UI_RGB(255, 255, 255);
+	l->stripe = UI_RGB(242, 242, 242);
+	m->widget = l;
+	m->release = release_list;
+
+	return l;
+}
+static ui_module list_module(ui_listview l) {
+	return l ? l->module : NULL;
+}
+static void refresh_list(ui_listview l, int rows) {
+	if (!l) return;
+
+	Extent.release(l->module->ctx, &l->rows);
+	Extent.init(&l->rows, rows, l->rows.size);
+	clear_cache(l);
+	clamp_offset(l);
+}
+static void update_row(ui_listview l, int row) {
+	if (!l || row < 0 || row >= l->rows.count) return;
+
+	if (l->cache_capacity && l->cache[row & (l->cache_capacity - 1)].row == row) {
+		l->cache[row & (l->cache_capacity - 1)].row = -1;
+	}
+	if (l->source.height) Extent.set(l->module->ctx, &l->rows, row, l->source.height(l->source.data, row));
+}
+static void set_overscan(ui_listview l, int rows) {
+	if (l) l->overscan = rows > 0 ? rows : 0;
+}
+static void set_style(ui_listview l, ui_font font, uint32_t color, uint32_t background, uint32_t stripe) {
+	if (!l) return;
+
+	l->font = font;
+	l->color = color;
+	l->background = background;
+	l->stripe = stripe;
+}
+static void scroll_to(ui_listview l, int64_t offset) {
+	if (!l) return;
+
+	l->offset = offset;
+	clamp_offset(l);
+}
+static void scroll_by(ui_listview l, int64_t delta) {
+	if (l) scroll_to(l, l->offset + delta);
+}
+static void scroll_to_row(ui_listview l, int row) {
+	if (l) scroll_to(l, Extent.offset(&l->rows, row));
+}
+static int64_t list_offset(ui_listview l) {
+	return l ? l->offset : 0;
+}
+/* O(log n) hit test */
+static int row_at(ui_listview l, int y) {
+	if (!l || y < 0 || y >= window_height(l)) return -1;
+
+	int64_t offset = l->offset + y;
+	if (offset >= Extent.total(&l->rows)) return -1;
+
+	return Extent.index(&l->rows, offset);
+}
+static int64_t row_offset(ui_listview l, int row) {
+	return l ? Extent.offset(&l->rows, row) : 0;
+}
+static int64_t content_height(ui_listview l) {
+	return l ? Extent.total(&l->rows) : 0;
+}
+static int row_count(ui_listview l) {
+	return l ? l->rows.count : 0;
+}
+static void list_statistics(ui_listview l, listview_stats* out) {
+	if (!l || !out) return;
+
+	*out = l->stats;
+	out->measured = l->rows.measured;
+}
+
+/* global list view interface */
+const IListView ListView = {
+	.new = new_list,
+	.module = list_module,
+	.refresh = refresh_list,
+	.update = update_row,
+	.overscan = set_overscan,
+	.style = set_style,
+	.scroll_to = scroll_to,
+	.scroll_by = scroll_by,
+	.scroll_to_row = scroll_to_row,
+	.offset = list_offset,
+	.row_at = row_at,
+	.row_offset = row_offset,
+	.height = content_height,
+	.rows = row_count,
+	.stats = list_statistics
+};
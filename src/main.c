@@ -20,13 +20,18 @@ int main(void) {
 	}
 	
 	app_state state = {100};
-	ui_context ctx = Sigui.new_context(&state);
+	ui_context ctx = Sigui.new_context(&state, NULL);
 	if (!ctx) return -1;
 
-	window win = Sigui.new_window(50, 50, 300, 400);
+	window win = Sigui.new_window(ctx, 50, 50, 300, 400);
 	ui_module m = Sigui.add_module(ctx, "MainWindow", render_window, handle_window_event, win);
 	printf("[Main] module=%s\n", m->name);
 	
+	//	shortcuts: looked up by the context, not by each handler
+	key_stroke space = { KEY_MOD_NONE, ' ' };
+	Keymap.bind(ctx, m, &space, 1, Keymap.command(ctx, "toggle_state", execute_toggle_state));
+	Keymap.focus(ctx, m);
+	
 	//	main loop
 	int running = 1;
 	while (running) {
@@ -59,22 +64,13 @@ static void handle_window_event(ui_context ctx, ui_module module, event_info ei)
 	
 	if (e->type == EVENT_MOUSE_PRESS) {
 		printf("    <window_module> Mouse pressed at (%d, %d)\n", e->data.mouse.x, e->data.mouse.y);
-		command cmd = Sigui.new_command("show_message");
+		command cmd = Sigui.new_command(ctx, "show_message");
 		if (cmd) {
 			cmd->target = module; 									// the target module
 			cmd->execute = execute_show_message;
 			
 			Dispatcher.queue_command(ctx, cmd);
 		}
-	} else if (e->type == EVENT_KEY_PRESS && e->data.key.key_code == ' ') {
-	  printf("    <window_module> Space key pressed\n");
-	  command cmd = Sigui.new_command("toggle_state");
-	  if (cmd) {
-			cmd->target = module; 									// the target module
-			cmd->execute = execute_toggle_state;
-
-			Dispatcher.queue_command(ctx, cmd);
-	  }
 	}
 }
 static void execute_show_message(ui_context ctx, ui_module m) {
@@ -0,0 +1,165 @@
+// pace.c
+/**
+ * @detail Module update rates, time budgets and the watchdog. The clock is
+ * 	read once per frame for rates and around each callback for timings. A rate
+ * 	keeps a due time that advances by whole periods, so a 10 Hz module runs ten
+ * 	times a second whatever the frame rate (it never runs twice in a frame and
+ * 	does not drift). The watchdog keeps a throttle level per module: at level L
+ * 	the module runs every 2^L frames and may spend its budget times 2^L when it
+ * 	does. Strikes raise the level; runs that would fit the level below lower it.
+ */
+
+#include <time.h>
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+static uint64_t monotonic(object data) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+static inline int strikes_of(const pacer* p) {
+	return p->strikes > 0 ? p->strikes : PACE_STRIKES;
+}
+/* moves the throttle level after a run that cost `cost` */
+static void watch(ui_context ctx, ui_module m, uint64_t cost) {
+	pace_state* p = &m->pace;
+	pacer* c = &ctx->pacer;
+	if (!p->budget) return;
+
+	if (cost > p->budget << m->stats.throttle) {
+		m->stats.over_budget++;
+		p->calm = 0;
+		if (c->mode == WATCHDOG_OFF || ++p->strikes < strikes_of(c)) return;
+		p->strikes = 0;
+		if (!m->stats.flagged) {
+			DBLOG("<Pace> module=%s over budget (%llu ns)", m->name, (unsigned long long)cost);
+		}
+		m->stats.flagged = 1;
+		if (c->mode == WATCHDOG_THROTTLE && m->stats.throttle < PACE_MAX_THROTTLE) m->stats.throttle++;
+		return;
+	}
+	p->strikes = 0;
+	if (!m->stats.flagged) return;
+
+	//	step down once it would fit the level below; unflag at level 0
+	int level = m->stats.throttle;
+	if (level && cost > p->budget << (level - 1)) {
+		p->calm = 0;
+		return;
+	}
+	if (++p->calm < strikes_of(c)) return;
+	p->calm = 0;
+	if (level) m->stats.throttle--;
+	else m->stats.flagged = 0;
+}
+
+//	Pacer (internal) ============================================================
+static uint64_t clock_now(ui_context ctx) {
+	return ctx->pacer.clock ? ctx->pacer.clock(ctx->pacer.clock_data) : monotonic(NULL);
+}
+static void begin_pace_frame(ui_context ctx) {
+	ctx->pacer.now = clock_now(ctx);
+}
+static pace_result module_due(ui_context ctx, ui_module m) {
+	pace_state* p = &m->pace;
+	if (p->wait > 0) {
+		p->wait--;
+		return PACE_THROTTLE;
+	}
+	if (p->period && ctx->pacer.now < p->due) return PACE_RATE;
+
+	return PACE_RUN;
+}
+static uint64_t module_ran(ui_context ctx, ui_module m, uint64_t ns) {
+	pace_state* p = &m->pace;
+	uint64_t cost = ns + p->pending;
+	p->pending = 0;
+	m->stats.render_ns += ns;
+	m->stats.last_ns = cost > UINT32_MAX ? UINT32_MAX : (uint32_t)cost;
+	if (m->stats.last_ns > m->stats.worst_ns) m->stats.worst_ns = m->stats.last_ns;
+
+	//	next due time: whole periods, restarting when a run was missed
+	uint64_t now = ctx->pacer.now;
+	if (p->period) {
+		p->due += p->period;
+		if (p->due <= now) p->due = now + p->period;
+	}
+	watch(ctx, m, cost);
+	p->wait = (1 << m->stats.throttle) - 1;
+
+	return cost;
+}
+static void charge_module(ui_module m, uint64_t ns) {
+	m->pace.pending += ns;
+	m->stats.handler_ns += ns;
+}
+
+//	Budget Interface ============================================================
+static void set_rate(ui_module m, double hz) {
+	if (!m) return;
+
+	m->pace.period = hz > 0 ? (uint64_t)(1e9 / hz) : 0;
+	m->pace.due = 0;		// due on the next frame
+}
+static void set_budget(ui_module m, int usec) {
+	if (!m) return;
+
+	m->pace.budget = usec > 0 ? (uint64_t)usec * 1000 : 0;
+	m->pace.strikes = m->pace.calm = m->pace.wait = 0;
+	m->stats.throttle = 0;
+	m->stats.flagged = 0;
+}
+static void set_watchdog(ui_context ctx, watchdog_mode mode, int strikes) {
+	if (!ctx) return;
+
+	ctx->pacer.mode = mode;
+	ctx->pacer.strikes = strikes;
+	if (mode == WATCHDOG_THROTTLE || !ctx->modules) return;
+
+	//	only the throttle skips frames
+	int count = List.count(ctx->modules);
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		m->stats.throttle = 0;
+		m->pace.wait = 0;
+		if (mode == WATCHDOG_OFF) m->stats.flagged = 0;
+	}
+}
+static void set_clock(ui_context ctx, ui_clock clock, object data) {
+	if (!ctx) return;
+
+	ctx->pacer.clock = clock;
+	ctx->pacer.clock_data = data;
+}
+static int flagged_modules(ui_context ctx, ui_module* out, int max) {
+	if (!ctx || !ctx->modules) return 0;
+
+	int count = List.count(ctx->modules), flagged = 0;
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		if (!m->stats.flagged) continue;
+		if (out && flagged < max) out[flagged] = m;
+		flagged++;
+	}
+
+	return flagged;
+}
+
+/* pacer interface (internal) */
+const IPacer Pacer = {
+	.begin_frame = begin_pace_frame,
+	.now = clock_now,
+	.due = module_due,
+	.ran = module_ran,
+	.charge = charge_module
+};
+/* budget interface */
+const IBudget Budget = {
+	.rate = set_rate,
+	.budget = set_budget,
+	.watchdog = set_watchdog,
+	.clock = set_clock,
+	.flagged = flagged_modules
+};
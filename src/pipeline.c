@@ -0,0 +1,345 @@
+// pipeline.c
+/**
+ * @detail Pipelined frames. The renderer never reads the live context: it
+ * 	renders a mirror context whose modules (one per live module, never moved,
+ * 	so render caches keep their keys) are pointed at a frame packet just
+ * 	before `Render.frame`. Packets form a ring of `depth` slots; the caller
+ * 	fills the next free slot after `Sigui.render` and the render thread empties
+ * 	them in order. A packet owns one draw list per module, and a list whose
+ * 	hash already matches the live one is not copied, so steady modules cost
+ * 	nothing once every packet has seen them. All allocation happens on the
+ * 	calling thread; the render thread only reads packets and writes results
+ * 	(cache statistics, the adopted viewport) back into them.
+ */
+
+#include <pthread.h>
+#include <time.h>
+#include "sigui_pipeline.h"
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Private structs =============================================================
+typedef struct pipeline_item_s {
+	ui_module mirror;							// render-side module
+	struct ui_window_s win;
+	int has_win;
+	int enabled;
+	layer_state layer;
+	draw_list draws;							// owned by the packet
+	uint64_t cache_hits, cache_misses;	// results: the mirror's counters
+} pipeline_item;
+
+typedef struct pipeline_packet_s {
+	pipeline_item* items;
+	int count, capacity;
+	damage_set damage;						// live damage since the previous packet
+	ui_rect viewport;							// culling viewport (result: as adopted by the target)
+	int rendered;								// results not harvested yet
+} pipeline_packet;
+
+struct ui_pipeline_s {
+	ui_context ctx;							// live context
+	render_target target;
+	ui_context mirror;						// context the render thread renders
+	ui_module* mirrors;						// mirror modules, by live index (calling thread)
+	int mirror_count, mirror_capacity;
+	pipeline_packet packets[PIPELINE_MAX_DEPTH];
+	int depth;
+	int head, tail, queued;					// next to fill, next to render, packets queued
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t ready;					// signalled when a packet is queued
+	pthread_cond_t done;						// signalled when a packet is presented
+	int shutdown;								// 1 = render thread exits
+	pipeline_stats stats;
+};
+
+//	Helper Functions ============================================================
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+/* copies a draw list into packet storage; 1 when it had to copy */
+static int copy_draws(ui_context ctx, draw_list* to, const draw_list* from) {
+	if (to->count == from->count && to->hash == from->hash && to->text_count == from->text_count) {
+		to->clip = from->clip;
+		to->culled = from->culled;
+		return 0;
+	}
+	if (from->count > to->capacity) {
+		draw_cmd* cmds = ui_grow(ctx, to->cmds, 0, sizeof(draw_cmd) * from->capacity, ALLOC_PIPELINE);
+		if (!cmds) return -1;
+		to->cmds = cmds;
+		to->capacity = from->capacity;
+	}
+	if (from->text_count > to->text_capacity) {
+		char* text = ui_grow(ctx, to->text, 0, from->text_capacity, ALLOC_PIPELINE);
+		if (!text) return -1;
+		to->text = text;
+		to->text_capacity = from->text_capacity;
+	}
+	if (from->count) memcpy(to->cmds, from->cmds, sizeof(draw_cmd) * from->count);
+	if (from->text_count) memcpy(to->text, from->text, from->text_count);
+	to->count = from->count;
+	to->text_count = from->text_count;
+	to->hash = from->hash;
+	to->clip = from->clip;
+	to->culled = from->culled;
+
+	return 1;
+}
+/* mirror of the live module at `index`, created on first use */
+static ui_module mirror_of(ui_pipeline p, int index) {
+	if (index < p->mirror_count) return p->mirrors[index];
+
+	if (p->mirror_count == p->mirror_capacity) {
+		int grown = p->mirror_capacity ? p->mirror_capacity * 2 : 16;
+		ui_module* mirrors = ui_grow(p->ctx, p->mirrors, sizeof(ui_module) * p->mirror_count, sizeof(ui_module) * grown, ALLOC_PIPELINE);
+		if (!mirrors) return NULL;
+		p->mirrors = mirrors;
+		p->mirror_capacity = grown;
+	}
+	ui_module m = ui_alloc(p->ctx, sizeof(struct sigui_module_s), ALLOC_PIPELINE);
+	window win = ui_alloc(p->ctx, sizeof(struct ui_window_s), ALLOC_PIPELINE);
+	if (!m || !win) {
+		if (m) ui_free(p->ctx, m, ALLOC_PIPELINE);
+		if (win) ui_free(p->ctx, win, ALLOC_PIPELINE);
+		return NULL;
+	}
+	ui_module live = List.getAt(p->ctx->modules, index);
+	m->name = live->name;
+	m->render = live->render;
+	m->stats = live->stats;		// cache counters carry on
+	m->ctx = p->mirror;
+	m->win = win;
+
+	return p->mirrors[p->mirror_count++] = m;
+}
+/* copies results of a presented packet back into the live context */
+static void harvest(ui_pipeline p, pipeline_packet* pk) {
+	if (!pk->rendered) return;
+	pk->rendered = 0;
+
+	for (int i = 0; i < pk->count; ++i) {
+		ui_module live = List.getAt(p->ctx->modules, i);
+		live->stats.cache_hits = pk->items[i].cache_hits;
+		live->stats.cache_misses = pk->items[i].cache_misses;
+	}
+	//	callbacks of the next frame are culled against the target
+	if (p->ctx->viewport.width <= 0 || p->ctx->viewport.height <= 0) p->ctx->viewport = pk->viewport;
+}
+/* fills a packet from the live context (calling thread); returns the lists copied or -1 */
+static int fill_packet(ui_pipeline p, pipeline_packet* pk) {
+	ui_context ctx = p->ctx;
+	int count = List.count(ctx->modules), copied = 0;
+	if (count > pk->capacity) {
+		pipeline_item* items = ui_grow(ctx, pk->items, sizeof(pipeline_item) * pk->capacity, sizeof(pipeline_item) * count, ALLOC_PIPELINE);
+		if (!items) return -1;
+		pk->items = items;
+		pk->capacity = count;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		pipeline_item* it = &pk->items[i];
+		if (!(it->mirror = mirror_of(p, i))) return -1;
+		it->has_win = m->win != NULL;
+		if (m->win) it->win = *m->win;
+		it->enabled = m->enabled;
+		it->layer = m->layer;
+		int c = copy_draws(ctx, &it->draws, &m->draws);
+		if (c < 0) return -1;
+		copied += c;
+	}
+	pk->count = count;
+	pk->damage = ctx->damage;
+	Damage.clear(&ctx->damage);
+	pk->viewport = ctx->viewport;
+
+	return copied;
+}
+/* points the mirror at a packet and renders it (render thread) */
+static void render_packet(ui_pipeline p, pipeline_packet* pk) {
+	ui_context mirror = p->mirror;
+	for (int i = 0; i < pk->count; ++i) {
+		pipeline_item* it = &pk->items[i];
+		ui_module m = it->mirror;
+		if (List.count(mirror->modules) == i) List.add(mirror->modules, m);
+		*m->win = it->win;
+		if (!it->has_win) m->win->width = m->win->height = 0;
+		m->enabled = it->enabled && it->has_win;
+		m->layer = it->layer;
+		m->draws = it->draws;		// shared with the packet until it is refilled
+	}
+	Damage.merge(&mirror->damage, &pk->damage);
+	mirror->viewport = pk->viewport;
+
+	Render.frame(p->target, mirror);
+
+	for (int i = 0; i < pk->count; ++i) {
+		pk->items[i].cache_hits = pk->items[i].mirror->stats.cache_hits;
+		pk->items[i].cache_misses = pk->items[i].mirror->stats.cache_misses;
+	}
+	pk->viewport = mirror->viewport;
+	pk->rendered = 1;
+}
+/* render thread */
+static void* render_main(void* arg) {
+	ui_pipeline p = arg;
+
+	pthread_mutex_lock(&p->lock);
+	while (1) {
+		while (p->queued == 0 && !p->shutdown) pthread_cond_wait(&p->ready, &p->lock);
+		if (p->queued == 0) break;		// shut down once drained
+		pipeline_packet* pk = &p->packets[p->tail];
+		pthread_mutex_unlock(&p->lock);
+
+		uint64_t start = now_ns();
+		render_packet(p, pk);
+		uint64_t spent = now_ns() - start;
+
+		pthread_mutex_lock(&p->lock);
+		p->tail = (p->tail + 1) % p->depth;
+		p->queued--;
+		p->stats.presented++;
+		p->stats.render_ns += spent;
+		pthread_cond_broadcast(&p->done);
+	}
+	pthread_mutex_unlock(&p->lock);
+
+	return NULL;
+}
+static void release_pipeline(ui_pipeline p) {
+	ui_context ctx = p->ctx;
+	for (int k = 0; k < PIPELINE_MAX_DEPTH; ++k) {
+		pipeline_packet* pk = &p->packets[k];
+		for (int i = 0; i < pk->capacity; ++i) {
+			if (pk->items[i].draws.cmds) ui_free(ctx, pk->items[i].draws.cmds, ALLOC_PIPELINE);
+			if (pk->items[i].draws.text) ui_free(ctx, pk->items[i].draws.text, ALLOC_PIPELINE);
+		}
+		if (pk->items) ui_free(ctx, pk->items, ALLOC_PIPELINE);
+	}
+	for (int i = 0; i < p->mirror_count; ++i) {
+		ui_free(ctx, p->mirrors[i]->win, ALLOC_PIPELINE);
+		ui_free(ctx, p->mirrors[i], ALLOC_PIPELINE);
+	}
+	if (p->mirrors) ui_free(ctx, p->mirrors, ALLOC_PIPELINE);
+	if (p->mirror) {
+		if (p->mirror->modules) List.free(p->mirror->modules);
+		ui_free(ctx, p->mirror, ALLOC_PIPELINE);
+	}
+	ui_free(ctx, p, ALLOC_PIPELINE);
+}
+
+//	Pipeline Interface ==========================================================
+/* creates a pipeline and starts its render thread */
+static ui_pipeline new_pipeline(ui_context ctx, render_target target, int depth) {
+	if (!ctx || !target) return NULL;
+	if (depth <= 0) depth = 2;
+	if (depth > PIPELINE_MAX_DEPTH) depth = PIPELINE_MAX_DEPTH;
+
+	ui_pipeline p = ui_alloc(ctx, sizeof(struct ui_pipeline_s), ALLOC_PIPELINE);
+	if (!p) return NULL;
+	p->ctx = ctx;
+	p->target = target;
+	p->depth = p->stats.depth = depth;
+	p->mirror = ui_alloc(ctx, sizeof(struct sigui_context_s), ALLOC_PIPELINE);
+	if (!p->mirror || !(p->mirror->modules = List.new(16))) {
+		release_pipeline(p);
+		return NULL;
+	}
+	p->mirror->alloc = ctx->alloc;
+	p->mirror->state = ctx->state;
+
+	pthread_mutex_init(&p->lock, NULL);
+	pthread_cond_init(&p->ready, NULL);
+	pthread_cond_init(&p->done, NULL);
+	if (pthread_create(&p->thread, NULL, render_main, p) != 0) {
+		pthread_cond_destroy(&p->done);
+		pthread_cond_destroy(&p->ready);
+		pthread_mutex_destroy(&p->lock);
+		release_pipeline(p);
+		return NULL;
+	}
+	DBLOG("Pipeline created: depth=%d", depth);
+
+	return p;
+}
+/* waits until every queued frame is presented */
+static void flush_pipeline(ui_pipeline p) {
+	if (!p) return;
+
+	pthread_mutex_lock(&p->lock);
+	while (p->queued > 0) pthread_cond_wait(&p->done, &p->lock);
+	pthread_mutex_unlock(&p->lock);
+	for (int k = 0; k < p->depth; ++k) harvest(p, &p->packets[k]);
+}
+/* presents what is queued, then stops the render thread */
+static void free_pipeline(ui_pipeline p) {
+	if (!p) return;
+
+	flush_pipeline(p);
+	pthread_mutex_lock(&p->lock);
+	p->shutdown = 1;
+	pthread_cond_signal(&p->ready);
+	pthread_mutex_unlock(&p->lock);
+	pthread_join(p->thread, NULL);
+
+	pthread_cond_destroy(&p->done);
+	pthread_cond_destroy(&p->ready);
+	pthread_mutex_destroy(&p->lock);
+	release_pipeline(p);
+}
+/* logic of the next frame on the calling thread; rendering is queued */
+static void pipeline_frame(ui_pipeline p, ui_input* input) {
+	if (!p) return;
+
+	uint64_t start = now_ns();
+	Sigui.render(p->ctx, input);
+	uint64_t logic = now_ns() - start;
+
+	//	every packet queued: wait for the render thread to free one
+	pthread_mutex_lock(&p->lock);
+	p->stats.logic_ns += logic;
+	if (p->queued == p->depth) {
+		start = now_ns();
+		while (p->queued == p->depth) pthread_cond_wait(&p->done, &p->lock);
+		p->stats.stalls++;
+		p->stats.stall_ns += now_ns() - start;
+	}
+	pthread_mutex_unlock(&p->lock);
+
+	pipeline_packet* pk = &p->packets[p->head];
+	harvest(p, pk);
+	int copied = fill_packet(p, pk);
+	if (copied < 0) {
+		DBLOG("<Pipeline> out of memory: frame dropped");
+		return;
+	}
+
+	pthread_mutex_lock(&p->lock);
+	p->stats.copied += copied;
+	p->stats.shared += pk->count - copied;
+	p->head = (p->head + 1) % p->depth;
+	p->queued++;
+	p->stats.frames++;
+	pthread_cond_signal(&p->ready);
+	pthread_mutex_unlock(&p->lock);
+}
+static void pipeline_statistics(ui_pipeline p, pipeline_stats* out) {
+	if (!p || !out) return;
+
+	pthread_mutex_lock(&p->lock);
+	*out = p->stats;
+	pthread_mutex_unlock(&p->lock);
+}
+
+/* pipeline interface */
+const IPipeline Pipeline = {
+	.new = new_pipeline,
+	.free = free_pipeline,
+	.frame = pipeline_frame,
+	.flush = flush_pipeline,
+	.stats = pipeline_statistics
+};
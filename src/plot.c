@@ -0,0 +1,450 @@
+// plot.c
+/**
+ * @detail Time-series plots. A series keeps its samples and a min/max pyramid
+ * 	in chunked float arrays (chunks never move, so appending never copies old
+ * 	samples). Level L entry i holds the min (lo) and max (hi) of entries
+ * 	[i * PLOT_FAN, (i + 1) * PLOT_FAN) of level L - 1; level 0 is the samples.
+ * 	Appending re-computes only the pyramid entries whose span received samples.
+ * 	A range query scans an unaligned head and tail at each level and climbs to
+ * 	the next level for the aligned middle, so it reads at most ~2 * PLOT_FAN
+ * 	entries per level however wide the range is. Scans use SSE2 min/max
+ * 	kernels where available.
+ */
+
+#include <math.h>
+#include "ui_core.h"
+#include "sigui_widgets.h"
+#include "sigui_debug.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define PLOT_CHUNK_BITS 16
+#define PLOT_CHUNK (1 << PLOT_CHUNK_BITS)	/* floats per chunk */
+#define PLOT_LEVELS 8							/* pyramid levels (samples included) */
+
+/* chunked float array */
+typedef struct plot_array_s {
+	float** chunks;
+	int chunk_count, chunk_capacity;
+	int64_t count;
+} plot_array;
+/* series samples and min/max pyramid */
+typedef struct plot_series_s {
+	uint32_t color;
+	plot_array lo[PLOT_LEVELS];			/* level 0: samples; above: minimums */
+	plot_array hi[PLOT_LEVELS];			/* maximums (level 0 unused) */
+	int levels;									/* levels built (1: samples only) */
+} plot_series;
+/* plot state (module widget) */
+struct ui_plotview_s {
+	ui_module module;
+	plot_series series[PLOT_SERIES_MAX];
+	int series_count;
+	int64_t first, span;						/* samples in view (span <= 0: all) */
+	int follow;									/* view tracks the last `span` samples */
+	float min, max;							/* value range (min >= max: fit) */
+	uint32_t background;
+	plotview_stats stats;
+};
+
+//	SIMD Kernels ================================================================
+/* folds n floats into a running min and max, skipping NaN gaps: min/max ps
+ * return their second operand on NaN, so the sample goes first in every kernel */
+static void scan_minmax(const float* p, int n, float* lo, float* hi) {
+	int i = 0;
+	float mn = *lo, mx = *hi;
+#ifdef __SSE2__
+	if (n >= 8) {
+		__m128 lo0 = _mm_set1_ps(mn), lo1 = lo0, hi0 = _mm_set1_ps(mx), hi1 = hi0;
+		for (; i + 8 <= n; i += 8) {
+			__m128 a = _mm_loadu_ps(p + i), b = _mm_loadu_ps(p + i + 4);
+			lo0 = _mm_min_ps(a, lo0);
+			lo1 = _mm_min_ps(b, lo1);
+			hi0 = _mm_max_ps(a, hi0);
+			hi1 = _mm_max_ps(b, hi1);
+		}
+		float l[4], h[4];
+		_mm_storeu_ps(l, _mm_min_ps(lo0, lo1));
+		_mm_storeu_ps(h, _mm_max_ps(hi0, hi1));
+		for (int k = 0; k < 4; ++k) {
+			if (l[k] < mn) mn = l[k];
+			if (h[k] > mx) mx = h[k];
+		}
+	}
+#endif
+	for (; i < n; ++i) {
+		if (p[i] < mn) mn = p[i];
+		if (p[i] > mx) mx = p[i];
+	}
+	*lo = mn;
+	*hi = mx;
+}
+/* folds n floats into a running min */
+static float scan_min(const float* p, int n, float mn) {
+	int i = 0;
+#ifdef __SSE2__
+	if (n >= 8) {
+		__m128 a = _mm_set1_ps(mn), b = a;
+		for (; i + 8 <= n; i += 8) {
+			a = _mm_min_ps(_mm_loadu_ps(p + i), a);
+			b = _mm_min_ps(_mm_loadu_ps(p + i + 4), b);
+		}
+		float l[4];
+		_mm_storeu_ps(l, _mm_min_ps(a, b));
+		for (int k = 0; k < 4; ++k) if (l[k] < mn) mn = l[k];
+	}
+#endif
+	for (; i < n; ++i) if (p[i] < mn) mn = p[i];
+
+	return mn;
+}
+/* folds n floats into a running max */
+static float scan_max(const float* p, int n, float mx) {
+	int i = 0;
+#ifdef __SSE2__
+	if (n >= 8) {
+		__m128 a = _mm_set1_ps(mx), b = a;
+		for (; i + 8 <= n; i += 8) {
+			a = _mm_max_ps(_mm_loadu_ps(p + i), a);
+			b = _mm_max_ps(_mm_loadu_ps(p + i + 4), b);
+		}
+		float h[4];
+		_mm_storeu_ps(h, _mm_max_ps(a, b));
+		for (int k = 0; k < 4; ++k) if (h[k] > mx) mx = h[k];
+	}
+#endif
+	for (; i < n; ++i) if (p[i] > mx) mx = p[i];
+
+	return mx;
+}
+
+//	Chunked Arrays ==============================================================
+static inline float array_get(const plot_array* a, int64_t i) {
+	return a->chunks[i >> PLOT_CHUNK_BITS][i & (PLOT_CHUNK - 1)];
+}
+/* makes room for entries [0, count); 0 on success */
+static int array_reserve(ui_context ctx, plot_array* a, int64_t count) {
+	int chunks = (int)((count + PLOT_CHUNK - 1) >> PLOT_CHUNK_BITS);
+	if (chunks > a->chunk_capacity) {
+		int capacity = a->chunk_capacity ? a->chunk_capacity : 4;
+		while (capacity < chunks) capacity *= 2;
+		float** table = ui_grow(ctx, a->chunks, sizeof(float*) * a->chunk_count, sizeof(float*) * capacity, ALLOC_WIDGET);
+		if (!table) return -1;
+		a->chunks = table;
+		a->chunk_capacity = capacity;
+	}
+	while (a->chunk_count < chunks) {
+		float* chunk = ui_alloc(ctx, sizeof(float) * PLOT_CHUNK, ALLOC_WIDGET);
+		if (!chunk) return -1;
+		a->chunks[a->chunk_count++] = chunk;
+	}
+
+	return 0;
+}
+/* sets entry i (i <= count; i == count appends) */
+static int array_set(ui_context ctx, plot_array* a, int64_t i, float v) {
+	if (i == a->count) {
+		if (array_reserve(ctx, a, i + 1) != 0) return -1;
+		a->count++;
+	}
+	a->chunks[i >> PLOT_CHUNK_BITS][i & (PLOT_CHUNK - 1)] = v;
+
+	return 0;
+}
+/* folds entries [first, last) into a running min/max (lo == hi: one array of samples) */
+static void array_minmax(const plot_array* lo, const plot_array* hi, int64_t first, int64_t last, float* mn, float* mx) {
+	while (first < last) {
+		int chunk = (int)(first >> PLOT_CHUNK_BITS);
+		int offset = (int)(first & (PLOT_CHUNK - 1));
+		int n = last - first < PLOT_CHUNK - offset ? (int)(last - first) : PLOT_CHUNK - offset;
+		if (lo == hi) scan_minmax(lo->chunks[chunk] + offset, n, mn, mx);
+		else {
+			*mn = scan_min(lo->chunks[chunk] + offset, n, *mn);
+			*mx = scan_max(hi->chunks[chunk] + offset, n, *mx);
+		}
+		first += n;
+	}
+}
+static void array_release(ui_context ctx, plot_array* a) {
+	for (int i = 0; i < a->chunk_count; ++i) ui_free(ctx, a->chunks[i], ALLOC_WIDGET);
+	if (a->chunks) ui_free(ctx, a->chunks, ALLOC_WIDGET);
+	memset(a, 0, sizeof(plot_array));
+}
+
+//	Pyramid =====================================================================
+/* re-computes the pyramid entries covering samples from `first` on */
+static int extend_pyramid(ui_context ctx, plot_series* s, int64_t first) {
+	for (int level = 1; level < PLOT_LEVELS; ++level) {
+		const plot_array* below_lo = &s->lo[level - 1];
+		const plot_array* below_hi = level == 1 ? below_lo : &s->hi[level - 1];
+		if (below_lo->count <= PLOT_FAN) break;		// one entry would cover it all
+
+		int64_t b = first / PLOT_FAN;
+		if (b > s->lo[level].count) b = s->lo[level].count;	// a new level starts from 0
+		first = b;
+		for (int64_t end = (below_lo->count + PLOT_FAN - 1) / PLOT_FAN; b < end; ++b) {
+			int64_t last = (b + 1) * PLOT_FAN < below_lo->count ? (b + 1) * PLOT_FAN : below_lo->count;
+			float mn = INFINITY, mx = -INFINITY;
+			array_minmax(below_lo, below_hi, b * PLOT_FAN, last, &mn, &mx);
+			if (array_set(ctx, &s->lo[level], b, mn) != 0 || array_set(ctx, &s->hi[level], b, mx) != 0) return -1;
+		}
+		if (s->levels < level + 1) s->levels = level + 1;
+	}
+
+	return 0;
+}
+/* min/max of samples [first, last): unaligned ends at each level, aligned middle one level up */
+static int64_t query(const plot_series* s, int64_t first, int64_t last, float* mn, float* mx) {
+	*mn = INFINITY;
+	*mx = -INFINITY;
+	int64_t scanned = 0;
+	int64_t unit = 1;
+	for (int level = 0; first < last; ++level) {
+		const plot_array* lo = &s->lo[level];
+		const plot_array* hi = level ? &s->hi[level] : lo;
+		int64_t next = unit * PLOT_FAN;
+		if (level + 1 >= s->levels || last - first < 2 * next) {
+			array_minmax(lo, hi, first / unit, (last + unit - 1) / unit, mn, mx);
+			scanned += (last + unit - 1) / unit - first / unit;
+			break;
+		}
+
+		int64_t head = (first + next - 1) / next * next;
+		int64_t tail = last / next * next;
+		array_minmax(lo, hi, first / unit, head / unit, mn, mx);
+		array_minmax(lo, hi, tail / unit, (last + unit - 1) / unit, mn, mx);
+		scanned += (head - first + last - tail + unit - 1) / unit;
+		first = head;
+		last = tail;
+		unit = next;
+	}
+
+	return scanned;
+}
+
+//	Helper Functions ============================================================
+static int64_t longest_series(ui_plotview p) {
+	int64_t count = 0;
+	for (int i = 0; i < p->series_count; ++i) {
+		if (p->series[i].lo[0].count > count) count = p->series[i].lo[0].count;
+	}
+
+	return count;
+}
+static inline int value_y(float v, float min, float max, int height) {
+	return (int)lrintf((max - v) * (float)(height - 1) / (max - min));
+}
+/* one min/max span per pixel column; each span reaches its neighbour so the trace stays connected */
+static void draw_columns(ui_plotview p, plot_series* s, int64_t first, int64_t span, int width, int height, float min, float max) {
+	ui_context ctx = p->module->ctx;
+	int64_t count = s->lo[0].count;
+	int prev_top = -1, prev_bottom = -1;
+	for (int x = 0; x < width; ++x) {
+		int64_t a = first + span * x / width;
+		int64_t b = first + span * (x + 1) / width;
+		if (b > count) b = count;
+		if (a >= b) break;
+
+		float mn, mx;
+		p->stats.scanned += query(s, a, b, &mn, &mx);
+		int top = value_y(mx, min, max, height), bottom = value_y(mn, min, max, height);
+		if (prev_top >= 0) {
+			if (top > prev_bottom) top = prev_bottom;
+			if (bottom < prev_top) bottom = prev_top;
+		}
+		Draw.rect(ctx, x, top, 1, bottom - top + 1, s->color);
+		prev_top = top;
+		prev_bottom = bottom;
+	}
+	p->stats.columns = width;
+}
+/* zoomed in: samples joined by lines */
+static void draw_lines(ui_plotview p, plot_series* s, int64_t first, int64_t span, int width, int height, float min, float max) {
+	ui_context ctx = p->module->ctx;
+	int64_t last = first + span + 1 < s->lo[0].count ? first + span + 1 : s->lo[0].count;
+	int px = 0, py = 0;
+	for (int64_t i = first; i < last; ++i) {
+		int x = (int)((i - first) * (width - 1) / (span > 1 ? span - 1 : 1));
+		int y = value_y(array_get(&s->lo[0], i), min, max, height);
+		if (i > first) Draw.line(ctx, px, py, x, y, 1, s->color);
+		px = x;
+		py = y;
+	}
+	p->stats.scanned += last > first ? last - first : 0;
+	p->stats.columns = 0;
+}
+
+//	Module Callbacks ============================================================
+/* decimates every series over the samples in view */
+static void render_plot(ui_context ctx, ui_module m, ui_input* input) {
+	ui_plotview p = m->widget;
+	if (!p || !m->win) return;
+	int width = m->win->width, height = m->win->height;
+
+	p->stats.scanned = 0;
+	p->stats.columns = 0;
+	Draw.rect(ctx, 0, 0, width, height, p->background);
+	int64_t count = longest_series(p);
+	int64_t first = p->first, span = p->span;
+	if (span <= 0) {
+		first = 0;
+		span = count;
+	} else if (p->follow) first = count > span ? count - span : 0;
+	if (span <= 0 || width <= 0 || height <= 0) return;
+
+	float min = p->min, max = p->max;
+	if (min >= max) {
+		min = INFINITY;
+		max = -INFINITY;
+		for (int i = 0; i < p->series_count; ++i) {
+			float mn, mx;
+			p->stats.scanned += query(&p->series[i], first, first + span < p->series[i].lo[0].count ? first + span : p->series[i].lo[0].count, &mn, &mx);
+			if (mn < min) min = mn;
+			if (mx > max) max = mx;
+		}
+		if (!(min < max)) {
+			min = isfinite(min) ? min - 1.0f : -1.0f;
+			max = isfinite(max) ? max + 1.0f : 1.0f;
+		}
+	}
+
+	for (int i = 0; i < p->series_count; ++i) {
+		if (span > width) draw_columns(p, &p->series[i], first, span, width, height, min, max);
+		else draw_lines(p, &p->series[i], first, span, width, height, min, max);
+	}
+}
+/* frees the plot with its module */
+static void release_plot(ui_module m) {
+	ui_plotview p = m->widget;
+	if (!p) return;
+
+	for (int i = 0; i < p->series_count; ++i) {
+		for (int level = 0; level < PLOT_LEVELS; ++level) {
+			array_release(m->ctx, &p->series[i].lo[level]);
+			array_release(m->ctx, &p->series[i].hi[level]);
+		}
+	}
+	ui_free(m->ctx, p, ALLOC_WIDGET);
+	m->widget = NULL;
+}
+
+//	Plot Interface ==============================================================
+static ui_plotview new_plot(ui_context ctx, string name, window win) {
+	if (!ctx) return NULL;
+
+	ui_plotview p = ui_alloc(ctx, sizeof(struct ui_plotview_s), ALLOC_WIDGET);
+	if (!p) return NULL;
+	ui_module m = Sigui.add_module(ctx, name, render_plot, NULL, win);
+	if (!m) {
+		ui_free(ctx, p, ALLOC_WIDGET);
+		return NULL;
+	}
+	DBLOG("<Plot> new plot=%s", name);
+
+	p->module = m;
+	p->background = UI_RGB(255, 255, 255);
+	m->widget = p;
+	m->release = release_plot;
+
+	return p;
+}
+static ui_module plot_module(ui_plotview p) {
+	return p ? p->module : NULL;
+}
+static int add_series(ui_plotview p, uint32_t color) {
+	if (!p || p->series_count == PLOT_SERIES_MAX) return -1;
+
+	plot_series* s = &p->series[p->series_count];
+	memset(s, 0, sizeof(plot_series));
+	s->color = color;
+	s->levels = 1;
+
+	return p->series_count++;
+}
+/* O(count): copies the samples chunk by chunk, then extends the pyramid */
+static int append_samples(ui_plotview p, int series, const float* samples, int count) {
+	if (!p || series < 0 || series >= p->series_count || !samples || count < 0) return -1;
+	plot_series* s = &p->series[series];
+	plot_array* a = &s->lo[0];
+	ui_context ctx = p->module->ctx;
+
+	int64_t first = a->count;
+	if (array_reserve(ctx, a, first + count) != 0) return -1;
+	for (int done = 0; done < count; ) {
+		int offset = (int)(a->count & (PLOT_CHUNK - 1));
+		int n = count - done < PLOT_CHUNK - offset ? count - done : PLOT_CHUNK - offset;
+		memcpy(a->chunks[a->count >> PLOT_CHUNK_BITS] + offset, samples + done, sizeof(float) * n);
+		a->count += n;
+		done += n;
+	}
+
+	return extend_pyramid(ctx, s, first);
+}
+static int64_t series_count(ui_plotview p, int series) {
+	return p && series >= 0 && series < p->series_count ? p->series[series].lo[0].count : 0;
+}
+static void set_view(ui_plotview p, int64_t first, int64_t span) {
+	if (!p) return;
+
+	p->first = first > 0 ? first : 0;
+	p->span = span;
+	p->follow = 0;
+}
+static void follow_tail(ui_plotview p, int64_t span) {
+	if (!p) return;
+
+	p->span = span;
+	p->follow = span > 0;
+}
+static void set_range(ui_plotview p, float min, float max) {
+	if (!p) return;
+
+	p->min = min;
+	p->max = max;
+}
+static int range_minmax(ui_plotview p, int series, int64_t first, int64_t last, float* mn, float* mx) {
+	if (!p || series < 0 || series >= p->series_count) return -1;
+	plot_series* s = &p->series[series];
+	if (first < 0) first = 0;
+	if (last > s->lo[0].count) last = s->lo[0].count;
+	if (first >= last) return -1;
+
+	float lo, hi;
+	query(s, first, last, &lo, &hi);
+	if (mn) *mn = lo;
+	if (mx) *mx = hi;
+
+	return 0;
+}
+static void plot_statistics(ui_plotview p, plotview_stats* out) {
+	if (!p || !out) return;
+
+	*out = p->stats;
+	out->samples = 0;
+	out->levels = 0;
+	out->bytes = 0;
+	for (int i = 0; i < p->series_count; ++i) {
+		plot_series* s = &p->series[i];
+		out->samples += s->lo[0].count;
+		if (s->levels - 1 > out->levels) out->levels = s->levels - 1;
+		for (int level = 0; level < PLOT_LEVELS; ++level) {
+			out->bytes += (size_t)(s->lo[level].chunk_count + s->hi[level].chunk_count) * PLOT_CHUNK * sizeof(float);
+		}
+	}
+}
+
+/* global plot view interface */
+const IPlotView PlotView = {
+	.new = new_plot,
+	.module = plot_module,
+	.add_series = add_series,
+	.append = append_samples,
+	.count = series_count,
+	.view = set_view,
+	.follow = follow_tail,
+	.range = set_range,
+	.minmax = range_minmax,
+	.stats = plot_statistics
+};
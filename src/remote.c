@@ -0,0 +1,1020 @@
+// remote.c
+/**
+ * @detail Remote rendering. Messages are [type u8][length u32][payload].
+ * 	The server keeps a copy of what the viewer holds for every module and sends
+ * 	a frame as records for the modules that differ from it; a draw list record
+ * 	carries the list hash (the viewer's render caches key on it), the prefix
+ * 	and suffix kept from the previous list and the commands between them.
+ * 	Integers are LEB128 varints (zigzag when signed); a command's position and
+ * 	color are coded against the command before it, and its clip is only sent
+ * 	when it changes. Text runs become ids in a string table both ends grow in
+ * 	the same order: a frame first defines the strings its records introduce.
+ * 	When the table reaches REMOTE_STRING_MAX the next frame starts it over.
+ * 	The viewer rebuilds changed lists in a scratch list and swaps it with the
+ * 	module's, so steady frames allocate nothing on either end, and damages the
+ * 	windows of the lists it replaced (the renderer tracks moved windows).
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "sigui_remote.h"
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+#define REMOTE_ADDRESS_MAX 160
+#define REMOTE_NAME_MAX 128
+#define REMOTE_HEADER 5							/* type + length */
+#define REMOTE_MESSAGE_MAX (64u << 20)				/* longest payload either side accepts */
+
+//	Private structs =============================================================
+enum { MSG_FRAME = 1, MSG_ACK, MSG_INPUT, MSG_SIZE };
+enum { REC_NEW = 1, REC_WINDOW = 2, REC_ENABLED = 4, REC_LAYER = 8, REC_DRAWS = 16, REC_NO_WINDOW = 32 };
+enum { CMD_COLOR = 1, CMD_CLIP = 2, CMD_SHAPE = 4 };
+enum { IN_POINTER = 1, IN_BUTTONS = 2, IN_MODIFIERS = 4, IN_KEYS = 8 };
+enum { FRAME_STRINGS_RESET = 1 };
+
+typedef struct byte_buffer_s {
+	ui_context ctx;							// allocating context
+	uint8_t* data;
+	size_t size, capacity;
+	int failed;									// out of memory while writing
+} byte_buffer;
+
+typedef struct byte_reader_s {
+	const uint8_t* p;
+	const uint8_t* end;
+	int bad;										// read past the end
+} byte_reader;
+
+/* what the viewer holds for a module */
+typedef struct remote_module_s {
+	struct ui_window_s win;
+	int has_win, enabled;
+	layer_state layer;
+	draw_list draws;							// server: copy of the last list sent
+	int known;
+} remote_module;
+
+typedef struct remote_string_s {
+	uint64_t hash;
+	uint32_t offset, length;				// bytes in the arena
+} remote_string;
+
+struct ui_remote_s {
+	int server;									// 1: server, 0: viewer
+	int listen_fd, fd;
+	char address[REMOTE_ADDRESS_MAX];
+	char path[sizeof(((struct sockaddr_un*)0)->sun_path)];	// unix socket to unlink
+	ui_context ctx;							// server: streamed context; viewer: replica
+	remote_module* modules;
+	int module_capacity;
+	remote_string* strings;
+	int string_count, string_capacity;
+	int* string_index;						// server: open-addressed ids + 1
+	int index_mask;
+	char* arena;
+	size_t arena_size, arena_capacity;
+	int strings_reset;						// server: the next frame starts the table over
+	byte_buffer out, body, in;
+	uint64_t frame;
+	ui_input input;							// server: viewer input; viewer: last input sent
+	int input_changed;
+	draw_list scratch;						// viewer: list being rebuilt
+	remote_stats stats;
+};
+
+//	Helper Functions ============================================================
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+static int reserve(byte_buffer* b, size_t extra) {
+	if (b->size + extra <= b->capacity) return 0;
+	if (b->failed) return -1;
+
+	size_t capacity = b->capacity ? b->capacity : 4096;
+	while (capacity < b->size + extra) capacity *= 2;
+	uint8_t* data = ui_grow(b->ctx, b->data, b->size, capacity, ALLOC_REMOTE);
+	if (!data) {
+		b->failed = 1;
+		return -1;
+	}
+	b->data = data;
+	b->capacity = capacity;
+
+	return 0;
+}
+static void put_bytes(byte_buffer* b, const void* data, size_t size) {
+	if (reserve(b, size) != 0) return;
+	memcpy(b->data + b->size, data, size);
+	b->size += size;
+}
+static void put_u8(byte_buffer* b, uint8_t v) {
+	put_bytes(b, &v, 1);
+}
+static void put_uv(byte_buffer* b, uint64_t v) {
+	uint8_t tmp[10];
+	int n = 0;
+	do {
+		tmp[n] = v & 0x7F;
+		v >>= 7;
+		if (v) tmp[n] |= 0x80;
+		n++;
+	} while (v);
+	put_bytes(b, tmp, n);
+}
+static void put_zz(byte_buffer* b, int64_t v) {
+	put_uv(b, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+static void put_u32(byte_buffer* b, uint32_t v) {
+	uint8_t tmp[4] = { v, v >> 8, v >> 16, v >> 24 };
+	put_bytes(b, tmp, 4);
+}
+static void put_u64(byte_buffer* b, uint64_t v) {
+	put_u32(b, (uint32_t)v);
+	put_u32(b, (uint32_t)(v >> 32));
+}
+static void put_rect(byte_buffer* b, ui_rect r) {
+	put_zz(b, r.x);
+	put_zz(b, r.y);
+	put_zz(b, r.width);
+	put_zz(b, r.height);
+}
+static const uint8_t* get_bytes(byte_reader* r, size_t size) {
+	if (r->bad || (size_t)(r->end - r->p) < size) {
+		r->bad = 1;
+		return NULL;
+	}
+	const uint8_t* p = r->p;
+	r->p += size;
+
+	return p;
+}
+static uint8_t get_u8(byte_reader* r) {
+	const uint8_t* p = get_bytes(r, 1);
+	return p ? *p : 0;
+}
+static uint64_t get_uv(byte_reader* r) {
+	uint64_t v = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		uint8_t c = get_u8(r);
+		v |= (uint64_t)(c & 0x7F) << shift;
+		if (!(c & 0x80)) return v;
+	}
+	r->bad = 1;
+
+	return 0;
+}
+static int64_t get_zz(byte_reader* r) {
+	uint64_t v = get_uv(r);
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+static uint32_t get_u32(byte_reader* r) {
+	const uint8_t* p = get_bytes(r, 4);
+	return p ? (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24 : 0;
+}
+static uint64_t get_u64(byte_reader* r) {
+	uint64_t lo = get_u32(r);
+	return lo | (uint64_t)get_u32(r) << 32;
+}
+static ui_rect get_rect(byte_reader* r) {
+	ui_rect out;
+	out.x = (int)get_zz(r);
+	out.y = (int)get_zz(r);
+	out.width = (int)get_zz(r);
+	out.height = (int)get_zz(r);
+
+	return out;
+}
+static inline int rect_same(ui_rect a, ui_rect b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+static int layer_same(const layer_state* a, const layer_state* b) {
+	return a->enabled == b->enabled && a->width == b->width && a->height == b->height && a->scroll_x == b->scroll_x &&
+			 a->scroll_y == b->scroll_y && a->dx == b->dx && a->dy == b->dy && a->opacity == b->opacity;
+}
+/* commands equal but for where their text sits */
+static int cmd_same(const draw_list* a, int i, const draw_list* b, int j) {
+	draw_cmd x = a->cmds[i], y = b->cmds[j];
+	if (x.kind == DRAW_TEXT && y.kind == DRAW_TEXT &&
+		 (x.length != y.length || memcmp(a->text + x.text, b->text + y.text, x.length) != 0)) return 0;
+	x.text = y.text = 0;
+
+	return memcmp(&x, &y, sizeof(draw_cmd)) == 0;
+}
+
+//	Sockets =====================================================================
+/* opens a listening or connected socket; NULL error on success */
+static const char* open_socket(ui_remote r, const char* address, int listening) {
+	if (!strncmp(address, "unix:", 5)) {
+		struct sockaddr_un sa = { .sun_family = AF_UNIX };
+		if (strlen(address + 5) >= sizeof(sa.sun_path)) return "path too long";
+		strcpy(sa.sun_path, address + 5);
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0) return "socket";
+		if (listening) {
+			unlink(sa.sun_path);
+			if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 || listen(fd, 1) != 0) {
+				close(fd);
+				return "bind";
+			}
+			strcpy(r->path, sa.sun_path);
+			r->listen_fd = fd;
+		} else {
+			if (connect(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+				close(fd);
+				return "connect";
+			}
+			r->fd = fd;
+		}
+		snprintf(r->address, sizeof(r->address), "%s", address);
+		return NULL;
+	}
+	if (strncmp(address, "tcp:", 4) != 0) return "unknown scheme";
+
+	char host[REMOTE_ADDRESS_MAX - 16];
+	snprintf(host, sizeof(host), "%s", address + 4);
+	char* port = strrchr(host, ':');
+	if (!port) return "no port";
+	*port++ = '\0';
+	struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_flags = listening ? AI_PASSIVE : 0 };
+	struct addrinfo* found = NULL;
+	if (getaddrinfo(host[0] ? host : NULL, port, &hints, &found) != 0) return "resolve";
+
+	int fd = -1;
+	for (struct addrinfo* a = found; a && fd < 0; a = a->ai_next) {
+		fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+		if (fd < 0) continue;
+		int on = 1;
+		if (listening) {
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+			if (bind(fd, a->ai_addr, a->ai_addrlen) == 0 && listen(fd, 1) == 0) continue;
+		} else {
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+			if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) continue;
+		}
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(found);
+	if (fd < 0) return listening ? "bind" : "connect";
+
+	//	port 0: report the one picked
+	struct sockaddr_storage bound;
+	socklen_t size = sizeof(bound);
+	int number = atoi(port);
+	if (listening && getsockname(fd, (struct sockaddr*)&bound, &size) == 0) {
+		number = ntohs(bound.ss_family == AF_INET6 ? ((struct sockaddr_in6*)&bound)->sin6_port : ((struct sockaddr_in*)&bound)->sin_port);
+	}
+	snprintf(r->address, sizeof(r->address), "tcp:%s:%d", host, number);
+	if (listening) r->listen_fd = fd;
+	else r->fd = fd;
+
+	return NULL;
+}
+static void disconnect(ui_remote r) {
+	if (r->fd >= 0) close(r->fd);
+	r->fd = -1;
+	r->in.size = 0;
+	r->stats.connected = 0;
+	DBLOG("<Remote> peer closed");
+}
+static int write_all(ui_remote r, const uint8_t* data, size_t size) {
+	size_t done = 0;
+	while (done < size) {
+		ssize_t n = send(r->fd, data + done, size - done, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) {
+			disconnect(r);
+			return -1;
+		}
+		done += (size_t)n;
+	}
+	r->stats.bytes_out += size;
+
+	return (int)size;
+}
+/* starts a message in `out`; finish_message fills in its length */
+static void begin_message(byte_buffer* b, uint8_t type) {
+	b->size = 0;
+	b->failed = 0;
+	put_u8(b, type);
+	put_u32(b, 0);
+}
+static int finish_message(ui_remote r, byte_buffer* b) {
+	if (b->failed || b->size - REMOTE_HEADER > REMOTE_MESSAGE_MAX) return -1;
+	uint32_t length = (uint32_t)(b->size - REMOTE_HEADER);
+	uint8_t tmp[4] = { length, length >> 8, length >> 16, length >> 24 };
+	memcpy(b->data + 1, tmp, 4);
+
+	return write_all(r, b->data, b->size);
+}
+
+//	String Table ================================================================
+static void reset_strings(ui_remote r) {
+	r->string_count = 0;
+	r->arena_size = 0;
+	if (r->string_index) memset(r->string_index, 0, sizeof(int) * (r->index_mask + 1));
+}
+/* appends a string (ids are given in order); -1 when out of memory */
+static int add_string(ui_remote r, const char* s, uint32_t length, uint64_t hash) {
+	if (r->string_count == r->string_capacity) {
+		int grown = r->string_capacity ? r->string_capacity * 2 : 256;
+		remote_string* strings = ui_grow(r->ctx, r->strings, sizeof(remote_string) * r->string_count, sizeof(remote_string) * grown, ALLOC_REMOTE);
+		if (!strings) return -1;
+		r->strings = strings;
+		r->string_capacity = grown;
+	}
+	if (r->arena_size + length > r->arena_capacity) {
+		size_t grown = r->arena_capacity ? r->arena_capacity * 2 : 4096;
+		while (grown < r->arena_size + length) grown *= 2;
+		char* arena = ui_grow(r->ctx, r->arena, r->arena_size, grown, ALLOC_REMOTE);
+		if (!arena) return -1;
+		r->arena = arena;
+		r->arena_capacity = grown;
+	}
+	memcpy(r->arena + r->arena_size, s, length);
+	r->strings[r->string_count] = (remote_string){ hash, (uint32_t)r->arena_size, length };
+	r->arena_size += length;
+	r->stats.strings++;
+
+	return r->string_count++;
+}
+/* server: id of a text run, interning it when new */
+static int intern(ui_remote r, const char* s, uint32_t length) {
+	uint64_t h = ui_fnv1a(UI_FNV_OFFSET, s, length);
+	if ((r->string_count + 1) * 2 > (r->string_index ? r->index_mask + 1 : 0)) {
+		int slots = r->string_index ? (r->index_mask + 1) * 2 : 1024;
+		int* index = ui_alloc(r->ctx, sizeof(int) * slots, ALLOC_REMOTE);
+		if (!index) return -1;
+		for (int i = 0; i < r->string_count; ++i) {
+			uint32_t k = (uint32_t)r->strings[i].hash & (slots - 1);
+			while (index[k]) k = (k + 1) & (slots - 1);
+			index[k] = i + 1;
+		}
+		if (r->string_index) ui_free(r->ctx, r->string_index, ALLOC_REMOTE);
+		r->string_index = index;
+		r->index_mask = slots - 1;
+	}
+
+	uint32_t k = (uint32_t)h & r->index_mask;
+	for (; r->string_index[k]; k = (k + 1) & r->index_mask) {
+		const remote_string* e = &r->strings[r->string_index[k] - 1];
+		if (e->hash == h && e->length == length && !memcmp(r->arena + e->offset, s, length)) {
+			r->stats.string_hits++;
+			return r->string_index[k] - 1;
+		}
+	}
+	int id = add_string(r, s, length, h);
+	if (id >= 0) r->string_index[k] = id + 1;
+
+	return id;
+}
+
+//	Server ======================================================================
+/* copies a list the viewer now holds */
+static int keep_list(ui_context ctx, draw_list* to, const draw_list* from) {
+	if (from->count > to->capacity) {
+		draw_cmd* cmds = ui_grow(ctx, to->cmds, 0, sizeof(draw_cmd) * from->capacity, ALLOC_REMOTE);
+		if (!cmds) return -1;
+		to->cmds = cmds;
+		to->capacity = from->capacity;
+	}
+	if (from->text_count > to->text_capacity) {
+		char* text = ui_grow(ctx, to->text, 0, from->text_capacity, ALLOC_REMOTE);
+		if (!text) return -1;
+		to->text = text;
+		to->text_capacity = from->text_capacity;
+	}
+	if (from->count) memcpy(to->cmds, from->cmds, sizeof(draw_cmd) * from->count);
+	if (from->text_count) memcpy(to->text, from->text, from->text_count);
+	to->count = from->count;
+	to->text_count = from->text_count;
+	to->hash = from->hash;
+	to->clip = from->clip;
+
+	return 0;
+}
+static void encode_cmd(ui_remote r, byte_buffer* b, const draw_cmd* c, const char* text, const draw_cmd* prev) {
+	//	images are not streamed: their placeholder is
+	uint32_t kind = c->kind == DRAW_IMAGE ? DRAW_RECT : c->kind;
+	uint8_t flags = (c->color != prev->color ? CMD_COLOR : 0) | (!rect_same(c->clip, prev->clip) ? CMD_CLIP : 0) |
+						 (c->radius || c->border ? CMD_SHAPE : 0);
+	put_u8(b, (uint8_t)(kind | flags << 4));
+	put_zz(b, (int64_t)c->rect.x - prev->rect.x);
+	put_zz(b, (int64_t)c->rect.y - prev->rect.y);
+	put_zz(b, c->rect.width);
+	put_zz(b, c->rect.height);
+	if (flags & CMD_COLOR) put_u32(b, c->color);
+	if (flags & CMD_CLIP) put_rect(b, c->clip);
+	if (flags & CMD_SHAPE) {
+		put_uv(b, c->radius);
+		put_uv(b, c->border);
+	}
+	if (kind == DRAW_TEXT) {
+		put_uv(b, (uint64_t)intern(r, text + c->text, c->length));
+		put_zz(b, c->font);
+	} else if (kind == DRAW_LINE) {
+		for (int i = 0; i < 4; ++i) put_zz(b, c->points[i]);
+	}
+}
+/* the commands between the prefix and suffix a list shares with the last one sent */
+static void encode_draws(ui_remote r, byte_buffer* b, const draw_list* old, const draw_list* now) {
+	int n0 = old->count, n1 = now->count, keep_front = 0, keep_back = 0;
+	while (keep_front < n0 && keep_front < n1 && cmd_same(old, keep_front, now, keep_front)) keep_front++;
+	while (keep_back < n0 - keep_front && keep_back < n1 - keep_front &&
+			 cmd_same(old, n0 - 1 - keep_back, now, n1 - 1 - keep_back)) keep_back++;
+	int changed = n1 - keep_front - keep_back;
+
+	put_u64(b, now->hash);
+	put_rect(b, now->clip);
+	put_uv(b, keep_front);
+	put_uv(b, keep_back);
+	put_uv(b, changed);
+	draw_cmd prev = keep_front ? now->cmds[keep_front - 1] : (draw_cmd){ 0 };
+	for (int i = keep_front; i < keep_front + changed; ++i) {
+		encode_cmd(r, b, &now->cmds[i], now->text, &prev);
+		prev = now->cmds[i];
+	}
+	r->stats.kept += keep_front + keep_back;
+	r->stats.commands += changed;
+}
+/* records for the modules that differ from what the viewer holds */
+static int encode_records(ui_remote r, byte_buffer* b) {
+	ui_context ctx = r->ctx;
+	int count = List.count(ctx->modules), records = 0;
+	if (count > r->module_capacity) {
+		remote_module* modules = ui_grow(ctx, r->modules, sizeof(remote_module) * r->module_capacity, sizeof(remote_module) * count, ALLOC_REMOTE);
+		if (!modules) return -1;
+		r->modules = modules;
+		r->module_capacity = count;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		remote_module* s = &r->modules[i];
+		struct ui_window_s win = m->win ? *m->win : (struct ui_window_s){ 0 };
+		int has_win = m->win != NULL;
+		r->stats.raw_bytes += sizeof(draw_cmd) * m->draws.count + m->draws.text_count;
+
+		uint8_t mask = 0;
+		if (!s->known) mask = REC_NEW | REC_WINDOW | REC_ENABLED | REC_LAYER | REC_DRAWS;
+		if (has_win != s->has_win || memcmp(&win, &s->win, sizeof(win)) != 0) mask |= REC_WINDOW;
+		if (m->enabled != s->enabled) mask |= REC_ENABLED;
+		if (!layer_same(&m->layer, &s->layer)) mask |= REC_LAYER;
+		if (m->draws.hash != s->draws.hash || m->draws.count != s->draws.count || !rect_same(m->draws.clip, s->draws.clip)) mask |= REC_DRAWS;
+		if (!mask) {
+			r->stats.unchanged++;
+			continue;
+		}
+
+		put_uv(b, i);
+		put_u8(b, mask | (has_win ? 0 : REC_NO_WINDOW));
+		if (mask & REC_NEW) {
+			size_t length = strlen(m->name);
+			put_uv(b, length);
+			put_bytes(b, m->name, length);
+		}
+		if (mask & REC_WINDOW) put_rect(b, (ui_rect){ win.x, win.y, win.width, win.height });
+		if (mask & REC_ENABLED) put_u8(b, (uint8_t)m->enabled);
+		if (mask & REC_LAYER) {
+			put_u8(b, (uint8_t)m->layer.enabled);
+			put_rect(b, (ui_rect){ m->layer.width, m->layer.height, m->layer.scroll_x, m->layer.scroll_y });
+			put_zz(b, m->layer.dx);
+			put_zz(b, m->layer.dy);
+			put_u8(b, m->layer.opacity);
+		}
+		if (mask & REC_DRAWS) {
+			if (!s->known) s->draws.count = 0;		// nothing to keep
+			encode_draws(r, b, &s->draws, &m->draws);
+			if (keep_list(ctx, &s->draws, &m->draws) != 0) return -1;
+		}
+		s->win = win;
+		s->has_win = has_win;
+		s->enabled = m->enabled;
+		s->layer = m->layer;
+		s->known = 1;
+		records++;
+	}
+	r->stats.modules += records;
+
+	return records;
+}
+/* takes a waiting viewer; it is sent everything */
+static void accept_viewer(ui_remote r) {
+	int fd = accept(r->listen_fd, NULL, NULL);
+	if (fd < 0) return;
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	int on = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));		// fails harmlessly on unix sockets
+	r->fd = fd;
+	r->stats.connected = 1;
+	for (int i = 0; i < r->module_capacity; ++i) r->modules[i].known = 0;
+	r->strings_reset = 1;
+	r->input_changed = 0;
+	DBLOG("<Remote> viewer connected on %s", r->address);
+}
+static void apply_input(ui_remote r, byte_reader* in) {
+	uint8_t mask = get_u8(in);
+	ui_input* u = &r->input;
+	if (mask & IN_POINTER) {
+		u->mouse_x += (int)get_zz(in);
+		u->mouse_y += (int)get_zz(in);
+	}
+	if (mask & IN_BUTTONS) u->button = (uint32_t)get_uv(in);
+	if (mask & IN_MODIFIERS) u->modifiers = (uint32_t)get_uv(in);
+	if (mask & IN_KEYS) {
+		int n = (int)get_uv(in);
+		for (int i = 0; i < n && !in->bad; ++i) {
+			uint8_t key = get_u8(in);
+			u->keys[key] = get_u8(in);
+		}
+	}
+	if (in->bad) return;
+	r->input_changed = 1;
+	r->stats.inputs++;
+}
+
+//	Viewer ======================================================================
+static void replay_render(ui_context ctx, ui_module m, ui_input* input) {
+	//	lists come from the server; modules are retained
+}
+static int text_append(ui_context ctx, draw_list* dl, const char* s, uint32_t length) {
+	if (dl->text_count + (int)length > dl->text_capacity) {
+		int grown = dl->text_capacity ? dl->text_capacity * 2 : 256;
+		while (grown < dl->text_count + (int)length) grown *= 2;
+		char* text = ui_grow(ctx, dl->text, dl->text_count, grown, ALLOC_DRAW);
+		if (!text) return -1;
+		dl->text = text;
+		dl->text_capacity = grown;
+	}
+	memcpy(dl->text + dl->text_count, s, length);
+	dl->text_count += length;
+
+	return 0;
+}
+/* copies kept commands (and their text) into the list being built */
+static int keep_cmds(ui_context ctx, draw_list* to, const draw_list* from, int first, int count) {
+	for (int i = first; i < first + count; ++i) {
+		draw_cmd c = from->cmds[i];
+		if (c.kind == DRAW_TEXT) {
+			uint32_t offset = (uint32_t)to->text_count;
+			if (text_append(ctx, to, from->text + c.text, c.length) != 0) return -1;
+			c.text = offset;
+		}
+		to->cmds[to->count++] = c;
+	}
+
+	return 0;
+}
+static int decode_cmd(ui_remote r, byte_reader* in, draw_list* to, const draw_cmd* prev) {
+	uint8_t head = get_u8(in);
+	uint8_t flags = head >> 4;
+	draw_cmd c = { .kind = head & 0x0F, .color = prev->color, .clip = prev->clip };
+	c.rect.x = prev->rect.x + (int)get_zz(in);
+	c.rect.y = prev->rect.y + (int)get_zz(in);
+	c.rect.width = (int)get_zz(in);
+	c.rect.height = (int)get_zz(in);
+	if (flags & CMD_COLOR) c.color = get_u32(in);
+	if (flags & CMD_CLIP) c.clip = get_rect(in);
+	if (flags & CMD_SHAPE) {
+		c.radius = (uint16_t)get_uv(in);
+		c.border = (uint16_t)get_uv(in);
+	}
+	if (c.kind == DRAW_TEXT) {
+		uint64_t id = get_uv(in);
+		c.font = (int32_t)get_zz(in);
+		if (id >= (uint64_t)r->string_count) in->bad = 1;
+		if (in->bad) return -1;
+		const remote_string* s = &r->strings[id];
+		c.text = (uint32_t)to->text_count;
+		c.length = s->length;
+		if (text_append(r->ctx, to, r->arena + s->offset, s->length) != 0) return -1;
+	} else if (c.kind == DRAW_LINE) {
+		for (int i = 0; i < 4; ++i) c.points[i] = (int32_t)get_zz(in);
+	}
+	if (in->bad || c.kind > DRAW_IMAGE) return -1;
+	to->cmds[to->count++] = c;
+
+	return 0;
+}
+/* rebuilds a module's list from the kept commands and the changed ones */
+static int decode_draws(ui_remote r, byte_reader* in, ui_module m) {
+	uint64_t hash = get_u64(in);
+	ui_rect clip = get_rect(in);
+	uint64_t front = get_uv(in), back = get_uv(in), changed = get_uv(in);
+	draw_list* old = &m->draws;
+	if (in->bad || front + back > (uint64_t)old->count || changed > (uint64_t)(in->end - in->p)) return -1;
+
+	draw_list* to = &r->scratch;
+	int count = (int)(front + back + changed);
+	if (count > to->capacity) {
+		draw_cmd* cmds = ui_grow(r->ctx, to->cmds, 0, sizeof(draw_cmd) * count, ALLOC_DRAW);
+		if (!cmds) return -1;
+		to->cmds = cmds;
+		to->capacity = count;
+	}
+	to->count = to->text_count = 0;
+	if (keep_cmds(r->ctx, to, old, 0, (int)front) != 0) return -1;
+	for (uint64_t i = 0; i < changed; ++i) {
+		draw_cmd prev = to->count ? to->cmds[to->count - 1] : (draw_cmd){ 0 };
+		if (decode_cmd(r, in, to, &prev) != 0) return -1;
+	}
+	if (keep_cmds(r->ctx, to, old, old->count - (int)back, (int)back) != 0) return -1;
+
+	//	swap: the module's old buffers become the next scratch
+	draw_list swap = *old;
+	*old = *to;
+	*to = swap;
+	old->hash = hash;
+	old->clip = clip;
+	old->culled = 0;
+	m->stats.commands = old->count;
+	if (m->win) Damage.add(&r->ctx->damage, ui_window_rect(m));
+	r->stats.commands += changed;
+	r->stats.kept += front + back;
+
+	return 0;
+}
+static ui_module replica_module(ui_remote r, int index, uint8_t mask, byte_reader* in) {
+	ui_context ctx = r->ctx;
+	int count = List.count(ctx->modules);
+	if (index < 0 || index > count) return NULL;
+	if (!(mask & REC_NEW)) return index < count ? List.getAt(ctx->modules, index) : NULL;
+
+	char name[REMOTE_NAME_MAX];
+	uint64_t length = get_uv(in);
+	const uint8_t* bytes = get_bytes(in, length);
+	if (!bytes || index != count) return NULL;
+	if (length >= sizeof(name)) length = sizeof(name) - 1;
+	memcpy(name, bytes, length);
+	name[length] = '\0';
+
+	if (index >= r->module_capacity) {
+		int grown = r->module_capacity ? r->module_capacity * 2 : 16;
+		remote_module* modules = ui_grow(ctx, r->modules, sizeof(remote_module) * r->module_capacity, sizeof(remote_module) * grown, ALLOC_REMOTE);
+		if (!modules) return NULL;
+		r->modules = modules;
+		r->module_capacity = grown;
+	}
+	ui_module m = Sigui.add_module(ctx, name, replay_render, NULL, Sigui.new_window(ctx, 0, 0, 0, 0));
+	if (!m || !m->win) return NULL;
+	m->retained = m->recorded = 1;		// Sigui.render keeps the streamed lists
+	r->modules[index] = (remote_module){ .enabled = 1, .has_win = 1 };
+
+	return m;
+}
+static int apply_frame(ui_remote r, byte_reader* in) {
+	ui_context ctx = r->ctx;
+	uint64_t frame = get_uv(in);
+	uint64_t stamp = get_u64(in);
+	uint8_t flags = get_u8(in);
+	get_uv(in);		// module count (records create the new ones)
+
+	//	strings the records introduce
+	if (flags & FRAME_STRINGS_RESET) reset_strings(r);
+	uint64_t strings = get_uv(in);
+	for (uint64_t i = 0; i < strings && !in->bad; ++i) {
+		uint64_t length = get_uv(in);
+		const uint8_t* bytes = get_bytes(in, length);
+		if (bytes && add_string(r, (const char*)bytes, (uint32_t)length, 0) < 0) return -1;
+	}
+
+	uint64_t records = get_uv(in);
+	for (uint64_t i = 0; i < records && !in->bad; ++i) {
+		uint64_t index = get_uv(in);
+		uint8_t mask = get_u8(in);
+		if (in->bad || index > (uint64_t)List.count(ctx->modules)) return -1;
+		ui_module m = replica_module(r, (int)index, mask, in);
+		if (!m) return -1;
+		remote_module* s = &r->modules[index];
+		if (mask & REC_WINDOW) {
+			ui_rect w = get_rect(in);
+			*m->win = (struct ui_window_s){ w.x, w.y, w.width, w.height };
+			s->has_win = !(mask & REC_NO_WINDOW);
+		}
+		if (mask & REC_ENABLED) s->enabled = get_u8(in);
+		if (mask & REC_LAYER) {
+			m->layer.enabled = get_u8(in);
+			ui_rect l = get_rect(in);
+			m->layer.width = l.x;
+			m->layer.height = l.y;
+			m->layer.scroll_x = l.width;
+			m->layer.scroll_y = l.height;
+			m->layer.dx = (int)get_zz(in);
+			m->layer.dy = (int)get_zz(in);
+			m->layer.opacity = get_u8(in);
+			if (m->win) Damage.add(&ctx->damage, ui_module_bounds(m));
+		}
+		m->enabled = s->enabled && s->has_win;
+		if ((mask & REC_DRAWS) && decode_draws(r, in, m) != 0) return -1;
+		r->stats.modules++;
+	}
+	if (in->bad) return -1;
+	r->stats.frames++;
+
+	//	acknowledge: the server measures the round trip
+	begin_message(&r->out, MSG_ACK);
+	put_uv(&r->out, frame);
+	put_u64(&r->out, stamp);
+
+	return finish_message(r, &r->out) < 0 ? -1 : 0;
+}
+
+//	Messages ====================================================================
+/* one complete message; returns 1 for an applied frame */
+static int handle_message(ui_remote r, uint8_t type, byte_reader* in) {
+	if (!r->server) return type == MSG_FRAME ? (apply_frame(r, in) == 0 ? 1 : -1) : 0;
+
+	switch (type) {
+		case MSG_ACK: {
+			get_uv(in);
+			uint64_t stamp = get_u64(in);
+			if (in->bad) break;
+			uint64_t rtt = now_ns() - stamp;
+			r->stats.acks++;
+			r->stats.latency_ns = rtt;
+			r->stats.latency_total_ns += rtt;
+			if (rtt > r->stats.latency_max_ns) r->stats.latency_max_ns = rtt;
+			break;
+		}
+		case MSG_INPUT:
+			apply_input(r, in);
+			break;
+		case MSG_SIZE: {
+			int width = (int)get_uv(in), height = (int)get_uv(in);
+			ui_context ctx = r->ctx;
+			//	callbacks are culled against the viewer's target
+			if (!in->bad && (ctx->viewport.width <= 0 || ctx->viewport.height <= 0)) ctx->viewport = (ui_rect){ 0, 0, width, height };
+			break;
+		}
+	}
+
+	return 0;
+}
+/* reads what is available (waiting up to ms for the first bytes) and handles complete messages */
+static int pump(ui_remote r, int ms) {
+	if (r->server && r->fd < 0 && r->listen_fd >= 0) accept_viewer(r);
+	if (r->fd < 0) return -1;
+
+	struct pollfd pfd = { .fd = r->fd, .events = POLLIN };
+	if (poll(&pfd, 1, ms) <= 0) return 0;
+	while (r->in.size <= REMOTE_HEADER + REMOTE_MESSAGE_MAX) {
+		if (reserve(&r->in, 65536) != 0) return -1;
+		ssize_t n = recv(r->fd, r->in.data + r->in.size, r->in.capacity - r->in.size, MSG_DONTWAIT);
+		if (n > 0) {
+			r->in.size += (size_t)n;
+			r->stats.bytes_in += (size_t)n;
+			continue;
+		}
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		disconnect(r);
+		return -1;
+	}
+
+	int frames = 0;
+	size_t at = 0;
+	while (r->in.size - at >= REMOTE_HEADER) {
+		const uint8_t* h = r->in.data + at;
+		uint32_t length = (uint32_t)h[1] | (uint32_t)h[2] << 8 | (uint32_t)h[3] << 16 | (uint32_t)h[4] << 24;
+		if (length > REMOTE_MESSAGE_MAX) {
+			DBLOG("<Remote> message too long type=%d length=%u", h[0], length);
+			disconnect(r);
+			return -1;
+		}
+		if (r->in.size - at - REMOTE_HEADER < length) break;
+		byte_reader in = { h + REMOTE_HEADER, h + REMOTE_HEADER + length, 0 };
+		int applied = handle_message(r, h[0], &in);
+		if (applied < 0 || r->fd < 0) {
+			DBLOG("<Remote> malformed message type=%d", h[0]);
+			disconnect(r);
+			return -1;
+		}
+		frames += applied;
+		at += REMOTE_HEADER + length;
+	}
+	memmove(r->in.data, r->in.data + at, r->in.size - at);
+	r->in.size -= at;
+
+	return frames;
+}
+static ui_remote new_remote(ui_context ctx, int server) {
+	ui_remote r = ui_alloc(ctx, sizeof(struct ui_remote_s), ALLOC_REMOTE);
+	if (!r) return NULL;
+	r->server = server;
+	r->listen_fd = r->fd = -1;
+	r->ctx = ctx;
+	r->out.ctx = r->body.ctx = r->in.ctx = ctx;
+
+	return r;
+}
+static void release_remote(ui_remote r) {
+	ui_context ctx = r->ctx;
+	if (r->fd >= 0) close(r->fd);
+	if (r->listen_fd >= 0) close(r->listen_fd);
+	if (r->path[0]) unlink(r->path);
+	for (int i = 0; r->server && i < r->module_capacity; ++i) {
+		if (r->modules[i].draws.cmds) ui_free(ctx, r->modules[i].draws.cmds, ALLOC_REMOTE);
+		if (r->modules[i].draws.text) ui_free(ctx, r->modules[i].draws.text, ALLOC_REMOTE);
+	}
+	if (r->modules) ui_free(ctx, r->modules, ALLOC_REMOTE);
+	if (r->strings) ui_free(ctx, r->strings, ALLOC_REMOTE);
+	if (r->string_index) ui_free(ctx, r->string_index, ALLOC_REMOTE);
+	if (r->arena) ui_free(ctx, r->arena, ALLOC_REMOTE);
+	if (r->out.data) ui_free(ctx, r->out.data, ALLOC_REMOTE);
+	if (r->body.data) ui_free(ctx, r->body.data, ALLOC_REMOTE);
+	if (r->in.data) ui_free(ctx, r->in.data, ALLOC_REMOTE);
+	if (r->scratch.cmds) ui_free(ctx, r->scratch.cmds, ALLOC_DRAW);
+	if (r->scratch.text) ui_free(ctx, r->scratch.text, ALLOC_DRAW);
+	ui_free(ctx, r, ALLOC_REMOTE);
+}
+
+//	Remote Interface ============================================================
+static ui_remote serve(ui_context ctx, const string address) {
+	if (!ctx || !address) return NULL;
+
+	ui_remote r = new_remote(ctx, 1);
+	if (!r) return NULL;
+	const char* error = open_socket(r, address, 1);
+	if (error || fcntl(r->listen_fd, F_SETFL, O_NONBLOCK) != 0) {
+		DBLOG("<Remote> cannot serve %s: %s", address, error ? error : "fcntl");
+		release_remote(r);
+		return NULL;
+	}
+	DBLOG("<Remote> serving %s", r->address);
+
+	return r;
+}
+static ui_remote connect_viewer(const string address, int width, int height) {
+	if (!address) return NULL;
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	if (!ctx) return NULL;
+	ui_remote r = new_remote(ctx, 0);
+	if (!r) {
+		Sigui.free_context(ctx);
+		return NULL;
+	}
+	const char* error = open_socket(r, address, 0);
+	if (error) {
+		DBLOG("<Remote> cannot connect %s: %s", address, error);
+		release_remote(r);
+		Sigui.free_context(ctx);
+		return NULL;
+	}
+	r->stats.connected = 1;
+	ctx->viewport = (ui_rect){ 0, 0, width, height };
+
+	begin_message(&r->out, MSG_SIZE);
+	put_uv(&r->out, width > 0 ? width : 0);
+	put_uv(&r->out, height > 0 ? height : 0);
+	finish_message(r, &r->out);
+
+	return r;
+}
+static void free_remote(ui_remote r) {
+	if (!r) return;
+
+	ui_context replica = r->server ? NULL : r->ctx;
+	release_remote(r);
+	if (replica) Sigui.free_context(replica);
+}
+static const string remote_address(ui_remote r) {
+	return r ? r->address : NULL;
+}
+/* server: one frame message with the records that changed */
+static int send_frame(ui_remote r) {
+	if (!r || !r->server) return -1;
+	pump(r, 0);
+	if (r->fd < 0) return 0;
+
+	if (r->string_count >= REMOTE_STRING_MAX) r->strings_reset = 1;
+	uint8_t flags = 0;
+	if (r->strings_reset) {
+		reset_strings(r);
+		flags |= FRAME_STRINGS_RESET;
+		r->strings_reset = 0;
+	}
+	int first_string = r->string_count;
+	r->body.size = 0;
+	r->body.failed = 0;
+	int records = encode_records(r, &r->body);
+	if (records < 0 || r->body.failed) {
+		r->strings_reset = 1;		// the viewer may be out of step: start over
+		for (int i = 0; i < r->module_capacity; ++i) r->modules[i].known = 0;
+		return -1;
+	}
+
+	ui_context ctx = r->ctx;
+	byte_buffer* b = &r->out;
+	begin_message(b, MSG_FRAME);
+	put_uv(b, ++r->frame);
+	put_u64(b, now_ns());
+	put_u8(b, flags);
+	put_uv(b, List.count(ctx->modules));
+	put_uv(b, r->string_count - first_string);
+	for (int i = first_string; i < r->string_count; ++i) {
+		put_uv(b, r->strings[i].length);
+		put_bytes(b, r->arena + r->strings[i].offset, r->strings[i].length);
+	}
+	put_uv(b, records);
+	put_bytes(b, r->body.data, r->body.size);
+
+	int sent = finish_message(r, b);
+	if (sent > 0) r->stats.frames++;
+
+	return sent;
+}
+static int server_input(ui_remote r, ui_input* out) {
+	if (!r || !r->server) return 0;
+	pump(r, 0);
+	if (!r->input_changed) return 0;
+
+	r->input_changed = 0;
+	if (out) *out = r->input;
+	return 1;
+}
+static int receive_frames(ui_remote r, int ms) {
+	if (!r || r->server) return -1;
+
+	int frames = pump(r, ms);
+	if (frames < 0) return -1;
+	//	take whatever else already arrived
+	while (r->fd >= 0) {
+		int more = pump(r, 0);
+		if (more <= 0) break;
+		frames += more;
+	}
+
+	return r->fd < 0 ? -1 : frames;
+}
+static ui_context replica_context(ui_remote r) {
+	return r && !r->server ? r->ctx : NULL;
+}
+static int send_input(ui_remote r, const ui_input* in) {
+	if (!r || r->server || !in) return -1;
+	if (r->fd < 0) return -1;
+
+	ui_input* last = &r->input;
+	int keys = 0;
+	for (int k = 0; k < 256; ++k) keys += in->keys[k] != last->keys[k];
+	uint8_t mask = (in->mouse_x != last->mouse_x || in->mouse_y != last->mouse_y ? IN_POINTER : 0) |
+						(in->button != last->button ? IN_BUTTONS : 0) | (in->modifiers != last->modifiers ? IN_MODIFIERS : 0) |
+						(keys ? IN_KEYS : 0);
+	if (!mask) return 0;
+
+	byte_buffer* b = &r->out;
+	begin_message(b, MSG_INPUT);
+	put_u8(b, mask);
+	if (mask & IN_POINTER) {
+		put_zz(b, (int64_t)in->mouse_x - last->mouse_x);
+		put_zz(b, (int64_t)in->mouse_y - last->mouse_y);
+	}
+	if (mask & IN_BUTTONS) put_uv(b, in->button);
+	if (mask & IN_MODIFIERS) put_uv(b, in->modifiers);
+	if (mask & IN_KEYS) {
+		put_uv(b, keys);
+		for (int k = 0; k < 256; ++k) {
+			if (in->keys[k] == last->keys[k]) continue;
+			put_u8(b, (uint8_t)k);
+			put_u8(b, in->keys[k]);
+		}
+	}
+	int sent = finish_message(r, b);
+	if (sent > 0) {
+		*last = *in;
+		r->stats.inputs++;
+	}
+
+	return sent;
+}
+static void remote_statistics(ui_remote r, remote_stats* out) {
+	if (r && out) *out = r->stats;
+}
+
+/* remote interface */
+const IRemote Remote = {
+	.serve = serve,
+	.connect = connect_viewer,
+	.free = free_remote,
+	.address = remote_address,
+	.send = send_frame,
+	.input = server_input,
+	.receive = receive_frames,
+	.context = replica_context,
+	.send_input = send_input,
+	.stats = remote_statistics
+};
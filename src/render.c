@@ -1,68 +1,130 @@
 // render.c
+#include <pthread.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
 #include "render.h"
+#include "render_core.h"
 #include "sigui_debug.h"
 
 //	Engine State ================================================================
-static SDL_Window* sdl_window = NULL;
-static SDL_GLContext gl_context = NULL;
-//	[TODO] TASK: expand error codes with string messages
-static string ERR_Status = {0};
+/* default target behind the legacy init/module/dispose entry points */
+static render_target default_target = NULL;
+/* SDL is process-wide: count windowed targets holding a reference */
+static int sdl_users = 0;
+static pthread_mutex_t sdl_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//	Private structs =============================================================
+/* CPU pixel canvas (headless framebuffer or layer) */
+typedef struct canvas_s {
+	uint32_t* pixels;
+	int width, height;
+} canvas;
 
 //	Forward Declarations ========================================================
 static int cleanup(const string);
+static void free_target(render_target);
+static void evict_cache(object, module_cache*);
+static void gl_forget(render_target);
 
 /*
- *	Initializes SDL library and instantiates a sdl_window
+ *	Reports a target error and releases its backend resources
  */
-static int init_sdl_window(int width, int height) {
+static int fail_target(render_target t, const string msg) {
+	//	[TODO] TASK: expand error codes with string messages
+	fprintf(stdout, "Error [%s]: %s\n", t->status, msg);
+#ifndef SIMOCK
+	SDL_ClearError();
+#endif
+
+	if (t->gl_context) {
+		SDL_GL_DeleteContext(t->gl_context);
+		t->gl_context = NULL;
+	}
+	if (t->sdl_window) {
+		SDL_DestroyWindow(t->sdl_window);
+		t->sdl_window = NULL;
+	}
+
+	return -1;
+}
+/*
+ *	Takes (or releases) the process-wide SDL reference
+ */
+static int acquire_sdl(void) {
+	int ret = 0;
+	pthread_mutex_lock(&sdl_lock);
+#ifdef SIMOCK
+	if (sdl_users == 0) ret = SDL_Init(0);
+#else
+	if (sdl_users == 0) ret = SDL_Init(SDL_INIT_VIDEO);
+#endif
+	if (ret == 0) sdl_users++;
+	pthread_mutex_unlock(&sdl_lock);
+
+	return ret;
+}
+static void release_sdl(void) {
+	pthread_mutex_lock(&sdl_lock);
+	if (sdl_users > 0 && --sdl_users == 0) SDL_Quit();
+	pthread_mutex_unlock(&sdl_lock);
+}
+/*
+ *	Initializes SDL library and instantiates a sdl_window for a target
+ */
+static int init_sdl_window(render_target t) {
+	int width = t->width, height = t->height;
 	DBLOG("Initializing render engine: width=%d height=%d", width, height);
 
 #ifdef SIMOCK
 	//	mocked SDL initialization
-	if (SDL_Init(0) != 0) {
-		ERR_Status = "SDL_Init";
-		return cleanup("[MOCK] SDL init error");
+	if (acquire_sdl() != 0) {
+		t->status = "SDL_Init";
+		return fail_target(t, "[MOCK] SDL init error");
 	}
-	sdl_window = SDL_CreateWindow("", 0, 0, width, height, 0);
-	if(!sdl_window) {
-		ERR_Status = "SDL_CreateWindow";
-		return cleanup("[MOCK] SDL create window error");
+	t->sdl_ready = 1;
+	t->sdl_window = SDL_CreateWindow("", 0, 0, width, height, 0);
+	if(!t->sdl_window) {
+		t->status = "SDL_CreateWindow";
+		return fail_target(t, "[MOCK] SDL create window error");
 	}
-	gl_context = SDL_GL_CreateContext(sdl_window);
-	if (!gl_context) {
-		ERR_Status = "SDL_GL_CreateContext";
-		return cleanup("[V] GL context error");
+	t->gl_context = SDL_GL_CreateContext(t->sdl_window);
+	if (!t->gl_context) {
+		t->status = "SDL_GL_CreateContext";
+		return fail_target(t, "[V] GL context error");
 	}
 #else
 	//	real SDL initialization
-	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-		ERR_Status = "SDL_Init";
-		return cleanup("[V] window creation error");
+	if (acquire_sdl() != 0) {
+		t->status = "SDL_Init";
+		return fail_target(t, "[V] window creation error");
 	}
-	
+	t->sdl_ready = 1;
+
 	//	create window
-	sdl_window = SDL_CreateWindow(
+	t->sdl_window = SDL_CreateWindow(
 		"sigui",
 		SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
 		width, height,
 		SDL_WINDOW_OPENGL
 	);
-	if(!sdl_window) {
-		ERR_Status = "SDL_CreateWindow";
-		return cleanup((const string)SDL_GetError());
+	if(!t->sdl_window) {
+		t->status = "SDL_CreateWindow";
+		return fail_target(t, (const string)SDL_GetError());
 	}
-	
+
 	//	set OpenGL attributes (2.1 context for simplicity)
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
-	
+
 	//	create OpenGL context
-	gl_context = SDL_GL_CreateContext(sdl_window);
-	if (!gl_context) {
-		ERR_Status = "SDL_GL_CreateContext";
-		return cleanup((const string)SDL_GetError());
+	t->gl_context = SDL_GL_CreateContext(t->sdl_window);
+	if (!t->gl_context) {
+		t->status = "SDL_GL_CreateContext";
+		return fail_target(t, (const string)SDL_GetError());
 	}
-	
+
 	// Set up OpenGL viewport and projection
 	glViewport(0, 0, width, height);
 	glMatrixMode(GL_PROJECTION);
@@ -76,6 +138,150 @@ static int init_sdl_window(int width, int height) {
 	DBLOG("Render engine initialized");
 	return 0;
 }
+/*
+ *	Creates a render target; headless targets own a CPU framebuffer and touch no
+ *	global state, so any number of them can render concurrently
+ */
+static render_target new_target(render_mode mode, int width, int height) {
+	if (width <= 0 || height <= 0) return NULL;
+
+	render_target t = Mem.alloc(sizeof(struct render_target_s));
+	if (!t) return NULL;
+	memset(t, 0, sizeof(struct render_target_s));
+
+	t->mode = mode;
+	t->width = width;
+	t->height = height;
+	//	headless/offscreen framebuffers are retained between frames; SDL does not
+	//	report buffer age, so windowed targets repaint in full whenever anything changed
+	t->buffer_age = mode == RENDER_WINDOW ? 0 : 1;
+	t->layer_budget = LAYER_BUDGET;
+	t->atlas.size = ATLAS_SIZE;
+	t->caches.atlas = &t->atlas;
+	t->caches.tess = &t->tess;
+	t->images.budget = IMAGE_BUDGET;
+	t->images.upload_budget = IMAGE_UPLOAD_BUDGET;
+	t->images.streamed = mode == RENDER_WINDOW;
+	if (mode != RENDER_OFFSCREEN) t->caches.images = &t->images;
+	gl_forget(t);
+
+	if (mode != RENDER_WINDOW) {
+		t->pixels = Mem.alloc(sizeof(uint32_t) * (size_t)width * height);
+		if (!t->pixels) {
+			Mem.free(t);
+			return NULL;
+		}
+		memset(t->pixels, 0, sizeof(uint32_t) * (size_t)width * height);
+	}
+	if (mode == RENDER_OFFSCREEN) {
+		t->core = GLCore.new_offscreen(width, height);
+		if (!t->core) {
+			DBLOG("<Render> offscreen target unavailable: %s", GLCore.error());
+			free_target(t);
+			return NULL;
+		}
+		t->caches.instanced = 1;
+	} else if (mode == RENDER_WINDOW && init_sdl_window(t) != 0) {
+		free_target(t);
+		return NULL;
+	}
+
+	return t;
+}
+/*
+ *	Releases a render target
+ */
+static void free_target(render_target t) {
+	if (!t) return;
+
+	//	dispose cached vertex data and layers (GL objects need the target's context)
+#ifndef SIMOCK
+	if (t->gl_context) SDL_GL_MakeCurrent(t->sdl_window, t->gl_context);
+#endif
+	ModuleCache.clear(&t->caches, evict_cache, t);
+	if (t->order) Mem.free(t->order);
+	if (t->vbo) glDeleteBuffers(1, &t->vbo);
+	if (t->ibo) glDeleteBuffers(1, &t->ibo);
+	if (t->frame_verts) Mem.free(t->frame_verts);
+	Batch.release(&t->batch);
+	Atlas.release(&t->atlas);
+	Tess.release(&t->tess);
+	for (int i = 0; i < t->images.count; ++i) {
+		if (t->images.entries[i].texture) glDeleteTextures(1, &t->images.entries[i].texture);
+	}
+	ImageCache.release(&t->images);
+	if (t->atlas_texture) glDeleteTextures(1, &t->atlas_texture);
+	GLCore.free(t->core);
+
+	//	dispose context
+	if (t->gl_context) {
+		SDL_GL_DeleteContext(t->gl_context);
+		t->gl_context = NULL;
+	}
+	//	dispose sdl_window
+	if (t->sdl_window) {
+		SDL_DestroyWindow(t->sdl_window);
+		t->sdl_window = NULL;
+	}
+	if (t->sdl_ready) release_sdl();
+	if (t->pixels) Mem.free(t->pixels);
+
+	Mem.free(t);
+}
+/*
+ *	Source-over blend of an ARGB color onto an opaque ARGB pixel
+ */
+static inline uint32_t blend_over(uint32_t dst, uint32_t src) {
+	uint32_t a = src >> 24, out = 0xFF000000u;
+	for (int shift = 0; shift < 24; shift += 8) {
+		uint32_t c = ((src >> shift & 0xFF) * a + (dst >> shift & 0xFF) * (255 - a) + 127) / 255;
+		out |= c << shift;
+	}
+
+	return out;
+}
+/* headless framebuffer as a canvas */
+static inline canvas target_canvas(render_target t) {
+	return (canvas){ t->pixels, t->width, t->height };
+}
+/*
+ *	Fills a clipped rectangle in a CPU canvas
+ */
+static void fill_rect(canvas t, int x, int y, int w, int h, uint32_t color) {
+	int x0 = x < 0 ? 0 : x;
+	int y0 = y < 0 ? 0 : y;
+	int x1 = x + w > t.width ? t.width : x + w;
+	int y1 = y + h > t.height ? t.height : y + h;
+	if (x0 >= x1 || y0 >= y1) return;
+
+	uint32_t alpha = color >> 24;
+	if (alpha == 0) return;
+	for (int row = y0; row < y1; ++row) {
+		uint32_t* px = t.pixels + (size_t)row * t.width + x0;
+		if (alpha == 0xFF) {
+			for (int col = x0; col < x1; ++col) *px++ = color;
+			continue;
+		}
+		for (int col = x0; col < x1; ++col, ++px) *px = blend_over(*px, color);
+	}
+}
+/*
+ *	Emits a module window quad on the current GL context
+ */
+static void draw_window_quad(window win) {
+#ifdef SIMOCK
+	glColor3f(1.0f, 1.0f, 1.0f);
+	glBegin(0);		// GL_QUADS
+#else
+	glColor3f(1.0f, 1.0f, 1.0f);
+	glBegin(GL_QUADS);
+#endif
+	glVertex2i(win->x, win->y);
+	glVertex2i(win->x + win->width, win->y);
+	glVertex2i(win->x + win->width, win->y + win->height);
+	glVertex2i(win->x, win->y + win->height);
+	glEnd();
+}
 /*
  *	Render a module
  */
@@ -84,38 +290,1076 @@ static void render_module(ui_module m) {
 		DBLOG("No module or window to render");
 		return;
 	}
-	
+	if (!default_target) {
+		DBLOG("Render engine not initialized");
+		return;
+	}
+
 	window win = m->win;
+	if (!Damage.intersect(ui_window_rect(m), (ui_rect){ 0, 0, default_target->width, default_target->height }, NULL)) {
+		DBLOG("Culled module window outside the viewport");
+		default_target->stats.culled++;
+		return;
+	}
 	DBLOG("Rendering module window at x=%d y=%d w=%d h=%d",
 			win->x, win->y, win->width, win->height);
-			
+
+	if (default_target->mode == RENDER_HEADLESS) {
+		canvas fb = target_canvas(default_target);
+		fill_rect(fb, 0, 0, fb.width, fb.height, COLOR_BLACK);
+		fill_rect(fb, win->x, win->y, win->width, win->height, COLOR_WHITE);
+		default_target->stats.frames++;
+		return;
+	}
+
 #ifdef SIMOCK
 	//	mocked rendering
 	glClear(0);
-	glColor3f(1.0f, 1.0f, 1.0f);
-	glBegin(0);		// GL_QUADS
-	glVertex2i(win->x, win->y);
-	glVertex2i(win->x + win->width, win->y);
-	glVertex2i(win->x + win->width, win->y + win->height);
-	glVertex2i(win->x, win->y + win->height);
-	glEnd();
-	SDL_GL_SwapWindow(sdl_window);
+	draw_window_quad(win);
+	SDL_GL_SwapWindow(default_target->sdl_window);
 #else
 	//	real OpenGL rendering
 	glClear(GL_COLOR_BUFFER_BIT);
-	glColor3f(1.0f, 1.0f, 1.0f);
-	glBegin(GL_QUADS);
-	glVertex2i(win->x, win->y);
-	glVertex2i(win->x + win->width, win->y);
-	glVertex2i(win->x + win->width, win->y + win->height);
-	glVertex2i(win->x, win->y + win->height);
-	glEnd();
-	
+	draw_window_quad(win);
+
 	GLenum err = glGetError();
 	if (err != GL_NO_ERROR) fprintf(stderr, "GL Error: %d\n", err);
-	
-	SDL_GL_SwapWindow(sdl_window);
+
+	SDL_GL_SwapWindow(default_target->sdl_window);
+#endif
+	default_target->stats.frames++;
+}
+/*
+ *	Collects this frame's damage: explicit invalidations plus every module whose
+ *	on-screen rect moved, resized, or was enabled/disabled since the last presented frame
+ */
+static void collect_damage(render_target t, ui_context ctx, damage_set* ds) {
+	Damage.merge(ds, &ctx->damage);
+	if (!t->presented) Damage.all(ds);
+
+	int count = List.count(ctx->modules);
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		int enabled = m->enabled && m->win;
+		ui_rect now = enabled ? ui_module_bounds(m) : m->drawn;
+
+		if (enabled == m->drawn_enabled && (!enabled || memcmp(&now, &m->drawn, sizeof(ui_rect)) == 0)) continue;
+		if (m->drawn_enabled) Damage.add(ds, m->drawn);
+		if (enabled) Damage.add(ds, now);
+	}
+}
+/*
+ *	Expands this frame's damage by the damage of the frames the back buffer missed
+ */
+static void repair_damage(render_target t, damage_set* ds) {
+	if (t->buffer_age <= 0 || t->buffer_age > DAMAGE_HISTORY) {
+		Damage.all(ds);
+		return;
+	}
+
+	//	an age-N buffer missed the N-1 most recent presented frames
+	int back = 0;
+	while (back < t->buffer_age - 1) {
+		int slot = (t->history_head - back + DAMAGE_HISTORY) % DAMAGE_HISTORY;
+		Damage.merge(ds, &t->history[slot]);
+		++back;
+	}
+}
+/*
+ *	Blends a color through glyph coverage (atlas texels mapped 1:1 onto `r`)
+ */
+static void fill_glyph(canvas t, ui_rect r, const uint8_t* coverage, int stride, uint32_t color) {
+	uint32_t alpha = color >> 24, rgb = color & 0xFFFFFF;
+	for (int row = 0; row < r.height; ++row) {
+		const uint8_t* src = coverage + (size_t)row * stride;
+		uint32_t* px = t.pixels + (size_t)(r.y + row) * t.width + r.x;
+		for (int col = 0; col < r.width; ++col, ++px) {
+			uint32_t a = (src[col] * alpha + 127) / 255;
+			if (a) *px = blend_over(*px, a << 24 | rgb);
+		}
+	}
+}
+/*
+ *	Draws the part of an image quad inside a clip rect, sampling the decoded
+ *	pixels nearest to each pixel center (uv: image coordinates of the quad corners)
+ */
+static void fill_image(canvas t, ui_rect clip, ui_rect quad, const ui_vertex* v, ui_image image) {
+	int w, h, opaque;
+	const uint32_t* src = Images.pixels(image, &w, &h, &opaque);
+	if (!src) return;
+
+	//	16.16 fixed point source positions
+	int64_t du = (int64_t)((v[2].u - v[0].u) * w * 65536.0f) / quad.width;
+	int64_t dv = (int64_t)((v[2].v - v[0].v) * h * 65536.0f) / quad.height;
+	int64_t u0 = (int64_t)(v[0].u * w * 65536.0f) + du * (clip.x - quad.x) + du / 2;
+	int64_t sv = (int64_t)(v[0].v * h * 65536.0f) + dv * (clip.y - quad.y) + dv / 2;
+	for (int row = 0; row < clip.height; ++row, sv += dv) {
+		int sy = (int)(sv >> 16);
+		const uint32_t* line = src + (size_t)(sy < h ? sy : h - 1) * w;
+		uint32_t* px = t.pixels + (size_t)(clip.y + row) * t.width + clip.x;
+		int64_t su = u0;
+		for (int col = 0; col < clip.width; ++col, ++px, su += du) {
+			int sx = (int)(su >> 16);
+			uint32_t c = line[sx < w ? sx : w - 1];
+			*px = opaque || c >> 24 == 0xFF ? c : blend_over(*px, c);
+		}
+	}
+	Images.release(image);
+}
+/* edge function of p against a -> b (positive on the left in screen space) */
+static inline float edge(const ui_vertex* a, const ui_vertex* b, float x, float y) {
+	return (b->x - a->x) * (y - a->y) - (b->y - a->y) * (x - a->x);
+}
+/* top-left fill rule: pixels exactly on an edge belong to top and left edges only */
+static inline int edge_owns(const ui_vertex* a, const ui_vertex* b) {
+	float dx = b->x - a->x, dy = b->y - a->y;
+
+	return dy < 0 || (dy == 0 && dx > 0);
+}
+/* ceil/floor of a float in pixel range without a libm call */
+static inline int ceil_int(float v) {
+	int i = (int)v;
+	return i + (v > i);
+}
+static inline int floor_int(float v) {
+	int i = (int)v;
+	return i - (v < i);
+}
+/* a pixel center's edge values lie inside (ties: owned edges only) */
+static inline int covers(const float* w, const int* own) {
+	for (int e = 0; e < 3; ++e) {
+		if (w[e] < 0 || (w[e] == 0 && !own[e])) return 0;
+	}
+
+	return 1;
+}
+/*
+ *	Blends one triangle sampled at pixel centers, alpha interpolated across it,
+ *	inside a clip rect
+ */
+static void fill_triangle(canvas t, const ui_vertex* a, const ui_vertex* b, const ui_vertex* c, ui_rect clip) {
+	float area = edge(a, b, c->x, c->y);
+	if (area == 0) return;
+	if (area < 0) {
+		const ui_vertex* swap = b;
+		b = c;
+		c = swap;
+		area = -area;
+	}
+
+	int x0 = floor_int(fminf(a->x, fminf(b->x, c->x))), x1 = ceil_int(fmaxf(a->x, fmaxf(b->x, c->x)));
+	int y0 = floor_int(fminf(a->y, fminf(b->y, c->y))), y1 = ceil_int(fmaxf(a->y, fmaxf(b->y, c->y)));
+	ui_rect box;
+	if (!Damage.intersect(clip, (ui_rect){ x0, y0, x1 - x0, y1 - y0 }, &box)) return;
+
+	//	edge functions (A x + B y + C, inside >= 0) and alpha are planes
+	const ui_vertex* from[3] = { b, c, a };
+	const ui_vertex* to[3] = { c, a, b };
+	const ui_vertex* weight[3] = { a, b, c };
+	float A[3], B[3], C[3], inv[3];
+	int own[3];
+	float alpha_x = 0, alpha_y = 0, alpha_c = 0;
+	for (int e = 0; e < 3; ++e) {
+		A[e] = from[e]->y - to[e]->y;
+		B[e] = to[e]->x - from[e]->x;
+		C[e] = -(A[e] * from[e]->x + B[e] * from[e]->y);
+		inv[e] = A[e] != 0 ? 1.0f / A[e] : 0;
+		own[e] = edge_owns(from[e], to[e]);
+		float wa = weight[e]->rgba[3] / area;
+		alpha_x += A[e] * wa;
+		alpha_y += B[e] * wa;
+		alpha_c += C[e] * wa;
+	}
+	uint32_t rgb = (uint32_t)a->rgba[0] << 16 | (uint32_t)a->rgba[1] << 8 | a->rgba[2];
+	for (int y = box.y; y < box.y + box.height; ++y) {
+		float py = y + 0.5f;
+		float row[3] = { B[0] * py + C[0], B[1] * py + C[1], B[2] * py + C[2] };
+
+		//	narrow the row to the pixel centers the edges allow; a horizontal edge
+		//	rejects or keeps the whole row
+		int x0 = box.x, x1 = box.x + box.width;
+		for (int e = 0; e < 3; ++e) {
+			if (A[e] == 0) {
+				if (row[e] < 0 || (row[e] == 0 && !own[e])) x1 = x0;
+				continue;
+			}
+			float cross = -row[e] * inv[e] - 0.5f;		// pixel index of the edge crossing
+			if (cross < x0 - 1 || cross > x1 + 1) {
+				if ((A[e] > 0) == (cross > x1 + 1)) x1 = x0;		// the row lies outside this edge
+				continue;
+			}
+			if (A[e] > 0) {
+				int first = ceil_int(cross - 0.01f);
+				if (first > x0) x0 = first;
+			} else {
+				int end = floor_int(cross + 0.01f) + 1;
+				if (end < x1) x1 = end;
+			}
+		}
+		if (x0 >= x1) continue;
+
+		//	only the end pixels can sit on (or within rounding of) an edge
+		float w[3];
+		for (int e = 0; e < 3; ++e) w[e] = A[e] * (x0 + 0.5f) + row[e];
+		if (!covers(w, own) && ++x0 >= x1) continue;
+		for (int e = 0; e < 3; ++e) w[e] = A[e] * (x1 - 0.5f) + row[e];
+		if (!covers(w, own) && --x1 <= x0) continue;
+
+		float alpha = alpha_x * (x0 + 0.5f) + alpha_y * py + alpha_c + 0.5f;
+		uint32_t* px = t.pixels + (size_t)y * t.width + x0;
+		for (int x = x0; x < x1; ++x, ++px, alpha += alpha_x) {
+			if (alpha < 1.0f) continue;
+			uint32_t al = alpha >= 255.0f ? 255 : (uint32_t)alpha;
+			*px = al == 255 ? 0xFF000000u | rgb : blend_over(*px, al << 24 | rgb);
+		}
+	}
+}
+/*
+ *	Rasterizes a module's cached quads and meshes inside a clip rect (headless)
+ */
+static void draw_cache_headless(canvas dst, const module_cache* mc, ui_rect r, const glyph_atlas* atlas) {
+	ui_rect bounds;
+	if (!Damage.intersect(r, (ui_rect){ 0, 0, dst.width, dst.height }, &bounds)) return;
+
+	int s = 0, k = 0, q = 0;
+	while (q + 3 < mc->count) {
+		if (s < mc->mesh_count && mc->meshes[s].first == q) {
+			const mesh_span* span = &mc->meshes[s++];
+			q += span->count;
+			ui_rect clip;
+			if (!Damage.intersect(bounds, span->bounds, &clip)) continue;
+			const uint32_t* tri = mc->tris + span->index;
+			for (int i = 0; i + 2 < span->indices; i += 3) {
+				fill_triangle(dst, &mc->verts[tri[i]], &mc->verts[tri[i + 1]], &mc->verts[tri[i + 2]], clip);
+			}
+			continue;
+		}
+		const ui_vertex* v = &mc->verts[q];
+		ui_image image = k < mc->image_count && mc->images[k].first == q ? mc->images[k++].image : 0;
+		q += 4;
+		ui_rect quad = { (int)v[0].x, (int)v[0].y, (int)(v[2].x - v[0].x), (int)(v[2].y - v[0].y) };
+		ui_rect clip;
+		if (!Damage.intersect(r, quad, &clip) || !Damage.intersect(clip, (ui_rect){ 0, 0, dst.width, dst.height }, &clip)) continue;
+		if (image) {
+			fill_image(dst, clip, quad, v, image);
+			continue;
+		}
+
+		uint32_t argb = (uint32_t)v->rgba[3] << 24 | (uint32_t)v->rgba[0] << 16 |
+							 (uint32_t)v->rgba[1] << 8 | v->rgba[2];
+		if (v->u < 0) {
+			fill_rect(dst, clip.x, clip.y, clip.width, clip.height, argb);
+			continue;
+		}
+		if (!atlas->pixels) continue;
+		int ax = (int)(v->u * atlas->size + 0.5f) + clip.x - quad.x;
+		int ay = (int)(v->v * atlas->size + 0.5f) + clip.y - quad.y;
+		fill_glyph(dst, clip, atlas->pixels + (size_t)ay * atlas->size + ax, atlas->size, argb);
+	}
+}
+/*
+ *	Redundant-state filter: GL calls are issued only when the cached state differs
+ */
+static int gl_changed(render_target t, int same) {
+	if (same) {
+		t->stats.state_avoided++;
+#ifdef SIMOCK
+		mock_gl_state_avoided++;
+#endif
+		return 0;
+	}
+	t->stats.state_changes++;
+
+	return 1;
+}
+static void gl_cap(render_target t, GLenum cap, GLuint* cached, GLuint on) {
+	if (!gl_changed(t, *cached == on)) return;
+
+	*cached = on;
+	if (on) glEnable(cap);
+	else glDisable(cap);
+}
+static void gl_bind_buffer(render_target t, GLenum target, GLuint* cached, GLuint buffer) {
+	if (!gl_changed(t, *cached == buffer)) return;
+
+	*cached = buffer;
+	glBindBuffer(target, buffer);
+}
+static void gl_bind_texture(render_target t, GLuint texture) {
+	if (!gl_changed(t, t->gl.texture == texture)) return;
+
+	t->gl.texture = texture;
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+static void gl_scissor(render_target t, ui_rect r) {
+	ui_rect box = { r.x, t->height - r.y - r.height, r.width, r.height };
+	if (!gl_changed(t, memcmp(&t->gl.scissor_rect, &box, sizeof(ui_rect)) == 0)) return;
+
+	t->gl.scissor_rect = box;
+	glScissor(box.x, box.y, box.width, box.height);
+}
+static void gl_color(render_target t, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+	uint32_t rgba = (uint32_t)r << 24 | (uint32_t)g << 16 | (uint32_t)b << 8 | a;
+	if (!gl_changed(t, t->gl.color_known && t->gl.color == rgba)) return;
+
+	t->gl.color = rgba;
+	t->gl.color_known = 1;
+	glColor4ub(r, g, b, a);
+}
+/* forgets all cached GL state (e.g. after foreign GL code ran) */
+static void gl_forget(render_target t) {
+	t->gl = (gl_state){ GL_UNKNOWN, GL_UNKNOWN, GL_UNKNOWN, GL_UNKNOWN, GL_UNKNOWN, GL_UNKNOWN };
+}
+/*
+ *	Draws an index range of the frame buffers (OpenGL)
+ */
+static void draw_indexed_gl(int first, int count) {
+	glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)(sizeof(uint32_t) * (size_t)first));
+}
+/* content run kind of the quad or mesh starting at vertex v (0=flat, 1=glyph, 2=mesh, 3=image) */
+static int content_kind(const module_cache* mc, int s, int k, int v) {
+	if (s < mc->mesh_count && mc->meshes[s].first == v) return 2;
+	if (k < mc->image_count && mc->images[k].first == v) return 3;
+
+	return mc->verts[v].u >= 0;
+}
+/* texture of a drawable image (0=not resident) */
+static GLuint image_texture(render_target t, ui_image image) {
+	image_entry* e = ImageCache.find(&t->images, image);
+
+	return e && e->rows == e->height ? e->texture : 0;
+}
+/*
+ *	Draws a layered module's content range in runs of flat quads, glyph quads and
+ *	meshes; image quads are drawn one by one (OpenGL)
+ */
+static void draw_content_gl(render_target t, const module_cache* mc) {
+	int s = 0, k = 0, v = 0, index = mc->index_first;
+	while (v < mc->count) {
+		int kind = content_kind(mc, s, k, v);
+		int first = index;
+		GLuint texture = t->atlas_texture;
+		while (v < mc->count && content_kind(mc, s, k, v) == kind) {
+			if (kind == 2) {
+				index += mc->meshes[s].indices;
+				v += mc->meshes[s++].count;
+				continue;
+			}
+			index += 6;
+			v += 4;
+			if (kind == 3) {
+				texture = image_texture(t, mc->images[k++].image);
+				break;
+			}
+		}
+		if (kind == 3 && !texture) continue;
+
+		gl_cap(t, GL_BLEND, &t->gl.blend, kind != 0);
+		gl_cap(t, GL_TEXTURE_2D, &t->gl.texture_2d, kind == 1 || kind == 3);
+		if (kind == 1 || kind == 3) gl_bind_texture(t, texture);
+		draw_indexed_gl(first, index - first);
+	}
+}
+/*
+ *	Uploads the glyph atlas: whole when the texture is new, otherwise only its
+ *	dirty sub-rectangles (OpenGL)
+ */
+static void upload_atlas_gl(render_target t) {
+	glyph_atlas* a = &t->atlas;
+	if (!a->pixels) return;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (!t->atlas_uploaded) {
+		if (!t->atlas_texture) glGenTextures(1, &t->atlas_texture);
+		gl_bind_texture(t, t->atlas_texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, a->size, a->size, 0, GL_ALPHA, GL_UNSIGNED_BYTE, a->pixels);
+		t->atlas_uploaded = 1;
+		t->stats.atlas_uploads++;
+		t->stats.atlas_upload_bytes += (size_t)a->size * a->size;
+	} else if (a->dirty.count) {
+		gl_bind_texture(t, t->atlas_texture);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, a->size);
+		for (int i = 0; i < a->dirty.count; ++i) {
+			ui_rect r = a->dirty.rects[i];
+			glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.width, r.height, GL_ALPHA, GL_UNSIGNED_BYTE,
+								 a->pixels + (size_t)r.y * a->size + r.x);
+			t->stats.atlas_uploads++;
+			t->stats.atlas_upload_bytes += (size_t)r.width * r.height;
+		}
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+	Damage.clear(&a->dirty);
+}
+/*
+ *	Releases a module's layer storage
+ */
+static void release_layer(render_target t, module_cache* mc) {
+	layer_cache* lc = &mc->layer;
+	if (!lc->bytes) return;
+
+	if (lc->pixels) Mem.free(lc->pixels);
+	if (lc->fbo) glDeleteFramebuffers(1, &lc->fbo);
+	if (lc->texture) {
+		glDeleteTextures(1, &lc->texture);
+		if (t->gl.texture == lc->texture) t->gl.texture = 0;		// deleting unbinds
+	}
+	t->stats.layers--;
+	t->stats.layer_bytes -= lc->bytes;
+	*lc = (layer_cache){0};
+}
+/* releases a cache entry's layer (GL context must be current) */
+static void evict_cache(object user, module_cache* mc) {
+	release_layer(user, mc);
+}
+/*
+ *	Evicts least recently used layers (not needed this frame) until `bytes` fit;
+ *	the layers of the current frame are always kept, even over budget
+ */
+static void reserve_layer(render_target t, size_t bytes, uint64_t frame) {
+	while (t->stats.layer_bytes + bytes > t->layer_budget) {
+		module_cache* lru = NULL;
+		for (int i = 0; i < t->caches.count; ++i) {
+			module_cache* mc = &t->caches.entries[i];
+			if (!mc->layer.bytes || mc->layer.used >= frame) continue;
+			if (!lru || mc->layer.used < lru->layer.used) lru = mc;
+		}
+		if (!lru) return;
+
+		DBLOG("<Render> evicting layer (%dx%d)", lru->layer.width, lru->layer.height);
+		release_layer(t, lru);
+		t->stats.layer_evictions++;
+	}
+}
+/*
+ *	Allocates layer storage for the entry's layer rect
+ */
+static int alloc_layer(render_target t, module_cache* mc) {
+	layer_cache* lc = &mc->layer;
+	int w = mc->transform.width, h = mc->transform.height;
+	size_t bytes = sizeof(uint32_t) * (size_t)w * h;
+
+	if (t->mode == RENDER_HEADLESS) {
+		lc->pixels = Mem.alloc(bytes);
+		if (!lc->pixels) return -1;
+	} else {
+		glGenTextures(1, &lc->texture);
+		gl_bind_texture(t, lc->texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glGenFramebuffers(1, &lc->fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, lc->fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lc->texture, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	lc->width = w;
+	lc->height = h;
+	lc->bytes = bytes;
+	t->stats.layers++;
+	t->stats.layer_bytes += bytes;
+
+	return 0;
+}
+/*
+ *	Brings a layered module's layer up to date; it is re-rendered only when its
+ *	draw list or size changed since it was last rendered (or it was evicted)
+ */
+static void update_layer(render_target t, module_cache* mc, uint64_t frame) {
+	layer_cache* lc = &mc->layer;
+	int w = mc->transform.width, h = mc->transform.height;
+	lc->used = frame;
+	if (lc->bytes && lc->hash == mc->hash && lc->width == w && lc->height == h) return;
+
+	if (lc->bytes && (lc->width != w || lc->height != h)) release_layer(t, mc);
+	if (!lc->bytes) {
+		reserve_layer(t, sizeof(uint32_t) * (size_t)w * h, frame);
+		if (alloc_layer(t, mc) != 0) return;
+		lc->used = frame;
+	}
+
+	if (t->mode == RENDER_HEADLESS) {
+		draw_cache_headless((canvas){ lc->pixels, w, h }, mc, mc->transform, &t->atlas);
+	} else {
+		//	layer space is y-up so texture rows match the composite's coordinates
+		glBindFramebuffer(GL_FRAMEBUFFER, lc->fbo);
+		glViewport(0, 0, w, h);
+#ifndef SIMOCK
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		glLoadIdentity();
+		glOrtho(0, w, 0, h, -1, 1);
+#endif
+		gl_cap(t, GL_SCISSOR_TEST, &t->gl.scissor, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
+		draw_content_gl(t, mc);
+#ifndef SIMOCK
+		glPopMatrix();
+		glMatrixMode(GL_MODELVIEW);
+#endif
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, t->width, t->height);
+	}
+	lc->hash = mc->hash;
+	t->stats.layer_renders++;
+}
+/*
+ *	Composites a layer inside a clip rect: a blit at the scroll offset, blended
+ *	by the layer opacity (headless)
+ */
+static void composite_layer_headless(canvas dst, const module_cache* mc, ui_rect r) {
+	ui_module m = mc->key;
+	const layer_cache* lc = &mc->layer;
+	ui_rect bounds = ui_module_bounds(m);
+	ui_rect clip;
+	if (!lc->bytes || !Damage.intersect(r, bounds, &clip)) return;
+
+	//	source columns covered by the layer
+	int sx = clip.x - bounds.x + m->layer.scroll_x;
+	int x0 = clip.x + (sx < 0 ? -sx : 0);
+	int x1 = clip.x + clip.width;
+	if (sx + clip.width > lc->width) x1 -= sx + clip.width - lc->width;
+	if (x0 >= x1) return;
+
+	uint32_t alpha = (uint32_t)m->layer.opacity << 24;
+	for (int row = clip.y; row < clip.y + clip.height; ++row) {
+		int sy = row - bounds.y + m->layer.scroll_y;
+		if (sy < 0 || sy >= lc->height) continue;
+
+		const uint32_t* src = lc->pixels + (size_t)sy * lc->width + (x0 - bounds.x + m->layer.scroll_x);
+		uint32_t* px = dst.pixels + (size_t)row * dst.width + x0;
+		if (m->layer.opacity == 0xFF) {
+			memcpy(px, src, sizeof(uint32_t) * (x1 - x0));
+			continue;
+		}
+		for (int col = x0; col < x1; ++col, ++px, ++src) *px = blend_over(*px, alpha | (*src & 0xFFFFFF));
+	}
+}
+/*
+ *	Composites a layer texture at the scroll offset with the layer opacity (OpenGL)
+ */
+static void composite_layer_gl(render_target t, const module_cache* mc) {
+	ui_module m = mc->key;
+	const layer_cache* lc = &mc->layer;
+	if (!lc->bytes) return;
+
+	ui_rect b = ui_module_bounds(m);
+	float u0 = (float)m->layer.scroll_x / lc->width;
+	float v0 = (float)m->layer.scroll_y / lc->height;
+	float u1 = (float)(m->layer.scroll_x + b.width) / lc->width;
+	float v1 = (float)(m->layer.scroll_y + b.height) / lc->height;
+
+	gl_bind_texture(t, lc->texture);
+	gl_color(t, 0xFF, 0xFF, 0xFF, m->layer.opacity);
+#ifdef SIMOCK
+	glBegin(0);		// GL_QUADS
+#else
+	glBegin(GL_QUADS);
 #endif
+	glTexCoord2f(u0, v0);
+	glVertex2i(b.x, b.y);
+	glTexCoord2f(u1, v0);
+	glVertex2i(b.x + b.width, b.y);
+	glTexCoord2f(u1, v1);
+	glVertex2i(b.x + b.width, b.y + b.height);
+	glTexCoord2f(u0, v1);
+	glVertex2i(b.x, b.y + b.height);
+	glEnd();
+}
+/*
+ *	Gathers the drawn modules' vertices into the frame vertex buffer; only the
+ *	rebuilt modules are uploaded unless the layout (order, sizes) changed
+ */
+static int gather_vertices(render_target t, int n) {
+	uint64_t layout = UI_FNV_OFFSET;
+	for (int j = 0; j < n; ++j) {
+		layout = ui_fnv1a(layout, &t->order[j]->key, sizeof(ui_module));
+		layout = ui_fnv1a(layout, &t->order[j]->count, sizeof(int));
+	}
+	if (!t->vbo) glGenBuffers(1, &t->vbo);
+	gl_bind_buffer(t, GL_ARRAY_BUFFER, &t->gl.array_buffer, t->vbo);
+
+	if (layout != t->frame_layout) {
+		int total = 0;
+		for (int j = 0; j < n; ++j) total += t->order[j]->count;
+		if (total > t->frame_capacity) {
+			ui_vertex* verts = Mem.alloc(sizeof(ui_vertex) * total);
+			if (!verts) return -1;
+			if (t->frame_verts) Mem.free(t->frame_verts);
+			t->frame_verts = verts;
+			t->frame_capacity = total;
+		}
+		t->frame_count = 0;
+		for (int j = 0; j < n; ++j) {
+			module_cache* mc = t->order[j];
+			mc->base = t->frame_count;
+			memcpy(t->frame_verts + mc->base, mc->verts, sizeof(ui_vertex) * mc->count);
+			mc->uploaded = 1;
+			t->frame_count += mc->count;
+		}
+		glBufferData(GL_ARRAY_BUFFER, (long)sizeof(ui_vertex) * t->frame_count, t->frame_verts, GL_DYNAMIC_DRAW);
+		t->frame_layout = layout;
+		return 0;
+	}
+
+	for (int j = 0; j < n; ++j) {
+		module_cache* mc = t->order[j];
+		if (mc->uploaded) continue;
+		memcpy(t->frame_verts + mc->base, mc->verts, sizeof(ui_vertex) * mc->count);
+		glBufferSubData(GL_ARRAY_BUFFER, (long)sizeof(ui_vertex) * mc->base,
+							 (long)sizeof(ui_vertex) * mc->count, mc->verts);
+		mc->uploaded = 1;
+	}
+
+	return 0;
+}
+/*
+ *	Sorts and merges the frame's draws when any state key or bound changed, and
+ *	uploads the resulting indices
+ */
+static int batch_frame(render_target t, int n) {
+	uint64_t keys = t->frame_layout;
+	for (int j = 0; j < n; ++j) {
+		module_cache* mc = t->order[j];
+		ui_module m = mc->key;
+		keys = ui_fnv1a(keys, &mc->hash, sizeof(uint64_t));
+		keys = ui_fnv1a(keys, &mc->transform, sizeof(ui_rect));
+		keys = ui_fnv1a(keys, &mc->atlas_stamp, sizeof(uint64_t));
+		if (!m->layer.enabled) continue;
+		ui_rect b = ui_module_bounds(m);
+		keys = ui_fnv1a(keys, &b, sizeof(ui_rect));
+		keys = ui_fnv1a(keys, &m->layer.opacity, sizeof(uint8_t));
+		keys = ui_fnv1a(keys, &mc->layer.texture, sizeof(GLuint));
+	}
+	keys = ui_fnv1a(keys, &t->atlas_texture, sizeof(GLuint));
+	keys = ui_fnv1a(keys, &t->images.stamp, sizeof(uint64_t));
+	if (!t->ibo) glGenBuffers(1, &t->ibo);
+	gl_bind_buffer(t, GL_ELEMENT_ARRAY_BUFFER, &t->gl.element_buffer, t->ibo);
+	if (keys == t->frame_keys) return 0;
+
+	batch_set* bs = &t->batch;
+	Batch.reset(bs);
+	for (int j = 0; j < n; ++j) {
+		module_cache* mc = t->order[j];
+		if (!mc->key->layer.enabled) continue;
+		mc->index_first = Batch.content(bs, mc);
+		if (mc->index_first < 0) return -1;
+		mc->index_count = bs->index_count - mc->index_first;
+	}
+	for (int j = 0; j < n; ++j) {
+		module_cache* mc = t->order[j];
+		ui_module m = mc->key;
+		if (m->layer.enabled) {
+			if (Batch.layer(bs, mc, ui_module_bounds(m), m->layer.opacity != 0xFF) != 0) return -1;
+			continue;
+		}
+		int s = 0, k = 0, q = 0;
+		while (q + 3 < mc->count) {
+			if (s < mc->mesh_count && mc->meshes[s].first == q) {
+				const mesh_span* span = &mc->meshes[s++];
+				if (Batch.mesh(bs, mc->tris + span->index, span->indices, mc->base, span->bounds) != 0) return -1;
+				q += span->count;
+				continue;
+			}
+			const ui_vertex* v = &mc->verts[q];
+			ui_rect quad = { (int)v[0].x, (int)v[0].y, (int)(v[2].x - v[0].x), (int)(v[2].y - v[0].y) };
+			if (k < mc->image_count && mc->images[k].first == q) {
+				image_entry* e = ImageCache.find(&t->images, mc->images[k++].image);
+				if (e && e->rows == e->height && Batch.quads(bs, e->texture, mc->base + q, 1, quad, !e->opaque) != 0) return -1;
+				q += 4;
+				continue;
+			}
+			int glyph = v->u >= 0;
+			if (Batch.quads(bs, glyph ? t->atlas_texture : 0, mc->base + q, 1, quad, glyph || v->rgba[3] != 0xFF) != 0) return -1;
+			q += 4;
+		}
+	}
+	if (Batch.build(bs) != 0) return -1;
+
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (long)sizeof(uint32_t) * bs->index_count, bs->indices, GL_DYNAMIC_DRAW);
+	t->frame_keys = keys;
+
+	return 0;
+}
+/*
+ *	Submits the merged batches that touch one damage region (OpenGL)
+ */
+static void draw_region_gl(render_target t, ui_rect r) {
+	const batch_set* bs = &t->batch;
+	for (int i = 0; i < bs->count; ++i) {
+		const draw_batch* b = &bs->batches[i];
+		if (!Damage.intersect(r, b->bounds, NULL)) continue;
+
+		gl_cap(t, GL_BLEND, &t->gl.blend, b->blend ? 1 : 0);
+		gl_cap(t, GL_TEXTURE_2D, &t->gl.texture_2d, b->texture ? 1 : 0);
+		if (b->layer) {
+			composite_layer_gl(t, b->layer);
+			continue;
+		}
+		if (b->texture) gl_bind_texture(t, b->texture);
+		draw_indexed_gl(b->first, b->count);
+	}
+	t->stats.batches = bs->count;
+}
+/*
+ *	Prepares the vertex caches of every visible (not culled) module, in draw order
+ */
+static int prepare_modules(render_target t, ui_context ctx, uint64_t frame) {
+	int count = List.count(ctx->modules);
+	if (count > t->order_capacity) {
+		module_cache** order = Mem.alloc(sizeof(module_cache*) * count);
+		if (!order) return 0;
+		if (t->order) Mem.free(t->order);
+		t->order = order;
+		t->order_capacity = count;
+	}
+
+	//	culled modules get no vertex work; their cached vertices are kept
+	int outside = 0, covered = 0;
+	Cull.modules(ctx, (ui_rect){ 0, 0, t->width, t->height }, &outside, &covered);
+	t->stats.culled = outside + covered;
+
+	//	prepare first: inserting may move entries
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		if (!m->enabled || !m->win) continue;
+		if (!m->culled) {
+			ModuleCache.prepare(&t->caches, m, frame);
+			continue;
+		}
+		module_cache* mc = ModuleCache.find(&t->caches, m);
+		if (mc) mc->seen = frame;
+	}
+	int n = 0;
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		if (!m->enabled || !m->win || m->culled) continue;
+		module_cache* mc = ModuleCache.find(&t->caches, m);
+		if (mc) t->order[n++] = mc;
+	}
+	t->stats.drawn = n;
+
+	return n;
+}
+/*
+ *	Draws the frame from the modules' cached instances: one copy per module into
+ *	the instance ring, one instanced draw per damage region, then the regions are
+ *	read back into the framebuffer (GL core)
+ */
+static int draw_frame_core(render_target t, int n, const damage_set* redraw, int full) {
+	int total = 0;
+	for (int j = 0; j < n; ++j) total += t->order[j]->inst_count;
+	if (GLCore.make_current(t->core) != 0) return -1;
+
+	glyph_atlas* a = &t->atlas;
+	if (a->pixels && !t->atlas_uploaded) {
+		GLCore.atlas(t->core, a->pixels, a->size, NULL, 0);
+		t->atlas_uploaded = 1;
+		t->stats.atlas_uploads++;
+		t->stats.atlas_upload_bytes += (size_t)a->size * a->size;
+	} else if (a->pixels && a->dirty.count) {
+		GLCore.atlas(t->core, a->pixels, a->size, a->dirty.rects, a->dirty.count);
+		t->stats.atlas_uploads += a->dirty.count;
+		t->stats.atlas_upload_bytes += Damage.area(&a->dirty);
+	}
+	Damage.clear(&a->dirty);
+
+	gl_instance* dst = GLCore.map(t->core, total);
+	if (!dst) return -1;
+	for (int j = 0; j < n; ++j) {
+		const module_cache* mc = t->order[j];
+		memcpy(dst, mc->inst, sizeof(gl_instance) * mc->inst_count);
+		dst += mc->inst_count;
+	}
+	t->stats.batches = GLCore.draw(t->core, total, redraw->rects, redraw->count, full);
+
+	return GLCore.read(t->core, t->pixels, redraw->rects, redraw->count);
+}
+/*
+ *	Updates the layers of layered modules; drops layers of modules drawn directly
+ */
+static void update_layers(render_target t, int n, uint64_t frame) {
+	for (int j = 0; j < n; ++j) {
+		module_cache* mc = t->order[j];
+		if (mc->key->layer.enabled) update_layer(t, mc, frame);
+		else release_layer(t, mc);
+	}
+	reserve_layer(t, 0, frame);		// apply a lowered budget
+}
+/* monotonic clock in nanoseconds */
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+/* deletes an image's texture and drops its entry */
+static void release_image(render_target t, image_entry* e) {
+	if (e->texture) {
+		glDeleteTextures(1, &e->texture);
+		if (t->gl.texture == e->texture) t->gl.texture = 0;		// deleting unbinds
+	}
+	ImageCache.remove(&t->images, e);
+}
+/*
+ *	Evicts least recently drawn image textures (not drawn in the last presented
+ *	frame) until `bytes` more fit; the images on screen are always kept
+ */
+static void reserve_images(render_target t, size_t bytes) {
+	image_table* it = &t->images;
+	while (it->bytes + bytes > it->budget) {
+		image_entry* lru = ImageCache.lru(it, t->stats.frames);
+		if (!lru) return;
+
+		DBLOG("<Render> evicting image %d (%dx%d)", lru->image, lru->width, lru->height);
+		release_image(t, lru);
+		it->evictions++;
+	}
+}
+/*
+ *	Streams pending image rows into textures, at most the per-frame upload budget
+ *	(at least one row); entries of freed images are dropped first (OpenGL)
+ */
+static void stream_images(render_target t) {
+	image_table* it = &t->images;
+	if (!it->count) return;
+#ifndef SIMOCK
+	SDL_GL_MakeCurrent(t->sdl_window, t->gl_context);
+#endif
+	uint64_t generation = Images.generation();
+	if (generation != it->generation) {
+		it->generation = generation;
+		for (int i = it->count - 1; i >= 0; --i) {
+			if (Image.state(it->entries[i].image) != IMAGE_READY) release_image(t, &it->entries[i]);
+		}
+	}
+	reserve_images(t, 0);		// apply a lowered budget
+
+	uint64_t start = now_ns();
+	size_t left = it->upload_budget;
+	int uploaded = 0;
+	for (int i = 0; i < it->count && left; ++i) {
+		image_entry* e = &it->entries[i];
+		if (e->rows == e->height) continue;
+		ui_image image = e->image;
+		const uint32_t* px = Images.pixels(image, NULL, NULL, NULL);
+		if (!px) continue;
+		if (!e->texture) {
+			size_t bytes = sizeof(uint32_t) * (size_t)e->width * e->height;
+			reserve_images(t, bytes);
+			e = ImageCache.find(it, image);		// eviction moves entries
+			glGenTextures(1, &e->texture);
+			gl_bind_texture(t, e->texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, e->width, e->height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+			e->bytes = bytes;
+			it->bytes += bytes;
+		}
+		size_t stride = sizeof(uint32_t) * (size_t)e->width;
+		int rows = left / stride > 0 ? (int)(left / stride) : 1;
+		if (rows > e->height - e->rows) rows = e->height - e->rows;
+		gl_bind_texture(t, e->texture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, e->rows, e->width, rows, GL_BGRA, GL_UNSIGNED_BYTE, px + (size_t)e->rows * e->width);
+		Images.release(image);
+		e->rows += rows;
+		it->upload_bytes += stride * rows;
+		left = stride * rows < left ? left - stride * rows : 0;
+		if (e->rows == e->height) it->stamp++;
+		uploaded = 1;
+	}
+	if (uploaded) it->stall_ns += now_ns() - start;
+}
+/*
+ *	Damages (and invalidates) modules showing placeholders whose images became
+ *	drawable; on window targets this also queues newly decoded images for upload
+ */
+static void collect_image_damage(render_target t, ui_context ctx, damage_set* ds) {
+	if (t->mode == RENDER_OFFSCREEN) return;
+
+	int count = List.count(ctx->modules);
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		if (!m->enabled || !m->win) continue;
+		module_cache* mc = ModuleCache.find(&t->caches, m);
+		if (!mc || !mc->valid || !mc->pending) continue;
+
+		for (int c = 0; c < m->draws.count; ++c) {
+			const draw_cmd* cmd = &m->draws.cmds[c];
+			if (cmd->kind != DRAW_IMAGE || !ImageCache.request(&t->images, cmd->image, t->stats.frames + 1)) continue;
+			mc->valid = 0;
+			mc->layer.hash = 0;		// re-render the layer too
+			Damage.add(ds, ui_module_bounds(m));
+			break;
+		}
+	}
+}
+/* copies the image cache statistics (streaming continues through skipped frames) */
+static void image_stats(render_target t) {
+	t->stats.images = t->images.count;
+	t->stats.image_bytes = t->images.bytes;
+	t->stats.image_hits = t->images.hits;
+	t->stats.image_misses = t->images.misses;
+	t->stats.image_evictions = t->images.evictions;
+	t->stats.image_upload_bytes = t->images.upload_bytes;
+	t->stats.image_stall_ns = t->images.stall_ns;
+}
+/*
+ *	Render the damaged parts of a context to a target; frames without damage are
+ *	skipped entirely (no drawing, no present)
+ */
+static void render_frame(render_target t, ui_context ctx) {
+	if (!t || !ctx || !ctx->modules) return;
+	//	callbacks of the next Sigui.render are culled against this target
+	if (ctx->viewport.width <= 0 || ctx->viewport.height <= 0) ctx->viewport = (ui_rect){ 0, 0, t->width, t->height };
+
+	damage_set frame = {0};
+	if (t->mode == RENDER_WINDOW) stream_images(t);
+	collect_damage(t, ctx, &frame);
+	collect_image_damage(t, ctx, &frame);
+	Damage.clip(&frame, t->width, t->height);
+	if (frame.count == 0) {
+		t->stats.skipped++;
+		image_stats(t);
+		return;
+	}
+
+	damage_set redraw = frame;
+	repair_damage(t, &redraw);
+	Damage.clip(&redraw, t->width, t->height);
+	//	mostly dirty: one full-surface pass is cheaper than many scissored ones
+	long surface = (long)t->width * t->height;
+	if (redraw.count > 1 && Damage.area(&redraw) * 4 > surface * 3) {
+		Damage.all(&redraw);
+		Damage.clip(&redraw, t->width, t->height);
+	}
+	int full = redraw.count == 1 && Damage.area(&redraw) == surface;
+
+	uint64_t frame_no = t->stats.frames + 1;
+	int n = prepare_modules(t, ctx, frame_no);
+
+	if (t->mode == RENDER_HEADLESS) {
+		canvas fb = target_canvas(t);
+		update_layers(t, n, frame_no);
+		for (int i = 0; i < redraw.count; ++i) {
+			ui_rect r = redraw.rects[i];
+			fill_rect(fb, r.x, r.y, r.width, r.height, COLOR_BLACK);
+			for (int j = 0; j < n; ++j) {
+				module_cache* mc = t->order[j];
+				if (mc->key->layer.enabled) composite_layer_headless(fb, mc, r);
+				else draw_cache_headless(fb, mc, r, &t->atlas);
+			}
+		}
+		Damage.clear(&t->atlas.dirty);		// read in place: nothing to upload
+	} else if (t->mode == RENDER_OFFSCREEN) {
+		if (draw_frame_core(t, n, &redraw, full) != 0) t->status = "GLCore";
+	} else {
+#ifndef SIMOCK
+		SDL_GL_MakeCurrent(t->sdl_window, t->gl_context);
+#endif
+		upload_atlas_gl(t);
+		if (gather_vertices(t, n) != 0 || batch_frame(t, n) != 0) {
+			t->status = "batch";
+			t->frame_layout = t->frame_keys = 0;		// rebuild next frame
+		}
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(ui_vertex), (const void*)offsetof(ui_vertex, x));
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ui_vertex), (const void*)offsetof(ui_vertex, rgba));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(ui_vertex), (const void*)offsetof(ui_vertex, u));
+		update_layers(t, n, frame_no);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		gl_cap(t, GL_SCISSOR_TEST, &t->gl.scissor, full ? 0 : 1);
+		for (int i = 0; i < redraw.count; ++i) {
+			ui_rect r = redraw.rects[i];
+			if (!full) gl_scissor(t, r);
+			glClear(GL_COLOR_BUFFER_BIT);
+			draw_region_gl(t, r);
+		}
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		SDL_GL_SwapWindow(t->sdl_window);
+	}
+	ModuleCache.sweep(&t->caches, frame_no, evict_cache, t);
+
+	//	remember what was presented
+	t->history_head = (t->history_head + 1) % DAMAGE_HISTORY;
+	t->history[t->history_head] = frame;
+	t->last = redraw;
+	t->presented = 1;
+	t->stats.frames++;
+	t->stats.regions = redraw.count;
+	t->stats.pixels = Damage.area(&redraw);
+	t->stats.glyphs = t->atlas.count;
+	t->stats.glyph_lookups = t->atlas.lookups;
+	t->stats.glyph_misses = t->atlas.misses;
+	t->stats.atlas_evictions = t->atlas.evictions;
+	t->stats.meshes = t->tess.count;
+	t->stats.mesh_hits = t->tess.hits;
+	t->stats.mesh_misses = t->tess.misses;
+	image_stats(t);
+
+	Damage.clear(&ctx->damage);
+	int count = List.count(ctx->modules);
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		m->drawn_enabled = m->enabled && m->win;
+		if (m->drawn_enabled) m->drawn = ui_module_bounds(m);
+	}
+}
+/* sets the resident layer budget; excess layers go on the next frame */
+static void layer_budget(render_target t, size_t bytes) {
+	if (t) t->layer_budget = bytes;
+}
+/* sets the resident image texture budget; excess textures go on the next frame */
+static void image_budget(render_target t, size_t bytes) {
+	if (t) t->images.budget = bytes;
+}
+/* sets the image bytes streamed into textures per frame */
+static void upload_budget(render_target t, size_t bytes) {
+	if (t) t->images.upload_budget = bytes;
+}
+/* resizes the glyph atlas; every cached glyph (and vertices using one) is dropped */
+static void atlas_size(render_target t, int size) {
+	if (!t || size <= 0) return;
+
+	Atlas.release(&t->atlas);
+	t->atlas.size = size;
+	t->atlas_uploaded = 0;
+	for (int i = 0; i < t->caches.count; ++i) t->caches.entries[i].valid = 0;
+}
+/* headless framebuffer accessor */
+static const uint32_t* target_pixels(render_target t) {
+	return t ? t->pixels : NULL;
+}
+/* statistics accessor */
+static void target_stats(render_target t, render_stats* out) {
+	if (t && out) *out = t->stats;
+}
+/* regions redrawn in the last presented frame */
+static int last_damage(render_target t, ui_rect* out, int max) {
+	if (!t) return 0;
+
+	int n = t->last.count < max ? t->last.count : max;
+	for (int i = 0; i < n; ++i) out[i] = t->last.rects[i];
+
+	return t->last.count;
+}
+/* last error source accessor */
+static const string target_status(render_target t) {
+	return t ? t->status : "NULL target";
+}
+/*
+ *	Legacy entry point: initializes the default (windowed) target
+ */
+static int init_default(int width, int height) {
+	if (default_target) free_target(default_target);
+
+	default_target = new_target(RENDER_WINDOW, width, height);
+	return default_target ? 0 : -1;
 }
 /*
  *	Clean up resources and exit
@@ -125,33 +1369,35 @@ static int cleanup(const string msg) {
 	int ret = msg ? -1 : 0;
 	DBLOG("Exiting render engine (%d)", ret);
 	if (ret) {
-		fprintf(stdout, "Error [%s]: %s\n", ERR_Status, msg);
+		fprintf(stdout, "Error [%s]: %s\n",
+				  default_target && default_target->status ? default_target->status : "render", msg);
 #ifdef SIMOCK
 		// no mock SDL_ClearError
 #else
 		SDL_ClearError();
 #endif
 	}
-	
-	//	dispose context
-	if (gl_context) {
-		SDL_GL_DeleteContext(gl_context);
-		gl_context = NULL;
-	}
-	//	dispose sdl_window
-	if (sdl_window) {
-		SDL_DestroyWindow(sdl_window);
-		sdl_window = NULL;
-	}
-	
-	SDL_Quit();
-	
+
+	free_target(default_target);
+	default_target = NULL;
+
 	DBLOG("Render engine cleanup complete.");
 	return ret;
 }
 
 const IRender Render = {
-    .init = init_sdl_window,
+    .init = init_default,
     .module = render_module,
-    .dispose = cleanup
+    .dispose = cleanup,
+    .new_target = new_target,
+    .free_target = free_target,
+    .frame = render_frame,
+    .pixels = target_pixels,
+    .status = target_status,
+    .stats = target_stats,
+    .damage = last_damage,
+    .layer_budget = layer_budget,
+    .atlas_size = atlas_size,
+    .image_budget = image_budget,
+    .upload_budget = upload_budget
 };
@@ -0,0 +1,473 @@
+// render_cache.c
+/**
+ * @detail Per-target module vertex caches. Each presented frame a module's cache
+ * 	entry is looked up by module pointer; its vertices are rebuilt only when the
+ * 	draw list hash or the window rect differ from what they were built with.
+ * 	Quad tables (headless, legacy GL) hold rects and glyphs as quads and shapes
+ * 	as cached meshes translated into place (clipped only when they cross their
+ * 	clip) and images as textured quads once the target can draw them (their
+ * 	placeholder color until then); instanced tables (GL core) keep one instance
+ * 	per command.
+ * 	Entries not prepared in a frame (module disabled or freed) are swept unless
+ * 	they still hold a resident layer; those go when the layer budget evicts them.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "render_core.h"
+#include "sigui_debug.h"
+
+//	Forward Declarations ========================================================
+static int push_instance(module_cache*, ui_rect, ui_rect, uint32_t, int, int, int, const float*);
+
+/* clipped polygon vertex */
+typedef struct clip_vertex_s {
+	float x, y, a;
+} clip_vertex;
+
+//	Helper Functions ============================================================
+static unsigned slot_of(const void* key, int capacity) {
+	return ui_fib_slot((uint64_t)(uintptr_t)key, __builtin_ctz((unsigned)capacity));
+}
+/* rebuilds the open addressing index */
+static int rebuild_index(cache_table* ct, int capacity) {
+	int* index = Mem.alloc(sizeof(int) * capacity);
+	if (!index) return -1;
+	memset(index, 0, sizeof(int) * capacity);
+
+	for (int i = 0; i < ct->count; ++i) {
+		unsigned s = slot_of(ct->entries[i].key, capacity);
+		while (index[s]) s = (s + 1) & (capacity - 1);
+		index[s] = i + 1;
+	}
+	if (ct->index) Mem.free(ct->index);
+	ct->index = index;
+	ct->index_capacity = capacity;
+
+	return 0;
+}
+static module_cache* find_entry(cache_table* ct, ui_module m) {
+	if (!ct->index) return NULL;
+
+	unsigned s = slot_of(m, ct->index_capacity);
+	while (ct->index[s]) {
+		module_cache* mc = &ct->entries[ct->index[s] - 1];
+		if (mc->key == m) return mc;
+		s = (s + 1) & (ct->index_capacity - 1);
+	}
+
+	return NULL;
+}
+static module_cache* add_entry(cache_table* ct, ui_module m) {
+	if (ct->count == ct->capacity) {
+		int capacity = ct->capacity ? ct->capacity * 2 : 16;
+		module_cache* entries = Mem.alloc(sizeof(module_cache) * capacity);
+		if (!entries) return NULL;
+		if (ct->entries) {
+			memcpy(entries, ct->entries, sizeof(module_cache) * ct->count);
+			Mem.free(ct->entries);
+		}
+		ct->entries = entries;
+		ct->capacity = capacity;
+	}
+
+	module_cache* mc = &ct->entries[ct->count++];
+	memset(mc, 0, sizeof(module_cache));
+	mc->key = m;
+
+	//	keep the index at most half full
+	if (ct->count * 2 > ct->index_capacity) {
+		if (rebuild_index(ct, ct->index_capacity ? ct->index_capacity * 2 : 32) != 0) {
+			ct->count--;
+			return NULL;
+		}
+	} else {
+		unsigned s = slot_of(m, ct->index_capacity);
+		while (ct->index[s]) s = (s + 1) & (ct->index_capacity - 1);
+		ct->index[s] = ct->count;
+	}
+
+	return mc;
+}
+/* appends one quad (uv: atlas u0, v0, u1, v1; NULL=untextured); returns 0 when out of memory */
+static int push_quad(module_cache* mc, ui_rect r, uint32_t argb, const float* uv) {
+	if (ui_grow_array((void**)&mc->verts, &mc->capacity, mc->count + 4, sizeof(ui_vertex), 64) != 0) return 0;
+
+	uint8_t rgba[4] = { argb >> 16, argb >> 8, argb, argb >> 24 };
+	float x0 = r.x, y0 = r.y, x1 = r.x + r.width, y1 = r.y + r.height;
+	static const float none[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+	if (!uv) uv = none;
+	ui_vertex* v = &mc->verts[mc->count];
+	v[0] = (ui_vertex){ x0, y0, uv[0], uv[1], { rgba[0], rgba[1], rgba[2], rgba[3] } };
+	v[1] = (ui_vertex){ x1, y0, uv[2], uv[1], { rgba[0], rgba[1], rgba[2], rgba[3] } };
+	v[2] = (ui_vertex){ x1, y1, uv[2], uv[3], { rgba[0], rgba[1], rgba[2], rgba[3] } };
+	v[3] = (ui_vertex){ x0, y1, uv[0], uv[3], { rgba[0], rgba[1], rgba[2], rgba[3] } };
+	mc->count += 4;
+
+	return 1;
+}
+/* appends the part of a quad inside a clip rect; returns 0 when out of memory */
+static int push_clipped(module_cache* mc, ui_rect r, ui_rect clip, uint32_t argb) {
+	ui_rect clipped;
+	if (!Damage.intersect(r, clip, &clipped)) return 1;
+
+	return push_quad(mc, clipped, argb, NULL);
+}
+/* clips a polygon against one rect edge (axis 0=x, 1=y; sign 1: keep >= bound, -1: keep <= bound) */
+static int clip_edge(const clip_vertex* in, int n, clip_vertex* out, int axis, float bound, float sign) {
+	int count = 0;
+	for (int i = 0; i < n; ++i) {
+		const clip_vertex* p = &in[i];
+		const clip_vertex* q = &in[(i + 1) % n];
+		float dp = sign * ((axis ? p->y : p->x) - bound);
+		float dq = sign * ((axis ? q->y : q->x) - bound);
+		if (dp >= 0) out[count++] = *p;
+		if ((dp >= 0) != (dq >= 0)) {
+			float t = dp / (dp - dq);
+			out[count++] = (clip_vertex){ p->x + (q->x - p->x) * t, p->y + (q->y - p->y) * t, p->a + (q->a - p->a) * t };
+		}
+	}
+
+	return count;
+}
+/*
+ *	Clips a mesh span to a rect: inside triangles are kept, crossing ones become
+ *	fans over new vertices (appended to the span), outside ones are dropped;
+ *	returns 0 when out of memory
+ */
+static int clip_span(module_cache* mc, mesh_span* s, ui_rect clip) {
+	float x0 = clip.x, y0 = clip.y, x1 = clip.x + clip.width, y1 = clip.y + clip.height;
+	int out = mc->tri_count, written = 0;
+	const ui_vertex proto = mc->verts[s->first];
+
+	for (int t = 0; t < s->indices; t += 3) {
+		if (ui_grow_array((void**)&mc->tris, &mc->tri_capacity, out + written + 15, sizeof(uint32_t), 64) != 0 ||
+			 ui_grow_array((void**)&mc->verts, &mc->capacity, mc->count + 7, sizeof(ui_vertex), 64) != 0) return 0;
+		const uint32_t* tri = mc->tris + s->index + t;
+		const ui_vertex* v[3] = { &mc->verts[tri[0]], &mc->verts[tri[1]], &mc->verts[tri[2]] };
+		int inside = 1;
+		for (int k = 0; k < 3; ++k) inside &= v[k]->x >= x0 && v[k]->x <= x1 && v[k]->y >= y0 && v[k]->y <= y1;
+		if (inside) {
+			memcpy(mc->tris + out + written, tri, sizeof(uint32_t) * 3);
+			written += 3;
+			continue;
+		}
+
+		clip_vertex a[9], b[9];
+		for (int k = 0; k < 3; ++k) a[k] = (clip_vertex){ v[k]->x, v[k]->y, v[k]->rgba[3] };
+		int n = clip_edge(a, 3, b, 0, x0, 1);
+		n = clip_edge(b, n, a, 0, x1, -1);
+		n = clip_edge(a, n, b, 1, y0, 1);
+		n = clip_edge(b, n, a, 1, y1, -1);
+		if (n < 3) continue;
+
+		int first = mc->count;
+		for (int k = 0; k < n; ++k) {
+			ui_vertex* w = &mc->verts[mc->count++];
+			*w = proto;
+			w->x = a[k].x;
+			w->y = a[k].y;
+			w->rgba[3] = (uint8_t)(a[k].a + 0.5f);
+		}
+		for (int k = 1; k + 1 < n; ++k) {
+			uint32_t* o = mc->tris + out + written;
+			o[0] = first;
+			o[1] = first + k;
+			o[2] = first + k + 1;
+			written += 3;
+		}
+	}
+
+	memmove(mc->tris + s->index, mc->tris + out, sizeof(uint32_t) * written);
+	mc->tri_count = s->index + written;
+	s->indices = written;
+	s->count = mc->count - s->first;
+
+	return 1;
+}
+/*
+ *	Appends a shape's cached mesh translated into place (and colored), clipped when
+ *	it crosses the clip; returns 0 when out of memory
+ */
+static int push_mesh(module_cache* mc, tess_cache* tess, const draw_cmd* cmd, ui_rect origin, ui_rect clip) {
+	const tess_mesh* mesh = tess ? Tess.mesh(tess, cmd) : NULL;
+	if (!mesh) return 1;
+	if (ui_grow_array((void**)&mc->verts, &mc->capacity, mc->count + mesh->vertex_count, sizeof(ui_vertex), 64) != 0 ||
+		 ui_grow_array((void**)&mc->tris, &mc->tri_capacity, mc->tri_count + mesh->index_count + 8, sizeof(uint32_t), 64) != 0 ||
+		 ui_grow_array((void**)&mc->meshes, &mc->mesh_capacity, mc->mesh_count + 1, sizeof(mesh_span), 64) != 0) return 0;
+
+	//	lines start at a pixel center
+	int line = cmd->kind == DRAW_LINE;
+	float x = origin.x + (line ? cmd->points[0] + 0.5f : cmd->rect.x);
+	float y = origin.y + (line ? cmd->points[1] + 0.5f : cmd->rect.y);
+	//	pixels whose centers fall strictly inside the mesh extent (the outer fringe has no coverage)
+	int bx = (int)floorf(x + mesh->x0 - 0.5f) + 1, by = (int)floorf(y + mesh->y0 - 0.5f) + 1;
+	ui_rect bounds = { bx, by, (int)ceilf(x + mesh->x1 - 0.5f) - bx, (int)ceilf(y + mesh->y1 - 0.5f) - by };
+	if (!Damage.intersect(bounds, clip, NULL)) return 1;
+
+	mesh_span* s = &mc->meshes[mc->mesh_count];
+	*s = (mesh_span){ mc->count, mesh->vertex_count, mc->tri_count, mesh->index_count, bounds };
+	Tess.emit(tess, mesh, x, y, cmd->color, mc->verts + mc->count, mc->tris + mc->tri_count, (uint32_t)mc->count);
+	mc->count += mesh->vertex_count;
+	mc->tri_count += mesh->index_count;
+
+	if (!ui_rect_contains(clip, bounds)) {
+		if (!clip_span(mc, s, clip)) return 0;
+		Damage.intersect(bounds, clip, &s->bounds);
+	}
+	if (!s->indices) {
+		mc->count = s->first;
+		mc->tri_count = s->index;
+		return 1;
+	}
+	mc->mesh_count++;
+
+	return 1;
+}
+/*
+ *	Lays a text run out: one atlas lookup per glyph on a visible line, emitted as
+ *	a clipped textured quad (quad tables) or a glyph instance; returns 0 when out of memory
+ */
+static int push_text(module_cache* mc, glyph_atlas* atlas, ui_module m, const draw_cmd* cmd, ui_rect origin,
+							ui_rect clip, uint32_t argb, uint64_t frame, int instanced) {
+	if (!atlas || !m->draws.text) return 1;
+	const char* s = m->draws.text + cmd->text;
+	const char* end = s + cmd->length;
+	int line = Glyphs.height(cmd->font);
+	int x0 = origin.x + cmd->rect.x;
+	int pen = x0, top = origin.y + cmd->rect.y;
+	int clip_right = clip.x + clip.width, clip_bottom = clip.y + clip.height;
+
+	while (s < end && top < clip_bottom) {
+		uint32_t cp = ui_utf8_next(&s, end);
+		if (cp == '\n') {
+			pen = x0;
+			top += line;
+			continue;
+		}
+		//	lines above the clip and the rest of a line past its right edge cost nothing
+		if (top + line <= clip.y || pen >= clip_right) continue;
+
+		const glyph_entry* g = Atlas.glyph(atlas, cmd->font, cp, frame);
+		if (!g) continue;
+		ui_rect dst = { pen + g->left, top + g->top, g->width, g->height };
+		pen += g->advance;
+		if (g->shelf < 0) continue;
+		mc->shelves |= 1ull << g->shelf;
+
+		float size = (float)atlas->size;
+		if (instanced) {
+			float uv[4] = { g->x / size, g->y / size, (g->x + g->width) / size, (g->y + g->height) / size };
+			if (!push_instance(mc, dst, clip, argb, 0, 0, GL_INSTANCE_RECT, uv)) return 0;
+			continue;
+		}
+		ui_rect vis;
+		if (!Damage.intersect(dst, clip, &vis)) continue;
+		float u0 = g->x + vis.x - dst.x, v0 = g->y + vis.y - dst.y;
+		float uv[4] = { u0 / size, v0 / size, (u0 + vis.width) / size, (v0 + vis.height) / size };
+		if (!push_quad(mc, vis, argb, uv)) return 0;
+	}
+
+	return 1;
+}
+/*
+ *	Appends the visible part of an image with matching texture coordinates or,
+ *	until the target can draw the image, its placeholder; returns 0 when out of memory
+ */
+static int push_image(module_cache* mc, image_table* images, const draw_cmd* cmd, ui_rect r, ui_rect clip, uint64_t frame) {
+	ui_rect vis;
+	if (!Damage.intersect(r, clip, &vis)) return 1;
+	if (!images || !ImageCache.ready(images, cmd->image, frame)) {
+		mc->pending++;
+		return push_quad(mc, vis, cmd->color, NULL);
+	}
+	if (ui_grow_array((void**)&mc->images, &mc->image_capacity, mc->image_count + 1, sizeof(image_quad), 64) != 0) return 0;
+
+	float uv[4] = { (float)(vis.x - r.x) / r.width, (float)(vis.y - r.y) / r.height,
+						 (float)(vis.x + vis.width - r.x) / r.width, (float)(vis.y + vis.height - r.y) / r.height };
+	mc->images[mc->image_count++] = (image_quad){ mc->count, cmd->image };
+
+	return push_quad(mc, vis, COLOR_WHITE, uv);
+}
+/* builds absolute vertices: background, then commands clipped to the window (or layer) */
+static void build_vertices(module_cache* mc, ui_module m, ui_rect win, const cache_table* ct, uint64_t frame) {
+	mc->count = 0;
+	mc->mesh_count = 0;
+	mc->tri_count = 0;
+	mc->image_count = 0;
+	mc->pending = 0;
+	mc->shelves = 0;
+	push_quad(mc, win, COLOR_WHITE, NULL);
+
+	for (int i = 0; i < m->draws.count; ++i) {
+		const draw_cmd* cmd = &m->draws.cmds[i];
+		ui_rect r = { win.x + cmd->rect.x, win.y + cmd->rect.y, cmd->rect.width, cmd->rect.height };
+		ui_rect clip = { win.x + cmd->clip.x, win.y + cmd->clip.y, cmd->clip.width, cmd->clip.height };
+		if (!Damage.intersect(clip, win, &clip)) continue;
+		int square = cmd->kind == DRAW_RECT || (cmd->kind == DRAW_ROUNDED && !cmd->radius);
+		int ok = square ? push_clipped(mc, r, clip, cmd->color)
+				 : cmd->kind == DRAW_TEXT ? push_text(mc, ct->atlas, m, cmd, win, clip, cmd->color, frame, 0)
+				 : cmd->kind == DRAW_IMAGE ? push_image(mc, ct->images, cmd, r, clip, frame)
+				 : push_mesh(mc, ct->tess, cmd, win, clip);
+		if (!ok) break;
+	}
+}
+/* appends one instance (kind: GL_INSTANCE_*); returns 0 when out of memory */
+static int push_instance(module_cache* mc, ui_rect r, ui_rect clip, uint32_t argb, int radius, int border, int kind, const float* uv) {
+	if (mc->inst_count == mc->inst_capacity) {
+		int capacity = mc->inst_capacity ? mc->inst_capacity * 2 : 16;
+		gl_instance* inst = Mem.alloc(sizeof(gl_instance) * capacity);
+		if (!inst) return 0;
+		if (mc->inst) {
+			memcpy(inst, mc->inst, sizeof(gl_instance) * mc->inst_count);
+			Mem.free(mc->inst);
+		}
+		mc->inst = inst;
+		mc->inst_capacity = capacity;
+	}
+
+	mc->inst[mc->inst_count++] = (gl_instance){
+		{ r.x, r.y, r.width, r.height },
+		{ clip.x, clip.y, clip.width, clip.height },
+		{ uv ? uv[0] : 0, uv ? uv[1] : 0, uv ? uv[2] : 0, uv ? uv[3] : 0 },
+		argb, radius, border, kind
+	};
+
+	return 1;
+}
+/* scales a color's alpha by an opacity */
+static inline uint32_t fade(uint32_t argb, uint32_t opacity) {
+	if (opacity == 0xFF) return argb;
+	uint32_t a = ((argb >> 24) * opacity + 127) / 255;
+
+	return a << 24 | (argb & 0xFFFFFF);
+}
+/*
+ *	Builds instances: background, then one per command; `origin` places the
+ *	window (or scrolled layer) and every shape is clipped to `clip` in the shader
+ */
+static void build_instances(module_cache* mc, ui_module m, ui_rect origin, ui_rect clip, uint32_t opacity,
+									 glyph_atlas* atlas, uint64_t frame) {
+	mc->inst_count = 0;
+	mc->pending = 0;
+	mc->shelves = 0;
+	push_instance(mc, origin, clip, fade(COLOR_WHITE, opacity), 0, 0, GL_INSTANCE_RECT, NULL);
+
+	for (int i = 0; i < m->draws.count; ++i) {
+		const draw_cmd* cmd = &m->draws.cmds[i];
+		ui_rect r = { origin.x + cmd->rect.x, origin.y + cmd->rect.y, cmd->rect.width, cmd->rect.height };
+		ui_rect c = { origin.x + cmd->clip.x, origin.y + cmd->clip.y, cmd->clip.width, cmd->clip.height };
+		if (!Damage.intersect(c, clip, &c)) continue;
+		int border = cmd->kind == DRAW_BORDER ? cmd->border : 0;
+		if (cmd->kind == DRAW_TEXT) {
+			if (!push_text(mc, atlas, m, cmd, origin, c, fade(cmd->color, opacity), frame, 1)) break;
+			continue;
+		}
+		//	images are not uploaded to GL core targets: the placeholder stands in
+		int kind = GL_INSTANCE_RECT;
+		float ends[4];
+		if (cmd->kind == DRAW_LINE) {
+			//	endpoints (pixel centers) ride in the uv slot; the rect only bounds the quad
+			kind = GL_INSTANCE_LINE;
+			border = cmd->border;
+			for (int k = 0; k < 4; ++k) ends[k] = (k & 1 ? origin.y : origin.x) + cmd->points[k] + 0.5f;
+		} else if (cmd->kind == DRAW_SHADOW) {
+			kind = GL_INSTANCE_SHADOW;
+			border = cmd->border;
+			int grow = (border + 1) / 2;
+			r = (ui_rect){ r.x - grow, r.y - grow, r.width + 2 * grow, r.height + 2 * grow };
+		}
+		if (!push_instance(mc, r, c, fade(cmd->color, opacity), cmd->radius, border, kind, kind == GL_INSTANCE_LINE ? ends : NULL)) break;
+	}
+}
+
+/* finds (or creates) a module's cache entry and refreshes it when stale */
+static module_cache* prepare_entry(cache_table* ct, ui_module m, uint64_t frame) {
+	module_cache* mc = find_entry(ct, m);
+	if (!mc && !(mc = add_entry(ct, m))) return NULL;
+	mc->seen = frame;
+
+	//	layered modules are built in layer space; instanced tables draw them in
+	//	place (scrolled, clipped to the on-screen rect, faded)
+	ui_rect win = m->layer.enabled ? ui_layer_rect(m) : ui_window_rect(m);
+	ui_rect clip = win;
+	uint32_t opacity = 0xFF;
+	if (ct->instanced && m->layer.enabled) {
+		clip = ui_module_bounds(m);
+		win.x = clip.x - m->layer.scroll_x;
+		win.y = clip.y - m->layer.scroll_y;
+		opacity = m->layer.opacity;
+	}
+	//	cached glyphs stay valid until one of their shelves is evicted
+	int glyphs_valid = !mc->shelves || (ct->atlas && !Atlas.stale(ct->atlas, mc->shelves, mc->atlas_stamp));
+	//	and cached image quads while their images stay drawable (marked used here)
+	int images_valid = !mc->image_count || (ct->images && ImageCache.touch(ct->images, mc->images, mc->image_count, frame));
+	if (mc->valid && glyphs_valid && images_valid && mc->hash == m->draws.hash && memcmp(&mc->transform, &win, sizeof(ui_rect)) == 0 &&
+		 memcmp(&mc->clip, &clip, sizeof(ui_rect)) == 0 && mc->opacity == opacity) {
+		if (mc->shelves) Atlas.touch(ct->atlas, mc->shelves, frame);
+		m->stats.cache_hits++;
+		return mc;
+	}
+
+	if (ct->instanced) build_instances(mc, m, win, clip, opacity, ct->atlas, frame);
+	else build_vertices(mc, m, win, ct, frame);
+	mc->atlas_stamp = ct->atlas ? ct->atlas->stamp : 0;
+	mc->clip = clip;
+	mc->opacity = opacity;
+	mc->hash = m->draws.hash;
+	mc->transform = win;
+	mc->valid = 1;
+	mc->uploaded = 0;
+	m->stats.cache_misses++;
+
+	return mc;
+}
+/* drops entries that were not prepared in `frame` and hold no layer */
+static void sweep_entries(cache_table* ct, uint64_t frame, cache_evict on_evict, object user) {
+	int removed = 0;
+	int i = 0;
+	while (i < ct->count) {
+		module_cache* mc = &ct->entries[i];
+		if (mc->seen == frame || mc->layer.bytes) {
+			++i;
+			continue;
+		}
+		if (on_evict) on_evict(user, mc);
+		if (mc->verts) Mem.free(mc->verts);
+		if (mc->meshes) Mem.free(mc->meshes);
+		if (mc->tris) Mem.free(mc->tris);
+		if (mc->images) Mem.free(mc->images);
+		if (mc->inst) Mem.free(mc->inst);
+		ct->entries[i] = ct->entries[--ct->count];
+		removed = 1;
+	}
+	if (removed) rebuild_index(ct, ct->index_capacity);
+}
+/* drops every entry and the table storage */
+static void clear_entries(cache_table* ct, cache_evict on_evict, object user) {
+	for (int i = 0; i < ct->count; ++i) {
+		if (on_evict) on_evict(user, &ct->entries[i]);
+		if (ct->entries[i].verts) Mem.free(ct->entries[i].verts);
+		if (ct->entries[i].meshes) Mem.free(ct->entries[i].meshes);
+		if (ct->entries[i].tris) Mem.free(ct->entries[i].tris);
+		if (ct->entries[i].images) Mem.free(ct->entries[i].images);
+		if (ct->entries[i].inst) Mem.free(ct->entries[i].inst);
+	}
+	if (ct->entries) Mem.free(ct->entries);
+	if (ct->index) Mem.free(ct->index);
+	int instanced = ct->instanced;
+	tess_cache* tess = ct->tess;
+	image_table* images = ct->images;
+	memset(ct, 0, sizeof(cache_table));
+	ct->instanced = instanced;
+	ct->tess = tess;
+	ct->images = images;
+}
+
+/* module cache interface (internal) */
+const IModuleCache ModuleCache = {
+	.prepare = prepare_entry,
+	.find = find_entry,
+	.sweep = sweep_entries,
+	.clear = clear_entries
+};
@@ -0,0 +1,308 @@
+// render_core.h
+#ifndef RENDER_CORE_H
+#define RENDER_CORE_H
+
+#include "render.h"
+#include "gl_core.h"
+
+#define COLOR_BLACK 0xFF000000u
+#define COLOR_WHITE 0xFFFFFFFFu
+#define DAMAGE_HISTORY 4			/* frames of damage kept for buffer-age repair */
+#define LAYER_BUDGET (64u << 20)	/* default resident layer bytes per target */
+#define BATCH_LOOKBACK 32			/* batches an item may move back past to merge */
+#define GL_UNKNOWN 0xFFFFFFFFu	/* state cache: value not known */
+#define ATLAS_SIZE 512				/* default glyph atlas side (A8) */
+#define ATLAS_SHELVES 64			/* shelves per atlas (shelf masks are 64-bit) */
+#define TESS_CACHE_MAX 4096		/* cached meshes per target before the cache is flushed */
+#define TESS_SEGMENTS_MAX 16		/* arc segments per rounded corner */
+#define IMAGE_BUDGET (64u << 20)	/* default resident image texture bytes per target */
+#define IMAGE_UPLOAD_BUDGET (1u << 20)	/* default image bytes uploaded per frame */
+
+/* vertex: absolute position, atlas coordinates (u < 0: untextured) + color bytes in GL memory order (R, G, B, A) */
+typedef struct ui_vertex_s {
+	float x, y;
+	float u, v;
+	uint8_t rgba[4];
+} ui_vertex;
+/* cached glyph: atlas rect + metrics */
+typedef struct glyph_entry_s {
+	uint64_t key;					/* font << 32 | codepoint */
+	uint16_t x, y;					/* atlas position */
+	uint16_t width, height;		/* bitmap size (0=blank) */
+	int16_t left, top;			/* bitmap offset from the pen */
+	int16_t advance;				/* pen advance */
+	int16_t shelf;					/* shelf holding the bitmap (-1=blank) */
+} glyph_entry;
+/* atlas row holding glyphs of similar height */
+typedef struct atlas_shelf_s {
+	int y, height;					/* atlas rows */
+	int x;							/* next free column */
+	uint64_t used;					/* last frame one of its glyphs was drawn (LRU) */
+	uint64_t evicted;				/* atlas stamp of the last eviction (0=never) */
+} atlas_shelf;
+/* per-target glyph cache: shelf-packed A8 atlas */
+typedef struct glyph_atlas_s {
+	uint8_t* pixels;				/* coverage, size x size (allocated on first glyph) */
+	int size;						/* atlas side */
+	atlas_shelf shelves[ATLAS_SHELVES];
+	int shelf_count;
+	int bottom;						/* first row not claimed by a shelf */
+	glyph_entry* glyphs;			/* dense entries */
+	int count, capacity;
+	int* index;						/* open addressing: entry index + 1 (0=empty) */
+	int index_capacity;			/* power of two */
+	uint64_t stamp;				/* eviction counter */
+	damage_set dirty;				/* atlas rects changed since the last upload */
+	uint64_t lookups;				/* glyph lookups */
+	uint64_t misses;				/* glyphs rasterized */
+	uint64_t evictions;			/* shelves evicted */
+} glyph_atlas;
+/* shape parameters a mesh is tessellated from (position excluded) */
+typedef struct tess_key_s {
+	int32_t kind;					/* draw_kind: border, rounded, line or shadow */
+	int32_t width, height;		/* rect size (lines: 0) */
+	int32_t radius;				/* corner radius */
+	int32_t border;				/* outline width, line width or shadow blur */
+	int32_t dx, dy;				/* lines: end point relative to the start */
+} tess_key;
+/* cached mesh: local positions and coverage (SoA, padded to 4) + triangles */
+typedef struct tess_mesh_s {
+	tess_key key;
+	int vertex_count, index_count;
+	int vertices;					/* pool offset: x[], y[], coverage[] at stride `padded` */
+	int padded;						/* vertex_count rounded up to 4 */
+	int indices;					/* index pool offset */
+	float x0, y0, x1, y1;		/* local bounds */
+} tess_mesh;
+/* per-target tessellation cache */
+typedef struct tess_cache_s {
+	tess_mesh* meshes;			/* dense entries */
+	int count, capacity;
+	int* index;						/* open addressing: entry index + 1 (0=empty) */
+	int index_capacity;			/* power of two */
+	float* floats;					/* vertex pool */
+	int float_count, float_capacity;
+	uint16_t* indices;			/* index pool */
+	int index_count, index_pool_capacity;
+	uint64_t hits, misses;		/* mesh lookups */
+	uint64_t flushes;				/* times the cache was full and dropped */
+} tess_cache;
+/* run of mesh triangles in a module's vertex stream */
+typedef struct mesh_span_s {
+	int first, count;				/* vertices */
+	int index, indices;			/* module triangle indices (local vertex numbers) */
+	ui_rect bounds;				/* absolute bounds */
+} mesh_span;
+/* image quad in a module's vertex stream */
+typedef struct image_quad_s {
+	int first;						/* quad's first vertex */
+	ui_image image;				/* sampled image */
+} image_quad;
+/* image resident on a target (RENDER_WINDOW: a texture streamed in row bands) */
+typedef struct image_entry_s {
+	ui_image image;
+	GLuint texture;				/* 0=storage not allocated yet */
+	int width, height;
+	int rows;						/* rows uploaded (height: drawable) */
+	int opaque;						/* no pixel needs blending */
+	size_t bytes;					/* texture storage */
+	uint64_t used;					/* last frame the image was drawn (LRU) */
+} image_entry;
+/* per-target image cache */
+typedef struct image_table_s {
+	image_entry* entries;		/* dense entries */
+	int count, capacity;
+	int* slots;						/* image handle -> entry index + 1 (0=none) */
+	int slot_capacity;
+	int streamed;					/* images are drawn from uploaded textures (RENDER_WINDOW) */
+	size_t bytes;					/* texture bytes resident */
+	size_t budget;					/* resident byte cap */
+	size_t upload_budget;		/* bytes uploaded per frame */
+	uint64_t generation;			/* image registry generation last synced */
+	uint64_t stamp;				/* bumped whenever an entry becomes drawable or goes away */
+	uint64_t hits, misses;		/* image draws: drawable vs placeholder */
+	uint64_t evictions;			/* textures evicted by the budget */
+	size_t upload_bytes;			/* bytes uploaded */
+	uint64_t stall_ns;			/* time spent uploading */
+} image_table;
+/* offscreen layer of one module */
+typedef struct layer_cache_s {
+	uint32_t* pixels;				/* RENDER_HEADLESS: layer pixels */
+	GLuint fbo, texture;			/* RENDER_WINDOW: framebuffer + color texture */
+	int width, height;			/* layer size */
+	size_t bytes;					/* resident bytes (0=not resident) */
+	uint64_t hash;					/* draw list hash the layer was rendered from */
+	uint64_t used;					/* last frame the layer was needed (LRU) */
+} layer_cache;
+/* per-target vertex cache of one module */
+typedef struct module_cache_s {
+	ui_module key;					/* module (only compared once stale) */
+	uint64_t hash;					/* draw list hash the vertices were built from */
+	ui_rect transform;			/* window (or layer) rect the vertices were built with */
+	ui_vertex* verts;				/* quads (4 vertices each) and mesh spans, background first */
+	int count, capacity;			/* vertex count/capacity */
+	mesh_span* meshes;			/* mesh spans in vertex order (other vertices are quads) */
+	int mesh_count, mesh_capacity;
+	uint32_t* tris;				/* mesh triangle indices (local vertex numbers) */
+	int tri_count, tri_capacity;
+	image_quad* images;			/* image quads in vertex order */
+	int image_count, image_capacity;
+	int pending;					/* images drawn as placeholders */
+	uint64_t shelves;				/* atlas shelves the cached glyphs live on */
+	uint64_t atlas_stamp;		/* atlas stamp when the glyphs were cached */
+	gl_instance* inst;			/* instanced tables: shapes, background first */
+	int inst_count, inst_capacity;
+	ui_rect clip;					/* instanced tables: clip + opacity the instances were built with */
+	uint32_t opacity;
+	int uploaded;					/* RENDER_WINDOW: the frame buffer holds the current vertices */
+	int base;						/* RENDER_WINDOW: first vertex in the frame buffer */
+	int index_first;				/* RENDER_WINDOW: layer content index range */
+	int index_count;
+	uint64_t seen;					/* last frame the module was prepared */
+	int valid;						/* vertices match hash/transform */
+	layer_cache layer;			/* offscreen layer (kept while resident) */
+} module_cache;
+/* releases an entry's backend resources: (user, entry) */
+typedef void (*cache_evict)(object, module_cache*);
+/* module cache table */
+typedef struct cache_table_s {
+	module_cache* entries;		/* dense entries */
+	int count, capacity;			/* entry count/capacity */
+	int* index;						/* open addressing: entry index + 1 (0=empty) */
+	int index_capacity;			/* power of two */
+	int instanced;					/* entries hold instances (GL core targets) instead of quads */
+	glyph_atlas* atlas;			/* glyph source of DRAW_TEXT */
+	tess_cache* tess;				/* mesh source of shapes (quad tables) */
+	image_table* images;			/* image source of DRAW_IMAGE (quad tables) */
+} cache_table;
+
+/* draw item: a run of quads, a mesh (or one layer composite) sharing a state key */
+typedef struct draw_item_s {
+	GLuint texture;				/* atlas or layer texture (0=vertex colored quads) */
+	int blend;						/* needs blending */
+	ui_rect bounds;				/* on-screen bounds */
+	int first, count;				/* quads in the frame vertex buffer (meshes: base vertex, indices) */
+	module_cache* layer;			/* layer composite (NULL=quads) */
+	int batch;						/* batch the item was merged into */
+	const uint32_t* mesh;		/* mesh triangles (local to `first`; NULL=quads) */
+} draw_item;
+/* merged draw: one state, one indexed draw */
+typedef struct draw_batch_s {
+	GLuint texture;				/* state key: texture */
+	int blend;						/* state key: blending */
+	ui_rect bounds;				/* union of the item bounds */
+	int first, count;				/* range in the index buffer */
+	module_cache* layer;			/* layer composite (NULL=quads) */
+	int items;						/* merged items */
+} draw_batch;
+/* per-target batching state */
+typedef struct batch_set_s {
+	draw_item* items;				/* items in z order */
+	int item_count, item_capacity;
+	draw_batch* batches;			/* batches in submission order */
+	int count, capacity;
+	uint32_t* indices;			/* triangle indices (content ranges, then batches) */
+	int index_count, index_capacity;
+	int* scratch;					/* per-batch emission cursor */
+	int scratch_capacity;
+} batch_set;
+/* cached GL state for the redundant-state filter */
+typedef struct gl_state_s {
+	GLuint blend, texture_2d, scissor;		/* capabilities (GL_UNKNOWN, 0, 1) */
+	GLuint texture;							/* bound 2D texture */
+	GLuint array_buffer, element_buffer;	/* bound buffers */
+	ui_rect scissor_rect;					/* scissor box (GL coordinates) */
+	uint32_t color;							/* current color (RGBA bytes) */
+	int color_known;
+} gl_state;
+
+/* opaque render target structure */
+struct render_target_s {
+	render_mode mode;				/* backend */
+	int width, height;			/* target size */
+	SDL_Window* sdl_window;		/* RENDER_WINDOW: window */
+	SDL_GLContext gl_context;	/* RENDER_WINDOW: GL context */
+	int sdl_ready;					/* RENDER_WINDOW: holds an SDL reference */
+	uint32_t* pixels;				/* RENDER_HEADLESS/OFFSCREEN: framebuffer */
+	string status;					/* last error source (NULL=OK) */
+	int buffer_age;				/* frames since the back buffer was last drawn (0=unknown) */
+	int presented;					/* at least one frame presented */
+	damage_set history[DAMAGE_HISTORY];	/* damage of recent frames (ring) */
+	int history_head;				/* ring index of the newest entry */
+	damage_set last;				/* regions redrawn in the last presented frame */
+	render_stats stats;			/* statistics */
+	cache_table caches;			/* per-module vertex caches */
+	module_cache** order;		/* scratch: visible module caches in draw order */
+	int order_capacity;			/* scratch capacity */
+	size_t layer_budget;			/* resident layer byte budget */
+	ui_vertex* frame_verts;		/* RENDER_WINDOW: vertices of every drawn module */
+	int frame_count, frame_capacity;
+	uint64_t frame_layout;		/* hash of the drawn module order and vertex counts */
+	uint64_t frame_keys;			/* hash of the state keys batches were built from */
+	GLuint vbo, ibo;				/* RENDER_WINDOW: frame vertex/index buffers */
+	batch_set batch;				/* RENDER_WINDOW: sorted + merged draws */
+	gl_state gl;					/* RENDER_WINDOW: redundant-state filter */
+	gl_core core;					/* RENDER_OFFSCREEN: instanced GL 3.3 core renderer */
+	glyph_atlas atlas;			/* glyph cache */
+	tess_cache tess;				/* shape meshes */
+	image_table images;			/* images drawn on the target */
+	GLuint atlas_texture;		/* RENDER_WINDOW: atlas texture (GL_ALPHA) */
+	int atlas_uploaded;			/* atlas texture holds the whole atlas */
+};									// render_target
+
+/* module cache interface (internal) */
+typedef struct IModuleCache {
+	module_cache* (*prepare)(cache_table*, ui_module, uint64_t);	/* find/refresh a module's vertices (or instances); counts hit/miss */
+	module_cache* (*find)(cache_table*, ui_module);					/* find a module's entry (NULL=none) */
+	void (*sweep)(cache_table*, uint64_t, cache_evict, object);		/* drop entries not prepared this frame (resident layers stay) */
+	void (*clear)(cache_table*, cache_evict, object);					/* drop all entries */
+} IModuleCache;
+
+extern const IModuleCache ModuleCache;
+
+/* draw batching interface (internal) */
+typedef struct IBatch {
+	void (*reset)(batch_set*);										/* drop items, batches and indices */
+	int (*quads)(batch_set*, GLuint, int, int, ui_rect, int);	/* add quads (texture, first, count, bounds, blend); 0 on success */
+	int (*layer)(batch_set*, module_cache*, ui_rect, int);	/* add a layer composite (entry, bounds, blend) */
+	int (*mesh)(batch_set*, const uint32_t*, int, int, ui_rect);	/* add a blended mesh (indices, count, base vertex, bounds); 0 on success */
+	int (*content)(batch_set*, const module_cache*);		/* emit a module's quads and meshes unbatched; returns the first index (-1=error) */
+	int (*build)(batch_set*);										/* merge items into batches and emit indices; 0 on success */
+	void (*release)(batch_set*);									/* free storage */
+} IBatch;
+
+extern const IBatch Batch;
+
+/* glyph atlas interface (internal) */
+typedef struct IAtlas {
+	const glyph_entry* (*glyph)(glyph_atlas*, ui_font, uint32_t, uint64_t);	/* look up (rasterize + pack on miss) a glyph drawn in a frame (NULL=unavailable) */
+	void (*touch)(glyph_atlas*, uint64_t, uint64_t);	/* mark shelves (mask) drawn in a frame */
+	int (*stale)(const glyph_atlas*, uint64_t, uint64_t);	/* a shelf of the mask was evicted after the stamp */
+	void (*release)(glyph_atlas*);							/* free storage (the size is kept) */
+} IAtlas;
+
+extern const IAtlas Atlas;
+
+/* shape tessellation interface (internal) */
+typedef struct ITess {
+	const tess_mesh* (*mesh)(tess_cache*, const draw_cmd*);	/* cached mesh of a shape command (NULL=nothing to draw or no memory) */
+	void (*emit)(const tess_cache*, const tess_mesh*, float, float, uint32_t, ui_vertex*, uint32_t*, uint32_t);	/* translated (x, y) colored vertices + indices rebased on a vertex */
+	void (*release)(tess_cache*);								/* free storage */
+} ITess;
+
+extern const ITess Tess;
+
+/* per-target image cache interface (internal; backends own the textures) */
+typedef struct IImageCache {
+	int (*ready)(image_table*, ui_image, uint64_t);		/* image drawable in a frame (counts hit/miss); queues a decoded image for upload */
+	int (*request)(image_table*, ui_image, uint64_t);	/* `ready` without statistics */
+	int (*touch)(image_table*, const image_quad*, int, uint64_t);	/* mark a module's images drawn in a frame; 1 when all are still drawable */
+	image_entry* (*find)(image_table*, ui_image);			/* resident entry (NULL=none) */
+	image_entry* (*lru)(image_table*, uint64_t);			/* least recently drawn entry holding storage, not drawn since a frame (NULL=none) */
+	void (*remove)(image_table*, image_entry*);			/* drop an entry (its texture already deleted) */
+	void (*release)(image_table*);							/* free storage (budgets are kept) */
+} IImageCache;
+
+extern const IImageCache ImageCache;
+
+#endif	//	RENDER_CORE_H
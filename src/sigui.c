@@ -3,8 +3,10 @@
  * @detail Here we can add a lot of detail about what is going on from a 30,000 foot perspective. 
  */
  
+#include <string.h>
 #include "sigui.h"
 #include "ui_core.h"
+#include "sigui_debug.h"
  
 static ui_input INIT_INPUT = {0};
 
@@ -21,28 +23,38 @@ typedef struct input_delta_s {
 //	Helper Functions ============================================================
 static void generate_events(ui_context, ui_input*);
 static input_delta compute_input_delta(ui_input*, ui_input*);
-static event_info create_event(event_type, ui_input*, uint32_t);
+static event_info create_event(ui_context, event_type, ui_input*, uint32_t);
+static string copy_name(ui_context, const string);
 
 /* creates a new sigui context */
-static ui_context new_ui_context(object state) {
-	ui_context ctx = Mem.alloc(sizeof(struct sigui_context_s));
+static ui_context new_ui_context(object state, ui_allocator alloc) {
+	if (!alloc) alloc = Allocator.standard();
+	
+	ui_context ctx = alloc->alloc(alloc, sizeof(struct sigui_context_s), ALLOC_CONTEXT);
 	if (!ctx) return NULL;
+	ctx->alloc = alloc;
 	
+	//	[NOTE] queue storage is owned by sigcore List, which has no allocator hook;
+	//	the queued items (events, commands, modules) go through the context allocator
 	ctx->modules = List.new(4);	/* initialize modules capacity -> 4 */
 	ctx->events = List.new(4);		/* initialize event queue */
 	ctx->commands = List.new(4);	/* initialize the command queue */
 	if (!ctx->modules || !ctx->events || !ctx->commands) {
-		Mem.free(ctx);
+		if (ctx->modules) List.free(ctx->modules);
+		if (ctx->events) List.free(ctx->events);
+		if (ctx->commands) List.free(ctx->commands);
+		alloc->free(alloc, ctx, ALLOC_CONTEXT);
 		return NULL;
 	}
 	
 	ctx->state = state;
 	ctx->input_state = INIT_INPUT;	/* initialize last input */
+	ctx->pacer.mode = WATCHDOG_FLAG;
 	return ctx;
 }
 /* creates a new window */
-static window new_ui_window(int x, int y, int w, int h) {
-	window win = Mem.alloc(sizeof(struct ui_window_s));
+static window new_ui_window(ui_context ctx, int x, int y, int w, int h) {
+	window win = ui_alloc(ctx, sizeof(struct ui_window_s), ALLOC_WINDOW);
 	if (!win) return NULL;
 	
 	win->x = x;
@@ -56,42 +68,125 @@ static window new_ui_window(int x, int y, int w, int h) {
 static ui_module add_module(ui_context ctx, string name, ui_render renderer, event_handler h, window win) {
 	if (!ctx || !name || !renderer) return NULL;
 	
-	ui_module m = Mem.alloc(sizeof(struct sigui_module_s));
+	ui_module m = ui_alloc(ctx, sizeof(struct sigui_module_s), ALLOC_MODULE);
 	if (!m) return NULL;
-	printf("   <Sigui> adding module name=%s\n", name);
+	DBLOG("<Sigui> adding module name=%s", name);
 	
-	m->name = String.copy(name);
+	m->name = copy_name(ctx, name);
 	m->render = renderer;
 	m->handler = h;
 	m->enabled = 1;
 	m->win = win;
+	m->ctx = ctx;
+	m->layer.opacity = 0xFF;
+	if (Hierarchy.add(ctx, m) != 0) {
+		ui_free(ctx, m->name, ALLOC_STRING);
+		ui_free(ctx, m, ALLOC_MODULE);
+		return NULL;
+	}
 	
 	List.add(ctx->modules, m);
 	
 	return m;
 }
+/* marks a module window dirty */
+static void invalidate_module(ui_module m) {
+	if (!m) return;
+	
+	m->force_record = 1;		// re-record even when retained
+	if (!m->ctx || !m->win) return;
+	Damage.add(&m->ctx->damage, (ui_rect){ m->win->x, m->win->y, m->win->width, m->win->height });
+}
+/* marks a context rect dirty */
+static void damage_rect(ui_context ctx, ui_rect r) {
+	if (!ctx) return;
+	
+	Damage.add(&ctx->damage, r);
+}
+/* copies module statistics */
+static void module_statistics(ui_module m, module_stats* out) {
+	if (m && out) *out = m->stats;
+}
+/* sets the culling viewport */
+static void set_viewport(ui_context ctx, ui_rect r) {
+	if (ctx) ctx->viewport = r;
+}
+/* copies the last frame's statistics */
+static void frame_statistics(ui_context ctx, frame_stats* out) {
+	if (ctx && out) *out = ctx->frame;
+}
 /* renders all enabled modules */
 static void render_ui(ui_context ctx, ui_input* input) {
 	if (!ctx) return;
 	if (!ctx->modules || List.count(ctx->modules) == 0) return;
-	printf("--- Frame Begin ---\n");
+	DBLOG("--- Frame Begin ---");
+	
+	ui_allocator alloc = ui_allocator_of(ctx);
+	if (alloc->begin_frame) alloc->begin_frame(alloc);
+	Pacer.begin_frame(ctx);
 	
 	generate_events(ctx, input);			//	generate ui events
+	//	steady-state: nothing was queued for this frame
+	int steady = List.count(ctx->events) == 0 && List.count(ctx->commands) == 0;
 	Dispatcher.dispatch_events(ctx);		// dispatch all events
 	Dispatcher.dispatch_commands(ctx);	//	dispatch all commands
+	Flex.update(ctx);							//	lay out windows changed by handlers
+	
+	//	cull before any callback runs (handlers may have moved windows)
+	frame_stats fs = {0};
+	Cull.modules(ctx, ui_viewport(ctx), &fs.culled_viewport, &fs.culled_occluded);
 	
 	//	render context modules
 	iterator it = Array.getIterator(ctx->modules, LIST);
 	while (Iterator.hasNext(it)) {
 		ui_module m = Iterator.next(it);
-		if (m->enabled && m->render) {
-			printf("   Rendering module: %s\n    ", m->name);  /* Show name */
-			m->render(ctx, m, input);
+		if (!m->enabled || !m->render) continue;
+		fs.modules++;
+		if (m->culled) {
+			m->stats.culled++;
+			continue;
+		}
+		
+		//	declared unchanged: keep the last draw list without calling back, unless
+		//	more of the module became visible than it was recorded for
+		if (m->retained && m->recorded && !m->force_record &&
+			 ui_rect_contains(m->draws.clip, DrawList.base_clip(ctx, m))) {
+			m->stats.retained++;
+			fs.retained++;
+			continue;
 		}
+		//	not due (rate or watchdog): keep the last draw list the same way
+		pace_result pace = Pacer.due(ctx, m);
+		if (pace != PACE_RUN && m->recorded && ui_rect_contains(m->draws.clip, DrawList.base_clip(ctx, m))) {
+			if (pace == PACE_RATE) {
+				m->stats.paced++;
+				fs.paced++;
+			} else {
+				m->stats.throttled++;
+				fs.throttled++;
+			}
+			continue;
+		}
+		DBLOG("Rendering module: %s", m->name);
+		StateStore.begin(ctx, m);				//	widget ids are scoped to the module
+		DrawList.begin(ctx, m);
+		uint64_t start = Pacer.now(ctx);
+		m->render(ctx, m, input);
+		fs.callback_ns += Pacer.ran(ctx, m, Pacer.now(ctx) - start);
+		DrawList.end(ctx, m);
+		fs.drawn++;
+		fs.primitives += m->draws.count;
+		fs.primitives_culled += m->draws.culled;
 	}
 	Iterator.free(it);
+	StateStore.begin(ctx, NULL);
+	fs.flagged = Budget.flagged(ctx, NULL, 0);
+	ctx->frame = fs;
+	TextCache.end_frame(ctx);				//	ages (and sweeps) text layouts
+	StateStore.end_frame(ctx);				//	ages (and sweeps) widget state
 	
-	printf("--- Frame End ---\n");
+	if (alloc->end_frame) alloc->end_frame(alloc, steady);
+	DBLOG("--- Frame End ---");
 	
 }
 /* frees a sigui context */
@@ -103,8 +198,8 @@ static void free_ui_context(ui_context ctx) {
 		iterator it = Array.getIterator(ctx->commands, LIST);
 		while (Iterator.hasNext(it)) {
 			command c = Iterator.next(it);
-			if (c->name) String.free(c->name);
-			Mem.free(c);
+			if (c->name) ui_free(ctx, c->name, ALLOC_STRING);
+			ui_free(ctx, c, ALLOC_COMMAND);
 		}
 		Iterator.free(it);
 		List.free(ctx->commands);
@@ -114,8 +209,8 @@ static void free_ui_context(ui_context ctx) {
 		iterator it = Array.getIterator(ctx->events, LIST);
 		while (Iterator.hasNext(it)) {
 			event_info ei = Iterator.next(it);
-			Mem.free(ei->e);
-			Mem.free(ei);
+			ui_free(ctx, ei->e, ALLOC_EVENT);
+			ui_free(ctx, ei, ALLOC_EVENT);
 		}
 		Iterator.free(it);
 		List.free(ctx->events);
@@ -125,21 +220,30 @@ static void free_ui_context(ui_context ctx) {
 		iterator it = Array.getIterator(ctx->modules, LIST);
 		while (Iterator.hasNext(it)) {
 			ui_module m = Iterator.next(it);
-			if (m->name) String.free(m->name);
-			if (m->win) Mem.free(m->win);
+			DrawList.release(ctx, m);
+			if (m->release) m->release(m);
+			if (m->name) ui_free(ctx, m->name, ALLOC_STRING);
+			if (m->win) ui_free(ctx, m->win, ALLOC_WINDOW);
+			if (m->children) ui_free(ctx, m->children, ALLOC_TREE);
 			
-			Mem.free(m);
+			ui_free(ctx, m, ALLOC_MODULE);
 		}
 		Iterator.free(it);
 		List.free(ctx->modules);
 	}
+	TextCache.release(ctx);
+	KeyTable.release(ctx);
+	Hierarchy.release(ctx);
+	FlexTree.release(ctx);
+	StateStore.release(ctx);
+	StyleCache.release(ctx);
 	
-	Mem.free(ctx);
+	ctx->alloc->free(ctx->alloc, ctx, ALLOC_CONTEXT);
 }
 
 /* event factory */
-static event_info create_event(event_type type, ui_input* input, uint32_t value) {
-	event e = Mem.alloc(sizeof(struct event_s));
+static event_info create_event(ui_context ctx, event_type type, ui_input* input, uint32_t value) {
+	event e = ui_alloc(ctx, sizeof(struct event_s), ALLOC_EVENT);
 	if (!e) return NULL;
 	
 	e->type = type;
@@ -155,16 +259,17 @@ static event_info create_event(event_type type, ui_input* input, uint32_t value)
 		case EVENT_KEY_PRESS:
 		case EVENT_KEY_RELEASE:
 			e->data.key.key_code = (int)value;
+			e->data.key.modifiers = input ? input->modifiers & KEY_MOD_ALL : 0;
 			
 			break;
 		default:
-			Mem.free(e);
+			ui_free(ctx, e, ALLOC_EVENT);
 			return NULL;
 	}
 	
-	event_info ei = Mem.alloc(sizeof(struct event_info_s));
+	event_info ei = ui_alloc(ctx, sizeof(struct event_info_s), ALLOC_EVENT);
 	if (!ei) {
-		Mem.free(e);
+		ui_free(ctx, e, ALLOC_EVENT);
 		return NULL;
 	}
 	
@@ -172,14 +277,24 @@ static event_info create_event(event_type type, ui_input* input, uint32_t value)
 	return ei;
 }
 /* command factory */
-static command create_command(const string name) {
-	command cmd = Mem.alloc(sizeof(struct command_s));
+static command create_command(ui_context ctx, const string name) {
+	command cmd = ui_alloc(ctx, sizeof(struct command_s), ALLOC_COMMAND);
 	if (!cmd) return NULL;
 	
-	cmd->name = String.copy(name);
+	cmd->name = copy_name(ctx, name);
 	
 	return cmd;
 }
+/* copies a name string through the context allocator */
+static string copy_name(ui_context ctx, const string name) {
+	if (!name) return NULL;
+	
+	size_t len = strlen(name);
+	string copy = ui_alloc(ctx, len + 1, ALLOC_STRING);
+	if (copy) memcpy(copy, name, len + 1);
+	
+	return copy;
+}
 /* generate input events */
 static void generate_events(ui_context ctx, ui_input* input) {
 	if (!ctx || !input) return;
@@ -195,28 +310,28 @@ static void generate_events(ui_context ctx, ui_input* input) {
 	
 	//	mouse events
 	if (delta.mouse_button_pressed & MOUSE_BUTTON_LEFT) {
-		event_info ei = create_event(EVENT_MOUSE_PRESS, input, MOUSE_BUTTON_LEFT);
+		event_info ei = create_event(ctx, EVENT_MOUSE_PRESS, input, MOUSE_BUTTON_LEFT);
 		if (ei) {
 			ei->e->data.mouse.button = MOUSE_BUTTON_LEFT;
 			Dispatcher.queue_event(ctx, ei);
 		}
 	}
 	if (delta.mouse_button_released & MOUSE_BUTTON_LEFT) {
-		event_info ei = create_event(EVENT_MOUSE_RELEASE, input, MOUSE_BUTTON_LEFT);
+		event_info ei = create_event(ctx, EVENT_MOUSE_RELEASE, input, MOUSE_BUTTON_LEFT);
 		if (ei) {
 			ei->e->data.mouse.button = MOUSE_BUTTON_LEFT;
 			Dispatcher.queue_event(ctx, ei);
 		}
 	}
 	if (delta.mouse_button_pressed & MOUSE_BUTTON_RIGHT) {
-		event_info ei = create_event(EVENT_MOUSE_PRESS, input, MOUSE_BUTTON_RIGHT);
+		event_info ei = create_event(ctx, EVENT_MOUSE_PRESS, input, MOUSE_BUTTON_RIGHT);
 		if (ei) {
 			ei->e->data.mouse.button = MOUSE_BUTTON_RIGHT;
 			Dispatcher.queue_event(ctx, ei);
 		}
 	}
 	if (delta.mouse_button_released & MOUSE_BUTTON_RIGHT) {
-		event_info ei = create_event(EVENT_MOUSE_RELEASE, input, MOUSE_BUTTON_RIGHT);
+		event_info ei = create_event(ctx, EVENT_MOUSE_RELEASE, input, MOUSE_BUTTON_RIGHT);
 		if (ei) {
 			ei->e->data.mouse.button = MOUSE_BUTTON_RIGHT;
 			Dispatcher.queue_event(ctx, ei);
@@ -224,15 +339,15 @@ static void generate_events(ui_context ctx, ui_input* input) {
 	}
 	/*	add more mouse buttons/wheel/move as needed */
 	
-	//	key events
+	//	key events (presses consumed by a key binding queue its command instead)
 	int i = 0;
 	while (i < sizeof(INIT_INPUT.keys)) {
-		if (delta.key_pressed[i]) {
-			event_info ei = create_event(EVENT_KEY_PRESS, input, i);
+		if (delta.key_pressed[i] && !KeyTable.press(ctx, i, input->modifiers)) {
+			event_info ei = create_event(ctx, EVENT_KEY_PRESS, input, i);
 			if (ei) Dispatcher.queue_event(ctx, ei);
 		}
-		if (delta.key_released[i]) {
-			event_info ei = create_event(EVENT_KEY_RELEASE, input, i);
+		if (delta.key_released[i] && !KeyTable.up(ctx, i)) {
+			event_info ei = create_event(ctx, EVENT_KEY_RELEASE, input, i);
 			if (ei) Dispatcher.queue_event(ctx, ei);
 		}
 		
@@ -270,5 +385,10 @@ const ISigui Sigui = {
 	.add_module = add_module,
 	.render = render_ui,
 	.new_event = create_event,
-	.new_command = create_command
+	.new_command = create_command,
+	.invalidate = invalidate_module,
+	.damage = damage_rect,
+	.stats = module_statistics,
+	.viewport = set_viewport,
+	.frame_stats = frame_statistics
 };
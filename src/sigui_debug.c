@@ -7,6 +7,19 @@ int mock_sdl_window_created = 0;
 int mock_gl_context_created = 0;
 int mock_gl_begin_called = 0;
 int mock_gl_end_called = 0;
+int mock_gl_scissor_called = 0;
+int mock_swap_called = 0;
+int mock_gl_buffer_uploads = 0;
+int mock_gl_draw_calls = 0;
+int mock_gl_fbo_binds = 0;
+int mock_gl_layers_live = 0;
+int mock_gl_index_uploads = 0;
+int mock_gl_state_calls = 0;
+int mock_gl_state_avoided = 0;
+int mock_gl_texture_uploads = 0;
+long mock_gl_texture_bytes = 0;
+int mock_gl_textures_live = 0;
+static GLuint mock_next_buffer = 1;
 
 SDL_Window* SDL_CreateWindow(const char* title, int x, int y, int w, int h, uint32_t flags) {
 	mock_sdl_window_created++;
@@ -18,7 +31,7 @@ SDL_GLContext SDL_GL_CreateContext(SDL_Window* window) {
 	return (SDL_GLContext)1;
 }
 void SDL_GL_DeleteContext(SDL_GLContext context) {}
-void SDL_GL_SwapWindow(SDL_Window* window) {}
+void SDL_GL_SwapWindow(SDL_Window* window) { mock_swap_called++; }
 int SDL_Init(uint32_t flags) {
 	mock_sdl_init_called++;
 	return 0;
@@ -30,5 +43,55 @@ void glBegin(uint32_t mode) { mock_gl_begin_called++; }
 void glVertex2i(int x, int y) {}
 void glEnd(void) { mock_gl_end_called++; }
 void glColor3f(float r, float g, float b) {}
+void glScissor(int x, int y, int w, int h) {
+	mock_gl_scissor_called++;
+	mock_gl_state_calls++;
+}
+void glEnable(uint32_t cap) { mock_gl_state_calls++; }
+void glDisable(uint32_t cap) { mock_gl_state_calls++; }
+void glGenBuffers(GLsizei n, GLuint* buffers) { while (n-- > 0) *buffers++ = mock_next_buffer++; }
+void glDeleteBuffers(GLsizei n, const GLuint* buffers) {}
+void glBindBuffer(GLenum target, GLuint buffer) { mock_gl_state_calls++; }
+void glBufferData(GLenum target, long size, const void* data, GLenum usage) {
+	if (target == GL_ELEMENT_ARRAY_BUFFER) mock_gl_index_uploads++;
+	else mock_gl_buffer_uploads++;
+}
+void glBufferSubData(GLenum target, long offset, long size, const void* data) { mock_gl_buffer_uploads++; }
+void glEnableClientState(GLenum array) {}
+void glDisableClientState(GLenum array) {}
+void glVertexPointer(int size, GLenum type, GLsizei stride, const void* ptr) {}
+void glColorPointer(int size, GLenum type, GLsizei stride, const void* ptr) {}
+void glDrawArrays(GLenum mode, int first, GLsizei count) { mock_gl_draw_calls++; }
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) { mock_gl_draw_calls++; }
+void glGenTextures(GLsizei n, GLuint* textures) {
+	mock_gl_textures_live += n;
+	while (n-- > 0) *textures++ = mock_next_buffer++;
+}
+void glDeleteTextures(GLsizei n, const GLuint* textures) { mock_gl_textures_live -= n; }
+void glBindTexture(GLenum target, GLuint texture) { mock_gl_state_calls++; }
+void glTexParameteri(GLenum target, GLenum name, int value) {}
+void glTexImage2D(GLenum target, int level, int internal, GLsizei w, GLsizei h, int border, GLenum format, GLenum type, const void* data) {
+	if (data) {
+		mock_gl_texture_uploads++;
+		mock_gl_texture_bytes += (long)w * h * (format == GL_ALPHA ? 1 : 4);
+	}
+}
+void glGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+	mock_gl_layers_live += n;
+	while (n-- > 0) *framebuffers++ = mock_next_buffer++;
+}
+void glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) { mock_gl_layers_live -= n; }
+void glBindFramebuffer(GLenum target, GLuint framebuffer) { if (framebuffer) mock_gl_fbo_binds++; }
+void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, int level) {}
+void glViewport(int x, int y, GLsizei w, GLsizei h) {}
+void glBlendFunc(GLenum sfactor, GLenum dfactor) {}
+void glColor4ub(uint8_t r, uint8_t g, uint8_t b, uint8_t a) { mock_gl_state_calls++; }
+void glTexCoord2f(float s, float t) {}
+void glTexCoordPointer(int size, GLenum type, GLsizei stride, const void* ptr) {}
+void glTexSubImage2D(GLenum target, int level, int x, int y, GLsizei w, GLsizei h, GLenum format, GLenum type, const void* data) {
+	mock_gl_texture_uploads++;
+	mock_gl_texture_bytes += (long)w * h * (format == GL_ALPHA ? 1 : 4);
+}
+void glPixelStorei(GLenum name, int value) {}
 
 #endif // SIMOCK
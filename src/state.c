@@ -0,0 +1,250 @@
+// state.c
+/**
+ * @detail Persistent widget state. Ids map to blob handles through one open-
+ * 	addressed table of 16-byte slots: Fibonacci hashing picks the home slot,
+ * 	linear probing resolves collisions, and removal shifts the following run
+ * 	back instead of leaving tombstones, so a lookup stops at the first empty
+ * 	slot and probe runs stay short as entries come and go. Blobs live in slabs
+ * 	that are never moved or freed before the context, and dropped blobs go to a
+ * 	free list sized for every blob, so once the working set has been seen the
+ * 	store does not allocate. Each lookup stamps the slot with the frame; the
+ * 	sweep visits STATE_SWEEP_SLOTS slots per frame and drops stale ones.
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+#define STATE_MIN_SLOTS 64
+
+//	Helper Functions ============================================================
+/* splitmix64 finalizer (ids are never 0) */
+static inline ui_id finish_id(uint64_t h) {
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	h ^= h >> 31;
+
+	return h ? h : 1;
+}
+/* FNV-1a of bytes continued from a scope */
+static ui_id hash_bytes(ui_id scope, const void* data, size_t size) {
+	return finish_id(ui_fnv1a(UI_FNV_OFFSET ^ scope, data, size));
+}
+static inline ui_id scope_of(const state_store* s) {
+	return s->depth ? s->stack[s->depth - 1] : 0;
+}
+static inline uint32_t home_slot(const state_store* s, ui_id id) {
+	return ui_fib_slot(id, s->bits);
+}
+static inline uint8_t* blob_at(const state_store* s, uint32_t handle) {
+	return s->slabs[handle >> 8] + (size_t)(handle & 0xFF) * STATE_BLOB_SIZE;
+}
+/* slot holding an id, or the empty slot ending its probe run */
+static state_entry* probe(state_store* s, ui_id id) {
+	uint32_t i = home_slot(s, id);
+	uint64_t probes = 1;
+	while (s->entries[i].id != id && s->entries[i].id) {
+		i = (i + 1) & s->mask;
+		probes++;
+	}
+	s->stats.probes += probes;
+
+	return &s->entries[i];
+}
+/* rehashes into a table of `slots` (a power of two) */
+static int resize_table(ui_context ctx, state_store* s, int slots) {
+	state_entry* entries = ui_alloc(ctx, sizeof(state_entry) * slots, ALLOC_STATE);
+	if (!entries) return -1;
+
+	state_entry* old = s->entries;
+	int old_slots = s->mask ? s->mask + 1 : 0;
+	s->entries = entries;
+	s->mask = slots - 1;
+	s->bits = __builtin_ctz((unsigned)slots);
+	s->cursor = 0;
+	for (int i = 0; i < old_slots; ++i) {
+		if (!old[i].id) continue;
+		uint32_t j = home_slot(s, old[i].id);
+		while (entries[j].id) j = (j + 1) & s->mask;
+		entries[j] = old[i];
+	}
+	if (old) ui_free(ctx, old, ALLOC_STATE);
+
+	return 0;
+}
+/* a free blob handle, adding a slab when none is left (~0u: out of memory) */
+static uint32_t take_blob(ui_context ctx, state_store* s) {
+	if (s->free_count) return s->free[--s->free_count];
+	if (s->slab_count >= (1 << 24)) return ~0u;
+
+	if (s->slab_count == s->slab_capacity) {
+		int grown = s->slab_capacity ? s->slab_capacity * 2 : 4;
+		uint8_t** slabs = ui_grow(ctx, s->slabs, sizeof(uint8_t*) * s->slab_count, sizeof(uint8_t*) * grown, ALLOC_STATE);
+		if (!slabs) return ~0u;
+		s->slabs = slabs;
+		s->slab_capacity = grown;
+	}
+	//	the free list holds every blob, so dropping one never allocates
+	int blobs = (s->slab_count + 1) * STATE_SLAB_BLOBS;
+	if (blobs > s->free_capacity) {
+		uint32_t* free = ui_grow(ctx, s->free, sizeof(uint32_t) * s->free_count, sizeof(uint32_t) * blobs, ALLOC_STATE);
+		if (!free) return ~0u;
+		s->free = free;
+		s->free_capacity = blobs;
+	}
+	uint8_t* slab = ui_alloc(ctx, (size_t)STATE_SLAB_BLOBS * STATE_BLOB_SIZE, ALLOC_STATE);
+	if (!slab) return ~0u;
+
+	uint32_t base = (uint32_t)s->slab_count << 8;
+	s->slabs[s->slab_count++] = slab;
+	for (int i = STATE_SLAB_BLOBS - 1; i > 0; --i) s->free[s->free_count++] = base | i;
+	s->stats.slabs = s->slab_count;
+
+	return base;
+}
+/* empties a slot, shifting the rest of its probe run back */
+static void remove_slot(state_store* s, uint32_t i) {
+	s->free[s->free_count++] = s->entries[i].blob;
+	s->count--;
+	for (uint32_t j = (i + 1) & s->mask; s->entries[j].id; j = (j + 1) & s->mask) {
+		//	an entry may fill the hole when the hole lies between its home and it
+		uint32_t home = home_slot(s, s->entries[j].id);
+		if (((j - home) & s->mask) >= ((j - i) & s->mask)) {
+			s->entries[i] = s->entries[j];
+			i = j;
+		}
+	}
+	s->entries[i].id = 0;
+}
+
+//	State Store (internal) ======================================================
+static void begin_scope(ui_context ctx, ui_module m) {
+	state_store* s = &ctx->store;
+	s->depth = m ? 1 : 0;
+	if (m) s->stack[0] = finish_id((uint64_t)(uintptr_t)m);
+}
+/* ages entries; stale ones found by the bounded sweep are dropped */
+static void end_state_frame(ui_context ctx) {
+	state_store* s = &ctx->store;
+	s->frame++;
+	if (!s->count) return;
+
+	uint32_t keep = s->keep > 0 ? (uint32_t)s->keep : STATE_KEEP_FRAMES;
+	for (int n = 0; n < STATE_SWEEP_SLOTS; ++n) {
+		state_entry* e = &s->entries[s->cursor];
+		if (e->id && s->frame - e->used > keep) {
+			remove_slot(s, s->cursor);
+			s->stats.collected++;
+			continue;		// the slot may now hold a shifted entry
+		}
+		s->cursor = (s->cursor + 1) & s->mask;
+	}
+}
+static void release_store(ui_context ctx) {
+	state_store* s = &ctx->store;
+	for (int i = 0; i < s->slab_count; ++i) ui_free(ctx, s->slabs[i], ALLOC_STATE);
+	if (s->slabs) ui_free(ctx, s->slabs, ALLOC_STATE);
+	if (s->free) ui_free(ctx, s->free, ALLOC_STATE);
+	if (s->entries) ui_free(ctx, s->entries, ALLOC_STATE);
+	*s = (state_store){ 0 };
+}
+
+//	Widget State Interface ======================================================
+static ui_id label_id(ui_context ctx, const string label) {
+	if (!ctx || !label) return 0;
+
+	return hash_bytes(scope_of(&ctx->store), label, strlen(label));
+}
+static ui_id data_id(ui_context ctx, const void* data, size_t size) {
+	if (!ctx || (!data && size)) return 0;
+
+	return hash_bytes(scope_of(&ctx->store), data, size);
+}
+static int push_id(ui_context ctx, ui_id id) {
+	if (!ctx || ctx->store.depth == STATE_ID_DEPTH) return -1;
+
+	ctx->store.stack[ctx->store.depth++] = id;
+	return 0;
+}
+/* the recording module's scope stays */
+static void pop_id(ui_context ctx) {
+	if (ctx && ctx->store.depth > (ctx->recording ? 1 : 0)) ctx->store.depth--;
+}
+static object get_state(ui_context ctx, ui_id id, int* created) {
+	if (created) *created = 0;
+	if (!ctx || !id) return NULL;
+	state_store* s = &ctx->store;
+	s->stats.lookups++;
+
+	if (s->mask) {
+		state_entry* e = probe(s, id);
+		if (e->id == id) {
+			e->used = s->frame;
+			return blob_at(s, e->blob);
+		}
+	}
+	//	keep the load at or under one half
+	if ((s->count + 1) * 2 > (s->mask ? s->mask + 1 : 0)) {
+		int slots = s->mask ? (s->mask + 1) * 2 : STATE_MIN_SLOTS;
+		if (resize_table(ctx, s, slots) != 0) return NULL;
+	}
+	uint32_t handle = take_blob(ctx, s);
+	if (handle == ~0u) return NULL;
+
+	state_entry* e = probe(s, id);
+	*e = (state_entry){ .id = id, .blob = handle, .used = s->frame };
+	s->count++;
+	s->stats.created++;
+	if (created) *created = 1;
+
+	uint8_t* blob = blob_at(s, handle);
+	memset(blob, 0, STATE_BLOB_SIZE);
+	return blob;
+}
+static object find_state(ui_context ctx, ui_id id) {
+	if (!ctx || !id || !ctx->store.mask) return NULL;
+	state_store* s = &ctx->store;
+	s->stats.lookups++;
+
+	state_entry* e = probe(s, id);
+	if (e->id != id) return NULL;
+	e->used = s->frame;
+	return blob_at(s, e->blob);
+}
+static void forget_state(ui_context ctx, ui_id id) {
+	if (!ctx || !id || !ctx->store.mask) return;
+	state_store* s = &ctx->store;
+
+	state_entry* e = probe(s, id);
+	if (e->id == id) remove_slot(s, (uint32_t)(e - s->entries));
+}
+static void keep_frames(ui_context ctx, int frames) {
+	if (ctx) ctx->store.keep = frames;
+}
+static void state_statistics(ui_context ctx, state_stats* out) {
+	if (!ctx || !out) return;
+
+	*out = ctx->store.stats;
+	out->live = ctx->store.count;
+	out->slots = ctx->store.mask ? ctx->store.mask + 1 : 0;
+}
+
+/* state store interface (internal) */
+const IStateStore StateStore = {
+	.begin = begin_scope,
+	.end_frame = end_state_frame,
+	.release = release_store
+};
+/* widget state interface */
+const IWidgetState WidgetState = {
+	.id = label_id,
+	.id_data = data_id,
+	.push = push_id,
+	.pop = pop_id,
+	.get = get_state,
+	.find = find_state,
+	.forget = forget_state,
+	.keep = keep_frames,
+	.stats = state_statistics
+};
@@ -0,0 +1,278 @@
+// style.c
+/**
+ * @detail Themes and resolved styles. Rules are kept per class as registered;
+ * 	nothing is compiled up front. A resolve hashes (class, state, overrides)
+ * 	into an open-addressed index of interned records: a record resolved at the
+ * 	current theme generation is returned as is, a stale one is re-resolved in
+ * 	place (its address does not change) and a missing one is resolved into a
+ * 	new slot. Resolving walks the class chain once per specificity level, so it
+ * 	only runs when a key is first seen or after the theme changed. Records live
+ * 	in chunks that are never moved; at STYLE_CACHE_MAX records the index is
+ * 	emptied and the chunks reused.
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+#define STYLE_STATE_BITS 5
+
+//	Helper Functions ============================================================
+static uint64_t mix(uint64_t h, uint64_t v) {
+	h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+	return h * 0xBF58476D1CE4E5B9ull;
+}
+static uint64_t hash_key(int cls, uint32_t states, const style_rule* o) {
+	uint64_t h = mix(mix(UI_FNV_OFFSET, (uint32_t)cls), states);
+	if (!o) return h;
+
+	//	only the properties the overrides set take part
+	const ui_style* v = &o->values;
+	h = mix(h, o->set);
+	if (o->set & STYLE_BACKGROUND) h = mix(h, v->background);
+	if (o->set & STYLE_TEXT) h = mix(h, v->text);
+	if (o->set & STYLE_BORDER_COLOR) h = mix(h, v->border_color);
+	if (o->set & STYLE_BORDER) h = mix(h, (uint16_t)v->border);
+	if (o->set & STYLE_RADIUS) h = mix(h, (uint16_t)v->radius);
+	if (o->set & STYLE_PADDING) h = mix(h, (uint64_t)(uint16_t)v->padding[0] << 48 | (uint64_t)(uint16_t)v->padding[1] << 32 |
+														 (uint32_t)(uint16_t)v->padding[2] << 16 | (uint16_t)v->padding[3]);
+	if (o->set & STYLE_FONT) h = mix(h, (uint32_t)v->font);
+
+	return h;
+}
+/* copies the properties a rule sets */
+static void apply(ui_style* s, const style_rule* r) {
+	const ui_style* v = &r->values;
+	if (r->set & STYLE_BACKGROUND) s->background = v->background;
+	if (r->set & STYLE_TEXT) s->text = v->text;
+	if (r->set & STYLE_BORDER_COLOR) s->border_color = v->border_color;
+	if (r->set & STYLE_BORDER) s->border = v->border;
+	if (r->set & STYLE_RADIUS) s->radius = v->radius;
+	if (r->set & STYLE_PADDING) memcpy(s->padding, v->padding, sizeof(s->padding));
+	if (r->set & STYLE_FONT) s->font = v->font;
+}
+/* overrides match when they set the same properties to the same values */
+static int same_overrides(const style_record* rec, const style_rule* o) {
+	if (!o) return !rec->overridden;
+	if (!rec->overridden || rec->overrides.set != o->set) return 0;
+
+	ui_style a = { 0 }, b = { 0 };
+	apply(&a, &rec->overrides);
+	apply(&b, o);
+	return memcmp(&a, &b, sizeof(ui_style)) == 0;
+}
+static inline style_record* record_at(theme* t, int i) {
+	return &t->chunks[i / STYLE_CHUNK][i % STYLE_CHUNK];
+}
+/* the global class exists from the first theme call on */
+static int ensure_global(ui_context ctx) {
+	theme* t = &ctx->theme;
+	if (t->class_count) return 0;
+
+	t->classes = ui_grow(ctx, NULL, 0, sizeof(style_class) * 8, ALLOC_STYLE);
+	if (!t->classes) return -1;
+	t->class_capacity = 8;
+	t->class_count = 1;
+	t->classes[0] = (style_class){ .parent = -1 };
+	t->defaults = (ui_style){ .text = UI_RGB(0xE0, 0xE0, 0xE0), .font = UI_FONT_DEFAULT };
+	t->stats.classes = 1;
+
+	return 0;
+}
+/* every theme change goes through here */
+static void bump(theme* t) {
+	t->generation++;
+	t->stats.generation = t->generation;
+}
+/* applies the rules of a class chain over the defaults */
+static void resolve_into(theme* t, style_record* rec) {
+	int chain[STYLE_CLASS_DEPTH], depth = 0;
+	for (int c = rec->cls; c >= 0 && depth < STYLE_CLASS_DEPTH; c = t->classes[c].parent) chain[depth++] = c;
+
+	ui_style s = t->defaults;
+	for (int level = 0; level <= STYLE_STATE_BITS; ++level) {
+		for (int d = depth - 1; d >= 0; --d) {
+			const style_class* sc = &t->classes[chain[d]];
+			for (int i = 0; i < sc->rule_count; ++i) {
+				const style_class_rule* r = &sc->rules[i];
+				if (__builtin_popcount(r->states) == level && (r->states & ~rec->states) == 0) apply(&s, &r->rule);
+			}
+		}
+	}
+	if (rec->overridden) apply(&s, &rec->overrides);
+
+	rec->style = s;
+	rec->generation = t->generation;
+	t->stats.resolved++;
+}
+/* empties the index (chunks are reused) */
+static void flush(theme* t) {
+	if (t->index) memset(t->index, 0, sizeof(int) * (t->index_mask + 1));
+	t->count = 0;
+	t->stats.flushes++;
+}
+/* index sized for at least `records` at one half load */
+static int grow_index(ui_context ctx, theme* t, int records) {
+	int slots = 64;
+	while (slots < records * 2) slots *= 2;
+	if (t->index && slots <= t->index_mask + 1) return 0;
+
+	int* index = ui_alloc(ctx, sizeof(int) * slots, ALLOC_STYLE);
+	if (!index) return -1;
+	for (int i = 0; i < t->count; ++i) {
+		uint32_t s = (uint32_t)record_at(t, i)->hash & (slots - 1);
+		while (index[s]) s = (s + 1) & (slots - 1);
+		index[s] = i + 1;
+	}
+	if (t->index) ui_free(ctx, t->index, ALLOC_STYLE);
+	t->index = index;
+	t->index_mask = slots - 1;
+
+	return 0;
+}
+
+//	Theme Interface =============================================================
+static int add_class(ui_context ctx, const string name, int parent) {
+	if (!ctx || !name || ensure_global(ctx) != 0) return -1;
+	theme* t = &ctx->theme;
+	if (parent < 0 || parent >= t->class_count) return -1;
+	for (int i = 1; i < t->class_count; ++i) {
+		if (!strcmp(t->classes[i].name, name)) return i;
+	}
+	if (t->classes[parent].depth + 2 > STYLE_CLASS_DEPTH) return -1;
+
+	if (t->class_count == t->class_capacity) {
+		style_class* grown = ui_grow(ctx, t->classes, sizeof(style_class) * t->class_count,
+											  sizeof(style_class) * t->class_capacity * 2, ALLOC_STYLE);
+		if (!grown) return -1;
+		t->classes = grown;
+		t->class_capacity *= 2;
+	}
+	size_t len = strlen(name);
+	string copy = ui_alloc(ctx, len + 1, ALLOC_STYLE);
+	if (!copy) return -1;
+	memcpy(copy, name, len + 1);
+
+	t->classes[t->class_count] = (style_class){ .name = copy, .parent = parent, .depth = t->classes[parent].depth + 1 };
+	t->stats.classes = t->class_count + 1;
+	return t->class_count++;
+}
+static int add_rule(ui_context ctx, int cls, uint32_t states, const style_rule* rule) {
+	if (!ctx || !rule || ensure_global(ctx) != 0) return -1;
+	theme* t = &ctx->theme;
+	if (cls < 0 || cls >= t->class_count) return -1;
+
+	style_class* sc = &t->classes[cls];
+	if (sc->rule_count == sc->rule_capacity) {
+		int grown = sc->rule_capacity ? sc->rule_capacity * 2 : 4;
+		style_class_rule* rules = ui_grow(ctx, sc->rules, sizeof(style_class_rule) * sc->rule_count,
+													 sizeof(style_class_rule) * grown, ALLOC_STYLE);
+		if (!rules) return -1;
+		sc->rules = rules;
+		sc->rule_capacity = grown;
+	}
+	sc->rules[sc->rule_count++] = (style_class_rule){ .states = states & STYLE_STATE_ALL, .rule = *rule };
+	t->stats.rules = ++t->rule_count;
+	bump(t);
+
+	return 0;
+}
+static void set_defaults(ui_context ctx, const ui_style* s) {
+	if (!ctx || !s || ensure_global(ctx) != 0) return;
+
+	ctx->theme.defaults = *s;
+	bump(&ctx->theme);
+}
+static void clear_rules(ui_context ctx) {
+	if (!ctx) return;
+	theme* t = &ctx->theme;
+
+	for (int i = 0; i < t->class_count; ++i) t->classes[i].rule_count = 0;
+	t->rule_count = t->stats.rules = 0;
+	bump(t);
+}
+/* one probe for a current record; stale records are re-resolved in place */
+static const ui_style* resolve_style(ui_context ctx, int cls, uint32_t states, const style_rule* overrides) {
+	if (!ctx || ensure_global(ctx) != 0) return NULL;
+	theme* t = &ctx->theme;
+	if (cls < 0 || cls >= t->class_count) cls = 0;
+	states &= STYLE_STATE_ALL;
+	t->stats.lookups++;
+
+	uint64_t h = hash_key(cls, states, overrides);
+	if (t->index) {
+		for (uint32_t s = (uint32_t)h & t->index_mask; t->index[s]; s = (s + 1) & t->index_mask) {
+			style_record* rec = record_at(t, t->index[s] - 1);
+			if (rec->hash != h || rec->cls != cls || rec->states != states || !same_overrides(rec, overrides)) continue;
+			if (rec->generation == t->generation) t->stats.hits++;
+			else resolve_into(t, rec);
+			return &rec->style;
+		}
+	}
+
+	//	new key: take the next record
+	if (t->count == STYLE_CACHE_MAX) flush(t);
+	if (grow_index(ctx, t, t->count + 1) != 0) return NULL;
+	if (t->count == t->chunk_count * STYLE_CHUNK) {
+		if (t->chunk_count == t->chunk_capacity) {
+			int grown = t->chunk_capacity ? t->chunk_capacity * 2 : 4;
+			style_record** chunks = ui_grow(ctx, t->chunks, sizeof(style_record*) * t->chunk_count,
+													  sizeof(style_record*) * grown, ALLOC_STYLE);
+			if (!chunks) return NULL;
+			t->chunks = chunks;
+			t->chunk_capacity = grown;
+		}
+		style_record* chunk = ui_alloc(ctx, sizeof(style_record) * STYLE_CHUNK, ALLOC_STYLE);
+		if (!chunk) return NULL;
+		t->chunks[t->chunk_count++] = chunk;
+	}
+	int i = t->count++;
+	style_record* rec = record_at(t, i);
+	*rec = (style_record){ .hash = h, .cls = cls, .states = states, .overridden = overrides != NULL };
+	if (overrides) rec->overrides = *overrides;
+	resolve_into(t, rec);
+
+	uint32_t s = (uint32_t)h & t->index_mask;
+	while (t->index[s]) s = (s + 1) & t->index_mask;
+	t->index[s] = i + 1;
+	t->stats.cached = t->count;
+
+	return &rec->style;
+}
+static uint32_t theme_generation(ui_context ctx) {
+	return ctx ? ctx->theme.generation : 0;
+}
+static void theme_statistics(ui_context ctx, style_stats* out) {
+	if (!ctx || !out) return;
+
+	*out = ctx->theme.stats;
+	out->cached = ctx->theme.count;
+}
+
+//	Style Cache (internal) ======================================================
+static void release_theme(ui_context ctx) {
+	theme* t = &ctx->theme;
+	for (int i = 0; i < t->class_count; ++i) {
+		if (t->classes[i].name) ui_free(ctx, t->classes[i].name, ALLOC_STYLE);
+		if (t->classes[i].rules) ui_free(ctx, t->classes[i].rules, ALLOC_STYLE);
+	}
+	if (t->classes) ui_free(ctx, t->classes, ALLOC_STYLE);
+	for (int i = 0; i < t->chunk_count; ++i) ui_free(ctx, t->chunks[i], ALLOC_STYLE);
+	if (t->chunks) ui_free(ctx, t->chunks, ALLOC_STYLE);
+	if (t->index) ui_free(ctx, t->index, ALLOC_STYLE);
+	*t = (theme){ 0 };
+}
+
+/* theme interface */
+const ITheme Theme = {
+	.add_class = add_class,
+	.rule = add_rule,
+	.defaults = set_defaults,
+	.clear = clear_rules,
+	.resolve = resolve_style,
+	.generation = theme_generation,
+	.stats = theme_statistics
+};
+/* style cache interface (internal) */
+const IStyleCache StyleCache = {
+	.release = release_theme
+};
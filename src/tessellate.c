@@ -0,0 +1,310 @@
+// tessellate.c
+/**
+ * @detail Shape tessellation. Borders, rounded rects, lines and shadows become
+ * 	triangle meshes in shape-local coordinates with per-vertex coverage: every
+ * 	edge is bracketed by two rings half a pixel inside (coverage 1) and half a
+ * 	pixel outside (coverage 0), so interpolated coverage is the analytic
+ * 	`0.5 - distance` at pixel centers. Pixel-aligned straight edges stay crisp
+ * 	because the ramp runs exactly between two pixel centers; shadows use a ramp
+ * 	`blur` pixels wide. Meshes are cached per target by shape parameters and
+ * 	emitted translated and colored, four vertices (eight indices) at a time with
+ * 	SSE2 where available.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "render_core.h"
+#include "sigui_debug.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define RING_MAX (4 * (TESS_SEGMENTS_MAX + 1))
+#define HALF_PI 1.57079632679489661923f
+
+//	Helper Functions ============================================================
+static unsigned slot_of(uint64_t h, int capacity) {
+	return (unsigned)(h >> 32) & (capacity - 1);
+}
+/* arc segments per corner: about one per two pixels of radius */
+static int segments_for(float radius) {
+	int n = (int)(radius + 1.0f) / 2 + 1;
+	return n < 1 ? 1 : n > TESS_SEGMENTS_MAX ? TESS_SEGMENTS_MAX : n;
+}
+
+//	Mesh Building ===============================================================
+/* mesh under construction (local scratch) */
+typedef struct builder_s {
+	float x[4 * RING_MAX], y[4 * RING_MAX], cov[4 * RING_MAX];
+	uint16_t idx[6 * 4 * RING_MAX];
+	int vertices, indices;
+} builder;
+
+static int vertex(builder* b, float x, float y, float cov) {
+	b->x[b->vertices] = x;
+	b->y[b->vertices] = y;
+	b->cov[b->vertices] = cov;
+	return b->vertices++;
+}
+static void triangle(builder* b, int i0, int i1, int i2) {
+	b->idx[b->indices++] = (uint16_t)i0;
+	b->idx[b->indices++] = (uint16_t)i1;
+	b->idx[b->indices++] = (uint16_t)i2;
+}
+/*
+ *	Appends the outline of a (x, y, w, h) rect with corner radius r, offset
+ *	outwards by o (< 0: inwards): 4 * (n + 1) points clockwise from the left end
+ *	of the top-left arc; returns the first vertex
+ */
+static int ring(builder* b, float x, float y, float w, float h, float r, float o, int n, float cov) {
+	float R = r + o > 0 ? r + o : 0;
+	float cx[4] = { x - o + R, x + w + o - R, x + w + o - R, x - o + R };
+	float cy[4] = { y - o + R, y - o + R, y + h + o - R, y + h + o - R };
+	int first = b->vertices;
+	for (int c = 0; c < 4; ++c) {
+		float a0 = HALF_PI * (2 + c);		// left, up, right, down
+		for (int s = 0; s <= n; ++s) {
+			float a = a0 + HALF_PI * s / n;
+			vertex(b, cx[c] + R * cosf(a), cy[c] + R * sinf(a), cov);
+		}
+	}
+
+	return first;
+}
+/* triangles between two rings of `count` points */
+static void strip(builder* b, int outer, int inner, int count) {
+	for (int i = 0; i < count; ++i) {
+		int j = (i + 1) % count;
+		triangle(b, inner + i, outer + i, outer + j);
+		triangle(b, inner + i, outer + j, inner + j);
+	}
+}
+/* convex fan over a polygon */
+static void fan(builder* b, int first, int count) {
+	for (int i = 1; i + 1 < count; ++i) triangle(b, first, first + i, first + i + 1);
+}
+/*
+ *	Fills a ring of four n-segment corners: small fans inside each corner and one
+ *	octagon over the corner endpoints, so no triangle spans the whole shape twice
+ *	(the CPU rasterizer walks every row of every triangle)
+ */
+static void fill_ring(builder* b, int first, int n) {
+	int octagon[8];
+	for (int c = 0; c < 4; ++c) {
+		int corner = first + c * (n + 1);
+		for (int s = 1; s < n; ++s) triangle(b, corner, corner + s, corner + s + 1);
+		octagon[2 * c] = corner;
+		octagon[2 * c + 1] = corner + n;
+	}
+	for (int k = 1; k + 1 < 8; ++k) triangle(b, octagon[0], octagon[k], octagon[k + 1]);
+}
+/* filled rounded rect; coverage ramps over `fringe` pixels centered on the edge */
+static void build_fill(builder* b, float w, float h, float r, float fringe) {
+	int n = segments_for(r + fringe / 2);
+	int count = 4 * (n + 1);
+	int inner = ring(b, 0, 0, w, h, r, -fringe / 2, n, 1.0f);
+	int outer = ring(b, 0, 0, w, h, r, fringe / 2, n, 0.0f);
+	fill_ring(b, inner, n);
+	strip(b, outer, inner, count);
+}
+/* outline of `width` pixels; the inner edge has radius r - width */
+static void build_border(builder* b, float w, float h, float r, float width) {
+	int n = segments_for(r + 0.5f);
+	int count = 4 * (n + 1);
+	float ir = r > width ? r - width : 0;
+	int a = ring(b, 0, 0, w, h, r, 0.5f, n, 0.0f);
+	int o = ring(b, 0, 0, w, h, r, -0.5f, n, 1.0f);
+	int i = ring(b, width, width, w - 2 * width, h - 2 * width, ir, 0.5f, n, 1.0f);
+	int d = ring(b, width, width, w - 2 * width, h - 2 * width, ir, -0.5f, n, 0.0f);
+	strip(b, a, o, count);
+	strip(b, o, i, count);
+	strip(b, i, d, count);
+}
+/* butt-capped segment from (0, 0) to (dx, dy); hairlines scale their coverage */
+static void build_line(builder* b, float dx, float dy, float width) {
+	float length = sqrtf(dx * dx + dy * dy);
+	float ux = dx / length, uy = dy / length;		// along
+	float nx = -uy, ny = ux;							// across
+	float half = width / 2;
+	float inner = half > 0.5f ? half - 0.5f : 0, outer = half + 0.5f;
+	float cov = half > 0.5f ? 1.0f : width;
+	float start = length > 1 ? 0.5f : length / 2, end = length - start;
+
+	//	inner and outer rectangles, same corner order
+	float along[4] = { start, end, end, start }, side[4] = { -1, -1, 1, 1 };
+	int in = b->vertices;
+	for (int c = 0; c < 4; ++c) vertex(b, ux * along[c] + nx * side[c] * inner, uy * along[c] + ny * side[c] * inner, cov);
+	float cap[4] = { -0.5f, length + 0.5f, length + 0.5f, -0.5f };
+	int out = b->vertices;
+	for (int c = 0; c < 4; ++c) vertex(b, ux * cap[c] + nx * side[c] * outer, uy * cap[c] + ny * side[c] * outer, 0.0f);
+	fan(b, in, 4);
+	strip(b, out, in, 4);
+}
+
+//	Cache =======================================================================
+static int find_mesh(const tess_cache* tc, const tess_key* k, uint64_t h) {
+	if (!tc->index) return -1;
+
+	unsigned s = slot_of(h, tc->index_capacity);
+	while (tc->index[s]) {
+		const tess_mesh* m = &tc->meshes[tc->index[s] - 1];
+		if (memcmp(&m->key, k, sizeof(tess_key)) == 0) return tc->index[s] - 1;
+		s = (s + 1) & (tc->index_capacity - 1);
+	}
+
+	return -1;
+}
+/* drops every mesh (module caches hold copies, so nothing refers to them) */
+static void flush(tess_cache* tc) {
+	DBLOG("<Tess> flushing %d meshes", tc->count);
+	tc->count = 0;
+	tc->float_count = 0;
+	tc->index_count = 0;
+	if (tc->index) memset(tc->index, 0, sizeof(int) * tc->index_capacity);
+	tc->flushes++;
+}
+/* stores a built mesh; returns it (NULL=no memory) */
+static const tess_mesh* add_mesh(tess_cache* tc, const tess_key* k, uint64_t h, const builder* b) {
+	if (tc->count >= TESS_CACHE_MAX) flush(tc);
+
+	int padded = (b->vertices + 3) & ~3;
+	if (ui_grow_array((void**)&tc->meshes, &tc->capacity, tc->count + 1, sizeof(tess_mesh), 256) != 0 ||
+		 ui_grow_array((void**)&tc->floats, &tc->float_capacity, tc->float_count + 3 * padded, sizeof(float), 256) != 0 ||
+		 ui_grow_array((void**)&tc->indices, &tc->index_pool_capacity, tc->index_count + b->indices, sizeof(uint16_t), 256) != 0) return NULL;
+	if (!tc->index) {
+		tc->index = Mem.alloc(sizeof(int) * TESS_CACHE_MAX * 2);
+		if (!tc->index) return NULL;
+		memset(tc->index, 0, sizeof(int) * TESS_CACHE_MAX * 2);
+		tc->index_capacity = TESS_CACHE_MAX * 2;
+	}
+
+	tess_mesh* m = &tc->meshes[tc->count];
+	m->key = *k;
+	m->vertex_count = b->vertices;
+	m->index_count = b->indices;
+	m->padded = padded;
+	m->vertices = tc->float_count;
+	m->indices = tc->index_count;
+	float* x = tc->floats + m->vertices;
+	memset(x, 0, sizeof(float) * 3 * padded);
+	memcpy(x, b->x, sizeof(float) * b->vertices);
+	memcpy(x + padded, b->y, sizeof(float) * b->vertices);
+	memcpy(x + 2 * padded, b->cov, sizeof(float) * b->vertices);
+	memcpy(tc->indices + m->indices, b->idx, sizeof(uint16_t) * b->indices);
+	tc->float_count += 3 * padded;
+	tc->index_count += b->indices;
+
+	m->x0 = m->y0 = 1e30f;
+	m->x1 = m->y1 = -1e30f;
+	for (int i = 0; i < b->vertices; ++i) {
+		if (b->x[i] < m->x0) m->x0 = b->x[i];
+		if (b->y[i] < m->y0) m->y0 = b->y[i];
+		if (b->x[i] > m->x1) m->x1 = b->x[i];
+		if (b->y[i] > m->y1) m->y1 = b->y[i];
+	}
+
+	unsigned s = slot_of(h, tc->index_capacity);
+	while (tc->index[s]) s = (s + 1) & (tc->index_capacity - 1);
+	tc->index[s] = ++tc->count;
+
+	return m;
+}
+
+/* cached mesh of a border, rounded rect, line or shadow (NULL=nothing to draw) */
+static const tess_mesh* shape_mesh(tess_cache* tc, const draw_cmd* cmd) {
+	tess_key k;
+	memset(&k, 0, sizeof(k));		// hashed as bytes
+	k.kind = cmd->kind;
+	k.border = cmd->border;
+	if (cmd->kind == DRAW_LINE) {
+		k.dx = cmd->points[2] - cmd->points[0];
+		k.dy = cmd->points[3] - cmd->points[1];
+		if (!k.dx && !k.dy) return NULL;
+	} else {
+		if (cmd->rect.width <= 0 || cmd->rect.height <= 0) return NULL;
+		k.width = cmd->rect.width;
+		k.height = cmd->rect.height;
+		k.radius = cmd->radius;
+	}
+
+	uint64_t h = ui_fnv1a(UI_FNV_OFFSET, &k, sizeof(tess_key));
+	int hit = find_mesh(tc, &k, h);
+	if (hit >= 0) {
+		tc->hits++;
+		return &tc->meshes[hit];
+	}
+	tc->misses++;
+
+	builder b;
+	b.vertices = b.indices = 0;
+	float w = (float)k.width, hgt = (float)k.height;
+	float limit = (w < hgt ? w : hgt) / 2;
+	float r = k.radius < limit ? (float)k.radius : limit;
+	switch (k.kind) {
+		case DRAW_BORDER:
+			if (2.0f * k.border < w && 2.0f * k.border < hgt) build_border(&b, w, hgt, r, (float)k.border);
+			else build_fill(&b, w, hgt, r, 1.0f);
+			break;
+		case DRAW_ROUNDED: build_fill(&b, w, hgt, r, 1.0f); break;
+		case DRAW_SHADOW: build_fill(&b, w, hgt, r, (float)k.border); break;
+		case DRAW_LINE: build_line(&b, (float)k.dx, (float)k.dy, (float)k.border); break;
+		default: return NULL;
+	}
+
+	return add_mesh(tc, &k, h, &b);
+}
+/* writes a mesh translated by (x, y) in a color, and its indices rebased on `base` */
+static void emit_mesh(const tess_cache* tc, const tess_mesh* m, float x, float y, uint32_t argb,
+							 ui_vertex* out, uint32_t* indices, uint32_t base) {
+	const float* xs = tc->floats + m->vertices;
+	const float* ys = xs + m->padded;
+	const float* cov = ys + m->padded;
+	const uint16_t* idx = tc->indices + m->indices;
+	uint8_t r = argb >> 16, g = argb >> 8, b = argb;
+	float alpha = (float)(argb >> 24);
+	int n = m->vertex_count;
+
+	int i = 0;
+#ifdef __SSE2__
+	__m128 tx = _mm_set1_ps(x), ty = _mm_set1_ps(y), ta = _mm_set1_ps(alpha);
+	for (; i < n; i += 4) {
+		float px[4], py[4];
+		int32_t pa[4];
+		_mm_storeu_ps(px, _mm_add_ps(_mm_loadu_ps(xs + i), tx));
+		_mm_storeu_ps(py, _mm_add_ps(_mm_loadu_ps(ys + i), ty));
+		_mm_storeu_si128((__m128i*)pa, _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(cov + i), ta)));
+		int lanes = n - i < 4 ? n - i : 4;
+		for (int k = 0; k < lanes; ++k) {
+			out[i + k] = (ui_vertex){ px[k], py[k], -1.0f, -1.0f, { r, g, b, (uint8_t)pa[k] } };
+		}
+	}
+	__m128i zero = _mm_setzero_si128(), tb = _mm_set1_epi32((int)base);
+	int j = 0;
+	for (; j + 8 <= m->index_count; j += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(idx + j));
+		_mm_storeu_si128((__m128i*)(indices + j), _mm_add_epi32(_mm_unpacklo_epi16(v, zero), tb));
+		_mm_storeu_si128((__m128i*)(indices + j + 4), _mm_add_epi32(_mm_unpackhi_epi16(v, zero), tb));
+	}
+	for (; j < m->index_count; ++j) indices[j] = base + idx[j];
+#else
+	for (; i < n; ++i) {
+		out[i] = (ui_vertex){ xs[i] + x, ys[i] + y, -1.0f, -1.0f, { r, g, b, (uint8_t)(cov[i] * alpha + 0.5f) } };
+	}
+	for (int j = 0; j < m->index_count; ++j) indices[j] = base + idx[j];
+#endif
+}
+/* frees the cache storage */
+static void release_cache(tess_cache* tc) {
+	if (tc->meshes) Mem.free(tc->meshes);
+	if (tc->index) Mem.free(tc->index);
+	if (tc->floats) Mem.free(tc->floats);
+	if (tc->indices) Mem.free(tc->indices);
+	memset(tc, 0, sizeof(tess_cache));
+}
+
+/* tessellation interface (internal) */
+const ITess Tess = {
+	.mesh = shape_mesh,
+	.emit = emit_mesh,
+	.release = release_cache
+};
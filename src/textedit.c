@@ -0,0 +1,751 @@
+// textedit.c
+/**
+ * @detail Text editor over a piece table. The original document is a read-only
+ * 	file mapping; inserted bytes go to an append buffer. Pieces (runs of either)
+ * 	are the nodes of an implicit treap ordered by document position; every node
+ * 	sums the bytes, newlines, pieces and not-yet-scanned pieces of its subtree.
+ * 	Inserting splits the tree at an offset and merges the new pieces in; erasing
+ * 	splits twice and drops the middle. Pieces are capped at EDIT_PIECE_MAX bytes
+ * 	so the scans inside one piece (splitting, k-th newline) are bounded.
+ *
+ * 	A freshly opened file is one unscanned piece per EDIT_PIECE_MAX bytes and
+ * 	nothing is read. Newlines are counted piece by piece in document order: up
+ * 	to the line or offset being asked for, and a slice per frame in the
+ * 	background. Sums over unscanned pieces count no newlines, which is harmless
+ * 	because lookups only run once every piece before their answer is scanned.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ui_core.h"
+#include "sigui_widgets.h"
+#include "sigui_debug.h"
+
+#define EDIT_LINE_MAX 512						/* bytes of a line laid out */
+#define EDIT_ROWS_MAX 256						/* lines laid out per frame */
+#define EDIT_SCAN_FRAME (16 * EDIT_PIECE_MAX)	/* original bytes indexed per frame in the background */
+#define EDIT_PAD 4								/* text inset from the left edge */
+
+#define NODE(ed, i) (&(ed)->nodes[i])
+
+/* piece sources */
+typedef enum {
+	PIECE_ORIGINAL,							/* mapped file */
+	PIECE_ADDED									/* append buffer */
+} piece_source;
+/* piece table node (index 0: empty sentinel) */
+typedef struct edit_node_s {
+	int left, right;							/* children */
+	uint32_t priority;						/* treap heap key */
+	uint8_t source;							/* piece_source */
+	uint8_t scanned;							/* newlines counted */
+	int64_t start, length;					/* bytes of the source */
+	int64_t lines;								/* newlines in the piece (once scanned) */
+	int64_t size;								/* subtree bytes */
+	int64_t total;								/* subtree newlines (scanned pieces) */
+	int unscanned;								/* subtree pieces not scanned */
+	int count;									/* subtree pieces */
+} edit_node;
+/* editor state (module widget) */
+struct ui_textedit_s {
+	ui_module module;
+	const char* original;					/* mapped file (NULL: none) */
+	int64_t original_size;
+	char* added;								/* append buffer */
+	int64_t added_size, added_capacity;
+	edit_node* nodes;							/* node pool */
+	int node_count, node_capacity;
+	int free_list;								/* released nodes (linked through left) */
+	int root;
+	uint32_t seed;								/* priority generator */
+	int64_t indexed;							/* original bytes scanned */
+	int64_t caret, top;
+	int follow;									/* keep the caret in view */
+	uint64_t version;							/* bumped by every change */
+	ui_font font;
+	uint32_t color, background, caret_color;
+	char* view;									/* laid out lines (EDIT_LINE_MAX each) */
+	int64_t starts[EDIT_ROWS_MAX];		/* offsets of the laid out lines */
+	int view_lines;							/* lines laid out */
+	int64_t view_top;
+	uint64_t view_version;
+	int view_rows;								/* rows the layout was made for (0: stale) */
+	int drawn;
+};
+
+//	Piece Table =================================================================
+static inline const char* piece_data(ui_textedit ed, const edit_node* n) {
+	return (n->source == PIECE_ORIGINAL ? ed->original : ed->added) + n->start;
+}
+static int64_t count_newlines(const char* p, int64_t n) {
+	int64_t lines = 0;
+	const char* end = p + n;
+	while (p < end && (p = memchr(p, '\n', end - p))) {
+		lines++;
+		p++;
+	}
+
+	return lines;
+}
+static void update(ui_textedit ed, int t) {
+	edit_node* n = NODE(ed, t);
+	const edit_node* l = NODE(ed, n->left);
+	const edit_node* r = NODE(ed, n->right);
+	n->size = l->size + n->length + r->size;
+	n->total = l->total + (n->scanned ? n->lines : 0) + r->total;
+	n->unscanned = l->unscanned + !n->scanned + r->unscanned;
+	n->count = l->count + 1 + r->count;
+}
+/* makes room for `n` new nodes, so node pointers stay valid while the tree is restructured */
+static int reserve_nodes(ui_textedit ed, int n) {
+	if (ed->node_count + n <= ed->node_capacity) return 0;
+
+	int capacity = ed->node_capacity ? ed->node_capacity : 64;
+	while (capacity < ed->node_count + n) capacity *= 2;
+	edit_node* nodes = ui_grow(ed->module->ctx, ed->nodes, sizeof(edit_node) * ed->node_count,
+										sizeof(edit_node) * capacity, ALLOC_WIDGET);
+	if (!nodes) return -1;
+	ed->nodes = nodes;
+	ed->node_capacity = capacity;
+
+	return 0;
+}
+static int new_node(ui_textedit ed, piece_source source, int64_t start, int64_t length) {
+	int t = ed->free_list;
+	if (t) ed->free_list = NODE(ed, t)->left;
+	else t = ed->node_count++;
+
+	edit_node* n = NODE(ed, t);
+	memset(n, 0, sizeof(edit_node));
+	ed->seed ^= ed->seed << 13;
+	ed->seed ^= ed->seed >> 17;
+	ed->seed ^= ed->seed << 5;
+	n->priority = ed->seed;
+	n->source = source;
+	n->start = start;
+	n->length = length;
+	update(ed, t);
+
+	return t;
+}
+static void free_tree(ui_textedit ed, int t) {
+	if (!t) return;
+
+	free_tree(ed, NODE(ed, t)->left);
+	free_tree(ed, NODE(ed, t)->right);
+	NODE(ed, t)->left = ed->free_list;
+	ed->free_list = t;
+}
+/* splits a tree into the first `offset` bytes and the rest; a piece crossing
+	the offset is cut in two (one reserved node) */
+static void split(ui_textedit ed, int t, int64_t offset, int* l, int* r) {
+	if (!t) {
+		*l = *r = 0;
+		return;
+	}
+
+	edit_node* n = NODE(ed, t);
+	int64_t ls = NODE(ed, n->left)->size;
+	if (offset <= ls) {
+		split(ed, n->left, offset, l, &n->left);
+		*r = t;
+	} else if (offset >= ls + n->length) {
+		split(ed, n->right, offset - ls - n->length, &n->right, r);
+		*l = t;
+	} else {
+		int64_t cut = offset - ls;
+		int m = new_node(ed, n->source, n->start + cut, n->length - cut);
+		edit_node* tail = NODE(ed, m);
+		tail->priority = n->priority;			// heads the old right subtree
+		tail->scanned = n->scanned;
+		if (n->scanned) {
+			const char* p = piece_data(ed, n);
+			int64_t head = cut <= n->length - cut ? count_newlines(p, cut) : n->lines - count_newlines(p + cut, n->length - cut);
+			tail->lines = n->lines - head;
+			n->lines = head;
+		}
+		n->length = cut;
+		tail->right = n->right;
+		n->right = 0;
+		update(ed, m);
+		*l = t;
+		*r = m;
+	}
+	update(ed, t);
+}
+static int merge(ui_textedit ed, int a, int b) {
+	if (!a || !b) return a ? a : b;
+
+	if (NODE(ed, a)->priority >= NODE(ed, b)->priority) {
+		int right = merge(ed, NODE(ed, a)->right, b);
+		NODE(ed, a)->right = right;
+		update(ed, a);
+		return a;
+	}
+	int left = merge(ed, a, NODE(ed, b)->left);
+	NODE(ed, b)->left = left;
+	update(ed, b);
+
+	return b;
+}
+/* the last piece of a tree when it ends at the append buffer's end (0: none) */
+static int appendable(ui_textedit ed, int t) {
+	while (t && NODE(ed, t)->right) t = NODE(ed, t)->right;
+	if (!t) return 0;
+
+	edit_node* n = NODE(ed, t);
+	return n->source == PIECE_ADDED && n->start + n->length == ed->added_size ? t : 0;
+}
+/* grows the last piece of a tree (typing extends one piece instead of adding one per key) */
+static void extend_last(ui_textedit ed, int t, int64_t length, int64_t lines) {
+	edit_node* n = NODE(ed, t);
+	if (n->right) extend_last(ed, n->right, length, lines);
+	else {
+		n->length += length;
+		n->lines += lines;
+	}
+	update(ed, t);
+}
+/* node holding a document offset and the offset inside it (0: past the end) */
+static int piece_at(ui_textedit ed, int64_t offset, int64_t* within) {
+	int t = ed->root;
+	while (t) {
+		edit_node* n = NODE(ed, t);
+		int64_t ls = NODE(ed, n->left)->size;
+		if (offset < ls) t = n->left;
+		else if (offset < ls + n->length) {
+			*within = offset - ls;
+			return t;
+		} else {
+			offset -= ls + n->length;
+			t = n->right;
+		}
+	}
+
+	return 0;
+}
+
+//	Line Index ==================================================================
+/* first unscanned piece with the bytes and newlines before it (0: all scanned) */
+static int first_unscanned(ui_textedit ed, int64_t* bytes, int64_t* lines) {
+	*bytes = *lines = 0;
+	int t = ed->root;
+	while (t && NODE(ed, t)->unscanned) {
+		edit_node* n = NODE(ed, t);
+		edit_node* l = NODE(ed, n->left);
+		if (l->unscanned) {
+			t = n->left;
+			continue;
+		}
+		*bytes += l->size;
+		*lines += l->total;
+		if (!n->scanned) return t;
+		*bytes += n->length;
+		*lines += n->lines;
+		t = n->right;
+	}
+
+	return 0;
+}
+/* counts the newlines of the first unscanned piece; sums are fixed on the way back up */
+static void scan_first(ui_textedit ed, int t) {
+	edit_node* n = NODE(ed, t);
+	if (NODE(ed, n->left)->unscanned) scan_first(ed, n->left);
+	else if (!n->scanned) {
+		n->lines = count_newlines(piece_data(ed, n), n->length);
+		n->scanned = 1;
+		if (n->source == PIECE_ORIGINAL) ed->indexed += n->length;
+	} else scan_first(ed, n->right);
+	update(ed, t);
+}
+/* scans pieces until the `line`th newline or `offset` lies in the scanned prefix */
+static void scan_until(ui_textedit ed, int64_t line, int64_t offset) {
+	int64_t bytes, lines;
+	while (first_unscanned(ed, &bytes, &lines) && lines < line && bytes < offset) scan_first(ed, ed->root);
+}
+/* scans unscanned pieces in order for about `budget` bytes */
+static void scan_slice(ui_textedit ed, int64_t budget) {
+	int64_t bytes, lines;
+	int t;
+	while (budget > 0 && (t = first_unscanned(ed, &bytes, &lines))) {
+		budget -= NODE(ed, t)->length;
+		scan_first(ed, ed->root);
+	}
+}
+/* offset after the `line`th newline (-1: fewer newlines) */
+static int64_t line_offset(ui_textedit ed, int64_t line) {
+	if (line <= 0) return 0;
+	scan_until(ed, line, INT64_MAX);
+	if (NODE(ed, ed->root)->total < line) return -1;
+
+	int64_t base = 0;
+	for (int t = ed->root; t; ) {
+		edit_node* n = NODE(ed, t);
+		edit_node* l = NODE(ed, n->left);
+		if (line <= l->total) {
+			t = n->left;
+			continue;
+		}
+		line -= l->total;
+		base += l->size;
+		if (n->scanned && line <= n->lines) {
+			const char* p = piece_data(ed, n);
+			const char* q = p;
+			while ((q = memchr(q, '\n', p + n->length - q)) && --line) q++;
+			return base + (q - p) + 1;
+		}
+		line -= n->scanned ? n->lines : 0;
+		base += n->length;
+		t = n->right;
+	}
+
+	return -1;
+}
+/* newlines before an offset */
+static int64_t offset_line(ui_textedit ed, int64_t offset) {
+	scan_until(ed, INT64_MAX, offset);
+
+	int64_t lines = 0;
+	for (int t = ed->root; t; ) {
+		edit_node* n = NODE(ed, t);
+		edit_node* l = NODE(ed, n->left);
+		if (offset < l->size) {
+			t = n->left;
+			continue;
+		}
+		offset -= l->size;
+		lines += l->total;
+		if (offset < n->length) return lines + count_newlines(piece_data(ed, n), offset);
+		offset -= n->length;
+		lines += n->lines;
+		t = n->right;
+	}
+
+	return lines;
+}
+
+//	Helper Functions ============================================================
+/* drops the document: pieces, append buffer bytes and the mapping */
+static void reset_document(ui_textedit ed) {
+	if (ed->original && ed->original_size) munmap((void*)ed->original, ed->original_size);
+	ed->original = NULL;
+	ed->original_size = 0;
+	ed->added_size = 0;
+	ed->node_count = 1;						// node 0 is the sentinel
+	ed->free_list = 0;
+	ed->root = 0;
+	ed->indexed = 0;
+	ed->caret = ed->top = 0;
+	ed->version++;
+}
+/* builds a treap over the pieces of the original in O(n) (Cartesian tree on random priorities) */
+static int build_original(ui_textedit ed) {
+	int count = (int)((ed->original_size + EDIT_PIECE_MAX - 1) / EDIT_PIECE_MAX);
+	if (!count) return 0;
+	if (reserve_nodes(ed, count) != 0) return -1;
+	int* stack = ui_alloc(ed->module->ctx, sizeof(int) * count, ALLOC_WIDGET);
+	if (!stack) return -1;
+
+	int depth = 0;
+	for (int i = 0; i < count; ++i) {
+		int64_t start = (int64_t)i * EDIT_PIECE_MAX;
+		int64_t length = ed->original_size - start < EDIT_PIECE_MAX ? ed->original_size - start : EDIT_PIECE_MAX;
+		int x = new_node(ed, PIECE_ORIGINAL, start, length);
+		int last = 0;
+		while (depth && NODE(ed, stack[depth - 1])->priority < NODE(ed, x)->priority) last = stack[--depth];
+		NODE(ed, x)->left = last;
+		if (depth) NODE(ed, stack[depth - 1])->right = x;
+		stack[depth++] = x;
+	}
+	ed->root = stack[0];
+	ui_free(ed->module->ctx, stack, ALLOC_WIDGET);
+
+	//	sums bottom-up (post-order)
+	int* order = ui_alloc(ed->module->ctx, sizeof(int) * count, ALLOC_WIDGET);
+	if (!order) return -1;
+	int n = 0;
+	order[n++] = ed->root;
+	for (int i = 0; i < n; ++i) {
+		edit_node* node = NODE(ed, order[i]);
+		if (node->left) order[n++] = node->left;
+		if (node->right) order[n++] = node->right;
+	}
+	while (n--) update(ed, order[n]);		// children come after their parent
+	ui_free(ed->module->ctx, order, ALLOC_WIDGET);
+
+	return 0;
+}
+/* copies line text for display: control bytes become spaces (one byte per glyph stays true) */
+static void sanitize(char* text, int n) {
+	for (int i = 0; i < n; ++i) {
+		if ((uint8_t)text[i] < 32 || text[i] == 127) text[i] = ' ';
+	}
+	text[n] = '\0';
+}
+/* lays out the lines from the top of the window */
+static void layout_view(ui_textedit ed, int rows) {
+	if (!ed->view) {
+		ed->view = ui_alloc(ed->module->ctx, (size_t)EDIT_ROWS_MAX * EDIT_LINE_MAX, ALLOC_WIDGET);
+		if (!ed->view) return;
+	}
+
+	int64_t length = NODE(ed, ed->root)->size;
+	int64_t start = line_offset(ed, ed->top);
+	ed->view_lines = 0;
+	for (int i = 0; i < rows && start >= 0; ++i) {
+		int64_t next = line_offset(ed, ed->top + i + 1);
+		int64_t end = next < 0 ? length : next - 1;
+		int n = end - start < EDIT_LINE_MAX - 1 ? (int)(end - start) : EDIT_LINE_MAX - 1;
+		char* text = ed->view + (size_t)i * EDIT_LINE_MAX;
+		n = (int)TextEdit.read(ed, start, text, n);
+		sanitize(text, n);
+		ed->starts[i] = start;
+		ed->view_lines++;
+		start = next;
+	}
+	ed->view_top = ed->top;
+	ed->view_version = ed->version;
+	ed->view_rows = rows;
+}
+/* pen x of a byte column of a laid out line */
+static int column_x(ui_textedit ed, const char* text, int64_t column) {
+	text_layout layout;
+	if (!*text || TextCache.layout(ed->module->ctx, ed->font, text, -1, 0, &layout) != 0) return 0;
+	for (int i = 0; i < layout.glyph_count; ++i) {
+		if (layout.glyphs[i].offset >= column) return layout.glyphs[i].pen;
+	}
+	const text_glyph* last = &layout.glyphs[layout.glyph_count - 1];
+
+	return layout.glyph_count ? last->pen + last->advance : 0;
+}
+/* byte column of a laid out line nearest a pen x */
+static int64_t x_column(ui_textedit ed, const char* text, int x) {
+	text_layout layout;
+	if (!*text || TextCache.layout(ed->module->ctx, ed->font, text, -1, 0, &layout) != 0) return 0;
+	for (int i = 0; i < layout.glyph_count; ++i) {
+		if (layout.glyphs[i].pen + layout.glyphs[i].advance / 2 > x) return layout.glyphs[i].offset;
+	}
+
+	return (int64_t)strlen(text);
+}
+
+//	Module Callbacks ============================================================
+/* lays out (when stale) and records the lines in the window and the caret */
+static void render_edit(ui_context ctx, ui_module m, ui_input* input) {
+	ui_textedit ed = m->widget;
+	if (!ed || !m->win) return;
+	int width = m->win->width, height = m->win->height;
+	int lh = Font.height(ed->font);
+	int rows = lh > 0 ? height / lh + 1 : 1;
+	if (rows > EDIT_ROWS_MAX) rows = EDIT_ROWS_MAX;
+
+	scan_slice(ed, EDIT_SCAN_FRAME);
+	int64_t caret_line = offset_line(ed, ed->caret);
+	if (ed->follow) {
+		if (caret_line < ed->top) ed->top = caret_line;
+		if (caret_line > ed->top + rows - 2) ed->top = caret_line - rows + 2;
+		ed->follow = 0;
+	}
+	if (ed->view_rows != rows || ed->view_top != ed->top || ed->view_version != ed->version) layout_view(ed, rows);
+
+	Draw.rect(ctx, 0, 0, width, height, ed->background);
+	for (int i = 0; i < ed->view_lines; ++i) {
+		const char* text = ed->view + (size_t)i * EDIT_LINE_MAX;
+		if (*text) Draw.text(ctx, EDIT_PAD, i * lh, ed->font, text, ed->color);
+	}
+	ed->drawn = ed->view_lines;
+
+	int row = (int)(caret_line - ed->top);
+	if (row >= 0 && row < ed->view_lines) {
+		int x = column_x(ed, ed->view + (size_t)row * EDIT_LINE_MAX, ed->caret - ed->starts[row]);
+		Draw.rect(ctx, EDIT_PAD + x, row * lh, 1, lh, ed->caret_color);
+	}
+}
+/* keys edit at the caret; a press moves it */
+static void handle_edit(ui_context ctx, ui_module m, event_info ei) {
+	ui_textedit ed = m->widget;
+	if (!ed || !ei || !ei->e) return;
+	event e = ei->e;
+
+	if (e->type == EVENT_KEY_PRESS) {
+		int key = e->data.key.key_code;
+		char c = (char)key;
+		if (key == '\b') {
+			if (ed->caret > 0) TextEdit.erase(ed, ed->caret - 1, 1);
+		} else if (key == 127) TextEdit.erase(ed, ed->caret, 1);
+		else if (key == '\r' || key == '\n') TextEdit.insert(ed, ed->caret, "\n", 1);
+		else if (key == '\t' || (key >= 32 && key < 127)) TextEdit.insert(ed, ed->caret, &c, 1);
+		ed->follow = 1;
+	} else if (e->type == EVENT_MOUSE_PRESS && e->data.mouse.button == MOUSE_BUTTON_LEFT && m->win) {
+		int x = e->data.mouse.x - m->win->x, y = e->data.mouse.y - m->win->y;
+		int lh = Font.height(ed->font);
+		if (x < 0 || y < 0 || x >= m->win->width || y >= m->win->height || lh <= 0) return;
+		int row = y / lh;
+		if (ed->view_version != ed->version || ed->view_top != ed->top || row >= ed->view_lines) return;
+		ed->caret = ed->starts[row] + x_column(ed, ed->view + (size_t)row * EDIT_LINE_MAX, x - EDIT_PAD);
+	}
+}
+/* frees the editor with its module */
+static void release_edit(ui_module m) {
+	ui_textedit ed = m->widget;
+	if (!ed) return;
+
+	reset_document(ed);
+	if (ed->nodes) ui_free(m->ctx, ed->nodes, ALLOC_WIDGET);
+	if (ed->added) ui_free(m->ctx, ed->added, ALLOC_WIDGET);
+	if (ed->view) ui_free(m->ctx, ed->view, ALLOC_WIDGET);
+	ui_free(m->ctx, ed, ALLOC_WIDGET);
+	m->widget = NULL;
+}
+
+//	Text Edit Interface =========================================================
+static ui_textedit new_edit(ui_context ctx, string name, window win) {
+	if (!ctx) return NULL;
+
+	ui_textedit ed = ui_alloc(ctx, sizeof(struct ui_textedit_s), ALLOC_WIDGET);
+	if (!ed) return NULL;
+	ui_module m = Sigui.add_module(ctx, name, render_edit, handle_edit, win);
+	if (!m) {
+		ui_free(ctx, ed, ALLOC_WIDGET);
+		return NULL;
+	}
+	DBLOG("<TextEdit> new editor=%s", name);
+
+	ed->module = m;
+	ed->seed = 0x9E3779B9u;
+	ed->node_count = 1;
+	ed->font = UI_FONT_DEFAULT;
+	ed->color = UI_RGB(0, 0, 0);
+	ed->background = UI_RGB(255, 255, 255);
+	ed->caret_color = UI_RGB(0, 0, 0);
+	if (reserve_nodes(ed, 1) != 0) {
+		ui_free(ctx, ed, ALLOC_WIDGET);
+		return NULL;
+	}
+	memset(NODE(ed, 0), 0, sizeof(edit_node));
+	m->widget = ed;
+	m->release = release_edit;
+
+	return ed;
+}
+static ui_module edit_module(ui_textedit ed) {
+	return ed ? ed->module : NULL;
+}
+/* maps the file; only the piece tree (one node per EDIT_PIECE_MAX bytes) is built */
+static int open_file(ui_textedit ed, const char* path) {
+	if (!ed || !path) return -1;
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return -1;
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return -1;
+	}
+	void* map = NULL;
+	if (st.st_size > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			close(fd);
+			return -1;
+		}
+	}
+	close(fd);
+	DBLOG("<TextEdit> mapped %s (%lld bytes)", path, (long long)st.st_size);
+
+	reset_document(ed);
+	ed->original = map;
+	ed->original_size = st.st_size;
+	if (build_original(ed) != 0) {
+		reset_document(ed);
+		return -1;
+	}
+
+	return 0;
+}
+static int load_text(ui_textedit ed, const char* text, int64_t length) {
+	if (!ed || (!text && length > 0)) return -1;
+
+	reset_document(ed);
+	return length > 0 ? TextEdit.insert(ed, 0, text, length) : 0;
+}
+/* writes the pieces in order to a temporary file renamed over the target */
+static int save_file(ui_textedit ed, const char* path) {
+	if (!ed || !path) return -1;
+
+	char tmp[4096];
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp~", path) >= (int)sizeof(tmp)) return -1;
+	FILE* f = fopen(tmp, "wb");
+	if (!f) return -1;
+
+	int ok = 1;
+	int64_t length = NODE(ed, ed->root)->size;
+	for (int64_t offset = 0; ok && offset < length; ) {
+		int64_t within;
+		edit_node* n = NODE(ed, piece_at(ed, offset, &within));
+		ok = fwrite(piece_data(ed, n) + within, 1, n->length - within, f) == (size_t)(n->length - within);
+		offset += n->length - within;
+	}
+	if (fclose(f) != 0) ok = 0;
+	if (!ok || rename(tmp, path) != 0) {
+		remove(tmp);
+		return -1;
+	}
+
+	return 0;
+}
+/* O(log n) per EDIT_PIECE_MAX bytes inserted */
+static int insert_text(ui_textedit ed, int64_t offset, const char* text, int64_t length) {
+	if (!ed || !text || length < 0) return -1;
+	if (!length) return 0;
+	int64_t size = NODE(ed, ed->root)->size;
+	if (offset < 0) offset = 0;
+	if (offset > size) offset = size;
+
+	if (ed->added_size + length > ed->added_capacity) {
+		int64_t capacity = ed->added_capacity ? ed->added_capacity : 4096;
+		while (capacity < ed->added_size + length) capacity *= 2;
+		char* added = ui_grow(ed->module->ctx, ed->added, ed->added_size, capacity, ALLOC_WIDGET);
+		if (!added) return -1;
+		ed->added = added;
+		ed->added_capacity = capacity;
+	}
+	if (reserve_nodes(ed, (int)(length / EDIT_PIECE_MAX) + 2) != 0) return -1;
+
+	int l, r;
+	split(ed, ed->root, offset, &l, &r);
+	int64_t start = ed->added_size;
+	memcpy(ed->added + start, text, length);
+
+	//	typing right after the last insert grows that piece
+	int last = appendable(ed, l);
+	int64_t done = 0;
+	if (last) {
+		int64_t room = EDIT_PIECE_MAX - NODE(ed, last)->length;
+		done = length < room ? length : room;
+		if (done > 0) extend_last(ed, l, done, count_newlines(text, done));
+	}
+	ed->added_size = start + done;
+	while (done < length) {
+		int64_t n = length - done < EDIT_PIECE_MAX ? length - done : EDIT_PIECE_MAX;
+		int piece = new_node(ed, PIECE_ADDED, start + done, n);
+		NODE(ed, piece)->scanned = 1;
+		NODE(ed, piece)->lines = count_newlines(text + done, n);
+		update(ed, piece);
+		l = merge(ed, l, piece);
+		done += n;
+		ed->added_size = start + done;
+	}
+	ed->root = merge(ed, l, r);
+
+	if (ed->caret >= offset) ed->caret += length;
+	ed->version++;
+
+	return 0;
+}
+/* O(log n) plus the pieces removed */
+static int erase_text(ui_textedit ed, int64_t offset, int64_t length) {
+	if (!ed || offset < 0 || length < 0) return -1;
+	int64_t size = NODE(ed, ed->root)->size;
+	if (offset >= size || !length) return 0;
+	if (length > size - offset) length = size - offset;
+	if (reserve_nodes(ed, 2) != 0) return -1;
+
+	int l, m, r;
+	split(ed, ed->root, offset, &l, &m);
+	int d;
+	split(ed, m, length, &d, &r);
+	free_tree(ed, d);
+	ed->root = merge(ed, l, r);
+
+	if (ed->caret > offset) ed->caret = ed->caret - offset > length ? ed->caret - length : offset;
+	ed->version++;
+
+	return 0;
+}
+static int64_t read_text(ui_textedit ed, int64_t offset, char* buf, int64_t size) {
+	if (!ed || !buf || offset < 0) return 0;
+
+	int64_t copied = 0;
+	while (copied < size) {
+		int64_t within;
+		int t = piece_at(ed, offset + copied, &within);
+		if (!t) break;
+		edit_node* n = NODE(ed, t);
+		int64_t count = n->length - within < size - copied ? n->length - within : size - copied;
+		memcpy(buf + copied, piece_data(ed, n) + within, count);
+		copied += count;
+	}
+
+	return copied;
+}
+static int64_t document_length(ui_textedit ed) {
+	return ed ? NODE(ed, ed->root)->size : 0;
+}
+static int64_t line_count(ui_textedit ed) {
+	if (!ed) return 0;
+
+	scan_until(ed, INT64_MAX, INT64_MAX);
+	return NODE(ed, ed->root)->total + 1;
+}
+static int64_t line_start(ui_textedit ed, int64_t line) {
+	return ed && line >= 0 ? line_offset(ed, line) : -1;
+}
+static int64_t line_of(ui_textedit ed, int64_t offset) {
+	return ed ? offset_line(ed, offset) : 0;
+}
+static void set_caret(ui_textedit ed, int64_t offset) {
+	if (!ed) return;
+
+	int64_t size = NODE(ed, ed->root)->size;
+	ed->caret = offset < 0 ? 0 : offset > size ? size : offset;
+	ed->follow = 1;
+}
+static int64_t caret_position(ui_textedit ed) {
+	return ed ? ed->caret : 0;
+}
+static void scroll_to_line(ui_textedit ed, int64_t line) {
+	if (!ed) return;
+
+	ed->top = line > 0 ? line : 0;
+	ed->follow = 0;
+}
+static int64_t top_line(ui_textedit ed) {
+	return ed ? ed->top : 0;
+}
+static void edit_statistics(ui_textedit ed, textedit_stats* out) {
+	if (!ed || !out) return;
+
+	edit_node* root = NODE(ed, ed->root);
+	out->length = root->size;
+	out->lines = root->total + 1;
+	out->indexed = ed->indexed;
+	out->mapped = ed->original_size;
+	out->added = ed->added_size;
+	out->pieces = root->count;
+	out->drawn = ed->drawn;
+}
+
+/* global text edit interface */
+const ITextEdit TextEdit = {
+	.new = new_edit,
+	.module = edit_module,
+	.open = open_file,
+	.load = load_text,
+	.save = save_file,
+	.insert = insert_text,
+	.erase = erase_text,
+	.read = read_text,
+	.length = document_length,
+	.lines = line_count,
+	.line_start = line_start,
+	.line_of = line_of,
+	.caret = set_caret,
+	.position = caret_position,
+	.scroll_to_line = scroll_to_line,
+	.top = top_line,
+	.stats = edit_statistics
+};
@@ -0,0 +1,752 @@
+// tiles.c
+/**
+ * @detail Tiled image viewer. A tiled file holds a pyramid of levels, each cut
+ * 	into fixed-size ARGB tiles, so the pixels of any tile at any zoom are one
+ * 	contiguous, page-aligned run of the mapping. The viewer wraps a cached tile
+ * 	as an image over the mapping (Images.wrap: no decode, no copy), so drawing
+ * 	it costs what any Draw.image costs. Reading a cold tile would stall the
+ * 	frame on page faults, so tiles enter the cache only after a per-viewer
+ * 	thread has paged them in. The frame rebuilds that thread's queue, most
+ * 	wanted first, and picks up the finished tiles at its start.
+ *
+ * 	The cache is a chained hash over a pool of entries (key: level, row, column)
+ * 	threaded on an LRU list ordered by the frame that last drew them. Evicting
+ * 	a tile frees its image and drops its pages from the mapping.
+ */
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ui_core.h"
+#include "sigui_widgets.h"
+#include "sigui_debug.h"
+
+#define TILE_MAGIC "SGTILES1"
+#define TILE_HEADER_BYTES 4096					/* header block (tiles start page aligned) */
+#define TILE_CACHE_BYTES ((size_t)64 << 20)	/* default cache cap */
+#define TILE_QUEUE_MAX 1024						/* tiles queued for paging per frame */
+#define TILE_FALLBACK 4							/* coarser levels tried for a missing tile */
+#define TILE_PAGE 4096
+#define TILE_SCALE_MAX 64.0						/* deepest zoom (window pixels per image pixel) */
+#define TILE_IMAGE_MAX (1u << 30)				/* widest/tallest image */
+
+/* cache key of a tile */
+#define TILE_KEY(level, tx, ty) ((uint64_t)(level) << 48 | (uint64_t)(ty) << 24 | (uint64_t)(tx))
+
+/* cached tile */
+typedef struct tile_entry_s {
+	uint64_t key;
+	ui_image image;							/* wrapped tile pixels */
+	int chain;									/* next entry of the bucket (-1: end; free list when unused) */
+	int prev, next;							/* LRU neighbors, most recently drawn first (-1: end) */
+	uint64_t drawn;							/* frame that last drew the tile */
+} tile_entry;
+/* viewer state (module widget) */
+struct ui_tileview_s {
+	ui_module module;
+	const uint8_t* map;						/* mapped file (NULL: none) */
+	size_t map_size;
+	tiled_header header;
+	int columns[TILE_LEVELS_MAX], rows[TILE_LEVELS_MAX];	/* tiles per level */
+	size_t tile_bytes;
+	double x, y, scale;						/* image point at the window's top-left; window pixels per image pixel */
+	int dragging, drag_x, drag_y;
+	uint32_t background, placeholder;
+	//	cache (module thread)
+	tile_entry* entries;
+	int entry_count, entry_capacity, free_entry;
+	int* buckets;								/* first entry of each bucket (-1: empty) */
+	int bucket_mask;
+	int head, tail;							/* LRU ends */
+	int resident;
+	size_t cap;
+	uint64_t frame, evicted;
+	uint64_t* requests;						/* tiles wanted by the frame being recorded */
+	int request_count;
+	//	prefetch thread (shared under lock)
+	pthread_t thread;
+	int running, quit, busy;
+	pthread_mutex_t lock;
+	pthread_cond_t work, idle;
+	uint64_t queue[TILE_QUEUE_MAX];
+	int queue_head, queue_count;
+	uint64_t done[TILE_QUEUE_MAX];			/* paged in, not yet cached */
+	int done_count;
+	uint64_t loaded;
+	tileview_stats stats;
+};
+
+//	Tile Geometry ===============================================================
+static inline int key_level(uint64_t key) {
+	return (int)(key >> 48);
+}
+static inline int key_x(uint64_t key) {
+	return (int)(key & 0xFFFFFF);
+}
+static inline int key_y(uint64_t key) {
+	return (int)((key >> 24) & 0xFFFFFF);
+}
+/* first pixel of a tile in the mapping */
+static inline const uint32_t* tile_pixels(ui_tileview v, uint64_t key) {
+	int level = key_level(key);
+	size_t index = (size_t)key_y(key) * v->columns[level] + key_x(key);
+
+	return (const uint32_t*)(v->map + v->header.offset[level] + index * v->tile_bytes);
+}
+/* window x/y of an image x/y */
+static inline int window_x(ui_tileview v, double x) {
+	return (int)floor((x - v->x) * v->scale);
+}
+static inline int window_y(ui_tileview v, double y) {
+	return (int)floor((y - v->y) * v->scale);
+}
+/* window rect covered by a tile */
+static ui_rect tile_rect(ui_tileview v, uint64_t key) {
+	double span = (double)v->header.tile * (1 << key_level(key));
+	int x0 = window_x(v, key_x(key) * span), y0 = window_y(v, key_y(key) * span);
+	int x1 = window_x(v, (key_x(key) + 1) * span), y1 = window_y(v, (key_y(key) + 1) * span);
+
+	return (ui_rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+/* coarsest level whose pixels are at most a window pixel wide */
+static int level_for(ui_tileview v) {
+	int level = 0;
+	while (level + 1 < (int)v->header.levels && v->scale * (2 << level) <= 1.0) level++;
+
+	return level;
+}
+
+//	Prefetch Thread =============================================================
+/* faults a tile's pages in */
+static void page_in(const void* p, size_t bytes) {
+	uintptr_t start = (uintptr_t)p & ~(uintptr_t)(TILE_PAGE - 1);
+	madvise((void*)start, (uintptr_t)p + bytes - start, MADV_WILLNEED);
+
+	volatile uint8_t sink = 0;
+	for (size_t i = 0; i < bytes; i += TILE_PAGE) sink ^= ((const uint8_t*)p)[i];
+	sink ^= ((const uint8_t*)p)[bytes - 1];
+	(void)sink;
+}
+/* pages queued tiles in, front first, until the viewer is released */
+static void* prefetch_main(void* arg) {
+	ui_tileview v = arg;
+	pthread_mutex_lock(&v->lock);
+	while (1) {
+		while (!v->queue_count && !v->quit) pthread_cond_wait(&v->work, &v->lock);
+		if (v->quit) break;
+		uint64_t key = v->queue[v->queue_head];
+		v->queue_head++;
+		v->queue_count--;
+		v->busy = 1;
+		pthread_mutex_unlock(&v->lock);
+
+		page_in(tile_pixels(v, key), v->tile_bytes);
+
+		pthread_mutex_lock(&v->lock);
+		v->busy = 0;
+		if (v->done_count < TILE_QUEUE_MAX) v->done[v->done_count++] = key;		// else asked for again
+		v->loaded++;
+		if (!v->queue_count) pthread_cond_broadcast(&v->idle);
+	}
+	pthread_mutex_unlock(&v->lock);
+
+	return NULL;
+}
+/* replaces the thread's queue with the frame's requests */
+static void submit_requests(ui_tileview v) {
+	pthread_mutex_lock(&v->lock);
+	memcpy(v->queue, v->requests, sizeof(uint64_t) * v->request_count);
+	v->queue_head = 0;
+	v->queue_count = v->request_count;
+	if (v->queue_count) pthread_cond_signal(&v->work);
+	v->stats.queued = v->queue_count;
+	v->stats.loaded = v->loaded;
+	pthread_mutex_unlock(&v->lock);
+}
+/* empties the queue and waits out the tile being paged in (before unmapping) */
+static void drain(ui_tileview v) {
+	pthread_mutex_lock(&v->lock);
+	v->queue_count = 0;
+	while (v->busy) pthread_cond_wait(&v->idle, &v->lock);
+	v->done_count = 0;
+	pthread_mutex_unlock(&v->lock);
+}
+
+//	Tile Cache ==================================================================
+static inline int* bucket_of(ui_tileview v, int* buckets, uint64_t key) {
+	return &buckets[ui_fib_slot(key, __builtin_popcount(v->bucket_mask))];
+}
+static int find_tile(ui_tileview v, uint64_t key) {
+	if (!v->buckets) return -1;
+
+	int e = *bucket_of(v, v->buckets, key);
+	while (e >= 0 && v->entries[e].key != key) e = v->entries[e].chain;
+
+	return e;
+}
+static void unlink_lru(ui_tileview v, int e) {
+	tile_entry* t = &v->entries[e];
+	if (t->prev >= 0) v->entries[t->prev].next = t->next;
+	else v->head = t->next;
+	if (t->next >= 0) v->entries[t->next].prev = t->prev;
+	else v->tail = t->prev;
+}
+static void push_lru(ui_tileview v, int e) {
+	tile_entry* t = &v->entries[e];
+	t->prev = -1;
+	t->next = v->head;
+	if (v->head >= 0) v->entries[v->head].prev = e;
+	v->head = e;
+	if (v->tail < 0) v->tail = e;
+}
+/* marks a tile drawn by this frame */
+static void touch_tile(ui_tileview v, int e) {
+	v->entries[e].drawn = v->frame;
+	if (v->head == e) return;
+	unlink_lru(v, e);
+	push_lru(v, e);
+}
+/* rebuilds the buckets for the entry capacity (live entries are on the LRU list) */
+static int rehash(ui_tileview v) {
+	int size = 16;
+	while (size < v->entry_capacity * 2) size *= 2;
+	int* buckets = ui_alloc(v->module->ctx, sizeof(int) * size, ALLOC_WIDGET);
+	if (!buckets) return -1;
+	if (v->buckets) ui_free(v->module->ctx, v->buckets, ALLOC_WIDGET);
+	v->buckets = buckets;
+	v->bucket_mask = size - 1;
+	for (int i = 0; i < size; ++i) buckets[i] = -1;
+	for (int e = v->head; e >= 0; e = v->entries[e].next) {
+		int* b = bucket_of(v, buckets, v->entries[e].key);
+		v->entries[e].chain = *b;
+		*b = e;
+	}
+
+	return 0;
+}
+/* caches a paged-in tile (-1: no memory) */
+static int add_tile(ui_tileview v, uint64_t key) {
+	if (v->free_entry < 0 && v->entry_count == v->entry_capacity) {
+		int capacity = v->entry_capacity ? v->entry_capacity * 2 : 64;
+		tile_entry* entries = ui_grow(v->module->ctx, v->entries, sizeof(tile_entry) * v->entry_count,
+												sizeof(tile_entry) * capacity, ALLOC_WIDGET);
+		if (!entries) return -1;
+		v->entries = entries;
+		v->entry_capacity = capacity;
+		if (rehash(v) != 0) return -1;
+	}
+	ui_image image = Images.wrap(tile_pixels(v, key), v->header.tile, v->header.tile, 0);
+	if (!image) return -1;
+
+	int e = v->free_entry;
+	if (e >= 0) v->free_entry = v->entries[e].chain;
+	else e = v->entry_count++;
+	tile_entry* t = &v->entries[e];
+	t->key = key;
+	t->image = image;
+	t->drawn = 0;
+	int* b = bucket_of(v, v->buckets, key);
+	t->chain = *b;
+	*b = e;
+	push_lru(v, e);
+	v->resident++;
+
+	return e;
+}
+/* frees a tile's image and returns its pages to the kernel */
+static void evict_tile(ui_tileview v, int e) {
+	tile_entry* t = &v->entries[e];
+	Image.free(t->image);
+	madvise((void*)tile_pixels(v, t->key), v->tile_bytes, MADV_DONTNEED);
+
+	int* link = bucket_of(v, v->buckets, t->key);
+	while (*link != e) link = &v->entries[*link].chain;
+	*link = t->chain;
+	unlink_lru(v, e);
+	t->chain = v->free_entry;
+	v->free_entry = e;
+	v->resident--;
+}
+/* drops every cached tile */
+static void clear_tiles(ui_tileview v) {
+	while (v->tail >= 0) evict_tile(v, v->tail);
+	v->evicted = 0;
+}
+/* evicts least recently drawn tiles over the cap; tiles drawn by this frame stay */
+static void trim_tiles(ui_tileview v) {
+	while (v->tail >= 0 && (size_t)v->resident * v->tile_bytes > v->cap && v->entries[v->tail].drawn != v->frame) {
+		evict_tile(v, v->tail);
+		v->evicted++;
+	}
+}
+/* caches the tiles paged in since the last frame */
+static void collect_tiles(ui_tileview v) {
+	uint64_t done[TILE_QUEUE_MAX];
+	pthread_mutex_lock(&v->lock);
+	int count = v->done_count;
+	memcpy(done, v->done, sizeof(uint64_t) * count);
+	v->done_count = 0;
+	pthread_mutex_unlock(&v->lock);
+
+	for (int i = 0; i < count; ++i) {
+		if (find_tile(v, done[i]) < 0) add_tile(v, done[i]);
+	}
+}
+/* asks for a tile unless it is cached */
+static void request_tile(ui_tileview v, uint64_t key) {
+	if (v->request_count < TILE_QUEUE_MAX && find_tile(v, key) < 0) v->requests[v->request_count++] = key;
+}
+
+//	Helper Functions ============================================================
+/* tile range of a level crossing the window [x0, x1) x [y0, y1) */
+static void visible_tiles(ui_tileview v, int level, int* x0, int* y0, int* x1, int* y1) {
+	double span = (double)v->header.tile * (1 << level);
+	window win = v->module->win;
+	*x0 = (int)floor(v->x / span);
+	*y0 = (int)floor(v->y / span);
+	*x1 = (int)floor((v->x + win->width / v->scale) / span) + 1;
+	*y1 = (int)floor((v->y + win->height / v->scale) / span) + 1;
+	if (*x0 < 0) *x0 = 0;
+	if (*y0 < 0) *y0 = 0;
+	if (*x1 > v->columns[level]) *x1 = v->columns[level];
+	if (*y1 > v->rows[level]) *y1 = v->rows[level];
+}
+/* draws a visible tile, or the nearest cached coarser tile clipped to it; 1 when the tile itself was drawn */
+static int draw_tile(ui_context ctx, ui_tileview v, uint64_t key) {
+	ui_rect r = tile_rect(v, key);
+	if (r.width <= 0 || r.height <= 0) return 1;
+	int e = find_tile(v, key);
+	if (e >= 0) {
+		touch_tile(v, e);
+		Draw.image(ctx, r.x, r.y, r.width, r.height, v->entries[e].image, v->placeholder);
+		return 1;
+	}
+
+	int level = key_level(key);
+	for (int k = 1; k <= TILE_FALLBACK && level + k < (int)v->header.levels; ++k) {
+		uint64_t parent = TILE_KEY(level + k, key_x(key) >> k, key_y(key) >> k);
+		if ((e = find_tile(v, parent)) < 0) continue;
+		ui_rect p = tile_rect(v, parent);
+		touch_tile(v, e);
+		if (Draw.push_clip(ctx, r.x, r.y, r.width, r.height) == 0) {
+			Draw.image(ctx, p.x, p.y, p.width, p.height, v->entries[e].image, v->placeholder);
+			Draw.pop_clip(ctx);
+		}
+		return 0;
+	}
+	Draw.rect(ctx, r.x, r.y, r.width, r.height, v->placeholder);
+
+	return 0;
+}
+/* parses a decimal PPM header field after whitespace and comments (-1: malformed) */
+static long ppm_number(const uint8_t** p, const uint8_t* end) {
+	while (*p < end && (**p == '#' || **p == ' ' || **p == '\t' || **p == '\r' || **p == '\n')) {
+		if (**p == '#') {
+			while (*p < end && **p != '\n') (*p)++;
+		} else (*p)++;
+	}
+	if (*p == end || **p < '0' || **p > '9') return -1;
+
+	long n = 0;
+	while (*p < end && **p >= '0' && **p <= '9' && n < (1L << 30)) n = n * 10 + (*(*p)++ - '0');
+
+	return n;
+}
+/* fills level 0 from PPM rows */
+static void fill_base(uint8_t* out, const tiled_header* hd, const uint8_t* raster, int channels, int max) {
+	int side = hd->tile, columns = (hd->width + side - 1) / side, rows = (hd->height + side - 1) / side;
+	size_t tile_bytes = sizeof(uint32_t) * side * side;
+	for (int ty = 0; ty < rows; ++ty) {
+		for (int tx = 0; tx < columns; ++tx) {
+			uint32_t* tile = (uint32_t*)(out + hd->offset[0] + ((size_t)ty * columns + tx) * tile_bytes);
+			int x0 = tx * side, n = (int)hd->width - x0 < side ? (int)hd->width - x0 : side;
+			for (int r = 0; r < side; ++r) {
+				uint32_t* px = tile + (size_t)r * side;
+				uint32_t y = (uint32_t)ty * side + r;
+				if (y >= hd->height) {
+					memset(px, 0, sizeof(uint32_t) * side);
+					continue;
+				}
+				const uint8_t* s = raster + ((size_t)y * hd->width + x0) * channels;
+				for (int i = 0; i < n; ++i, s += channels) {
+					uint32_t cr = s[0], cg = s[channels > 1], cb = s[channels > 1 ? 2 : 0];
+					if (max != 255) {
+						cr = cr > (uint32_t)max ? 255 : (cr * 255 + max / 2) / max;
+						cg = cg > (uint32_t)max ? 255 : (cg * 255 + max / 2) / max;
+						cb = cb > (uint32_t)max ? 255 : (cb * 255 + max / 2) / max;
+					}
+					px[i] = 0xFF000000u | cr << 16 | cg << 8 | cb;
+				}
+				memset(px + n, 0, sizeof(uint32_t) * (side - n));
+			}
+		}
+	}
+}
+/* fills a level by averaging 2x2 blocks of the level below (pixels past its edge left out) */
+static void fill_level(uint8_t* out, const tiled_header* hd, int level) {
+	int side = hd->tile, shift = __builtin_ctz(side);
+	uint32_t pw = (hd->width + (1u << (level - 1)) - 1) >> (level - 1), ph = (hd->height + (1u << (level - 1)) - 1) >> (level - 1);
+	uint32_t w = (pw + 1) / 2, h = (ph + 1) / 2;
+	int pcolumns = (pw + side - 1) / side, columns = (w + side - 1) / side, rows = (h + side - 1) / side;
+	size_t tile_bytes = sizeof(uint32_t) * side * side;
+	const uint8_t* below = out + hd->offset[level - 1];
+
+	for (int ty = 0; ty < rows; ++ty) {
+		for (int tx = 0; tx < columns; ++tx) {
+			uint32_t* tile = (uint32_t*)(out + hd->offset[level] + ((size_t)ty * columns + tx) * tile_bytes);
+			for (int r = 0; r < side; ++r) {
+				for (int c = 0; c < side; ++c) {
+					uint32_t gx = (uint32_t)tx * side + c, gy = (uint32_t)ty * side + r;
+					uint32_t sum_r = 0, sum_g = 0, sum_b = 0, n = 0;
+					for (uint32_t sy = 2 * gy; gx < w && gy < h && sy < 2 * gy + 2 && sy < ph; ++sy) {
+						for (uint32_t sx = 2 * gx; sx < 2 * gx + 2 && sx < pw; ++sx) {
+							const uint32_t* src = (const uint32_t*)(below + ((size_t)(sy >> shift) * pcolumns + (sx >> shift)) * tile_bytes);
+							uint32_t p = src[(sy & (side - 1)) * side + (sx & (side - 1))];
+							sum_r += p >> 16 & 0xFF;
+							sum_g += p >> 8 & 0xFF;
+							sum_b += p & 0xFF;
+							n++;
+						}
+					}
+					tile[r * side + c] = n ? 0xFF000000u | (sum_r + n / 2) / n << 16 | (sum_g + n / 2) / n << 8 | (sum_b + n / 2) / n : 0;
+				}
+			}
+		}
+	}
+}
+
+//	Module Callbacks ============================================================
+/* draws the visible tiles of the level nearest the scale and queues the missing ones */
+static void render_tiles(ui_context ctx, ui_module m, ui_input* input) {
+	ui_tileview v = m->widget;
+	if (!v || !m->win) return;
+	int width = m->win->width, height = m->win->height;
+	if (v->dragging && input && (input->button & MOUSE_BUTTON_LEFT)) {
+		TileView.pan(v, input->mouse_x - v->drag_x, input->mouse_y - v->drag_y);
+		v->drag_x = input->mouse_x;
+		v->drag_y = input->mouse_y;
+	}
+
+	Draw.rect(ctx, 0, 0, width, height, v->background);
+	if (!v->map) return;
+	v->frame++;
+	v->request_count = 0;
+	v->stats.visible = v->stats.drawn = v->stats.fallback = 0;
+	collect_tiles(v);
+
+	int level = level_for(v), x0, y0, x1, y1;
+	visible_tiles(v, level, &x0, &y0, &x1, &y1);
+	int ix = window_x(v, 0), iy = window_y(v, 0);
+	int clipped = Draw.push_clip(ctx, ix, iy, window_x(v, v->header.width) - ix, window_y(v, v->header.height) - iy) == 0;
+	for (int ty = y0; ty < y1; ++ty) {
+		for (int tx = x0; tx < x1; ++tx) {
+			uint64_t key = TILE_KEY(level, tx, ty);
+			v->stats.visible++;
+			if (draw_tile(ctx, v, key)) v->stats.drawn++;
+			else {
+				v->stats.fallback++;
+				request_tile(v, key);
+			}
+		}
+	}
+	if (clipped) Draw.pop_clip(ctx);
+
+	//	prefetch: a ring around the window, then the coarser level
+	for (int ty = y0 - 1; ty <= y1; ++ty) {
+		for (int tx = x0 - 1; tx <= x1; ++tx) {
+			int inside = tx >= x0 && tx < x1 && ty >= y0 && ty < y1;
+			if (!inside && tx >= 0 && ty >= 0 && tx < v->columns[level] && ty < v->rows[level]) request_tile(v, TILE_KEY(level, tx, ty));
+		}
+	}
+	if (level + 1 < (int)v->header.levels) {
+		visible_tiles(v, level + 1, &x0, &y0, &x1, &y1);
+		for (int ty = y0; ty < y1; ++ty) {
+			for (int tx = x0; tx < x1; ++tx) request_tile(v, TILE_KEY(level + 1, tx, ty));
+		}
+	}
+	submit_requests(v);
+	trim_tiles(v);
+
+	v->stats.level = level;
+	v->stats.resident = v->resident;
+	v->stats.bytes = (size_t)v->resident * v->tile_bytes;
+	v->stats.evicted = v->evicted;
+}
+/* left drags pan; '+'/'-' zoom about the center, '0' fits */
+static void handle_tiles(ui_context ctx, ui_module m, event_info ei) {
+	ui_tileview v = m->widget;
+	if (!v || !ei || !ei->e || !m->win) return;
+	event e = ei->e;
+
+	if (e->type == EVENT_KEY_PRESS) {
+		int key = e->data.key.key_code;
+		if (key == '+' || key == '=') TileView.zoom(v, 1.25, m->win->width / 2, m->win->height / 2);
+		else if (key == '-') TileView.zoom(v, 0.8, m->win->width / 2, m->win->height / 2);
+		else if (key == '0') TileView.fit(v);
+		return;
+	}
+	if (e->data.mouse.button != MOUSE_BUTTON_LEFT) return;
+	if (e->type == EVENT_MOUSE_RELEASE) v->dragging = 0;
+	else if (e->type == EVENT_MOUSE_PRESS) {
+		int x = e->data.mouse.x - m->win->x, y = e->data.mouse.y - m->win->y;
+		if (x < 0 || y < 0 || x >= m->win->width || y >= m->win->height) return;
+		v->dragging = 1;
+		v->drag_x = e->data.mouse.x;
+		v->drag_y = e->data.mouse.y;
+	}
+}
+/* unmaps the file (the thread is drained first) */
+static void close_file(ui_tileview v) {
+	if (!v->map) return;
+
+	drain(v);
+	clear_tiles(v);
+	munmap((void*)v->map, v->map_size);
+	v->map = NULL;
+	v->map_size = 0;
+}
+/* stops the thread and frees the viewer with its module */
+static void release_tiles(ui_module m) {
+	ui_tileview v = m->widget;
+	if (!v) return;
+
+	close_file(v);
+	if (v->running) {
+		pthread_mutex_lock(&v->lock);
+		v->quit = 1;
+		pthread_cond_broadcast(&v->work);
+		pthread_mutex_unlock(&v->lock);
+		pthread_join(v->thread, NULL);
+	}
+	pthread_mutex_destroy(&v->lock);
+	pthread_cond_destroy(&v->work);
+	pthread_cond_destroy(&v->idle);
+	if (v->entries) ui_free(m->ctx, v->entries, ALLOC_WIDGET);
+	if (v->buckets) ui_free(m->ctx, v->buckets, ALLOC_WIDGET);
+	if (v->requests) ui_free(m->ctx, v->requests, ALLOC_WIDGET);
+	ui_free(m->ctx, v, ALLOC_WIDGET);
+	m->widget = NULL;
+}
+
+//	Tile View Interface =========================================================
+static ui_tileview new_viewer(ui_context ctx, string name, window win) {
+	if (!ctx) return NULL;
+
+	ui_tileview v = ui_alloc(ctx, sizeof(struct ui_tileview_s), ALLOC_WIDGET);
+	if (!v) return NULL;
+	v->requests = ui_alloc(ctx, sizeof(uint64_t) * TILE_QUEUE_MAX, ALLOC_WIDGET);
+	ui_module m = v->requests ? Sigui.add_module(ctx, name, render_tiles, handle_tiles, win) : NULL;
+	if (!m) {
+		if (v->requests) ui_free(ctx, v->requests, ALLOC_WIDGET);
+		ui_free(ctx, v, ALLOC_WIDGET);
+		return NULL;
+	}
+	DBLOG("<TileView> new viewer=%s", name);
+
+	v->module = m;
+	v->scale = 1.0;
+	v->head = v->tail = v->free_entry = -1;
+	v->cap = TILE_CACHE_BYTES;
+	v->background = UI_RGB(32, 32, 32);
+	v->placeholder = UI_RGB(64, 64, 64);
+	pthread_mutex_init(&v->lock, NULL);
+	pthread_cond_init(&v->work, NULL);
+	pthread_cond_init(&v->idle, NULL);
+	m->widget = v;
+	m->release = release_tiles;
+
+	return v;
+}
+static ui_module viewer_module(ui_tileview v) {
+	return v ? v->module : NULL;
+}
+/* converts a PPM to a tiled pyramid; both files are mapped, the target written under a temporary name */
+static int convert_file(const char* source, const char* target, int side) {
+	if (!source || !target) return -1;
+	if (!side) side = TILE_SIDE;
+	if (side < 16 || side > 4096 || (side & (side - 1))) return -1;
+
+	int fd = open(source, O_RDONLY);
+	if (fd < 0) return -1;
+	struct stat st;
+	const uint8_t* in = fstat(fd, &st) == 0 && st.st_size > 2 ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (in == MAP_FAILED) return -1;
+
+	//	header
+	const uint8_t* p = in + 2;
+	const uint8_t* end = in + st.st_size;
+	int channels = in[1] == '6' ? 3 : 1;
+	long w = ppm_number(&p, end), h = ppm_number(&p, end), max = ppm_number(&p, end);
+	int ret = -1;
+	if (in[0] != 'P' || (in[1] != '5' && in[1] != '6') || w <= 0 || h <= 0 || w > TILE_IMAGE_MAX || h > TILE_IMAGE_MAX ||
+		 w >= (1L << 24) * side || h >= (1L << 24) * side ||
+		 max <= 0 || max > 255 || p == end || (size_t)(end - p - 1) < (size_t)w * h * channels) {
+		munmap((void*)in, st.st_size);
+		return -1;
+	}
+	const uint8_t* raster = p + 1;
+
+	tiled_header hd = {0};
+	memcpy(hd.magic, TILE_MAGIC, 8);
+	hd.width = (uint32_t)w;
+	hd.height = (uint32_t)h;
+	hd.tile = side;
+	size_t tile_bytes = sizeof(uint32_t) * side * side;
+	uint64_t size = TILE_HEADER_BYTES;
+	for (uint32_t lw = hd.width, lh = hd.height; hd.levels < TILE_LEVELS_MAX; lw = (lw + 1) / 2, lh = (lh + 1) / 2) {
+		hd.offset[hd.levels++] = size;
+		size += (uint64_t)((lw + side - 1) / side) * ((lh + side - 1) / side) * tile_bytes;
+		if (lw <= (uint32_t)side && lh <= (uint32_t)side) break;
+	}
+
+	char tmp[4096];
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp~", target) < (int)sizeof(tmp) && (fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644)) >= 0) {
+		uint8_t* out = ftruncate(fd, size) == 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		if (out != MAP_FAILED) {
+			memcpy(out, &hd, sizeof(hd));
+			fill_base(out, &hd, raster, channels, (int)max);
+			for (uint32_t level = 1; level < hd.levels; ++level) fill_level(out, &hd, level);
+			ret = munmap(out, size);
+		}
+		if (close(fd) != 0) ret = -1;
+		if (ret == 0) ret = rename(tmp, target);
+		if (ret != 0) remove(tmp);
+	}
+	munmap((void*)in, st.st_size);
+	DBLOG("<TileView> converted %s: %ldx%ld, %u levels, %llu bytes", source, w, h, hd.levels, (unsigned long long)size);
+
+	return ret;
+}
+/* maps a tiled file after checking its header and level extents (a crafted header must not reach past the mapping) */
+static int open_file(ui_tileview v, const char* path) {
+	if (!v || !path) return -1;
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return -1;
+	struct stat st;
+	const uint8_t* map = fstat(fd, &st) == 0 && st.st_size >= TILE_HEADER_BYTES ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (map == MAP_FAILED) return -1;
+
+	tiled_header hd;
+	memcpy(&hd, map, sizeof(hd));
+	int ok = memcmp(hd.magic, TILE_MAGIC, 8) == 0 && hd.width && hd.height && hd.width <= TILE_IMAGE_MAX &&
+				hd.height <= TILE_IMAGE_MAX && hd.tile >= 16 && hd.tile <= 4096 &&
+				!(hd.tile & (hd.tile - 1)) && hd.levels >= 1 && hd.levels <= TILE_LEVELS_MAX;
+	int columns[TILE_LEVELS_MAX], rows[TILE_LEVELS_MAX];
+	size_t tile_bytes = sizeof(uint32_t) * hd.tile * hd.tile;
+	for (uint32_t l = 0; ok && l < hd.levels; ++l) {
+		uint32_t lw = (uint32_t)(((uint64_t)hd.width + (1ull << l) - 1) >> l), lh = (uint32_t)(((uint64_t)hd.height + (1ull << l) - 1) >> l);
+		columns[l] = (lw + hd.tile - 1) / hd.tile;
+		rows[l] = (lh + hd.tile - 1) / hd.tile;
+		uint64_t bytes, extent;
+		ok = columns[l] < (1 << 24) && rows[l] < (1 << 24) && hd.offset[l] % TILE_PAGE == 0 &&
+			  !__builtin_mul_overflow((uint64_t)columns[l] * rows[l], (uint64_t)tile_bytes, &bytes) &&
+			  !__builtin_add_overflow(hd.offset[l], bytes, &extent) && extent <= (uint64_t)st.st_size;
+	}
+	if (!ok) {
+		munmap((void*)map, st.st_size);
+		return -1;
+	}
+	if (!v->running) {
+		if (pthread_create(&v->thread, NULL, prefetch_main, v) != 0) {
+			munmap((void*)map, st.st_size);
+			return -1;
+		}
+		v->running = 1;
+	}
+	DBLOG("<TileView> mapped %s (%ux%u, %u levels)", path, hd.width, hd.height, hd.levels);
+
+	close_file(v);
+	v->map = map;
+	v->map_size = st.st_size;
+	v->header = hd;
+	v->tile_bytes = tile_bytes;
+	memcpy(v->columns, columns, sizeof(columns));
+	memcpy(v->rows, rows, sizeof(rows));
+	TileView.fit(v);
+
+	return 0;
+}
+static int image_size(ui_tileview v, int* width, int* height) {
+	if (!v || !v->map) return -1;
+
+	if (width) *width = v->header.width;
+	if (height) *height = v->header.height;
+	return 0;
+}
+/* the deepest zoom out shows the whole image at half the window */
+static double min_scale(ui_tileview v) {
+	window win = v->module->win;
+	if (!v->map || !win) return 1e-6;
+
+	double sx = (double)win->width / v->header.width, sy = (double)win->height / v->header.height;
+	return (sx < sy ? sx : sy) / 2;
+}
+static void set_view(ui_tileview v, double x, double y, double scale) {
+	if (!v) return;
+
+	double lo = min_scale(v);
+	v->scale = scale < lo ? lo : scale > TILE_SCALE_MAX ? TILE_SCALE_MAX : scale;
+	v->x = x;
+	v->y = y;
+}
+static void fit_view(ui_tileview v) {
+	if (!v || !v->map || !v->module->win) return;
+
+	window win = v->module->win;
+	double scale = min_scale(v) * 2;
+	set_view(v, (v->header.width - win->width / scale) / 2, (v->header.height - win->height / scale) / 2, scale);
+}
+static void pan_view(ui_tileview v, int dx, int dy) {
+	if (!v) return;
+
+	v->x -= dx / v->scale;
+	v->y -= dy / v->scale;
+}
+static void zoom_view(ui_tileview v, double factor, int x, int y) {
+	if (!v || factor <= 0) return;
+
+	double px = v->x + x / v->scale, py = v->y + y / v->scale;
+	set_view(v, 0, 0, v->scale * factor);
+	v->x = px - x / v->scale;
+	v->y = py - y / v->scale;
+}
+static double view_scale(ui_tileview v) {
+	return v ? v->scale : 0;
+}
+static void set_cache(ui_tileview v, size_t bytes) {
+	if (v) v->cap = bytes;
+}
+static void wait_idle(ui_tileview v) {
+	if (!v) return;
+
+	pthread_mutex_lock(&v->lock);
+	while (v->queue_count || v->busy) pthread_cond_wait(&v->idle, &v->lock);
+	pthread_mutex_unlock(&v->lock);
+}
+static void viewer_statistics(ui_tileview v, tileview_stats* out) {
+	if (v && out) *out = v->stats;
+}
+
+/* global tile view interface */
+const ITileView TileView = {
+	.new = new_viewer,
+	.module = viewer_module,
+	.convert = convert_file,
+	.open = open_file,
+	.size = image_size,
+	.view = set_view,
+	.fit = fit_view,
+	.pan = pan_view,
+	.zoom = zoom_view,
+	.scale = view_scale,
+	.cache = set_cache,
+	.wait = wait_idle,
+	.stats = viewer_statistics
+};
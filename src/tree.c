@@ -0,0 +1,285 @@
+// tree.c
+/**
+ * @detail Module tree. Modules form a forest kept beside the flat module list
+ * 	(which still sets the draw order): the context holds the roots, and every
+ * 	module its children, bottom to top. Each module caches its own on-screen
+ * 	rect and the union of its subtree's, plus the highest draw order in it; a
+ * 	refresh compares every module's rect with the cached one and marks the
+ * 	changed modules and their ancestors dirty, then recomputes the dirty nodes
+ * 	only. Hit tests pick the module drawn last under the point, whatever root it
+ * 	hangs from, and descend into a subtree only when its bounds contain the
+ * 	point and it holds a module drawn above the best so far. Culling descends
+ * 	by bounds alone, and the dispatcher walks the path from a root to the
+ * 	target instead of every module.
+ */
+
+#include "ui_core.h"
+#include "sigui_debug.h"
+
+//	Helper Functions ============================================================
+static inline int rect_empty(ui_rect r) {
+	return r.width <= 0 || r.height <= 0;
+}
+static inline int rect_same(ui_rect a, ui_rect b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+static inline int rect_has(ui_rect r, int x, int y) {
+	return x >= r.x && y >= r.y && x < r.x + r.width && y < r.y + r.height;
+}
+/* smallest rect covering both (empty rects are ignored) */
+static ui_rect rect_union(ui_rect a, ui_rect b) {
+	if (rect_empty(a)) return b;
+	if (rect_empty(b)) return a;
+
+	int x0 = a.x < b.x ? a.x : b.x, y0 = a.y < b.y ? a.y : b.y;
+	int x1 = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+	int y1 = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+	return (ui_rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+/* marks a module and its ancestors dirty (ancestors of a dirty node already are) */
+static void mark_dirty(ui_module m) {
+	while (m && !m->tree_dirty) {
+		m->tree_dirty = 1;
+		m = m->parent;
+	}
+}
+/* appends to a module array, growing it */
+static int push_module(ui_context ctx, ui_module** items, int* count, int* capacity, ui_module m) {
+	if (*count == *capacity) {
+		int grown = *capacity ? *capacity * 2 : 4;
+		ui_module* a = ui_grow(ctx, *items, sizeof(ui_module) * *count, sizeof(ui_module) * grown, ALLOC_TREE);
+		if (!a) return -1;
+		*items = a;
+		*capacity = grown;
+	}
+	(*items)[(*count)++] = m;
+
+	return 0;
+}
+/* removes from a module array, keeping the order */
+static void remove_module(ui_module* items, int* count, ui_module m) {
+	for (int i = 0; i < *count; ++i) {
+		if (items[i] != m) continue;
+		memmove(items + i, items + i + 1, sizeof(ui_module) * (*count - i - 1));
+		(*count)--;
+		return;
+	}
+}
+/* recomputes the dirty part of a subtree */
+static void recompute(module_tree* t, ui_module m) {
+	ui_rect r = m->own;
+	int top = m->order;
+	for (int i = 0; i < m->child_count; ++i) {
+		ui_module c = m->children[i];
+		if (c->tree_dirty) recompute(t, c);
+		r = rect_union(r, c->subtree);
+		if (c->top > top) top = c->top;
+	}
+	m->subtree = r;
+	m->top = top;
+	m->tree_dirty = 0;
+	t->stats.refreshed++;
+}
+/* enabled module of a subtree drawn last over a point, if drawn above `best` */
+static ui_module hit_subtree(module_tree* t, ui_module m, int x, int y, ui_module best) {
+	t->stats.tested++;
+	if (!m->enabled || !rect_has(m->subtree, x, y) || (best && m->top < best->order)) return best;
+
+	if (rect_has(m->own, x, y) && (!best || m->order > best->order)) best = m;
+	for (int i = m->child_count - 1; i >= 0; --i) best = hit_subtree(t, m->children[i], x, y, best);
+
+	return best;
+}
+static ui_module hit_roots(ui_context ctx, int x, int y) {
+	module_tree* t = &ctx->tree;
+	ui_module best = NULL;
+	for (int i = t->root_count - 1; i >= 0; --i) best = hit_subtree(t, t->roots[i], x, y, best);
+
+	return best;
+}
+/* marks a whole subtree culled (windowless modules are never culled); counts the enabled windows */
+static int cull_all(ui_module m) {
+	if (m->win) m->culled = CULL_VIEWPORT;
+	int n = m->enabled && m->win;
+	for (int i = 0; i < m->child_count; ++i) n += cull_all(m->children[i]);
+
+	return n;
+}
+static int cull_subtree(ui_module m, ui_rect viewport) {
+	ui_rect visible;
+	if (!Damage.intersect(m->subtree, viewport, &visible)) return cull_all(m);
+
+	int n = 0;
+	for (int i = 0; i < m->child_count; ++i) n += cull_subtree(m->children[i], viewport);
+
+	return n;
+}
+
+//	Hierarchy (internal) ========================================================
+/* a new module starts as the topmost root, drawn after every other module */
+static int add_root(ui_context ctx, ui_module m) {
+	module_tree* t = &ctx->tree;
+	m->order = m->top = List.count(ctx->modules);
+	if (push_module(ctx, &t->roots, &t->root_count, &t->root_capacity, m) != 0) return -1;
+	t->stats.roots = t->root_count;
+
+	return 0;
+}
+/* re-reads every module rect, then recomputes the dirty subtrees */
+static void refresh_tree(ui_context ctx) {
+	if (!ctx || !ctx->modules) return;
+
+	int count = List.count(ctx->modules);
+	for (int i = 0; i < count; ++i) {
+		ui_module m = List.getAt(ctx->modules, i);
+		ui_rect r = m->win ? ui_module_bounds(m) : (ui_rect){ 0 };
+		if (rect_same(r, m->own)) continue;
+		m->own = r;
+		mark_dirty(m);
+	}
+
+	module_tree* t = &ctx->tree;
+	for (int i = 0; i < t->root_count; ++i) {
+		if (t->roots[i]->tree_dirty) recompute(t, t->roots[i]);
+	}
+}
+/* pointer events: the module under the pointer, or the one holding the press */
+static ui_module event_target(ui_context ctx, event e) {
+	module_tree* t = &ctx->tree;
+	ui_module target = NULL;
+
+	switch (e->type) {
+		case EVENT_MOUSE_PRESS:
+			if (!t->pointer) t->pointer = hit_roots(ctx, e->data.mouse.x, e->data.mouse.y);
+			t->buttons |= e->data.mouse.button;
+			target = t->pointer;
+			break;
+		case EVENT_MOUSE_RELEASE:
+			target = t->pointer;
+			t->buttons &= ~e->data.mouse.button;
+			if (!t->buttons) t->pointer = NULL;
+			break;
+		case EVENT_MOUSE_MOVE:
+		case EVENT_MOUSE_SCROLL:
+			target = t->pointer ? t->pointer : hit_roots(ctx, e->data.mouse.x, e->data.mouse.y);
+			break;
+		default:
+			break;		// key events are broadcast
+	}
+
+	return target;
+}
+/* target first, root last (storage reused until the next call) */
+static ui_module* target_path(ui_context ctx, ui_module target, int* count) {
+	module_tree* t = &ctx->tree;
+	int n = 0;
+	for (ui_module m = target; m; m = m->parent) {
+		if (n == t->path_capacity) {
+			int grown = t->path_capacity ? t->path_capacity * 2 : 16;
+			ui_module* p = ui_grow(ctx, t->path, sizeof(ui_module) * n, sizeof(ui_module) * grown, ALLOC_TREE);
+			if (!p) break;
+			t->path = p;
+			t->path_capacity = grown;
+		}
+		t->path[n++] = m;
+	}
+	*count = n;
+
+	return t->path;
+}
+static int cull_tree(ui_context ctx, ui_rect viewport) {
+	module_tree* t = &ctx->tree;
+	int n = 0;
+	for (int i = 0; i < t->root_count; ++i) n += cull_subtree(t->roots[i], viewport);
+
+	return n;
+}
+/* child arrays go with their modules */
+static void release_tree(ui_context ctx) {
+	module_tree* t = &ctx->tree;
+	if (t->roots) ui_free(ctx, t->roots, ALLOC_TREE);
+	if (t->path) ui_free(ctx, t->path, ALLOC_TREE);
+	*t = (module_tree){ 0 };
+}
+
+//	Module Tree Interface =======================================================
+/* moves a module and its subtree under a parent (NULL: topmost root) */
+static int attach_module(ui_module parent, ui_module child) {
+	if (!child || !child->ctx || (parent && parent->ctx != child->ctx)) return -1;
+	for (ui_module p = parent; p; p = p->parent) {
+		if (p == child) return -1;
+	}
+
+	ui_context ctx = child->ctx;
+	module_tree* t = &ctx->tree;
+	ui_module old = child->parent;
+	if (old) remove_module(old->children, &old->child_count, child);
+	else remove_module(t->roots, &t->root_count, child);
+
+	int failed = parent ? push_module(ctx, &parent->children, &parent->child_count, &parent->child_capacity, child)
+							  : push_module(ctx, &t->roots, &t->root_count, &t->root_capacity, child);
+	if (failed) {
+		//	the old array just gave up a slot, so this cannot fail
+		if (old) old->children[old->child_count++] = child;
+		else t->roots[t->root_count++] = child;
+		return -1;
+	}
+
+	mark_dirty(old);
+	child->parent = parent;
+	mark_dirty(parent);
+	t->stats.roots = t->root_count;
+	DBLOG("<Tree> attached %s under %s", child->name, parent ? parent->name : "(root)");
+
+	return 0;
+}
+static ui_module module_parent(ui_module m) {
+	return m ? m->parent : NULL;
+}
+static int module_children(ui_module m) {
+	return m ? m->child_count : 0;
+}
+static ui_module module_child(ui_module m, int index) {
+	if (!m || index < 0 || index >= m->child_count) return NULL;
+
+	return m->children[index];
+}
+static void set_capture(ui_module m, event_handler h) {
+	if (m) m->capture = h;
+}
+static ui_module hit_module(ui_context ctx, int x, int y) {
+	if (!ctx) return NULL;
+
+	refresh_tree(ctx);
+	return hit_roots(ctx, x, y);
+}
+static ui_rect subtree_bounds(ui_module m) {
+	if (!m || !m->ctx) return (ui_rect){ 0 };
+
+	refresh_tree(m->ctx);
+	return m->subtree;
+}
+static void tree_statistics(ui_context ctx, tree_stats* out) {
+	if (ctx && out) *out = ctx->tree.stats;
+}
+
+/* hierarchy interface (internal) */
+const IHierarchy Hierarchy = {
+	.add = add_root,
+	.refresh = refresh_tree,
+	.target = event_target,
+	.path = target_path,
+	.cull = cull_tree,
+	.release = release_tree
+};
+/* module tree interface */
+const IModuleTree ModuleTree = {
+	.attach = attach_module,
+	.parent = module_parent,
+	.children = module_children,
+	.child = module_child,
+	.capture = set_capture,
+	.hit = hit_module,
+	.bounds = subtree_bounds,
+	.stats = tree_statistics
+};
@@ -2,10 +2,142 @@
 #ifndef UI_CORE_H
 #define UI_CORE_H
 
+#include <string.h>
 #include "sigui.h"
+#include "sigui_draw.h"
+#include "sigui_flex.h"
+#include "sigui_style.h"
 
-// Helper Functions ============================================================
+#define DAMAGE_MAX_REGIONS 8
+#define CLIP_STACK_MAX 32
+#define GLYPH_MAX 128							/* largest rasterized glyph (pixels per side) */
+#define TEXT_KEEP_FRAMES 60					/* default frames an unused text layout stays cached */
+#define EXTENT_BLOCK 64						/* items per extent index block */
+#define STATE_KEEP_FRAMES 120				/* default frames an untouched widget state survives */
+#define STATE_SLAB_BLOBS 256				/* blobs per state slab */
+#define STATE_SWEEP_SLOTS 64				/* table slots the state sweep visits per frame */
+#define STYLE_CHUNK 256						/* resolved style records per chunk */
+#define STYLE_CACHE_MAX 4096				/* resolved style records before the cache is emptied */
+#define STYLE_CLASS_DEPTH 16				/* longest class chain (global class included) */
+#define PACE_STRIKES 3						/* default runs over budget before the watchdog acts */
+#define PACE_MAX_THROTTLE 6					/* deepest throttle level (every 64th frame) */
+#define UI_FNV_OFFSET 0xcbf29ce484222325ull	/* FNV-1a starting value */
+#define IMAGE_INDEX_BITS 20					/* low image handle bits: registry slot + 1 (above: the slot's reuse count) */
+
+/* module culling result */
+typedef enum {
+	CULL_NONE,									/* visible */
+	CULL_VIEWPORT,								/* outside the viewport */
+	CULL_OCCLUDED								/* covered by an opaque window drawn later */
+} cull_state;
+
+/* damage region set (regions never overlap) */
+typedef struct damage_set_s {
+	ui_rect rects[DAMAGE_MAX_REGIONS + 1];	/* regions (+1 scratch slot while merging) */
+	int count;									/* region count */
+	int full;									/* whole surface is dirty */
+} damage_set;
+
+/* recorded draw list */
+typedef struct draw_list_s {
+	draw_cmd* cmds;							/* commands (window-local) */
+	int count, capacity;						/* command count/capacity */
+	uint64_t hash;								/* running FNV-1a hash of the commands */
+	ui_rect clip;								/* base clip the list was recorded with */
+	int culled;									/* primitives dropped by the clip stack */
+	char* text;									/* DRAW_TEXT runs */
+	int text_count, text_capacity;		/* text bytes/capacity */
+} draw_list;
+/* rasterized glyph: alpha coverage, rows top-down */
+typedef struct glyph_image_s {
+	int width, height;						/* bitmap size (0=blank) */
+	int left, top;								/* bitmap offset from the pen (line top-left) */
+	int advance;								/* pen advance */
+	uint8_t alpha[GLYPH_MAX * GLYPH_MAX];
+} glyph_image;
+
+/* shaped glyph of a cached text run (pen positions do not depend on wrapping) */
+typedef struct text_glyph_s {
+	uint32_t offset;							/* byte offset in the text */
+	int32_t pen;								/* pen x before the glyph, unwrapped */
+	int16_t advance;							/* pen advance */
+	uint16_t flags;							/* TEXT_SPACE, TEXT_NEWLINE */
+} text_glyph;
+/* one line of a wrapped text run */
+typedef struct text_line_s {
+	int first, count;							/* glyphs (trailing spaces excluded) */
+	int next;									/* first glyph of the following line */
+	int start, bytes;							/* text bytes of the glyphs */
+	int width;									/* pixels */
+	int scan;									/* widest extent checked before the break */
+	int overflow;								/* extent that forced the break (INT_MAX: '\n' or end) */
+	int newline;								/* ended by '\n' */
+} text_line;
+/* cached layout of (text, font, wrap width); arrays live in the cache arena */
+typedef struct text_entry_s {
+	uint64_t hash;								/* FNV-1a of the text */
+	int font, length, wrap;					/* key (with the hash) */
+	uint32_t text, glyphs, lines;			/* arena offsets */
+	int glyph_count, line_count;
+	int width;									/* widest line */
+	uint64_t used;								/* generation of the last lookup */
+} text_entry;
+/* resolved layout (valid until the next lookup) */
+typedef struct text_layout_s {
+	const char* text;
+	const text_glyph* glyphs;
+	const text_line* lines;
+	int glyph_count, line_count;
+	int width, height, line_height;
+} text_layout;
+/* per-context text layout cache */
+typedef struct text_cache_s {
+	text_entry* entries;
+	int count, capacity;
+	int* index;									/* open addressing: full key -> entry + 1 */
+	int* runs;									/* open addressing: (text, font) -> entry + 1 */
+	int index_capacity;
+	uint8_t* arena;							/* entry arrays (bump allocated) */
+	uint8_t* spare;							/* compaction target, swapped with the arena */
+	size_t used, arena_capacity;
+	text_glyph* scratch_glyphs;			/* shaping scratch (reused) */
+	text_line* scratch_lines;				/* line breaking scratch (reused) */
+	int scratch_glyph_capacity, scratch_line_capacity;
+	uint64_t generation, swept;			/* frame generation, last sweep */
+	int keep;									/* frames an unused layout survives (<= 0: default) */
+	text_stats stats;
+} text_cache;
 
+/* item extents (row heights, column widths) with O(log n) offset lookups;
+	items are grouped into blocks whose sums live in a Fenwick tree */
+typedef struct extent_index_s {
+	uint16_t* sizes;							/* per item (0=default; NULL until the first set) */
+	int64_t* tree;								/* Fenwick tree over block sums (1-based) */
+	int count;									/* items */
+	int blocks;									/* blocks of EXTENT_BLOCK items */
+	int size;									/* default item size */
+	int measured;								/* items with an explicit size */
+} extent_index;
+
+/* offscreen layer options of a module */
+typedef struct layer_state_s {
+	int enabled;								/* render into a layer */
+	int width, height;						/* layer size (<= 0: window size) */
+	int scroll_x, scroll_y;					/* layer pixel shown at the window origin */
+	int dx, dy;									/* composite offset from the window */
+	uint8_t opacity;							/* composite opacity */
+} layer_state;
+
+/* update rate and budget of a module */
+typedef struct pace_state_s {
+	uint64_t period;							/* ns between runs (0: every frame) */
+	uint64_t due;								/* clock time of the next run */
+	uint64_t budget;							/* ns per frame (0: none) */
+	uint64_t pending;							/* handler time since the last run */
+	int wait;									/* frames left to skip (throttle) */
+	int strikes;								/* consecutive runs over budget */
+	int calm;									/* consecutive runs that fit the level below */
+} pace_state;
 
 /* opaque sigui module structure */
 struct sigui_module_s {
@@ -14,7 +146,165 @@ struct sigui_module_s {
 	event_handler handler;	/* event delegate */
 	int enabled;				/* enabled flag (1=TRUE, 0=FALSE) */
 	window win;					/* module window */
+	ui_context ctx;			/* owning context */
+	ui_rect drawn;				/* composited rect at the last presented frame */
+	int drawn_enabled;		/* enabled flag at the last presented frame */
+	draw_list draws;			/* last recorded draw list */
+	uint64_t recorded_hash;	/* hash of the previous recording */
+	int recorded;				/* at least one list was recorded */
+	int retained;				/* declared unchanged: skip recording */
+	int force_record;			/* record once even if retained */
+	module_stats stats;		/* statistics */
+	layer_state layer;		/* offscreen layer options */
+	cull_state culled;		/* culling result of the last cull pass */
+	object widget;				/* widget state (list, grid, ...) */
+	void (*release)(ui_module);	/* frees the widget state with the module */
+	ui_module parent;			/* parent module (NULL: root) */
+	ui_module* children;		/* child modules, bottom to top */
+	int child_count, child_capacity;
+	event_handler capture;	/* capture phase delegate */
+	ui_rect own;				/* on-screen bounds at the last refresh */
+	ui_rect subtree;			/* union of own and the children's subtree bounds */
+	int tree_dirty;			/* subtree bounds need recomputing (ancestors are dirty too) */
+	int order;					/* position in the module list (draw order) */
+	int top;						/* highest order in the subtree */
+	pace_state pace;			/* update rate, budget and watchdog state */
 }; 								// ui_module
+/* key binding */
+typedef struct key_binding_s {
+	ui_module scope;							/* NULL: global */
+	key_stroke strokes[KEY_CHORD_MAX];
+	int count;
+	int command;								/* command id */
+} key_binding;
+/* command run by key bindings */
+typedef struct key_command_s {
+	string name;
+	void (*execute)(ui_context, ui_module);
+} key_command;
+/* compiled trie edge: (parent, modifiers, key) -> child */
+typedef struct key_edge_s {
+	uint64_t key;								/* 0: empty slot */
+	int child;
+} key_edge;
+/* key bindings of a context */
+typedef struct keymap_s {
+	key_binding* bindings;
+	int binding_count, binding_capacity;
+	key_command* commands;					/* id i at i - 1 */
+	int command_count, command_capacity;
+	key_edge* edges;							/* open-addressed edge table */
+	int edge_mask;
+	int* accept;								/* command completed at each node (0: none) */
+	ui_module* scopes;						/* root i + 1 is the trie of scope i (NULL: global) */
+	int scope_count;
+	int global_root, focus_root;			/* 0: no bindings */
+	int dirty;									/* bindings changed since the last compile */
+	int node;									/* chord in progress (0: none) */
+	ui_module chord_scope;					/* scope of the chord in progress */
+	ui_module focus;
+	uint8_t consumed[32];					/* keys whose press a binding consumed */
+	keymap_stats stats;
+} keymap;
+/* module forest of a context */
+typedef struct module_tree_s {
+	ui_module* roots;							/* root modules, bottom to top */
+	int root_count, root_capacity;
+	ui_module* path;							/* dispatch path scratch (target first) */
+	int path_capacity;
+	ui_module pointer;						/* module that took the press of the held buttons */
+	uint32_t buttons;							/* buttons held since that press */
+	tree_stats stats;
+} module_tree;
+/* widget state table slot */
+typedef struct state_entry_s {
+	ui_id id;									/* 0: empty */
+	uint32_t blob;								/* slab << 8 | index */
+	uint32_t used;								/* frame of the last lookup */
+} state_entry;
+/* widget state store of a context */
+typedef struct state_store_s {
+	state_entry* entries;					/* open addressing, linear probing, no tombstones */
+	int mask;									/* slots - 1 (0: no table) */
+	int bits;									/* log2(slots) */
+	int count;									/* live entries */
+	uint8_t** slabs;							/* STATE_SLAB_BLOBS blobs each (never moved) */
+	int slab_count, slab_capacity;
+	uint32_t* free;							/* free blob handles */
+	int free_count, free_capacity;
+	ui_id stack[STATE_ID_DEPTH];			/* id scopes (stack[0]: the recording module) */
+	int depth;
+	uint32_t frame;
+	int keep;									/* frames an untouched blob survives (<= 0: default) */
+	int cursor;									/* next slot the sweep visits */
+	state_stats stats;
+} state_store;
+/* theme rule of a class */
+typedef struct style_class_rule_s {
+	uint32_t states;							/* required state bits */
+	style_rule rule;
+} style_class_rule;
+/* widget class (class 0 is the global class) */
+typedef struct style_class_s {
+	string name;
+	int parent;									/* -1: none (the global class) */
+	int depth;									/* classes above it */
+	style_class_rule* rules;				/* insertion order */
+	int rule_count, rule_capacity;
+} style_class;
+/* interned resolved style */
+typedef struct style_record_s {
+	ui_style style;							/* first: resolve returns its address */
+	uint64_t hash;
+	int cls;
+	uint32_t states;
+	uint32_t generation;						/* theme generation it was resolved at */
+	int overridden;
+	style_rule overrides;
+} style_record;
+/* theme and resolved style cache of a context */
+typedef struct theme_s {
+	style_class* classes;
+	int class_count, class_capacity;
+	int rule_count;
+	ui_style defaults;
+	style_record** chunks;					/* STYLE_CHUNK records each (never moved) */
+	int chunk_count, chunk_capacity;
+	int count;									/* records in use */
+	int* index;									/* open addressing: record + 1 */
+	int index_mask;
+	uint32_t generation;
+	style_stats stats;
+} theme;
+/* flex layout node (links are node ids, -1: none) */
+typedef struct flex_node_s {
+	flex_style style;
+	ui_module module;							/* window written with the rect (NULL: none) */
+	int parent, first, last, prev, next;	/* tree links (next also links free slots) */
+	int content_width, content_height;	/* content of a childless node */
+	int width, height;						/* measured size */
+	ui_rect rect;								/* placed rect */
+	uint8_t used;								/* live node */
+	uint8_t dirty;								/* size must be re-measured */
+	uint8_t relayout;							/* children must be re-placed */
+	uint8_t pending;							/* a descendant is dirty or needs relayout */
+} flex_node;
+/* flex layout tree of a context (node 0 is the root) */
+typedef struct flex_tree_s {
+	flex_node* nodes;
+	int count, capacity;						/* slots used/allocated */
+	int free;									/* first free slot (-1: none) */
+	int width, height;						/* root size (<= 0: measured) */
+	flex_stats stats;
+} flex_tree;
+/* module scheduling of a context */
+typedef struct pacer_s {
+	watchdog_mode mode;						/* watchdog action */
+	int strikes;								/* runs over budget before it acts (<= 0: default) */
+	ui_clock clock;							/* NULL: monotonic */
+	object clock_data;
+	uint64_t now;								/* clock time at the start of the frame */
+} pacer;
 /* opaque sigui context structure */
 struct sigui_context_s {
 	list modules;				/* context modules */
@@ -22,7 +312,272 @@ struct sigui_context_s {
 	list commands;				/* context command queue */
 	object state;				/* user-defined state */
 	ui_input input_state;	/* last input state */
+	ui_allocator alloc;		/* context allocator */
+	damage_set damage;		/* explicit damage since the last presented frame */
+	ui_module recording;		/* module whose callback is running (draw target) */
+	ui_rect clips[CLIP_STACK_MAX];	/* clip stack of the recording module (window-local) */
+	int clip_depth;			/* clip stack depth (base clip included) */
+	ui_rect viewport;			/* visible area (empty=unbounded) */
+	frame_stats frame;		/* last frame's statistics */
+	text_cache text;			/* text layout cache */
+	keymap keys;				/* key bindings */
+	module_tree tree;			/* module hierarchy */
+	flex_tree flex;			/* module window layout */
+	state_store store;		/* persistent widget state */
+	theme theme;				/* theme and resolved styles */
+	pacer pacer;				/* module update rates and watchdog */
 };									// ui_context
 
+/* key binding lookup interface (internal) */
+typedef struct IKeyTable {
+	int (*press)(ui_context, int, uint32_t);	/* look a key press up (key, modifiers); 1 when a binding consumed it */
+	int (*up)(ui_context, int);					/* 1 when the key's press was consumed (its release is too) */
+	void (*release)(ui_context);					/* free the bindings */
+} IKeyTable;
+
+extern const IKeyTable KeyTable;
+
+/* module hierarchy interface (internal) */
+typedef struct IHierarchy {
+	int (*add)(ui_context, ui_module);							/* append a new module as a root; 0 on success */
+	void (*refresh)(ui_context);									/* pick up moved windows; recompute changed subtree bounds */
+	ui_module (*target)(ui_context, event);					/* module an event is aimed at (NULL: broadcast) */
+	ui_module* (*path)(ui_context, ui_module, int*);		/* target and its ancestors, target first (count) */
+	int (*cull)(ui_context, ui_rect);							/* mark subtrees outside a viewport; returns the enabled windows marked */
+	void (*release)(ui_context);									/* free the tree storage */
+} IHierarchy;
+
+extern const IHierarchy Hierarchy;
+
+/* widget state store interface (internal) */
+typedef struct IStateStore {
+	void (*begin)(ui_context, ui_module);						/* reset the id stack to a module's scope (NULL: none) */
+	void (*end_frame)(ui_context);								/* advance the frame; sweep a bounded number of slots */
+	void (*release)(ui_context);									/* free the store */
+} IStateStore;
+
+extern const IStateStore StateStore;
+
+/* module pacing results */
+typedef enum {
+	PACE_RUN,
+	PACE_RATE,									/* not due at its update rate */
+	PACE_THROTTLE								/* skipped by the watchdog */
+} pace_result;
+/* module pacing interface (internal) */
+typedef struct IPacer {
+	void (*begin_frame)(ui_context);							/* read the frame clock */
+	uint64_t (*now)(ui_context);								/* clock time in ns */
+	pace_result (*due)(ui_context, ui_module);			/* whether a module should run this frame */
+	uint64_t (*ran)(ui_context, ui_module, uint64_t);	/* charge a render callback (ns); returns the time charged */
+	void (*charge)(ui_module, uint64_t);					/* charge a handler or command (ns) */
+} IPacer;
+
+extern const IPacer Pacer;
+
+/* resolved style cache interface (internal) */
+typedef struct IStyleCache {
+	void (*release)(ui_context);									/* free the theme and its cache */
+} IStyleCache;
+
+extern const IStyleCache StyleCache;
+
+/* flex layout interface (internal) */
+typedef struct IFlexTree {
+	void (*release)(ui_context);									/* free the layout nodes */
+} IFlexTree;
+
+extern const IFlexTree FlexTree;
+
+/* damage region interface (internal) */
+typedef struct IDamage {
+	void (*clear)(damage_set*);							/* empty the set */
+	void (*all)(damage_set*);								/* mark the whole surface dirty */
+	void (*add)(damage_set*, ui_rect);					/* add a dirty rect */
+	void (*merge)(damage_set*, const damage_set*);	/* add every region of another set */
+	void (*clip)(damage_set*, int, int);				/* clip to a surface (full -> one region) */
+	long (*area)(const damage_set*);						/* covered area */
+	int (*intersect)(ui_rect, ui_rect, ui_rect*);	/* rect intersection (0=empty) */
+} IDamage;
+
+extern const IDamage Damage;
+
+/* module culling interface (internal) */
+typedef struct ICull {
+	void (*modules)(ui_context, ui_rect, int*, int*);	/* classify modules against a viewport (viewport, occluded counts) */
+} ICull;
+
+extern const ICull Cull;
+
+/* draw list recording interface (internal) */
+typedef struct IDrawList {
+	ui_rect (*base_clip)(ui_context, ui_module);	/* visible part of the module in recording space */
+	void (*begin)(ui_context, ui_module);		/* start recording a module */
+	void (*end)(ui_context, ui_module);			/* finish recording; damages the window on change */
+	void (*release)(ui_context, ui_module);	/* free a module's draw list */
+} IDrawList;
+
+extern const IDrawList DrawList;
+
+/* glyph source interface (internal; thread-safe) */
+typedef struct IGlyphs {
+	int (*raster)(ui_font, uint32_t, glyph_image*);	/* rasterize a codepoint; 0 on success */
+	int (*advance)(ui_font, uint32_t);					/* pen advance of a codepoint */
+	int (*height)(ui_font);									/* line height (0=invalid font) */
+} IGlyphs;
+
+extern const IGlyphs Glyphs;
+
+/* decoded image source interface (internal; thread-safe) */
+typedef struct IImages {
+	const uint32_t* (*pixels)(ui_image, int*, int*, int*);	/* decoded ARGB pixels (width, height, opaque), pinned until `release`; NULL until ready */
+	void (*release)(ui_image);										/* unpin pixels returned by `pixels`; a freed image's pixels go with the last release */
+	ui_image (*wrap)(const uint32_t*, int, int, int);		/* ready image over caller-owned ARGB (width, height, opaque); Image.free waits for their release */
+	uint64_t (*generation)(void);								/* bumped whenever an image finishes decoding or is freed */
+	int (*slots)(void);											/* registry slots, live and free (freed slots are reused) */
+} IImages;
+
+extern const IImages Images;
+
+/* text layout cache interface (internal) */
+typedef struct ITextCache {
+	int (*layout)(ui_context, ui_font, const char*, int, int, text_layout*);	/* layout of (font, text, bytes (-1: strlen), wrap); 0 on success */
+	void (*end_frame)(ui_context);			/* advance the generation; sweeps unused layouts */
+	void (*release)(ui_context);				/* free the cache */
+} ITextCache;
+
+extern const ITextCache TextCache;
+
+/* item extent index interface (internal) */
+typedef struct IExtent {
+	void (*init)(extent_index*, int, int);							/* empty index of (count, default size) */
+	int (*resize)(ui_context, extent_index*, int);				/* change the item count (sizes kept); 0 on success */
+	int (*set)(ui_context, extent_index*, int, int);			/* set an item's size; 0 on success */
+	int (*size)(const extent_index*, int);							/* an item's size */
+	int (*measured)(const extent_index*, int);					/* whether an item's size was set */
+	int64_t (*offset)(const extent_index*, int);					/* offset of an item's leading edge (count: total) */
+	int (*index)(const extent_index*, int64_t);					/* item containing an offset (clamped) */
+	int64_t (*total)(const extent_index*);							/* sum of every size */
+	void (*release)(ui_context, extent_index*);					/* free the index */
+} IExtent;
+
+extern const IExtent Extent;
+
+// Helper Functions ============================================================
+/* resolves the allocator of a (possibly NULL) context */
+static inline ui_allocator ui_allocator_of(ui_context ctx) {
+	return ctx && ctx->alloc ? ctx->alloc : Allocator.standard();
+}
+/* allocates zeroed memory through the context allocator */
+static inline object ui_alloc(ui_context ctx, size_t size, alloc_tag tag) {
+	ui_allocator a = ui_allocator_of(ctx);
+	return a->alloc(a, size, tag);
+}
+/* releases memory through the context allocator */
+static inline void ui_free(ui_context ctx, object ptr, alloc_tag tag) {
+	ui_allocator a = ui_allocator_of(ctx);
+	a->free(a, ptr, tag);
+}
+/* grows an array through the context allocator (contents preserved); NULL on failure */
+static inline object ui_grow(ui_context ctx, object ptr, size_t used, size_t size, alloc_tag tag) {
+	object grown = ui_alloc(ctx, size, tag);
+	if (!grown) return NULL;
+	if (ptr) {
+		memcpy(grown, ptr, used);
+		ui_free(ctx, ptr, tag);
+	}
+	
+	return grown;
+}
+/* grows a renderer array (sigcore Mem) to hold `need` elements, doubling from `initial`; 0 on success */
+static inline int ui_grow_array(void** ptr, int* capacity, int need, size_t size, int initial) {
+	if (need <= *capacity) return 0;
+
+	int capacity_new = *capacity ? *capacity : initial;
+	while (capacity_new < need) capacity_new *= 2;
+	void* grown = Mem.alloc(size * capacity_new);
+	if (!grown) return -1;
+	if (*ptr) {
+		memcpy(grown, *ptr, size * *capacity);
+		Mem.free(*ptr);
+	}
+	*ptr = grown;
+	*capacity = capacity_new;
+
+	return 0;
+}
+/* FNV-1a of bytes continued from `h` (UI_FNV_OFFSET for a new hash) */
+static inline uint64_t ui_fnv1a(uint64_t h, const void* data, size_t size) {
+	const uint8_t* p = data;
+	while (size--) {
+		h ^= *p++;
+		h *= 0x100000001b3ull;
+	}
+
+	return h;
+}
+/* registry slot + 1 of an image handle (the same for every image that reuses the slot) */
+static inline int ui_image_index(ui_image image) {
+	return image & ((1 << IMAGE_INDEX_BITS) - 1);
+}
+/* Fibonacci hashing: slot of a key in a table of 2^bits slots */
+static inline uint32_t ui_fib_slot(uint64_t key, int bits) {
+	return bits ? (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits)) : 0;
+}
+/* decodes one UTF-8 codepoint and advances the cursor (malformed bytes decode as U+FFFD) */
+static inline uint32_t ui_utf8_next(const char** cursor, const char* end) {
+	const uint8_t* p = (const uint8_t*)*cursor;
+	uint32_t cp = *p++;
+	int more = cp < 0x80 ? 0 : (cp & 0xE0) == 0xC0 ? 1 : (cp & 0xF0) == 0xE0 ? 2 : (cp & 0xF8) == 0xF0 ? 3 : -1;
+	if (more > 0) cp &= 0x3F >> more;
+	while (more > 0 && p < (const uint8_t*)end && (*p & 0xC0) == 0x80) {
+		cp = cp << 6 | (*p++ & 0x3F);
+		--more;
+	}
+	*cursor = (const char*)p;
+
+	return more == 0 ? cp : 0xFFFD;
+}
+/* module window as a rect */
+static inline ui_rect ui_window_rect(ui_module m) {
+	return (ui_rect){ m->win->x, m->win->y, m->win->width, m->win->height };
+}
+/* rect a module covers on screen (window, shifted by its layer offset) */
+static inline ui_rect ui_module_bounds(ui_module m) {
+	ui_rect r = ui_window_rect(m);
+	if (m->layer.enabled) {
+		r.x += m->layer.dx;
+		r.y += m->layer.dy;
+	}
+	
+	return r;
+}
+/* layer content extent, origin at (0, 0) */
+static inline ui_rect ui_layer_rect(ui_module m) {
+	int w = m->layer.width > 0 ? m->layer.width : m->win->width;
+	int h = m->layer.height > 0 ? m->layer.height : m->win->height;
+	
+	return (ui_rect){ 0, 0, w, h };
+}
+/* module paints every pixel of its on-screen rect opaquely */
+static inline int ui_module_opaque(ui_module m) {
+	if (!m->layer.enabled) return 1;		// window background is opaque
+	
+	ui_rect l = ui_layer_rect(m), b = ui_window_rect(m);
+	return m->layer.opacity == 0xFF && m->layer.scroll_x >= 0 && m->layer.scroll_y >= 0 &&
+			 m->layer.scroll_x + b.width <= l.width && m->layer.scroll_y + b.height <= l.height;
+}
+/* outer contains inner */
+static inline int ui_rect_contains(ui_rect outer, ui_rect inner) {
+	return inner.x >= outer.x && inner.y >= outer.y &&
+			 inner.x + inner.width <= outer.x + outer.width &&
+			 inner.y + inner.height <= outer.y + outer.height;
+}
+/* a context viewport (unbounded when empty) */
+static inline ui_rect ui_viewport(ui_context ctx) {
+	if (ctx->viewport.width > 0 && ctx->viewport.height > 0) return ctx->viewport;
+	
+	return (ui_rect){ -(1 << 29), -(1 << 29), 1 << 30, 1 << 30 };
+}
 
 #endif	//	UI_CORE_H
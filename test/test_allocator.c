@@ -0,0 +1,171 @@
+// test_allocator.c
+#include "sigui.h"
+#include "../src/ui_core.h"
+#include <sigtest.h>
+#include <sigcore.h>
+#include <string.h>
+#include <time.h>
+
+// Assert.isTrue(condition, "fail message");
+// Assert.isFalse(condition, "fail message");
+// Assert.areEqual(obj1, obj2, INT, "fail message");
+// Assert.areEqual(obj1, obj2, PTR, "fail message");
+// Assert.areEqual(obj1, obj2, STRING, "fail message");
+
+static int violations = 0;
+static int alloc_on_frame = -1;
+static int frame_no = 0;
+
+//	dummy renderer function for module
+static void dummy_render(ui_context, ui_module, ui_input*);
+//	renderer that allocates a command on a chosen frame
+static void allocating_render(ui_context, ui_module, ui_input*);
+//	strict mode violation handler
+static void count_violation(ui_allocator, size_t, size_t);
+
+/* test info */
+void test_harness(void) {
+	printf("\n");
+	fflush(stdout);
+
+	time_t rawtime;
+	time(&rawtime);
+
+	struct tm* timeinfo;
+	timeinfo = localtime(&rawtime);
+
+	char date_str[20];
+	strftime(date_str, sizeof(date_str), "%b-%d-%Y [%H:%M]", timeinfo);
+
+	flogf(stdout, "Test Run Date=%s", date_str);
+}
+/* test default allocator */
+void default_allocator(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Assert.isTrue(ctx != NULL, "context should not be NULL");
+	Assert.isTrue(ctx->alloc == Allocator.standard(), "context should fall back to the standard allocator");
+
+	alloc_stats stats;
+	Assert.isTrue(Allocator.stats(ctx->alloc, ALLOC_TAG_COUNT, &stats) != 0, "standard allocator has no stats");
+
+	Sigui.free_context(ctx);
+}
+/* test tracked context lifecycle */
+void tracked_context_lifecycle(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_allocator tracking = Allocator.new_tracking(NULL);
+	Assert.isTrue(tracking != NULL, "tracking allocator should not be NULL");
+
+	ui_context ctx = Sigui.new_context(NULL, tracking);
+	window win = Sigui.new_window(ctx, 0, 0, 100, 200);
+	Sigui.add_module(ctx, "TestModule", dummy_render, NULL, win);
+
+	alloc_stats stats;
+	Allocator.stats(tracking, ALLOC_CONTEXT, &stats);
+	Assert.isTrue(stats.allocs == 1, "context should be allocated once");
+	Allocator.stats(tracking, ALLOC_MODULE, &stats);
+	Assert.isTrue(stats.allocs == 1 && stats.live_bytes > 0, "module should be live");
+	Allocator.stats(tracking, ALLOC_WINDOW, &stats);
+	Assert.isTrue(stats.live_bytes == sizeof(struct ui_window_s), "window bytes mismatch");
+	Allocator.stats(tracking, ALLOC_STRING, &stats);
+	Assert.isTrue(stats.live_bytes == strlen("TestModule") + 1, "module name bytes mismatch");
+
+	Sigui.free_context(ctx);
+
+	Allocator.stats(tracking, ALLOC_TAG_COUNT, &stats);
+	flogf(stdout, "total: live=%zu peak=%zu allocs=%zu frees=%zu",
+			stats.live_bytes, stats.peak_bytes, stats.allocs, stats.frees);
+	Assert.isTrue(stats.live_bytes == 0, "all bytes should be released");
+	Assert.isTrue(stats.peak_bytes > 0, "peak should be recorded");
+	Assert.isTrue(stats.allocs == stats.frees, "allocs and frees should balance");
+
+	Allocator.free_tracking(tracking);
+}
+/* test per-frame allocation counts */
+void frame_allocations(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_allocator tracking = Allocator.new_tracking(NULL);
+	ui_context ctx = Sigui.new_context(NULL, tracking);
+	window win = Sigui.new_window(ctx, 0, 0, 100, 200);
+	Sigui.add_module(ctx, "TestModule", dummy_render, NULL, win);
+
+	ui_input input = {0};
+	alloc_stats stats;
+
+	//	frame 0: key press allocates an event
+	input.keys['A'] = 1;
+	Sigui.render(ctx, &input);
+	Allocator.stats(tracking, ALLOC_EVENT, &stats);
+	Assert.isTrue(stats.frame_allocs > 0, "key press frame should allocate events");
+
+	//	frame 1: unchanged input does not allocate
+	Sigui.render(ctx, &input);
+	Allocator.stats(tracking, ALLOC_TAG_COUNT, &stats);
+	Assert.isTrue(stats.frame_allocs == 0, "steady frame should not allocate");
+	Allocator.stats(tracking, ALLOC_EVENT, &stats);
+	Assert.isTrue(stats.live_bytes == 0, "dispatched events should be released");
+
+	Sigui.free_context(ctx);
+	Allocator.free_tracking(tracking);
+}
+/* test strict mode */
+void strict_steady_state(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_allocator tracking = Allocator.new_tracking(NULL);
+	Allocator.set_strict(tracking, 1, count_violation);
+	ui_context ctx = Sigui.new_context(NULL, tracking);
+	window win = Sigui.new_window(ctx, 0, 0, 100, 200);
+	Sigui.add_module(ctx, "TestModule", allocating_render, NULL, win);
+
+	violations = 0;
+	frame_no = 0;
+	alloc_on_frame = 0;		// allocation during warm-up is allowed
+	ui_input input = {0};
+	Sigui.render(ctx, &input);
+	Assert.isTrue(violations == 0, "warm-up frame should not be checked");
+
+	alloc_on_frame = -1;
+	Sigui.render(ctx, &input);		// executes the queued command (not steady)
+	Sigui.render(ctx, &input);
+	Assert.isTrue(violations == 0, "non-allocating frames should pass");
+
+	alloc_on_frame = frame_no;
+	Sigui.render(ctx, &input);
+	Assert.isTrue(violations == 1, "allocating steady frame should be flagged");
+
+	Sigui.free_context(ctx);
+	Allocator.free_tracking(tracking);
+}
+
+static void dummy_render(ui_context ctx, ui_module module, ui_input* input) {
+	//	no-op dummy renderer ...
+}
+static void allocating_render(ui_context ctx, ui_module module, ui_input* input) {
+	if (frame_no++ == alloc_on_frame) {
+		command cmd = Sigui.new_command(ctx, "alloc");
+		cmd->target = module;
+		Dispatcher.queue_command(ctx, cmd);
+	}
+}
+static void count_violation(ui_allocator a, size_t frame, size_t count) {
+	flogf(stdout, "violation: frame=%zu allocations=%zu", frame, count);
+	violations++;
+}
+
+// Register test cases
+__attribute__((constructor)) void init_sigtest_tests(void) {
+	register_test("test_harness", test_harness);
+	register_test("default_allocator", default_allocator);
+	register_test("tracked_context_lifecycle", tracked_context_lifecycle);
+	register_test("frame_allocations", frame_allocations);
+	register_test("strict_steady_state", strict_steady_state);
+}
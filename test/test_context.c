@@ -1,5 +1,7 @@
 // test_context.c
 #include "sigui.h"
+#include "sigui_flex.h"
+#include "sigui_draw.h"
 #include <sigtest.h>
 #include <time.h>
 
@@ -14,6 +16,14 @@ typedef struct {
 } test_state;
 
 static void dummy_render(ui_context, ui_module, ui_input*);
+static void quiet_render(ui_context, ui_module, ui_input*);
+static int window_is(window, int, int, int, int);
+//	fake clock: callbacks advance it by their cost
+static uint64_t fake_ns;
+static uint64_t slow_ns;
+static uint64_t fake_clock(object);
+static void slow_render(ui_context, ui_module, ui_input*);
+static void slow_handler(ui_context, ui_module, event_info);
 
 /* test info */
 void unit_testing(void) {
@@ -38,7 +48,7 @@ void new_context (void) {
 	flogf(stdout, "TEST: new_context (ui_context is opaque)");
 	
 	test_state state = {42};
-	ui_context ctx = Sigui.new_context(&state);
+	ui_context ctx = Sigui.new_context(&state, NULL);
 	
 	Assert.isTrue(ctx != NULL, "new context should not be NULL");	
 	Mem.free(ctx);		// Sigui.free_context not yet implemented
@@ -49,7 +59,7 @@ void add_module_to_context(void) {
 	fflush(stdout);
 	
 	test_state state = {42};
-	ui_context ctx = Sigui.new_context(&state);
+	ui_context ctx = Sigui.new_context(&state, NULL);
 	string mod_name = "TestModule";
 	
 	Sigui.add_module(ctx, mod_name, dummy_render, NULL, NULL);
@@ -64,7 +74,7 @@ void render_context_module(void) {
 	fflush(stdout);
 	
 	test_state state = {42};
-	ui_context ctx = Sigui.new_context(&state);
+	ui_context ctx = Sigui.new_context(&state, NULL);
 	string mod_name = "TestModule";
 	Sigui.add_module(ctx, mod_name, dummy_render, NULL, NULL);
 	
@@ -79,7 +89,7 @@ void render_with_input(void) {
 	fflush(stdout);
 	
 	test_state state = {42};
-	ui_context ctx = Sigui.new_context(&state);
+	ui_context ctx = Sigui.new_context(&state, NULL);
 	string mod_name = "TestModule";
 	Sigui.add_module(ctx, mod_name, dummy_render, NULL, NULL);
 	ui_input input = {10, 20, MOUSE_BUTTON_NONE, {0}};  /* Simulated input */
@@ -95,8 +105,8 @@ void render_with_window(void) {
 	fflush(stdout);
 	
 	test_state state = {42};
-	ui_context ctx = Sigui.new_context(&state);
-	window win = Sigui.new_window(10, 20, 100, 200);    
+	ui_context ctx = Sigui.new_context(&state, NULL);
+	window win = Sigui.new_window(ctx, 10, 20, 100, 200);    
 	string mod_name = "TestModule";
 	Sigui.add_module(ctx, mod_name, dummy_render, NULL, win);
 	ui_input input = {10, 20, MOUSE_BUTTON_LEFT, {0}};  /* Simulated input */
@@ -122,7 +132,7 @@ void create_event_info(void) {
 	input.button = expMouseLeft;
 	input.keys[' '] = expKeySpace;
 	
-	event_info ei = Sigui.new_event(expType, &input, expMouseLeft);
+	event_info ei = Sigui.new_event(NULL, expType, &input, expMouseLeft);
 	
 	//	event_info only has event data
 	Assert.isTrue(ei != NULL, "event_info should not be NULL");
@@ -138,7 +148,7 @@ void create_command_obj(void) {
 	printf("\n");
 	fflush(stdout);
 	
-	command cmd = Sigui.new_command("TestCommand");
+	command cmd = Sigui.new_command(NULL, "TestCommand");
 	
 	Assert.isTrue(cmd != NULL, "command create should not be NULL");
 	flogf(stdout, "command=%s", cmd->name);
@@ -157,6 +167,225 @@ static void dummy_render(ui_context ctx, ui_module module, ui_input* input) {
 }
 
 
+/* test flex placement: padding, gap, grow, shrink, bounds, justify, align */
+static void flex_layout(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window header = Sigui.new_window(ctx, 0, 0, 0, 0);
+	ui_module header_module = Sigui.add_module(ctx, "header", quiet_render, NULL, header);
+	window side = Sigui.new_window(ctx, 0, 0, 0, 0);
+	ui_module side_module = Sigui.add_module(ctx, "side", quiet_render, NULL, side);
+	window main = Sigui.new_window(ctx, 0, 0, 0, 0);
+	ui_module main_module = Sigui.add_module(ctx, "main", quiet_render, NULL, main);
+	window footer = Sigui.new_window(ctx, 0, 0, 0, 0);
+	ui_module footer_module = Sigui.add_module(ctx, "footer", quiet_render, NULL, footer);
+
+	//	column: header, body (row: side, main), footer
+	flex_style page = { .direction = FLEX_COLUMN, .padding = { 10, 10, 10, 10 }, .gap = 10 };
+	Flex.style(ctx, FLEX_ROOT, &page);
+	Flex.resize(ctx, 800, 600);
+	Flex.node(ctx, FLEX_ROOT, &(flex_style){ .height = 50 }, header_module);
+	int body = Flex.node(ctx, FLEX_ROOT, &(flex_style){ .grow = 1, .gap = 4 }, NULL);
+	int side_node = Flex.node(ctx, body, &(flex_style){ .width = 300, .max_width = 200 }, side_module);
+	Flex.node(ctx, body, &(flex_style){ .grow = 1 }, main_module);
+	Flex.node(ctx, FLEX_ROOT, &(flex_style){ .height = 30 }, footer_module);
+	Sigui.render(ctx, NULL);
+
+	Assert.isTrue(window_is(header, 10, 10, 780, 50), "header should stretch across the padded root");
+	Assert.isTrue(window_is(side, 10, 70, 200, 480), "side should be capped by max_width and fill the body");
+	Assert.isTrue(window_is(main, 214, 70, 576, 480), "main should take the free space after the gap");
+	Assert.isTrue(window_is(footer, 10, 560, 780, 30), "footer should sit at the bottom");
+
+	//	resizing the root re-places everything that depends on it
+	Flex.resize(ctx, 1000, 400);
+	Flex.update(ctx);
+	Assert.isTrue(window_is(main, 214, 70, 776, 280) && window_is(footer, 10, 360, 980, 30), "a resize should re-place the page");
+
+	//	overflow is taken from shrinking children, weighted by size
+	Flex.style(ctx, side_node, &(flex_style){ .width = 600, .shrink = 1 });
+	Flex.style(ctx, body, &(flex_style){ .grow = 1, .gap = 4, .align = FLEX_ALIGN_CENTER });
+	Flex.update(ctx);
+	Assert.isTrue(side->width == 976 - main->width && main->height == 0, "side should shrink to fit; main has no height to center");
+
+	//	justify places leftover space when nothing grows
+	ui_context row = Sigui.new_context(NULL, NULL);
+	window a = Sigui.new_window(row, 0, 0, 0, 0), b = Sigui.new_window(row, 0, 0, 0, 0);
+	Flex.style(row, FLEX_ROOT, &(flex_style){ .justify = FLEX_JUSTIFY_SPACE_BETWEEN, .align = FLEX_ALIGN_END });
+	Flex.resize(row, 100, 40);
+	int leaf = Flex.node(row, FLEX_ROOT, NULL, Sigui.add_module(row, "a", quiet_render, NULL, a));
+	Flex.content(row, leaf, 20, 10);
+	Flex.node(row, FLEX_ROOT, &(flex_style){ .width = 30, .height = 20 }, Sigui.add_module(row, "b", quiet_render, NULL, b));
+	Flex.update(row);
+	Assert.isTrue(window_is(a, 0, 30, 20, 10) && window_is(b, 70, 20, 30, 20), "space-between should push the ends apart");
+
+	Sigui.free_context(row);
+	Sigui.free_context(ctx);
+}
+/* test that a change re-lays out only what it affects */
+static void flex_incremental(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	enum { ROWS = 100, CELLS = 20 };
+	Flex.style(ctx, FLEX_ROOT, &(flex_style){ .direction = FLEX_COLUMN });
+	Flex.resize(ctx, 2000, 0);
+	int rows[ROWS], cells[ROWS][CELLS];
+	window last = NULL;
+	for (int r = 0; r < ROWS; ++r) {
+		rows[r] = Flex.node(ctx, FLEX_ROOT, &(flex_style){ .padding = { 2, 2, 2, 2 }, .gap = 1, .align = FLEX_ALIGN_START }, NULL);
+		for (int c = 0; c < CELLS; ++c) {
+			last = Sigui.new_window(ctx, 0, 0, 0, 0);
+			cells[r][c] = Flex.node(ctx, rows[r], &(flex_style){ .grow = 1 }, Sigui.add_module(ctx, "cell", quiet_render, NULL, last));
+			Flex.content(ctx, cells[r][c], 10, 16);
+		}
+	}
+	Flex.update(ctx);
+	flex_stats fs;
+	Flex.stats(ctx, &fs);
+	Assert.isTrue(fs.nodes == 1 + ROWS + ROWS * CELLS && fs.measured == fs.nodes && fs.arranged == fs.nodes, "the first update should lay out every node");
+	Assert.isTrue(Flex.rect(ctx, FLEX_ROOT).height == ROWS * 20 && last->y == (ROWS - 1) * 20 + 2, "rows should stack");
+
+	//	nothing changed: no work
+	Assert.isTrue(Flex.update(ctx) == 0, "an update without changes should do nothing");
+
+	//	a cell narrower inside its row: the row re-places its cells (the growing ones share the width), nothing else moves
+	Flex.content(ctx, cells[50][3], 4, 16);
+	Flex.update(ctx);
+	Flex.stats(ctx, &fs);
+	flogf(stdout, "measured=%d arranged=%d moved=%d written=%d", fs.measured, fs.arranged, fs.moved, fs.written);
+	Assert.isTrue(fs.measured == 3 && fs.arranged + fs.moved <= 2 + CELLS, "a width change should stay inside its row");
+
+	//	a taller cell: its row grows and the rows below shift without re-placing their cells
+	Flex.content(ctx, cells[50][3], 4, 40);
+	Flex.update(ctx);
+	Flex.stats(ctx, &fs);
+	flogf(stdout, "measured=%d arranged=%d moved=%d written=%d", fs.measured, fs.arranged, fs.moved, fs.written);
+	Assert.isTrue(fs.arranged == 3 && fs.moved == (ROWS - 51) * (1 + CELLS), "rows below should be shifted, not re-placed");
+	Assert.isTrue(last->y == (ROWS - 1) * 20 + 2 + 24 && Flex.rect(ctx, FLEX_ROOT).height == ROWS * 20 + 24, "rows below should move by the growth");
+
+	//	removing a row closes the gap
+	Flex.remove(ctx, rows[0]);
+	Flex.update(ctx);
+	Flex.stats(ctx, &fs);
+	Assert.isTrue(fs.nodes == 1 + (ROWS - 1) * (1 + CELLS) && last->y == (ROWS - 2) * 20 + 2 + 24, "a removed row should free its nodes");
+	Assert.isTrue(Flex.node(ctx, rows[0], NULL, NULL) < 0, "a removed node should not take children");
+
+	Sigui.free_context(ctx);
+}
+/* test that modules run at their update rates and keep their output between runs */
+static void module_rates(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Budget.clock(ctx, fake_clock, NULL);
+	fake_ns = 0;
+	slow_ns = 1000;
+	ui_module clock = Sigui.add_module(ctx, "clock", slow_render, NULL, Sigui.new_window(ctx, 0, 0, 10, 10));
+	ui_module chart = Sigui.add_module(ctx, "chart", slow_render, NULL, Sigui.new_window(ctx, 10, 0, 10, 10));
+	ui_module every = Sigui.add_module(ctx, "every", slow_render, NULL, Sigui.new_window(ctx, 20, 0, 10, 10));
+	Budget.rate(clock, 1);
+	Budget.rate(chart, 10);
+
+	//	two seconds at 60 fps
+	frame_stats fs;
+	for (int f = 0; f < 120; ++f) {
+		Sigui.render(ctx, NULL);
+		fake_ns += 1000000000ull / 60;
+	}
+	Sigui.frame_stats(ctx, &fs);
+	module_stats cs, hs, es;
+	Sigui.stats(clock, &cs);
+	Sigui.stats(chart, &hs);
+	Sigui.stats(every, &es);
+	flogf(stdout, "clock=%llu chart=%llu every=%llu", (unsigned long long)cs.frames, (unsigned long long)hs.frames, (unsigned long long)es.frames);
+	Assert.isTrue(cs.frames == 2 && cs.paced == 118, "a 1 Hz module should run once a second");
+	Assert.isTrue(hs.frames == 20 && hs.paced == 100, "a 10 Hz module should run ten times a second");
+	Assert.isTrue(es.frames == 120 && es.paced == 0, "a module without a rate should run every frame");
+	Assert.isTrue(cs.commands == 1 && cs.render_ns == 2 * slow_ns && cs.last_ns == slow_ns, "a paced module should keep its draw list and timings");
+	Assert.isTrue(fs.drawn + fs.paced == 3 && fs.callback_ns == (uint64_t)fs.drawn * slow_ns, "frame statistics should count paced modules");
+
+	//	back to every frame
+	Budget.rate(clock, 0);
+	Sigui.render(ctx, NULL);
+	Sigui.render(ctx, NULL);
+	Sigui.stats(clock, &cs);
+	Assert.isTrue(cs.frames == 4, "a cleared rate should run every frame");
+
+	Sigui.free_context(ctx);
+}
+/* test that the watchdog flags and throttles modules over their budget */
+static void module_watchdog(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Budget.clock(ctx, fake_clock, NULL);
+	fake_ns = 0;
+	slow_ns = 3000000;
+	ui_module slow = Sigui.add_module(ctx, "slow", slow_render, slow_handler, Sigui.new_window(ctx, 0, 0, 10, 10));
+	ui_module fast = Sigui.add_module(ctx, "fast", quiet_render, NULL, Sigui.new_window(ctx, 10, 0, 10, 10));
+	Budget.budget(slow, 1000);
+	Budget.budget(fast, 1000);
+
+	//	flagging (the default) never skips frames
+	module_stats ms;
+	for (int f = 0; f < 10; ++f) Sigui.render(ctx, NULL);
+	Sigui.stats(slow, &ms);
+	ui_module flagged[4];
+	Assert.isTrue(ms.flagged && ms.over_budget == 10 && ms.frames == 10 && ms.throttle == 0, "a module over budget should be flagged");
+	Assert.isTrue(Budget.flagged(ctx, flagged, 4) == 1 && flagged[0] == slow, "only the slow module should be flagged");
+
+	//	handler time is charged to the module's next run
+	ui_input press = { .mouse_x = 5, .mouse_y = 5, .button = 1 };
+	Sigui.render(ctx, &press);
+	Sigui.stats(slow, &ms);
+	Assert.isTrue(ms.handler_ns == 500000 && ms.last_ns == slow_ns + 500000, "handlers should be timed");
+
+	//	throttling: 3 ms against 1 ms settles at every fourth frame (4 ms)
+	Budget.watchdog(ctx, WATCHDOG_THROTTLE, 2);
+	for (int f = 0; f < 100; ++f) Sigui.render(ctx, NULL);
+	Sigui.stats(slow, &ms);
+	frame_stats fs;
+	Sigui.frame_stats(ctx, &fs);
+	flogf(stdout, "throttle=%d frames=%llu throttled=%llu", ms.throttle, (unsigned long long)ms.frames, (unsigned long long)ms.throttled);
+	Assert.isTrue(ms.throttle == 2 && ms.flagged && ms.throttled > 60, "a slow module should be throttled until it fits");
+	Assert.isTrue(fs.flagged == 1, "frame statistics should count flagged modules");
+
+	//	cheaper again: it steps down and is unflagged
+	slow_ns = 500000;
+	for (int f = 0; f < 40; ++f) Sigui.render(ctx, NULL);
+	Sigui.stats(slow, &ms);
+	Assert.isTrue(ms.throttle == 0 && !ms.flagged && Budget.flagged(ctx, NULL, 0) == 0, "a module that fits again should recover");
+	Sigui.stats(fast, &ms);
+	Assert.isTrue(!ms.flagged && ms.throttled == 0 && ms.over_budget == 0, "a fast module should never be throttled");
+
+	Sigui.free_context(ctx);
+}
+static void quiet_render(ui_context ctx, ui_module module, ui_input* input) {
+	//	no-op renderer
+}
+static int window_is(window w, int x, int y, int width, int height) {
+	if (!w) return 0;
+	flogf(stdout, "window (%d, %d, %d, %d)", w->x, w->y, w->width, w->height);
+
+	return w->x == x && w->y == y && w->width == width && w->height == height;
+}
+
+static uint64_t fake_clock(object data) {
+	return fake_ns;
+}
+static void slow_render(ui_context ctx, ui_module module, ui_input* input) {
+	Draw.rect(ctx, 0, 0, 4, 4, UI_RGB(0xFF, 0, 0));
+	fake_ns += slow_ns;
+}
+static void slow_handler(ui_context ctx, ui_module module, event_info ei) {
+	fake_ns += 500000;
+}
+
 // Register test cases
 __attribute__((constructor)) void init_sigtest_tests(void) {
 	register_test("unit_testing", unit_testing);
@@ -167,4 +396,8 @@ __attribute__((constructor)) void init_sigtest_tests(void) {
 	register_test("render_with_window", render_with_window);
 	register_test("create_event_info", create_event_info);
 	register_test("create_command_obj", create_command_obj);
+	register_test("flex_layout", flex_layout);
+	register_test("flex_incremental", flex_incremental);
+	register_test("module_rates", module_rates);
+	register_test("module_watchdog", module_watchdog);
 }
@@ -31,6 +31,15 @@ static event_info create_mouse_event(event_type, int, int, int, ui_input*);
 static event_info create_keyboard_event(event_type, int, ui_input*);
 //	reset event counts
 static void reset_event_counts(void);
+//	records the module and phase of each call
+static void trace_handler(ui_context, ui_module, event_info);
+//	records like trace_handler, then stops propagation
+static void stop_handler(ui_context, ui_module, event_info);
+//	queues and dispatches a mouse event
+static void click(ui_context, event_type, int, int);
+
+static char trace[512];
+static ui_module trace_target = NULL;
 
 /* test info */
 void unit_testing(void) {
@@ -53,7 +62,7 @@ void queue_ui_event(void) {
 	printf("\n");
 	fflush(stdout);
 	
-	ui_context ctx = Sigui.new_context(NULL);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
 	Assert.isTrue(ctx != NULL, "context should not be NULL");
 	
 	ui_input input = {0};
@@ -82,8 +91,8 @@ void dispatch_queued_event(void) {
 	printf("\n");
 	fflush(stdout);
 	
-	ui_context ctx = Sigui.new_context(NULL);
-	window win = Sigui.new_window(0, 0, 100, 200);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 0, 0, 100, 200);
 
 	ui_module m = Sigui.add_module(ctx, "TestModule", dummy_render, test_handler, win);
 	m->enabled = 1;
@@ -104,10 +113,10 @@ void queue_ui_command(void) {
 	printf("\n");
 	fflush(stdout);
 	
-	ui_context ctx = Sigui.new_context(NULL);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
 	Assert.isTrue(ctx != NULL, "context should not be NULL");
 	
-	command cmd = Sigui.new_command("test");
+	command cmd = Sigui.new_command(ctx, "test");
 	cmd->execute = test_command_execute;
 
 	Dispatcher.queue_command(ctx, cmd);
@@ -121,8 +130,8 @@ static void dispatch_queued_command(void) {
 	fflush(stdout);
 	
 	flogf(stdout, "creating ui context");
-	ui_context ctx = Sigui.new_context(NULL);
-	window win = Sigui.new_window(0, 0, 100, 200);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 0, 0, 100, 200);
 	ui_module m = Sigui.add_module(ctx, "TestModule", dummy_render, test_command_handler, win);
 	m->enabled = 1;
 	flogf(stdout, "created module=%s", m->name);
@@ -150,8 +159,8 @@ static void validate_input_transitions(void) {
 	
 	reset_event_counts();
 	
-	ui_context ctx = Sigui.new_context(NULL);
-	window win = Sigui.new_window(50, 50, 300, 400);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 50, 50, 300, 400);
 	Sigui.add_module(ctx, "TestWindow", dummy_render, test_transition_handler, win);
 	
 	ui_input input = {0};
@@ -178,6 +187,140 @@ static void validate_input_transitions(void) {
 	
 	Sigui.free_context(ctx);
 }
+/* test capture/target/bubble order, stop, pointer capture and broadcast */
+static void module_tree_propagation(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_module root = Sigui.add_module(ctx, "R", dummy_render, trace_handler, Sigui.new_window(ctx, 0, 0, 400, 400));
+	ui_module panel = Sigui.add_module(ctx, "P", dummy_render, trace_handler, Sigui.new_window(ctx, 10, 10, 200, 200));
+	ui_module button = Sigui.add_module(ctx, "B", dummy_render, trace_handler, Sigui.new_window(ctx, 20, 20, 50, 50));
+	Sigui.add_module(ctx, "S", dummy_render, trace_handler, Sigui.new_window(ctx, 500, 0, 100, 100));
+	Assert.isTrue(ModuleTree.attach(root, panel) == 0 && ModuleTree.attach(panel, button) == 0, "attach should succeed");
+	Assert.isTrue(ModuleTree.attach(button, root) != 0, "a cycle should be refused");
+	Assert.isTrue(ModuleTree.parent(button) == panel && ModuleTree.children(root) == 1 && ModuleTree.child(panel, 0) == button,
+					  "the tree should read back");
+	ModuleTree.capture(root, trace_handler);
+	ModuleTree.capture(panel, trace_handler);
+
+	//	only the path to the target runs, in capture, target, bubble order
+	click(ctx, EVENT_MOUSE_PRESS, 30, 30);
+	flogf(stdout, "press: %s", trace);
+	Assert.isTrue(!strcmp(trace, "Rc Pc Bt Pb Rb ") && trace_target == button, "the press should capture down to B and bubble back");
+
+	//	the release goes to the module that took the press, wherever it happens
+	click(ctx, EVENT_MOUSE_RELEASE, 550, 50);
+	Assert.isTrue(!strcmp(trace, "Rc Pc Bt Pb Rb "), "the release should follow the press");
+
+	//	a press on the panel itself: its capture handler runs at the target phase
+	click(ctx, EVENT_MOUSE_PRESS, 150, 150);
+	Assert.isTrue(!strcmp(trace, "Rc Pt Pt Rb "), "the target should run its capture then its handler");
+	click(ctx, EVENT_MOUSE_RELEASE, 150, 150);
+
+	//	stop in a capture handler ends the walk
+	ModuleTree.capture(panel, stop_handler);
+	click(ctx, EVENT_MOUSE_PRESS, 30, 30);
+	Assert.isTrue(!strcmp(trace, "Rc Pc "), "stop should end propagation");
+	click(ctx, EVENT_MOUSE_RELEASE, 30, 30);
+
+	//	a press that hits nothing is broadcast (stop still applies)
+	ModuleTree.capture(panel, trace_handler);
+	click(ctx, EVENT_MOUSE_PRESS, 900, 900);
+	Assert.isTrue(!strcmp(trace, "R- P- B- S- "), "an untargeted event should reach every module");
+	click(ctx, EVENT_MOUSE_RELEASE, 900, 900);
+	button->handler = stop_handler;
+	click(ctx, EVENT_MOUSE_PRESS, 900, 900);
+	Assert.isTrue(!strcmp(trace, "R- P- B- "), "stop should end a broadcast");
+	click(ctx, EVENT_MOUSE_RELEASE, 900, 900);
+
+	//	disabled modules are not hit; the press falls to the parent
+	button->enabled = 0;
+	click(ctx, EVENT_MOUSE_PRESS, 30, 30);
+	Assert.isTrue(!strcmp(trace, "Rc Pt Pt Rb "), "a disabled module should not be a target");
+	click(ctx, EVENT_MOUSE_RELEASE, 30, 30);
+
+	tree_stats ts;
+	ModuleTree.stats(ctx, &ts);
+	Assert.isTrue(ts.roots == 2 && ts.targeted == 8 && ts.broadcast == 4 && ts.stopped == 4, "stats should count the dispatches");
+
+	Sigui.free_context(ctx);
+}
+/* test cached subtree bounds, hit tests and subtree culling */
+static void module_tree_bounds(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	enum { GROUPS = 20, ITEMS = 50 };
+	ui_module groups[GROUPS];
+	for (int g = 0; g < GROUPS; ++g) {
+		groups[g] = Sigui.add_module(ctx, "group", dummy_render, trace_handler, NULL);
+		for (int i = 0; i < ITEMS; ++i) {
+			ui_module item = Sigui.add_module(ctx, "item", dummy_render, trace_handler,
+														 Sigui.new_window(ctx, g * 1000 + (i % 10) * 20, (i / 10) * 20, 20, 20));
+			ModuleTree.attach(groups[g], item);
+		}
+	}
+	ui_rect b = ModuleTree.bounds(groups[3]);
+	Assert.isTrue(b.x == 3000 && b.y == 0 && b.width == 200 && b.height == 100, "a group should bound its items");
+
+	//	moving one window recomputes its ancestors only
+	tree_stats before, after;
+	ModuleTree.stats(ctx, &before);
+	ui_module moved = ModuleTree.child(groups[3], 7);
+	moved->win->x = 3500;
+	b = ModuleTree.bounds(groups[3]);
+	ModuleTree.stats(ctx, &after);
+	Assert.isTrue(b.width == 520 && after.refreshed - before.refreshed == 2, "a move should recompute the changed path");
+
+	//	hit tests skip groups whose bounds miss the point
+	ModuleTree.stats(ctx, &before);
+	ui_module hit = ModuleTree.hit(ctx, 3510, 5);
+	ModuleTree.stats(ctx, &after);
+	Assert.isTrue(hit == moved, "the moved window should be hit");
+	Assert.isTrue(after.tested - before.tested < GROUPS + ITEMS + 1, "a hit test should visit one group's items");
+	Assert.isTrue(ModuleTree.hit(ctx, 3300, 5) == NULL, "a point between items should hit nothing");
+
+	//	a press reaches the item and its group only
+	click(ctx, EVENT_MOUSE_PRESS, 3510, 5);
+	Assert.isTrue(!strcmp(trace, "itemt groupb "), "the press should bubble to the group only");
+
+	//	groups outside the viewport are culled with their items
+	Sigui.viewport(ctx, (ui_rect){ 0, 0, 1500, 200 });
+	Sigui.render(ctx, NULL);
+	frame_stats fs;
+	Sigui.frame_stats(ctx, &fs);
+	Assert.isTrue(fs.culled_viewport == (GROUPS - 2) * ITEMS && fs.drawn == 2 * ITEMS + GROUPS, "groups off screen should be culled");
+
+	Sigui.free_context(ctx);
+}
+
+/* test that hit tests follow the draw order across roots */
+static void module_tree_draw_order(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_module a = Sigui.add_module(ctx, "A", dummy_render, trace_handler, Sigui.new_window(ctx, 0, 0, 200, 200));
+	ui_module b = Sigui.add_module(ctx, "B", dummy_render, trace_handler, Sigui.new_window(ctx, 50, 50, 100, 100));
+	ui_module c = Sigui.add_module(ctx, "C", dummy_render, trace_handler, Sigui.new_window(ctx, 60, 60, 20, 20));
+	Assert.isTrue(ModuleTree.attach(a, c) == 0, "C should move under A");
+
+	//	C hangs from the first root but is drawn after B
+	Assert.isTrue(ModuleTree.hit(ctx, 65, 65) == c, "a child drawn over a later root should be hit");
+	Assert.isTrue(ModuleTree.hit(ctx, 55, 55) == b, "the later root should be hit beside the child");
+	Assert.isTrue(ModuleTree.hit(ctx, 10, 10) == a, "the first root should be hit where nothing covers it");
+	click(ctx, EVENT_MOUSE_PRESS, 65, 65);
+	Assert.isTrue(!strcmp(trace, "Ct Ab "), "the press should go to the child drawn on top");
+	click(ctx, EVENT_MOUSE_RELEASE, 65, 65);
+
+	//	a disabled child drops out of hit tests
+	c->enabled = 0;
+	Assert.isTrue(ModuleTree.hit(ctx, 65, 65) == b, "a disabled child should not be hit");
+
+	Sigui.free_context(ctx);
+}
 
 static void dummy_render(ui_context ctx, ui_module module, ui_input* input) {
 	//	no-op dummy renderer ...
@@ -200,14 +343,14 @@ static void test_transition_handler(ui_context ctx, ui_module module, event_info
 	
 	
 	if (e->type == EVENT_MOUSE_PRESS) {
-		command cmd = Sigui.new_command("click: show_message");
+		command cmd = Sigui.new_command(ctx, "click: show_message");
 		cmd->target = module; 						// the target module
 		cmd->execute = test_command_execute;
 		
 		flogf(stdout, "enqueueing command name=%s target=%s", cmd->name, module->name);
 		Dispatcher.queue_command(ctx, cmd);
 	} else if (e->type == EVENT_KEY_PRESS && e->data.key.key_code == ' ') {
-		command cmd = Sigui.new_command("key: toggle_state");
+		command cmd = Sigui.new_command(ctx, "key: toggle_state");
 		cmd->target = module; 						// the target module
 		cmd->execute = test_command_execute;
 		
@@ -224,7 +367,7 @@ static void test_command_handler(ui_context ctx, ui_module module, event_info ei
 	
 	flogf(stdout, "building command: event=%d", e->type);
 	if (e->type == EVENT_MOUSE_PRESS) {
-		command cmd = Sigui.new_command("test_cmd");
+		command cmd = Sigui.new_command(ctx, "test_cmd");
 		cmd->target = module; 						// the target module
 		cmd->execute = test_command_execute;
 		
@@ -239,7 +382,7 @@ static event_info create_mouse_event(event_type type, int mouse_x, int mouse_y,
 	//	reset keys
 	memset(input->keys, 0, sizeof(input->keys));
 	
-	return Sigui.new_event(type, input, button);
+	return Sigui.new_event(NULL, type, input, button);
 }
 static event_info create_keyboard_event(event_type type, int key, ui_input* input) {
 	input->mouse_x = 0;
@@ -249,7 +392,26 @@ static event_info create_keyboard_event(event_type type, int key, ui_input* inpu
 	memset(input->keys, 0, sizeof(input->keys));
 	input->keys[key] = 1;
 	
-	return Sigui.new_event(type, input, key);
+	return Sigui.new_event(NULL, type, input, key);
+}
+static void trace_handler(ui_context ctx, ui_module module, event_info ei) {
+	static const char phases[] = "-ctb";
+	size_t n = strlen(trace);
+	if (ei->phase == EVENT_PHASE_BROADCAST || ei->phase == EVENT_PHASE_TARGET) trace_target = ei->target;
+	Assert.isTrue(ei->current_target == module, "current_target should be the running module");
+	snprintf(trace + n, sizeof(trace) - n, "%s%c ", module->name, phases[ei->phase]);
+}
+static void stop_handler(ui_context ctx, ui_module module, event_info ei) {
+	trace_handler(ctx, module, ei);
+	ei->stop = 1;
+}
+static void click(ui_context ctx, event_type type, int x, int y) {
+	ui_input input = {0};
+	input.mouse_x = x;
+	input.mouse_y = y;
+	trace[0] = 0;
+	Dispatcher.queue_event(ctx, Sigui.new_event(ctx, type, &input, MOUSE_BUTTON_LEFT));
+	Dispatcher.dispatch_events(ctx);
 }
 static void reset_event_counts(void) {
 	//	reset event counts
@@ -264,4 +426,7 @@ __attribute__((constructor)) void init_sigtest_tests(void) {
 	register_test("queue_ui_command", queue_ui_command);
 	register_test("dispatch_queued_command", dispatch_queued_command);
 	register_test("validate_input_transitions", validate_input_transitions);
+	register_test("module_tree_propagation", module_tree_propagation);
+	register_test("module_tree_bounds", module_tree_bounds);
+	register_test("module_tree_draw_order", module_tree_draw_order);
 }
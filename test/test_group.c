@@ -0,0 +1,119 @@
+// test_group.c
+#include "sigui.h"
+#include "../src/ui_core.h"
+#include "render.h"
+#include "sigui_group.h"
+#include <sigtest.h>
+#include <sigcore.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+// Assert.isTrue(condition, "fail message");
+// Assert.isFalse(condition, "fail message");
+// Assert.areEqual(obj1, obj2, INT, "fail message");
+// Assert.areEqual(obj1, obj2, PTR, "fail message");
+// Assert.areEqual(obj1, obj2, STRING, "fail message");
+
+#define MEMBERS 16
+
+static atomic_int renders;
+
+//	counting renderer function for module
+static void counting_render(ui_context, ui_module, ui_input*);
+
+/* test info */
+void test_harness(void) {
+	printf("\n");
+	fflush(stdout);
+
+	time_t rawtime;
+	time(&rawtime);
+
+	struct tm* timeinfo;
+	timeinfo = localtime(&rawtime);
+
+	char date_str[20];
+	strftime(date_str, sizeof(date_str), "%b-%d-%Y [%H:%M]", timeinfo);
+
+	flogf(stdout, "Test Run Date=%s", date_str);
+}
+/* test group creation */
+void new_group(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_group g = Group.new(4);
+	Assert.isTrue(g != NULL, "group should not be NULL");
+	Assert.isTrue(Group.threads(g) == 4, "group should step on 4 threads");
+	Assert.isTrue(Group.count(g) == 0, "new group should be empty");
+
+	Group.free(g);
+}
+/* test stepping independent contexts in parallel */
+void step_group_members(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctxs[MEMBERS];
+	render_target targets[MEMBERS];
+	ui_group g = Group.new(4);
+
+	for (int i = 0; i < MEMBERS; ++i) {
+		ctxs[i] = Sigui.new_context(NULL, NULL);
+		targets[i] = Render.new_target(RENDER_HEADLESS, 64, 64);
+		window win = Sigui.new_window(ctxs[i], i, i, 8, 8);		// each member draws somewhere else
+		Sigui.add_module(ctxs[i], "Member", counting_render, NULL, win);
+		Assert.isTrue(Group.add(g, ctxs[i], targets[i]) == i, "member index mismatch");
+	}
+
+	atomic_store(&renders, 0);
+	const int frames = 3;
+	for (int f = 0; f < frames; ++f) Group.step(g);
+	flogf(stdout, "renders=%d", atomic_load(&renders));
+	Assert.isTrue(atomic_load(&renders) == MEMBERS * frames, "every member should render once per step");
+
+	//	each framebuffer holds only its own module
+	for (int i = 0; i < MEMBERS; ++i) {
+		const uint32_t* px = Render.pixels(targets[i]);
+		Assert.isTrue(px[i * 64 + i] == 0xFFFFFFFFu, "member quad missing");
+		Assert.isTrue(px[(i + 8) * 64 + i + 8] == 0xFF000000u, "pixel outside member quad should be clear");
+	}
+
+	Group.free(g);
+	for (int i = 0; i < MEMBERS; ++i) {
+		Render.free_target(targets[i]);
+		Sigui.free_context(ctxs[i]);
+	}
+}
+/* test per-member input */
+void member_input(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Member", counting_render, NULL, NULL);
+	ui_group g = Group.new(2);
+	int index = Group.add(g, ctx, NULL);
+
+	ui_input input = {0};
+	input.keys['A'] = 1;
+	Group.set_input(g, index, &input);
+	Group.step(g);
+	Assert.isTrue(ctx->input_state.keys['A'] == 1, "member input should reach the context");
+
+	Group.free(g);
+	Sigui.free_context(ctx);
+}
+
+static void counting_render(ui_context ctx, ui_module module, ui_input* input) {
+	atomic_fetch_add(&renders, 1);
+}
+
+// Register test cases
+__attribute__((constructor)) void init_sigtest_tests(void) {
+	register_test("test_harness", test_harness);
+	register_test("new_group", new_group);
+	register_test("step_group_members", step_group_members);
+	register_test("member_input", member_input);
+}
@@ -33,6 +33,17 @@ static event_info create_mouse_event(event_type, int, int, int, ui_input*);
 static event_info create_keyboard_event(event_type, int, ui_input*);
 //	reset event counts
 static void reset_event_counts(void);
+//	press and release a key over two frames
+static void press_key(ui_context, ui_input*, int);
+//	key binding commands
+static void count_command(ui_context, ui_module);
+static void save_command(ui_context, ui_module);
+static void comment_command(ui_context, ui_module);
+static void cut_command(ui_context, ui_module);
+
+static int command_runs = 0;
+static const char* command_last = "";
+static ui_module command_target = NULL;
 
 /* test info */
 void test_harness(void) {
@@ -128,6 +139,107 @@ static void multi_key_input(void) {
 	clean_up_context(ctx);
 }
 
+/* test shortcuts, chords, modifiers and focus scoping */
+static void key_bindings(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = set_up_context();
+	ui_module editor = Sigui.add_module(ctx, "Editor", dummy_render, NULL, Sigui.new_window(ctx, 0, 0, 10, 10));
+	reset_event_counts();
+	int save = Keymap.command(ctx, "save", save_command);
+	int comment = Keymap.command(ctx, "comment", comment_command);
+	int cut = Keymap.command(ctx, "cut", cut_command);
+	key_stroke ctrl_s = { KEY_MOD_CTRL, 'S' };
+	key_stroke chord[2] = { { KEY_MOD_CTRL, 'K' }, { KEY_MOD_CTRL, 'C' } };
+	key_stroke x = { KEY_MOD_NONE, 'X' };
+	Assert.isTrue(save > 0 && comment > save && cut > comment, "commands should get increasing ids");
+	Assert.isTrue(Keymap.bind(ctx, NULL, &ctrl_s, 1, save) == 0 && Keymap.bind(ctx, NULL, chord, 2, comment) == 0 &&
+					  Keymap.bind(ctx, editor, &x, 1, cut) == 0, "bindings should register");
+	Assert.isTrue(Keymap.bind(ctx, NULL, chord, 1, save) != 0, "a prefix of a chord should be refused");
+
+	//	ctrl+s: the command runs, no key events reach the modules
+	ui_input input = {0};
+	input.modifiers = KEY_MOD_CTRL;
+	press_key(ctx, &input, 'S');
+	Assert.isTrue(command_runs == 1 && !strcmp(command_last, "save"), "ctrl+s should run save");
+	Assert.isTrue(event_counts[EVENT_KEY_PRESS] == 0 && event_counts[EVENT_KEY_RELEASE] == 0, "a bound press should be consumed with its release");
+
+	//	plain s is a different stroke
+	input.modifiers = KEY_MOD_NONE;
+	press_key(ctx, &input, 'S');
+	Assert.isTrue(command_runs == 1 && event_counts[EVENT_KEY_PRESS] == 1, "modifiers should be matched exactly");
+
+	//	ctrl+k ctrl+c
+	input.modifiers = KEY_MOD_CTRL;
+	press_key(ctx, &input, 'K');
+	keymap_stats ks;
+	Keymap.stats(ctx, &ks);
+	Assert.isTrue(command_runs == 1 && ks.pending == 1, "a chord prefix should wait for the next stroke");
+	press_key(ctx, &input, 'C');
+	Assert.isTrue(command_runs == 2 && !strcmp(command_last, "comment"), "the chord should run comment");
+
+	//	a broken chord lets the stroke through
+	press_key(ctx, &input, 'K');
+	input.modifiers = KEY_MOD_NONE;
+	press_key(ctx, &input, 'Q');
+	Assert.isTrue(command_runs == 2 && event_counts[EVENT_KEY_PRESS] == 2, "a stroke that breaks a chord should be delivered");
+
+	//	scoped bindings need focus; the focused module is the target
+	press_key(ctx, &input, 'X');
+	Assert.isTrue(command_runs == 2 && event_counts[EVENT_KEY_PRESS] == 3, "scoped bindings should be ignored without focus");
+	Keymap.focus(ctx, editor);
+	press_key(ctx, &input, 'X');
+	Assert.isTrue(command_runs == 3 && command_target == editor && !strcmp(command_last, "cut"), "focus should enable scoped bindings");
+	input.modifiers = KEY_MOD_CTRL;
+	press_key(ctx, &input, 'S');
+	Assert.isTrue(command_runs == 4 && command_target == editor, "global bindings should still apply under focus");
+
+	Assert.isTrue(Keymap.unbind(ctx, NULL, &ctrl_s, 1) == 0, "unbind should remove the binding");
+	press_key(ctx, &input, 'S');
+	Assert.isTrue(command_runs == 4 && event_counts[EVENT_KEY_PRESS] == 4, "an unbound stroke should be delivered");
+
+	clean_up_context(ctx);
+}
+/* test that lookups stay a probe or two with many bindings */
+static void key_binding_scale(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = set_up_context();
+	reset_event_counts();
+	int id = Keymap.command(ctx, "noop", count_command);
+	int bound = 0;
+	for (int a = 'A'; a <= 'Z'; ++a) {
+		for (int b = '0'; b <= '9'; ++b) {
+			for (uint32_t m = 0; m < 4; ++m) {
+				key_stroke chord[3] = { { KEY_MOD_CTRL | KEY_MOD_ALT, a }, { m, b }, { KEY_MOD_SHIFT, 'Z' } };
+				bound += Keymap.bind(ctx, NULL, chord, 3, id) == 0;
+			}
+		}
+	}
+	Keymap.compile(ctx);
+	keymap_stats ks;
+	Keymap.stats(ctx, &ks);
+	Assert.isTrue(bound == 26 * 10 * 4 && ks.bindings == bound && ks.nodes == 1 + 26 + 26 * 40 * 2, "every chord should compile");
+
+	ui_input input = {0};
+	for (int i = 0; i < 300; ++i) {
+		input.modifiers = KEY_MOD_CTRL | KEY_MOD_ALT;
+		press_key(ctx, &input, 'A' + i % 26);
+		input.modifiers = i % 4;
+		press_key(ctx, &input, '0' + i % 10);
+		input.modifiers = KEY_MOD_SHIFT;
+		press_key(ctx, &input, 'Z');
+	}
+	Keymap.stats(ctx, &ks);
+	Assert.isTrue(command_runs == 300 && ks.matched == 300 && event_counts[EVENT_KEY_PRESS] == 0, "every chord should match");
+	Assert.isTrue(ks.probes < ks.lookups * 3, "a lookup should take a probe or two");
+	printf("bindings=%d nodes=%d slots=%d probes/lookup=%.2f\n", ks.bindings, ks.nodes, ks.slots, (double)ks.probes / ks.lookups);
+
+	clean_up_context(ctx);
+}
+
 //	Handlers ====================================================================
 static void dummy_render(ui_context ctx, ui_module module, ui_input* input) {
 	//	no-op dummy renderer ...
@@ -171,8 +283,8 @@ static void input_test_handler(ui_context ctx, ui_module module, event_info ei)
 //	Sigui Test Functions ========================================================
 //	[TODO] TASK: (maintenance, low priority) Move to `sigui_test.h`
 static ui_context set_up_context(void) {
-	ui_context ctx = Sigui.new_context(NULL);
-	window win = Sigui.new_window(0, 0, 100, 200);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 0, 0, 100, 200);
 	Sigui.add_module(ctx, "TestModule", dummy_render, input_test_handler, win);
 	
 	return ctx;
@@ -187,7 +299,7 @@ static event_info create_mouse_event(event_type type, int mouse_x, int mouse_y,
 	//	reset keys
 	memset(input->keys, 0, sizeof(input->keys));
 	
-	return Sigui.new_event(type, input, button);
+	return Sigui.new_event(NULL, type, input, button);
 }
 static event_info create_keyboard_event(event_type type, int key, ui_input* input) {
 	input->mouse_x = 0;
@@ -197,12 +309,36 @@ static event_info create_keyboard_event(event_type type, int key, ui_input* inpu
 	memset(input->keys, 0, sizeof(input->keys));
 	input->keys[key] = 1;
 	
-	return Sigui.new_event(type, input, key);
+	return Sigui.new_event(NULL, type, input, key);
 }
 static void reset_event_counts(void) {
 	//	reset event counts
 	event_id = 0;
 	memset(event_counts, 0, sizeof(event_counts));
+	command_runs = 0;
+	command_target = NULL;
+}
+static void press_key(ui_context ctx, ui_input* input, int key) {
+	input->keys[key] = 1;
+	Sigui.render(ctx, input);
+	input->keys[key] = 0;
+	Sigui.render(ctx, input);
+}
+static void count_command(ui_context ctx, ui_module m) {
+	command_runs++;
+	command_target = m;
+}
+static void save_command(ui_context ctx, ui_module m) {
+	command_last = "save";
+	count_command(ctx, m);
+}
+static void comment_command(ui_context ctx, ui_module m) {
+	command_last = "comment";
+	count_command(ctx, m);
+}
+static void cut_command(ui_context ctx, ui_module m) {
+	command_last = "cut";
+	count_command(ctx, m);
 }
 
 // Register test cases
@@ -210,4 +346,6 @@ __attribute__((constructor)) void init_sigtest_tests(void) {
     register_test("test_harness", test_harness);
 //    register_test("multi_button_input", multi_button_input);
     register_test("multi_key_input", multi_key_input);
+    register_test("key_bindings", key_bindings);
+    register_test("key_binding_scale", key_binding_scale);
 }
@@ -2,11 +2,21 @@
 #include "sigui.h"
 #include "../src/ui_core.h"
 #include "render.h"
+#include "sigui_pipeline.h"
+#include "sigui_remote.h"
 #include "sigui_debug.h"
 #include <sigtest.h>
 #include <sigcore.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <time.h>
+#include <unistd.h>
 
 #define POKE 0
 
@@ -17,8 +27,26 @@
 // Assert.areEqual(obj1, obj2, STRING, "fail message");
 
 static void test_dummy_renderer(ui_context, ui_module, ui_input*);
+static void test_rect_renderer(ui_context, ui_module, ui_input*);
+static void test_tall_renderer(ui_context, ui_module, ui_input*);
+static void test_clip_renderer(ui_context, ui_module, ui_input*);
+static void test_shape_renderer(ui_context, ui_module, ui_input*);
+static void test_text_renderer(ui_context, ui_module, ui_input*);
+static void test_fixed_text_renderer(ui_context, ui_module, ui_input*);
+static void test_paragraph_renderer(ui_context, ui_module, ui_input*);
+static void test_mesh_renderer(ui_context, ui_module, ui_input*);
+static void test_stroke_renderer(ui_context, ui_module, ui_input*);
+static void test_image_renderer(ui_context, ui_module, ui_input*);
+
+static uint32_t rect_color = 0xFFFF0000u;
+static int rect_calls = 0;
+static const char* text_value = "Hi";
+static int paragraph_wrap = 0;
+static ui_image image_values[3];		/* image drawn by the module at window x / 20 */
+static int image_freed = 0;				/* set by free_image_thread once Image.free returns */
 
 static void reset_mocks(void);
+static size_t make_ppm(uint8_t*, int, int, uint32_t);
 
 /* test info */
 void test_harness(void) {
@@ -109,9 +137,9 @@ void test_render_module(void) {
 	flogf(stdout, "rendering module");
 	reset_mocks();
 
-	ui_context ctx = Sigui.new_context(NULL);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
 	Assert.isTrue(ctx != NULL, "context creation failed");
-	window win = Sigui.new_window(50, 50, 300, 400);
+	window win = Sigui.new_window(ctx, 50, 50, 300, 400);
 	Assert.isTrue(win != NULL, "window creation failed");
 	//	must have a renderer to create module
 	ui_module m = Sigui.add_module(ctx, "TestModule", test_dummy_renderer, NULL, win);
@@ -129,6 +157,1272 @@ void test_render_module(void) {
 	reset_mocks();
 }
 
+/* headless render target */
+void test_headless_target(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "headless render target");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 64, 48);
+	Assert.isTrue(t != NULL, "headless target creation failed");
+	Assert.isTrue(mock_sdl_init_called == 0, "headless target should not touch SDL");
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 10, 10, 20, 20);
+	Sigui.add_module(ctx, "TestModule", test_dummy_renderer, NULL, win);
+
+	Render.frame(t, ctx);
+	const uint32_t* px = Render.pixels(t);
+	Assert.isTrue(px != NULL, "headless target should expose pixels");
+	Assert.isTrue(px[15 * 64 + 15] == 0xFFFFFFFFu, "pixel inside window should be white");
+	Assert.isTrue(px[5 * 64 + 5] == 0xFF000000u, "pixel outside window should be black");
+	Assert.isTrue(mock_gl_begin_called == 0, "headless target should not call GL");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	reset_mocks();
+}
+
+/* damage tracking and partial redraw */
+void test_damage_partial_redraw(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "damage tracking");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 200, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 10, 10, 20, 20);
+	ui_module m = Sigui.add_module(ctx, "TestModule", test_dummy_renderer, NULL, win);
+	render_stats stats;
+
+	//	first frame: full redraw
+	Render.frame(t, ctx);
+	Render.stats(t, &stats);
+	Assert.isTrue(stats.frames == 1 && stats.pixels == 200 * 100, "first frame should be a full redraw");
+
+	//	nothing changed: skipped
+	Render.frame(t, ctx);
+	Render.stats(t, &stats);
+	Assert.isTrue(stats.frames == 1 && stats.skipped == 1, "frame without damage should be skipped");
+
+	//	move the window: only old + new rects are redrawn
+	uint32_t* px = (uint32_t*)Render.pixels(t);
+	px[90 * 200 + 190] = 0xFF123456u;				// sentinel far from the window
+	win->x = 14;
+	Render.frame(t, ctx);
+	Render.stats(t, &stats);
+	ui_rect regions[DAMAGE_MAX_REGIONS];
+	int n = Render.damage(t, regions, DAMAGE_MAX_REGIONS);
+	flogf(stdout, "regions=%d pixels=%ld first=(%d,%d %dx%d)", n, stats.pixels,
+			regions[0].x, regions[0].y, regions[0].width, regions[0].height);
+	Assert.isTrue(n == 1, "overlapping old/new rects should merge into one region");
+	Assert.isTrue(stats.pixels == 24 * 20, "only the union of old and new rects should be redrawn");
+	Assert.isTrue(px[90 * 200 + 190] == 0xFF123456u, "undamaged pixels should not be touched");
+	Assert.isTrue(px[15 * 200 + 11] == 0xFF000000u, "uncovered part of the old rect should be cleared");
+	Assert.isTrue(px[15 * 200 + 33] == 0xFFFFFFFFu, "new rect should be drawn");
+
+	//	explicit invalidation
+	Sigui.invalidate(m);
+	Render.frame(t, ctx);
+	Render.stats(t, &stats);
+	Assert.isTrue(stats.frames == 3 && stats.pixels == 20 * 20, "invalidated module should be redrawn");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* damage region merging */
+void test_damage_merging(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "damage merging");
+
+	damage_set ds = {0};
+	for (int i = 0; i < 32; ++i) Damage.add(&ds, (ui_rect){ i * 20, (i % 3) * 40, 10, 10 });
+	flogf(stdout, "regions=%d", ds.count);
+	Assert.isTrue(ds.count <= DAMAGE_MAX_REGIONS, "region count should stay bounded");
+
+	damage_set overlap = {0};
+	Damage.add(&overlap, (ui_rect){ 0, 0, 10, 10 });
+	Damage.add(&overlap, (ui_rect){ 5, 5, 10, 10 });
+	Damage.add(&overlap, (ui_rect){ 2, 2, 2, 2 });
+	Assert.isTrue(overlap.count == 1, "overlapping rects should merge");
+	Assert.isTrue(overlap.rects[0].width == 15 && overlap.rects[0].height == 15, "merged region mismatch");
+}
+
+/* retained draw lists and per-target vertex caches */
+void test_draw_list_cache(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "draw list cache");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 100, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 10, 10, 40, 40);
+	ui_module m = Sigui.add_module(ctx, "Rects", test_rect_renderer, NULL, win);
+	module_stats ms;
+	rect_color = 0xFFFF0000u;
+	rect_calls = 0;
+
+	//	first frame records and builds vertices
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	const uint32_t* px = Render.pixels(t);
+	Sigui.stats(m, &ms);
+	Assert.isTrue(Draw.count(m) == 1 && ms.commands == 1, "one command should be recorded");
+	Assert.isTrue(ms.cache_misses == 1 && ms.cache_hits == 0, "first frame should miss the cache");
+	Assert.isTrue(px[15 * 100 + 15] == 0xFFFF0000u, "recorded rect should be drawn");
+	Assert.isTrue(px[30 * 100 + 30] == 0xFFFFFFFFu, "window background should be drawn");
+
+	//	same commands: no damage, nothing rebuilt
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	render_stats rs;
+	Render.stats(t, &rs);
+	Sigui.stats(m, &ms);
+	Assert.isTrue(rs.skipped == 1, "identical draw list should not damage the window");
+
+	//	external damage: vertices are reused
+	Sigui.damage(ctx, (ui_rect){ 0, 0, 100, 100 });
+	Render.frame(t, ctx);
+	Sigui.stats(m, &ms);
+	Assert.isTrue(ms.cache_hits == 1 && ms.cache_misses == 1, "unchanged module should hit the cache");
+
+	//	changed content damages the window and rebuilds
+	rect_color = 0x800000FFu;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Sigui.stats(m, &ms);
+	flogf(stdout, "hits=%ld misses=%ld blended=%08x", (long)ms.cache_hits, (long)ms.cache_misses, px[15 * 100 + 15]);
+	Assert.isTrue(ms.cache_misses == 2, "changed draw list should rebuild vertices");
+	Assert.isTrue(px[15 * 100 + 15] == 0xFF7F7FFFu, "translucent rect should blend over the background");
+
+	//	retained: callback is skipped until invalidated
+	Draw.retain(m, 1);
+	int calls = rect_calls;
+	Sigui.render(ctx, NULL);
+	Sigui.stats(m, &ms);
+	Assert.isTrue(rect_calls == calls && ms.retained == 1, "retained module should not be called back");
+	Sigui.invalidate(m);
+	Sigui.render(ctx, NULL);
+	Assert.isTrue(rect_calls == calls + 1, "invalidated module should be re-recorded");
+
+	//	moving the window invalidates the vertices
+	win->x = 20;
+	Render.frame(t, ctx);
+	Sigui.stats(m, &ms);
+	Assert.isTrue(ms.cache_misses == 3, "moved window should rebuild vertices");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* uploads to GL happen only when the vertices change */
+void test_draw_list_upload(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "draw list uploads");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_WINDOW, 100, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 0, 0, 50, 50);
+	Sigui.add_module(ctx, "Rects", test_rect_renderer, NULL, win);
+	rect_color = 0xFF00FF00u;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Assert.isTrue(mock_gl_buffer_uploads == 1, "first frame should upload once");
+	Assert.isTrue(mock_gl_draw_calls == 1, "one draw call per module");
+
+	Sigui.damage(ctx, (ui_rect){ 60, 60, 10, 10 });
+	Render.frame(t, ctx);
+	Assert.isTrue(mock_gl_buffer_uploads == 1, "unchanged module should not upload again");
+	Assert.isTrue(mock_gl_draw_calls == 2, "cached buffer should be drawn again");
+
+	rect_color = 0xFF0000FFu;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Assert.isTrue(mock_gl_buffer_uploads == 2, "changed module should upload again");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	reset_mocks();
+}
+
+/* layered modules are rendered once and composited */
+void test_layer_composite(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "layer compositing");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 100, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 10, 10, 40, 40);
+	ui_module m = Sigui.add_module(ctx, "Chart", test_tall_renderer, NULL, win);
+	Layer.enable(m, 40, 100);
+	rect_color = 0xFFFF0000u;
+	rect_calls = 0;
+	render_stats rs;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	const uint32_t* px = Render.pixels(t);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.layers == 1 && rs.layer_bytes == 40 * 100 * 4, "layer should be resident");
+	Assert.isTrue(rs.layer_renders == 1, "layer should be rendered once");
+	Assert.isTrue(px[15 * 100 + 15] == 0xFFFFFFFFu, "layer background should be composited");
+
+	//	scrolling is a blit: no callback, no layer render
+	Layer.scroll(m, 0, 70);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "scrolled=%08x frames=%ld", px[10 * 100 + 10], (long)rs.frames);
+	Assert.isTrue(rect_calls == 1 && rs.layer_renders == 1, "scroll should not re-render the layer");
+	Assert.isTrue(px[10 * 100 + 10] == 0xFFFF0000u, "scrolled content should be visible");
+	Assert.isTrue(px[45 * 100 + 10] == 0xFF000000u, "rows past the layer should stay clear");
+
+	//	opacity and translation re-composite
+	Layer.opacity(m, 0x80);
+	Layer.translate(m, 5, 0);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "faded=%08x regions=%d", px[10 * 100 + 15], rs.regions);
+	Assert.isTrue(rs.layer_renders == 1, "fading should not re-render the layer");
+	Assert.isTrue(px[10 * 100 + 15] == 0xFF800000u, "layer should blend with its opacity");
+	Assert.isTrue(px[10 * 100 + 12] == 0xFF000000u, "uncovered window area should be cleared");
+
+	//	moving the window does not re-render either; new content does
+	win->y = 20;
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.layer_renders == 1, "moved window should reuse the layer");
+	Sigui.invalidate(m);
+	rect_color = 0xFF00FF00u;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.layer_renders == 2, "changed content should re-render the layer");
+
+	Layer.disable(m);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.layers == 0 && rs.layer_bytes == 0, "disabled layer should be released");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* layer memory is bounded by an LRU budget */
+void test_layer_budget(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "layer budget");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_WINDOW, 100, 100);
+	Render.layer_budget(t, 3 * 20 * 20 * 4);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_module mods[4];
+	for (int i = 0; i < 4; ++i) {
+		mods[i] = Sigui.add_module(ctx, "Layered", test_rect_renderer, NULL, Sigui.new_window(ctx, i * 20, 0, 20, 20));
+		Layer.enable(mods[i], 0, 0);
+		mods[i]->enabled = i < 3;
+	}
+	render_stats rs;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.layers == 3 && mock_gl_layers_live == 3, "three layers should fit");
+	Assert.isTrue(mock_gl_fbo_binds >= 3, "layers should render through framebuffers");
+
+	//	hidden layer stays resident while within budget
+	mods[0]->enabled = 0;
+	Render.frame(t, ctx);
+	mods[0]->enabled = 1;
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.layer_renders == 3 && rs.layer_evictions == 0, "re-shown layer should be reused");
+
+	//	a fourth layer evicts the least recently used hidden one
+	mods[1]->enabled = 0;
+	Render.frame(t, ctx);
+	mods[3]->enabled = 1;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "layers=%d bytes=%ld renders=%ld evictions=%ld", rs.layers, (long)rs.layer_bytes,
+			(long)rs.layer_renders, (long)rs.layer_evictions);
+	Assert.isTrue(rs.layers == 3 && rs.layer_evictions == 1, "LRU layer should be evicted");
+	Assert.isTrue(rs.layer_renders == 4, "only the new layer should be rendered");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	Assert.isTrue(mock_gl_layers_live == 0, "framebuffers should be released with the target");
+	reset_mocks();
+}
+
+/* off-screen and occluded modules are culled before callbacks and vertex work */
+void test_cull_modules(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "module culling");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 100, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window off = Sigui.new_window(ctx, 200, 0, 20, 20);
+	Sigui.add_module(ctx, "Offscreen", test_rect_renderer, NULL, off);
+	ui_module hidden = Sigui.add_module(ctx, "Hidden", test_rect_renderer, NULL, Sigui.new_window(ctx, 10, 10, 20, 20));
+	Sigui.add_module(ctx, "Cover", test_dummy_renderer, NULL, Sigui.new_window(ctx, 0, 0, 50, 50));
+	Sigui.viewport(ctx, (ui_rect){ 0, 0, 100, 100 });
+	rect_calls = 0;
+	frame_stats fs;
+	render_stats rs;
+	module_stats ms;
+
+	Sigui.render(ctx, NULL);
+	Sigui.frame_stats(ctx, &fs);
+	Sigui.stats(hidden, &ms);
+	flogf(stdout, "modules=%d drawn=%d viewport=%d occluded=%d", fs.modules, fs.drawn,
+			fs.culled_viewport, fs.culled_occluded);
+	Assert.isTrue(rect_calls == 0, "culled modules should not be called back");
+	Assert.isTrue(fs.modules == 3 && fs.drawn == 1, "only the cover module should be drawn");
+	Assert.isTrue(fs.culled_viewport == 1 && fs.culled_occluded == 1, "culled counts should be reported");
+	Assert.isTrue(ms.culled == 1, "module stats should count culled frames");
+
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.drawn == 1 && rs.culled == 2, "renderer should skip culled modules");
+
+	//	a translucent cover does not occlude
+	Layer.enable(List.getAt(ctx->modules, 2), 0, 0);
+	Layer.opacity(List.getAt(ctx->modules, 2), 0x80);
+	off->x = 60;
+	Sigui.render(ctx, NULL);
+	Sigui.frame_stats(ctx, &fs);
+	Assert.isTrue(fs.drawn == 3 && rect_calls == 2, "uncovered modules should be drawn again");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* the clip stack clips and culls primitives */
+void test_clip_stack(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "clip stack");
+	reset_mocks();
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 90, 0, 40, 40);
+	ui_module m = Sigui.add_module(ctx, "Clipped", test_clip_renderer, NULL, win);
+	Sigui.viewport(ctx, (ui_rect){ 0, 0, 100, 100 });
+	frame_stats fs;
+
+	Sigui.render(ctx, NULL);
+	Sigui.frame_stats(ctx, &fs);
+	flogf(stdout, "primitives=%d culled=%d", fs.primitives, fs.primitives_culled);
+	Assert.isTrue(fs.primitives == 1 && fs.primitives_culled == 2, "primitives outside the clip should be culled");
+	Assert.isTrue(m->draws.cmds[0].rect.x == 2 && m->draws.cmds[0].rect.width == 3, "primitive should be clipped");
+
+	//	retained module is re-recorded once more of it becomes visible
+	Draw.retain(m, 1);
+	win->x = 50;
+	Sigui.render(ctx, NULL);
+	Sigui.frame_stats(ctx, &fs);
+	Assert.isTrue(fs.drawn == 1 && fs.retained == 0, "retained module should re-record when uncovered");
+	Sigui.render(ctx, NULL);
+	Sigui.frame_stats(ctx, &fs);
+	Assert.isTrue(fs.retained == 1, "retained module should then be kept");
+
+	Sigui.free_context(ctx);
+}
+
+/* draws are sorted by state and merged where z order allows */
+void test_draw_batching(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "draw batching");
+	reset_mocks();
+
+	render_target t = Render.new_target(RENDER_WINDOW, 100, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	for (int i = 0; i < 3; ++i) Sigui.add_module(ctx, "Opaque", test_dummy_renderer, NULL, Sigui.new_window(ctx, i * 30, 50, 20, 20));
+	render_stats rs;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.batches == 1 && mock_gl_draw_calls == 1, "opaque modules should merge into one draw");
+
+	//	translucent rect: non-overlapping opaque quads move ahead of it
+	window a = Sigui.new_window(ctx, 0, 0, 20, 20);
+	window b = Sigui.new_window(ctx, 30, 0, 20, 20);
+	Sigui.add_module(ctx, "Translucent", test_rect_renderer, NULL, a);
+	Sigui.add_module(ctx, "Behind", test_dummy_renderer, NULL, b);
+	rect_color = 0x80FF0000u;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "batches=%d changes=%ld avoided=%ld", rs.batches, (long)rs.state_changes, (long)rs.state_avoided);
+	Assert.isTrue(rs.batches == 2, "opaque quads should merge around a translucent one");
+
+	//	overlapping the translucent rect keeps z order
+	b->x = 5;
+	b->y = 5;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.batches == 3, "overlapping quads should not be reordered");
+
+	//	repeated frames: the filter drops redundant state
+	int calls = mock_gl_state_calls;
+	Sigui.damage(ctx, (ui_rect){ 0, 0, 100, 100 });
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "state calls=%d avoided=%d", mock_gl_state_calls - calls, mock_gl_state_avoided);
+	Assert.isTrue(mock_gl_state_avoided > 0 && (uint64_t)mock_gl_state_avoided == rs.state_avoided,
+					  "avoided state changes should be counted");
+	Assert.isTrue(mock_gl_index_uploads == 3, "unchanged batches should not be re-uploaded");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	rect_color = 0xFFFF0000u;
+	reset_mocks();
+}
+
+/* instanced GL core target matches the headless rasterizer (skipped without EGL) */
+void test_gl_core_offscreen(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "GL core offscreen");
+
+	render_target gpu = Render.new_target(RENDER_OFFSCREEN, 100, 100);
+	if (!gpu) {
+		flogf(stdout, "EGL surfaceless GL 3.3 unavailable: skipped");
+		return;
+	}
+	render_target cpu = Render.new_target(RENDER_HEADLESS, 100, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window win = Sigui.new_window(ctx, 10, 10, 80, 80);
+	Sigui.add_module(ctx, "Shapes", test_shape_renderer, NULL, win);
+	render_stats rs;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(cpu, ctx);
+	Render.frame(gpu, ctx);
+	Render.stats(gpu, &rs);
+	Assert.isTrue(rs.batches == 1, "one instanced draw per damage region");
+
+	//	exact (+-1) except where the rounded corners are anti-aliased
+	const uint32_t* a = Render.pixels(cpu);
+	const uint32_t* b = Render.pixels(gpu);
+	int mismatched = 0, corners = 0;
+	for (int i = 0; i < 100 * 100; ++i) {
+		for (int shift = 0; shift < 32; shift += 8) {
+			int d = (int)(a[i] >> shift & 0xFF) - (int)(b[i] >> shift & 0xFF);
+			if (d > 1 || d < -1) {
+				int x = i % 100, y = i / 100;
+				if (x >= 15 && x < 45 && y >= 50 && y < 80) corners++;
+				else mismatched++;
+				break;
+			}
+		}
+	}
+	flogf(stdout, "rect=%08x border=%08x inside=%08x corner=%08x mismatched=%d anti-aliased=%d",
+			b[20 * 100 + 20], b[16 * 100 + 41], b[25 * 100 + 55], b[51 * 100 + 16], mismatched, corners);
+	Assert.isTrue(b[20 * 100 + 20] == 0xFFFF0000u && b[16 * 100 + 41] == 0xFF00FF00u, "filled rect and border");
+	Assert.isTrue(b[25 * 100 + 55] == 0xFFFFFFFFu && b[51 * 100 + 16] == 0xFFFFFFFFu, "border inside and rounded corner keep the background");
+	Assert.isTrue(b[65 * 100 + 30] == 0xFF0000FFu, "rounded rect body");
+	Assert.isTrue(mismatched == 0 && corners < 80, "offscreen output should match the headless rasterizer");
+
+	//	partial frame through the next ring segment
+	Sigui.damage(ctx, (ui_rect){ 0, 0, 50, 50 });
+	Render.frame(gpu, ctx);
+	Render.stats(gpu, &rs);
+	Assert.isTrue(rs.regions == 1 && b[20 * 100 + 20] == 0xFFFF0000u, "partial frames should redraw from the ring");
+
+	Sigui.free_context(ctx);
+	Render.free_target(cpu);
+	Render.free_target(gpu);
+}
+
+/* glyphs are rasterized once into the atlas; cached modules do no lookups */
+void test_text_atlas(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "text atlas");
+
+	int w = 0, h = 0;
+	Font.measure(UI_FONT_DEFAULT, "Hi\nthere", &w, &h);
+	Assert.isTrue(w == 40 && h == 32, "built-in font is 8x16");
+	Assert.isTrue(Font.load("/nonexistent.ttf", 16) == -1, "missing font should fail to load");
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 64, 32);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Text", test_text_renderer, NULL, Sigui.new_window(ctx, 0, 0, 64, 32));
+	render_stats rs;
+
+	text_value = "Hi";
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	const uint32_t* px = Render.pixels(t);
+	int inked = 0, stray = 0;
+	for (int y = 0; y < 32; ++y) {
+		for (int x = 0; x < 64; ++x) {
+			int ink = px[y * 64 + x] == 0xFF000000u;
+			if (x >= 2 && x < 18 && y >= 2 && y < 18) inked += ink;
+			else stray += ink;
+		}
+	}
+	flogf(stdout, "lookups=%ld misses=%ld glyphs=%d inked=%d", (long)rs.glyph_lookups, (long)rs.glyph_misses, rs.glyphs, inked);
+	Assert.isTrue(rs.glyph_lookups == 2 && rs.glyph_misses == 2 && rs.glyphs == 2, "one lookup and raster per new glyph");
+	Assert.isTrue(inked > 10 && stray == 0, "glyphs should be drawn inside the text extent");
+
+	//	unchanged text redraws from cached vertices: no lookups
+	Sigui.damage(ctx, (ui_rect){ 0, 0, 64, 32 });
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.glyph_lookups == 2, "cached text should not look glyphs up");
+
+	text_value = "Hi!";
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.glyph_lookups == 5 && rs.glyph_misses == 3, "only the new glyph should be rasterized");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	text_value = "Hi";
+}
+
+/* a full atlas evicts the least recently drawn shelf; stale caches rebuild */
+void test_text_eviction(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "text atlas eviction");
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 40, 40);
+	render_target ref = Render.new_target(RENDER_HEADLESS, 40, 40);
+	Render.atlas_size(t, 24);			// two shelves of two capitals
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Fixed", test_fixed_text_renderer, NULL, Sigui.new_window(ctx, 0, 0, 40, 20));
+	Sigui.add_module(ctx, "Text", test_text_renderer, NULL, Sigui.new_window(ctx, 0, 20, 40, 20));
+	ui_module cover = Sigui.add_module(ctx, "Cover", test_dummy_renderer, NULL, Sigui.new_window(ctx, 0, 0, 40, 20));
+	cover->enabled = 0;
+	render_stats rs;
+
+	text_value = " ";
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.frame(ref, ctx);
+
+	//	"ABC" is covered (its cache is kept); "DEF" needs its shelves
+	cover->enabled = 1;
+	text_value = "DEF";
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.frame(ref, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "evictions=%ld glyphs=%d", (long)rs.atlas_evictions, rs.glyphs);
+	Assert.isTrue(rs.atlas_evictions >= 1, "a full atlas should evict");
+
+	//	uncovered: the cached "ABC" lost glyphs and must be rebuilt
+	cover->enabled = 0;
+	text_value = " ";
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.frame(ref, ctx);
+	Assert.isTrue(memcmp(Render.pixels(t), Render.pixels(ref), sizeof(uint32_t) * 40 * 40) == 0,
+					  "evicted glyphs should be re-rasterized");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	Render.free_target(ref);
+	text_value = "Hi";
+}
+
+/* 10k glyphs: one lookup each, one batched draw, dirty-rect atlas uploads */
+void test_text_batching(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "text batching");
+	reset_mocks();
+
+	static char screen[100 * 101 + 1];
+	for (int line = 0; line < 100; ++line) {
+		for (int col = 0; col < 100; ++col) screen[line * 101 + col] = 'A' + (line + col) % 26;
+		screen[line * 101 + 100] = '\n';
+	}
+	screen[100 * 101 - 1] = 0;
+	text_value = screen;
+
+	render_target t = Render.new_target(RENDER_WINDOW, 804, 1604);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Screen", test_text_renderer, NULL, Sigui.new_window(ctx, 0, 0, 804, 1604));
+	render_stats rs;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "lookups=%ld batches=%d draws=%d uploads=%d", (long)rs.glyph_lookups, rs.batches, mock_gl_draw_calls, mock_gl_texture_uploads);
+	Assert.isTrue(rs.glyph_lookups == 10000 && rs.glyphs == 26, "one lookup per glyph");
+	Assert.isTrue(rs.batches == 2 && mock_gl_draw_calls == 2, "background + one batched draw for all glyphs");
+	Assert.isTrue(mock_gl_texture_uploads == 1, "first upload sends the whole atlas");
+
+	//	a new glyph uploads only its sub-rectangle
+	screen[0] = '#';
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "uploads=%d bytes=%ld", mock_gl_texture_uploads, mock_gl_texture_bytes);
+	Assert.isTrue(mock_gl_texture_uploads == 2 && rs.glyphs == 27, "new glyph should be uploaded");
+	Assert.isTrue(mock_gl_texture_bytes - (long)512 * 512 <= 8 * 16, "only the dirty rect should be uploaded");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	text_value = "Hi";
+	reset_mocks();
+}
+
+/* layouts are memoized per (text, font, wrap); width changes rewrap cached glyphs */
+void test_text_layout(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "text layout cache");
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	text_stats ts;
+	int w = 0, h = 0;
+
+	Text.measure(ctx, UI_FONT_DEFAULT, "hello world foo", 0, &w, &h);
+	Assert.isTrue(w == 120 && h == 16, "unwrapped text is one line");
+	Text.measure(ctx, UI_FONT_DEFAULT, "hello world foo", 0, &w, &h);
+	Text.stats(ctx, &ts);
+	Assert.isTrue(ts.misses == 1 && ts.hits == 1 && ts.entries == 1, "second lookup should hit");
+
+	Text.measure(ctx, UI_FONT_DEFAULT, "hello world foo", 48, &w, &h);
+	Assert.isTrue(w == 40 && h == 48, "wrapped at every space");
+	Text.measure(ctx, UI_FONT_DEFAULT, "hello world foo", 100, &w, &h);
+	Assert.isTrue(w == 88 && h == 32, "wrapped after 'world'");
+	Text.measure(ctx, UI_FONT_DEFAULT, "averyveryverylongword", 40, &w, &h);
+	Assert.isTrue(w == 40 && h == 80, "a word wider than the wrap breaks between glyphs");
+	Text.measure(ctx, UI_FONT_DEFAULT, "trailing\n", 0, &w, &h);
+	Assert.isTrue(h == 32, "a trailing newline opens a line");
+	Text.stats(ctx, &ts);
+	Assert.isTrue(ts.misses == 3 && ts.rewraps == 2, "width changes should rewrap cached glyphs");
+
+	//	paragraphs whose breaks still hold are kept
+	const char* doc = "short line\nanother short one\na much longer paragraph that wraps at narrow widths";
+	text_layout a, b;
+	TextCache.layout(ctx, UI_FONT_DEFAULT, doc, -1, 1000, &a);
+	uint64_t reused = ts.lines_reused;
+	TextCache.layout(ctx, UI_FONT_DEFAULT, doc, -1, 200, &a);
+	Text.stats(ctx, &ts);
+	flogf(stdout, "lines=%d reused=%ld", a.line_count, (long)(ts.lines_reused - reused));
+	Assert.isTrue(ts.lines_reused - reused == 2 && a.line_count == 5, "unaffected lines should be reused");
+
+	//	rewrapped layouts equal layouts made from scratch
+	static const char words[] = "lorem ipsum dolor sit amet, consectetur adipiscing elit sed do\n"
+		"eiusmod tempor incididunt ut labore  et dolore magna aliqua ut enim ad minim veniam quis\n\n"
+		"nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat";
+	int same = 1;
+	for (int i = 0; i < 60 && same; ++i) {
+		int wrap = i < 30 ? 400 - i * 13 : 8 + (i - 30) * 13;
+		ui_context fresh = Sigui.new_context(NULL, NULL);
+		TextCache.layout(ctx, UI_FONT_DEFAULT, words, -1, wrap, &a);
+		TextCache.layout(fresh, UI_FONT_DEFAULT, words, -1, wrap, &b);
+		same = a.line_count == b.line_count && a.width == b.width;
+		for (int l = 0; same && l < a.line_count; ++l) {
+			same = a.lines[l].start == b.lines[l].start && a.lines[l].bytes == b.lines[l].bytes &&
+					 a.lines[l].width == b.lines[l].width;
+		}
+		if (!same) {
+			flogf(stdout, "wrap=%d lines=%d/%d", wrap, a.line_count, b.line_count);
+		}
+		Sigui.free_context(fresh);
+	}
+	Text.stats(ctx, &ts);
+	flogf(stdout, "rewraps=%ld reused=%ld", (long)ts.rewraps, (long)ts.lines_reused);
+	Assert.isTrue(same, "rewrapped layouts should match fresh layouts");
+
+	Sigui.free_context(ctx);
+}
+
+/* paragraphs record their visible lines; unused layouts are swept without steady allocations */
+void test_text_paragraph(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "text paragraphs");
+
+	ui_allocator tracking = Allocator.new_tracking(NULL);
+	ui_context ctx = Sigui.new_context(NULL, tracking);
+	ui_module m = Sigui.add_module(ctx, "Paragraph", test_paragraph_renderer, NULL, Sigui.new_window(ctx, 0, 0, 100, 40));
+	text_stats ts;
+	alloc_stats as;
+
+	//	"one two three four five six" at 64px: four lines, three of them cross the 40px window
+	text_value = "one two three four five six";
+	paragraph_wrap = 64;
+	Sigui.render(ctx, NULL);
+	Assert.isTrue(Draw.count(m) == 4 && m->draws.culled == 1, "only lines crossing the window are recorded");
+
+	for (int f = 0; f < 10; ++f) {
+		paragraph_wrap = 56 + f % 2 * 8;
+		Sigui.render(ctx, NULL);
+	}
+	Allocator.stats(tracking, ALLOC_TEXT, &as);
+	Text.stats(ctx, &ts);
+	flogf(stdout, "entries=%d hits=%ld frame_allocs=%zu", ts.entries, (long)ts.hits, as.frame_allocs);
+	Assert.isTrue(as.frame_allocs == 0 && ts.entries == 2, "steady frames should not allocate");
+
+	//	layouts nobody asks for are swept
+	Text.keep(ctx, 2);
+	text_value = "something else";
+	for (int f = 0; f < 6; ++f) Sigui.render(ctx, NULL);
+	Text.stats(ctx, &ts);
+	flogf(stdout, "entries=%d evictions=%ld bytes=%zu", ts.entries, (long)ts.evictions, ts.bytes);
+	Assert.isTrue(ts.evictions == 2 && ts.entries == 1, "unused layouts should be evicted");
+
+	Sigui.free_context(ctx);
+	Allocator.stats(tracking, ALLOC_TEXT, &as);
+	Assert.isTrue(as.live_bytes == 0, "cache storage should be released");
+	Allocator.free_tracking(tracking);
+	text_value = "Hi";
+	paragraph_wrap = 0;
+}
+
+/* identical shapes share one cached mesh; meshes are anti-aliased and clipped */
+void test_tessellation(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "shape tessellation");
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 200, 200);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Meshes", test_mesh_renderer, NULL, Sigui.new_window(ctx, 0, 0, 200, 200));
+	render_stats rs;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "meshes=%d hits=%ld misses=%ld", rs.meshes, (long)rs.mesh_hits, (long)rs.mesh_misses);
+	Assert.isTrue(rs.meshes == 2 && rs.mesh_misses == 2 && rs.mesh_hits == 63, "identical shapes should share a mesh");
+
+	//	body solid, square corner empty, curved edge anti-aliased
+	const uint32_t* px = Render.pixels(t);
+	uint32_t body = px[10 * 200 + 10], corner = px[0], edge = px[2 * 200 + 1];
+	flogf(stdout, "body=%08x corner=%08x edge=%08x", body, corner, edge);
+	Assert.isTrue(body == 0xFF0000FFu && corner == 0xFFFFFFFFu, "rounded rect body and corner");
+	Assert.isTrue(edge != 0xFF0000FFu && edge != 0xFFFFFFFFu, "curved edges should be anti-aliased");
+
+	//	the clipped rect (150,150 40x40 under a 160x160 clip) stops at the clip edge
+	Assert.isTrue(px[155 * 200 + 155] == 0xFF00FF00u && px[165 * 200 + 155] == 0xFFFFFFFFu &&
+					  px[155 * 200 + 165] == 0xFFFFFFFFu, "meshes should be clipped");
+
+	//	a frame with nothing new rebuilds nothing
+	Sigui.damage(ctx, (ui_rect){ 0, 0, 200, 200 });
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.mesh_misses == 2 && rs.mesh_hits == 63, "cached modules should not tessellate");
+
+	//	GL: the meshes merge into one blended batch over the opaque background
+	reset_mocks();
+	render_target gl = Render.new_target(RENDER_WINDOW, 200, 200);
+	Render.frame(gl, ctx);
+	Render.stats(gl, &rs);
+	flogf(stdout, "batches=%d draws=%d", rs.batches, mock_gl_draw_calls);
+	Assert.isTrue(rs.batches == 2 && mock_gl_draw_calls == 2, "meshes should batch");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	Render.free_target(gl);
+}
+
+/* lines and shadows are anti-aliased; the GL core target matches them (skipped without EGL) */
+void test_strokes(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "lines and shadows");
+
+	render_target cpu = Render.new_target(RENDER_HEADLESS, 100, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Strokes", test_stroke_renderer, NULL, Sigui.new_window(ctx, 0, 0, 100, 100));
+
+	Sigui.render(ctx, NULL);
+	Render.frame(cpu, ctx);
+	const uint32_t* a = Render.pixels(cpu);
+	//	hairline on a pixel row: exact; diagonal: partial coverage beside the segment
+	uint32_t row = a[10 * 100 + 50], above = a[9 * 100 + 50];
+	uint32_t diagonal = a[30 * 100 + 30], beside = a[30 * 100 + 31];
+	flogf(stdout, "row=%08x above=%08x diagonal=%08x beside=%08x", row, above, diagonal, beside);
+	Assert.isTrue(row == 0xFF000000u && above == 0xFFFFFFFFu, "axis-aligned hairlines should be crisp");
+	Assert.isTrue((diagonal & 0xFF) < 0x80 && (beside & 0xFF) > 0x20 && (beside & 0xFF) < 0xFF, "diagonal lines should be anti-aliased");
+
+	//	shadow: opaque core, half coverage at the caster edge, nothing past half the blur
+	uint32_t core = a[75 * 100 + 75], rim = a[75 * 100 + 60], past = a[75 * 100 + 53];
+	flogf(stdout, "core=%08x rim=%08x past=%08x", core, rim, past);
+	Assert.isTrue(core == 0xFF000000u && past == 0xFFFFFFFFu, "shadow core and falloff");
+	Assert.isTrue((rim & 0xFF) > 0x60 && (rim & 0xFF) < 0xA0, "the caster edge should be half covered");
+
+	render_target gpu = Render.new_target(RENDER_OFFSCREEN, 100, 100);
+	if (!gpu) {
+		flogf(stdout, "EGL surfaceless GL 3.3 unavailable: GL comparison skipped");
+	} else {
+		Render.frame(gpu, ctx);
+		const uint32_t* b = Render.pixels(gpu);
+		int worst = 0;
+		for (int i = 0; i < 100 * 100; ++i) {
+			for (int shift = 0; shift < 32; shift += 8) {
+				int d = (int)(a[i] >> shift & 0xFF) - (int)(b[i] >> shift & 0xFF);
+				if (d < 0) d = -d;
+				if (d > worst) worst = d;
+			}
+		}
+		flogf(stdout, "gl row=%08x core=%08x worst=%d", b[10 * 100 + 50], b[75 * 100 + 75], worst);
+		Assert.isTrue(b[10 * 100 + 50] == 0xFF000000u && b[75 * 100 + 75] == 0xFF000000u, "GL core lines and shadows");
+		Assert.isTrue(worst <= 0x30, "GL core coverage should stay close to the meshes");
+		Render.free_target(gpu);
+	}
+
+	Sigui.free_context(ctx);
+	Render.free_target(cpu);
+}
+
+/* PPM and QOI decode on workers; malformed data fails */
+void test_image_decode(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "image decoding");
+
+	//	2x2 QOI: RGBA red, RGB green, index (red), RGBA half-transparent blue
+	static const uint8_t qoi[] = {
+		'q', 'o', 'i', 'f', 0, 0, 0, 2, 0, 0, 0, 2, 4, 0,
+		0xFF, 255, 0, 0, 255,  0xFE, 0, 255, 0,  50,  0xFF, 0, 0, 255, 128,
+		0, 0, 0, 0, 0, 0, 0, 1
+	};
+	uint8_t ppm[64];
+	size_t ppm_size = make_ppm(ppm, 2, 2, 0xFF0000FFu);
+	ui_image a = Image.decode(qoi, sizeof(qoi));
+	ui_image b = Image.decode(ppm, ppm_size);
+	ui_image bad = Image.decode("P6\n2 2\n255\n", 11);
+	Assert.isTrue(a && b && bad && a != b, "images should get distinct handles");
+	Assert.isTrue(Image.wait(a) == 0 && Image.wait(b) == 0, "QOI and PPM should decode");
+	Assert.isTrue(Image.wait(bad) != 0 && Image.state(bad) == IMAGE_FAILED, "truncated data should fail");
+	int w = 0, h = 0;
+	Assert.isTrue(Image.size(a, &w, &h) == 0 && w == 2 && h == 2, "decoded size");
+
+	//	a file decodes like in-memory data
+	char path[] = "/tmp/sigui_imageXXXXXX";
+	int fd = mkstemp(path);
+	Assert.isTrue(fd >= 0 && write(fd, ppm, ppm_size) == (ssize_t)ppm_size, "temp file");
+	close(fd);
+	ui_image c = Image.load(path);
+	Assert.isTrue(Image.wait(c) == 0, "PPM files should decode");
+	unlink(path);
+	ui_image missing = Image.load("/nonexistent/sigui.ppm");
+	Assert.isTrue(Image.wait(missing) != 0, "missing files should fail");
+
+	//	scaled 10x: each source pixel covers a 10x10 block
+	render_target t = Render.new_target(RENDER_HEADLESS, 60, 40);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Image", test_image_renderer, NULL, Sigui.new_window(ctx, 0, 0, 60, 40));
+	image_values[0] = a;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	const uint32_t* px = Render.pixels(t);
+	uint32_t red = px[15 * 60 + 15], green = px[15 * 60 + 25], index = px[25 * 60 + 15], blue = px[25 * 60 + 25];
+	flogf(stdout, "red=%08x green=%08x index=%08x blue=%08x", red, green, index, blue);
+	Assert.isTrue(red == 0xFFFF0000u && green == 0xFF00FF00u && index == 0xFFFF0000u, "QOI pixels");
+	Assert.isTrue(blue == 0xFF7F7FFFu || blue == 0xFF8080FFu, "translucent pixels should blend over the window");
+
+	Image.free(a);
+	Assert.isTrue(Image.state(a) == IMAGE_NONE, "freed images should be gone");
+	Image.free(b);
+	Image.free(c);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+
+/* frees an image from another thread (the logic thread of a pipeline) */
+static void* free_image_thread(void* arg) {
+	Image.free(*(ui_image*)arg);
+	__atomic_store_n(&image_freed, 1, __ATOMIC_RELEASE);
+	return NULL;
+}
+/* pixels handed to a reader stay valid until it releases them, whoever frees the image */
+void test_image_pinning(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "image pinning");
+
+	//	decoded pixels outlive a free until the reader lets go
+	uint8_t ppm[64];
+	size_t ppm_size = make_ppm(ppm, 2, 2, 0xFF0000FFu);
+	ui_image a = Image.decode(ppm, ppm_size);
+	Assert.isTrue(Image.wait(a) == 0, "PPM should decode");
+	const uint32_t* px = Images.pixels(a, NULL, NULL, NULL);
+	uint32_t first = px ? px[0] : 0;
+	Image.free(a);
+	Assert.isTrue(Image.state(a) == IMAGE_NONE && !Images.pixels(a, NULL, NULL, NULL), "a freed image should hand out no pixels");
+	Assert.isTrue(px && px[0] == first && px[3] == first, "pinned pixels should survive the free");
+	Images.release(a);
+
+	//	wrapped pixels go back to their owner only once released
+	uint32_t owned[4] = { 1, 2, 3, 4 };
+	ui_image w = Images.wrap(owned, 2, 2, 1);
+	Assert.isTrue(Images.pixels(w, NULL, NULL, NULL) == owned, "wrapped pixels should not be copied");
+	image_freed = 0;
+	pthread_t thread;
+	pthread_create(&thread, NULL, free_image_thread, &w);
+	usleep(20000);
+	Assert.isTrue(!__atomic_load_n(&image_freed, __ATOMIC_ACQUIRE), "freeing wrapped pixels should wait for the reader");
+	Images.release(w);
+	pthread_join(thread, NULL);
+	Assert.isTrue(image_freed && Image.state(w) == IMAGE_NONE, "the free should finish after the release");
+}
+/* a placeholder shows until the image decodes; the module is then redrawn without its callback */
+void test_image_placeholder(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "image placeholder");
+
+	//	a FIFO keeps the decoder blocked until the test writes the image
+	char path[64];
+	snprintf(path, sizeof(path), "/tmp/sigui_fifo_%d.ppm", (int)getpid());
+	unlink(path);
+	Assert.isTrue(mkfifo(path, 0600) == 0, "fifo");
+	ui_image img = Image.load(path);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 40, 40);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "Image", test_image_renderer, NULL, Sigui.new_window(ctx, 0, 0, 40, 40));
+	image_values[0] = img;
+	render_stats rs;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(Image.state(img) == IMAGE_PENDING, "the decode should still be waiting");
+	Assert.isTrue(Render.pixels(t)[15 * 40 + 15] == 0xFF808080u && rs.image_misses == 1, "placeholder while decoding");
+
+	uint8_t ppm[64];
+	size_t size = make_ppm(ppm, 2, 2, 0xFF00FF00u);
+	int fd = open(path, O_WRONLY);
+	Assert.isTrue(fd >= 0 && write(fd, ppm, size) == (ssize_t)size, "fifo write");
+	close(fd);
+	Assert.isTrue(Image.wait(img) == 0, "image should decode");
+	unlink(path);
+
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "pixel=%08x hits=%ld misses=%ld frames=%ld", Render.pixels(t)[15 * 40 + 15], (long)rs.image_hits,
+			(long)rs.image_misses, (long)rs.frames);
+	Assert.isTrue(rs.frames == 2 && Render.pixels(t)[15 * 40 + 15] == 0xFF00FF00u, "decoded image should replace the placeholder");
+	Assert.isTrue(rs.image_hits == 1, "the rebuilt module should find the image");
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.skipped == 1, "nothing left to redraw");
+
+	Image.free(img);
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+
+/* window targets stream image rows within the upload budget and evict textures LRU */
+void test_image_streaming(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "image streaming");
+	reset_mocks();
+
+	static uint8_t ppm[64 * 64 * 3 + 32];
+	ui_image imgs[3];
+	for (int i = 0; i < 3; ++i) {
+		size_t size = make_ppm(ppm, 64, 64, 0xFF000000u | 0x40u << (i * 8));
+		imgs[i] = Image.decode(ppm, size);
+		Image.wait(imgs[i]);
+	}
+
+	render_target t = Render.new_target(RENDER_WINDOW, 60, 20);
+	Render.upload_budget(t, 4096);		// 16 rows of 64 pixels
+	Render.image_budget(t, 2 * 64 * 64 * 4);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_module mods[3];
+	for (int i = 0; i < 3; ++i) {
+		mods[i] = Sigui.add_module(ctx, "Image", test_image_renderer, NULL, Sigui.new_window(ctx, i * 20, 0, 20, 20));
+		mods[i]->enabled = i == 0;
+		image_values[i] = imgs[i];
+	}
+	render_stats rs;
+
+	//	first frame queues the texture; four more stream 16 rows each
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	for (int i = 0; i < 3; ++i) Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	Assert.isTrue(rs.image_hits == 0 && rs.image_upload_bytes == 3 * 4096, "rows should stream within the budget");
+	Render.frame(t, ctx);
+	Render.stats(t, &rs);
+	flogf(stdout, "uploaded=%ld resident=%ld hits=%ld misses=%ld stall=%ldns", (long)rs.image_upload_bytes,
+			(long)rs.image_bytes, (long)rs.image_hits, (long)rs.image_misses, (long)rs.image_stall_ns);
+	Assert.isTrue(rs.image_upload_bytes == 64 * 64 * 4 && rs.image_bytes == 64 * 64 * 4, "whole image resident");
+	Assert.isTrue(rs.image_hits == 1 && rs.image_misses == 1 && rs.frames == 2, "module redrawn once the image is resident");
+	Assert.isTrue(rs.image_stall_ns > 0, "upload time should be measured");
+
+	//	showing the images in turn keeps the two most recently drawn
+	Render.upload_budget(t, 1 << 20);
+	for (int i = 1; i < 3; ++i) {
+		mods[i - 1]->enabled = 0;
+		mods[i]->enabled = 1;
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+		Render.frame(t, ctx);
+	}
+	Render.stats(t, &rs);
+	flogf(stdout, "images=%d resident=%ld evictions=%ld hits=%ld textures=%d", rs.images, (long)rs.image_bytes,
+			(long)rs.image_evictions, (long)rs.image_hits, mock_gl_textures_live);
+	Assert.isTrue(rs.images == 2 && rs.image_bytes == 2 * 64 * 64 * 4 && rs.image_evictions == 1, "LRU image should be evicted");
+	Assert.isTrue(rs.image_hits == 3 && mock_gl_textures_live == 2, "shown images should be drawn from textures");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	Assert.isTrue(mock_gl_textures_live == 0, "textures should be released with the target");
+	for (int i = 0; i < 3; ++i) Image.free(imgs[i]);
+	reset_mocks();
+}
+
+/* pipelined frames present the same pixels as serial ones */
+void test_pipeline_frames(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "pipelined frames");
+	reset_mocks();
+
+	render_target ts = Render.new_target(RENDER_HEADLESS, 120, 80);
+	render_target tp = Render.new_target(RENDER_HEADLESS, 120, 80);
+	ui_context serial = Sigui.new_context(NULL, NULL);
+	ui_context piped = Sigui.new_context(NULL, NULL);
+	window ws[3], wp[3];
+	ui_module ms[3], mp[3];
+	ui_render renderers[3] = { test_rect_renderer, test_text_renderer, test_shape_renderer };
+	for (int i = 0; i < 3; ++i) {
+		ws[i] = Sigui.new_window(serial, 4 + i * 36, 10, 32, 40);
+		wp[i] = Sigui.new_window(piped, 4 + i * 36, 10, 32, 40);
+		ms[i] = Sigui.add_module(serial, "m", renderers[i], NULL, ws[i]);
+		mp[i] = Sigui.add_module(piped, "m", renderers[i], NULL, wp[i]);
+	}
+	ui_pipeline p = Pipeline.new(piped, tp, 2);
+	Assert.isTrue(p != NULL, "pipeline creation failed");
+
+	//	the rect changes color and the text module moves; the shapes stay put
+	int same = 1;
+	for (int f = 0; f < 40; ++f) {
+		rect_color = 0xFF000000u | (uint32_t)f * 0x030507u;
+		ws[1]->y = wp[1]->y = 10 + f % 20;
+		Sigui.render(serial, NULL);
+		Render.frame(ts, serial);
+		Pipeline.frame(p, NULL);
+		if (f % 7 == 6) {
+			Pipeline.flush(p);
+			if (memcmp(Render.pixels(ts), Render.pixels(tp), sizeof(uint32_t) * 120 * 80) != 0) same = 0;
+		}
+	}
+	Pipeline.flush(p);
+	Assert.isTrue(same && memcmp(Render.pixels(ts), Render.pixels(tp), sizeof(uint32_t) * 120 * 80) == 0, "pipelined frames should match serial ones");
+
+	pipeline_stats ps;
+	Pipeline.stats(p, &ps);
+	flogf(stdout, "frames=%llu presented=%llu copied=%llu shared=%llu stalls=%llu", (unsigned long long)ps.frames,
+			(unsigned long long)ps.presented, (unsigned long long)ps.copied, (unsigned long long)ps.shared, (unsigned long long)ps.stalls);
+	Assert.isTrue(ps.depth == 2 && ps.frames == 40 && ps.presented == 40, "every frame should be presented");
+	Assert.isTrue(ps.copied == 40 + 2 + 2 && ps.shared == 3 * 40 - ps.copied, "unchanged lists should not be copied again");
+	module_stats a, b;
+	Sigui.stats(ms[2], &a);
+	Sigui.stats(mp[2], &b);
+	Assert.isTrue(a.cache_hits == b.cache_hits && a.cache_misses == b.cache_misses, "cache statistics should come back to the live modules");
+	Assert.isTrue(piped->viewport.width == 120 && piped->viewport.height == 80, "the target size should become the viewport");
+
+	Pipeline.free(p);
+	Sigui.free_context(serial);
+	Sigui.free_context(piped);
+	Render.free_target(ts);
+	Render.free_target(tp);
+}
+void test_remote_stream(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "remote stream");
+	reset_mocks();
+
+	char address[64];
+	snprintf(address, sizeof(address), "unix:/tmp/sigui_test_%d.sock", (int)getpid());
+	render_target ts = Render.new_target(RENDER_HEADLESS, 120, 80);
+	render_target tv = Render.new_target(RENDER_HEADLESS, 120, 80);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	window w[3];
+	ui_render renderers[3] = { test_rect_renderer, test_text_renderer, test_shape_renderer };
+	for (int i = 0; i < 3; ++i) {
+		w[i] = Sigui.new_window(ctx, 4 + i * 36, 10, 32, 40);
+		Sigui.add_module(ctx, "m", renderers[i], NULL, w[i]);
+	}
+	ui_remote server = Remote.serve(ctx, address);
+	ui_remote viewer = Remote.connect(address, 120, 80);
+	Assert.isTrue(server && viewer, "server and viewer should connect over a unix socket");
+
+	//	the rect changes color, the text module moves and flips between two strings; the shapes stay put
+	int same = 1, applied = 0;
+	for (int f = 0; f < 40; ++f) {
+		rect_color = 0xFF000000u | (uint32_t)f * 0x030507u;
+		text_value = f % 2 ? "Ho" : "Hi";
+		w[1]->y = 10 + f % 20;
+		Sigui.render(ctx, NULL);
+		Remote.send(server);
+		Render.frame(ts, ctx);
+		applied += Remote.receive(viewer, 1000);
+		Render.frame(tv, Remote.context(viewer));
+		if (memcmp(Render.pixels(ts), Render.pixels(tv), sizeof(uint32_t) * 120 * 80) != 0) same = 0;
+	}
+	Assert.isTrue(applied == 40, "every frame should reach the viewer");
+	Assert.isTrue(same, "the replica should match the server frame by frame");
+
+	remote_stats st;
+	Remote.stats(server, &st);
+	flogf(stdout, "frames=%llu out=%llu raw=%llu modules=%llu commands=%llu kept=%llu strings=%llu", (unsigned long long)st.frames,
+			(unsigned long long)st.bytes_out, (unsigned long long)st.raw_bytes, (unsigned long long)st.modules,
+			(unsigned long long)st.commands, (unsigned long long)st.kept, (unsigned long long)st.strings);
+	Assert.isTrue(st.frames == 40 && st.strings == 2 && st.string_hits == 38, "a string should cross the wire once");
+	Assert.isTrue(st.modules == 3 + 2 * 39 && st.unchanged == 39, "only changed modules should be sent");
+	Assert.isTrue(st.bytes_out * 3 < st.raw_bytes, "the stream should be smaller than the draw lists");
+
+	//	an unchanged frame is a header; one changed color is one record
+	Sigui.render(ctx, NULL);
+	int idle = Remote.send(server);
+	rect_color = 0xFF123456u;
+	Sigui.render(ctx, NULL);
+	remote_stats before, after;
+	Remote.stats(server, &before);
+	int changed = Remote.send(server);
+	Remote.stats(server, &after);
+	flogf(stdout, "idle=%d changed=%d", idle, changed);
+	Assert.isTrue(idle > 0 && idle < 40, "an unchanged frame should be tiny");
+	Assert.isTrue(after.modules - before.modules == 1 && after.commands - before.commands == 1, "only the changed command should be sent");
+	Assert.isTrue(Remote.receive(viewer, 1000) == 2, "the viewer should apply both frames");
+
+	//	input goes back as deltas
+	ui_input in = { 0 };
+	in.mouse_x = 30;
+	in.mouse_y = 40;
+	in.keys['a'] = 1;
+	Assert.isTrue(Remote.send_input(viewer, &in) > 0 && Remote.send_input(viewer, &in) == 0, "unchanged input should not be sent");
+	ui_input got = { 0 };
+	int copied = 0;
+	for (int i = 0; i < 100 && !copied; ++i) copied = Remote.input(server, &got);
+	Assert.isTrue(copied && got.mouse_x == 30 && got.mouse_y == 40 && got.keys['a'] == 1, "the server should see the viewer input");
+	Assert.isTrue(Remote.input(server, &got) == 0, "input should be copied once per change");
+	Remote.stats(server, &st);
+	Assert.isTrue(st.acks >= 40 && st.latency_max_ns > 0, "acknowledgements should measure the round trip");
+
+	Remote.free(server);
+	Assert.isTrue(Remote.receive(viewer, 1000) == -1, "the viewer should see the server close");
+	text_value = "Hi";
+	Remote.free(viewer);
+	Sigui.free_context(ctx);
+	Render.free_target(ts);
+	Render.free_target(tv);
+}
+void test_remote_malformed(void) {
+	printf("\n");
+	fflush(stdout);
+	flogf(stdout, "remote malformed frame");
+	reset_mocks();
+
+	//	a hand-made server sends a record for module 0xFFFFFFFF (-1 as an int)
+	struct sockaddr_un sa = { .sun_family = AF_UNIX };
+	snprintf(sa.sun_path, sizeof(sa.sun_path), "/tmp/sigui_bad_%d.sock", (int)getpid());
+	unlink(sa.sun_path);
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	Assert.isTrue(bind(listener, (struct sockaddr*)&sa, sizeof(sa)) == 0 && listen(listener, 1) == 0, "test server should listen");
+	char address[128];
+	snprintf(address, sizeof(address), "unix:%s", sa.sun_path);
+	ui_remote viewer = Remote.connect(address, 64, 64);
+	int fd = accept(listener, NULL, NULL);
+	Assert.isTrue(viewer && fd >= 0, "viewer should connect");
+
+	uint8_t frame[] = { 1, 19, 0, 0, 0,						// MSG_FRAME, payload length
+							  1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,		// frame id, stamp, flags, modules
+							  0, 1,										// no strings, one record
+							  0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 2 };		// module index, REC_WINDOW
+	Assert.isTrue(write(fd, frame, sizeof(frame)) == (ssize_t)sizeof(frame), "test server should write");
+	Assert.isTrue(Remote.receive(viewer, 1000) == -1, "a record for a module that does not exist should drop the stream");
+	Assert.isTrue(List.count(Remote.context(viewer)->modules) == 0, "the replica should be left untouched");
+	Remote.free(viewer);
+	close(fd);
+
+	//	a header announcing a 4 GiB payload is refused before it is buffered
+	viewer = Remote.connect(address, 64, 64);
+	fd = accept(listener, NULL, NULL);
+	Assert.isTrue(viewer && fd >= 0, "viewer should reconnect");
+	uint8_t header[5] = { 1, 0xF0, 0xFF, 0xFF, 0xFF };
+	uint8_t filler[4096] = { 0 };
+	Assert.isTrue(write(fd, header, sizeof(header)) == (ssize_t)sizeof(header), "test server should write");
+	Assert.isTrue(write(fd, filler, sizeof(filler)) == (ssize_t)sizeof(filler), "test server should write");
+	Assert.isTrue(Remote.receive(viewer, 1000) == -1, "an oversized message should drop the stream");
+
+	Remote.free(viewer);
+	close(fd);
+	close(listener);
+	unlink(sa.sun_path);
+}
+static void test_mesh_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	for (int i = 0; i < 64; ++i) Draw.rounded(ctx, i % 8 * 18, i / 8 * 18, 16, 16, 6, 0xFF0000FFu);
+	Draw.push_clip(ctx, 0, 0, 160, 160);
+	Draw.rounded(ctx, 150, 150, 40, 40, 8, 0xFF00FF00u);
+	Draw.pop_clip(ctx);
+}
+static void test_stroke_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	Draw.line(ctx, 10, 10, 90, 10, 1, 0xFF000000u);
+	Draw.line(ctx, 10, 10, 50, 50, 2, 0xFF000000u);
+	Draw.shadow(ctx, 60, 60, 30, 30, 4, 8, 0xFF000000u);
+}
+static void test_image_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	Draw.image(ctx, 10, 10, 20, 20, image_values[m->win->x / 20], 0xFF808080u);
+}
+static void test_shape_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	Draw.rect(ctx, 5, 5, 20, 20, 0xFFFF0000u);
+	Draw.border(ctx, 30, 5, 30, 30, 3, 0, 0xFF00FF00u);
+	Draw.rounded(ctx, 5, 40, 30, 30, 10, 0xFF0000FFu);
+	Draw.text(ctx, 40, 45, UI_FONT_DEFAULT, "Ag", 0xFF000000u);
+}
+static void test_text_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	Draw.text(ctx, 2, 2, UI_FONT_DEFAULT, text_value, 0xFF000000u);
+}
+static void test_paragraph_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	Draw.paragraph(ctx, 0, 0, paragraph_wrap, UI_FONT_DEFAULT, text_value, 0xFF000000u);
+	Draw.rect(ctx, 0, 0, 4, 4, 0xFF0000FFu);
+}
+static void test_fixed_text_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	Draw.text(ctx, 2, 2, UI_FONT_DEFAULT, "ABC", 0xFF000000u);
+}
+static void test_clip_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	Draw.push_clip(ctx, 2, 2, 20, 20);
+	Draw.rect(ctx, 0, 0, 5, 5, 0xFFFF0000u);		// clipped to (2,2 3x3)
+	Draw.rect(ctx, 30, 30, 5, 5, 0xFFFF0000u);	// outside the pushed clip
+	Draw.pop_clip(ctx);
+	Draw.rect(ctx, 20, 0, 5, 5, 0xFFFF0000u);		// outside the viewport
+}
+static void test_tall_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	rect_calls++;
+	Draw.rect(ctx, 0, 60, 40, 20, rect_color);
+}
+static void test_rect_renderer(ui_context ctx, ui_module m, ui_input* input) {
+	rect_calls++;
+	Draw.rect(ctx, 2, 2, 10, 10, rect_color);
+}
 static void test_dummy_renderer(ui_context ctx, ui_module m, ui_input* input) {
 	// ... dummy renderer
 }
@@ -140,6 +1434,27 @@ static void reset_mocks(void) {
 	mock_gl_context_created = 0;
 	mock_gl_begin_called = 0;
 	mock_gl_end_called = 0;
+	mock_gl_buffer_uploads = 0;
+	mock_gl_draw_calls = 0;
+	mock_gl_fbo_binds = 0;
+	mock_gl_layers_live = 0;
+	mock_gl_index_uploads = 0;
+	mock_gl_state_calls = 0;
+	mock_gl_state_avoided = 0;
+	mock_gl_texture_uploads = 0;
+	mock_gl_texture_bytes = 0;
+	mock_gl_textures_live = 0;
+}
+/* writes a binary PPM of one color; returns its size */
+static size_t make_ppm(uint8_t* out, int w, int h, uint32_t argb) {
+	int n = sprintf((char*)out, "P6\n%d %d\n255\n", w, h);
+	for (int i = 0; i < w * h; ++i, n += 3) {
+		out[n] = argb >> 16;
+		out[n + 1] = argb >> 8;
+		out[n + 2] = argb;
+	}
+
+	return n;
 }
 
 // Register test cases
@@ -148,4 +1463,29 @@ __attribute__((constructor)) void init_sigtest_tests(void) {
 	register_test("render_engine_init", render_engine_init);
 	register_test("test_render_engine_cleanup", test_render_engine_cleanup);
 	register_test("test_render_module", test_render_module);
+	register_test("test_headless_target", test_headless_target);
+	register_test("test_damage_partial_redraw", test_damage_partial_redraw);
+	register_test("test_damage_merging", test_damage_merging);
+	register_test("test_draw_list_cache", test_draw_list_cache);
+	register_test("test_draw_list_upload", test_draw_list_upload);
+	register_test("test_layer_composite", test_layer_composite);
+	register_test("test_layer_budget", test_layer_budget);
+	register_test("test_cull_modules", test_cull_modules);
+	register_test("test_clip_stack", test_clip_stack);
+	register_test("test_draw_batching", test_draw_batching);
+	register_test("test_gl_core_offscreen", test_gl_core_offscreen);
+	register_test("test_text_atlas", test_text_atlas);
+	register_test("test_text_eviction", test_text_eviction);
+	register_test("test_text_batching", test_text_batching);
+	register_test("test_text_layout", test_text_layout);
+	register_test("test_text_paragraph", test_text_paragraph);
+	register_test("test_tessellation", test_tessellation);
+	register_test("test_strokes", test_strokes);
+	register_test("test_image_decode", test_image_decode);
+	register_test("test_image_placeholder", test_image_placeholder);
+	register_test("test_image_streaming", test_image_streaming);
+	register_test("test_image_pinning", test_image_pinning);
+	register_test("test_pipeline_frames", test_pipeline_frames);
+	register_test("test_remote_stream", test_remote_stream);
+	register_test("test_remote_malformed", test_remote_malformed);
 }
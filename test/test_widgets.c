@@ -0,0 +1,1047 @@
+// test_widgets.c
+#include "sigui.h"
+#include "../src/ui_core.h"
+#include "render.h"
+#include "sigui_widgets.h"
+#include "sigui_style.h"
+#include <sigtest.h>
+#include <sigcore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Assert.isTrue(condition, "fail message");
+// Assert.isFalse(condition, "fail message");
+// Assert.areEqual(obj1, obj2, INT, "fail message");
+// Assert.areEqual(obj1, obj2, PTR, "fail message");
+// Assert.areEqual(obj1, obj2, STRING, "fail message");
+
+#define BIG_ROWS 10000000
+
+static int text_calls;
+static int height_calls;
+static int cell_batches;
+static int batch_rows;
+
+//	row source callbacks
+static int row_text(object, int, char*, int);
+static int row_height(object, int);
+static void grid_cells(object, int, int, int, char*, int);
+static int grid_header(object, int, char*, int);
+//	image helpers
+static uint32_t gradient(int, int);
+static void write_gradient(const char*, int, int);
+//	widget state callbacks
+static void counter_render(ui_context, ui_module, ui_input*);
+static void idle_render(ui_context, ui_module, ui_input*);
+
+/* test info */
+void test_harness(void) {
+	printf("\n");
+	fflush(stdout);
+
+	time_t rawtime;
+	time(&rawtime);
+
+	struct tm* timeinfo;
+	timeinfo = localtime(&rawtime);
+
+	char date_str[20];
+	strftime(date_str, sizeof(date_str), "%b-%d-%Y [%H:%M]", timeinfo);
+
+	flogf(stdout, "Test Run Date=%s", date_str);
+}
+/* test the extent index against a linear walk */
+void test_extent_index(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	extent_index ei;
+	Extent.init(&ei, 5000, 10);
+	Assert.isTrue(Extent.total(&ei) == 50000 && !ei.sizes, "default sizes should need no storage");
+	Assert.isTrue(Extent.index(&ei, 12345) == 1234, "fixed sizes should divide");
+
+	int sizes[5000];
+	for (int i = 0; i < 5000; ++i) {
+		sizes[i] = i % 7 == 0 ? 10 : 1 + (i * 37) % 50;
+		if (i % 7) Extent.set(ctx, &ei, i, sizes[i]);
+	}
+	int64_t offset = 0;
+	int mismatched = 0;
+	for (int i = 0; i < 5000; ++i) {
+		if (Extent.offset(&ei, i) != offset) mismatched++;
+		if (Extent.index(&ei, offset) != i || Extent.index(&ei, offset + sizes[i] - 1) != i) mismatched++;
+		offset += sizes[i];
+	}
+	Assert.isTrue(mismatched == 0, "offsets and lookups should match a linear walk");
+	Assert.isTrue(Extent.total(&ei) == offset, "total should be the sum of the sizes");
+	Assert.isTrue(Extent.index(&ei, offset + 100) == 4999 && Extent.index(&ei, -5) == 0, "lookups should clamp");
+
+	//	shrinking keeps the leading sizes
+	Extent.resize(ctx, &ei, 100);
+	int64_t head = 0;
+	for (int i = 0; i < 100; ++i) head += sizes[i];
+	Assert.isTrue(Extent.total(&ei) == head, "resize should keep the leading sizes");
+	printf("measured=%d total=%lld\n", ei.measured, (long long)Extent.total(&ei));
+
+	Extent.release(ctx, &ei);
+	Sigui.free_context(ctx);
+}
+/* test that a list records only the window plus overscan and reuses rows */
+void test_list_window(void) {
+	printf("\n");
+	fflush(stdout);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 200, 200);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	listview_source src = { .text = row_text };
+	ui_listview l = ListView.new(ctx, "List", Sigui.new_window(ctx, 0, 0, 200, 200), &src, BIG_ROWS, 20);
+	Assert.isTrue(l != NULL && ListView.rows(l) == BIG_ROWS, "list creation failed");
+	listview_stats ls;
+	text_calls = 0;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	ListView.stats(l, &ls);
+	Assert.isTrue(ls.first == 0 && ls.last == 14, "top of the list should record 10 rows + 4 overscan");
+	Assert.isTrue(text_calls == 14 && ls.fetched == 14, "each recorded row should be fetched once");
+	const uint32_t* px = Render.pixels(t);
+	Assert.isTrue(px[30 * 200 + 100] != px[10 * 200 + 100], "odd rows should be striped");
+
+	//	deep in the list: overscan on both sides
+	ListView.scroll_to_row(l, 5000000);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	ListView.stats(l, &ls);
+	Assert.isTrue(ls.first == 4999996 && ls.drawn == 18, "middle of the list should record 10 rows + 2x4 overscan");
+	Assert.isTrue(ListView.row_at(l, 45) == 5000002, "hit test should find the row under y");
+
+	//	scrolling one row fetches one row
+	int before = text_calls;
+	ListView.scroll_by(l, 20);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	ListView.stats(l, &ls);
+	Assert.isTrue(text_calls - before == 1, "a one-row scroll should fetch one new row");
+	Assert.isTrue(ls.reused >= 17, "the other rows should come from the row cache");
+
+	//	the end clamps
+	ListView.scroll_to(l, ListView.height(l) + 1000);
+	Assert.isTrue(ListView.offset(l) == (int64_t)BIG_ROWS * 20 - 200, "offset should clamp to the last page");
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	ListView.stats(l, &ls);
+	Assert.isTrue(ls.last == BIG_ROWS && ls.first == BIG_ROWS - 14, "bottom of the list should record the last page + overscan");
+	printf("fetched=%llu reused=%llu\n", (unsigned long long)ls.fetched, (unsigned long long)ls.reused);
+
+	//	refresh drops cached rows
+	before = text_calls;
+	ListView.refresh(l, 100);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	ListView.stats(l, &ls);
+	Assert.isTrue(ListView.offset(l) == 100 * 20 - 200 && ls.last == 100, "refresh should clamp to the new row count");
+	Assert.isTrue(text_calls - before == ls.drawn, "refresh should fetch every row again");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* test lazily measured variable heights */
+void test_list_heights(void) {
+	printf("\n");
+	fflush(stdout);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 200, 200);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	listview_source src = { .text = row_text, .height = row_height };
+	ui_listview l = ListView.new(ctx, "List", Sigui.new_window(ctx, 0, 0, 200, 200), &src, BIG_ROWS, 20);
+	listview_stats ls;
+	height_calls = 0;
+
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	ListView.stats(l, &ls);
+	Assert.isTrue(ls.measured == height_calls && ls.measured == ls.drawn, "only recorded rows should be measured");
+
+	//	the top row stays put while rows above it are measured
+	ListView.scroll_to_row(l, 5000000);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	ListView.stats(l, &ls);
+	Assert.isTrue(ListView.row_at(l, 0) == 5000000, "measuring should keep the top row at the top");
+	Assert.isTrue(ListView.offset(l) == ListView.row_offset(l, 5000000), "the top row should start at the window edge");
+	Assert.isTrue(ls.measured < 64, "far rows should stay unmeasured");
+
+	int64_t y = 0;
+	int mismatched = 0;
+	for (int row = 5000000; row < 5000008; ++row) {
+		if (ListView.row_at(l, (int)y) != row) mismatched++;
+		y += row_height(NULL, row);
+	}
+	Assert.isTrue(mismatched == 0, "hit tests should follow the measured heights");
+
+	//	a changed row is measured again
+	int calls = height_calls;
+	ListView.update(l, 5000001);
+	Assert.isTrue(height_calls == calls + 1, "update should measure the row again");
+	printf("measured=%d height=%lld\n", ls.measured, (long long)ListView.height(l));
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* test that the per-frame work does not depend on the row count */
+void test_list_scale(void) {
+	printf("\n");
+	fflush(stdout);
+
+	int rows[2] = { 100, BIG_ROWS };
+	int fetched[2], drawn[2];
+	for (int k = 0; k < 2; ++k) {
+		render_target t = Render.new_target(RENDER_HEADLESS, 200, 400);
+		ui_context ctx = Sigui.new_context(NULL, NULL);
+		listview_source src = { .text = row_text, .height = row_height };
+		ui_listview l = ListView.new(ctx, "List", Sigui.new_window(ctx, 0, 0, 200, 400), &src, rows[k], 20);
+		listview_stats ls;
+		text_calls = 0;
+
+		ListView.scroll_to_row(l, rows[k] / 2 - 10);
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+		int start = text_calls;
+		for (int f = 0; f < 20; ++f) {
+			ListView.scroll_by(l, 3);
+			Sigui.render(ctx, NULL);
+			Render.frame(t, ctx);
+		}
+		ListView.stats(l, &ls);
+		fetched[k] = text_calls - start;
+		drawn[k] = ls.drawn;
+
+		Sigui.free_context(ctx);
+		Render.free_target(t);
+	}
+	printf("rows=%d fetched=%d drawn=%d | rows=%d fetched=%d drawn=%d\n",
+		rows[0], fetched[0], drawn[0], rows[1], fetched[1], drawn[1]);
+	Assert.isTrue(fetched[0] == fetched[1] && drawn[0] == drawn[1], "scrolling should do the same work at any row count");
+}
+
+/* test a grid: both axes virtualized, frozen header and columns, column tiles */
+void test_grid_window(void) {
+	printf("\n");
+	fflush(stdout);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 400, 300);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	gridview_source src = { .cells = grid_cells, .header = grid_header };
+	ui_gridview g = GridView.new(ctx, "Grid", Sigui.new_window(ctx, 0, 0, 400, 300), &src, BIG_ROWS / 2, 300, 20, 80);
+	Assert.isTrue(g != NULL, "grid creation failed");
+	gridview_stats gs;
+	cell_batches = 0;
+
+	//	top-left: 5 columns x 14 rows below a 20px header, one tile per column
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	GridView.stats(g, &gs);
+	Assert.isTrue(gs.first_row == 0 && gs.last_row == 14 && gs.first_column == 0 && gs.last_column == 5, "grid should show 5x14 cells");
+	Assert.isTrue(cell_batches == 5 && batch_rows == GRID_TILE_ROWS && gs.cells == 5 * GRID_TILE_ROWS, "cells should be fetched a column tile per call");
+	const uint32_t* px = Render.pixels(t);
+	Assert.isTrue(px[10 * 400 + 60] == UI_RGB(230, 230, 230), "header should be drawn");
+
+	//	deep scroll with a frozen first column
+	GridView.freeze(g, 1);
+	GridView.scroll_to(g, 150 * 80, (int64_t)1000000 * 20);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	GridView.stats(g, &gs);
+	int row, column;
+	Assert.isTrue(GridView.cell_at(g, 10, 25, &row, &column) == 0 && row == 1000000 && column == 0, "frozen column should stay in place");
+	Assert.isTrue(GridView.cell_at(g, 100, 45, &row, &column) == 0 && row == 1000001 && column == 151, "scrolled cells should hit test past the frozen column");
+	Assert.isTrue(GridView.cell_at(g, 100, 5, &row, &column) == 1 && row == -1 && column == 151, "header should stay at the top");
+	Assert.isTrue(gs.first_column == 151 && gs.first_row == 1000000, "scrolled columns should start past the frozen ones");
+
+	//	scrolling inside the tiles fetches nothing
+	int batches = cell_batches;
+	GridView.scroll_by(g, 0, 20);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	Assert.isTrue(cell_batches == batches, "scrolling within cached tiles should not fetch");
+
+	//	resizing re-fits only the resized column's tiles
+	uint64_t refits = gs.refits;
+	GridView.resize_column(g, 152, 120);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	GridView.stats(g, &gs);
+	Assert.isTrue(GridView.column_width(g, 152) == 120 && cell_batches == batches, "resize should not fetch");
+	Assert.isTrue(gs.refits - refits == GRID_TILE_ROWS + 1, "resize should re-fit one column tile and its title");
+	Assert.isTrue(GridView.cell_at(g, 285, 45, &row, &column) == 0 && column == 153, "later columns should shift by the resize");
+	printf("batches=%llu cells=%llu hits=%llu refits=%llu\n", (unsigned long long)gs.batches,
+		(unsigned long long)gs.cells, (unsigned long long)gs.hits, (unsigned long long)gs.refits);
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* test that a frame's tiles stay cached together however many are on screen */
+void test_grid_cache(void) {
+	printf("\n");
+	fflush(stdout);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 1600, 1200);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	gridview_source src = { .cells = grid_cells, .header = grid_header };
+	ui_gridview g = GridView.new(ctx, "Grid", Sigui.new_window(ctx, 0, 0, 1600, 1200), &src, BIG_ROWS / 2, 3000, 12, 24);
+	gridview_stats gs;
+
+	//	fill the cache with tiles from other places, then come back
+	for (int k = 0; k < 12; ++k) {
+		GridView.scroll_to(g, (int64_t)k * 37 * 24, (int64_t)k * 5000 * 12);
+		Sigui.render(ctx, NULL);
+		Render.frame(t, ctx);
+	}
+	GridView.scroll_to(g, 0, 0);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	GridView.stats(g, &gs);
+	uint64_t batches = gs.batches;
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	GridView.stats(g, &gs);
+	Assert.isTrue(gs.tiles > 200, "the view should need a few hundred tiles");
+	Assert.isTrue(gs.batches == batches, "a steady frame should draw every tile from the cache");
+	printf("tiles=%d batches=%llu hits=%llu\n", gs.tiles, (unsigned long long)gs.batches, (unsigned long long)gs.hits);
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* test selecting a cell and dragging a header edge */
+void test_grid_input(void) {
+	printf("\n");
+	fflush(stdout);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 400, 300);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	gridview_source src = { .cells = grid_cells, .header = grid_header };
+	ui_gridview g = GridView.new(ctx, "Grid", Sigui.new_window(ctx, 10, 10, 400, 300), &src, 1000, 50, 20, 80);
+	ui_input input = {0};
+	int row, column;
+
+	//	press and release on a cell
+	input.mouse_x = 10 + 170;
+	input.mouse_y = 10 + 65;
+	input.button = MOUSE_BUTTON_LEFT;
+	Sigui.render(ctx, &input);
+	input.button = 0;
+	Sigui.render(ctx, &input);
+	Render.frame(t, ctx);
+	Assert.isTrue(GridView.selected(g, &row, &column) == 0 && row == 2 && column == 2, "press should select the cell under the mouse");
+
+	//	drag the right edge of column 0 from 80 to 130
+	input.mouse_x = 10 + 79;
+	input.mouse_y = 10 + 5;
+	input.button = MOUSE_BUTTON_LEFT;
+	Sigui.render(ctx, &input);
+	input.mouse_x = 10 + 130;
+	Sigui.render(ctx, &input);
+	input.button = 0;
+	Sigui.render(ctx, &input);
+	input.mouse_x = 10 + 200;
+	Sigui.render(ctx, &input);
+	Assert.isTrue(GridView.column_width(g, 0) == 130, "dragging a header edge should resize the column");
+	Assert.isTrue(GridView.column_width(g, 1) == 80, "other columns should keep their width");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+
+/* test the min/max pyramid against a linear scan */
+void test_plot_pyramid(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_plotview p = PlotView.new(ctx, "Plot", Sigui.new_window(ctx, 0, 0, 200, 100));
+	int s = PlotView.add_series(p, UI_RGB(0, 0, 255));
+	Assert.isTrue(p != NULL && s == 0, "plot creation failed");
+
+	//	appended in uneven batches
+	int n = 1 << 20;
+	float* samples = malloc(sizeof(float) * n);
+	uint32_t seed = 12345;
+	for (int i = 0; i < n; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		samples[i] = (float)(seed >> 8) / (float)(1 << 24) - 0.5f + (i % 100000) * 0.0001f;
+	}
+	for (int done = 0; done < n; done += 777) PlotView.append(p, s, samples + done, n - done < 777 ? n - done : 777);
+	Assert.isTrue(PlotView.count(p, s) == n, "every sample should be appended");
+
+	int mismatched = 0;
+	for (int q = 0; q < 200; ++q) {
+		seed = seed * 1664525u + 1013904223u;
+		int first = (int)(seed % n);
+		seed = seed * 1664525u + 1013904223u;
+		int last = first + 1 + (int)(seed % (q < 100 ? 5000 : n - first));
+		if (last > n) last = n;
+		float mn = samples[first], mx = samples[first];
+		for (int i = first; i < last; ++i) {
+			if (samples[i] < mn) mn = samples[i];
+			if (samples[i] > mx) mx = samples[i];
+		}
+		float lo, hi;
+		if (PlotView.minmax(p, s, first, last, &lo, &hi) != 0 || lo != mn || hi != mx) mismatched++;
+	}
+	Assert.isTrue(mismatched == 0, "pyramid queries should match a linear scan");
+
+	plotview_stats ps;
+	PlotView.stats(p, &ps);
+	Assert.isTrue(ps.samples == n && ps.levels >= 4, "appending should build the pyramid");
+	printf("samples=%lld levels=%d bytes=%zu\n", (long long)ps.samples, ps.levels, ps.bytes);
+
+	free(samples);
+	Sigui.free_context(ctx);
+}
+/* test that NaN gaps are skipped the same way on every kernel path */
+void test_plot_gaps(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_plotview p = PlotView.new(ctx, "Plot", Sigui.new_window(ctx, 0, 0, 200, 100));
+	int s = PlotView.add_series(p, UI_RGB(0, 0, 255));
+
+	//	spikes one vector before a gap in the same lane, and gap runs
+	int n = 100000;
+	float* samples = malloc(sizeof(float) * n);
+	for (int i = 0; i < n; ++i) samples[i] = (i % 97 < 5) ? NAN : (float)(i % 13) - 6.0f;
+	samples[1001] = -100.0f;
+	samples[1009] = NAN;
+	samples[50002] = 100.0f;
+	samples[50010] = NAN;
+	PlotView.append(p, s, samples, n);
+
+	int mismatched = 0;
+	int64_t ranges[][2] = { { 0, n }, { 1000, 1020 }, { 996, 1012 }, { 50000, 50016 }, { 49990, 50100 }, { 0, 60000 }, { 1001, n } };
+	for (int q = 0; q < (int)(sizeof(ranges) / sizeof(ranges[0])); ++q) {
+		float mn = INFINITY, mx = -INFINITY;
+		for (int64_t i = ranges[q][0]; i < ranges[q][1]; ++i) {
+			if (samples[i] < mn) mn = samples[i];
+			if (samples[i] > mx) mx = samples[i];
+		}
+		float lo, hi;
+		if (PlotView.minmax(p, s, ranges[q][0], ranges[q][1], &lo, &hi) != 0 || lo != mn || hi != mx) mismatched++;
+	}
+	Assert.isTrue(mismatched == 0, "gaps should not hide the spikes before them");
+	float lo, hi;
+	PlotView.minmax(p, s, 0, n, &lo, &hi);
+	Assert.isTrue(lo == -100.0f && hi == 100.0f, "the whole series should span both spikes");
+
+	free(samples);
+	Sigui.free_context(ctx);
+}
+/* test per-column decimation, zooming and following */
+void test_plot_decimation(void) {
+	printf("\n");
+	fflush(stdout);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 200, 100);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_plotview p = PlotView.new(ctx, "Plot", Sigui.new_window(ctx, 0, 0, 200, 100));
+	int s = PlotView.add_series(p, UI_RGB(255, 0, 0));
+	plotview_stats ps;
+
+	//	a square wave: every column spans the full range
+	float block[4096];
+	for (int i = 0; i < 4096; ++i) block[i] = (i / 8) % 2 ? 1.0f : -1.0f;
+	for (int k = 0; k < 1024; ++k) PlotView.append(p, s, block, 4096);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	PlotView.stats(p, &ps);
+	const uint32_t* px = Render.pixels(t);
+	Assert.isTrue(ps.columns == 200 && px[2 * 200 + 100] == UI_RGB(255, 0, 0) && px[97 * 200 + 100] == UI_RGB(255, 0, 0), "columns should span min to max");
+	Assert.isTrue(ps.scanned < 200 * 2 * (2 * PLOT_FAN) * (ps.levels + 1), "decimation should read the pyramid, not the samples");
+	int64_t scanned = ps.scanned;
+
+	//	zoomed in: lines between samples
+	PlotView.view(p, 1000, 50);
+	PlotView.range(p, -2.0f, 2.0f);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	PlotView.stats(p, &ps);
+	Assert.isTrue(ps.columns == 0 && ps.scanned == 51, "a zoomed in view should draw its samples as lines");
+
+	//	following the tail
+	PlotView.follow(p, 100000);
+	PlotView.append(p, s, block, 4096);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	PlotView.stats(p, &ps);
+	Assert.isTrue(ps.columns == 200 && ps.samples == 1025 * 4096, "follow should show the latest samples");
+	printf("scanned=%lld (full view) %lld (tail) levels=%d\n", (long long)scanned, (long long)ps.scanned, ps.levels);
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+}
+/* test opening a mapped file: nothing is copied, lines are indexed on demand */
+void test_edit_open(void) {
+	printf("\n");
+	fflush(stdout);
+
+	const char* path = "/tmp/sigui_test_edit.txt";
+	FILE* f = fopen(path, "wb");
+	int64_t size = 0, starts[4000];
+	for (int i = 0; i < 4000; ++i) {
+		starts[i] = size;
+		size += fprintf(f, "line %d %.*s\n", i, i % 50, "..................................................");
+	}
+	fclose(f);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_textedit ed = TextEdit.new(ctx, "Editor", Sigui.new_window(ctx, 0, 0, 300, 200));
+	Assert.isTrue(TextEdit.open(ed, path) == 0, "the file should open");
+	textedit_stats es;
+	TextEdit.stats(ed, &es);
+	Assert.isTrue(es.mapped == size && es.added == 0 && es.indexed == 0, "opening should map the file without reading it");
+	Assert.isTrue(es.pieces == (size + EDIT_PIECE_MAX - 1) / EDIT_PIECE_MAX, "the original should be split into pieces");
+
+	Assert.isTrue(TextEdit.line_start(ed, 10) == starts[10], "an early line should need only its pieces");
+	TextEdit.stats(ed, &es);
+	Assert.isTrue(es.indexed < size, "lookups should index lazily");
+	int wrong = 0;
+	for (int i = 0; i < 4000; i += 7) wrong += TextEdit.line_start(ed, i) != starts[i] || TextEdit.line_of(ed, starts[i] + 3) != i;
+	Assert.isTrue(wrong == 0, "line starts should match the file");
+	Assert.isTrue(TextEdit.lines(ed) == 4001 && TextEdit.line_start(ed, 4001) == -1, "the line count should include the last (empty) line");
+
+	char buf[16];
+	Assert.isTrue(TextEdit.read(ed, starts[1234], buf, 9) == 9 && !memcmp(buf, "line 1234", 9), "reads should come from the mapping");
+
+	Sigui.free_context(ctx);
+	remove(path);
+}
+/* test random edits against a flat reference buffer */
+void test_edit_pieces(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_textedit ed = TextEdit.new(ctx, "Editor", Sigui.new_window(ctx, 0, 0, 300, 200));
+	int capacity = 1 << 20, length = 0;
+	char* ref = malloc(capacity);
+	char* out = malloc(capacity);
+	char text[300];
+	uint32_t seed = 777;
+
+	int mismatched = 0;
+	for (int op = 0; op < 3000; ++op) {
+		seed = seed * 1664525u + 1013904223u;
+		int offset = length ? (int)((seed >> 8) % (length + 1)) : 0;
+		seed = seed * 1664525u + 1013904223u;
+		int n = 1 + (int)((seed >> 8) % 200);
+		if (op % 3 == 2 && length) {
+			if (n > length - offset) n = length - offset;
+			TextEdit.erase(ed, offset, n);
+			memmove(ref + offset, ref + offset + n, length - offset - n);
+			length -= n;
+		} else {
+			for (int i = 0; i < n; ++i) text[i] = (i + op) % 17 ? 'a' + (i + op) % 26 : '\n';
+			TextEdit.insert(ed, offset, text, n);
+			memmove(ref + offset + n, ref + offset, length - offset);
+			memcpy(ref + offset, text, n);
+			length += n;
+		}
+		if (op % 100 == 0) {
+			mismatched += TextEdit.length(ed) != length || TextEdit.read(ed, 0, out, capacity) != length || memcmp(out, ref, length);
+			int64_t line = 0, start = 0;
+			for (int i = 0; i < length; ++i) {
+				if (ref[i] == '\n') {
+					line++;
+					start = i + 1;
+					if (line % 13 == 0) mismatched += TextEdit.line_start(ed, line) != start || TextEdit.line_of(ed, i) != line - 1;
+				}
+			}
+			mismatched += TextEdit.lines(ed) != line + 1;
+		}
+	}
+	Assert.isTrue(mismatched == 0, "edits should match the reference buffer");
+
+	textedit_stats es;
+	TextEdit.stats(ed, &es);
+	Assert.isTrue(es.length == length && es.pieces < 3000, "pieces should stay bounded by the edits");
+	printf("length=%lld pieces=%d added=%lld\n", (long long)es.length, es.pieces, (long long)es.added);
+
+	free(ref);
+	free(out);
+	Sigui.free_context(ctx);
+}
+/* test typing, visible-line rendering and saving */
+void test_edit_input(void) {
+	printf("\n");
+	fflush(stdout);
+
+	render_target t = Render.new_target(RENDER_HEADLESS, 320, 240);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_textedit ed = TextEdit.new(ctx, "Editor", Sigui.new_window(ctx, 0, 0, 300, 200));
+	char text[8192];
+	int n = 0;
+	for (int i = 0; i < 500; ++i) n += snprintf(text + n, sizeof(text) - n, "%d\n", i);
+	TextEdit.load(ed, text, n);
+
+	TextEdit.caret(ed, TextEdit.line_start(ed, 2));
+	ui_input input = {0};
+	const char* typed = "ab\bc\r";
+	for (const char* c = typed; *c; ++c) {
+		input.keys[(uint8_t)*c] = 1;
+		Sigui.render(ctx, &input);
+		input.keys[(uint8_t)*c] = 0;
+		Sigui.render(ctx, &input);
+	}
+	char buf[16];
+	int64_t got = TextEdit.read(ed, TextEdit.line_start(ed, 2), buf, 5);
+	Assert.isTrue(got == 5 && !memcmp(buf, "ac\n2\n", 5), "keys should edit at the caret");
+	Assert.isTrue(TextEdit.position(ed) == TextEdit.line_start(ed, 3), "the caret should follow typing");
+
+	TextEdit.scroll_to_line(ed, 300);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	textedit_stats es;
+	TextEdit.stats(ed, &es);
+	int rows = 200 / Font.height(UI_FONT_DEFAULT) + 1;
+	Assert.isTrue(es.drawn == rows, "only the visible lines should be laid out");
+
+	//	a press moves the caret to the line under it
+	int lh = Font.height(UI_FONT_DEFAULT);
+	input.mouse_x = 1;
+	input.mouse_y = 2 * lh + 1;
+	input.button = MOUSE_BUTTON_LEFT;
+	Sigui.render(ctx, &input);
+	input.button = 0;
+	Sigui.render(ctx, &input);
+	Assert.isTrue(TextEdit.position(ed) == TextEdit.line_start(ed, 302), "a press should place the caret");
+
+	const char* path = "/tmp/sigui_test_edit_save.txt";
+	Assert.isTrue(TextEdit.save(ed, path) == 0, "the document should save");
+	ui_textedit copy = TextEdit.new(ctx, "Copy", Sigui.new_window(ctx, 0, 0, 100, 100));
+	TextEdit.open(copy, path);
+	char a[8192], b[8192];
+	Assert.isTrue(TextEdit.length(copy) == TextEdit.length(ed) && TextEdit.read(copy, 0, a, sizeof(a)) == TextEdit.read(ed, 0, b, sizeof(b)) &&
+						  !memcmp(a, b, TextEdit.length(ed)), "a saved document should reopen unchanged");
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	remove(path);
+}
+/* test converting a PPM into a tiled pyramid */
+void test_tile_convert(void) {
+	printf("\n");
+	fflush(stdout);
+
+	const char* ppm = "/tmp/sigui_test_tiles.ppm";
+	const char* path = "/tmp/sigui_test_tiles.sgt";
+	write_gradient(ppm, 1000, 600);
+	Assert.isTrue(TileView.convert(ppm, path, 64) == 0, "the PPM should convert");
+	Assert.isTrue(TileView.convert(path, "/tmp/sigui_test_tiles.bad", 64) != 0 && TileView.convert(ppm, path, 100) != 0,
+					  "bad sources and tile sides should be refused");
+
+	FILE* f = fopen(path, "rb");
+	tiled_header hd;
+	Assert.isTrue(f && fread(&hd, sizeof(hd), 1, f) == 1, "the header should be readable");
+	Assert.isTrue(!memcmp(hd.magic, "SGTILES1", 8) && hd.width == 1000 && hd.height == 600 && hd.tile == 64 && hd.levels == 5,
+					  "levels should halve down to one tile");
+
+	//	level 0 matches the source; level 1 averages 2x2 blocks
+	uint32_t px[2];
+	fseek(f, hd.offset[0] + ((2 * 16 + 3) * 64 * 64 + 5 * 64 + 7) * 4, SEEK_SET);
+	Assert.isTrue(fread(px, 4, 1, f) == 1 && px[0] == gradient(3 * 64 + 7, 2 * 64 + 5), "level 0 pixels should match the source");
+	uint32_t x = 100, y = 30, expect = 0xFF000000u;
+	for (int shift = 16; shift >= 0; shift -= 8) {
+		uint32_t sum = 0;
+		for (int i = 0; i < 4; ++i) sum += gradient(2 * x + i % 2, 2 * y + i / 2) >> shift & 0xFF;
+		expect |= (sum + 2) / 4 << shift;
+	}
+	fseek(f, hd.offset[1] + ((0 * 8 + 1) * 64 * 64 + 30 * 64 + 36) * 4, SEEK_SET);
+	Assert.isTrue(fread(px, 4, 1, f) == 1 && px[0] == expect, "level 1 should average the level below");
+	fseek(f, hd.offset[1] + ((4 * 8 + 7) * 64 * 64 + 63 * 64 + 63) * 4, SEEK_SET);
+	Assert.isTrue(fread(px, 4, 1, f) == 1 && px[0] == 0, "pixels past the edge should be zero");
+	fclose(f);
+
+	remove(ppm);
+}
+/* test paging tiles in, drawing them from the cache and the cache cap */
+void test_tile_view(void) {
+	printf("\n");
+	fflush(stdout);
+
+	const char* path = "/tmp/sigui_test_tiles.sgt";
+	render_target t = Render.new_target(RENDER_HEADLESS, 200, 150);
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_tileview v = TileView.new(ctx, "Viewer", Sigui.new_window(ctx, 0, 0, 200, 150));
+	Assert.isTrue(TileView.open(v, path) == 0, "the tiled file should open");
+	tileview_stats ts;
+
+	//	fitted: 0.2 window pixels per image pixel draws level 2
+	Sigui.render(ctx, NULL);
+	TileView.stats(v, &ts);
+	Assert.isTrue(ts.level == 2 && ts.visible == 12 && ts.drawn == 0 && ts.queued > 0, "cold tiles should be queued, not drawn");
+	TileView.wait(v);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	TileView.stats(v, &ts);
+	Assert.isTrue(ts.drawn == ts.visible && ts.loaded >= 12, "paged in tiles should be drawn");
+	uint32_t c = Render.pixels(t)[75 * 200 + 100], g = gradient(500, 300);
+	int close = 1;
+	for (int shift = 0; shift < 24; shift += 8) close &= abs((int)(c >> shift & 0xFF) - (int)(g >> shift & 0xFF)) < 8;
+	Assert.isTrue(close, "the window center should show the image center");
+
+	//	zoomed in: level 0 tiles fall back to cached coarser tiles until paged in
+	TileView.zoom(v, 5.0, 100, 75);
+	Sigui.render(ctx, NULL);
+	TileView.stats(v, &ts);
+	Assert.isTrue(ts.level == 0 && ts.fallback == ts.visible && TileView.scale(v) == 1.0, "zooming should switch levels");
+	TileView.wait(v);
+	Sigui.render(ctx, NULL);
+	TileView.stats(v, &ts);
+	Assert.isTrue(ts.drawn == ts.visible, "the finer tiles should replace the fallback");
+
+	//	dragging pans by window pixels
+	ui_input input = {0};
+	input.mouse_x = 100;
+	input.mouse_y = 75;
+	input.button = MOUSE_BUTTON_LEFT;
+	Sigui.render(ctx, &input);
+	input.mouse_x = 60;
+	Sigui.render(ctx, &input);
+	input.button = 0;
+	Sigui.render(ctx, &input);
+	TileView.wait(v);
+	Sigui.render(ctx, NULL);
+	Render.frame(t, ctx);
+	c = Render.pixels(t)[75 * 200 + 100];
+	g = gradient(540, 300);
+	close = 1;
+	for (int shift = 0; shift < 24; shift += 8) close &= abs((int)(c >> shift & 0xFF) - (int)(g >> shift & 0xFF)) < 4;
+	Assert.isTrue(close && TileView.scale(v) == 1.0, "dragging should pan the image under the mouse");
+
+	//	a small cap evicts tiles the frame did not draw
+	TileView.cache(v, 4 * 64 * 64 * 4);
+	for (int i = 0; i < 4; ++i) {
+		TileView.pan(v, -90, i % 2 ? 100 : -100);
+		Sigui.render(ctx, NULL);
+		TileView.wait(v);
+		Sigui.render(ctx, NULL);
+	}
+	TileView.stats(v, &ts);
+	Assert.isTrue(ts.visible > 0 && ts.evicted > 0 && ts.resident <= ts.visible + 4, "the cap should bound the cache");
+	printf("level=%d visible=%d resident=%d loaded=%llu evicted=%llu\n", ts.level, ts.visible, ts.resident,
+			 (unsigned long long)ts.loaded, (unsigned long long)ts.evicted);
+
+	//	churning tiles through the capped cache reuses the image slots of evicted ones
+	int slots = Images.slots();
+	uint64_t loaded = ts.loaded;
+	for (int i = 0; i < 16; ++i) {
+		TileView.pan(v, i % 2 ? 150 : -150, i % 4 < 2 ? 100 : -100);
+		Sigui.render(ctx, NULL);
+		TileView.wait(v);
+		Sigui.render(ctx, NULL);
+	}
+	TileView.stats(v, &ts);
+	Assert.isTrue(ts.loaded - loaded > 16, "panning back and forth should keep paging tiles in");
+	Assert.isTrue(Images.slots() <= slots, "evicted tiles should give their image slots back");
+	printf("loaded=%llu slots=%d\n", (unsigned long long)(ts.loaded - loaded), Images.slots());
+
+	Sigui.free_context(ctx);
+	Render.free_target(t);
+	remove(path);
+}
+
+/* test that headers whose extents overflow are refused */
+void test_tile_crafted(void) {
+	printf("\n");
+	fflush(stdout);
+
+	const char* path = "/tmp/sigui_test_crafted.sgt";
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	ui_tileview v = TileView.new(ctx, "Viewer", Sigui.new_window(ctx, 0, 0, 200, 150));
+	tiled_header headers[3] = {
+		{ "SGTILES1", 0xFFFFFFFFu, 0xFFFFFFFFu, 4096, 1, { 4096 } },					// 2^20 x 2^20 tiles of 2^26 bytes wrap to 0
+		{ "SGTILES1", 64, 64, 64, 1, { 0xFFFFFFFFFFFFF000ull } },						// offset + tile bytes wraps
+		{ "SGTILES1", 64, 64, 64, 1, { 4096 } }											// fits
+	};
+	for (int i = 0; i < 3; ++i) {
+		uint8_t file[4096 + 64 * 64 * 4] = { 0 };
+		memcpy(file, &headers[i], sizeof(tiled_header));
+		FILE* f = fopen(path, "wb");
+		Assert.isTrue(f && fwrite(file, sizeof(file), 1, f) == 1 && fclose(f) == 0, "the file should be written");
+		Assert.isTrue(TileView.open(v, path) == (i == 2 ? 0 : -1), i == 2 ? "a valid header should open" : "an overflowing extent should be refused");
+	}
+
+	Sigui.free_context(ctx);
+	remove(path);
+}
+/* test id scoping and state that lasts across frames */
+static void test_state_persist(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	Sigui.add_module(ctx, "left", counter_render, NULL, Sigui.new_window(ctx, 0, 0, 10, 10));
+	Sigui.add_module(ctx, "right", counter_render, NULL, Sigui.new_window(ctx, 10, 0, 10, 10));
+	for (int f = 0; f < 5; ++f) Sigui.render(ctx, NULL);
+
+	//	each module counted its own "scroll" and the nested "item" of its rows
+	state_stats ss;
+	WidgetState.stats(ctx, &ss);
+	Assert.isTrue(ss.live == 2 * 4 && ss.created == 2 * 4, "each module should own its blobs");
+	ui_id outside = WidgetState.id(ctx, "scroll");
+	Assert.isTrue(WidgetState.find(ctx, outside) == NULL, "ids outside a module should not collide with module ids");
+
+	//	push/pop scope ids; a blob keeps its address
+	int created;
+	WidgetState.push(ctx, WidgetState.id(ctx, "panel"));
+	ui_id open = WidgetState.id(ctx, "open");
+	int* flag = WidgetState.get(ctx, open, &created);
+	Assert.isTrue(flag && created && *flag == 0, "a new blob should be zeroed");
+	*flag = 7;
+	WidgetState.pop(ctx);
+	Assert.isTrue(WidgetState.id(ctx, "open") != open, "the scope should be part of the id");
+	for (int i = 0; i < 1000; ++i) WidgetState.get(ctx, WidgetState.id_data(ctx, &i, sizeof(i)), NULL);
+	Assert.isTrue(WidgetState.get(ctx, open, &created) == flag && !created && *flag == 7, "a blob should stay put while the table grows");
+
+	WidgetState.forget(ctx, open);
+	Assert.isTrue(WidgetState.find(ctx, open) == NULL, "forget should drop the blob");
+	for (int i = 0; i < 1000; ++i) Assert.isTrue(WidgetState.find(ctx, WidgetState.id_data(ctx, &i, sizeof(i))) != NULL, "removal should not lose other ids");
+
+	Sigui.free_context(ctx);
+}
+/* test incremental collection and allocation-free steady state */
+static void test_state_collect(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_allocator tracking = Allocator.new_tracking(NULL);
+	ui_context ctx = Sigui.new_context(NULL, tracking);
+	Sigui.add_module(ctx, "idle", idle_render, NULL, Sigui.new_window(ctx, 0, 0, 10, 10));
+	WidgetState.keep(ctx, 10);
+	enum { IDS = 4000 };
+	for (int i = 0; i < IDS; ++i) *(int*)WidgetState.get(ctx, WidgetState.id_data(ctx, &i, sizeof(i)), NULL) = i;
+
+	//	touch half the ids every frame; the sweep drops the rest a bounded amount at a time
+	state_stats ss;
+	alloc_stats as;
+	uint64_t collected = 0;
+	int bounded = 1;
+	size_t allocs = 0;
+	for (int f = 0; f < 400; ++f) {
+		for (int i = 0; i < IDS; i += 2) {
+			int* v = WidgetState.get(ctx, WidgetState.id_data(ctx, &i, sizeof(i)), NULL);
+			if (*v != i) bounded = 0;
+		}
+		Sigui.render(ctx, NULL);
+		WidgetState.stats(ctx, &ss);
+		if (ss.collected - collected > STATE_SWEEP_SLOTS) bounded = 0;
+		collected = ss.collected;
+		if (f == 200) {
+			Allocator.stats(tracking, ALLOC_STATE, &as);
+			allocs = as.allocs;
+		}
+	}
+	Allocator.stats(tracking, ALLOC_STATE, &as);
+	Assert.isTrue(bounded, "touched blobs should survive and the sweep should stay bounded");
+	Assert.isTrue(ss.live == IDS / 2 && ss.collected == IDS / 2, "every untouched blob should be collected");
+	Assert.isTrue(as.allocs == allocs, "steady frames should not allocate");
+	Assert.isTrue(ss.probes < ss.lookups * 2, "lookups should take about one probe");
+	printf("live=%d slots=%d slabs=%d probes/lookup=%.2f\n", ss.live, ss.slots, ss.slabs, (double)ss.probes / ss.lookups);
+
+	//	dropped blobs are reused
+	for (int i = IDS; i < IDS + IDS / 2; ++i) WidgetState.get(ctx, WidgetState.id_data(ctx, &i, sizeof(i)), NULL);
+	WidgetState.stats(ctx, &ss);
+	Assert.isTrue(ss.live == IDS && ss.slabs == IDS / STATE_SLAB_BLOBS + (IDS % STATE_SLAB_BLOBS != 0), "freed blobs should be reused");
+
+	Sigui.free_context(ctx);
+	Allocator.stats(tracking, ALLOC_TAG_COUNT, &as);
+	Assert.isTrue(as.live_bytes == 0, "the store should be freed with the context");
+	Allocator.free_tracking(tracking);
+}
+
+/* test the cascade: inheritance, state specificity and overrides */
+static void test_style_resolve(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_context ctx = Sigui.new_context(NULL, NULL);
+	int button = Theme.add_class(ctx, "button", 0);
+	int danger = Theme.add_class(ctx, "danger", button);
+	Assert.isTrue(button > 0 && danger > button && Theme.add_class(ctx, "button", 0) == button, "class names should be interned");
+
+	Theme.rule(ctx, 0, 0, &(style_rule){ STYLE_BORDER | STYLE_PADDING, { .border = 1, .padding = { 4, 2, 4, 2 } } });
+	Theme.rule(ctx, button, 0, &(style_rule){ STYLE_BACKGROUND, { .background = UI_RGB(0x30, 0x30, 0x30) } });
+	Theme.rule(ctx, button, STYLE_STATE_HOVER, &(style_rule){ STYLE_BACKGROUND, { .background = UI_RGB(0x40, 0x40, 0x40) } });
+	Theme.rule(ctx, danger, 0, &(style_rule){ STYLE_TEXT, { .text = UI_RGB(0xFF, 0x40, 0x40) } });
+	//	a stateless rule of a derived class does not beat a hover rule of its base
+	Theme.rule(ctx, danger, 0, &(style_rule){ STYLE_BACKGROUND, { .background = UI_RGB(0x50, 0, 0) } });
+	Theme.rule(ctx, 0, STYLE_STATE_HOVER | STYLE_STATE_PRESSED, &(style_rule){ STYLE_BORDER, { .border = 3 } });
+
+	const ui_style* plain = Theme.resolve(ctx, button, 0, NULL);
+	Assert.isTrue(plain->background == UI_RGB(0x30, 0x30, 0x30) && plain->border == 1 && plain->padding[1] == 2, "global and class rules should apply");
+	Assert.isTrue(plain->text == UI_RGB(0xE0, 0xE0, 0xE0) && plain->font == UI_FONT_DEFAULT, "unset properties should come from the defaults");
+	const ui_style* red = Theme.resolve(ctx, danger, 0, NULL);
+	Assert.isTrue(red->text == UI_RGB(0xFF, 0x40, 0x40) && red->background == UI_RGB(0x50, 0, 0) && red->border == 1, "a derived class should apply over its base");
+	const ui_style* hover = Theme.resolve(ctx, danger, STYLE_STATE_HOVER | STYLE_STATE_FOCUSED, NULL);
+	Assert.isTrue(hover->background == UI_RGB(0x40, 0x40, 0x40) && hover->border == 1, "state rules should apply by how many bits they require");
+	const ui_style* pressed = Theme.resolve(ctx, button, STYLE_STATE_HOVER | STYLE_STATE_PRESSED, NULL);
+	Assert.isTrue(pressed->border == 3, "a rule requiring more states should win");
+	Assert.isTrue(Theme.resolve(ctx, button, 0x100, NULL) == plain, "unknown state bits should be ignored");
+
+	//	overrides are part of the key, and only their set properties count
+	style_rule accent = { STYLE_TEXT, { .text = UI_RGB(0, 0xFF, 0), .border = 9 } };
+	const ui_style* green = Theme.resolve(ctx, button, 0, &accent);
+	Assert.isTrue(green != plain && green->text == UI_RGB(0, 0xFF, 0) && green->border == 1, "overrides should apply last");
+	accent.values.border = 5;
+	Assert.isTrue(Theme.resolve(ctx, button, 0, &accent) == green, "values of unset properties should not split the key");
+
+	//	records keep their address while the cache grows
+	for (int i = 0; i < 1000; ++i) {
+		style_rule o = { STYLE_BACKGROUND, { .background = (uint32_t)i } };
+		Theme.resolve(ctx, i % 2 ? button : danger, (uint32_t)i & STYLE_STATE_ALL, &o);
+	}
+	style_stats st;
+	Theme.stats(ctx, &st);
+	Assert.isTrue(Theme.resolve(ctx, button, 0, NULL) == plain && Theme.resolve(ctx, button, 0, &accent) == green, "records should stay put");
+	Assert.isTrue(st.classes == 3 && st.rules == 6 && st.cached == 5 + 1000 && st.flushes == 0, "every key should be interned once");
+
+	Sigui.free_context(ctx);
+}
+/* test generation invalidation, hits and the cache bound */
+static void test_style_invalidate(void) {
+	printf("\n");
+	fflush(stdout);
+
+	ui_allocator tracking = Allocator.new_tracking(NULL);
+	ui_context ctx = Sigui.new_context(NULL, tracking);
+	int label = Theme.add_class(ctx, "label", 0);
+	Theme.rule(ctx, label, 0, &(style_rule){ STYLE_TEXT, { .text = UI_RGB(1, 2, 3) } });
+	const ui_style* s = Theme.resolve(ctx, label, STYLE_STATE_SELECTED, NULL);
+	uint32_t generation = Theme.generation(ctx);
+
+	//	steady lookups hit and do not allocate
+	style_stats before, after;
+	alloc_stats as;
+	Theme.stats(ctx, &before);
+	Allocator.stats(tracking, ALLOC_STYLE, &as);
+	size_t allocs = as.allocs;
+	for (int i = 0; i < 10000; ++i) Theme.resolve(ctx, label, STYLE_STATE_SELECTED, NULL);
+	Theme.stats(ctx, &after);
+	Allocator.stats(tracking, ALLOC_STYLE, &as);
+	Assert.isTrue(after.hits - before.hits == 10000 && after.resolved == before.resolved && as.allocs == allocs, "current records should be hits");
+
+	//	a theme change re-resolves stale records in place, once
+	Theme.rule(ctx, label, STYLE_STATE_SELECTED, &(style_rule){ STYLE_TEXT, { .text = UI_RGB(9, 9, 9) } });
+	Assert.isTrue(Theme.generation(ctx) != generation, "a rule should bump the generation");
+	Assert.isTrue(s->text == UI_RGB(1, 2, 3), "records should only change on lookup");
+	Assert.isTrue(Theme.resolve(ctx, label, STYLE_STATE_SELECTED, NULL) == s && s->text == UI_RGB(9, 9, 9), "a stale record should be re-resolved in place");
+	Theme.stats(ctx, &before);
+	Theme.resolve(ctx, label, STYLE_STATE_SELECTED, NULL);
+	Theme.stats(ctx, &after);
+	Assert.isTrue(after.resolved == before.resolved && after.hits == before.hits + 1, "the record should be current again");
+	Theme.defaults(ctx, &(ui_style){ .text = UI_RGB(7, 7, 7), .radius = 4 });
+	Assert.isTrue(Theme.resolve(ctx, label, 0, NULL)->radius == 4 && Theme.resolve(ctx, label, STYLE_STATE_SELECTED, NULL)->text == UI_RGB(9, 9, 9), "defaults should sit under the rules");
+	Theme.clear(ctx);
+	Assert.isTrue(Theme.resolve(ctx, label, STYLE_STATE_SELECTED, NULL)->text == UI_RGB(7, 7, 7), "clear should drop the rules");
+
+	//	the cache is bounded: past STYLE_CACHE_MAX it starts over in the same chunks
+	for (int i = 0; i < STYLE_CACHE_MAX + 10; ++i) {
+		style_rule o = { STYLE_RADIUS, { .radius = (int16_t)i } };
+		Assert.isTrue(Theme.resolve(ctx, label, 0, &o)->radius == (int16_t)i, "overrides should resolve");
+	}
+	Theme.stats(ctx, &after);
+	Allocator.stats(tracking, ALLOC_STYLE, &as);
+	size_t bytes = as.live_bytes;
+	for (int i = 0; i < STYLE_CACHE_MAX; ++i) Theme.resolve(ctx, label, STYLE_STATE_HOVER, &(style_rule){ STYLE_RADIUS, { .radius = (int16_t)i } });
+	Allocator.stats(tracking, ALLOC_STYLE, &as);
+	Assert.isTrue(after.flushes == 1 && after.cached <= STYLE_CACHE_MAX && as.live_bytes == bytes, "a full cache should be emptied, not grown");
+	printf("lookups=%llu hits=%llu resolved=%llu flushes=%llu\n", (unsigned long long)after.lookups, (unsigned long long)after.hits,
+			 (unsigned long long)after.resolved, (unsigned long long)after.flushes);
+
+	Sigui.free_context(ctx);
+	Allocator.stats(tracking, ALLOC_TAG_COUNT, &as);
+	Assert.isTrue(as.live_bytes == 0, "the theme should be freed with the context");
+	Allocator.free_tracking(tracking);
+}
+
+//	widget state ================================================================
+/* counts frames in a per-module blob, and per row under a nested scope */
+static void counter_render(ui_context ctx, ui_module m, ui_input* input) {
+	int* frames = WidgetState.get(ctx, WidgetState.id(ctx, "scroll"), NULL);
+	(*frames)++;
+	Assert.isTrue(WidgetState.push(ctx, WidgetState.id(ctx, "rows")) == 0, "push should succeed");
+	for (int row = 0; row < 3; ++row) {
+		int* seen = WidgetState.get(ctx, WidgetState.id_data(ctx, &row, sizeof(row)), NULL);
+		if (++*seen != *frames) Assert.isTrue(0, "row state should persist");
+	}
+	WidgetState.pop(ctx);
+	WidgetState.pop(ctx);		// the module scope is kept
+	Assert.isTrue(WidgetState.find(ctx, WidgetState.id(ctx, "scroll")) == frames, "the module scope should survive an extra pop");
+}
+static void idle_render(ui_context ctx, ui_module m, ui_input* input) {
+	//	no-op
+}
+
+//	row source ==================================================================
+static int row_text(object data, int row, char* buf, int size) {
+	text_calls++;
+	return snprintf(buf, size, "row %d", row);
+}
+static int row_height(object data, int row) {
+	height_calls++;
+	return 16 + (row % 3) * 8;
+}
+static void grid_cells(object data, int column, int first, int count, char* buf, int stride) {
+	cell_batches++;
+	batch_rows = count;
+	for (int i = 0; i < count; ++i) snprintf(buf + i * stride, stride, "r%dc%d", first + i, column);
+}
+static int grid_header(object data, int column, char* buf, int size) {
+	return snprintf(buf, size, "column %d", column);
+}
+
+//	image helpers ===============================================================
+static uint32_t gradient(int x, int y) {
+	return 0xFF000000u | (uint32_t)(x * 255 / 999) << 16 | (uint32_t)(y * 255 / 599) << 8 | (uint32_t)((x + y) % 256);
+}
+static void write_gradient(const char* path, int width, int height) {
+	FILE* f = fopen(path, "wb");
+	fprintf(f, "P6\n# gradient\n%d %d\n255\n", width, height);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			uint32_t c = gradient(x, y);
+			uint8_t rgb[3] = { c >> 16 & 0xFF, c >> 8 & 0xFF, c & 0xFF };
+			fwrite(rgb, 1, 3, f);
+		}
+	}
+	fclose(f);
+}
+
+//	register test cases
+__attribute__((constructor)) void init_sigtest_tests(void) {
+	register_test("test_harness", test_harness);
+	register_test("test_extent_index", test_extent_index);
+	register_test("test_list_window", test_list_window);
+	register_test("test_list_heights", test_list_heights);
+	register_test("test_list_scale", test_list_scale);
+	register_test("test_grid_window", test_grid_window);
+	register_test("test_grid_cache", test_grid_cache);
+	register_test("test_grid_input", test_grid_input);
+	register_test("test_plot_pyramid", test_plot_pyramid);
+	register_test("test_plot_gaps", test_plot_gaps);
+	register_test("test_plot_decimation", test_plot_decimation);
+	register_test("test_edit_open", test_edit_open);
+	register_test("test_edit_pieces", test_edit_pieces);
+	register_test("test_edit_input", test_edit_input);
+	register_test("test_tile_convert", test_tile_convert);
+	register_test("test_tile_view", test_tile_view);
+	register_test("test_tile_crafted", test_tile_crafted);
+	register_test("test_state_persist", test_state_persist);
+	register_test("test_state_collect", test_state_collect);
+	register_test("test_style_resolve", test_style_resolve);
+	register_test("test_style_invalidate", test_style_invalidate);
+}
@@ -0,0 +1,38 @@
+// ppm2tiles.c
+/**
+ * @detail Converts a binary PPM (P6 color or P5 gray, 8-bit) into the tiled
+ * 	pyramid file read by `TileView.open`. Both files are mapped, so images far
+ * 	larger than memory convert without being loaded.
+ * 	usage: ppm2tiles <source.ppm> <target> [tile=256]
+ */
+#include "sigui.h"
+#include "sigui_widgets.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <source.ppm> <target> [tile=%d]\n", argv[0], TILE_SIDE);
+		return 2;
+	}
+	int tile = argc > 3 ? atoi(argv[3]) : TILE_SIDE;
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	if (TileView.convert(argv[1], argv[2], tile) != 0) {
+		fprintf(stderr, "%s: cannot convert %s (binary 8-bit PPM and a power of two tile side from 16 to 4096 expected)\n", argv[0], argv[1]);
+		return 1;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	FILE* f = fopen(argv[2], "rb");
+	tiled_header hd;
+	if (f && fread(&hd, sizeof(hd), 1, f) == 1) {
+		printf("%s: %ux%u, %u levels of %ux%u tiles in %.2f s\n", argv[2], hd.width, hd.height, hd.levels, hd.tile, hd.tile,
+				 (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9);
+	}
+	if (f) fclose(f);
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+// sigview.c
+/**
+ * @detail Remote viewer: connects to a `Remote.serve` endpoint, replays the
+ * 	stream into a headless target and sends a pointer sweeping the diagonal
+ * 	back as input. Stops after `frames` frames (0: until the server closes),
+ * 	then prints the stream statistics and optionally saves the last frame.
+ * 	usage: sigview <unix:path|tcp:host:port> [width=800] [height=600] [frames=0] [last.ppm]
+ */
+#include "sigui.h"
+#include "sigui_remote.h"
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* writes a target's pixels as a binary PPM */
+static int save_ppm(const char* path, const uint32_t* pixels, int width, int height) {
+	FILE* f = fopen(path, "wb");
+	if (!f) return -1;
+	fprintf(f, "P6\n%d %d\n255\n", width, height);
+	for (long i = 0; i < (long)width * height; ++i) {
+		uint8_t rgb[3] = { pixels[i] >> 16, pixels[i] >> 8, pixels[i] };
+		fwrite(rgb, 1, 3, f);
+	}
+
+	return fclose(f);
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <unix:path|tcp:host:port> [width=800] [height=600] [frames=0] [last.ppm]\n", argv[0]);
+		return 2;
+	}
+	int width = argc > 2 ? atoi(argv[2]) : 800;
+	int height = argc > 3 ? atoi(argv[3]) : 600;
+	int frames = argc > 4 ? atoi(argv[4]) : 0;
+
+	ui_remote viewer = Remote.connect(argv[1], width, height);
+	if (!viewer) {
+		fprintf(stderr, "%s: cannot connect to %s\n", argv[0], argv[1]);
+		return 1;
+	}
+	render_target t = Render.new_target(RENDER_HEADLESS, width, height);
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	ui_input input = { 0 };
+	int received = 0;
+	while (!frames || received < frames) {
+		int n = Remote.receive(viewer, 1000);
+		if (n < 0) break;
+		if (n == 0) continue;
+		received += n;
+		Render.frame(t, Remote.context(viewer));
+		input.mouse_x = received % width;
+		input.mouse_y = received % height;
+		Remote.send_input(viewer, &input);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+	remote_stats st;
+	Remote.stats(viewer, &st);
+	printf("%s: %llu frames in %.2f s, %llu bytes in (%.1f per frame, %.2f MB/s), %llu records, %llu commands (%llu kept), %llu strings\n",
+			 Remote.address(viewer), (unsigned long long)st.frames, seconds, (unsigned long long)st.bytes_in,
+			 st.frames ? (double)st.bytes_in / st.frames : 0.0, seconds > 0 ? st.bytes_in / seconds / 1e6 : 0.0,
+			 (unsigned long long)st.modules, (unsigned long long)st.commands, (unsigned long long)st.kept, (unsigned long long)st.strings);
+	if (argc > 5 && save_ppm(argv[5], Render.pixels(t), width, height) != 0) fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[5]);
+
+	Render.free_target(t);
+	Remote.free(viewer);
+
+	return 0;
+}